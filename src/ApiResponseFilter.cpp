@@ -0,0 +1,72 @@
+#include "ApiResponseFilter.h"
+#include <string.h> // For strncmp.
+
+// Filter documents are tiny (a handful of keys each). In ArduinoJson 7 every document is heap-backed and sized to
+// its content (`StaticJsonDocument<N>` only ignores its N), so plain `JsonDocument`s are used.
+static JsonDocument s_thresholdsFilter;
+static JsonDocument s_nodeDataFilter;
+static JsonDocument s_deviceStatusFilter;
+static JsonDocument s_worldTimeFilter;
+static JsonDocument s_syncFilter;
+static JsonDocument s_telemetryFilter;
+static bool s_filtersBuilt = false;
+
+/**
+ * @brief Populates the filter documents. Called once, on first use.
+ * Field lists must match what the callbacks in ESP32GreenhouseController.ino and NetworkWorker.cpp read.
+ */
+static void buildFilters() {
+    s_thresholdsFilter["data"][0]["name"] = true; // Index 0 applies the filter to every array element.
+    s_thresholdsFilter["data"][0]["threshold_min"] = true;
+    s_thresholdsFilter["data"][0]["threshold_max"] = true;
+
+    s_nodeDataFilter["data"]["temperature"] = true;
+    s_nodeDataFilter["data"]["humidity"] = true;
+    s_nodeDataFilter["data"]["light_intensity"] = true;
+
+    s_deviceStatusFilter["data"]["exhaust_status"] = true;
+    s_deviceStatusFilter["data"]["dehumidifier_status"] = true;
+    s_deviceStatusFilter["data"]["blower_status"] = true;
+
+    s_worldTimeFilter["unixtime"] = true;
+
+    s_syncFilter["thresholds"] = s_thresholdsFilter;
+    s_syncFilter["node_data"] = s_nodeDataFilter;
+
+    s_telemetryFilter["acked_seq"] = true;
+
+    s_filtersBuilt = true;
+}
+
+/**
+ * @brief Maps an `apiType` tag to its response layout by prefix.
+ * Refer to ApiResponseFilter.h for detailed documentation.
+ */
+ApiResponseKind classifyApiResponse(const char* apiType) {
+    if (!apiType) return ApiResponseKind::GENERIC;
+    if (strncmp(apiType, "TH_", 3) == 0) return ApiResponseKind::THRESHOLDS;
+    if (strncmp(apiType, "ND_", 3) == 0) return ApiResponseKind::NODE_DATA;
+    if (strncmp(apiType, "DEV_ST_G", 8) == 0) return ApiResponseKind::DEVICE_STATUS;
+    if (strncmp(apiType, "WT_", 3) == 0) return ApiResponseKind::WORLD_TIME;
+    if (strncmp(apiType, "SYNC_", 5) == 0) return ApiResponseKind::SYNC;
+    if (strncmp(apiType, "TLM_", 4) == 0) return ApiResponseKind::TELEMETRY;
+    return ApiResponseKind::GENERIC;
+}
+
+/**
+ * @brief Gets the filter document for a response kind, building all filters on first use.
+ * Refer to ApiResponseFilter.h for detailed documentation.
+ */
+const JsonDocument* getApiResponseFilter(ApiResponseKind kind) {
+    if (!s_filtersBuilt) buildFilters();
+    switch (kind) {
+        case ApiResponseKind::THRESHOLDS:    return &s_thresholdsFilter;
+        case ApiResponseKind::NODE_DATA:     return &s_nodeDataFilter;
+        case ApiResponseKind::DEVICE_STATUS: return &s_deviceStatusFilter;
+        case ApiResponseKind::WORLD_TIME:    return &s_worldTimeFilter;
+        case ApiResponseKind::SYNC:          return &s_syncFilter;
+        case ApiResponseKind::TELEMETRY:     return &s_telemetryFilter;
+        case ApiResponseKind::GENERIC:
+        default:                             return nullptr;
+    }
+}
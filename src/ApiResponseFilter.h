@@ -0,0 +1,54 @@
+/**
+ * @file ApiResponseFilter.h
+ * @brief ArduinoJson filter documents describing which response fields each API call actually uses.
+ *
+ * The backend responses carry more fields than the callbacks in the main sketch read (timestamps,
+ * IDs, descriptive names, ...). Deserializing with an ArduinoJson filter discards everything else
+ * while parsing, so the network managers only materialize the fields below:
+ * - Thresholds (`TH_*`): `data[].name`, `data[].threshold_min`, `data[].threshold_max`.
+ * - Node data (`ND_*`): `data.temperature`, `data.humidity`, `data.light_intensity`.
+ * - Device status (`DEV_ST_G*`): `data.exhaust_status`, `data.dehumidifier_status`, `data.blower_status`.
+ * - World time (`WT_*`): `unixtime`.
+ * - Combined sync (`SYNC_*`): the threshold and node data fields under `thresholds` and `node_data`.
+ * - Telemetry replay (`TLM_*`): `acked_seq`.
+ *
+ * The response kind is derived from the `apiType` tag already passed with every request, so no
+ * call site has to change. Unknown tags map to `ApiResponseKind::GENERIC`, which parses unfiltered.
+ * The filters are built once on first use and kept for the lifetime of the program.
+ */
+#ifndef API_RESPONSE_FILTER_H
+#define API_RESPONSE_FILTER_H
+
+#include <stdint.h>      // For uint8_t.
+#include <ArduinoJson.h> // For JsonDocument.
+
+/**
+ * @enum ApiResponseKind
+ * @brief Response layouts known to the firmware.
+ */
+enum class ApiResponseKind : uint8_t {
+    GENERIC,       ///< Unknown layout; parsed without a filter.
+    THRESHOLDS,    ///< Threshold list returned by the TH endpoint.
+    NODE_DATA,     ///< Latest sensor readings returned by the ND endpoint.
+    DEVICE_STATUS, ///< Relay override targets returned by the device status GET endpoint.
+    WORLD_TIME,    ///< Time service response carrying `unixtime`.
+    SYNC,          ///< Combined endpoint: `{"thresholds": <TH response>, "node_data": <ND response>}`.
+    TELEMETRY      ///< Telemetry replay acknowledgement, optionally carrying `acked_seq`.
+};
+
+/**
+ * @brief Maps a request's `apiType` tag to the response layout it expects.
+ * @param apiType The tag passed to `startAsyncHttpRequest()` (e.g., "TH_ASYNC_LP"). May be `nullptr`.
+ * @return The matching `ApiResponseKind`, or `ApiResponseKind::GENERIC` if the tag is not recognised.
+ */
+ApiResponseKind classifyApiResponse(const char* apiType);
+
+/**
+ * @brief Gets the ArduinoJson filter document for a response kind.
+ * @param kind The response layout.
+ * @return Pointer to a filter usable with `DeserializationOption::Filter`, or `nullptr` for
+ *         `ApiResponseKind::GENERIC` (parse everything).
+ */
+const JsonDocument* getApiResponseFilter(ApiResponseKind kind);
+
+#endif // API_RESPONSE_FILTER_H
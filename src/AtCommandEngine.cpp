@@ -0,0 +1,273 @@
+#include "AtCommandEngine.h"
+#include <esp_task_wdt.h> // For watchdog reset while handing over
+
+/**
+ * @brief Checks whether a line is a final error result.
+ */
+static bool isErrorLine(const char* line) {
+    return strcmp(line, "ERROR") == 0 || strncmp(line, "+CME ERROR", 10) == 0 || strncmp(line, "+CMS ERROR", 10) == 0;
+}
+
+/**
+ * @brief Constructs the engine over the modem UART.
+ * Refer to AtCommandEngine.h for detailed documentation.
+ */
+AtCommandEngine::AtCommandEngine(Stream& uart)
+    : _uart(uart),
+      _queueHead(0),
+      _queueCount(0),
+      _inFlight(false),
+      _sentAtMs(0),
+      _haveInfo(false),
+      _urcCount(0),
+      _lineLen(0),
+      _lineSpill(false),
+      _passHead(0),
+      _passLen(0) {
+    _info[0] = '\0';
+    _line[0] = '\0';
+}
+
+/**
+ * @brief Queues a command.
+ * Refer to AtCommandEngine.h for detailed documentation.
+ */
+bool AtCommandEngine::submit(const char* command, const char* infoPrefix, unsigned long timeoutMs,
+                             ResponseHandler handler, const char* finalToken) {
+    if (_queueCount >= AT_COMMAND_QUEUE_DEPTH + 1) {
+        DEBUG_PRINTF(2, "AtCommandEngine: Queue full, AT%s not queued.\n", command);
+        return false;
+    }
+    Command& cmd = _queue[(_queueHead + _queueCount) % (AT_COMMAND_QUEUE_DEPTH + 1)];
+    if (strlcpy(cmd.text, command, sizeof(cmd.text)) >= sizeof(cmd.text) ||
+        (infoPrefix && strlcpy(cmd.infoPrefix, infoPrefix, sizeof(cmd.infoPrefix)) >= sizeof(cmd.infoPrefix)) ||
+        (finalToken && strlcpy(cmd.finalToken, finalToken, sizeof(cmd.finalToken)) >= sizeof(cmd.finalToken))) {
+        DEBUG_PRINTLN(1, "AtCommandEngine: Command text too long, not queued.");
+        return false;
+    }
+    cmd.wantsInfo = infoPrefix != nullptr;
+    if (!infoPrefix) cmd.infoPrefix[0] = '\0';
+    if (!finalToken) cmd.finalToken[0] = '\0';
+    cmd.timeoutMs = timeoutMs;
+    cmd.handler = std::move(handler);
+    _queueCount++;
+    return true;
+}
+
+/**
+ * @brief Registers a URC handler.
+ * Refer to AtCommandEngine.h for detailed documentation.
+ */
+bool AtCommandEngine::onUrc(const char* prefix, UrcHandler handler) {
+    if (_urcCount >= AT_URC_MAX_HANDLERS) return false;
+    _urcs[_urcCount].prefix = prefix;
+    _urcs[_urcCount].prefixLen = strlen(prefix);
+    _urcs[_urcCount].handler = std::move(handler);
+    _urcCount++;
+    return true;
+}
+
+/**
+ * @brief Reads the UART, dispatches lines, times out and starts commands.
+ * Refer to AtCommandEngine.h for detailed documentation.
+ */
+void AtCommandEngine::poll(unsigned long nowMs) {
+    pumpRx(nowMs);
+    if (_inFlight && nowMs - _sentAtMs >= _queue[_queueHead].timeoutMs) {
+        DEBUG_PRINTF(2, "AtCommandEngine: AT%s timed out.\n", _queue[_queueHead].text);
+        complete(AtResult::TIMEOUT);
+    }
+    startNext(nowMs);
+}
+
+/**
+ * @brief Drops queued commands and the one in flight without calling their handlers.
+ * Refer to AtCommandEngine.h for detailed documentation.
+ */
+void AtCommandEngine::clear() {
+    for (uint8_t i = 0; i < _queueCount; ++i) {
+        _queue[(_queueHead + i) % (AT_COMMAND_QUEUE_DEPTH + 1)].handler = nullptr; // Release captured state.
+    }
+    _queueHead = 0;
+    _queueCount = 0;
+    _inFlight = false;
+    _haveInfo = false;
+}
+
+void AtCommandEngine::startNext(unsigned long nowMs) {
+    if (_inFlight || _queueCount == 0) return;
+    const Command& cmd = _queue[_queueHead];
+    _uart.write(reinterpret_cast<const uint8_t*>("AT"), 2);
+    _uart.write(reinterpret_cast<const uint8_t*>(cmd.text), strlen(cmd.text));
+    _uart.write(reinterpret_cast<const uint8_t*>("\r\n"), 2);
+    _inFlight = true;
+    _sentAtMs = nowMs;
+    _haveInfo = false;
+    _info[0] = '\0';
+}
+
+void AtCommandEngine::complete(AtResult result) {
+    Command& cmd = _queue[_queueHead];
+    ResponseHandler handler = std::move(cmd.handler);
+    cmd.handler = nullptr;
+    _queueHead = (_queueHead + 1) % (AT_COMMAND_QUEUE_DEPTH + 1);
+    _queueCount--;
+    _inFlight = false;
+
+    _stats.commands++;
+    if (result == AtResult::ERROR) _stats.errors++;
+    else if (result == AtResult::TIMEOUT) _stats.timeouts++;
+
+    if (handler) handler(result, _haveInfo ? _info : ""); // May submit the next command of a sequence.
+}
+
+void AtCommandEngine::pumpRx(unsigned long nowMs) {
+    (void)nowMs;
+    while (_uart.available() > 0) {
+        int c = _uart.read();
+        if (c < 0) break;
+        if (_lineSpill) { // Long line (socket data, banner): not ours, forward it as read.
+            char ch = (char)c;
+            passthrough(&ch, 1);
+            if (c == '\n') _lineSpill = false;
+            continue;
+        }
+        if (c == '\r') continue;
+        if (c == '\n') {
+            _line[_lineLen] = '\0';
+            size_t len = _lineLen;
+            _lineLen = 0;
+            if (len > 0) onLine(_line);
+            continue;
+        }
+        if (_lineLen + 1 >= sizeof(_line)) {
+            passthrough("\r\n", 2);
+            passthrough(_line, _lineLen);
+            char ch = (char)c;
+            passthrough(&ch, 1);
+            _lineLen = 0;
+            _lineSpill = true;
+            continue;
+        }
+        _line[_lineLen++] = (char)c;
+    }
+}
+
+void AtCommandEngine::onLine(const char* line) {
+    if (_inFlight) {
+        const Command& cmd = _queue[_queueHead];
+        if (strncmp(line, "AT", 2) == 0 && strcmp(line + 2, cmd.text) == 0) return; // Echo (before ATE0).
+        if (cmd.finalToken[0] != '\0' ? strcmp(line, cmd.finalToken) == 0 : strcmp(line, "OK") == 0) {
+            complete(AtResult::OK);
+            return;
+        }
+        if (isErrorLine(line)) {
+            complete(AtResult::ERROR);
+            return;
+        }
+        if (cmd.wantsInfo && !_haveInfo && cmd.infoPrefix[0] != '\0' &&
+            strncmp(line, cmd.infoPrefix, strlen(cmd.infoPrefix)) == 0) {
+            strlcpy(_info, line, sizeof(_info));
+            _haveInfo = true;
+            return;
+        }
+    } else if (strcmp(line, "OK") == 0 || isErrorLine(line)) {
+        _stats.strayFinals++; // Late reply to a timed-out command; must not reach TinyGSM.
+        return;
+    }
+
+    for (uint8_t i = 0; i < _urcCount; ++i) {
+        if (strncmp(line, _urcs[i].prefix, _urcs[i].prefixLen) == 0) {
+            _stats.urcs++;
+            _urcs[i].handler(line);
+            return;
+        }
+    }
+
+    if (_inFlight && _queue[_queueHead].wantsInfo && !_haveInfo && _queue[_queueHead].infoPrefix[0] == '\0') {
+        strlcpy(_info, line, sizeof(_info)); // Unprefixed reply, e.g. the IP address of AT+CIFSR.
+        _haveInfo = true;
+        return;
+    }
+
+    // Not ours: re-frame as the modem sent it, so TinyGSM's GSM_NL-prefixed matches still work.
+    passthrough("\r\n", 2);
+    passthrough(line, strlen(line));
+    passthrough("\r\n", 2);
+}
+
+void AtCommandEngine::passthrough(const char* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (_passLen >= sizeof(_pass)) {
+            _stats.passthroughDrops += len - i;
+            return;
+        }
+        _pass[(_passHead + _passLen) % sizeof(_pass)] = (uint8_t)data[i];
+        _passLen++;
+    }
+}
+
+void AtCommandEngine::handOver() {
+    if (_inFlight) {
+        unsigned long start = millis();
+        _stats.handovers++;
+        while (_inFlight) {
+            unsigned long now = millis();
+            pumpRx(now);
+            if (_inFlight && now - _sentAtMs >= _queue[_queueHead].timeoutMs) {
+                DEBUG_PRINTF(2, "AtCommandEngine: AT%s timed out.\n", _queue[_queueHead].text);
+                complete(AtResult::TIMEOUT);
+            }
+            if (_inFlight) {
+                esp_task_wdt_reset();
+                delay(1);
+            }
+        }
+        unsigned long waited = millis() - start;
+        if (waited > _stats.maxHandoverWaitMs) _stats.maxHandoverWaitMs = waited;
+    }
+    if (_lineLen > 0) { // TinyGSM continues a line the engine had started reading.
+        passthrough("\r\n", 2);
+        passthrough(_line, _lineLen);
+        _lineLen = 0;
+    }
+}
+
+// --- Stream interface ---
+// Commands queued (not yet sent) stay queued while TinyGSM runs; poll() sends them afterwards.
+
+int AtCommandEngine::available() {
+    handOver();
+    return (int)_passLen + _uart.available();
+}
+
+int AtCommandEngine::read() {
+    handOver();
+    if (_passLen > 0) {
+        uint8_t b = _pass[_passHead];
+        _passHead = (_passHead + 1) % sizeof(_pass);
+        _passLen--;
+        return b;
+    }
+    return _uart.read();
+}
+
+int AtCommandEngine::peek() {
+    handOver();
+    if (_passLen > 0) return _pass[_passHead];
+    return _uart.peek();
+}
+
+void AtCommandEngine::flush() {
+    _uart.flush();
+}
+
+size_t AtCommandEngine::write(uint8_t b) {
+    handOver();
+    return _uart.write(b);
+}
+
+size_t AtCommandEngine::write(const uint8_t* buffer, size_t size) {
+    handOver();
+    return _uart.write(buffer, size);
+}
@@ -0,0 +1,219 @@
+/**
+ * @file AtCommandEngine.h
+ * @brief Defines `AtCommandEngine`, a non-blocking AT command pipeline between TinyGSM and the modem UART.
+ *
+ * TinyGSM's status calls (`getSignalQuality()`, `isGprsConnected()`, `getRegistrationStatus()`, `gprsConnect()`)
+ * send a command and spin on the UART until the reply or a timeout of up to 85 s. `GPRSManager` runs those
+ * from `updateFSM()`, so each one stalled the network worker. This engine replaces them with:
+ * - A command queue: `submit()` returns at once; `poll()` sends the next command when the line is free.
+ * - A response matcher: lines read from the UART RX buffer complete the command in flight on `OK`, `ERROR`,
+ *   `+CME ERROR`/`+CMS ERROR` or a custom final token, capturing the expected info line (e.g. `+CSQ: 20,0`).
+ * - A URC dispatcher: lines matching a registered prefix (`+CREG:`, `+CGREG:`) go to their handler, so
+ *   registration changes arrive as notifications instead of being polled.
+ *
+ * TinyGSM is constructed over this engine instead of the UART (`TinyGsm modem(atEngine)`) and keeps running the
+ * data plane (sockets, `AT+CIPSEND`, `AT+CIPRXGET`) synchronously. The two share the UART as follows:
+ * - Before TinyGSM reads or writes, the engine finishes its command in flight (bounded by that command's
+ *   timeout; status queries answer in tens of milliseconds) and hands over a clean line.
+ * - Lines the engine read but does not own (e.g. `+CIPRXGET: 1,0`) are kept in a passthrough buffer and served
+ *   to TinyGSM ahead of the UART, so socket notifications are not lost.
+ * - A bare `OK`/`ERROR` arriving with no command in flight (late reply to a timed-out command) is dropped, so it
+ *   cannot be taken as the reply to TinyGSM's next command.
+ * - URCs that arrive while TinyGSM itself is reading are consumed by TinyGSM; callers that depend on a URC
+ *   should also query the state on a slow interval.
+ *
+ * The engine only needs a `Stream`, so it can be driven off-target by a scripted modem stream, as
+ * `test/test_at_command_engine` does.
+ *
+ * Network worker task only; no locking.
+ */
+#ifndef AT_COMMAND_ENGINE_H
+#define AT_COMMAND_ENGINE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "config.h" // For AT_COMMAND_QUEUE_DEPTH, AT_LINE_MAX_LEN and related sizes.
+
+/**
+ * @enum AtResult
+ * @brief Outcome of a queued AT command.
+ */
+enum class AtResult : uint8_t {
+    OK,      ///< Final `OK` (or the command's custom final token) received.
+    ERROR,   ///< `ERROR`, `+CME ERROR` or `+CMS ERROR` received.
+    TIMEOUT  ///< No final result within the command's timeout.
+};
+
+/**
+ * @class AtCommandEngine
+ * @brief Command queue, response matcher and URC dispatcher over a modem `Stream`, itself usable as TinyGSM's stream.
+ */
+class AtCommandEngine : public Stream {
+public:
+    /**
+     * @brief Completion callback of a command.
+     * @param result Outcome.
+     * @param info The expected info line (e.g. "+CSQ: 20,0"), or "" if none was captured.
+     */
+    using ResponseHandler = std::function<void(AtResult result, const char* info)>;
+
+    /**
+     * @brief URC callback.
+     * @param line The whole notification line (e.g. "+CREG: 5").
+     */
+    using UrcHandler = std::function<void(const char* line)>;
+
+    /**
+     * @struct Stats
+     * @brief Counters since boot.
+     */
+    struct Stats {
+        uint32_t commands = 0;              ///< Commands completed (any result).
+        uint32_t errors = 0;                ///< Commands completed with `AtResult::ERROR`.
+        uint32_t timeouts = 0;              ///< Commands completed with `AtResult::TIMEOUT`.
+        uint32_t urcs = 0;                  ///< Lines dispatched to a URC handler.
+        uint32_t strayFinals = 0;           ///< `OK`/`ERROR` lines dropped because no command was in flight.
+        uint32_t passthroughDrops = 0;      ///< Bytes dropped because the passthrough buffer was full.
+        uint32_t handovers = 0;             ///< TinyGSM UART accesses that had to finish a command in flight first.
+        unsigned long maxHandoverWaitMs = 0;///< Longest such wait.
+    };
+
+    /**
+     * @brief Constructs the engine over the modem UART.
+     * @param uart Modem serial port (e.g. `Serial1`), already begun by the caller.
+     */
+    explicit AtCommandEngine(Stream& uart);
+
+    /**
+     * @brief Queues a command. Never blocks; the command is sent by `poll()` once earlier ones completed.
+     * @param command Command text after "AT" (e.g. "+CSQ"); copied.
+     * @param infoPrefix Prefix of the info line to capture (e.g. "+CSQ:"), "" to capture the first line that is
+     *                   not a final result (e.g. the bare IP printed by `AT+CIFSR`), or `nullptr` for none.
+     * @param timeoutMs Time allowed for the final result after sending.
+     * @param handler Called once with the outcome; may submit further commands. May be empty.
+     * @param finalToken Line that completes the command successfully instead of `OK` (e.g. "SHUT OK"), or `nullptr`.
+     * @return `false` if the queue is full or a text does not fit; the handler is not called then.
+     */
+    bool submit(const char* command, const char* infoPrefix, unsigned long timeoutMs,
+                ResponseHandler handler, const char* finalToken = nullptr);
+
+    /**
+     * @brief Registers a URC handler. Lines starting with `prefix` that are not the info line of the command in
+     *        flight are passed to it.
+     * @param prefix Line prefix (e.g. "+CREG:"); must outlive the engine (string literal).
+     * @param handler Callback.
+     * @return `false` if `AT_URC_MAX_HANDLERS` are already registered.
+     */
+    bool onUrc(const char* prefix, UrcHandler handler);
+
+    /**
+     * @brief Reads whatever the UART has buffered, dispatches complete lines, times out and starts commands.
+     * Never blocks; call every pass of the owner's loop.
+     * @param nowMs Current `millis()`.
+     */
+    void poll(unsigned long nowMs);
+
+    /**
+     * @brief Drops queued commands and the one in flight without calling their handlers. Used when the modem
+     *        reboots and their replies will never come.
+     */
+    void clear();
+
+    /**
+     * @brief Checks whether nothing is queued or in flight.
+     * @return `true` if idle.
+     */
+    bool isIdle() const { return !_inFlight && _queueCount == 0; }
+
+    /**
+     * @brief Gets the counters since boot.
+     * @return Reference to the statistics.
+     */
+    const Stats& getStats() const { return _stats; }
+
+    // --- Stream interface, used by TinyGSM ---
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+private:
+    /**
+     * @brief A queued command.
+     */
+    struct Command {
+        char text[AT_COMMAND_MAX_LEN];           ///< Command after "AT".
+        char infoPrefix[AT_INFO_PREFIX_MAX_LEN]; ///< Info line prefix; valid if `wantsInfo`.
+        char finalToken[AT_INFO_PREFIX_MAX_LEN]; ///< Custom success line, or "" for `OK`.
+        bool wantsInfo;                          ///< An info line is captured.
+        unsigned long timeoutMs;                 ///< Time allowed after sending.
+        ResponseHandler handler;                 ///< Completion callback.
+    };
+
+    /**
+     * @brief A registered URC prefix.
+     */
+    struct Urc {
+        const char* prefix;  ///< Line prefix.
+        size_t prefixLen;    ///< `strlen(prefix)`.
+        UrcHandler handler;  ///< Callback.
+    };
+
+    /**
+     * @brief Finishes the command in flight before TinyGSM touches the UART, then moves a partly read line to
+     *        the passthrough buffer so TinyGSM sees the bytes in order.
+     */
+    void handOver();
+    /**
+     * @brief Reads the UART into `_line`, processing each complete line.
+     * @param nowMs Current `millis()`.
+     */
+    void pumpRx(unsigned long nowMs);
+    /**
+     * @brief Classifies one complete line: echo, info line, final result, URC or passthrough.
+     * @param line Null-terminated line without CR/LF.
+     */
+    void onLine(const char* line);
+    /**
+     * @brief Sends the head of the queue if nothing is in flight.
+     * @param nowMs Current `millis()`.
+     */
+    void startNext(unsigned long nowMs);
+    /**
+     * @brief Completes the command in flight and calls its handler.
+     * @param result Outcome.
+     */
+    void complete(AtResult result);
+    /**
+     * @brief Appends bytes to the passthrough buffer, dropping what does not fit.
+     */
+    void passthrough(const char* data, size_t len);
+
+    Stream& _uart;                                 ///< Modem UART.
+
+    Command _queue[AT_COMMAND_QUEUE_DEPTH + 1];    ///< Ring of queued commands plus the one in flight at `_queueHead`.
+    uint8_t _queueHead;                            ///< Index of the oldest entry.
+    uint8_t _queueCount;                           ///< Entries in the ring, including the one in flight.
+    bool _inFlight;                                ///< `_queue[_queueHead]` has been sent and awaits its final result.
+    unsigned long _sentAtMs;                       ///< `millis()` when the command in flight was sent.
+    char _info[AT_LINE_MAX_LEN];                   ///< Captured info line of the command in flight.
+    bool _haveInfo;                                ///< `_info` holds a line.
+
+    Urc _urcs[AT_URC_MAX_HANDLERS];                ///< Registered URC prefixes.
+    uint8_t _urcCount;                             ///< Entries in `_urcs`.
+
+    char _line[AT_LINE_MAX_LEN];                   ///< Line being assembled from the UART.
+    size_t _lineLen;                               ///< Bytes in `_line`.
+    bool _lineSpill;                               ///< The current line outgrew `_line`; it is not ours and goes to TinyGSM as read.
+
+    uint8_t _pass[AT_PASSTHROUGH_BUFFER_LEN];      ///< Ring of bytes owed to TinyGSM.
+    size_t _passHead;                              ///< Index of the oldest byte.
+    size_t _passLen;                               ///< Bytes in `_pass`.
+
+    Stats _stats;                                  ///< Counters.
+};
+
+#endif // AT_COMMAND_ENGINE_H
@@ -0,0 +1,124 @@
+#include "ChunkedDecoder.h"
+#include <string.h> // For memmove.
+
+// Eight hex digits cover any chunk this firmware could plausibly receive and keep the size within 32 bits.
+static const uint8_t CHUNK_SIZE_MAX_DIGITS = 8;
+
+/**
+ * @brief Constructs a decoder ready for a new body.
+ * Refer to ChunkedDecoder.h for detailed documentation.
+ */
+ChunkedDecoder::ChunkedDecoder() {
+    reset();
+}
+
+/**
+ * @brief Prepares the decoder for a new body.
+ * Refer to ChunkedDecoder.h for detailed documentation.
+ */
+void ChunkedDecoder::reset() {
+    _state = State::SIZE;
+    _chunkRemaining = 0;
+    _sizeDigits = 0;
+    _overflowed = false;
+    _payloadBytes = 0;
+}
+
+/**
+ * @brief Decodes the next piece of an encoded body.
+ * Framing bytes are handled one at a time; chunk payload is moved in runs with a single `memmove`.
+ * Refer to ChunkedDecoder.h for detailed documentation.
+ */
+size_t ChunkedDecoder::feed(const char* in, size_t inLen, char* out, size_t outCapacity, size_t& outLen) {
+    size_t i = 0;
+    outLen = 0;
+
+    while (i < inLen && _state != State::DONE && _state != State::ERROR) {
+        if (_state == State::DATA) {
+            size_t run = inLen - i;
+            if (run > _chunkRemaining) run = (size_t)_chunkRemaining;
+            size_t fit = outCapacity - outLen;
+            if (fit > run) fit = run;
+            if (fit > 0) memmove(out + outLen, in + i, fit);
+            if (fit < run) _overflowed = true;
+            outLen += fit;
+            i += run;
+            _chunkRemaining -= run;
+            _payloadBytes += run;
+            if (_chunkRemaining == 0) _state = State::DATA_CR;
+            continue;
+        }
+
+        char c = in[i++];
+        switch (_state) {
+            case State::SIZE:
+                if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
+                    if (_sizeDigits >= CHUNK_SIZE_MAX_DIGITS) {
+                        _state = State::ERROR;
+                        break;
+                    }
+                    uint8_t nibble = (c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10);
+                    _chunkRemaining = (_chunkRemaining << 4) | nibble;
+                    _sizeDigits++;
+                } else if (_sizeDigits > 0 && (c == ';' || c == ' ' || c == '\t')) {
+                    _state = State::EXTENSION;
+                } else if (_sizeDigits > 0 && c == '\r') {
+                    _state = State::SIZE_LF;
+                } else if (_sizeDigits > 0 && c == '\n') {
+                    endSizeLine();
+                } else {
+                    _state = State::ERROR;
+                }
+                break;
+
+            case State::EXTENSION:
+                if (c == '\r') _state = State::SIZE_LF;
+                else if (c == '\n') endSizeLine();
+                break;
+
+            case State::SIZE_LF:
+                if (c == '\n') endSizeLine();
+                else _state = State::ERROR;
+                break;
+
+            case State::DATA_CR:
+                if (c == '\r') _state = State::DATA_LF;
+                else if (c == '\n') _state = State::SIZE;
+                else _state = State::ERROR;
+                break;
+
+            case State::DATA_LF:
+                if (c == '\n') _state = State::SIZE;
+                else _state = State::ERROR;
+                break;
+
+            case State::TRAILER_START:
+                if (c == '\r') _state = State::FINAL_LF;
+                else if (c == '\n') _state = State::DONE;
+                else _state = State::TRAILER;
+                break;
+
+            case State::TRAILER:
+                if (c == '\n') _state = State::TRAILER_START;
+                break;
+
+            case State::FINAL_LF:
+                if (c == '\n') _state = State::DONE;
+                else _state = State::ERROR;
+                break;
+
+            default:
+                break;
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief Handles the end of a chunk-size line.
+ * Refer to ChunkedDecoder.h for detailed documentation.
+ */
+void ChunkedDecoder::endSizeLine() {
+    _sizeDigits = 0;
+    _state = (_chunkRemaining == 0) ? State::TRAILER_START : State::DATA;
+}
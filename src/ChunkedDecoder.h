@@ -0,0 +1,114 @@
+/**
+ * @file ChunkedDecoder.h
+ * @brief Defines the `ChunkedDecoder` class, a streaming decoder for HTTP/1.1 chunked transfer encoding.
+ *
+ * `GPRSManager` talks HTTP over a raw `TinyGsmClient` socket, so it has to undo the chunked framing
+ * itself. This decoder is a byte-level state machine that can be fed the response body in arbitrary
+ * pieces as they arrive from the modem: a chunk-size line, a chunk extension, the CRLF after a chunk
+ * or a trailer field may all be split across reads. Only chunk payload bytes are written to the output,
+ * so the decoded body is built up directly in its destination buffer without holding the encoded copy.
+ *
+ * Design notes:
+ * - Output never grows faster than input (`out` bytes written <= input bytes consumed), so the caller
+ *   may decode in place by passing an `out` pointer that aliases `in` (with `out <= in`).
+ * - Chunk extensions (`;name=value`) and trailer fields are accepted and skipped.
+ * - Payload bytes that do not fit the caller's output capacity are dropped and flagged via
+ *   `hasOverflowed()`; decoding continues so the end of the body is still detected.
+ * - Bare LF line endings are tolerated; any other framing violation puts the decoder into an error state.
+ * - The class has no Arduino dependencies and allocates no memory.
+ */
+#ifndef CHUNKED_DECODER_H
+#define CHUNKED_DECODER_H
+
+#include <stdint.h> // For fixed-width integer types.
+#include <stddef.h> // For `size_t`.
+
+/**
+ * @class ChunkedDecoder
+ * @brief Incremental decoder for `Transfer-Encoding: chunked` message bodies.
+ */
+class ChunkedDecoder {
+public:
+    /**
+     * @enum State
+     * @brief Position of the decoder within the chunked framing.
+     */
+    enum class State : uint8_t {
+        SIZE,          ///< Reading the hexadecimal chunk size.
+        EXTENSION,     ///< Skipping a chunk extension up to the end of the size line.
+        SIZE_LF,       ///< Expecting the LF that ends the size line.
+        DATA,          ///< Copying chunk payload; `_chunkRemaining` bytes left in the current chunk.
+        DATA_CR,       ///< Expecting the CR after a chunk's payload.
+        DATA_LF,       ///< Expecting the LF after a chunk's payload.
+        TRAILER_START, ///< At the start of a trailer line (after the last chunk). An empty line ends the body.
+        TRAILER,       ///< Skipping a trailer field up to its LF.
+        FINAL_LF,      ///< Expecting the LF of the empty line that ends the body.
+        DONE,          ///< The complete body has been decoded. Further input is ignored.
+        ERROR          ///< The framing was malformed. Further input is ignored.
+    };
+
+    /**
+     * @brief Constructs a decoder ready for a new body.
+     */
+    ChunkedDecoder();
+
+    /**
+     * @brief Prepares the decoder for a new body.
+     */
+    void reset();
+
+    /**
+     * @brief Decodes the next piece of an encoded body.
+     * @param in Encoded bytes as received.
+     * @param inLen Number of bytes in `in`.
+     * @param out Destination for decoded payload bytes. May alias `in` as long as `out <= in`.
+     * @param outCapacity Number of bytes available at `out`. Payload beyond this is dropped and flags overflow.
+     * @param outLen Receives the number of decoded bytes written to `out`.
+     * @return Number of input bytes consumed. Less than `inLen` only once `DONE` or `ERROR` is reached.
+     */
+    size_t feed(const char* in, size_t inLen, char* out, size_t outCapacity, size_t& outLen);
+
+    /**
+     * @brief Checks whether the terminating chunk and trailer section have been decoded.
+     * @return `true` once the end of the body has been reached.
+     */
+    bool isDone() const { return _state == State::DONE; }
+
+    /**
+     * @brief Checks whether malformed framing was encountered.
+     * @return `true` if the decoder is in the `ERROR` state.
+     */
+    bool hasError() const { return _state == State::ERROR; }
+
+    /**
+     * @brief Checks whether any payload was dropped for lack of output capacity.
+     * @return `true` if at least one payload byte was discarded.
+     */
+    bool hasOverflowed() const { return _overflowed; }
+
+    /**
+     * @brief Gets the current decoder state.
+     * @return The `State` value.
+     */
+    State getState() const { return _state; }
+
+    /**
+     * @brief Gets the total number of payload bytes decoded, including any that were dropped on overflow.
+     * @return Decoded payload size in bytes.
+     */
+    unsigned long getPayloadBytes() const { return _payloadBytes; }
+
+private:
+    State _state;                   ///< Current framing state.
+    unsigned long _chunkRemaining;  ///< Size of the chunk being read, then payload bytes left in it.
+    uint8_t _sizeDigits;            ///< Hex digits read for the current chunk size (bounded to avoid overflow).
+    bool _overflowed;               ///< Set if payload was dropped because the output was full.
+    unsigned long _payloadBytes;    ///< Total payload bytes seen for this body.
+
+    /**
+     * @brief Handles the end of a chunk-size line: moves to `DATA`, or to the trailer section for the last chunk.
+     */
+    void endSizeLine();
+};
+
+#endif // CHUNKED_DECODER_H
@@ -118,6 +118,7 @@ void ConfigPortalManager::handleFactoryReset() {
     DEBUG_PRINTLN_F(1, F("Factory reset requested via ConfigPortalManager."));
     _lcd.clear();
     _lcd.message(0, 0, "FACTORY RESET...", true);
+    _lcd.flushAll();
 
     _deviceConfig.factoryResetConfig(); // factoryResetConfig is void, cannot assign to bool
 
@@ -177,6 +178,7 @@ bool ConfigPortalManager::startPortal() {
 
     if (!WiFi.softAP(apS_unique, apP)) {
         _lcd.message(0, 3, "AP START FAILED!", true);
+        _lcd.flushAll();
         delay(5000);
         ESP.restart();
         return false; // Should not reach here
@@ -192,6 +194,7 @@ bool ConfigPortalManager::startPortal() {
         _lcd.message(0, 3, "DNS FAILED!", true); // Overwrites IP on LCD line 3
         // Potentially log or handle this failure more gracefully than just showing on LCD
     }
+    _lcd.flushAll(); // The portal loop below does not return to loop(), which normally flushes the LCD.
 
     _server.on("/", HTTP_GET, std::bind(&ConfigPortalManager::handleRoot, this));
     _server.on("/save", HTTP_POST, std::bind(&ConfigPortalManager::handleSave, this));
@@ -214,6 +217,7 @@ bool ConfigPortalManager::startPortal() {
 
     _lcd.clear();
     _lcd.message(0, 0, "Portal Timeout", true);
+    _lcd.flushAll();
     DEBUG_PRINTLN_F(1, F("Config Portal timed out. Restarting."));
     delay(2000);
     ESP.restart();
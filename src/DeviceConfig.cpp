@@ -41,11 +41,35 @@ void DeviceConfig::constructApiUrls() {
     strncpy_P(base_url_buffer, DEFAULT_API_STATUS_GET_BASE_URL, sizeof(base_url_buffer) - 1);
     base_url_buffer[sizeof(base_url_buffer) - 1] = '\0';
     snprintf(device_status_get_url, sizeof(device_status_get_url), "%s?gh_id=%d", base_url_buffer, this->gh_id);
+
+    // --- Combined Sync URL (optional; stays empty when the backend has no such endpoint) ---
+    strncpy_P(base_url_buffer, DEFAULT_API_SYNC_BASE_URL, sizeof(base_url_buffer) - 1);
+    base_url_buffer[sizeof(base_url_buffer) - 1] = '\0';
+    if (base_url_buffer[0] != '\0') {
+        snprintf(sync_url, sizeof(sync_url), "%s?gh_id=%d", base_url_buffer, this->gh_id);
+    } else {
+        sync_url[0] = '\0';
+    }
+
+    // --- Telemetry Replay URL (optional; stays empty when the backend has no such endpoint) ---
+    strncpy_P(base_url_buffer, DEFAULT_API_TELEMETRY_BASE_URL, sizeof(base_url_buffer) - 1);
+    base_url_buffer[sizeof(base_url_buffer) - 1] = '\0';
+    if (base_url_buffer[0] != '\0') {
+        snprintf(telemetry_url, sizeof(telemetry_url), "%s?gh_id=%d", base_url_buffer, this->gh_id);
+    } else {
+        telemetry_url[0] = '\0';
+    }
     
     // --- World Time URL ---
     // This URL is typically common and does not require gh_id.
     strncpy_P(worldtime_url, WORLDTIME_URL, sizeof(worldtime_url) - 1);
     worldtime_url[sizeof(worldtime_url) - 1] = '\0'; // Ensure null termination.
+
+    // --- MQTT Broker (optional; stays empty when there is no broker) ---
+    // Not a URL and not per greenhouse: topics carry the gh_id instead (see MqttManager.h).
+    strncpy_P(mqtt_host, DEFAULT_MQTT_BROKER_HOST, sizeof(mqtt_host) - 1);
+    mqtt_host[sizeof(mqtt_host) - 1] = '\0';
+    mqtt_port = DEFAULT_MQTT_BROKER_PORT;
 }
 
 /**
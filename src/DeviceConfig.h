@@ -119,6 +119,23 @@ public:
      * Max length: `API_URL_MAX_LEN`. Built using `API_BASE_URL_DEVICE_COMMANDS` (or similar) and `gh_id`.
      */
     char device_status_get_url[API_URL_MAX_LEN];
+    /**
+     * @brief Fully constructed URL of the optional combined sync endpoint (thresholds + node data in one response).
+     * Max length: `API_URL_MAX_LEN`. Built from `DEFAULT_API_SYNC_BASE_URL` and `gh_id`; empty if that base URL is empty.
+     */
+    char sync_url[API_URL_MAX_LEN];
+    /**
+     * @brief Fully constructed URL of the optional telemetry endpoint that receives replayed log records.
+     * Max length: `API_URL_MAX_LEN`. Built from `DEFAULT_API_TELEMETRY_BASE_URL` and `gh_id`; empty if that base URL is empty.
+     */
+    char telemetry_url[API_URL_MAX_LEN];
+    /**
+     * @brief Host of the optional MQTT broker that pushes overrides and threshold changes.
+     * Max length: `MQTT_HOST_MAX_LEN`. Set from `DEFAULT_MQTT_BROKER_HOST` in `config.h`; empty disables push.
+     */
+    char mqtt_host[MQTT_HOST_MAX_LEN];
+    /** @brief MQTT broker port. Set from `DEFAULT_MQTT_BROKER_PORT` in `config.h`. */
+    uint16_t mqtt_port;
 
     // --- Device Identification ---
     /**
@@ -193,8 +210,8 @@ private:
      *
      * It takes base API URLs (e.g., `API_BASE_URL_TH_DATA`, `API_BASE_URL_ND_DATA` from `config.h`)
      * and appends the `gh_id` as a query parameter (e.g., `"?gh_id=1"`) to form the complete
-     * URLs stored in `th_url`, `nd_url`, `device_status_post_url`, and `device_status_get_url`.
-     * The `worldtime_url` is typically a static URL from `config.h` and is just copied.
+     * URLs stored in `th_url`, `nd_url`, `device_status_post_url`, `device_status_get_url`, `sync_url` and `telemetry_url`.
+     * The `worldtime_url` is typically a static URL from `config.h` and is just copied, as are `mqtt_host` and `mqtt_port`.
      * Ensures all constructed URLs fit within their respective `API_URL_MAX_LEN` buffers.
      *
      * @see `DeviceConfig.cpp` for the detailed implementation of URL formatting.
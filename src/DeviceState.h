@@ -48,14 +48,10 @@ enum class GPRSState {
  */
 struct DeviceState {
     // --- Timing and Counters ---
-    unsigned long lastLoopTime;                 ///< Timestamp (`millis()`) of the last main loop iteration.
-    unsigned long lastApiAttemptTime;           ///< Timestamp of the last attempt to communicate with the API.
-    unsigned long lastTimeSyncTime;             ///< Timestamp of the last successful RTC synchronization.
+    // Periodic loop work (API fetch, status poll, SD retry, RTC sync) is timed by the JobScheduler in the main sketch.
     unsigned long lastSuccessfulApiUpdateTime;  ///< Timestamp of the last successful data update to/from the API.
-    unsigned long lastSdRetryTime;              ///< Timestamp of the last attempt to initialize or interact with the SD card after a failure.
     unsigned long lastConnectionRetryTime;      ///< Timestamp of the last general network connection retry attempt (WiFi or GPRS).
     unsigned long lastWiFiRetryWhenGprsTime;    ///< Timestamp of the last attempt to switch back to WiFi when operating on GPRS failover.
-    unsigned long lastDeviceStatusCheckTime;    ///< Timestamp of the last check for device status/commands from the API (e.g., manual overrides).
 
     // --- Operational Flags ---
     bool isInFailSafeMode;                      ///< Flag indicating if the device is currently in a failsafe operational mode (e.g., due to prolonged network unavailability).
@@ -96,14 +92,9 @@ struct DeviceState {
      * - GPRS signal quality is initialized to 99 (unknown/error).
      */
     DeviceState() :
-        lastLoopTime(0),
-        lastApiAttemptTime(0),
-        lastTimeSyncTime(0),
         lastSuccessfulApiUpdateTime(0),
-        lastSdRetryTime(0),
         lastConnectionRetryTime(0),
         lastWiFiRetryWhenGprsTime(0),
-        lastDeviceStatusCheckTime(0),
         isInFailSafeMode(false),
         // sdCardOk(false), // Removed
         currentConnectionRetryDelayMs(INITIAL_RETRY_DELAY_MS),
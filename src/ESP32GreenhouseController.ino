@@ -39,14 +39,15 @@
 #include <LiquidCrystal_I2C.h>
 #include <TinyGsmCommon.h>
 #include <TinyGsmClient.h>
-#include <NTPClient.h>
-#include <WiFiUdp.h>
 #include <functional> // For std::function
 
 // --- Additional Libraries for Advanced Features ---
 #include <Preferences.h>    // For saving settings to NVS
 // WebServer and DNSServer are now managed by ConfigPortalManager
 #include <esp_task_wdt.h> // Include watchdog bawaan ESP32
+#if LIGHT_SLEEP_ENABLED
+#include <esp_pm.h>       // For automatic light sleep
+#endif
 #include <ESPmDNS.h>        // For mDNS discovery (optional, but often included)
 #include <memory>           // For std::unique_ptr
 
@@ -54,7 +55,9 @@
 #include "NetworkInterface.h"
 #include "WiFiManager.h"
 #include "GPRSManager.h"
+#include "AtCommandEngine.h" // Non-blocking AT command pipeline between TinyGSM and Serial1
 #include "NetworkFacade.h"
+#include "NetworkWorker.h" // Runs NetworkFacade on its own core-0 task
 #include "DeviceConfig.h" // For global config struct
 #include "DeviceState.h"  // For global state struct
 #include "LCDDisplay.h"   // For LCD Display class
@@ -63,6 +66,14 @@
 #include "RelayController.h" // For RelayController class
 #include "SDCardLogger.h"  // For SDCardLogger class
 #include "ConfigPortalManager.h" // For Configuration Portal
+#include "LoopProfiler.h"     // LOOP_PROFILE() stage timing (no-op unless LOOP_PROFILER_ENABLED)
+#include "JobScheduler.h"     // Deadline-ordered periodic jobs driving loop()
+#include "StatusUplinkBatcher.h" // Merges relay/failsafe changes into one status POST
+#include "TelemetryOutbox.h"    // Replays the SD telemetry log in batched POSTs
+#if LOOP_PROFILER_ENABLED
+#include <WebServer.h>
+#include <StreamString.h>
+#endif
 
 // --- Configuration File --- (Moved to the top)
 // #include "config.h"
@@ -83,13 +94,27 @@ void printDebugStatus(const char* msg); // IMPORTANT: Used by many classes/funct
 // Config Portal functions (startConfigPortal, handleCaptivePortal, processor, handleFactoryReset) moved to ConfigPortalManager
 
 // Loop helper functions
-void handleNetworkConnection(unsigned long now);
-void handleApiDataFetching(unsigned long now);
+void handleNetworkEvent(const NetworkWorkerEvent& event);
+void handlePushMessage(MqttTopic topic, JsonDocument& doc);
+void registerLoopJobs(unsigned long now);
 void checkDataStalenessAndFailsafe(unsigned long now);
-void handleWebOverride(unsigned long now);
-void runMainOperationalBlock(unsigned long now);
-void checkSdCard(unsigned long now);
-void checkRtcSync(unsigned long now);
+void applyWebOverride();
+void handleSerialCommands();
+void printNetworkReport(Print& out);
+
+// Scheduled jobs (return false to be retried with the job's backoff)
+bool handleApiDataFetching(unsigned long now);
+bool applyThresholdsResponse(JsonVariantConst d);
+bool applyNodeDataResponse(JsonVariantConst d);
+bool applyDeviceStatusResponse(JsonVariantConst d);
+void markApiDataCurrent(const char* failsafeExitMsg);
+bool pollWebOverride(unsigned long now);
+bool runMainOperationalBlock(unsigned long now);
+void scheduleStatusFlush(unsigned long now);
+bool flushStatusUplink(unsigned long now);
+bool drainTelemetryOutbox(unsigned long now);
+bool checkSdCard(unsigned long now);
+bool checkRtcSync(unsigned long now);
 
 // --- Global Configuration and State Instances ---
 DeviceConfig deviceConfig; // Holds all persistent configuration
@@ -100,7 +125,9 @@ DeviceState deviceState;   // Holds all dynamic operational states
 // Preferences object is now encapsulated within DeviceConfig
 
 // --- Global Modem Instance (required by GPRSManager) ---
-TinyGsm modem(Serial1); // RX: GSM_RX, TX: GSM_TX (defined in config.h, used by Serial1.begin)
+// TinyGSM talks to the modem through modemAt, which GPRSManager also uses for its non-blocking status/attach commands.
+AtCommandEngine modemAt(Serial1); // RX: GSM_RX, TX: GSM_TX (defined in config.h, used by Serial1.begin)
+TinyGsm modem(modemAt);
 
 // Note: Individual global state variables (lastLoop, active_ssid, etc.) are now part of
 // deviceConfig and deviceState structs.
@@ -135,11 +162,22 @@ SensorDataManager sensorData;
 LCDDisplay lcd; // This is the single global LCD object.
 // MyNetworkManager* net = nullptr; // Replaced by NetworkFacade
 NetworkFacade* networkFacade = nullptr; // Global instance for the network facade
+NetworkWorker* networkWorker = nullptr; // Owns networkFacade once started at the end of setup()
 RTCManager* rtc_mgr = nullptr;
 RelayController relay(lcd); // Pass the global lcd object by reference.
 SDCardLogger sd_logger(&lcd); // SDCardLogger now manages its own 'ok' status internally
 ConfigPortalManager* configPortalMgr = nullptr; // Global instance for Config Portal Manager
-char globalDateTimeBuffer[20]; // Buffer for RTCManager::getDateTimeString
+char globalDateTimeBuffer[20]; // Buffer for RTCManager::formatInto
+JobScheduler scheduler;        // Periodic loop work; see registerLoopJobs()
+int8_t apiFetchJob = -1;       // Job ids re-run early after a reconnect
+int8_t statusPollJob = -1;
+StatusUplinkBatcher statusUplink; // Pending relay/failsafe changes for device_status_post_url
+int8_t statusFlushJob = -1;       // One-shot job sending statusUplink; -1 while none is scheduled
+TelemetryOutbox telemetryOutbox(sd_logger); // Acked position of the SD telemetry log replay
+int8_t outboxJob = -1;
+#if LOOP_PROFILER_ENABLED
+WebServer profileServer(LOOP_PROFILER_HTTP_PORT); // Serves GET /profile while profiling is compiled in
+#endif
 
 
 // ==================================================================================
@@ -148,6 +186,7 @@ char globalDateTimeBuffer[20]; // Buffer for RTCManager::getDateTimeString
 void printDebugStatus(const char* msg) {
     DEBUG_PRINTLN(3, msg);
     lcd.message(0, 0, msg, true); // 'lcd' is now the globally defined object
+    lcd.flush(); // Shows setup progress before loop() runs; one row fits the budget.
 }
 
 // loadConfiguration() and saveConfiguration() are removed.
@@ -183,15 +222,16 @@ void setup() {
     lcd.begin(); printDebugStatus("Setup Starting..."); esp_task_wdt_reset(); // lcd is global
     // loadConfiguration(); // Removed: DeviceConfig loads itself in its constructor.
     sd_logger.begin(); esp_task_wdt_reset(); // Use sd_logger
+    if (sd_logger.isSdCardOk()) Serial.printf("Boot: telemetry log restored in %lu us (%s)\n", sd_logger.getLogOpenMicros(), sd_logger.wasRestoredFromCheckpoint() ? "checkpoint" : "scan");
     relay.begin(); esp_task_wdt_reset();
 
     // Instantiate WiFiManager
-    auto wifiManager = std::unique_ptr<WiFiManager>(new WiFiManager(deviceConfig.ssid, deviceConfig.password, deviceConfig.api_token, &lcd));
+    auto wifiManager = std::unique_ptr<WiFiManager>(new WiFiManager(deviceConfig.ssid, deviceConfig.password, deviceConfig.api_token));
     esp_task_wdt_reset();
 
     // Instantiate GPRSManager
     // 'modem' is the global TinyGsm instance
-    auto gprsManager = std::unique_ptr<GPRSManager>(new GPRSManager(modem, deviceConfig.gprs_apn, deviceConfig.gprs_user, deviceConfig.gprs_password, deviceConfig.sim_pin, deviceConfig.api_token, &deviceState, &lcd));
+    auto gprsManager = std::unique_ptr<GPRSManager>(new GPRSManager(modem, modemAt, deviceConfig.gprs_apn, deviceConfig.gprs_user, deviceConfig.gprs_password, deviceConfig.sim_pin, deviceConfig.api_token, &deviceState));
     esp_task_wdt_reset();
 
     // Instantiate NetworkFacade, taking ownership of wifiManager and gprsManager
@@ -223,18 +263,23 @@ void setup() {
     }
     esp_task_wdt_reset();
 
-    // RTCManager now needs a NetworkInterface compatible reference.
-    // The NetworkFacade itself is a NetworkInterface.
-    rtc_mgr = new RTCManager(lcd, *networkFacade); // Pass NetworkFacade instance
+    // Network time reaches the RTC through the worker's TIME_EPOCH events; see checkRtcSync().
+    rtc_mgr = new RTCManager(lcd);
     if(!rtc_mgr){while(1){esp_task_wdt_reset();delay(1000);}} esp_task_wdt_reset();
-    rtc_mgr->begin(); if(rtc_mgr->isRtcOk() && networkFacade && networkFacade->isConnected())rtc_mgr->checkAndSyncOnDrift(); esp_task_wdt_reset();
+    rtc_mgr->begin(); esp_task_wdt_reset();
 
-    if(sd_logger.isSdCardOk()){if(sensorData.loadFromLog())printDebugStatus("Log Data Loaded");else printDebugStatus("Log Load Failed");}else printDebugStatus("No SD for Init");
+    // Requests submitted below are held in the worker's ring until begin() at the end of setup.
+    networkWorker = new NetworkWorker(*networkFacade, deviceConfig, deviceState);
+    if(!networkWorker){while(1){esp_task_wdt_reset();delay(1000);}}
+    networkWorker->setEventHandler(handleNetworkEvent);
+    networkWorker->setPushHandler(handlePushMessage);
+
+    if(sd_logger.isSdCardOk()){if(sensorData.loadFromLog(sd_logger))printDebugStatus("Log Data Loaded");else printDebugStatus("Log Load Failed");}else printDebugStatus("No SD for Init");
     esp_task_wdt_reset();
  
     if(networkFacade && networkFacade->isConnected()){
         // Fetch initial device statuses
-        networkFacade->startAsyncHttpRequest(deviceConfig.device_status_get_url, "GET", "DEV_ST_G_SETUP", nullptr,
+        networkWorker->submit(deviceConfig.device_status_get_url, "GET", "DEV_ST_G_SETUP", nullptr,
             [&](JsonDocument& doc) -> bool { // Capture deviceState by reference
             if (!doc["data"].isNull() && doc["data"].is<JsonObject>()) {
                 JsonObject data = doc["data"];
@@ -258,7 +303,7 @@ void setup() {
     if(networkFacade && networkFacade->isConnected()){
         printDebugStatus("Fetching initial API data (async)...");
         // Thresholds
-        networkFacade->startAsyncHttpRequest(deviceConfig.th_url, "GET", "TH_ASYNC_SETUP", nullptr,
+        networkWorker->submit(deviceConfig.th_url, "GET", "TH_ASYNC_SETUP", nullptr,
             [&](JsonDocument& d) -> bool { // Capture deviceState by reference
             if (d["data"].isNull() || !d["data"].is<JsonArray>()) { DEBUG_PRINTLN_F(1, F("Async TH_SETUP CB: Malformed JSON.")); return false; }
             JsonArray da = d["data"].as<JsonArray>();
@@ -280,7 +325,7 @@ void setup() {
         }, true);
         esp_task_wdt_reset();
         // Node Data
-        networkFacade->startAsyncHttpRequest(deviceConfig.nd_url, "GET", "ND_ASYNC_SETUP", nullptr,
+        networkWorker->submit(deviceConfig.nd_url, "GET", "ND_ASYNC_SETUP", nullptr,
             [&](JsonDocument& d) -> bool { // Capture deviceState by reference
             if (d["data"].isNull() || !d["data"].is<JsonObject>()) { DEBUG_PRINTLN_F(1, F("Async ND_SETUP CB: Malformed JSON.")); return false; }
             JsonObject o = d["data"];
@@ -295,16 +340,40 @@ void setup() {
     else printDebugStatus("No Net for initial API fetch");
     esp_task_wdt_reset();
 
-    // Initialize DeviceState timers
+    // Initialize DeviceState timers and the loop schedule
     unsigned long m = millis();
-    deviceState.lastLoopTime = m;
-    deviceState.lastApiAttemptTime = m - API_MS + 5000; // Allow first attempt soon
-    deviceState.lastTimeSyncTime = m;
-    deviceState.lastSdRetryTime = m;
     deviceState.lastConnectionRetryTime = m;
     deviceState.lastWiFiRetryWhenGprsTime = m;
-    deviceState.lastDeviceStatusCheckTime = m;
     // deviceState.currentConnectionRetryDelayMs is initialized in its constructor
+    registerLoopJobs(m);
+    statusUplink.begin(esp_random());
+
+    // From here on only the worker task touches networkFacade.
+    if (rtc_mgr->isRtcOk()) networkWorker->requestTimeSync(); // Served by the worker's first pass.
+    if (!networkWorker->begin()) printDebugStatus("Net worker start fail!");
+
+#if LIGHT_SLEEP_ENABLED
+    // Both loops block between deadlines, so the idle task can light-sleep until the next tick or event.
+    // WiFi keeps its association through modem sleep (the Arduino default) and holds a PM lock while active.
+    esp_pm_config_esp32_t pmConfig = {};
+    pmConfig.max_freq_mhz = LIGHT_SLEEP_MAX_FREQ_MHZ;
+    pmConfig.min_freq_mhz = LIGHT_SLEEP_MIN_FREQ_MHZ;
+    pmConfig.light_sleep_enable = true;
+    esp_err_t pmErr = esp_pm_configure(&pmConfig);
+    if (pmErr != ESP_OK) Serial.printf("Light sleep unavailable: %s\n", esp_err_to_name(pmErr));
+    else Serial.println(F("Automatic light sleep enabled."));
+#endif
+
+#if LOOP_PROFILER_ENABLED
+    loopProfiler.begin();
+    profileServer.on("/profile", HTTP_GET, []() {
+        StreamString body;
+        loopProfiler.writeJson(body);
+        profileServer.send(200, "application/json", body);
+        if (profileServer.hasArg("reset")) loopProfiler.reset();
+    });
+    profileServer.begin();
+#endif
 
     printDebugStatus("Setup Complete"); esp_task_wdt_reset();
 }
@@ -314,133 +383,195 @@ void setup() {
 // ==================================================================================
 void loop() {
     esp_task_wdt_reset();
-    if (!networkFacade || !rtc_mgr) {
-        printDebugStatus("FATAL: networkFacade or rtc_mgr null in loop!");
+    if (!networkWorker || !rtc_mgr) {
+        printDebugStatus("FATAL: networkWorker or rtc_mgr null in loop!");
         delay(1000); ESP.restart();
     }
 
+#if LOOP_PROFILER_ENABLED
+    uint32_t loopStart = LoopProfiler::now();
+    loopProfiler.noteWakeup();
+#endif
+    scheduler.noteWakeup();
     unsigned long now = millis();
 
-    // Update all ongoing asynchronous network operations
-    if (networkFacade) networkFacade->updateHttpOperations();
+    // Run callbacks for responses and status events posted by the network worker (never blocks)
+    LOOP_PROFILE(LoopStage::POLL_NETWORK, networkWorker->pollEvents());
+    applyWebOverride();
+    LOOP_PROFILE(LoopStage::FAILSAFE, checkDataStalenessAndFailsafe(now));
 
-    // Update GPRS Finite State Machine
-    if (networkFacade && networkFacade->getGPRSManager()) {
-        networkFacade->getGPRSManager()->updateFSM();
-    }
+    // Run whatever periodic work is due (see registerLoopJobs)
+    scheduler.runDue(now);
+    LOOP_PROFILE(LoopStage::SERIAL_CMDS, handleSerialCommands());
 
-    // Call helper functions
-    handleNetworkConnection(now);
-    handleApiDataFetching(now);
-    checkDataStalenessAndFailsafe(now);
-    handleWebOverride(now);
-    runMainOperationalBlock(now);
-    checkSdCard(now);
-    checkRtcSync(now);
-    
-    yield();
+    // Send what jobs and the network worker drew on the LCD; large repaints are spread over several passes.
+    lcd.flush();
+
+#if LOOP_PROFILER_ENABLED
+    loopProfiler.record(LoopStage::LOOP_TOTAL, loopStart);
+    profileServer.handleClient();
+#endif
+
+    // Block until the next deadline or a network event instead of spinning; the idle task runs meanwhile.
+    unsigned long wait = scheduler.msUntilNext(millis());
+    if (wait > LOOP_MAX_SLEEP_MS) wait = LOOP_MAX_SLEEP_MS; // Keeps serial commands responsive
+    if (lcd.isDirty() && wait > LCD_FLUSH_RETRY_MS) wait = LCD_FLUSH_RETRY_MS; // Finish a deferred repaint soon
+    networkWorker->waitForEvent(wait);
 }
 // ==================================================================================
 //   Loop Helper Function Definitions
 // ==================================================================================
 
-void handleNetworkConnection(unsigned long now) {
-    if (networkFacade && !networkFacade->isConnected() && (now - deviceState.lastConnectionRetryTime >= deviceState.currentConnectionRetryDelayMs)) {
-        deviceState.lastConnectionRetryTime = now;
-        printDebugStatus("Attempting network reconnect...");
-        if (networkFacade->connect()) { // Facade's connect handles preference
-            deviceState.currentConnectionRetryDelayMs = INITIAL_RETRY_DELAY_MS; // From config.h
-            DEBUG_PRINTF(3, "Net Reconnect OK: %s", networkFacade->getStatusString().c_str());
-            lcd.message(0,0, "Net Reconnect OK", true); // Simplified for LCD line 0
-            // lcd.message(0,1, networkFacade->getStatusString().c_str(), true); // Optionally display full status on next line if space
-            if (rtc_mgr && rtc_mgr->isRtcOk()) rtc_mgr->checkAndSyncOnDrift();
-        } else {
-            deviceState.currentConnectionRetryDelayMs *= 2;
-            if (deviceState.currentConnectionRetryDelayMs > MAX_RETRY_DELAY_MS) deviceState.currentConnectionRetryDelayMs = MAX_RETRY_DELAY_MS; // From config.h
-            printDebugStatus("Net Reconnect Wait...");
-        }
+// Handles non-HTTP events from the network worker. Runs on the control loop.
+void handleNetworkEvent(const NetworkWorkerEvent& event) {
+    switch (event.kind) {
+        case NetworkEventKind::STATUS_MESSAGE:
+            printDebugStatus(event.body);
+            break;
+        case NetworkEventKind::CONNECTED:
+            lcd.message(0,0, event.body, true);
+            // Refresh thresholds and overrides now rather than at the next interval
+            scheduler.runSoon(apiFetchJob, millis());
+            scheduler.runSoon(statusPollJob, millis());
+            scheduler.runSoon(statusFlushJob, millis()); // Send status changes held while offline
+            scheduler.runSoon(outboxJob, millis());      // Start replaying what was logged while offline
+            break;
+        case NetworkEventKind::HTTP_NOT_MODIFIED:
+            // The server confirmed our copy is current; it counts as fresh data for the failsafe timer.
+            if (strcmp(event.body, deviceConfig.th_url) == 0 || strcmp(event.body, deviceConfig.nd_url) == 0 ||
+                (deviceConfig.sync_url[0] != '\0' && strcmp(event.body, deviceConfig.sync_url) == 0)) {
+                markApiDataCurrent("Exited Failsafe (API data unchanged).");
+            }
+            break;
+        case NetworkEventKind::TIME_EPOCH:
+            if (rtc_mgr && rtc_mgr->isRtcOk() && rtc_mgr->applyNetworkEpoch(event.epoch, event.epochEdgeUs))
+                DEBUG_PRINTF(3, "RTC adjusted to network time: %lu\n", (unsigned long)event.epoch);
+            break;
+        default:
+            break;
     }
+}
 
-    // If GPRS is active, periodically try to switch back to WiFi if WiFi is preferred and available
-    if (networkFacade && networkFacade->getPreference() == NetworkFacade::NetworkPreference::WIFI_PREFERRED &&
-        networkFacade->getWiFiManager() != nullptr && 
-        networkFacade->getCurrentInterface() == networkFacade->getGPRSManager() &&
-        networkFacade->isConnected() && 
-        (now - deviceState.lastWiFiRetryWhenGprsTime >= deviceState.currentWiFiSwitchBackoffDelayMs)) { // Use backoff delay
-        deviceState.lastWiFiRetryWhenGprsTime = now;
-        DEBUG_PRINTF(3, "Attempting to switch back to WiFi (backoff: %lu ms)...", deviceState.currentWiFiSwitchBackoffDelayMs);
-        // lcd.message(0,1,"Try WiFi Switch...",true); // Optional brief LCD indicator
-        if (networkFacade->switchToWiFi()) {
-            DEBUG_PRINTF(3, "Switched to WiFi: %s", networkFacade->getStatusString().c_str());
-            lcd.message(0,0, "Switched to WiFi", true);
-            if (rtc_mgr && rtc_mgr->isRtcOk()) rtc_mgr->checkAndSyncOnDrift();
-            deviceState.currentWiFiSwitchBackoffDelayMs = WIFI_RETRY_WHEN_GPRS_MS; // Reset backoff on success
-        } else {
-            DEBUG_PRINTLN_F(2, F("Failed to switch back to WiFi, staying on GPRS. Increasing backoff."));
-            // lcd.message(0,1,"WiFi Switch Fail",true); // Optional brief LCD indicator
-            deviceState.currentWiFiSwitchBackoffDelayMs *= 2;
-            if (deviceState.currentWiFiSwitchBackoffDelayMs > MAX_WIFI_RETRY_WHEN_GPRS_MS) {
-                deviceState.currentWiFiSwitchBackoffDelayMs = MAX_WIFI_RETRY_WHEN_GPRS_MS;
-            }
-            DEBUG_PRINTF(3, "Next WiFi switch attempt in %lu ms.", deviceState.currentWiFiSwitchBackoffDelayMs);
-        }
+// Applies a message pushed over MQTT (see MqttManager.h). Payloads have the same shape as the
+// corresponding GET responses, so the HTTP handlers are reused.
+void handlePushMessage(MqttTopic topic, JsonDocument& doc) {
+    switch (topic) {
+        case MqttTopic::OVERRIDE:
+            applyDeviceStatusResponse(doc.as<JsonVariantConst>()); // Applied by applyWebOverride() right after pollEvents()
+            break;
+        case MqttTopic::THRESHOLDS:
+            applyThresholdsResponse(doc.as<JsonVariantConst>());
+            break;
     }
 }
 
-void handleApiDataFetching(unsigned long now) {
-    if (networkFacade && networkFacade->isConnected() && (now - deviceState.lastApiAttemptTime >= API_MS)) { // API_MS from config.h
-        deviceState.lastApiAttemptTime = now;
-        // Thresholds
-        bool th_initiated = networkFacade->startAsyncHttpRequest(deviceConfig.th_url, "GET", "TH_ASYNC_LP", nullptr,
-            [&](JsonDocument& d) -> bool { 
-            if (d["data"].isNull() || !d["data"].is<JsonArray>()) {
-                DEBUG_PRINTLN_F(1, F("Async TH LP CB: Malformed JSON - no data array."));
-                return false;
-            }
-            JsonArray da = d["data"].as<JsonArray>();
-            int fc = 0; float tMn = 0, tMx = 0, hMn = 0, hMx = 0, lMn = 0, lMx = 0;
-            for (JsonObject i : da) {
-                if (i["name"].isNull() || i["threshold_min"].isNull() || i["threshold_max"].isNull()) continue;
-                const char* n = i["name"];
-                float mn = atof(i["threshold_min"].as<const char*>());
-                float mx = atof(i["threshold_max"].as<const char*>());
-                if (strcmp(n, "Temperature") == 0) { tMn = mn; tMx = mx; fc++; }
-                else if (strcmp(n, "Humidity") == 0) { hMn = mn; hMx = mx; fc++; }
-                else if (strcmp(n, "Light Intensity") == 0) { lMn = mn; lMx = mx; fc++; }
-            }
-            if (fc < 3) {
-                 DEBUG_PRINTF(1, "Async TH LP CB: Failed to find all 3 thresholds. Found: %d\n", fc);
-                return false;
-            }
-            sensorData.updateThresholds(tMn, tMx, hMn, hMx, lMn, lMx);
-            DEBUG_PRINTLN_F(3, F("Async TH LP CB: Thresholds updated."));
-            deviceState.lastSuccessfulApiUpdateTime = millis();
-            if (deviceState.isInFailSafeMode) { deviceState.isInFailSafeMode = false; printDebugStatus("Exited Failsafe (API TH OK).");}
-            return true;
-        }, true);
+// Registers the periodic loop work. Each job returns false when it could not run (e.g. offline)
+// and is then retried with its own backoff instead of waiting a full interval.
+void registerLoopJobs(unsigned long now) {
+    apiFetchJob = scheduler.addPeriodic("api_fetch", API_MS, 5000, [](unsigned long t) {
+        bool ok; LOOP_PROFILE(LoopStage::API_FETCH, ok = handleApiDataFetching(t)); return ok;
+    }, now, API_FETCH_RETRY_MIN_MS, API_MS);
+    statusPollJob = scheduler.addPeriodic("status_poll", DEVICE_STATUS_CHECK_INTERVAL_MS, DEVICE_STATUS_CHECK_INTERVAL_MS, [](unsigned long t) {
+        bool ok; LOOP_PROFILE(LoopStage::WEB_OVERRIDE, ok = pollWebOverride(t)); return ok;
+    }, now);
+    scheduler.addPeriodic("control", LOOP_MS, 0, [](unsigned long t) {
+        bool ok; LOOP_PROFILE(LoopStage::MAIN_BLOCK, ok = runMainOperationalBlock(t)); return ok;
+    }, now);
+    scheduler.addPeriodic("sd_retry", SD_RETRY_INTERVAL_MS, SD_RETRY_INTERVAL_MS, [](unsigned long t) {
+        bool ok; LOOP_PROFILE(LoopStage::SD_CHECK, ok = checkSdCard(t)); return ok;
+    }, now, SD_RETRY_INTERVAL_MS, SD_RETRY_MAX_INTERVAL_MS);
+    scheduler.addPeriodic("rtc_sync", TIME_SYNC_CHECK_INTERVAL_MS, TIME_SYNC_CHECK_INTERVAL_MS, [](unsigned long t) {
+        bool ok; LOOP_PROFILE(LoopStage::RTC_SYNC, ok = checkRtcSync(t)); return ok;
+    }, now, TIME_SYNC_RETRY_MIN_MS, TIME_SYNC_RETRY_MAX_MS);
+    if (deviceConfig.telemetry_url[0] != '\0') {
+        outboxJob = scheduler.addPeriodic("outbox", TELEMETRY_OUTBOX_CHECK_MS, TELEMETRY_OUTBOX_CHECK_MS, drainTelemetryOutbox,
+                                          now, TELEMETRY_OUTBOX_CHECK_MS, TELEMETRY_OUTBOX_RETRY_MAX_MS);
+    }
+}
 
-        // Node Data
-        bool nd_initiated = networkFacade->startAsyncHttpRequest(deviceConfig.nd_url, "GET", "ND_ASYNC_LP", nullptr,
-            [&](JsonDocument& d) -> bool { 
-            if (d["data"].isNull() || !d["data"].is<JsonObject>()) {
-                DEBUG_PRINTLN_F(1, F("Async ND LP CB: Malformed JSON - no data object."));
-                return false;
-            }
-            JsonObject o = d["data"];
-            if (o["temperature"].isNull() || o["humidity"].isNull() || o["light_intensity"].isNull()) {
-                DEBUG_PRINTLN_F(1, F("Async ND LP CB: JSON missing sensor fields."));
-                return false;
-            }
-            sensorData.updateData(o["temperature"].as<float>(), o["humidity"].as<float>(), o["light_intensity"].as<float>());
-            DEBUG_PRINTLN_F(3, F("Async ND LP CB: Node data updated."));
-            deviceState.lastSuccessfulApiUpdateTime = millis();
-            if (deviceState.isInFailSafeMode) { deviceState.isInFailSafeMode = false; printDebugStatus("Exited Failsafe (API ND OK).");}
-            return true;
-        }, true);
+// Applies a threshold response ({"data": [{name, threshold_min, threshold_max}, ...]}).
+bool applyThresholdsResponse(JsonVariantConst d) {
+    if (d["data"].isNull() || !d["data"].is<JsonArrayConst>()) {
+        DEBUG_PRINTLN_F(1, F("Async TH LP CB: Malformed JSON - no data array."));
+        return false;
+    }
+    JsonArrayConst da = d["data"].as<JsonArrayConst>();
+    int fc = 0; float tMn = 0, tMx = 0, hMn = 0, hMx = 0, lMn = 0, lMx = 0;
+    for (JsonObjectConst i : da) {
+        if (i["name"].isNull() || i["threshold_min"].isNull() || i["threshold_max"].isNull()) continue;
+        const char* n = i["name"];
+        float mn = atof(i["threshold_min"].as<const char*>());
+        float mx = atof(i["threshold_max"].as<const char*>());
+        if (strcmp(n, "Temperature") == 0) { tMn = mn; tMx = mx; fc++; }
+        else if (strcmp(n, "Humidity") == 0) { hMn = mn; hMx = mx; fc++; }
+        else if (strcmp(n, "Light Intensity") == 0) { lMn = mn; lMx = mx; fc++; }
+    }
+    if (fc < 3) {
+         DEBUG_PRINTF(1, "Async TH LP CB: Failed to find all 3 thresholds. Found: %d\n", fc);
+        return false;
+    }
+    sensorData.updateThresholds(tMn, tMx, hMn, hMx, lMn, lMx);
+    DEBUG_PRINTLN_F(3, F("Async TH LP CB: Thresholds updated."));
+    markApiDataCurrent("Exited Failsafe (API TH OK).");
+    return true;
+}
 
-        if (th_initiated) DEBUG_PRINTLN(3, "Async Threshold fetch (loop) initiated.");
-        if (nd_initiated) DEBUG_PRINTLN(3, "Async Node Data fetch (loop) initiated.");
+// Applies a node data response ({"data": {temperature, humidity, light_intensity}}).
+bool applyNodeDataResponse(JsonVariantConst d) {
+    if (d["data"].isNull() || !d["data"].is<JsonObjectConst>()) {
+        DEBUG_PRINTLN_F(1, F("Async ND LP CB: Malformed JSON - no data object."));
+        return false;
     }
+    JsonObjectConst o = d["data"];
+    if (o["temperature"].isNull() || o["humidity"].isNull() || o["light_intensity"].isNull()) {
+        DEBUG_PRINTLN_F(1, F("Async ND LP CB: JSON missing sensor fields."));
+        return false;
+    }
+    sensorData.updateData(o["temperature"].as<float>(), o["humidity"].as<float>(), o["light_intensity"].as<float>());
+    DEBUG_PRINTLN_F(3, F("Async ND LP CB: Node data updated."));
+    markApiDataCurrent("Exited Failsafe (API ND OK).");
+    return true;
+}
+
+// Records that the API data held in sensorData is current, either freshly parsed or confirmed by a 304.
+void markApiDataCurrent(const char* failsafeExitMsg) {
+    deviceState.lastSuccessfulApiUpdateTime = millis();
+    if (deviceState.isInFailSafeMode) {
+        deviceState.isInFailSafeMode = false;
+        printDebugStatus(failsafeExitMsg);
+        statusUplink.noteFailsafe(false);
+        scheduleStatusFlush(millis());
+    }
+}
+
+bool handleApiDataFetching(unsigned long now) {
+    if (!networkWorker->isConnected()) return false;
+    {
+        if (deviceConfig.sync_url[0] != '\0') {
+            // Combined endpoint: thresholds and node data in one round trip (and one 304 when neither changed).
+            bool sync_initiated = networkWorker->submit(deviceConfig.sync_url, "GET", "SYNC_ASYNC_LP", nullptr,
+                [&](JsonDocument& d) -> bool {
+                bool thOk = applyThresholdsResponse(d["thresholds"].as<JsonVariantConst>());
+                bool ndOk = applyNodeDataResponse(d["node_data"].as<JsonVariantConst>());
+                return thOk && ndOk;
+            }, true);
+            if (sync_initiated) DEBUG_PRINTLN(3, "Async sync fetch (loop) initiated.");
+        } else {
+            // Thresholds
+            bool th_initiated = networkWorker->submit(deviceConfig.th_url, "GET", "TH_ASYNC_LP", nullptr,
+                [&](JsonDocument& d) -> bool { return applyThresholdsResponse(d.as<JsonVariantConst>()); }, true);
+
+            // Node Data
+            bool nd_initiated = networkWorker->submit(deviceConfig.nd_url, "GET", "ND_ASYNC_LP", nullptr,
+                [&](JsonDocument& d) -> bool { return applyNodeDataResponse(d.as<JsonVariantConst>()); }, true);
+
+            if (th_initiated) DEBUG_PRINTLN(3, "Async Threshold fetch (loop) initiated.");
+            if (nd_initiated) DEBUG_PRINTLN(3, "Async Node Data fetch (loop) initiated.");
+        }
+
+        if (DEBUG_LEVEL >= 3) printNetworkReport(Serial);
+    }
+    return true;
 }
 
 void checkDataStalenessAndFailsafe(unsigned long now) {
@@ -454,29 +585,38 @@ void checkDataStalenessAndFailsafe(unsigned long now) {
         deviceState.isInFailSafeMode = true;
         relay.forceSafeState();
         printDebugStatus("FAILSAFE Active!");
+        statusUplink.noteFailsafe(true);
+        scheduleStatusFlush(now);
     }
 }
 
-void handleWebOverride(unsigned long now) {
+// Applies a device status response ({"data": {exhaust_status, dehumidifier_status, blower_status}}) as web override targets.
+bool applyDeviceStatusResponse(JsonVariantConst d) {
+    if (!d["data"].isNull() && d["data"].is<JsonObjectConst>()) {
+        JsonObjectConst data = d["data"];
+        if (!data["exhaust_status"].isNull() && !data["dehumidifier_status"].isNull() && !data["blower_status"].isNull()) {
+            deviceState.web_exhaust_target_state = atoi(data["exhaust_status"].as<const char*>()) == 1;
+            deviceState.web_dehumidifier_target_state = atoi(data["dehumidifier_status"].as<const char*>()) == 1;
+            deviceState.web_blower_target_state = atoi(data["blower_status"].as<const char*>()) == 1;
+            DEBUG_PRINTLN_F(3, F("Async DEV_ST_G LP CB: Web statuses updated."));
+            return true;
+        } else { DEBUG_PRINTLN_F(1, F("Async DEV_ST_G LP CB: JSON missing status fields.")); }
+    } else { DEBUG_PRINTLN_F(1, F("Async DEV_ST_G LP CB: Malformed JSON.")); }
+    return false;
+}
+
+bool pollWebOverride(unsigned long now) {
+    // Overrides are pushed while the MQTT session is up; polling resumes as soon as it drops.
+    if (networkWorker->isPushConnected()) return true;
     // Fetch web override status
-    if (networkFacade && networkFacade->isConnected() && (now - deviceState.lastDeviceStatusCheckTime >= DEVICE_STATUS_CHECK_INTERVAL_MS)) { // From config.h
-        deviceState.lastDeviceStatusCheckTime = now;
-        networkFacade->startAsyncHttpRequest(deviceConfig.device_status_get_url, "GET", "DEV_ST_G_LP_ASYNC", nullptr,
-            [&](JsonDocument& doc) -> bool { 
-            if (!doc["data"].isNull() && doc["data"].is<JsonObject>()) {
-                JsonObject data = doc["data"];
-                if (!data["exhaust_status"].isNull() && !data["dehumidifier_status"].isNull() && !data["blower_status"].isNull()) {
-                    deviceState.web_exhaust_target_state = atoi(data["exhaust_status"].as<const char*>()) == 1;
-                    deviceState.web_dehumidifier_target_state = atoi(data["dehumidifier_status"].as<const char*>()) == 1;
-                    deviceState.web_blower_target_state = atoi(data["blower_status"].as<const char*>()) == 1;
-                    DEBUG_PRINTLN_F(3, F("Async DEV_ST_G LP CB: Web statuses updated."));
-                    return true;
-                } else { DEBUG_PRINTLN_F(1, F("Async DEV_ST_G LP CB: JSON missing status fields.")); }
-            } else { DEBUG_PRINTLN_F(1, F("Async DEV_ST_G LP CB: Malformed JSON.")); }
-            return false;
-        }, true);
-    }
+    if (!networkWorker->isConnected()) return false;
+    return networkWorker->submit(deviceConfig.device_status_get_url, "GET", "DEV_ST_G_LP_ASYNC", nullptr,
+        [&](JsonDocument& doc) -> bool { return applyDeviceStatusResponse(doc.as<JsonVariantConst>()); },
+        true, HttpRequestPriority::URGENT);
+}
 
+// Applies manual override targets changed by the status poll callback.
+void applyWebOverride() {
     // Apply web override if state changed
     if (deviceState.web_exhaust_target_state != deviceState.last_web_exhaust_target_state) {
         relay.setManualOverride(0, deviceState.web_exhaust_target_state, MANUAL_OVERRIDE_DURATION_MS); // From config.h
@@ -495,107 +635,221 @@ void handleWebOverride(unsigned long now) {
     }
 }
 
-void runMainOperationalBlock(unsigned long now) {
+bool runMainOperationalBlock(unsigned long now) {
     // Determine if data is stale for display purposes before the main operational block
     bool isDataStaleForDisplay = false;
     if (deviceState.lastSuccessfulApiUpdateTime == 0 && millis() > STALE_DATA_THRESHOLD_MS) isDataStaleForDisplay = true;
     else if (deviceState.lastSuccessfulApiUpdateTime > 0 && (now - deviceState.lastSuccessfulApiUpdateTime > STALE_DATA_THRESHOLD_MS)) isDataStaleForDisplay = true;
 
-    if (now - deviceState.lastLoopTime >= LOOP_MS) { // LOOP_MS from config.h
-        deviceState.lastLoopTime = now;
-        if (rtc_mgr && rtc_mgr->isRtcOk()) {
-            String dt_str = rtc_mgr->getFormattedDateTime();
-            strncpy(globalDateTimeBuffer, dt_str.c_str(), sizeof(globalDateTimeBuffer) - 1);
-            globalDateTimeBuffer[sizeof(globalDateTimeBuffer) - 1] = '\0'; // Ensure null termination
-        }
+    if (rtc_mgr && rtc_mgr->isRtcOk()) {
+        rtc_mgr->reanchorIfDue(); // One DS3231 read per RTC_REANCHOR_INTERVAL_MS; otherwise time is extrapolated.
+        rtc_mgr->formatInto(globalDateTimeBuffer, sizeof(globalDateTimeBuffer));
+    }
 
-        if (!deviceState.isInFailSafeMode) {
-            bool r1c = relay.updateSingleRelayState(0, sensorData.humidity, sensorData.getHumMin(), sensorData.getHumMax(), sensorData.temperature, sensorData.getTempMin(), sensorData.getTempMax());
-            bool r2c = relay.updateSingleRelayState(1, sensorData.humidity, sensorData.getHumMin(), sensorData.getHumMax(), sensorData.temperature, sensorData.getTempMin(), sensorData.getTempMax());
-            bool r3c = relay.updateSingleRelayState(2, sensorData.humidity, sensorData.getHumMin(), sensorData.getHumMax(), sensorData.temperature, sensorData.getTempMin(), sensorData.getTempMax());
-            relay.ensureRelay4Off();
-
-            if (networkFacade && networkFacade->isConnected()) {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
-                StaticJsonDocument<JSON_DOC_SIZE_STATUS_POST> postJsonDocLocal;
-#pragma GCC diagnostic pop
-                char payloadBuffer[JSON_DOC_SIZE_STATUS_POST];
-                if (r1c) {
-                    postJsonDocLocal.clear(); postJsonDocLocal["gh_id"] = deviceConfig.gh_id; postJsonDocLocal["exhaust_status"] = relay.getR1() ? 1 : 0;
-                    serializeJson(postJsonDocLocal, payloadBuffer, sizeof(payloadBuffer));
-                    networkFacade->startAsyncHttpRequest(deviceConfig.device_status_post_url, "POST", "EXH_ST_P_LP", payloadBuffer, nullptr, true);
-                }
-                if (r2c) {
-                    postJsonDocLocal.clear(); postJsonDocLocal["gh_id"] = deviceConfig.gh_id; postJsonDocLocal["dehumidifier_status"] = relay.getR2() ? 1 : 0;
-                    serializeJson(postJsonDocLocal, payloadBuffer, sizeof(payloadBuffer));
-                    networkFacade->startAsyncHttpRequest(deviceConfig.device_status_post_url, "POST", "DEH_ST_P_LP", payloadBuffer, nullptr, true);
-                }
-                if (r3c) {
-                    postJsonDocLocal.clear(); postJsonDocLocal["gh_id"] = deviceConfig.gh_id; postJsonDocLocal["blower_status"] = relay.getR3() ? 1 : 0;
-                    serializeJson(postJsonDocLocal, payloadBuffer, sizeof(payloadBuffer));
-                    networkFacade->startAsyncHttpRequest(deviceConfig.device_status_post_url, "POST", "BLW_ST_P_LP", payloadBuffer, nullptr, true);
-                }
-            }
-        } else {
-            relay.forceSafeState();
+    if (!deviceState.isInFailSafeMode) {
+        bool r1c = relay.updateSingleRelayState(0, sensorData.humidity, sensorData.getHumMin(), sensorData.getHumMax(), sensorData.temperature, sensorData.getTempMin(), sensorData.getTempMax());
+        bool r2c = relay.updateSingleRelayState(1, sensorData.humidity, sensorData.getHumMin(), sensorData.getHumMax(), sensorData.temperature, sensorData.getTempMin(), sensorData.getTempMax());
+        bool r3c = relay.updateSingleRelayState(2, sensorData.humidity, sensorData.getHumMin(), sensorData.getHumMax(), sensorData.temperature, sensorData.getTempMin(), sensorData.getTempMax());
+        relay.ensureRelay4Off();
+
+        // Changed relays go out together in one batched POST (see flushStatusUplink).
+        if (r1c) statusUplink.noteRelay(0, relay.getR1());
+        if (r2c) statusUplink.noteRelay(1, relay.getR2());
+        if (r3c) statusUplink.noteRelay(2, relay.getR3());
+        if (statusUplink.hasPending()) {
+            statusUplink.noteSensors(sensorData.temperature, sensorData.humidity, sensorData.light);
+            scheduleStatusFlush(now);
         }
+    } else {
+        relay.forceSafeState();
+    }
 
-        if (rtc_mgr) {
-             lcd.update(globalDateTimeBuffer, sensorData.temperature, sensorData.humidity, sensorData.light, relay.getR1(), relay.getR2(), relay.getR3(), relay.getR4(), sensorData.getTempMin(), sensorData.getTempMax(), sensorData.getHumMin(), sensorData.getHumMax(), sensorData.getLightMin(), sensorData.getLightMax(), (networkFacade ? networkFacade->isConnected() : false), isDataStaleForDisplay, sd_logger.isSdCardOk(), deviceState.isInFailSafeMode);
+    if (rtc_mgr) {
+         lcd.update(globalDateTimeBuffer, sensorData.temperature, sensorData.humidity, sensorData.light, relay.getR1(), relay.getR2(), relay.getR3(), relay.getR4(), sensorData.getTempMin(), sensorData.getTempMax(), sensorData.getHumMin(), sensorData.getHumMax(), sensorData.getLightMin(), sensorData.getLightMax(), networkWorker->isConnected(), isDataStaleForDisplay, sd_logger.isSdCardOk(), deviceState.isInFailSafeMode);
 
-            if (sd_logger.isSdCardOk() && rtc_mgr->isRtcOk() && (globalDateTimeBuffer[0] != 'Y' && globalDateTimeBuffer[0] != '\0')) // Check for valid time string
-                sd_logger.logData(globalDateTimeBuffer, sensorData.temperature, sensorData.humidity, sensorData.light, sensorData.getTempMin(), sensorData.getTempMax(), sensorData.getHumMin(), sensorData.getHumMax(), sensorData.getLightMin(), sensorData.getLightMax(), relay.getR1(), relay.getR2(), relay.getR3(), relay.getR4());
-        }
+        if (sd_logger.isSdCardOk() && rtc_mgr->isRtcOk() && (globalDateTimeBuffer[0] != 'Y' && globalDateTimeBuffer[0] != '\0')) // Check for valid time string
+            sd_logger.logData(rtc_mgr->epoch(), sensorData.temperature, sensorData.humidity, sensorData.light, sensorData.getTempMin(), sensorData.getTempMax(), sensorData.getHumMin(), sensorData.getHumMax(), sensorData.getLightMin(), sensorData.getLightMax(), relay.getR1(), relay.getR2(), relay.getR3(), relay.getR4());
     }
+    return true;
 }
 
-void checkSdCard(unsigned long now) {
-    if (!sd_logger.isSdCardOk() && (now - deviceState.lastSdRetryTime >= SD_RETRY_INTERVAL_MS)) { // From config.h
-        deviceState.lastSdRetryTime = now;
-        printDebugStatus("Retrying SD...");
-        // sd_logger.reInit() will update its internal _sdCardOk status
-        if (sd_logger.reInit()) DEBUG_PRINTLN(2, "SD re-init OK");
-        else DEBUG_PRINTLN(1, "SD re-init Fail");
+// Schedules the batched status POST STATUS_UPLINK_MAX_LATENCY_MS out, unless a flush is already pending.
+// Changes noted before it runs are merged into the same batch.
+void scheduleStatusFlush(unsigned long now) {
+    if (statusFlushJob >= 0 || !statusUplink.hasPending()) return;
+    statusFlushJob = scheduler.addOneShot("status_flush", STATUS_UPLINK_MAX_LATENCY_MS, flushStatusUplink, now,
+                                          STATUS_UPLINK_RETRY_MIN_MS, STATUS_UPLINK_RETRY_MAX_MS);
+    if (statusFlushJob < 0) DEBUG_PRINTLN(1, "Status uplink: scheduler full, batch held until next change.");
+}
+
+// Sends the pending status changes as one POST. Returns false (retried with backoff, same seq) when it
+// cannot be queued; the batch is kept so nothing noted while offline is lost.
+bool flushStatusUplink(unsigned long now) {
+    char payloadBuffer[JSON_DOC_SIZE_STATUS_POST];
+    size_t len = statusUplink.buildPayload(deviceConfig.gh_id, payloadBuffer, sizeof(payloadBuffer));
+    if (len == 0) { statusFlushJob = -1; return true; } // Nothing pending (or unserializable; already logged).
+    if (!networkWorker->isConnected() ||
+        !networkWorker->submit(deviceConfig.device_status_post_url, "POST", "STATUS_BATCH_P", payloadBuffer, nullptr, true, HttpRequestPriority::URGENT)) {
+        statusUplink.markDeferred();
+        return false;
     }
+    statusUplink.markSent();
+    DEBUG_PRINTF(3, "Status uplink: batch seq %lu sent.\n", (unsigned long)statusUplink.getSequence());
+    statusFlushJob = -1;
+    return true;
+}
+
+// Sends the next batch of logged telemetry the endpoint has not acknowledged yet (see TelemetryOutbox.h).
+// Records are logged whether or not a link is up; this replays them once one is. Returns false while offline.
+bool drainTelemetryOutbox(unsigned long now) {
+    if (!networkWorker->isConnected()) return false;
+    if (!networkWorker->isBulkBufferFree() || !telemetryOutbox.isDue(now, networkWorker->isOnWiFi())) return true;
+
+    static char body[HTTP_BULK_PAYLOAD_MAX_LEN]; // Off the loop task stack; submit() copies it.
+    uint32_t lastSeq = 0;
+    uint16_t rows = 0;
+    size_t len = telemetryOutbox.buildBatch(deviceConfig.gh_id, body, sizeof(body), lastSeq, rows);
+    if (len == 0) return true;
+    bool submitted = networkWorker->submit(deviceConfig.telemetry_url, "POST", "TLM_BATCH_P", body,
+        [lastSeq](JsonDocument& d) -> bool {
+            // Only runs for a 2xx reply. The server may store only part of a batch; anything after its acked_seq is sent again.
+            uint32_t acked = d["acked_seq"].isNull() ? lastSeq : d["acked_seq"].as<uint32_t>();
+            telemetryOutbox.onAck(acked < lastSeq ? acked : lastSeq);
+            // WiFi drains a backlog back to back; GPRS waits TELEMETRY_OUTBOX_GPRS_MIN_GAP_MS between batches.
+            if (telemetryOutbox.getPending() > 0 && networkWorker->isOnWiFi()) scheduler.runSoon(outboxJob, millis());
+            return true;
+        }, true, HttpRequestPriority::BACKGROUND);
+    if (!submitted) return false;
+    telemetryOutbox.markSubmitted(lastSeq, rows, len, now);
+    return true;
 }
 
-void checkRtcSync(unsigned long now) {
-    if (rtc_mgr && rtc_mgr->isRtcOk() && networkFacade && networkFacade->isConnected() && (now - deviceState.lastTimeSyncTime >= TIME_SYNC_INTERVAL)) { // From config.h
-        deviceState.lastTimeSyncTime = now;
-        NetworkInterface* currentNetIF = networkFacade->getCurrentInterface();
-        WiFiManager* wifiMgr = networkFacade->getWiFiManager();
-
-        bool isCurrentWiFi = (wifiMgr && currentNetIF == wifiMgr && wifiMgr->isConnected());
-
-        if (isCurrentWiFi) {
-            if (!rtc_mgr->syncNTP()) { 
-                DEBUG_PRINTLN(2, "NTP Sync failed, attempting HTTP time sync (async).");
-                networkFacade->startAsyncHttpRequest(deviceConfig.worldtime_url, "GET", "WT_ASYNC_LP_WIFI", nullptr,
-                [&](JsonDocument& d) { 
-                    if (!d["unixtime"].isNull() && d["unixtime"].is<uint32_t>()) {
-                        uint32_t epoch = d["unixtime"].as<uint32_t>();
-                        if(rtc_mgr) rtc_mgr->adjustTime(epoch); 
-                        DEBUG_PRINTF(3, "Async WT LP CB (WiFi): Epoch fetched & RTC adjusted: %lu\n", epoch);
-                        return true;
-                    }
-                    DEBUG_PRINTLN_F(1, F("Async WT LP CB (WiFi): Failed to parse unixtime."));
-                    return false;
-                }, false);
+bool checkSdCard(unsigned long now) {
+    if (sd_logger.isSdCardOk()) return true;
+    printDebugStatus("Retrying SD...");
+    // sd_logger.reInit() will update its internal _sdCardOk status
+    if (sd_logger.reInit()) { DEBUG_PRINTLN(2, "SD re-init OK"); return true; }
+    DEBUG_PRINTLN(1, "SD re-init Fail");
+    return false;
+}
+
+bool checkRtcSync(unsigned long now) {
+    if (!(rtc_mgr && rtc_mgr->isRtcOk())) return false;
+    if (!rtc_mgr->isSyncDue(now)) return true; // The interval grows once the RTC's drift rate is known.
+    if (!networkWorker->isConnected()) return false;
+    // The worker tries SNTP on WiFi and falls back to the HTTP time API; the epoch comes back as a TIME_EPOCH event.
+    networkWorker->requestTimeSync();
+    return true;
+}
+
+// Prints the HTTP queue, keep-alive, WiFi connect, failover and conditional request (304) counters published by the network worker,
+// plus the batched status uplink, telemetry replay and MQTT push counters.
+void printNetworkReport(Print& out) {
+    HttpRequestQueue::Stats qs = networkWorker->getRequestQueueStats();
+    out.printf("HTTP queue: depth %u (peak %u), dispatched %lu, requeued %lu, dropped %lu, wait last/max %lu/%lu ms\n",
+               qs.depth, qs.highWaterMark, (unsigned long)qs.dispatched, (unsigned long)qs.requeued, (unsigned long)qs.dropped,
+               qs.lastWaitMs, qs.maxWaitMs);
+    HttpConnectionPool::Stats cs = networkWorker->getConnectionStats(networkWorker->isOnWiFi());
+    out.printf("HTTP conns: %lu/%lu reused, %lu handshakes (last/avg/max %lu/%lu/%lu ms), %lu stale, %lu server closes\n",
+               (unsigned long)cs.reused, (unsigned long)cs.requests, (unsigned long)cs.handshakes, cs.lastHandshakeMs,
+               cs.handshakes ? cs.totalHandshakeMs / cs.handshakes : 0UL, cs.maxHandshakeMs,
+               (unsigned long)cs.staleReconnects, (unsigned long)cs.serverCloses);
+    WiFiManager::ConnectStats ws = networkWorker->getWiFiConnectStats();
+    out.printf("WiFi connect: %lu/%lu fast (%lu fell back to scan), %lu failed; time-to-IP last/avg/max %lu/%lu/%lu ms\n",
+               (unsigned long)ws.fastConnects, (unsigned long)ws.connects, (unsigned long)ws.fastFallbacks,
+               (unsigned long)ws.failures, ws.lastTimeToIpMs, ws.connects ? ws.totalTimeToIpMs / ws.connects : 0UL,
+               ws.maxTimeToIpMs);
+    NetworkFacade::FailoverStats fs = networkWorker->getFailoverStats();
+    out.printf("Failover: %lu to warm GPRS, %lu cold, %lu requests re-issued; switch last/max %lu/%lu ms, first reply last/max %lu/%lu ms\n",
+               (unsigned long)fs.failovers, (unsigned long)fs.coldFailovers, (unsigned long)fs.reissued,
+               fs.lastSwitchMs, fs.maxSwitchMs, fs.lastRecoveryMs, fs.maxRecoveryMs);
+    HttpValidatorCache::Stats vs = networkWorker->getValidatorStats();
+    out.printf("HTTP 304: %lu/%lu conditional, saved %lu B / %lu ms total; GPRS last hour %lu B / %lu ms\n",
+               (unsigned long)vs.notModified, (unsigned long)vs.conditionalSent, (unsigned long)vs.bytesSaved,
+               (unsigned long)(vs.parseUsSaved / 1000), (unsigned long)vs.gprsBytesSavedLastHour,
+               (unsigned long)(vs.gprsParseUsSavedLastHour / 1000));
+    const StatusUplinkBatcher::Stats& us = statusUplink.getStats();
+    out.printf("Status uplink: %lu changes in %lu POSTs (seq %lu), %lu deferred, %s\n",
+               (unsigned long)us.changes, (unsigned long)us.batches, (unsigned long)statusUplink.getSequence(),
+               (unsigned long)us.retries, statusUplink.hasPending() ? "pending" : "idle");
+    if (deviceConfig.telemetry_url[0] != '\0') {
+        const TelemetryOutbox::Stats& ts = telemetryOutbox.getStats();
+        out.printf("Telemetry outbox: %lu pending after seq %lu; %lu records in %lu POSTs (%lu B), %lu acks, %lu ack timeouts\n",
+                   (unsigned long)telemetryOutbox.getPending(), (unsigned long)telemetryOutbox.getAckedSeq(),
+                   (unsigned long)ts.recordsSent, (unsigned long)ts.batches, (unsigned long)ts.bytesSent,
+                   (unsigned long)ts.acks, (unsigned long)ts.ackTimeouts);
+    }
+    if (deviceConfig.mqtt_host[0] != '\0') {
+        MqttManager::Stats ms = networkWorker->getPushStats();
+        out.printf("MQTT push: %s; %lu sessions, %lu connect failures, %lu messages, %lu refused\n",
+                   networkWorker->isPushConnected() ? "up" : "down (polling)", (unsigned long)ms.connects,
+                   (unsigned long)ms.connectFailures, (unsigned long)ms.messages, (unsigned long)ms.refused);
+    }
+}
+
+// Reads newline-terminated maintenance commands from Serial without blocking.
+// "export" writes the binary telemetry log to TELEMETRY_CSV_EXPORT_PATH as CSV.
+// "sched" prints the loop jobs and wakeup count.
+// "net" prints HTTP queue, keep-alive, conditional request (304) and push counters.
+// "lcd" prints LCD frame buffer rendering counters.
+// "rtc" prints the extrapolated clock and its drift against the RTC.
+// "profile" / "profile reset" print / clear loop stage timings (LOOP_PROFILER_ENABLED builds).
+void handleSerialCommands() {
+    static char cmd[32];
+    static uint8_t len = 0;
+    while (Serial.available()) {
+        char c = Serial.read();
+        if (c != '\n' && c != '\r') {
+            if (len < sizeof(cmd) - 1) cmd[len++] = c;
+            continue;
+        }
+        if (len == 0) continue;
+        cmd[len] = '\0';
+        len = 0;
+
+        if (strcmp(cmd, "export") == 0) {
+            int32_t n = sd_logger.exportCsv(TELEMETRY_CSV_EXPORT_PATH);
+            if (n >= 0) Serial.printf("Exported %ld records to %s\n", (long)n, TELEMETRY_CSV_EXPORT_PATH);
+            else Serial.println(F("Export failed (SD or telemetry log not ready)."));
+        } else if (strcmp(cmd, "sched") == 0) {
+            scheduler.printReport(Serial, millis());
+        } else if (strcmp(cmd, "net") == 0) {
+            printNetworkReport(Serial);
+        } else if (strcmp(cmd, "rtc") == 0) {
+            if (rtc_mgr && rtc_mgr->isRtcOk()) {
+                char dt[20];
+                rtc_mgr->formatInto(dt, sizeof(dt));
+                RTCManager::ClockStats rs = rtc_mgr->getClockStats();
+                Serial.printf("RTC: %s; %lu/%lu checks corrected (last %ld us) over %lu s, drift ~%.1f ppm\n", dt,
+                              (unsigned long)rs.corrections, (unsigned long)rs.checks, (long)rs.lastCorrectionUs,
+                              (unsigned long)rs.sinceAnchorS, rs.driftPpm);
+                RTCManager::SyncStats ss = rtc_mgr->getSyncStats();
+                Serial.printf("RTC sync: %lu samples, %lu adjustments, last offset %ld ms, RTC drift %s%.2f ppm, next in %lu h\n",
+                              (unsigned long)ss.samples, (unsigned long)ss.adjustments, (long)ss.lastOffsetMs,
+                              ss.driftKnown ? "" : "unknown ", ss.driftPpm, ss.intervalMs / 3600000UL);
+                SntpClient::Stats ns = networkWorker->getSntpStats();
+                Serial.printf("SNTP: %lu/%lu rounds synced, %lu replies, %lu rejected, %lu timeouts, %lu DNS failures, last rtt %lu us (%s)\n",
+                              (unsigned long)ns.synced, (unsigned long)ns.rounds, (unsigned long)ns.replies,
+                              (unsigned long)ns.rejected, (unsigned long)ns.timeouts, (unsigned long)ns.dnsFailures,
+                              (unsigned long)ns.lastRttUs, SNTP_SERVERS[ns.lastServer]);
+            } else {
+                Serial.println(F("RTC not available."));
             }
-        } else if (currentNetIF && currentNetIF->isConnected()) { 
-            DEBUG_PRINTLN(2, "GPRS/Other active, attempting NITZ/HTTP time sync (async).");
-            networkFacade->startAsyncHttpRequest(deviceConfig.worldtime_url, "GET", "WT_ASYNC_LP_GPRS", nullptr,
-            [&](JsonDocument& d) { 
-                if (!d["unixtime"].isNull() && d["unixtime"].is<uint32_t>()) {
-                    uint32_t epoch = d["unixtime"].as<uint32_t>();
-                    if(rtc_mgr) rtc_mgr->adjustTime(epoch); 
-                    DEBUG_PRINTF(3, "Async WT LP CB (GPRS/Other): Epoch fetched & RTC adjusted: %lu\n", epoch);
-                    return true;
-                }
-                DEBUG_PRINTLN_F(1, F("Async WT LP CB (GPRS/Other): Failed to parse unixtime."));
-                return false;
-            }, false);
+        } else if (strcmp(cmd, "lcd") == 0) {
+            const LCDDisplay::Stats& ls = lcd.getStats();
+            Serial.printf("LCD: %lu flushes (%lu over budget), %lu chars, %lu cursor moves, %lu clears, ~%lu I2C bytes, last %lu us\n",
+                          (unsigned long)ls.flushes, (unsigned long)ls.deferred, (unsigned long)ls.cellsWritten,
+                          (unsigned long)ls.cursorMoves, (unsigned long)ls.clears, (unsigned long)ls.i2cBytes,
+                          (unsigned long)ls.lastBusUs);
+#if LOOP_PROFILER_ENABLED
+        } else if (strcmp(cmd, "profile") == 0) {
+            loopProfiler.printReport(Serial);
+        } else if (strcmp(cmd, "profile reset") == 0) {
+            loopProfiler.reset();
+            Serial.println(F("Loop profile cleared."));
+#endif
+        } else {
+            Serial.printf("Unknown command: %s (available: export, sched, net, lcd, rtc%s)\n", cmd, LOOP_PROFILER_ENABLED ? ", profile, profile reset" : "");
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,124 @@
+/**
+ * @file FixedString.h
+ * @brief Defines `FixedString`, a null-terminated string with inline fixed capacity, and `StrView`, a borrowed
+ *        pointer/length pair.
+ *
+ * Arduino `String` members reassigned per request (URLs, methods, API tags, payloads) and `String` return values
+ * built on every state change each cost a heap allocation, and over weeks the freed blocks fragment the heap until
+ * large allocations such as `JsonDocument` pools fail. `FixedString` keeps the characters inside the owning object,
+ * so assigning, formatting and returning one by value never touches the heap. Its `c_str()`, `length()` and
+ * `operator==` match `String`, so call sites read the same.
+ *
+ * Text longer than the capacity is truncated; `assign()` and `format()` report it so callers that cannot accept a
+ * partial value (a URL) can refuse it. Capacities come from the `*_MAX_LEN` constants in `config.h`.
+ *
+ * `StrView` names text owned elsewhere that outlives its use, such as a request body held in the
+ * `HttpRequestQueue` slot while the request is in flight.
+ *
+ * The header only needs the C library, so it builds unchanged for the ESP32 and for a host toolchain.
+ */
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <stddef.h> // For size_t.
+#include <stdarg.h> // For va_list in format().
+#include <stdio.h>  // For vsnprintf().
+#include <string.h> // For strlen(), strcmp(), memcpy().
+
+/**
+ * @struct StrView
+ * @brief Borrowed, null-terminated text and its length. Does not own or copy the characters.
+ */
+struct StrView {
+    const char* data; ///< First character; never `nullptr` (an empty view points at "").
+    size_t len;       ///< Number of characters before the terminator.
+
+    StrView() : data(""), len(0) {}
+    StrView(const char* s) : data(s ? s : ""), len(s ? strlen(s) : 0) {}
+    StrView(const char* s, size_t n) : data(s), len(n) {}
+
+    const char* c_str() const { return data; }
+    size_t length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+};
+
+/**
+ * @class FixedString
+ * @brief Null-terminated string stored inline in `N` bytes (`N - 1` characters).
+ * @tparam N Buffer size including the terminator, typically a `*_MAX_LEN` constant.
+ */
+template <size_t N>
+class FixedString {
+    static_assert(N >= 2, "FixedString needs room for at least one character and the terminator");
+
+public:
+    FixedString() : _len(0) { _buf[0] = '\0'; }
+    FixedString(const char* s) : _len(0) { assign(s); }
+
+    FixedString& operator=(const char* s) {
+        assign(s);
+        return *this;
+    }
+
+    /**
+     * @brief Replaces the contents with `s` (`nullptr` clears).
+     * @return `false` if `s` was truncated to `capacity()`.
+     */
+    bool assign(const char* s) {
+        return assign(s, s ? strlen(s) : 0);
+    }
+
+    /**
+     * @brief Replaces the contents with the first `len` characters of `s`.
+     * @return `false` if they were truncated to `capacity()`.
+     */
+    bool assign(const char* s, size_t len) {
+        bool fits = len < N;
+        _len = fits ? len : N - 1;
+        if (_len) memcpy(_buf, s, _len);
+        _buf[_len] = '\0';
+        return fits;
+    }
+
+    /**
+     * @brief Replaces the contents with `printf`-style formatted text.
+     * @return `false` if the text was truncated to `capacity()` (or the format failed, which clears the string).
+     */
+    __attribute__((format(printf, 2, 3))) bool format(const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(_buf, N, fmt, args);
+        va_end(args);
+        if (n < 0) {
+            clear();
+            return false;
+        }
+        _len = (size_t)n < N ? (size_t)n : N - 1;
+        return (size_t)n < N;
+    }
+
+    void clear() {
+        _len = 0;
+        _buf[0] = '\0';
+    }
+
+    const char* c_str() const { return _buf; }
+    size_t length() const { return _len; }
+    bool isEmpty() const { return _len == 0; }
+    StrView view() const { return StrView(_buf, _len); }
+
+    /**
+     * @brief Gets the most characters the string can hold.
+     * @return `N - 1`.
+     */
+    static constexpr size_t capacity() { return N - 1; }
+
+    bool operator==(const char* s) const { return s && strcmp(_buf, s) == 0; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+
+private:
+    char _buf[N]; ///< Characters and terminator.
+    size_t _len;  ///< Characters before the terminator.
+};
+
+#endif // FIXED_STRING_H
@@ -4,11 +4,13 @@
 // TinyGsmCommon.h and TinyGsmClient.h are now included via GPRSManager.h, which includes config.h first.
 #include "GPRSManager.h"
 #include "DeviceState.h" // Include DeviceState header
-#include "LCDDisplay.h"  // For LCDDisplay class definition
 #include "DeviceConfig.h" // For FW_NAME, FW_VERSION
+#include "ApiResponseFilter.h" // Per-API filters applied when deserializing response bodies
 #include <Arduino.h>  // For millis(), Serial, etc.
 #include <esp_task_wdt.h> // For watchdog reset
 
+static_assert(MQTT_GPRS_MUX < TINY_GSM_MUX_COUNT, "The MQTT push socket needs a modem mux channel after the HTTP pool.");
+
 // GPRSState enum is now defined in DeviceState.h and included.
 
 const char* GPRSManager::gprsStateToString(GPRSState state) { // Note: Parameter type is now GPRSState from DeviceState.h
@@ -30,46 +32,116 @@ const char* GPRSManager::gprsStateToString(GPRSState state) { // Note: Parameter
 }
 
 
+/**
+ * @brief Reads the registration status from a `+CREG`/`+CGREG` line.
+ * @param line "+CREG: <stat>[,...]" (URC) or "+CREG: <n>,<stat>[,...]" (reply to the `?` query).
+ * @param queryReply The line answers a query, so `<stat>` is the second field.
+ * @return The status, or -1 if the line is malformed.
+ */
+static int8_t parseRegStatus(const char* line, bool queryReply) {
+    const char* p = strchr(line, ':');
+    if (!p) return -1;
+    p++;
+    if (queryReply) {
+        p = strchr(p, ',');
+        if (!p) return -1;
+        p++;
+    }
+    while (*p == ' ') p++;
+    if (*p < '0' || *p > '9') return -1;
+    return (int8_t)atoi(p);
+}
+
+/**
+ * @brief Checks whether a registration status means registered (home network or roaming).
+ */
+static bool isRegistered(int8_t status) {
+    return status == 1 || status == 5;
+}
+
 // Constructor
 GPRSManager::GPRSManager(
     TinyGsm& modem,
+    AtCommandEngine& at,
     const char* apn,
     const char* gprsUser,
     const char* gprsPass,
     const char* simPin,
     const char* authToken,
-    DeviceState* deviceState, // Added DeviceState
-    LCDDisplay* lcd)
+    DeviceState* deviceState) // Added DeviceState
     : _modem(modem),
-      _gprsClient(modem), // Initialize GPRS client with the modem reference
+      _at(at),
+      _pool(_poolClients),
+      _poolSlot(0),
+      _slotAcquired(false),
+      _connReused(false),
+      _staleRetryUsed(false),
       _apn(apn),
       _gprsUser(gprsUser),
       _gprsPass(gprsPass),
       _simPin(simPin),
       _authToken(authToken),
       _deviceState(deviceState), // Initialize DeviceState
-      _lcd(lcd),
       _currentHttpState(GPRSHttpState::IDLE),
       _asyncOperationActive(false),
       _gprsHttpStatusCode(0),
       _gprsContentLength(0),
+      _gprsHasContentLength(false),
+      _gprsServerKeepAlive(false),
+      _gprsKeepAliveTimeoutMs(0),
       _gprsChunkedEncoding(false),
       _gprsBodyBytesRead(0),
+      _gprsBodyLen(0),
+      _gprsBodyTruncated(false),
       _currentGprsState(GPRSState::GPRS_STATE_DISABLED), // Initialize GPRS FSM state
       _lastGprsStateTransitionTime(0),
       _gprsReconnectAttempt(0),
       _modemResetCount(0),
-      _gprsAttachFailCount(0)
+      _gprsAttachFailCount(0),
+      _modemReset(at),
+      _nextSignalPollMs(0),
+      _signalQuality(99),
+      _signalQueryPending(false),
+      _netRegStatus(-1),
+      _gprsRegStatus(-1),
+      _regQueryPending(false),
+      _nextRegQueryMs(0),
+      _attachScript(AttachScript::IDLE),
+      _attachStep(0),
+      _attachRun(0),
+      _gprsAttached(false),
+      _linkCheckPending(false),
+      _linkCheckFailed(false)
        {
+   memset(&_gprsResponseValidators, 0, sizeof(_gprsResponseValidators));
+   memset(&_pendingValidators, 0, sizeof(_pendingValidators));
+   memset(&_asyncValidators, 0, sizeof(_asyncValidators));
+   _pendingIdempotencyKey[0] = '\0';
+   _asyncIdempotencyKey[0] = '\0';
+   // One TinyGSM socket per pool slot, on modem mux channels 0..HTTP_POOL_SLOTS-1.
+   for (uint8_t i = 0; i < HTTP_POOL_SLOTS; ++i) {
+       _gprsClients[i].init(&modem, i);
+       _poolClients[i] = &_gprsClients[i];
+   }
+   _pushClient.init(&modem, MQTT_GPRS_MUX);
    _gprsHost[0] = '\0';
    _gprsPath[0] = '\0';
+   _gprsBodyBuffer[0] = '\0';
+   _localIp[0] = '\0';
+   // Registration changes arrive as URCs once AT+CREG=1 / AT+CGREG=1 are set after each modem reset.
+   _at.onUrc("+CREG:", [this](const char* line) {
+       _netRegStatus = parseRegStatus(line, false);
+       DEBUG_PRINTF(3, "GPRS: Network registration URC: %d\n", _netRegStatus);
+   });
+   _at.onUrc("+CGREG:", [this](const char* line) {
+       _gprsRegStatus = parseRegStatus(line, false);
+       DEBUG_PRINTF(3, "GPRS: GPRS registration URC: %d\n", _gprsRegStatus);
+   });
   // _jsonDoc.reserve(GPRS_BODY_BUFFER_SIZE); // StaticJsonDocument pre-allocates, reserve is not needed and not a member.
 }
 
 GPRSManager::~GPRSManager() {
-    if (_gprsClient.connected()) {
-        _gprsClient.stop();
-    }
+    _pool.closeAll();
 }
 
 void GPRSManager::setAuthToken(const char* authToken) {
@@ -93,7 +165,10 @@ bool GPRSManager::connect() {
 
 void GPRSManager::disconnect() {
     DEBUG_PRINTLN(3, "GPRSManager: Disconnecting GPRS...");
+    _pool.closeAll();
+    _pushClient.stop();
     _modem.gprsDisconnect();
+    _gprsAttached = false;
     // Optionally, power down modem if not needed for a while
     // #if defined(MODEM_POWER_ON)
     //    digitalWrite(MODEM_POWER_ON, LOW); // Example
@@ -111,6 +186,29 @@ void GPRSManager::transitionToState(GPRSState newState) {
         if (newState != GPRSState::GPRS_STATE_RECONNECTING) {
             _gprsReconnectAttempt = 0;
         }
+        if (newState == GPRSState::GPRS_STATE_INIT_RESET_MODEM) {
+            // Replies to queued commands will never come, and URC settings are lost with the reboot.
+            _at.clear();
+            // Every reset runs its sub-steps from the start: soft first, then hard.
+            ModemResetSequencer::Kind kind = ModemResetSequencer::Kind::SOFT;
+            if (_modemResetCount > 0) {
+                kind = GPRS_MODEM_HARD_RESET_PINS ? ModemResetSequencer::Kind::PIN_SEQUENCE
+                                                  : ModemResetSequencer::Kind::WAIT_AND_RESTART;
+            }
+            _modemReset.begin(kind, _simPin.c_str(), _lastGprsStateTransitionTime);
+            _signalQueryPending = false;
+            _regQueryPending = false;
+            _linkCheckPending = false;
+            _netRegStatus = -1;
+            _gprsRegStatus = -1;
+            _gprsAttached = false;
+        }
+        if (newState == GPRSState::GPRS_STATE_INIT_ATTACH_GPRS) {
+            _attachScript = AttachScript::IDLE; // A script abandoned by a state change is not resumed.
+        }
+        if (newState == GPRSState::GPRS_STATE_OPERATIONAL) {
+            _linkCheckFailed = false;
+        }
         if (newState == GPRSState::GPRS_STATE_INIT_START) {
              _modemResetCount = 0; // Reset for a full new init sequence
              _gprsAttachFailCount = 0;
@@ -131,9 +229,27 @@ unsigned long GPRSManager::getElapsedTimeInCurrentGprsState() const {
 void GPRSManager::updateFSM() {
     esp_task_wdt_reset(); // Reset watchdog at the beginning of FSM update
 
+    // Dispatch modem lines (replies, URCs) and send the next queued command; never waits on the UART.
+    unsigned long now = millis();
+    _at.poll(now);
+
+    // AT+CSQ is queued on an interval and its reply cached, not while the modem is off or rebooting.
+    bool modemUp = _currentGprsState != GPRSState::GPRS_STATE_DISABLED &&
+                   _currentGprsState != GPRSState::GPRS_STATE_INIT_WAIT_SERIAL &&
+                   _currentGprsState != GPRSState::GPRS_STATE_INIT_RESET_MODEM &&
+                   _currentGprsState != GPRSState::GPRS_STATE_ERROR_MODEM_FAIL;
+    if (modemUp && !_signalQueryPending && (long)(now - _nextSignalPollMs) >= 0) {
+        _signalQueryPending = _at.submit("+CSQ", "+CSQ:", AT_DEFAULT_TIMEOUT_MS, [this](AtResult result, const char* info) {
+            _signalQueryPending = false;
+            const char* value = strchr(info, ':');
+            if (result == AtResult::OK && value) _signalQuality = atoi(value + 1);
+        });
+        _nextSignalPollMs = now + GPRS_SIGNAL_POLL_INTERVAL_MS;
+    }
+
     // Update global device state if available
     if (_deviceState) {
-        _deviceState->gprsSignalQuality = getSignalQuality();
+        _deviceState->gprsSignalQuality = _signalQuality;
         _deviceState->isGprsConnected = isConnected();
     }
 
@@ -187,77 +303,6 @@ bool GPRSManager::checkModemSerial() {
     return _modem.testAT(200); // Short timeout for responsiveness check
 }
 
-bool GPRSManager::performModemSoftReset() {
-    DEBUG_PRINTLN(2, "GPRS FSM: Attempting modem soft reset (AT+CFUN=1,1)...");
-    bool success = _modem.restart(); // TinyGSM's restart often does a soft reset
-    esp_task_wdt_reset();
-    if (success) {
-        DEBUG_PRINTLN(3, "GPRS FSM: Modem soft reset successful.");
-        delay(5000); // Wait for modem to come back online
-        esp_task_wdt_reset();
-        return checkModemSerial(); // Verify it's responsive
-    } else {
-        DEBUG_PRINTLN(1, "GPRS FSM: Modem soft reset command failed.");
-        return false;
-    }
-}
-
-bool GPRSManager::performModemHardReset() {
-    DEBUG_PRINTLN(2, "GPRS FSM: Attempting modem hard reset (power cycle/reset pin)...");
-    // Power cycling/reset sequence (ensure pins are defined in config.h)
-    #if defined(MODEM_POWER_ON) // General power pin
-        pinMode(MODEM_POWER_ON, OUTPUT);
-        digitalWrite(MODEM_POWER_ON, LOW); delay(500);
-        digitalWrite(MODEM_POWER_ON, HIGH); delay(1000);
-        DEBUG_PRINTLN(3, "GPRS FSM: MODEM_POWER_ON toggled.");
-    #endif
-
-    #if defined(GSM_PWR) && GSM_PWR != -1 // Specific PWKEY pin
-        pinMode(GSM_PWR, OUTPUT);
-        digitalWrite(GSM_PWR, HIGH); delay(100);
-        digitalWrite(GSM_PWR, LOW);  delay(1200); // PWKEY pulse to turn OFF or ON
-        digitalWrite(GSM_PWR, HIGH); delay(2000); // Ensure it's high (ON state for some)
-        DEBUG_PRINTLN(3, "GPRS FSM: GSM_PWR pulsed.");
-    #endif
-
-    #if defined(GSM_RST) && GSM_RST != -1 // Specific Reset pin
-        pinMode(GSM_RST, OUTPUT);
-        digitalWrite(GSM_RST, LOW);  delay(GPRS_MODEM_RESET_PULSE_MS); // Assert reset
-        digitalWrite(GSM_RST, HIGH); delay(3000); // De-assert and wait
-        DEBUG_PRINTLN(3, "GPRS FSM: GSM_RST pulsed.");
-    #endif
-    
-    esp_task_wdt_reset();
-    delay(GPRS_MODEM_POWER_CYCLE_DELAY_MS); // Generous delay for modem to boot after hard reset
-    esp_task_wdt_reset();
-
-    // After hard reset, the modem object itself might need re-initialization
-    // if its internal state is not consistent with the hardware.
-    // _modem.init(); // This is a more thorough re-init of TinyGSM's internal state.
-    // However, _modem.restart() is often sufficient and preferred.
-    bool modemOk = _modem.restart(); // Try to re-establish communication with the modem
-    if (!modemOk) {
-         DEBUG_PRINTLN(1, "GPRS FSM: Modem did not respond after hard reset + restart(). Trying testAT...");
-         unsigned long modemStartTime = millis();
-         while (millis() - modemStartTime < GPRS_MODEM_RESPONSE_TIMEOUT_MS) { // 15s timeout for AT response
-             esp_task_wdt_reset();
-             if (checkModemSerial()) {
-                 modemOk = true;
-                 break;
-             }
-             delay(1000);
-         }
-    }
-
-    if (modemOk) {
-        DEBUG_PRINTLN(3, "GPRS FSM: Modem hard reset appears successful.");
-    } else {
-        DEBUG_PRINTLN(1, "GPRS FSM: Modem hard reset failed (modem unresponsive).");
-    }
-    return modemOk;
-}
-
-
 void GPRSManager::handleGprsInitStart() {
     DEBUG_PRINTLN(3, "GPRS FSM: Handling GPRS_STATE_INIT_START");
     _modemResetCount = 0; // Reset for this new attempt sequence
@@ -291,74 +336,40 @@ void GPRSManager::handleGprsInitWaitSerial() {
 
 
 void GPRSManager::handleGprsInitResetModem() {
-    DEBUG_PRINTLN(3, "GPRS FSM: Handling GPRS_STATE_INIT_RESET_MODEM");
-    bool resetOk = false;
-    if (_modemResetCount == 0) { // First try a soft reset
-        resetOk = performModemSoftReset();
-    } else { // Subsequent tries, use hard reset
-        resetOk = performModemHardReset();
+    ModemResetSequencer::Outcome outcome = _modemReset.update(millis());
+    if (outcome == ModemResetSequencer::Outcome::RUNNING) return;
+    if (_modemReset.modemAnswered()) _modemResetCount = 0; // Reset counter once the modem is back
+
+    if (outcome == ModemResetSequencer::Outcome::READY) {
+        finishModemReset();
+    } else if (outcome == ModemResetSequencer::Outcome::SIM_UNLOCK_FAILED) {
+        transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM); // Retry cycle
+    } else {
+        failModemReset();
     }
+}
 
-    if (resetOk) {
-        DEBUG_PRINTLN(3, "GPRS FSM: Modem reset successful.");
-        String modemInfo = _modem.getModemInfo();
-        DEBUG_PRINTF(3, "GPRS FSM: Modem Info: %s\n", modemInfo.c_str());
-        _modemResetCount = 0; // Reset counter on successful reset
-        
-        // Unlock SIM if PIN is provided
-        if (strlen(_simPin.c_str()) > 0) { // Use strlen for PROGMEM char array
-            SimStatus simStatus = _modem.getSimStatus();
-            esp_task_wdt_reset();
-            if (simStatus == SIM_LOCKED) {
-                DEBUG_PRINTLN(3, "GPRS FSM: Unlocking SIM...");
-                if (!_modem.simUnlock(_simPin.c_str())) {
-                    DEBUG_PRINTLN(1, "GPRS FSM: SIM Unlock Failed.");
-                    transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM); // Retry cycle
-                    return;
-                }
-                delay(1000); // Wait for unlock
-                simStatus = _modem.getSimStatus(); // Check again
-            }
-        }
+void GPRSManager::finishModemReset() {
+    // Registration is reported by URC from now on; handleGprsInitAttachGprs() queries it until the first one.
+    if (!_at.submit("+CREG=1", nullptr, AT_DEFAULT_TIMEOUT_MS, nullptr) ||
+        !_at.submit("+CGREG=1", nullptr, AT_DEFAULT_TIMEOUT_MS, nullptr)) {
+        DEBUG_PRINTLN(1, "GPRS FSM: Could not queue registration URC setup; relying on queries.");
+    }
+    _nextRegQueryMs = millis();
 
-        if (_modem.getSimStatus() != SIM_READY) {
-            DEBUG_PRINTF(1, "GPRS FSM: SIM not ready. Status: %d. Retrying modem reset.\n", (int)_modem.getSimStatus());
-            _modemResetCount++; // Increment here before check
-            if (_modemResetCount >= GPRS_MAX_MODEM_RESETS) { 
-                transitionToState(GPRSState::GPRS_STATE_ERROR_MODEM_FAIL);
-            } else {
-                transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM); // Try reset sequence again
-            }
-            return;
-        }
-        DEBUG_PRINTLN(3, "GPRS FSM: SIM OK.");
-
-        // Enable SSL for GPRS
-        DEBUG_PRINTLN(3, "GPRS FSM: Attempting to enable SSL (AT+CIPSSL=1)...");
-        _modem.sendAT(F("+CIPSSL=1"));
-        if (_modem.waitResponse(10000L) != 1) { // Wait up to 10s for "OK"
-            DEBUG_PRINTLN(1, "GPRS FSM: Failed to enable SSL (AT+CIPSSL=1). HTTPS might fail.");
-            // Consider transitioning to an error state or retrying modem reset if SSL is critical
-            // For now, log and continue. Some firmwares/modems might have it enabled by default.
-        } else {
-            DEBUG_PRINTLN(3, "GPRS FSM: SSL enabled successfully (AT+CIPSSL=1).");
-        }
-        esp_task_wdt_reset();
+    transitionToState(GPRSState::GPRS_STATE_INIT_ATTACH_GPRS); // Directly to ATTACH_GPRS
+}
 
-        // _apnSetRetryCount = 0; // Reset APN retry for the new modem state - Removed
-        transitionToState(GPRSState::GPRS_STATE_INIT_ATTACH_GPRS); // Directly to ATTACH_GPRS
+void GPRSManager::failModemReset() {
+    DEBUG_PRINTLN(1, "GPRS FSM: Modem reset failed.");
+    _modemResetCount++;
+    if (_modemResetCount >= GPRS_MAX_MODEM_RESETS) {
+        DEBUG_PRINTLN(1, "GPRS FSM: Max modem resets reached. Moving to MODEM_FAIL.");
+        transitionToState(GPRSState::GPRS_STATE_ERROR_MODEM_FAIL);
     } else {
-        DEBUG_PRINTLN(1, "GPRS FSM: Modem reset failed.");
-        _modemResetCount++;
-        if (_modemResetCount >= GPRS_MAX_MODEM_RESETS) { 
-            DEBUG_PRINTLN(1, "GPRS FSM: Max modem resets reached. Moving to MODEM_FAIL.");
-            transitionToState(GPRSState::GPRS_STATE_ERROR_MODEM_FAIL);
-        } else {
-            DEBUG_PRINTF(2, "GPRS FSM: Retrying modem reset (attempt %d).\n", _modemResetCount);
-            // Stay in INIT_RESET_MODEM or go back to ERROR_RESTART_MODEM to try again with delay
-            // Forcing a delay via ERROR_RESTART_MODEM might be better
-             transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM);
-        }
+        DEBUG_PRINTF(2, "GPRS FSM: Retrying modem reset (attempt %d).\n", _modemResetCount);
+        // Forcing a delay via ERROR_RESTART_MODEM before the next (hard) reset.
+        transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM);
     }
 }
 
@@ -412,63 +423,153 @@ void GPRSManager::handleGprsInitResetModem() {
 
 
 void GPRSManager::handleGprsInitAttachGprs() {
-    DEBUG_PRINTLN(3, "GPRS FSM: Handling GPRS_STATE_INIT_ATTACH_GPRS");
     esp_task_wdt_reset();
-
-    if (_modem.isNetworkConnected() && _modem.isGprsConnected()) {
-         DEBUG_PRINTLN(3, "GPRS FSM: Already registered and GPRS connected.");
-         _gprsAttachFailCount = 0; // Reset counter
-         transitionToState(GPRSState::GPRS_STATE_OPERATIONAL); // Or INIT_CONNECT_TCP if a test ping is desired
-         return;
-    }
-    
-    DEBUG_PRINTLN(3, "GPRS FSM: Checking network registration...");
-    if (!_modem.isNetworkConnected()) {
-        DEBUG_PRINTLN(2, "GPRS FSM: Not registered on network. Waiting for registration...");
-        // TinyGSM's waitForNetwork can take time.
-        // Non-blocking check:
-        SIM800RegStatus regStatus = _modem.getRegistrationStatus();
-        DEBUG_PRINTF(4, "GPRS FSM: Reg Status: %d\n", static_cast<int>(regStatus));
-        if (regStatus == REG_OK_HOME || regStatus == REG_OK_ROAMING) {
-            DEBUG_PRINTLN(3, "GPRS FSM: Network registration OK.");
-        } else {
-            if (getElapsedTimeInCurrentGprsState() > GPRS_ATTACH_TIMEOUT_MS) { // GPRS_ATTACH_TIMEOUT_MS from config.h
-                DEBUG_PRINTLN(1, "GPRS FSM: Network registration timeout.");
-                 _gprsAttachFailCount++;
-                if (_gprsAttachFailCount > GPRS_MAX_ATTACH_FAILURES) {
-                    transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM); // Changed from MODEM_FAIL to allow reset cycle
-                } else {
-                    // Stay in this state, retry on next FSM loop or transition to a specific retry delay state.
-                    // Forcing a new attempt by resetting timer
-                    _lastGprsStateTransitionTime = millis(); 
-                }
-                return;
+    unsigned long now = millis();
+
+    switch (_attachScript) {
+        case AttachScript::RUNNING:
+            return; // Commands complete through _at.poll(); nothing to wait on here.
+        case AttachScript::SUCCEEDED:
+            DEBUG_PRINTF(3, "GPRS FSM: GPRS Connected successfully (IP %s).\n", _localIp);
+            _attachScript = AttachScript::IDLE;
+            _gprsAttached = true;
+            _gprsRegStatus = -1; // May still hold the +CGREG: 0 the script's own AT+CGATT=0 caused; the next URC or check refreshes it.
+            _gprsAttachFailCount = 0; // Reset on success
+            transitionToState(GPRSState::GPRS_STATE_OPERATIONAL); // Move directly to Operational
+            return;
+        case AttachScript::FAILED:
+            _attachScript = AttachScript::IDLE;
+            DEBUG_PRINTLN(1, "GPRS FSM: GPRS connect failed.");
+            printModemErrorCause();
+            _gprsAttachFailCount++;
+            if (_gprsAttachFailCount >= GPRS_MAX_ATTACH_FAILURES) {
+                DEBUG_PRINTLN(1, "GPRS FSM: Max GPRS attach failures. Restarting modem.");
+                transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM);
+            } else {
+                DEBUG_PRINTF(2, "GPRS FSM: GPRS attach failed, attempt %d. Will retry in this state after FSM loop delay.\n", _gprsAttachFailCount);
+                 _lastGprsStateTransitionTime = millis(); // Reset timer to enforce FSM loop delay before retry
             }
-            // Still waiting for registration, stay in this state.
             return;
-        }
+        case AttachScript::IDLE:
+            break;
     }
-     esp_task_wdt_reset();
-
-    // Network is registered, now try to connect GPRS
-    DEBUG_PRINTLN(3, "GPRS FSM: Attempting GPRS connect...");
-    if (_modem.gprsConnect(_apn.c_str(), _gprsUser.c_str(), _gprsPass.c_str())) {
-        DEBUG_PRINTLN(3, "GPRS FSM: GPRS Connected successfully.");
-        _gprsAttachFailCount = 0; // Reset on success
-        // _tcpConnectFailCount = 0; // Reset for next phase - Removed
-        transitionToState(GPRSState::GPRS_STATE_OPERATIONAL); // Move directly to Operational
-    } else {
-        DEBUG_PRINTLN(1, "GPRS FSM: gprsConnect failed.");
-        printModemErrorCause();
-        _gprsAttachFailCount++;
-        if (_gprsAttachFailCount >= GPRS_MAX_ATTACH_FAILURES) { 
-            DEBUG_PRINTLN(1, "GPRS FSM: Max GPRS attach failures. Restarting modem.");
-            transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM);
-        } else {
-            DEBUG_PRINTF(2, "GPRS FSM: GPRS attach failed, attempt %d. Will retry in this state after FSM loop delay.\n", _gprsAttachFailCount);
-             _lastGprsStateTransitionTime = millis(); // Reset timer to enforce FSM loop delay before retry
+
+    if (!isRegistered(_netRegStatus)) {
+        // Normally a +CREG URC flips this; query as well in case TinyGSM consumed the URC or the modem never sent one.
+        if (!_regQueryPending && (long)(now - _nextRegQueryMs) >= 0) {
+            queryRegistration();
+            _nextRegQueryMs = now + GPRS_REGISTRATION_POLL_MS;
         }
+        if (getElapsedTimeInCurrentGprsState() > GPRS_ATTACH_TIMEOUT_MS) { // GPRS_ATTACH_TIMEOUT_MS from config.h
+            DEBUG_PRINTF(1, "GPRS FSM: Network registration timeout (status %d).\n", _netRegStatus);
+            _gprsAttachFailCount++;
+            if (_gprsAttachFailCount > GPRS_MAX_ATTACH_FAILURES) {
+                transitionToState(GPRSState::GPRS_STATE_ERROR_RESTART_MODEM); // Changed from MODEM_FAIL to allow reset cycle
+            } else {
+                // Forcing a new attempt by resetting timer
+                _lastGprsStateTransitionTime = millis();
+            }
+        }
+        return;
+    }
+
+    // Network is registered, now bring up the bearer.
+    DEBUG_PRINTLN(3, "GPRS FSM: Network registration OK. Attempting GPRS connect...");
+    _attachScript = AttachScript::RUNNING;
+    _attachStep = 0;
+    _attachRun++;
+    submitAttachStep();
+}
+
+/**
+ * @brief Queues `AT+CREG?` and `AT+CGREG?`; the replies update the cached registration status.
+ */
+void GPRSManager::queryRegistration() {
+    bool queued = _at.submit("+CREG?", "+CREG:", AT_DEFAULT_TIMEOUT_MS, [this](AtResult result, const char* info) {
+        if (result == AtResult::OK && info[0]) _netRegStatus = parseRegStatus(info, true);
+    });
+    queued = queued && _at.submit("+CGREG?", "+CGREG:", AT_DEFAULT_TIMEOUT_MS, [this](AtResult result, const char* info) {
+        _regQueryPending = false;
+        if (result == AtResult::OK && info[0]) _gprsRegStatus = parseRegStatus(info, true);
+    });
+    _regQueryPending = queued;
+}
+
+/**
+ * @brief Builds one command of the bearer bring-up script.
+ * The sequence is TinyGSM's SIM800 `gprsConnect()`: reset the bearer, configure the SAPBR and PDP contexts,
+ * attach, enable multiplexed sockets, then start the IP task and read the local address.
+ * @param index Step index.
+ * @param step Filled with the command; `step.skip` for a step that does not apply (no user/password), `step.text`
+ *             "" if the command does not fit `AT_COMMAND_MAX_LEN`.
+ * @return `false` past the last step.
+ */
+bool GPRSManager::buildAttachStep(uint8_t index, AttachStep& step) const {
+    const char* apn = _apn.c_str();
+    const char* user = _gprsUser.c_str();
+    const char* pass = _gprsPass.c_str();
+    step.info = nullptr;
+    step.finalToken = nullptr;
+    step.timeoutMs = AT_DEFAULT_TIMEOUT_MS;
+    step.required = true;
+    step.skip = false;
+    int n = 0;
+    switch (index) {
+        case 0:  n = snprintf(step.text, sizeof(step.text), "+CIPSHUT"); step.finalToken = "SHUT OK"; step.timeoutMs = 60000UL; step.required = false; break;
+        case 1:  n = snprintf(step.text, sizeof(step.text), "+CGATT=0"); step.timeoutMs = 60000UL; step.required = false; break;
+        case 2:  n = snprintf(step.text, sizeof(step.text), "+SAPBR=3,1,\"Contype\",\"GPRS\""); step.required = false; break;
+        case 3:  n = snprintf(step.text, sizeof(step.text), "+SAPBR=3,1,\"APN\",\"%s\"", apn); step.required = false; break;
+        case 4:  n = snprintf(step.text, sizeof(step.text), "+SAPBR=3,1,\"USER\",\"%s\"", user); step.skip = !user[0]; step.required = false; break;
+        case 5:  n = snprintf(step.text, sizeof(step.text), "+SAPBR=3,1,\"PWD\",\"%s\"", pass); step.skip = !pass[0]; step.required = false; break;
+        case 6:  n = snprintf(step.text, sizeof(step.text), "+CGDCONT=1,\"IP\",\"%s\"", apn); step.required = false; break;
+        case 7:  n = snprintf(step.text, sizeof(step.text), "+CGACT=1,1"); step.timeoutMs = 60000UL; step.required = false; break;
+        case 8:  n = snprintf(step.text, sizeof(step.text), "+SAPBR=1,1"); step.timeoutMs = 85000UL; step.required = false; break;
+        case 9:  n = snprintf(step.text, sizeof(step.text), "+SAPBR=2,1"); step.timeoutMs = 30000UL; break;
+        case 10: n = snprintf(step.text, sizeof(step.text), "+CGATT=1"); step.timeoutMs = 60000UL; break;
+        case 11: n = snprintf(step.text, sizeof(step.text), "+CIPMUX=1"); break;
+        case 12: n = snprintf(step.text, sizeof(step.text), "+CIPQSEND=1"); break;
+        case 13: n = snprintf(step.text, sizeof(step.text), "+CIPRXGET=1"); break;
+        case 14: n = snprintf(step.text, sizeof(step.text), "+CSTT=\"%s\",\"%s\",\"%s\"", apn, user, pass); step.timeoutMs = 60000UL; break;
+        case 15: n = snprintf(step.text, sizeof(step.text), "+CIICR"); step.timeoutMs = 60000UL; break;
+        case 16: n = snprintf(step.text, sizeof(step.text), "+CIFSR;E0"); step.info = ""; step.timeoutMs = 10000UL; break; // Replies with the bare IP.
+        case 17: n = snprintf(step.text, sizeof(step.text), "+CDNSCFG=\"8.8.8.8\",\"8.8.4.4\""); break;
+        default: return false;
     }
+    if (n < 0 || (size_t)n >= sizeof(step.text)) step.text[0] = '\0'; // Reported by submitAttachStep().
+    return true;
+}
+
+/**
+ * @brief Queues the current step of the bearer bring-up script; each completion queues the next one.
+ */
+void GPRSManager::submitAttachStep() {
+    AttachStep step;
+    bool more;
+    while ((more = buildAttachStep(_attachStep, step)) && step.skip) _attachStep++;
+    if (!more) {
+        _attachScript = AttachScript::SUCCEEDED;
+        return;
+    }
+    if (step.text[0] == '\0') {
+        DEBUG_PRINTF(1, "GPRS FSM: Attach step %u does not fit AT_COMMAND_MAX_LEN (APN credentials too long).\n", _attachStep);
+        _attachScript = AttachScript::FAILED;
+        return;
+    }
+    bool required = step.required;
+    bool readsIp = step.info != nullptr; // AT+CIFSR prints the local address.
+    uint8_t run = _attachRun;
+    bool queued = _at.submit(step.text, step.info, step.timeoutMs, [this, required, readsIp, run](AtResult result, const char* info) {
+        if (_attachScript != AttachScript::RUNNING || run != _attachRun) return; // Abandoned by a state change.
+        if (result != AtResult::OK && required) {
+            DEBUG_PRINTF(1, "GPRS FSM: Attach step %u failed (%s).\n", _attachStep, result == AtResult::TIMEOUT ? "timeout" : "error");
+            _attachScript = AttachScript::FAILED;
+            return;
+        }
+        if (readsIp) strlcpy(_localIp, info, sizeof(_localIp));
+        _attachStep++;
+        submitAttachStep();
+    }, step.finalToken);
+    if (!queued) _attachScript = AttachScript::FAILED;
 }
 
 
@@ -498,24 +599,44 @@ void GPRSManager::handleGprsInitAttachGprs() {
 
 void GPRSManager::handleGprsOperational() {
     // DEBUG_PRINTLN(5, "GPRS FSM: Handling GPRS_STATE_OPERATIONAL"); // Too verbose
-    if (getElapsedTimeInCurrentGprsState() > GPRS_CONNECTION_CHECK_INTERVAL_MS) { 
+    // Registration changes arrive as URCs and are acted on at once; unknown (-1) is not a loss.
+    if ((_netRegStatus >= 0 && !isRegistered(_netRegStatus)) || (_gprsRegStatus >= 0 && !isRegistered(_gprsRegStatus))) {
+        DEBUG_PRINTF(1, "GPRS FSM: Registration lost (CREG %d, CGREG %d).\n", _netRegStatus, _gprsRegStatus);
+        _gprsAttached = false;
+        transitionToState(GPRSState::GPRS_STATE_CONNECTION_LOST);
+        return;
+    }
+    if (_linkCheckFailed) {
+        DEBUG_PRINTLN(1, "GPRS FSM: GPRS connection lost (detected in OPERATIONAL by AT+CGATT?).");
+        _gprsAttached = false;
+        transitionToState(GPRSState::GPRS_STATE_CONNECTION_LOST);
+        return;
+    }
+    if (getElapsedTimeInCurrentGprsState() > GPRS_CONNECTION_CHECK_INTERVAL_MS && !_linkCheckPending) {
         _lastGprsStateTransitionTime = millis(); // Reset timer for this check interval
-        if (!_modem.isGprsConnected()) { // isGprsConnected can be slow, consider alternatives
-            DEBUG_PRINTLN(1, "GPRS FSM: GPRS connection lost (detected in OPERATIONAL by isGprsConnected).");
-            transitionToState(GPRSState::GPRS_STATE_CONNECTION_LOST);
-        } else if (!_modem.isNetworkConnected()) { // Also check basic network registration
-             DEBUG_PRINTLN(1, "GPRS FSM: Network registration lost (detected in OPERATIONAL).");
-            transitionToState(GPRSState::GPRS_STATE_CONNECTION_LOST);
-        }
-        else {
-            // DEBUG_PRINTF(4, "GPRS FSM: Still operational. Signal: %d\n", getSignalQuality());
-        }
+        // Same checks as TinyGSM isGprsConnected() (attached, IP up), queued instead of waited on; the
+        // registration query backs up URCs that TinyGSM consumed while it was reading.
+        _linkCheckPending = _at.submit("+CGATT?", "+CGATT:", AT_DEFAULT_TIMEOUT_MS, [this](AtResult result, const char* info) {
+            const char* value = strchr(info, ':');
+            if (result != AtResult::OK || !value || atoi(value + 1) != 1) {
+                _linkCheckPending = false;
+                _linkCheckFailed = true;
+                return;
+            }
+            _linkCheckPending = _at.submit("+CIFSR;E0", "", 10000UL, [this](AtResult result, const char* info) {
+                _linkCheckPending = false;
+                if (result != AtResult::OK) _linkCheckFailed = true;
+                else if (info[0]) strlcpy(_localIp, info, sizeof(_localIp));
+            });
+            if (!_linkCheckPending) _linkCheckFailed = true;
+        });
+        if (!_regQueryPending) queryRegistration();
     }
 }
 
 void GPRSManager::handleGprsConnectionLost() {
     DEBUG_PRINTLN(2, "GPRS FSM: Handling GPRS_STATE_CONNECTION_LOST. Moving to RECONNECTING.");
-    _gprsClient.stop(); // Ensure any active client connection is closed
+    _pool.closeAll(); // Ensure all client connections are closed; pooled sockets died with the bearer
     _gprsReconnectAttempt = 0; // Reset for this new reconnection sequence
     // Don't reset modemResetCount here, that's for full init sequences
     transitionToState(GPRSState::GPRS_STATE_RECONNECTING);
@@ -540,7 +661,7 @@ void GPRSManager::handleGprsReconnecting() {
 
 void GPRSManager::handleGprsErrorRestartModem() {
     DEBUG_PRINTLN(1, "GPRS FSM: Handling GPRS_STATE_ERROR_RESTART_MODEM");
-    _gprsClient.stop(); // Ensure client is stopped
+    _pool.closeAll(); // Ensure clients are stopped
 
     // _modemResetCount is managed by handleGprsInitResetModem
     // This state essentially forces a delay then a transition back to INIT_RESET_MODEM
@@ -556,8 +677,6 @@ void GPRSManager::handleGprsErrorRestartModem() {
 
 void GPRSManager::handleGprsErrorModemFail() {
     DEBUG_PRINTLN(1, "GPRS FSM: Handling GPRS_STATE_ERROR_MODEM_FAIL. GPRS is non-functional.");
-    if (_lcd) _lcd->message(0, 0, "Modem Fail", true); // Use message() to display error
-
     if (getElapsedTimeInCurrentGprsState() > GPRS_MODEM_FAIL_RECOVERY_TIMEOUT_MS) {
         DEBUG_PRINTLN(1, "GPRS FSM: Modem fail recovery timeout reached. Transitioning to DISABLED to allow manual restart of FSM.");
         transitionToState(GPRSState::GPRS_STATE_DISABLED);
@@ -572,12 +691,28 @@ bool GPRSManager::isConnected() const {
     return _currentGprsState == GPRSState::GPRS_STATE_OPERATIONAL;
 }
 
-String GPRSManager::getStatusString() const {
-    char buffer[150]; // Increased buffer
+bool GPRSManager::isHttpOperationActive() const {
+    return _asyncOperationActive;
+}
+
+/**
+ * @brief Abandons the request in flight.
+ * Refer to GPRSManager.h for detailed documentation.
+ */
+void GPRSManager::abortHttpOperation() {
+    if (!_asyncOperationActive) return;
+    DEBUG_PRINTF(2, "GPRSManager Async (%s): Aborted.\n", _asyncApiType.c_str());
+    closeConnection();
+    _asyncOperationActive = false;
+    _currentHttpState = GPRSHttpState::IDLE;
+}
+
+NetworkStatusString GPRSManager::getStatusString() const {
+    NetworkStatusString status;
     if (isConnected()) {
-        snprintf(buffer, sizeof(buffer), "GPRS: Connected (Sig: %d)", getSignalQuality());
+        status.format("GPRS: Connected (Sig: %d)", getSignalQuality());
     } else {
-        snprintf(buffer, sizeof(buffer), "GPRS: %s (Sig: %d, Rst: %d, AtchFail: %d, TCPFail: %d, APNSetFail: %d)",
+        status.format("GPRS: %s (Sig: %d, Rst: %d, AtchFail: %d, TCPFail: %d, APNSetFail: %d)",
                  gprsStateToString(_currentGprsState),
                  getSignalQuality(),
                  _modemResetCount,
@@ -585,27 +720,22 @@ String GPRSManager::getStatusString() const {
                  _tcpConnectFailCount,
                  _apnSetRetryCount);
     }
-    return String(buffer);
+    return status;
 }
 
 int GPRSManager::getSignalQuality() const {
-    // Cache signal quality? getSignalQuality() sends AT command.
-    // For now, direct call.
-    return _modem.getSignalQuality();
+    return _signalQuality; // Last AT+CSQ reply, refreshed by updateFSM() every GPRS_SIGNAL_POLL_INTERVAL_MS.
 }
 bool GPRSManager::isModemConnected() const {
-    // Check both network registration and GPRS context.
-    // isNetworkConnected() checks network registration (e.g., CREG).
-    // isGprsConnected() checks if a GPRS context is active (e.g., CGATT).
-    return _modem.isNetworkConnected() && _modem.isGprsConnected();
+    // Network registration (CREG, URC-driven) and the bearer as last brought up / checked by the FSM.
+    return isRegistered(_netRegStatus) && _gprsAttached;
 }
 
-String GPRSManager::getIPAddress() const {
-    if (isModemConnected()) { // Use the more direct check
-        IPAddress ip = _modem.localIP();
-        return ip.toString();
+IpAddressString GPRSManager::getIPAddress() const {
+    if (isModemConnected() && _localIp[0]) {
+        return IpAddressString(_localIp);
     }
-    return "0.0.0.0";
+    return IpAddressString("0.0.0.0");
 }
 
 
@@ -614,7 +744,7 @@ bool GPRSManager::startAsyncHttpRequest(
     const char* method,
     const char* apiType,
     const char* payload,
-    std::function<bool(JsonDocument& doc)> cb,
+    const HttpResponseCallback& cb,
     bool needsAuth) {
 
     if (_asyncOperationActive) {
@@ -687,21 +817,25 @@ bool GPRSManager::startAsyncHttpRequest(
         }
     }
 
-    _asyncUrl = url; 
-    _asyncMethod = method;
-    _asyncApiType = apiType;
-    _asyncPayload = (payload ? payload : "");
+    if (!_asyncUrl.assign(url) || !_asyncMethod.assign(method)) {
+        DEBUG_PRINTF(1, "GPRSManager: URL or method too long for '%s'.\n", apiType);
+        return false;
+    }
+    _asyncApiType = apiType; // Logging tag only; truncation is harmless.
+    _asyncPayload = StrView(payload);
     _asyncCb = cb;
     _asyncNeedsAuth = needsAuth;
     _asyncRequestStartTime = millis();
     _asyncOperationActive = true;
     _httpRetries = 0; // Initialize retry counter
+    _staleRetryUsed = false;
+    _asyncValidators = _pendingValidators; // Conditional headers apply to this request only
+    memset(&_pendingValidators, 0, sizeof(_pendingValidators));
+    memcpy(_asyncIdempotencyKey, _pendingIdempotencyKey, sizeof(_asyncIdempotencyKey));
+    _pendingIdempotencyKey[0] = '\0';
 
-    _gprsResponseBuffer = "";
+    resetResponseBuffers();
     _gprsHttpStatusCode = 0;
-    _gprsContentLength = 0;
-    _gprsChunkedEncoding = false;
-    _gprsBodyBytesRead = 0;
     _jsonDoc.clear();
 
     _currentHttpState = GPRSHttpState::CLIENT_CONNECT;
@@ -710,6 +844,7 @@ bool GPRSManager::startAsyncHttpRequest(
 
 void GPRSManager::updateHttpOperations() {
     if (!_asyncOperationActive) {
+        if (_currentGprsState == GPRSState::GPRS_STATE_OPERATIONAL) _pool.expireIdle(millis());
         return;
     }
     
@@ -717,7 +852,7 @@ void GPRSManager::updateHttpOperations() {
         DEBUG_PRINTF(2, "GPRSManager: HTTP op '%s' paused, GPRS not operational (State: %s).\n", _asyncApiType.c_str(), GPRSManager::gprsStateToString(_currentGprsState));
         if (_currentHttpState != GPRSHttpState::IDLE && _currentHttpState != GPRSHttpState::COMPLETE && _currentHttpState != GPRSHttpState::ERROR) {
              DEBUG_PRINTF(1, "GPRSManager: GPRS connection dropped during active HTTP op for '%s'. Aborting HTTP.\n", _asyncApiType.c_str());
-             if (_gprsClient.connected()) _gprsClient.stop();
+             closeConnection();
              _currentHttpState = GPRSHttpState::ERROR; 
         }
         return; 
@@ -731,7 +866,7 @@ void GPRSManager::updateHttpOperations() {
         _currentHttpState != GPRSHttpState::ERROR &&   // Don't timeout if already in error
         currentTime - _asyncRequestStartTime > GPRS_HTTP_TOTAL_TIMEOUT_MS) { 
         DEBUG_PRINTF(1, "GPRSManager: Async HTTP operation for '%s' timed out overall.\n", _asyncApiType.c_str());
-        if (_gprsClient.connected()) _gprsClient.stop();
+        closeConnection();
         _currentHttpState = GPRSHttpState::ERROR;
     }
 
@@ -749,9 +884,21 @@ void GPRSManager::updateHttpOperations() {
                  _currentHttpState = GPRSHttpState::ERROR; // Go to error, retry logic below might catch it
                  break; 
             }
-            DEBUG_PRINTF(4, "GPRSManager Async (%s): gprsClient.connect(%s:%d)\n", _asyncApiType.c_str(), _gprsHost, _gprsPort);
-            if (_gprsClient.connect(_gprsHost, _gprsPort)) {
-                DEBUG_PRINTF(3, "GPRSManager Async (%s): Connected to host.\n", _asyncApiType.c_str());
+            if (!_slotAcquired) {
+                _poolSlot = _pool.acquire(_gprsHost, (uint16_t)_gprsPort, currentTime, _connReused);
+                _slotAcquired = true;
+            }
+            if (_connReused) {
+                // Kept-alive socket to the same host: skip the modem's TCP handshake entirely.
+                DEBUG_PRINTF(3, "GPRSManager Async (%s): Reusing connection to host (slot %u).\n", _asyncApiType.c_str(), _poolSlot);
+                _currentHttpState = GPRSHttpState::SENDING_REQUEST;
+                _asyncRequestStartTime = millis();
+                break;
+            }
+            DEBUG_PRINTF(4, "GPRSManager Async (%s): gprsClient.connect(%s:%d) on slot %u\n", _asyncApiType.c_str(), _gprsHost, _gprsPort, _poolSlot);
+            if (activeClient().connect(_gprsHost, _gprsPort)) {
+                _pool.noteHandshake(millis() - currentTime);
+                DEBUG_PRINTF(3, "GPRSManager Async (%s): Connected to host in %lu ms.\n", _asyncApiType.c_str(), millis() - currentTime);
                 _currentHttpState = GPRSHttpState::SENDING_REQUEST;
                 _asyncRequestStartTime = millis(); // Reset timer for request phase
             } else {
@@ -770,7 +917,7 @@ void GPRSManager::updateHttpOperations() {
         case GPRSHttpState::SENDING_REQUEST: {
             if (currentTime - _asyncRequestStartTime > HTTP_RESPONSE_TIMEOUT_MS) { // Timeout for sending request (includes server thinking time before headers)
                 DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Timeout sending request or waiting for initial response.\n", _asyncApiType.c_str());
-                if (_gprsClient.connected()) _gprsClient.stop();
+                closeConnection();
                 _currentHttpState = GPRSHttpState::ERROR;
                 break;
             }
@@ -779,7 +926,7 @@ void GPRSManager::updateHttpOperations() {
             int offset = 0;
             offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "%s %s HTTP/1.1\r\n", _asyncMethod.c_str(), _gprsPath);
             offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Host: %s\r\n", _gprsHost);
-            if (_asyncNeedsAuth && strlen(_authToken.c_str()) > 0) {
+            if (_asyncNeedsAuth && _authToken.length() > 0) {
                 offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Authorization: Bearer %s\r\n", _authToken.c_str());
             }
             // Copy PROGMEM strings to RAM for snprintf
@@ -790,177 +937,149 @@ void GPRSManager::updateHttpOperations() {
             strncpy_P(fwVersionRAM, FW_VERSION, sizeof(fwVersionRAM) - 1);
             fwVersionRAM[sizeof(fwVersionRAM) - 1] = '\0';
             offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "User-Agent: %s/%s\r\n", fwNameRAM, fwVersionRAM);
-            if (strlen(_asyncPayload.c_str()) > 0) {
+            if (_asyncValidators.etag[0] != '\0') {
+                offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "If-None-Match: %s\r\n", _asyncValidators.etag);
+            }
+            if (_asyncValidators.lastModified[0] != '\0') {
+                offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "If-Modified-Since: %s\r\n", _asyncValidators.lastModified);
+            }
+            if (_asyncIdempotencyKey[0] != '\0') {
+                offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Idempotency-Key: %s\r\n", _asyncIdempotencyKey);
+            }
+            if (_asyncPayload.length() > 0) {
                 offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Content-Type: application/json\r\n");
-                offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Content-Length: %d\r\n", strlen(_asyncPayload.c_str()));
+                offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Content-Length: %u\r\n", (unsigned)_asyncPayload.length());
             }
-            offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Connection: close\r\n\r\n"); 
+            offset += snprintf(requestBuffer + offset, sizeof(requestBuffer) - offset, "Connection: keep-alive\r\n\r\n");
             
             if (offset >= sizeof(requestBuffer)) {
                  DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: HTTP headers too large for request buffer.\n", _asyncApiType.c_str());
                 _currentHttpState = GPRSHttpState::ERROR;
-                if(_gprsClient.connected()) _gprsClient.stop();
+                closeConnection();
                 break;
             }
-            if (strlen(_asyncPayload.c_str()) > 0) {
-                if (offset + strlen(_asyncPayload.c_str()) < sizeof(requestBuffer)) {
-                    memcpy(requestBuffer + offset, _asyncPayload.c_str(), strlen(_asyncPayload.c_str()));
-                    offset += strlen(_asyncPayload.c_str());
-                } else {
-                    DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Payload too large for request buffer with headers.\n", _asyncApiType.c_str());
-                    _currentHttpState = GPRSHttpState::ERROR;
-                    if(_gprsClient.connected()) _gprsClient.stop();
-                    break;
-                }
+            // Small bodies go out in the same write as the headers; bulk bodies (telemetry replay) follow in a second write.
+            size_t bodyLen = _asyncPayload.length();
+            bool bodyInline = bodyLen > 0 && offset + bodyLen < sizeof(requestBuffer);
+            if (bodyInline) {
+                memcpy(requestBuffer + offset, _asyncPayload.c_str(), bodyLen);
+                offset += bodyLen;
             }
             DEBUG_PRINTF(5, "GPRS HTTP Request:\n%s\n", requestBuffer); 
-            size_t sent = _gprsClient.write(reinterpret_cast<const uint8_t*>(requestBuffer), offset);
-            if (sent != (size_t)offset) {
-                 DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Failed to send full request. Sent %u/%d\n", _asyncApiType.c_str(), sent, offset);
+            size_t total = offset + (bodyInline ? 0 : bodyLen);
+            size_t sent = activeClient().write(reinterpret_cast<const uint8_t*>(requestBuffer), offset);
+            if (sent == (size_t)offset && total > (size_t)offset) {
+                sent += activeClient().write(reinterpret_cast<const uint8_t*>(_asyncPayload.c_str()), bodyLen);
+            }
+            if (sent != total && reconnectIfStale()) break;
+            if (sent != total) {
+                 DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Failed to send full request. Sent %u/%u\n", _asyncApiType.c_str(), (unsigned)sent, (unsigned)total);
                 _currentHttpState = GPRSHttpState::ERROR;
-                if(_gprsClient.connected()) _gprsClient.stop();
+                closeConnection();
                  if (_currentGprsState == GPRSState::GPRS_STATE_OPERATIONAL) transitionToState(GPRSState::GPRS_STATE_CONNECTION_LOST);
                 break;
             }
-            _gprsResponseBuffer = ""; 
+            resetResponseBuffers();
             _asyncRequestStartTime = millis(); 
             _currentHttpState = GPRSHttpState::HEADERS_RECEIVING;
             DEBUG_PRINTF(3, "GPRSManager Async (%s): Request sent, awaiting headers.\n", _asyncApiType.c_str());
             break;
         }
 
-        case GPRSHttpState::HEADERS_RECEIVING:
-            if (!_gprsClient.connected() && _currentHttpState == GPRSHttpState::HEADERS_RECEIVING) {
+        case GPRSHttpState::HEADERS_RECEIVING: {
+            if (!activeClient().connected() && !activeClient().available()) {
+                 if (reconnectIfStale()) break;
                  DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Client not connected while waiting for headers.\n", _asyncApiType.c_str());
                  _currentHttpState = GPRSHttpState::ERROR;
                  break; 
             }
-            while (_gprsClient.available()) { 
-                char c = _gprsClient.read();
-                if (c == -1) continue; 
-                _gprsResponseBuffer += c;
-                if (_gprsResponseBuffer.length() >= GPRS_MAX_HEADER_SIZE) { 
+            // Bulk-read straight into the header buffer, which scans only the newly arrived bytes for "\r\n\r\n".
+            bool headersDone = false;
+            int avail;
+            while (!headersDone && (avail = activeClient().available()) > 0) {
+                size_t space = _gprsHeaders.space();
+                if (space == 0) {
                     DEBUG_PRINTLN(1, "GPRSManager: Max header size reached.");
                     _currentHttpState = GPRSHttpState::ERROR;
-                    if (_gprsClient.connected()) _gprsClient.stop();
-                    goto end_gprs_header_check_label; 
+                    closeConnection();
+                    break;
                 }
-                if (_gprsResponseBuffer.endsWith("\r\n\r\n")) { 
-                    DEBUG_PRINTF(3, "GPRSManager Async (%s): Headers received.\n", _asyncApiType.c_str());
-                    DEBUG_PRINTF(5, "GPRS HTTP Headers:\n%s\n", _gprsResponseBuffer.c_str());
-
-                    int firstSpace = _gprsResponseBuffer.indexOf(' ');
-                    int secondSpace = (firstSpace != -1) ? _gprsResponseBuffer.indexOf(' ', firstSpace + 1) : -1;
-                    if (secondSpace != -1 && firstSpace != -1 && (secondSpace > firstSpace)) {
-                        _gprsHttpStatusCode = _gprsResponseBuffer.substring(firstSpace + 1, secondSpace).toInt();
-                        DEBUG_PRINTF(3, "GPRSManager Async (%s): Status %d\n", _asyncApiType.c_str(), _gprsHttpStatusCode);
-                    } else {
-                        DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Could not parse HTTP status line: '%s'\n", _asyncApiType.c_str(), _gprsResponseBuffer.substring(0, _gprsResponseBuffer.indexOf('\r')).c_str());
-                        _gprsHttpStatusCode = 0; 
-                         _currentHttpState = GPRSHttpState::ERROR; 
-                        if (_gprsClient.connected()) _gprsClient.stop();
-                        goto end_gprs_header_check_label;
-                    }
-
-                    String tempHeaders = _gprsResponseBuffer; tempHeaders.toLowerCase();
-                    int clPos = tempHeaders.indexOf("content-length:");
-                    if (clPos != -1) {
-                        int clValStart = clPos + strlen("content-length:");
-                        int clEnd = _gprsResponseBuffer.indexOf("\r\n", clValStart);
-                        if (clEnd != -1) {
-                             _gprsContentLength = _gprsResponseBuffer.substring(clValStart, clEnd).toInt();
-                            DEBUG_PRINTF(3, "GPRSManager Async (%s): Content-Length: %lu\n", _asyncApiType.c_str(), _gprsContentLength);
-                        } else { _gprsContentLength = 0; }
-                    } else { _gprsContentLength = 0; } 
-                    
-                    _gprsChunkedEncoding = (tempHeaders.indexOf("transfer-encoding: chunked") != -1);
-                    if(_gprsChunkedEncoding) {
-                        DEBUG_PRINTF(3, "GPRSManager Async (%s): Chunked transfer encoding detected.\n", _asyncApiType.c_str());
-                        _gprsContentLength = 0; 
-                    }
+                size_t want = ((size_t)avail < space) ? (size_t)avail : space;
+                int n = activeClient().read(reinterpret_cast<uint8_t*>(_gprsHeaders.writePtr()), want);
+                if (n <= 0) break;
+                headersDone = _gprsHeaders.commit((size_t)n);
+            }
 
-                    int bodyStartIndex = _gprsResponseBuffer.indexOf("\r\n\r\n");
-                    String initialBodyChunk = (bodyStartIndex != -1) ? _gprsResponseBuffer.substring(bodyStartIndex + 4) : "";
-                    _gprsResponseBuffer = initialBodyChunk; 
-                    _gprsBodyBytesRead = _gprsResponseBuffer.length();
+            if (headersDone) {
+                DEBUG_PRINTF(3, "GPRSManager Async (%s): Headers received.\n", _asyncApiType.c_str());
+                DEBUG_PRINTF(5, "GPRS HTTP Headers:\n%s\n", _gprsHeaders.headers());
+                if (!parseResponseHeaders()) {
+                    DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Could not parse HTTP status line.\n", _asyncApiType.c_str());
+                    _currentHttpState = GPRSHttpState::ERROR;
+                    closeConnection();
+                    break;
+                }
+                // Anything read past the blank line already belongs to the body.
+                if (_gprsHeaders.earlyBodyLength() > 0) storeBodyBytes(_gprsHeaders.earlyBody(), _gprsHeaders.earlyBodyLength());
+                DEBUG_PRINTF(3, "GPRSManager Async (%s): Status %d\n", _asyncApiType.c_str(), _gprsHttpStatusCode);
+                if (_gprsChunkedEncoding) {
+                    DEBUG_PRINTF(3, "GPRSManager Async (%s): Chunked transfer encoding detected.\n", _asyncApiType.c_str());
+                } else if (_gprsContentLength > 0) {
+                    DEBUG_PRINTF(3, "GPRSManager Async (%s): Content-Length: %lu\n", _asyncApiType.c_str(), _gprsContentLength);
+                }
 
-                    if (_gprsHttpStatusCode >= 200 && _gprsHttpStatusCode < 300) {
-                        if (!_gprsChunkedEncoding && _gprsContentLength == 0 && _gprsBodyBytesRead == 0) { 
-                            _currentHttpState = GPRSHttpState::PROCESSING_RESPONSE;
-                        } else {
-                            _currentHttpState = GPRSHttpState::BODY_RECEIVING;
-                            _asyncRequestStartTime = millis(); 
-                        }
-                    } else if (_gprsHttpStatusCode == 0) { 
-                        if (_gprsClient.connected()) _gprsClient.stop();
-                    }
-                     else { 
-                        DEBUG_PRINTF(1, "GPRSManager Async (%s) HTTP Status: %d (Error/Redirect). Reading body.\n", _asyncApiType.c_str(), _gprsHttpStatusCode);
+                if (_gprsHttpStatusCode == 204 || _gprsHttpStatusCode == 304 ||
+                    (!_gprsChunkedEncoding && _gprsHasContentLength && _gprsContentLength == 0)) {
+                    _currentHttpState = GPRSHttpState::PROCESSING_RESPONSE; // No body follows; do not wait for the server to close
+                } else if (_gprsHttpStatusCode >= 200 && _gprsHttpStatusCode < 300) {
+                    if (!_gprsChunkedEncoding && !_gprsHasContentLength && _gprsBodyBytesRead == 0 && !activeClient().connected()) {
+                        _currentHttpState = GPRSHttpState::PROCESSING_RESPONSE;
+                    } else {
                         _currentHttpState = GPRSHttpState::BODY_RECEIVING;
                         _asyncRequestStartTime = millis(); 
                     }
-                    goto end_gprs_header_check_label; 
+                } else { 
+                    DEBUG_PRINTF(1, "GPRSManager Async (%s) HTTP Status: %d (Error/Redirect). Reading body.\n", _asyncApiType.c_str(), _gprsHttpStatusCode);
+                    _currentHttpState = GPRSHttpState::BODY_RECEIVING;
+                    _asyncRequestStartTime = millis(); 
                 }
+                break;
             }
-            end_gprs_header_check_label:; 
 
             if (_currentHttpState == GPRSHttpState::HEADERS_RECEIVING) { 
                 if (currentTime - _asyncRequestStartTime > GPRS_HTTP_HEADER_TIMEOUT_MS) { 
                     DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Header receive timeout.\n", _asyncApiType.c_str());
                     _currentHttpState = GPRSHttpState::ERROR;
-                    if (_gprsClient.connected()) _gprsClient.stop();
-                } else if (!_gprsClient.connected()) { 
+                    closeConnection();
+                } else if (!activeClient().connected() && !activeClient().available()) { 
+                     if (reconnectIfStale()) break;
                      DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Client disconnected while waiting for headers.\n", _asyncApiType.c_str());
                      _currentHttpState = GPRSHttpState::ERROR;
                 }
             }
             break;
+        }
 
         case GPRSHttpState::BODY_RECEIVING:
-             if (!_gprsClient.connected() && !_gprsChunkedEncoding && (_gprsContentLength == 0 || _gprsBodyBytesRead < _gprsContentLength) ) {
-                 DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Client disconnected prematurely during body. Read %lu/%lu\n", _asyncApiType.c_str(), _gprsBodyBytesRead, _gprsContentLength);
-                 _currentHttpState = (_gprsBodyBytesRead > 0 || (_gprsHttpStatusCode >=200 && _gprsHttpStatusCode <300 && _gprsContentLength == 0) ) ? GPRSHttpState::PROCESSING_RESPONSE : GPRSHttpState::ERROR;
-                 break;
-            }
-            while (_gprsClient.available()) {
-                if (_gprsResponseBuffer.length() < GPRS_BODY_BUFFER_SIZE - 1) {
-                     char c = (char)_gprsClient.read();
-                     if (c == -1) continue;
-                     _gprsResponseBuffer += c;
-                     _gprsBodyBytesRead++;
-                } else {
-                    DEBUG_PRINTF(1, "GPRSManager Async (%s) CRITICAL: Body buffer full (%d bytes)! Response truncated. JSON parsing will likely fail. Increase GPRS_BODY_BUFFER_SIZE.\n", _asyncApiType.c_str(), GPRS_BODY_BUFFER_SIZE);
-                    while(_gprsClient.available()) _gprsClient.read(); // Discard remaining bytes
-                    break;
-                }
-            }
-            
+            readBodyFromClient();
+
             bodyComplete = false;
             if (_gprsChunkedEncoding) {
-                if (_gprsResponseBuffer.indexOf("\r\n0\r\n\r\n") != -1) {
-                    String unchunkedBody = "";
-                    int currentPos = 0;
-                    while(true) {
-                        int chunkSizeHexEnd = _gprsResponseBuffer.indexOf("\r\n", currentPos);
-                        if (chunkSizeHexEnd == -1) break; 
-                        String chunkSizeHex = _gprsResponseBuffer.substring(currentPos, chunkSizeHexEnd);
-                        long chunkSize = strtol(chunkSizeHex.c_str(), NULL, 16);
-                        if (chunkSize == 0) {bodyComplete = true; break;}
-                        int chunkDataStart = chunkSizeHexEnd + 2; 
-                        if (chunkDataStart + chunkSize > _gprsResponseBuffer.length()) break; 
-                        unchunkedBody += _gprsResponseBuffer.substring(chunkDataStart, chunkDataStart + chunkSize);
-                        currentPos = chunkDataStart + chunkSize + 2; 
-                        if (currentPos >= _gprsResponseBuffer.length() -1 && chunkSize !=0 ) break; // Break if not enough for next chunk size unless it's the final 0 chunk
-                        else if (currentPos >= _gprsResponseBuffer.length() -1 && chunkSize ==0 ) {bodyComplete = true; break;}// Final chunk parsed
-                    }
-                     if (bodyComplete) _gprsResponseBuffer = unchunkedBody;
-                } else if (!_gprsClient.connected() && _gprsBodyBytesRead > 0) { 
+                if (_chunkedDecoder.hasError()) {
+                    DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Malformed chunked body.\n", _asyncApiType.c_str());
+                    closeConnection();
+                    _currentHttpState = GPRSHttpState::ERROR;
+                    break;
+                }
+                if (_chunkedDecoder.isDone()) {
+                    bodyComplete = true;
+                } else if (!activeClient().connected() && !activeClient().available() && _gprsBodyBytesRead > 0) { 
                     DEBUG_PRINTLN(2, "GPRSManager: Client disconnected during chunked transfer. Assuming complete (may be partial).");
-                    bodyComplete = true; 
+                    bodyComplete = true;
                 }
             } else { 
-                if (_gprsContentLength > 0 && _gprsBodyBytesRead >= _gprsContentLength) bodyComplete = true;
-                else if (_gprsContentLength == 0 && !_gprsClient.connected()) {
+                if (_gprsHasContentLength && _gprsBodyBytesRead >= _gprsContentLength) bodyComplete = true;
+                else if (!_gprsHasContentLength && !activeClient().connected() && !activeClient().available()) {
                     bodyComplete = true;
                 }
             }
@@ -970,15 +1089,15 @@ void GPRSManager::updateHttpOperations() {
                 _currentHttpState = GPRSHttpState::PROCESSING_RESPONSE;
             } else if (currentTime - _asyncRequestStartTime > GPRS_HTTP_BODY_TIMEOUT_MS) { 
                  DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Body receive timeout. Read %lu bytes.\n", _asyncApiType.c_str(), _gprsBodyBytesRead);
-                 if (_gprsBodyBytesRead > 0 && _gprsHttpStatusCode >= 200 && _gprsHttpStatusCode < 300) {
+                 if (_gprsBodyBytesRead > 0 && _gprsHttpStatusCode >= 200 && _gprsHttpStatusCode < 300 && !_gprsChunkedEncoding) {
                      DEBUG_PRINTLN(2, "GPRSManager: Processing partial body from timeout.");
                     _currentHttpState = GPRSHttpState::PROCESSING_RESPONSE; 
                  } else {
                     _currentHttpState = GPRSHttpState::ERROR;
                  }
-            } else if (!_gprsClient.connected() && _currentHttpState == GPRSHttpState::BODY_RECEIVING) {
-                DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Client disconnected, body not complete. Read %lu.\n", _asyncApiType.c_str(), _gprsBodyBytesRead);
-                if (_gprsBodyBytesRead > 0 || (_gprsHttpStatusCode >=200 && _gprsHttpStatusCode <300 && _gprsContentLength == 0) ) {
+            } else if (!activeClient().connected() && !activeClient().available()) {
+                DEBUG_PRINTF(1, "GPRSManager Async (%s) Err: Client disconnected, body not complete. Read %lu/%lu\n", _asyncApiType.c_str(), _gprsBodyBytesRead, _gprsContentLength);
+                if (_gprsBodyBytesRead > 0 && !_gprsChunkedEncoding) {
                      _currentHttpState = GPRSHttpState::PROCESSING_RESPONSE; 
                 } else {
                     _currentHttpState = GPRSHttpState::ERROR;
@@ -988,15 +1107,30 @@ void GPRSManager::updateHttpOperations() {
 
         case GPRSHttpState::PROCESSING_RESPONSE: {
             DEBUG_PRINTF(4, "GPRSManager Async (%s): Processing. Status: %d\n", _asyncApiType.c_str(), _gprsHttpStatusCode);
-            DEBUG_PRINTF(5, "GPRS HTTP Body:\n%s\n", _gprsResponseBuffer.c_str());
+            DEBUG_PRINTF(5, "GPRS HTTP Body:\n%s\n", _gprsBodyBuffer);
             cbOk = false;
-            if (_gprsHttpStatusCode >= 200 && _gprsHttpStatusCode < 300) { 
+            HttpResponseInfo info = {};
+            info.statusCode = _gprsHttpStatusCode;
+            info.bodyBytes = _gprsChunkedEncoding ? _chunkedDecoder.getPayloadBytes() : _gprsBodyBytesRead; // After de-chunking.
+            if (_gprsHttpStatusCode == 304 && _asyncValidators.isSet()) {
+                // Our cached copy is current: a 304 has no body, and the callback already saw this data.
+                DEBUG_PRINTF(3, "GPRSManager Async (%s): 304 Not Modified, skipping body and callback.\n", _asyncApiType.c_str());
+                info.notModified = true;
+                cbOk = true;
+            } else if (_gprsBodyTruncated) {
+                DEBUG_PRINTF(1, "GPRSManager Async (%s) CRITICAL: Body exceeded %d bytes and was truncated. Increase GPRS_BODY_BUFFER_SIZE.\n", _asyncApiType.c_str(), GPRS_BODY_BUFFER_SIZE);
+            } else if (_gprsHttpStatusCode >= 200 && _gprsHttpStatusCode < 300) { 
                 if (_asyncCb) {
                     _jsonDoc.clear(); 
-                    DeserializationError err = deserializeJson(_jsonDoc, _gprsResponseBuffer);
+                    const JsonDocument* filter = getApiResponseFilter(classifyApiResponse(_asyncApiType.c_str()));
+                    unsigned long parseStartUs = micros();
+                    DeserializationError err = filter
+                        ? deserializeJson(_jsonDoc, (const char*)_gprsBodyBuffer, _gprsBodyLen, DeserializationOption::Filter(*filter))
+                        : deserializeJson(_jsonDoc, (const char*)_gprsBodyBuffer, _gprsBodyLen);
+                    info.parseUs = micros() - parseStartUs;
                     if (err) {
                         DEBUG_PRINTF(1, "GPRSManager Async (%s): JSON Fail: %s\n", _asyncApiType.c_str(), err.c_str());
-                        DEBUG_PRINTF(4, "Failed JSON: %s\n", _gprsResponseBuffer.c_str());
+                        DEBUG_PRINTF(4, "Failed JSON: %s\n", _gprsBodyBuffer);
                     } else {
                         cbOk = _asyncCb(_jsonDoc);
                          if (!cbOk) {
@@ -1009,31 +1143,31 @@ void GPRSManager::updateHttpOperations() {
                     cbOk = true;
                     DEBUG_PRINTF(3, "GPRSManager Async (%s): No CB, HTTP 2xx success.\n", _asyncApiType.c_str());
                 }
-            } else { 
-                 DEBUG_PRINTF(1, "GPRSManager Async (%s): HTTP Error %d.\n", _asyncApiType.c_str(), _gprsHttpStatusCode);
-                 if (_asyncCb && _gprsHttpStatusCode != 0) { 
-                    _jsonDoc.clear();
-                    DeserializationError err = deserializeJson(_jsonDoc, _gprsResponseBuffer);
-                    if (!err) {
-                        DEBUG_PRINTLN(2, "GPRSManager: Calling CB for HTTP error response.");
-                        _asyncCb(_jsonDoc); // Call CB but its return doesn't make cbOk true
-                    }
-                 }
+                // Only validators of a response the callback accepted are worth revalidating later.
+                if (cbOk) info.validators = _gprsResponseValidators;
+            } else {
+                // Like WiFiManager, an error body never reaches the callback: callbacks read a 2xx body as success
+                // (the telemetry outbox would ack the whole batch on a JSON error reply).
+                DEBUG_PRINTF(1, "GPRSManager Async (%s): HTTP Error %d. Response: %.96s\n", _asyncApiType.c_str(), _gprsHttpStatusCode, _gprsBodyBuffer);
             }
-            if(_gprsClient.connected()) _gprsClient.stop();
+            // Keep the socket only if the body was framed and read to its end and the server agreed to keep-alive.
+            releaseConnection(_gprsServerKeepAlive &&
+                              (_gprsChunkedEncoding ? _chunkedDecoder.isDone()
+                                                    : (_gprsHasContentLength && _gprsBodyBytesRead >= _gprsContentLength)));
+            if (_responseObserver) _responseObserver(_asyncUrl.c_str(), info);
             _currentHttpState = cbOk ? GPRSHttpState::COMPLETE : GPRSHttpState::ERROR;
             break;
         }
         case GPRSHttpState::COMPLETE:
             DEBUG_PRINTF(3, "GPRSManager Async (%s): Operation complete.\n", _asyncApiType.c_str());
-            if(_gprsClient.connected()) _gprsClient.stop();
+            closeConnection();
             _asyncOperationActive = false;
             _currentHttpState = GPRSHttpState::IDLE; 
             break;
 
         case GPRSHttpState::ERROR:
             DEBUG_PRINTF(1, "GPRSManager Async (%s): Operation failed. Status: %d. Retries: %d/%d\n", _asyncApiType.c_str(), _gprsHttpStatusCode, _httpRetries, MAX_HTTP_RETRIES);
-            if(_gprsClient.connected()) _gprsClient.stop();
+            closeConnection();
             
             if (isRetryableError(_gprsHttpStatusCode) && _httpRetries < MAX_HTTP_RETRIES) {
                 _httpRetries++;
@@ -1054,11 +1188,8 @@ void GPRSManager::updateHttpOperations() {
             if (millis() >= _asyncRequestStartTime) { // Check if delay has passed
                 DEBUG_PRINTF(2, "GPRSManager Async (%s): Retry delay complete. Attempting retry %d.\n", _asyncApiType.c_str(), _httpRetries);
                 // Reset relevant HTTP state variables before retrying
-                _gprsResponseBuffer = "";
+                resetResponseBuffers();
                 _gprsHttpStatusCode = 0;
-                _gprsContentLength = 0;
-                _gprsChunkedEncoding = false;
-                _gprsBodyBytesRead = 0;
                 _jsonDoc.clear();
                 _asyncRequestStartTime = millis(); // Reset start time for the new attempt
                 _currentHttpState = GPRSHttpState::CLIENT_CONNECT; // Start retry from client connect
@@ -1067,13 +1198,139 @@ void GPRSManager::updateHttpOperations() {
             break;
         default: 
             DEBUG_PRINTF(1, "GPRSManager Async (%s): Unhandled GPRSHttpState %d\n", _asyncApiType.c_str(), (int)_currentHttpState);
-            if(_gprsClient.connected()) _gprsClient.stop();
+            closeConnection();
             _currentHttpState = GPRSHttpState::ERROR; 
             _asyncOperationActive = false; 
             break;
     }
 }
 
+void GPRSManager::releaseConnection(bool keepOpen) {
+    if (!_slotAcquired) return;
+    _pool.release(_poolSlot, keepOpen, millis(), _gprsKeepAliveTimeoutMs);
+    _slotAcquired = false;
+}
+
+void GPRSManager::closeConnection() {
+    releaseConnection(false);
+}
+
+bool GPRSManager::reconnectIfStale() {
+    // Only a reused socket that produced no response at all is treated as closed by the server while idle.
+    if (!_slotAcquired || !_connReused || _staleRetryUsed || !_gprsHeaders.isEmpty()) return false;
+    _staleRetryUsed = true;
+    _connReused = false;
+    _pool.markStale(_poolSlot);
+    resetResponseBuffers();
+    _asyncRequestStartTime = millis();
+    _currentHttpState = GPRSHttpState::CLIENT_CONNECT;
+    return true;
+}
+
+void GPRSManager::resetResponseBuffers() {
+    _gprsHeaders.reset();
+    _gprsBodyLen = 0;
+    _gprsBodyBuffer[0] = '\0';
+    _gprsBodyTruncated = false;
+    _chunkedDecoder.reset();
+    _gprsContentLength = 0;
+    _gprsHasContentLength = false;
+    _gprsChunkedEncoding = false;
+    _gprsBodyBytesRead = 0;
+}
+
+/**
+ * @brief Makes the next request a conditional GET.
+ * Refer to GPRSManager.h for detailed documentation.
+ */
+void GPRSManager::setConditionalRequest(const HttpValidators* validators) {
+    if (validators) {
+        _pendingValidators = *validators;
+    } else {
+        memset(&_pendingValidators, 0, sizeof(_pendingValidators));
+    }
+}
+
+/**
+ * @brief Sets the idempotency key of the next request.
+ * Refer to GPRSManager.h for detailed documentation.
+ */
+void GPRSManager::setIdempotencyKey(const char* key) {
+    strlcpy(_pendingIdempotencyKey, key ? key : "", sizeof(_pendingIdempotencyKey));
+}
+
+bool GPRSManager::parseResponseHeaders() {
+    HttpResponseHead head;
+    bool ok = _gprsHeaders.parseResponseHeaders(head);
+    _gprsHttpStatusCode = head.statusCode;
+    _gprsServerKeepAlive = head.keepAlive;
+    _gprsHasContentLength = head.hasContentLength;
+    _gprsContentLength = head.contentLength;
+    _gprsChunkedEncoding = head.chunked;
+    _gprsKeepAliveTimeoutMs = head.keepAliveTimeoutMs;
+    _gprsResponseValidators = head.validators;
+    return ok;
+}
+
+void GPRSManager::storeBodyBytes(const char* data, size_t len) {
+    _gprsBodyBytesRead += len;
+    size_t space = (GPRS_BODY_BUFFER_SIZE - 1) - _gprsBodyLen;
+    char* dest = _gprsBodyBuffer + _gprsBodyLen;
+    size_t stored;
+
+    if (_gprsChunkedEncoding) {
+        // Decoding never writes ahead of the input, so decoding in place (data == dest) is safe.
+        _chunkedDecoder.feed(data, len, dest, space, stored);
+        if (_chunkedDecoder.hasOverflowed()) {
+            if (!_gprsBodyTruncated) {
+                DEBUG_PRINTF(1, "GPRSManager Async (%s): Body exceeds %d bytes, discarding the rest.\n", _asyncApiType.c_str(), GPRS_BODY_BUFFER_SIZE - 1);
+            }
+            _gprsBodyTruncated = true;
+        }
+    } else {
+        stored = len;
+        if (stored > space) {
+            stored = space;
+            if (!_gprsBodyTruncated) {
+                DEBUG_PRINTF(1, "GPRSManager Async (%s): Body exceeds %d bytes, discarding the rest.\n", _asyncApiType.c_str(), GPRS_BODY_BUFFER_SIZE - 1);
+            }
+            _gprsBodyTruncated = true;
+        }
+        if (data != dest) memcpy(dest, data, stored);
+    }
+    _gprsBodyLen += stored;
+    _gprsBodyBuffer[_gprsBodyLen] = '\0';
+}
+
+void GPRSManager::readBodyFromClient() {
+    int avail;
+    while ((avail = activeClient().available()) > 0) {
+        size_t want = (size_t)avail;
+        if (_gprsChunkedEncoding && (_chunkedDecoder.isDone() || _chunkedDecoder.hasError())) break;
+        if (!_gprsChunkedEncoding && _gprsHasContentLength) {
+            if (_gprsBodyBytesRead >= _gprsContentLength) break;
+            unsigned long remaining = _gprsContentLength - _gprsBodyBytesRead;
+            if (want > remaining) want = remaining;
+        }
+
+        size_t space = (GPRS_BODY_BUFFER_SIZE - 1) - _gprsBodyLen;
+        if (space > 0) {
+            // Read straight into the body buffer; storeBodyBytes() then de-chunks in place or only updates the bookkeeping.
+            if (want > space) want = space;
+            int n = activeClient().read(reinterpret_cast<uint8_t*>(_gprsBodyBuffer + _gprsBodyLen), want);
+            if (n <= 0) break;
+            storeBodyBytes(_gprsBodyBuffer + _gprsBodyLen, (size_t)n);
+        } else {
+            // Buffer full: drain through a small scratch buffer so the transfer can complete.
+            char discard[64];
+            if (want > sizeof(discard)) want = sizeof(discard);
+            int n = activeClient().read(reinterpret_cast<uint8_t*>(discard), want);
+            if (n <= 0) break;
+            storeBodyBytes(discard, (size_t)n);
+        }
+    }
+}
+
 void GPRSManager::printModemErrorCause() {
     #if DEBUG_LEVEL >= 1 
     // AT+CEER might not be universally supported or could interfere.
@@ -26,9 +26,9 @@
  *     - Parsing JSON responses using `ArduinoJson`.
  *     - Invoking user-provided callback functions (`_asyncCb`) with the parsed JSON.
  *     - Handling HTTP-level errors and retries (up to `MAX_HTTP_RETRIES` from `config.h`).
- * - **Status Reporting**: Optionally interacts with an `LCDDisplay` for visual feedback
- *   on GPRS and HTTP operations. Provides methods like `getStatusString()`, `getSignalQuality()`,
- *   and `getIPAddress()`.
+ * - **Status Reporting**: Provides methods like `getStatusString()`, `getSignalQuality()`,
+ *   `getIPAddress()` and `getGprsState()`. The manager runs on the network worker task and never touches the LCD;
+ *   the worker reports a failed modem to the control loop as a status event.
  *
  * Key Dependencies:
  * - `config.h`: Provides compile-time configurations such as the specific modem type
@@ -53,13 +53,17 @@
 #include "config.h"           // Essential: TINY_GSM_MODEM_*, serial pins, buffer sizes, timeouts, retry limits, JSON_DOC_SIZE_DEVICE_CONFIG.
 #include "NetworkInterface.h" // Defines the base class NetworkInterface and its virtual methods.
 #include "DeviceState.h"      // Provides `GPRSState` enum and `DeviceState` struct for global status.
+#include "ChunkedDecoder.h"   // Streaming decoder for chunked HTTP response bodies.
+#include "HttpHeaderBuffer.h" // Response header block, filled by bulk reads and parsed in place.
+#include "HttpConnectionPool.h" // Keep-alive socket reuse across requests.
+#include "AtCommandEngine.h"  // Non-blocking AT commands and +CREG/+CGREG URCs for the connection FSM.
+#include "ModemResetSequencer.h" // Non-blocking modem reset sub-steps.
 #include <TinyGsmCommon.h>   // Core TinyGSM definitions.
 #include <TinyGsmClient.h>   // `TinyGsmClient` for TCP/IP over GPRS (used for HTTP).
 // #include <TinyGsmClientSecure.h> // For HTTPS - typically requires specific modem features and more resources.
 #include <ArduinoJson.h>     // For parsing/creating JSON (HTTP response/request bodies).
 
 // Forward declarations
-class LCDDisplay; // Optional, for displaying status messages.
 // struct DeviceState; // Already included via DeviceState.h.
 // class TinyGsm;      // The actual TinyGsm modem object (e.g., TinyGsmSim800 from config.h) is passed by reference.
 
@@ -93,6 +97,8 @@ public:
      * @param modem Reference to an initialized `TinyGsm` modem object (e.g., an instance of `TinyGsmSim800`
      *              defined based on `TINY_GSM_MODEM_SIM800` from `config.h`). This object is used for all
      *              AT command interactions with the modem.
+     * @param at The `AtCommandEngine` that `modem` was constructed over. The connection FSM queues its status and
+     *           attach commands here instead of calling TinyGSM's blocking equivalents.
      * @param apn The Access Point Name (APN) string for the GPRS network provider. Max length defined by `GPRS_APN_MAX_LEN`.
      * @param gprsUser Username for GPRS connection, if required by the APN provider. Can be empty or `nullptr`. Max length: `GPRS_USER_MAX_LEN`.
      * @param gprsPass Password for GPRS connection, if required by the APN provider. Can be empty or `nullptr`. Max length: `GPRS_PWD_MAX_LEN`.
@@ -102,24 +108,22 @@ public:
      *                  if the `needsAuth` parameter in `startAsyncHttpRequest()` is true. Max length: `API_TOKEN_MAX_LEN`.
      * @param deviceState Pointer to the global `DeviceState` object. This manager will update `deviceState->gprsState`
      *                    to reflect the current status of the GPRS connection.
-     * @param lcd Optional pointer to an `LCDDisplay` object. If provided, status messages and errors related to
-     *            GPRS and HTTP operations may be displayed on the LCD. Defaults to `nullptr`.
      */
     GPRSManager(
         TinyGsm& modem,
+        AtCommandEngine& at,
         const char* apn,
         const char* gprsUser,
         const char* gprsPass,
         const char* simPin,
         const char* authToken,
-        DeviceState* deviceState,
-        LCDDisplay* lcd = nullptr
+        DeviceState* deviceState
     );
 
     /**
      * @brief Destructor for `GPRSManager`.
      * Ensures proper cleanup, primarily by attempting to disconnect from the GPRS network
-     * if a connection is active (`_gprsClient.stop()`, `_modem.gprsDisconnect()`).
+     * if a connection is active (`_pool.closeAll()`, `_modem.gprsDisconnect()`).
      */
     ~GPRSManager() override;
 
@@ -146,7 +150,7 @@ public:
      *
      * This method attempts to gracefully terminate the GPRS connection.
      * It typically involves:
-     * - Stopping any active `_gprsClient` TCP connections.
+     * - Stopping any active pooled `_gprsClients` TCP connections.
      * - Instructing the modem to detach from the GPRS service (`_modem.gprsDisconnect()`).
      * - Transitioning the GPRS FSM to `GPRS_DISCONNECTED` or `GPRS_IDLE`.
      * The actual disconnection might take some time and is handled by the GPRS FSM via `updateFSM()`.
@@ -180,7 +184,7 @@ public:
      * @param payload The request body string, typically for "POST" requests. Can be `nullptr` or empty for "GET".
      *                If provided for POST, "Content-Type: application/json" and "Content-Length" headers
      *                are typically added automatically.
-     * @param cb A `std::function<bool(JsonDocument& doc)>` callback. This function will be invoked
+     * @param cb An `HttpResponseCallback`. This function will be invoked
      *           upon successful completion of the HTTP request and parsing of its JSON response body.
      *           The `JsonDocument` passed to the callback contains the parsed response.
      *           The callback should return `true` if it successfully processed the data, `false` otherwise.
@@ -197,7 +201,7 @@ public:
         const char* method,
         const char* apiType,
         const char* payload,
-        std::function<bool(JsonDocument& doc)> cb,
+        const HttpResponseCallback& cb,
         bool needsAuth = true
     ) override;
 
@@ -206,7 +210,7 @@ public:
      *
      * This method must be called repeatedly from the main application loop. It drives the
      * state transitions of the active HTTP request, including:
-     * - Connecting the `_gprsClient` to the remote server.
+     * - Connecting (or reusing) a pooled `_gprsClients` socket to the remote server.
      * - Sending HTTP request headers and body.
      * - Receiving HTTP response headers and body.
      * - Handling timeouts and retries (up to `MAX_HTTP_RETRIES`).
@@ -215,6 +219,36 @@ public:
      */
     void updateHttpOperations() override;
 
+    /**
+     * @brief Checks whether an asynchronous HTTP operation is currently in progress.
+     * @return The value of `_asyncOperationActive`. While `true`, `startAsyncHttpRequest()` rejects new requests.
+     */
+    bool isHttpOperationActive() const override;
+
+    /**
+     * @brief Abandons the request in flight: closes its socket and returns the HTTP FSM to `IDLE` without a retry.
+     */
+    void abortHttpOperation() override;
+
+    /**
+     * @brief Makes the next request a conditional GET (`If-None-Match` / `If-Modified-Since`).
+     * Refer to `NetworkInterface::setConditionalRequest()`.
+     * @param validators Validators to send, or `nullptr` for an unconditional request.
+     */
+    void setConditionalRequest(const HttpValidators* validators) override;
+
+    /**
+     * @brief Sends an `Idempotency-Key` header with the next request. Refer to `NetworkInterface::setIdempotencyKey()`.
+     * @param key Header value, or `nullptr` for none.
+     */
+    void setIdempotencyKey(const char* key) override;
+
+    /**
+     * @brief Sets the observer told about each finished request.
+     * @param observer Called at the end of `PROCESSING_RESPONSE`; may be empty.
+     */
+    void setResponseObserver(ResponseObserver observer) override { _responseObserver = observer; }
+
     /**
      * @brief Provides a human-readable status string describing the current GPRS connection state.
      *
@@ -222,9 +256,9 @@ public:
      * signal quality (CSQ), network registration status, and the assigned IP address if connected.
      * Useful for debugging and display purposes.
      *
-     * @return `String` object containing the current GPRS status summary.
+     * @return The current GPRS status summary, held inline (no heap allocation).
      */
-    String getStatusString() const override;
+    NetworkStatusString getStatusString() const override;
 
     /**
      * @brief Sets a new authentication token to be used for subsequent API requests that require authentication.
@@ -235,24 +269,24 @@ public:
     void setAuthToken(const char* authToken);
 
     /**
-     * @brief Gets the current GPRS signal quality (CSQ) value from the modem.
+     * @brief Gets the last GPRS signal quality (CSQ) value reported by the modem.
      *
-     * The CSQ value reported by `_modem.getSignalQuality()` typically ranges from:
+     * Cached: `updateFSM()` queues `AT+CSQ` every `GPRS_SIGNAL_POLL_INTERVAL_MS`, so this never touches the UART.
+     * The value typically ranges from:
      * - 0 to 31: Indicating signal strength (higher is better).
      * - 99: Not known or not detectable.
      * This function returns the raw CSQ value.
      *
-     * @return `int` representing the raw signal quality (CSQ). Returns a value like 99 or a negative
-     *         number if the modem is not ready or an error occurs while querying.
+     * @return `int` representing the raw signal quality (CSQ); 99 until the first reply after a modem reset.
      */
     int getSignalQuality() const;
 
     /**
      * @brief Checks the GPRS modem's network registration and GPRS attachment status more thoroughly.
      *
-     * This queries the modem directly for:
-     * - Network registration status (e.g., using `AT+CREG?` which returns if registered, roaming, etc.).
-     * - GPRS attachment status (e.g., using `AT+CGATT?` which returns if GPRS service is available and attached).
+     * Answers from cached modem state, without a UART round trip:
+     * - Network registration status (from `+CREG` URCs and the FSM's `AT+CREG?` queries).
+     * - GPRS attachment status (bearer brought up by the attach script and confirmed by the periodic `AT+CGATT?`).
      * This is a more direct check than `isConnected()`, which relies on the FSM state.
      *
      * @return `true` if the modem reports being registered on the network AND attached to GPRS service.
@@ -260,14 +294,20 @@ public:
      */
     bool isModemConnected() const;
 
+    /**
+     * @brief Gets the state of the GPRS connection FSM.
+     * @return The current `GPRSState`.
+     */
+    GPRSState getGprsState() const { return _currentGprsState; }
+
     /**
      * @brief Gets the current IP address assigned to the ESP32 by the GPRS network.
-     * This is queried directly from the modem using `_modem.getLocalIP()`.
+     * This is the address the modem printed for the last `AT+CIFSR` (attach or link check).
      *
-     * @return `String` containing the IP address (e.g., "10.0.1.100").
+     * @return The IP address (e.g., "10.0.1.100"), held inline (no heap allocation).
      * @return An empty string or "0.0.0.0" if not connected or if an IP address is not yet available.
      */
-    String getIPAddress() const;
+    IpAddressString getIPAddress() const;
 
     /**
      * @brief Updates the GPRS connection Finite State Machine (FSM).
@@ -282,9 +322,26 @@ public:
      * - Handle persistent errors, potentially triggering modem resets (`_modemResetCount`, `MAX_MODEM_RESETS`).
      * It directly calls the appropriate `handleGprs...()` private method based on `_currentGprsState`
      * and updates `_deviceState->gprsState` via `transitionToState()`.
+     * It never sleeps: modem resets wait out their pin pulses and boot time as `ModemResetSequencer` sub-steps, and
+     * signal, registration and link checks and the bearer bring-up are queued on `_at` and completed by later
+     * calls (`AtCommandEngine::poll()` runs first on every call). Registration changes arrive as `+CREG`/`+CGREG`
+     * URCs. During a reset, the `AT` probes, the modem setup, SIM check and unlock and `AT+CIPSSL` are queued on `_at`
+     * as well; only the `AT` check before a reset (`checkModemSerial()`, 200 ms at most) still waits on the UART.
      */
     void updateFSM();
 
+    /**
+     * @brief Gets the keep-alive counters (requests, reuse, handshakes and handshake time).
+     * @return Reference to the connection pool statistics.
+     */
+    const HttpConnectionPool::Stats& getConnectionStats() const { return _pool.getStats(); }
+
+    /**
+     * @brief Gets the socket reserved for the MQTT push session, on modem mux channel `MQTT_GPRS_MUX`.
+     * @return `_pushClient`; separate from the HTTP pool so the session survives pool recycling.
+     */
+    Client* getPushClient() override { return &_pushClient; }
+
 private:
     // --- GPRS Connection Finite State Machine (FSM) ---
     // These private methods implement the logic for each state of the GPRS connection FSM.
@@ -302,15 +359,15 @@ private:
     void handleGprsInitStart();
     /** @brief GPRS FSM state handler for `GPRS_INIT_WAIT_SERIAL`: Waits for the modem's serial interface to become responsive (e.g., responds to "AT"). Uses `MODEM_SERIAL_CHECK_INTERVAL_MS` and `MODEM_SERIAL_CHECK_RETRIES`. Transitions to `GPRS_INIT_RESET_MODEM` on success, or an error state on failure. */
     void handleGprsInitWaitSerial();
-    /** @brief GPRS FSM state handler for `GPRS_INIT_RESET_MODEM`: Attempts to reset the modem (soft reset first, then hard reset if configured and supported via `MODEM_RST_PIN`). Manages `_modemResetCount`. Transitions to `GPRS_INIT_SET_APN` on successful reset sequence, or an error state. */
+    /** @brief GPRS FSM state handler for `GPRS_INIT_RESET_MODEM`: Resets the modem (soft reset first, then a hard reset: the `MODEM_POWER_ON`/`GSM_PWR`/`GSM_RST` pin sequence if `GPRS_MODEM_HARD_RESET_PINS`, else a wait and `AT+CFUN=1,1`) through `_modemReset`, returning at once while a sub-step waits. Manages `_modemResetCount`. Transitions to `GPRS_INIT_ATTACH_GPRS` on successful reset sequence, or an error state. */
     void handleGprsInitResetModem();
     /** @brief GPRS FSM state handler for `GPRS_INIT_SET_APN`: Configures the APN, GPRS username, and password on the modem. Also handles SIM PIN unlocking if `_simPin` is set. Retries APN setting `MAX_APN_SET_RETRIES` times. Transitions to `GPRS_INIT_ATTACH_GPRS` on success. */
     void handleGprsInitSetApn();
-    /** @brief GPRS FSM state handler for `GPRS_INIT_ATTACH_GPRS`: Attempts to register on the network and attach to the GPRS service. Monitors `_modem.isNetworkConnected()` and `_modem.isGprsConnected()`. Retries `MAX_GPRS_ATTACH_FAILURES` times. Transitions to `GPRS_OPERATIONAL` (or `GPRS_INIT_CONNECT_TCP` if used) on success. */
+    /** @brief GPRS FSM state handler for `GPRS_INIT_ATTACH_GPRS`: Waits for network registration (`+CREG` URC, or `AT+CREG?` every `GPRS_REGISTRATION_POLL_MS`), then runs the bearer bring-up as a queued `AttachScript` and acts on its outcome. Retries `MAX_GPRS_ATTACH_FAILURES` times. Transitions to `GPRS_OPERATIONAL` (or `GPRS_INIT_CONNECT_TCP` if used) on success. */
     void handleGprsInitAttachGprs();
     /** @brief GPRS FSM state handler for `GPRS_INIT_CONNECT_TCP`: (Optional/Placeholder) If GPRS attach alone isn't sufficient, this state can verify basic TCP connectivity (e.g., to a test server). Often, `GPRS_OPERATIONAL` is entered directly after successful GPRS attach. Manages `_tcpConnectFailCount`. */
     void handleGprsInitConnectTcp();
-    /** @brief GPRS FSM state handler for `GPRS_OPERATIONAL`: The GPRS connection is active. This state periodically checks `_modem.isGprsConnected()`. If connection drops, transitions to `GPRS_CONNECTION_LOST`. */
+    /** @brief GPRS FSM state handler for `GPRS_OPERATIONAL`: The GPRS connection is active. Reacts to a lost registration reported by URC at once, and queues an `AT+CGATT?`/`AT+CIFSR` link check every `GPRS_CONNECTION_CHECK_INTERVAL_MS`. If connection drops, transitions to `GPRS_CONNECTION_LOST`. */
     void handleGprsOperational();
     /** @brief GPRS FSM state handler for `GPRS_CONNECTION_LOST`: Entered when an active GPRS connection is unexpectedly lost. Initiates the reconnection process by transitioning to `GPRS_RECONNECTING`. */
     void handleGprsConnectionLost();
@@ -322,18 +379,55 @@ private:
     void handleGprsErrorModemFail();
 
     /**
-     * @brief Performs a hard reset of the modem if `MODEM_RST_PIN` is defined in `config.h`.
-     * Toggles the reset pin according to `MODEM_RST_PULSE_MS`.
-     * @return `true` if a hard reset was attempted (pin defined and toggled).
-     * @return `false` if `MODEM_RST_PIN` is not defined (hard reset not supported by hardware configuration).
+     * @enum AttachScript
+     * @brief Progress of the queued bearer bring-up in `GPRS_STATE_INIT_ATTACH_GPRS`.
+     */
+    enum class AttachScript : uint8_t {
+        IDLE,       ///< Not started (or outcome already handled).
+        RUNNING,    ///< Step `_attachStep` is queued on `_at`; each completion queues the next.
+        SUCCEEDED,  ///< All steps done; `_localIp` holds the address.
+        FAILED      ///< A required step failed or timed out.
+    };
+
+    /**
+     * @struct AttachStep
+     * @brief One command of the bearer bring-up script, built by `buildAttachStep()`.
+     */
+    struct AttachStep {
+        char text[AT_COMMAND_MAX_LEN]; ///< Command after "AT".
+        const char* info;              ///< Info line to capture (see `AtCommandEngine::submit()`), or `nullptr`.
+        const char* finalToken;        ///< Success line other than `OK`, or `nullptr`.
+        unsigned long timeoutMs;       ///< Command timeout.
+        bool required;                 ///< A failure aborts the script (optional steps mirror TinyGSM, which ignores them).
+        bool skip;                     ///< Step does not apply (e.g. no GPRS user name).
+    };
+
+    /**
+     * @brief Queues `AT+CREG?` and `AT+CGREG?`; their replies update `_netRegStatus`/`_gprsRegStatus`.
      */
-    bool performModemHardReset();
+    void queryRegistration();
     /**
-     * @brief Performs a soft reset of the modem using AT commands (e.g., `AT+CFUN=1,1` or `_modem.restart()`).
-     * @return `true` if the reset command was sent successfully and the modem acknowledged or began reset sequence.
-     * @return `false` if the command failed or the modem did not respond as expected.
+     * @brief Builds one step of the bearer bring-up script (TinyGSM's SIM800 `gprsConnect()` sequence).
+     * @param index Step index.
+     * @param step Filled with the command; `step.text` is "" if it does not fit `AT_COMMAND_MAX_LEN`.
+     * @return `false` past the last step.
      */
-    bool performModemSoftReset();
+    bool buildAttachStep(uint8_t index, AttachStep& step) const;
+    /**
+     * @brief Queues step `_attachStep` (skipping steps that do not apply), or marks the script finished.
+     */
+    void submitAttachStep();
+
+    /**
+     * @brief Finishes a successful reset (SIM ready, SSL enabled): turns on registration URCs and moves to
+     *        `GPRS_STATE_INIT_ATTACH_GPRS`.
+     */
+    void finishModemReset();
+    /**
+     * @brief Counts a failed reset and moves to `GPRS_STATE_ERROR_RESTART_MODEM`, or to `GPRS_STATE_ERROR_MODEM_FAIL`
+     *        after `GPRS_MAX_MODEM_RESETS`.
+     */
+    void failModemReset();
     /**
      * @brief Checks if the modem is responding to basic AT commands (typically "AT").
      * @return `true` if the modem sends an "OK" (or similar positive) response within a short timeout.
@@ -363,6 +457,21 @@ private:
     uint8_t _gprsAttachFailCount;               ///< Counter for consecutive failures specifically during the `GPRS_INIT_ATTACH_GPRS` state (network registration/GPRS attach). Compared against `MAX_GPRS_ATTACH_FAILURES`.
     uint8_t _tcpConnectFailCount;               ///< Counter for consecutive failures in the `GPRS_INIT_CONNECT_TCP` state (if this step is actively used for TCP tests). Compared against `MAX_TCP_CONNECT_FAILURES`.
     uint8_t _apnSetRetryCount;                  ///< Counter for retries when setting the APN (and SIM PIN) in the `GPRS_INIT_SET_APN` state. Compared against `MAX_APN_SET_RETRIES`.
+    ModemResetSequencer _modemReset;            ///< Timed sub-steps of `GPRS_STATE_INIT_RESET_MODEM`, started on entering it.
+    unsigned long _nextSignalPollMs;            ///< `millis()` of the next `AT+CSQ` refresh of `DeviceState::gprsSignalQuality`.
+    int _signalQuality;                         ///< Last `AT+CSQ` value; 99 (unknown) until the first reply.
+    bool _signalQueryPending;                   ///< An `AT+CSQ` is queued or in flight.
+    int8_t _netRegStatus;                       ///< Last `+CREG` status (1 home, 5 roaming); -1 unknown since the last reset.
+    int8_t _gprsRegStatus;                      ///< Last `+CGREG` status; -1 unknown since the last reset.
+    bool _regQueryPending;                      ///< `AT+CREG?`/`AT+CGREG?` are queued or in flight.
+    unsigned long _nextRegQueryMs;              ///< `millis()` of the next fallback registration query while unregistered.
+    AttachScript _attachScript;                 ///< Progress of the bearer bring-up.
+    uint8_t _attachStep;                        ///< Current step of the bring-up script.
+    uint8_t _attachRun;                         ///< Bumped per script run; replies to an abandoned run are ignored.
+    bool _gprsAttached;                         ///< The bearer is up, as of the last bring-up or link check.
+    bool _linkCheckPending;                     ///< The OPERATIONAL link check is queued or in flight.
+    bool _linkCheckFailed;                      ///< The last link check found the bearer down; handled by `handleGprsOperational()`.
+    char _localIp[16];                          ///< Local address printed by the last `AT+CIFSR`.
 
     // --- Asynchronous HTTP Request Finite State Machine (FSM) ---
     // These members support the FSM that manages a single asynchronous HTTP request at a time.
@@ -375,37 +484,44 @@ private:
      */
     enum class GPRSHttpState {
         IDLE,                   ///< HTTP FSM is idle; no active request. Ready to start a new one via `startAsyncHttpRequest()`.
-        CLIENT_CONNECT,         ///< `_gprsClient` is attempting to connect to the remote HTTP server (host `_gprsHost`, port `_gprsPort`). Uses `HTTP_CONNECT_TIMEOUT_MS`.
+        CLIENT_CONNECT,         ///< Takes a socket from `_pool`; a kept-alive one goes straight to `SENDING_REQUEST`, otherwise it is attempting to connect to the remote HTTP server (host `_gprsHost`, port `_gprsPort`). Uses `HTTP_CONNECT_TIMEOUT_MS`.
         SENDING_REQUEST,        ///< Actively sending the HTTP request (method, path, headers, and body if `_asyncPayload` exists) to the connected server. Uses `HTTP_SEND_TIMEOUT_MS`.
         HEADERS_RECEIVING,      ///< Waiting for and receiving HTTP response headers from the server. Looks for status line and important headers like Content-Length. Uses `HTTP_HEADER_TIMEOUT_MS`.
-        BODY_RECEIVING,         ///< Receiving the HTTP response body. Handles `_gprsContentLength` or chunked encoding. Accumulates data in `_gprsResponseBuffer`. Uses `HTTP_BODY_TIMEOUT_MS`.
-        PROCESSING_RESPONSE,    ///< All response data received (or timeout). Now parsing `_gprsResponseBuffer` (typically as JSON into `_jsonDoc`) and invoking the user callback `_asyncCb`.
+        BODY_RECEIVING,         ///< Receiving the HTTP response body. Handles `_gprsContentLength` or chunked encoding. Bulk-reads directly into `_gprsBodyBuffer`. Uses `HTTP_BODY_TIMEOUT_MS`.
+        PROCESSING_RESPONSE,    ///< All response data received (or timeout). Now parsing `_gprsBodyBuffer` (typically as JSON into `_jsonDoc`) and invoking the user callback `_asyncCb`.
         COMPLETE,               ///< HTTP request lifecycle finished successfully (response processed, callback returned `true`). Transitions back to `IDLE`.
         RETRY_WAIT,             ///< A retryable error occurred (e.g., timeout, server error 5xx). Waiting for `HTTP_RETRY_DELAY_MS` before transitioning back to `CLIENT_CONNECT` to retry the request (if `_httpRetries < MAX_HTTP_RETRIES`).
         ERROR                   ///< An unrecoverable error occurred (e.g., non-retryable HTTP code, max retries exceeded, callback returned `false`). Transitions back to `IDLE`.
     };
 
     // --- Core GPRS and HTTP Components (Private Members) ---
-    TinyGsm& _modem;           ///< Reference to the externally created and managed `TinyGsm` modem object (e.g., `TinyGsmSim800`). Used for all AT command communication.
-    TinyGsmClient _gprsClient; ///< `TinyGsmClient` instance associated with `_modem`. Used for GPRS-based TCP/IP communication for HTTP requests.
-                               ///< Note: For HTTPS, this would typically be `TinyGsmClientSecure` and would require the modem to support SSL/TLS and have necessary certificates/firmware.
+    TinyGsm& _modem;           ///< Reference to the externally created and managed `TinyGsm` modem object (e.g., `TinyGsmSim800`). Used for the reset sequence and socket (HTTP, MQTT) traffic.
+    AtCommandEngine& _at;      ///< Engine under `_modem`; the connection FSM's status and attach commands are queued here.
+    TinyGsmClient _gprsClients[HTTP_POOL_SLOTS]; ///< `TinyGsmClient` sockets on `_modem`, one modem mux channel per `HttpConnectionPool` slot. Used for GPRS-based TCP/IP communication for HTTP requests.
+                               ///< Note: For HTTPS, these would typically be `TinyGsmClientSecure` and would require the modem to support SSL/TLS and have necessary certificates/firmware.
+    Client* _poolClients[HTTP_POOL_SLOTS]; ///< Pointers to `_gprsClients` for `_pool`.
+    TinyGsmClient _pushClient; ///< Socket of the MQTT push session on mux `MQTT_GPRS_MUX` (see `getPushClient()`); not pooled.
+    HttpConnectionPool _pool;  ///< Chooses and recycles the socket for each request, so repeated requests skip the modem TCP handshake.
+    uint8_t _poolSlot;         ///< Slot of the current request while `_slotAcquired`.
+    bool _slotAcquired;        ///< The current request holds `_poolSlot`.
+    bool _connReused;          ///< The current attempt runs on a socket kept open from an earlier request.
+    bool _staleRetryUsed;      ///< The current request already reopened a stale socket once.
 
     // --- Configuration and State Variables (Private Members) ---
-    String _apn;        ///< Stores the Access Point Name (APN) for the GPRS network, copied from constructor. Max length `GPRS_APN_MAX_LEN`.
-    String _gprsUser;   ///< Stores the username for GPRS connection (if required by APN), copied from constructor. Max length `GPRS_USER_MAX_LEN`.
-    String _gprsPass;   ///< Stores the password for GPRS connection (if required by APN), copied from constructor. Max length `GPRS_PWD_MAX_LEN`.
-    String _simPin;     ///< Stores the PIN for the SIM card (if it's PIN-locked), copied from constructor. Max length `SIM_PIN_MAX_LEN`.
-    String _authToken;  ///< Stores the authentication token (e.g., "Bearer <token>") used for API requests if `_asyncNeedsAuth` is true. Updated by `setAuthToken()`. Max length `API_TOKEN_MAX_LEN`.
+    FixedString<GPRS_APN_MAX_LEN> _apn;        ///< Stores the Access Point Name (APN) for the GPRS network, copied from constructor. Max length `GPRS_APN_MAX_LEN`.
+    FixedString<GPRS_USER_MAX_LEN> _gprsUser;  ///< Stores the username for GPRS connection (if required by APN), copied from constructor. Max length `GPRS_USER_MAX_LEN`.
+    FixedString<GPRS_PWD_MAX_LEN> _gprsPass;   ///< Stores the password for GPRS connection (if required by APN), copied from constructor. Max length `GPRS_PWD_MAX_LEN`.
+    FixedString<SIM_PIN_MAX_LEN> _simPin;      ///< Stores the PIN for the SIM card (if it's PIN-locked), copied from constructor. Max length `SIM_PIN_MAX_LEN`.
+    FixedString<API_TOKEN_MAX_LEN> _authToken; ///< Stores the authentication token (e.g., "Bearer <token>") used for API requests if `_asyncNeedsAuth` is true. Updated by `setAuthToken()`. Max length `API_TOKEN_MAX_LEN`.
     DeviceState* _deviceState; ///< Pointer to the global `DeviceState` structure. Used to report `gprsState` to other parts of the system.
-    LCDDisplay* _lcd;   ///< Optional pointer to an `LCDDisplay` object. If not `nullptr`, used for displaying status or debug messages.
 
     // --- Asynchronous HTTP Operation Variables (for the HTTP FSM) ---
     GPRSHttpState _currentHttpState; ///< Current state of the asynchronous GPRS HTTP request FSM. Determines logic in `updateHttpOperations()`.
-    String _asyncUrl;                ///< Stores the full URL for the current or pending asynchronous HTTP request. Parsed into `_gprsHost`, `_gprsPath`, `_gprsPort`.
-    String _asyncMethod;             ///< HTTP method (e.g., "GET", "POST") for the current asynchronous request.
-    String _asyncApiType;            ///< User-defined descriptive string identifying the type of API call (e.g., "POST_SENSOR_DATA"). Useful for logging and debugging.
-    String _asyncPayload;            ///< Stores the payload (body content, typically JSON) for the current asynchronous POST request. Empty for GET.
-    std::function<bool(JsonDocument& doc)> _asyncCb; ///< The callback function to be invoked with the parsed JSON response upon successful completion of the async request.
+    FixedString<API_URL_MAX_LEN> _asyncUrl; ///< Stores the full URL for the current or pending asynchronous HTTP request. Parsed into `_gprsHost`, `_gprsPath`, `_gprsPort`.
+    FixedString<HTTP_REQUEST_METHOD_MAX_LEN> _asyncMethod; ///< HTTP method (e.g., "GET", "POST") for the current asynchronous request.
+    FixedString<HTTP_REQUEST_API_TYPE_MAX_LEN> _asyncApiType; ///< User-defined descriptive string identifying the type of API call (e.g., "POST_SENSOR_DATA"). Used for logging; truncated if longer.
+    StrView _asyncPayload;           ///< Borrowed body of the current POST request (owned by the caller's `HttpRequestQueue` slot until the request ends). Empty for GET.
+    HttpResponseCallback _asyncCb; ///< The callback function to be invoked with the parsed JSON response of a 2xx reply; never called for error statuses.
     bool _asyncNeedsAuth;            ///< Flag indicating whether the current asynchronous request requires the `_authToken` to be sent in an "Authorization" header.
     unsigned long _asyncRequestStartTime; ///< Timestamp (`millis()`) marking when the current async HTTP request state (e.g., `CLIENT_CONNECT`, `SENDING_REQUEST`) began. Used for timeouts like `HTTP_CONNECT_TIMEOUT_MS`.
     bool _asyncOperationActive;      ///< Boolean flag that is `true` if an asynchronous HTTP operation is currently in progress (i.e., `_currentHttpState` is not `IDLE` or `COMPLETE`/`ERROR` just before reset to `IDLE`). Prevents starting new requests.
@@ -415,11 +531,24 @@ private:
     char _gprsHost[GPRS_MAX_HOST_LEN]; ///< Buffer to store the extracted hostname from `_asyncUrl` (e.g., "api.example.com"). Size from `config.h`.
     char _gprsPath[GPRS_MAX_PATH_LEN]; ///< Buffer to store the extracted path part from `_asyncUrl` (e.g., "/data/submit"). Size from `config.h`.
     int _gprsPort;                     ///< Extracted port number from `_asyncUrl`. Defaults to 80 for HTTP if not specified in the URL.
-    String _gprsResponseBuffer;        ///< Buffer to accumulate the HTTP response body as it's received from `_gprsClient`. Cleared per request. Max size implicitly limited by `GPRS_RESPONSE_BUFFER_SIZE` or available memory.
+    HttpHeaderBuffer _gprsHeaders;     ///< Raw response status line and headers, filled by bulk `read()` calls and parsed in place.
+    char _gprsBodyBuffer[GPRS_BODY_BUFFER_SIZE]; ///< Response body, read directly from `activeClient()` and parsed in place by ArduinoJson. Always null-terminated.
+    size_t _gprsBodyLen;               ///< Number of valid bytes in `_gprsBodyBuffer`.
+    bool _gprsBodyTruncated;           ///< Set if the body did not fit `_gprsBodyBuffer`; the excess is drained and discarded and the response is treated as failed.
+    ChunkedDecoder _chunkedDecoder;    ///< Streaming decoder for chunked bodies; de-chunks bytes into `_gprsBodyBuffer` as they arrive.
     int _gprsHttpStatusCode;           ///< Stores the HTTP status code (e.g., 200, 404, 500) received from the server for the most recent GPRS HTTP request.
     unsigned long _gprsContentLength;  ///< Stores the `Content-Length` header value from the HTTP response, if provided by the server. Used in `BODY_RECEIVING` state.
-    bool _gprsChunkedEncoding;         ///< Flag set to `true` if the HTTP response uses "Transfer-Encoding: chunked". Requires special handling in `BODY_RECEIVING`. (Note: Full chunked decoding might be complex for GPRSManager).
+    bool _gprsHasContentLength;        ///< The response carried a `Content-Length` header (possibly 0). Without it, a non-chunked body ends when the server closes.
+    bool _gprsServerKeepAlive;         ///< The server allows reusing the connection (HTTP/1.1 without `Connection: close`, or explicit keep-alive).
+    unsigned long _gprsKeepAliveTimeoutMs; ///< Idle timeout from the response's `Keep-Alive: timeout=` header, or 0.
+    bool _gprsChunkedEncoding;         ///< Flag set to `true` if the HTTP response uses "Transfer-Encoding: chunked". Body bytes are then passed through `_chunkedDecoder`.
     unsigned long _gprsBodyBytesRead;  ///< Counter for the number of bytes read from the HTTP response body so far, used with `_gprsContentLength` or during chunked reading.
+    HttpValidators _gprsResponseValidators; ///< `ETag` / `Last-Modified` of the current response, from `parseResponseHeaders()`.
+    HttpValidators _pendingValidators; ///< Set by `setConditionalRequest()`; taken over by the next `startAsyncHttpRequest()`.
+    HttpValidators _asyncValidators;   ///< Validators sent with the current request; empty if unconditional.
+    char _pendingIdempotencyKey[HTTP_IDEMPOTENCY_KEY_LEN]; ///< Set by `setIdempotencyKey()`; taken over by the next `startAsyncHttpRequest()`.
+    char _asyncIdempotencyKey[HTTP_IDEMPOTENCY_KEY_LEN];   ///< `Idempotency-Key` of the current request; empty if none.
+    ResponseObserver _responseObserver; ///< Told about each finished request; may be empty.
 
 // Suppress deprecated declarations warning if `StaticJsonDocument` is from an older ArduinoJson version.
 // Modern ArduinoJson (v6+) prefers `JsonDocument` as a base, but `StaticJsonDocument` is still valid for fixed-size allocation.
@@ -463,6 +592,59 @@ private:
      */
     void printModemErrorCause();
 
+    /**
+     * @brief Clears the header and body buffers and all per-response parsing state.
+     * Called when a request starts, before each (re)send and before a retry.
+     */
+    void resetResponseBuffers();
+
+    /**
+     * @brief Parses the status line and the `Content-Length` / `Transfer-Encoding` / `Connection` / `Keep-Alive` /
+     *        `ETag` / `Last-Modified` headers in place.
+     * Delegates to `HttpHeaderBuffer::parseResponseHeaders()` and copies the result into the `_gprs*` response fields.
+     * @return `true` if a valid status line was found and `_gprsHttpStatusCode` was set.
+     */
+    bool parseResponseHeaders();
+
+    /**
+     * @brief Appends raw body bytes to `_gprsBodyBuffer`, truncating (and flagging) anything that does not fit.
+     * Chunked bodies are de-chunked by `_chunkedDecoder` on the way in, so only payload is stored.
+     * `data` may point at the free space of `_gprsBodyBuffer` itself (bytes read in place).
+     * @param data Bytes to append.
+     * @param len Number of bytes.
+     */
+    void storeBodyBytes(const char* data, size_t len);
+
+    /**
+     * @brief Bulk-reads all currently available body bytes from `activeClient()` into `_gprsBodyBuffer`.
+     * Bytes beyond the buffer capacity are drained and discarded so the connection can finish cleanly.
+     */
+    void readBodyFromClient();
+
+    /**
+     * @brief Gets the socket of the current request.
+     * @return The pooled client for `_poolSlot`.
+     */
+    TinyGsmClient& activeClient() { return _gprsClients[_poolSlot]; }
+
+    /**
+     * @brief Returns the current request's socket to `_pool`. No-op if no slot is held.
+     * @param keepOpen `true` if the response was fully read and the server allows reuse.
+     */
+    void releaseConnection(bool keepOpen);
+
+    /**
+     * @brief Closes the current request's socket and returns its slot. No-op if no slot is held.
+     */
+    void closeConnection();
+
+    /**
+     * @brief Handles a reused socket that failed before any response byte arrived.
+     * The server closed it while idle, so it is reopened once (back to `CLIENT_CONNECT`) without counting as a retry.
+     * @return `true` if the request was redirected to a fresh connection.
+     */
+    bool reconnectIfStale();
+
     // --- Deprecated or Integrated Method Comments ---
     // The following methods were likely part of initial planning but their logic has been
     // integrated directly into the respective GPRS FSM state handler methods (`handleGprs...()`).
@@ -0,0 +1,152 @@
+#include "HttpConnectionPool.h"
+
+/**
+ * @brief Constructs a pool over caller-owned clients.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+HttpConnectionPool::HttpConnectionPool(Client* const* clients) : _clients(clients) {
+    for (Slot& s : _slots) {
+        s.host[0] = '\0';
+        s.port = 0;
+        s.lastUsedMs = 0;
+        s.idleLimitMs = HTTP_KEEPALIVE_IDLE_TIMEOUT_MS;
+        s.inUse = false;
+    }
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief Picks the connection for a request.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+uint8_t HttpConnectionPool::acquire(const char* host, uint16_t port, unsigned long nowMs, bool& reused) {
+    reused = false;
+    _stats.requests++;
+
+    int8_t victim = -1;
+    for (uint8_t i = 0; i < HTTP_POOL_SLOTS; ++i) {
+        Slot& s = _slots[i];
+        if (s.inUse) continue;
+        if (s.port == port && strcmp(s.host, host) == 0) {
+            if (_clients[i]->connected() && !isExpired(s, nowMs)) {
+                reused = true;
+                _stats.reused++;
+                s.inUse = true;
+                DEBUG_PRINTF(4, "HttpConnectionPool: Reusing slot %u for %s:%u (idle %lu ms).\n", i, host, port, nowMs - s.lastUsedMs);
+                return i;
+            }
+            if (_clients[i]->connected()) _stats.idleExpiries++;
+            victim = i; // Same host but closed or expired: reconnect in place.
+            break;
+        }
+        // Prefer a slot without a live socket, then the least recently used one.
+        if (victim < 0) victim = i;
+        else if (_clients[victim]->connected() &&
+                 (!_clients[i]->connected() || (long)(s.lastUsedMs - _slots[victim].lastUsedMs) < 0)) victim = i;
+    }
+    if (victim < 0) victim = 0; // All slots in use cannot happen with one request at a time; fall back safely.
+
+    closeSlot(victim);
+    Slot& s = _slots[victim];
+    strncpy(s.host, host, sizeof(s.host) - 1);
+    s.host[sizeof(s.host) - 1] = '\0';
+    s.port = port;
+    s.idleLimitMs = HTTP_KEEPALIVE_IDLE_TIMEOUT_MS;
+    s.inUse = true;
+    return victim;
+}
+
+/**
+ * @brief Records a newly established connection.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+void HttpConnectionPool::noteHandshake(unsigned long handshakeMs) {
+    _stats.handshakes++;
+    _stats.lastHandshakeMs = handshakeMs;
+    _stats.totalHandshakeMs += handshakeMs;
+    if (handshakeMs > _stats.maxHandshakeMs) _stats.maxHandshakeMs = handshakeMs;
+}
+
+/**
+ * @brief Closes a reused connection that turned out to be dead.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+void HttpConnectionPool::markStale(uint8_t slot) {
+    if (slot >= HTTP_POOL_SLOTS) return;
+    _stats.staleReconnects++;
+    DEBUG_PRINTF(3, "HttpConnectionPool: Slot %u (%s) was closed by the server, reconnecting.\n", slot, _slots[slot].host);
+    _clients[slot]->stop();
+}
+
+/**
+ * @brief Returns a slot after the request finished.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+void HttpConnectionPool::release(uint8_t slot, bool keepOpen, unsigned long nowMs, unsigned long serverTimeoutMs) {
+    if (slot >= HTTP_POOL_SLOTS) return;
+    Slot& s = _slots[slot];
+    s.inUse = false;
+    if (!keepOpen || !_clients[slot]->connected()) {
+        if (!keepOpen && _clients[slot]->connected()) _stats.serverCloses++;
+        closeSlot(slot);
+        return;
+    }
+    s.lastUsedMs = nowMs;
+    s.idleLimitMs = HTTP_KEEPALIVE_IDLE_TIMEOUT_MS;
+    if (serverTimeoutMs > 0) {
+        // Give up the socket a little before the server does, so a request never races its close.
+        unsigned long serverLimit = serverTimeoutMs > HTTP_KEEPALIVE_SERVER_MARGIN_MS ? serverTimeoutMs - HTTP_KEEPALIVE_SERVER_MARGIN_MS : 0;
+        if (serverLimit < s.idleLimitMs) s.idleLimitMs = serverLimit;
+    }
+}
+
+/**
+ * @brief Closes idle connections past their keep-alive window.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+void HttpConnectionPool::expireIdle(unsigned long nowMs) {
+    for (uint8_t i = 0; i < HTTP_POOL_SLOTS; ++i) {
+        Slot& s = _slots[i];
+        if (s.inUse || s.host[0] == '\0' || !isExpired(s, nowMs)) continue;
+        if (_clients[i]->connected()) {
+            _stats.idleExpiries++;
+            DEBUG_PRINTF(4, "HttpConnectionPool: Closing idle slot %u (%s).\n", i, s.host);
+        }
+        closeSlot(i);
+    }
+}
+
+/**
+ * @brief Closes every pooled connection.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+void HttpConnectionPool::closeAll() {
+    for (uint8_t i = 0; i < HTTP_POOL_SLOTS; ++i) {
+        closeSlot(i);
+        _slots[i].inUse = false;
+    }
+}
+
+/**
+ * @brief Parses `timeout=` from a `Keep-Alive` header value.
+ * Refer to HttpConnectionPool.h for detailed documentation.
+ */
+unsigned long HttpConnectionPool::parseKeepAliveTimeout(const char* value, size_t len) {
+    for (size_t i = 0; i + 8 <= len; ++i) {
+        if (strncasecmp(value + i, "timeout=", 8) != 0) continue;
+        unsigned long seconds = 0;
+        for (size_t j = i + 8; j < len && value[j] >= '0' && value[j] <= '9'; ++j) seconds = seconds * 10 + (value[j] - '0');
+        return seconds * 1000UL;
+    }
+    return 0;
+}
+
+void HttpConnectionPool::closeSlot(uint8_t slot) {
+    if (_clients[slot]->connected()) _clients[slot]->stop();
+    _slots[slot].host[0] = '\0';
+    _slots[slot].port = 0;
+}
+
+bool HttpConnectionPool::isExpired(const Slot& s, unsigned long nowMs) const {
+    return nowMs - s.lastUsedMs >= s.idleLimitMs;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file HttpConnectionPool.h
+ * @brief Defines `HttpConnectionPool`, a small per-host pool of keep-alive TCP connections.
+ *
+ * Every status poll and threshold fetch goes to the same API host, so opening a fresh socket per request
+ * spends most of the transaction on the TCP handshake (1-3 s per request on SIM800 GPRS). The pool lets
+ * `WiFiManager` and `GPRSManager` keep a connection open after a response whose framing is known and
+ * hand it to the next request for the same host and port.
+ *
+ * The pool does not own the sockets: each manager passes in its own `Client` objects (`WiFiClient`,
+ * `TinyGsmClient`), one per slot, and keeps doing the HTTP framing itself. The pool decides which slot a
+ * request uses and when an idle connection must be dropped:
+ * - A connection idle for longer than `HTTP_KEEPALIVE_IDLE_TIMEOUT_MS`, or than the server's advertised
+ *   `Keep-Alive: timeout=` minus `HTTP_KEEPALIVE_SERVER_MARGIN_MS`, is closed instead of reused.
+ * - A response with `Connection: close` (or without known body length) is released with `keepOpen = false`.
+ * - A request that fails on a reused connection before any response byte arrived is "stale": the server
+ *   dropped the idle socket. The manager calls `markStale()` and reconnects once without counting a retry.
+ *
+ * Time is passed in by the caller (`nowMs`), like `HttpRequestQueue`. Not thread-safe; each manager uses
+ * its pool from the network worker task only.
+ */
+#ifndef HTTP_CONNECTION_POOL_H
+#define HTTP_CONNECTION_POOL_H
+
+#include <Arduino.h>
+#include <Client.h>   // Common base of `WiFiClient` and `TinyGsmClient`.
+#include "config.h"   // For HTTP_POOL_SLOTS and keep-alive timeouts.
+
+/**
+ * @class HttpConnectionPool
+ * @brief Assigns requests to reusable per-host connections and counts handshakes and reuse.
+ */
+class HttpConnectionPool {
+public:
+    /**
+     * @struct Stats
+     * @brief Running counters since boot.
+     */
+    struct Stats {
+        uint32_t requests;              ///< Connections handed out by `acquire()`.
+        uint32_t reused;                ///< Requests served on an already open connection.
+        uint32_t handshakes;            ///< New TCP connections established.
+        uint32_t staleReconnects;       ///< Reused connections found dead and transparently reopened.
+        uint32_t serverCloses;          ///< Responses after which the server did not allow reuse.
+        uint32_t idleExpiries;          ///< Idle connections closed because their keep-alive window ran out.
+        unsigned long lastHandshakeMs;  ///< Duration of the most recent handshake.
+        unsigned long maxHandshakeMs;   ///< Longest handshake observed.
+        unsigned long totalHandshakeMs; ///< Sum of all handshake durations, for the average over `handshakes`.
+    };
+
+    /**
+     * @brief Constructs a pool over caller-owned clients.
+     * @param clients Array of `HTTP_POOL_SLOTS` client pointers; each slot owns one socket.
+     */
+    explicit HttpConnectionPool(Client* const* clients);
+
+    /**
+     * @brief Picks the connection for a request to `host:port`.
+     * Reuses an open, non-expired connection to the same host; otherwise frees a slot (an unused one, or
+     * the least recently used one) and leaves it closed for the caller to `connect()`.
+     * @param host Host name as it appears in the URL.
+     * @param port TCP port.
+     * @param nowMs Current `millis()`.
+     * @param reused Set to `true` if the returned slot is already connected.
+     * @return Slot index, used with `client()`, `noteHandshake()` and `release()`.
+     */
+    uint8_t acquire(const char* host, uint16_t port, unsigned long nowMs, bool& reused);
+
+    /**
+     * @brief Gets the socket of a slot.
+     * @param slot Index returned by `acquire()`.
+     * @return The caller-provided client for that slot.
+     */
+    Client& client(uint8_t slot) const { return *_clients[slot]; }
+
+    /**
+     * @brief Records a newly established connection on a slot.
+     * @param handshakeMs Time spent in `connect()`.
+     */
+    void noteHandshake(unsigned long handshakeMs);
+
+    /**
+     * @brief Closes a reused connection that failed before any response arrived.
+     * The caller then reconnects the same slot; the failure is not counted as an HTTP retry.
+     * @param slot Index returned by `acquire()`.
+     */
+    void markStale(uint8_t slot);
+
+    /**
+     * @brief Returns a slot after the request finished.
+     * @param slot Index returned by `acquire()`.
+     * @param keepOpen `true` if the response was fully read and the server allows reuse.
+     * @param nowMs Current `millis()`.
+     * @param serverTimeoutMs Idle timeout advertised via `Keep-Alive: timeout=`, or 0 if none.
+     */
+    void release(uint8_t slot, bool keepOpen, unsigned long nowMs, unsigned long serverTimeoutMs = 0);
+
+    /**
+     * @brief Closes idle connections whose keep-alive window has passed. Call while no request is active.
+     * @param nowMs Current `millis()`.
+     */
+    void expireIdle(unsigned long nowMs);
+
+    /**
+     * @brief Closes every pooled connection (e.g., on disconnect or link loss).
+     */
+    void closeAll();
+
+    /**
+     * @brief Gets the pool counters.
+     * @return Reference to the running statistics.
+     */
+    const Stats& getStats() const { return _stats; }
+
+    /**
+     * @brief Parses the `timeout=` parameter of a `Keep-Alive` header value.
+     * @param value Header value, e.g. "timeout=5, max=100". Need not be null-terminated at `len`.
+     * @param len Number of characters in `value`.
+     * @return Timeout in milliseconds, or 0 if absent.
+     */
+    static unsigned long parseKeepAliveTimeout(const char* value, size_t len);
+
+private:
+    /**
+     * @struct Slot
+     * @brief Bookkeeping for one pooled connection.
+     */
+    struct Slot {
+        char host[GPRS_MAX_HOST_LEN]; ///< Host the socket is connected to; empty if unassigned.
+        uint16_t port;                ///< Port the socket is connected to.
+        unsigned long lastUsedMs;     ///< `millis()` when the last response on this socket completed.
+        unsigned long idleLimitMs;    ///< How long the socket may sit idle before it is closed.
+        bool inUse;                   ///< A request currently owns the slot.
+    };
+
+    void closeSlot(uint8_t slot);
+    bool isExpired(const Slot& s, unsigned long nowMs) const;
+
+    Client* const* _clients;        ///< Caller-owned sockets, one per slot.
+    Slot _slots[HTTP_POOL_SLOTS];   ///< Slot bookkeeping.
+    Stats _stats;                   ///< Running counters.
+};
+
+#endif // HTTP_CONNECTION_POOL_H
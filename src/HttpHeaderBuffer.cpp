@@ -0,0 +1,154 @@
+#include "HttpHeaderBuffer.h"
+#include "HttpConnectionPool.h" // For HttpConnectionPool::parseKeepAliveTimeout.
+
+static const char HEADER_TERMINATOR[] = "\r\n\r\n";
+static const uint8_t HEADER_TERMINATOR_LEN = 4;
+
+/**
+ * @brief Constructs an empty buffer.
+ * Refer to HttpHeaderBuffer.h for detailed documentation.
+ */
+HttpHeaderBuffer::HttpHeaderBuffer() {
+    reset();
+}
+
+/**
+ * @brief Empties the buffer.
+ * Refer to HttpHeaderBuffer.h for detailed documentation.
+ */
+void HttpHeaderBuffer::reset() {
+    _len = 0;
+    _match = 0;
+    _complete = false;
+    _earlyBodyLen = 0;
+    _buf[0] = '\0';
+}
+
+/**
+ * @brief Appends received bytes and looks for the end of the headers.
+ * Refer to HttpHeaderBuffer.h for detailed documentation.
+ */
+bool HttpHeaderBuffer::commit(size_t n) {
+    if (_complete || n == 0) return _complete;
+    int terminatorEnd = scanHeaderTerminator(_buf + _len, n);
+    _len += n;
+    if (terminatorEnd < 0) {
+        _buf[_len] = '\0';
+        return false;
+    }
+
+    // Shift whatever followed the blank line up by one to make room for the NUL. Since `_len` never exceeds
+    // GPRS_MAX_HEADER_SIZE - 1, the shifted bytes still fit.
+    size_t headerEnd = _len - n + (size_t)terminatorEnd;
+    _earlyBodyLen = _len - headerEnd;
+    memmove(_buf + headerEnd + 1, _buf + headerEnd, _earlyBodyLen);
+    _buf[headerEnd] = '\0';
+    _len = headerEnd;
+    _complete = true;
+    return true;
+}
+
+/**
+ * @brief Advances a running match of `pattern` by one input byte.
+ * Falls back to the longest pattern prefix that is still a suffix of the input, so overlapping
+ * partial matches (e.g. "\r\n\r" followed by "\r\n\r\n") are not missed.
+ */
+static uint8_t advancePatternMatch(const char* pattern, uint8_t patternLen, uint8_t matched, char c) {
+    if (matched < patternLen && pattern[matched] == c) return matched + 1;
+    for (uint8_t k = (matched < patternLen ? matched : patternLen - 1); k > 0; --k) {
+        // Candidate: pattern[0..k-1] must equal the last k-1 matched bytes followed by c.
+        if (pattern[k - 1] != c) continue;
+        if (memcmp(pattern, pattern + matched - (k - 1), k - 1) == 0) return k;
+    }
+    return 0;
+}
+
+int HttpHeaderBuffer::scanHeaderTerminator(const char* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        _match = advancePatternMatch(HEADER_TERMINATOR, HEADER_TERMINATOR_LEN, _match, data[i]);
+        if (_match == HEADER_TERMINATOR_LEN) return (int)(i + 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Copies a header value without surrounding whitespace. Values that do not fit are dropped entirely,
+ * since a truncated validator would never match on revalidation.
+ */
+static void copyHeaderValue(const char* value, size_t len, char* dest, size_t destSize) {
+    while (len > 0 && (*value == ' ' || *value == '\t')) { ++value; --len; }
+    while (len > 0 && (value[len - 1] == ' ' || value[len - 1] == '\t')) --len;
+    if (len >= destSize) {
+        dest[0] = '\0';
+        return;
+    }
+    memcpy(dest, value, len);
+    dest[len] = '\0';
+}
+
+/**
+ * @brief Parses the status line and the relevant headers in place.
+ * Refer to HttpHeaderBuffer.h for detailed documentation.
+ */
+bool HttpHeaderBuffer::parseResponseHeaders(HttpResponseHead& head) {
+    head.statusCode = 0;
+    head.keepAlive = false;
+    head.hasContentLength = false;
+    head.contentLength = 0;
+    head.chunked = false;
+    head.keepAliveTimeoutMs = 0;
+    head.validators.etag[0] = '\0';
+    head.validators.lastModified[0] = '\0';
+    if (!_complete) return false;
+
+    // Status line: "HTTP/1.x <code> <reason>". HTTP/1.1 connections persist unless the server says otherwise.
+    const char* line = _buf;
+    if (strncmp(line, "HTTP/", 5) != 0) return false;
+    const char* next = strstr(line, "\r\n");
+    const char* sp = strchr(line, ' ');
+    if (!sp || sp > next) return false;
+    int code = atoi(sp + 1);
+    if (code <= 0) return false;
+    head.statusCode = code;
+    head.keepAlive = strncmp(line, "HTTP/1.0", 8) != 0;
+
+    // Unfold continuation lines: a line break followed by SP or HT is part of the previous header's value.
+    for (char* fold = strstr(_buf + (next - _buf) + 2, "\r\n"); fold; fold = strstr(fold + 2, "\r\n")) {
+        if (fold[2] == ' ' || fold[2] == '\t') {
+            fold[0] = ' ';
+            fold[1] = ' ';
+        }
+    }
+
+    // Header lines, matched case-insensitively without copying.
+    while (next) {
+        line = next + 2;
+        next = strstr(line, "\r\n");
+        size_t lineLen = next ? (size_t)(next - line) : strlen(line);
+        if (lineLen == 0) break;
+
+        if (lineLen > 15 && strncasecmp(line, "Content-Length:", 15) == 0) {
+            head.contentLength = strtoul(line + 15, nullptr, 10);
+            head.hasContentLength = true;
+        } else if (lineLen > 11 && strncasecmp(line, "Connection:", 11) == 0) {
+            for (const char* p = line + 11; p < line + lineLen; ++p) {
+                if (p + 5 <= line + lineLen && strncasecmp(p, "close", 5) == 0) { head.keepAlive = false; break; }
+                if (p + 10 <= line + lineLen && strncasecmp(p, "keep-alive", 10) == 0) { head.keepAlive = true; break; }
+            }
+        } else if (lineLen > 11 && strncasecmp(line, "Keep-Alive:", 11) == 0) {
+            head.keepAliveTimeoutMs = HttpConnectionPool::parseKeepAliveTimeout(line + 11, lineLen - 11);
+        } else if (lineLen > 5 && strncasecmp(line, "ETag:", 5) == 0) {
+            copyHeaderValue(line + 5, lineLen - 5, head.validators.etag, sizeof(head.validators.etag));
+        } else if (lineLen > 14 && strncasecmp(line, "Last-Modified:", 14) == 0) {
+            copyHeaderValue(line + 14, lineLen - 14, head.validators.lastModified, sizeof(head.validators.lastModified));
+        } else if (lineLen > 18 && strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            for (const char* p = line + 18; p + 7 <= line + lineLen; ++p) {
+                if (strncasecmp(p, "chunked", 7) == 0) {
+                    head.chunked = true;
+                    break;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file HttpHeaderBuffer.h
+ * @brief Defines `HttpHeaderBuffer`, which collects an HTTP response's status line and headers from bulk socket
+ *        reads and parses them in place.
+ *
+ * `GPRSManager` reads the response straight into `writePtr()` and reports the byte count to `commit()`, which
+ * scans only the new bytes for the blank line that ends the headers. A partial "\r\n\r\n" is carried across
+ * reads, so the terminator may be split anywhere. Bytes read past the blank line already belong to the body and
+ * are kept, contiguous, as `earlyBody()`.
+ *
+ * `parseResponseHeaders()` then reads the status code and the headers the managers act on, matching names
+ * case-insensitively and unfolding obsolete line folding (RFC 7230 section 3.2.4) in place, without copying the
+ * block. The buffer holds `GPRS_MAX_HEADER_SIZE` bytes including the terminating NUL; headers that do not fit
+ * show as `space()` reaching 0 before `commit()` has returned `true`.
+ *
+ * Needs only `<Arduino.h>` for `strncasecmp` and the validator types, so it is unit tested on the host.
+ */
+#ifndef HTTP_HEADER_BUFFER_H
+#define HTTP_HEADER_BUFFER_H
+
+#include <Arduino.h>
+#include "config.h"             // For GPRS_MAX_HEADER_SIZE.
+#include "HttpValidatorCache.h" // For HttpValidators.
+
+/**
+ * @struct HttpResponseHead
+ * @brief What `parseResponseHeaders()` extracts from a response's status line and headers.
+ */
+struct HttpResponseHead {
+    int statusCode;                   ///< Status code from the status line, or 0 if it could not be parsed.
+    bool keepAlive;                   ///< The server allows reusing the connection (HTTP/1.1 without `Connection: close`, or explicit keep-alive).
+    bool hasContentLength;            ///< A `Content-Length` header was present (possibly 0).
+    unsigned long contentLength;      ///< Value of `Content-Length`, or 0.
+    bool chunked;                     ///< `Transfer-Encoding` includes `chunked`.
+    unsigned long keepAliveTimeoutMs; ///< Idle timeout from `Keep-Alive: timeout=`, or 0.
+    HttpValidators validators;        ///< `ETag` / `Last-Modified`; empty strings if not sent or too long.
+};
+
+/**
+ * @class HttpHeaderBuffer
+ * @brief Fixed buffer for one response's header block, filled incrementally and parsed in place.
+ */
+class HttpHeaderBuffer {
+public:
+    HttpHeaderBuffer();
+
+    /**
+     * @brief Empties the buffer for the next response.
+     */
+    void reset();
+
+    /**
+     * @brief Where the next bytes read from the socket go; at most `space()` of them.
+     */
+    char* writePtr() { return _buf + _len; }
+
+    /**
+     * @brief Bytes that can still be read into `writePtr()`. 0 once the headers are complete, or when they
+     *        filled the buffer without a blank line (the response must then be rejected).
+     */
+    size_t space() const { return _complete ? 0 : (GPRS_MAX_HEADER_SIZE - 1) - _len; }
+
+    /**
+     * @brief Appends `n` bytes just read into `writePtr()` and scans them for the end of the headers.
+     * On completion the header block is NUL-terminated in place and the bytes that followed it are moved to
+     * `earlyBody()`.
+     * @param n Number of bytes read, at most `space()`.
+     * @return `true` once the blank line ending the headers has been received.
+     */
+    bool commit(size_t n);
+
+    /**
+     * @brief Checks whether the blank line ending the headers has been received.
+     */
+    bool isComplete() const { return _complete; }
+
+    /**
+     * @brief Checks whether no byte of the response has been received yet.
+     */
+    bool isEmpty() const { return _len == 0; }
+
+    /**
+     * @brief The received header bytes; a NUL-terminated block ending in "\r\n\r\n" once `isComplete()`.
+     */
+    const char* headers() const { return _buf; }
+
+    /**
+     * @brief Body bytes that arrived in the same reads as the headers. Valid once `isComplete()`.
+     */
+    const char* earlyBody() const { return _buf + _len + 1; }
+
+    /**
+     * @brief Number of bytes at `earlyBody()`.
+     */
+    size_t earlyBodyLength() const { return _earlyBodyLen; }
+
+    /**
+     * @brief Parses the status line and the headers `GPRSManager` acts on.
+     * Header names are matched case-insensitively, and continuation lines starting with SP or HT are joined to
+     * the header they continue by overwriting the line break with spaces. Fields of `head` that the response
+     * does not set are reset to their defaults.
+     * @param head Receives the parsed fields.
+     * @return `false` if the headers are not complete or the status line is not "HTTP/x.y <code> ...".
+     */
+    bool parseResponseHeaders(HttpResponseHead& head);
+
+private:
+    /**
+     * @brief Scans newly received bytes for the "\r\n\r\n" terminator.
+     * Only the bytes passed in are inspected; a partial match is carried in `_match` to the next call.
+     * @param data Newly received bytes (already appended to `_buf`).
+     * @param len Number of new bytes.
+     * @return Offset just past the terminator within `data`, or -1 if it has not been seen yet.
+     */
+    int scanHeaderTerminator(const char* data, size_t len);
+
+    char _buf[GPRS_MAX_HEADER_SIZE]; ///< Status line and headers, then a NUL and the early body bytes once complete.
+    size_t _len;                     ///< Bytes received so far; once complete, the length of the header block.
+    uint8_t _match;                  ///< Progress (0-4) of the incremental "\r\n\r\n" scan, carried across reads.
+    bool _complete;                  ///< The blank line ending the headers has been received.
+    size_t _earlyBodyLen;            ///< Body bytes received together with the headers.
+};
+
+#endif // HTTP_HEADER_BUFFER_H
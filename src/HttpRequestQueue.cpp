@@ -0,0 +1,382 @@
+#include "HttpRequestQueue.h"
+#include "config.h" // For DEBUG_PRINTLN, DEBUG_PRINTF.
+#include <string.h> // For strncpy, strcmp, strlen, memcpy.
+
+/**
+ * @brief Constructs an empty queue with all slots free.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+HttpRequestQueue::HttpRequestQueue() : _freeCount(0), _bulkInUse(false), _inFlightSlot(-1), _nextSeq(1) {
+    for (uint8_t i = 0; i < HTTP_REQUEST_QUEUE_CAPACITY; ++i) {
+        _slots[i].url[0] = '\0';
+        _slots[i].method[0] = '\0';
+        _slots[i].apiType[0] = '\0';
+        _slots[i].payload[0] = '\0';
+        _slots[i].bulkPayload = false;
+        _slots[i].needsAuth = false;
+        _slots[i].priority = HttpRequestPriority::NORMAL;
+        _slots[i].enqueuedAtMs = 0;
+        _slots[i].seq = 0;
+        _slots[i].reissues = 0;
+        _slots[i].tag = 0;
+        // Push in reverse so that slot 0 is handed out first.
+        _freeSlots[_freeCount++] = HTTP_REQUEST_QUEUE_CAPACITY - 1 - i;
+    }
+    for (uint8_t level = 0; level < HTTP_REQUEST_PRIORITY_LEVELS; ++level) {
+        _rings[level].head = 0;
+        _rings[level].count = 0;
+    }
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief Copies a request into the queue, coalescing duplicate GETs and evicting less urgent work when full.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+bool HttpRequestQueue::push(const char* url, const char* method, const char* apiType, const char* payload,
+                            const HttpResponseCallback& cb, bool needsAuth,
+                            HttpRequestPriority priority, unsigned long nowMs, uint16_t tag) {
+    if (!url || !method || url[0] == '\0' || method[0] == '\0') {
+        DEBUG_PRINTLN(1, "HttpRequestQueue: Rejected request with empty URL or method.");
+        _stats.dropped++;
+        return false;
+    }
+    size_t payloadLen = payload ? strlen(payload) : 0;
+    bool bulk = payloadLen >= HTTP_REQUEST_PAYLOAD_MAX_LEN;
+    if (strlen(url) >= API_URL_MAX_LEN || payloadLen >= HTTP_BULK_PAYLOAD_MAX_LEN) {
+        DEBUG_PRINTF(1, "HttpRequestQueue: Rejected '%s', URL or payload exceeds descriptor buffers.\n", apiType ? apiType : "?");
+        _stats.dropped++;
+        return false;
+    }
+    if (bulk && _bulkInUse && !evictBulkLessUrgentThan(priority)) {
+        DEBUG_PRINTF(2, "HttpRequestQueue: Bulk buffer busy. Dropped '%s'.\n", apiType ? apiType : "?");
+        _stats.dropped++;
+        return false;
+    }
+
+    // Coalesce repeated GETs: a poll that is still waiting does not need a second copy.
+    if (strcmp(method, "GET") == 0) {
+        uint8_t level = 0, position = 0;
+        int existing = findQueuedGet(url, level, position);
+        if (existing >= 0) {
+            HttpRequestDescriptor& d = _slots[existing];
+            // The replaced callback will never run; let its owner know instead of leaving it waiting.
+            if (d.tag != 0 && _retireObserver) _retireObserver(d.tag);
+            d.cb = cb;
+            d.tag = tag;
+            d.needsAuth = needsAuth;
+            if ((uint8_t)priority < level) {
+                // Promote: unlink from the old ring and append to the more urgent one.
+                IndexRing& from = _rings[level];
+                for (uint8_t i = position; i + 1 < from.count; ++i) {
+                    from.slots[(from.head + i) % HTTP_REQUEST_QUEUE_CAPACITY] =
+                        from.slots[(from.head + i + 1) % HTTP_REQUEST_QUEUE_CAPACITY];
+                }
+                from.count--;
+                IndexRing& to = _rings[(uint8_t)priority];
+                to.slots[(to.head + to.count) % HTTP_REQUEST_QUEUE_CAPACITY] = (uint8_t)existing;
+                to.count++;
+                d.priority = priority;
+            }
+            _stats.coalesced++;
+            DEBUG_PRINTF(4, "HttpRequestQueue: Coalesced '%s' into queued request.\n", apiType ? apiType : "?");
+            return true;
+        }
+    }
+
+    if (_freeCount == 0 && !evictLessUrgentThan(priority)) {
+        _stats.dropped++;
+        DEBUG_PRINTF(2, "HttpRequestQueue: Full (%u). Dropped '%s'.\n", (unsigned)HTTP_REQUEST_QUEUE_CAPACITY, apiType ? apiType : "?");
+        return false;
+    }
+
+    uint8_t slot = _freeSlots[--_freeCount];
+    HttpRequestDescriptor& d = _slots[slot];
+    copyField(d.url, sizeof(d.url), url);
+    copyField(d.method, sizeof(d.method), method);
+    copyField(d.apiType, sizeof(d.apiType), apiType);
+    if (bulk) {
+        memcpy(_bulkPayload, payload, payloadLen + 1);
+        _bulkInUse = true;
+        d.payload[0] = '\0';
+    } else {
+        copyField(d.payload, sizeof(d.payload), payload);
+    }
+    d.bulkPayload = bulk;
+    d.cb = cb;
+    d.needsAuth = needsAuth;
+    d.priority = priority;
+    d.enqueuedAtMs = nowMs;
+    d.seq = _nextSeq++;
+    d.reissues = 0;
+    d.tag = tag;
+
+    IndexRing& ring = _rings[(uint8_t)priority];
+    ring.slots[(ring.head + ring.count) % HTTP_REQUEST_QUEUE_CAPACITY] = slot;
+    ring.count++;
+
+    _stats.enqueued++;
+    _stats.depth = size();
+    if (_stats.depth > _stats.highWaterMark) _stats.highWaterMark = _stats.depth;
+    return true;
+}
+
+/**
+ * @brief Returns the head of the most urgent non-empty level.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+HttpRequestDescriptor* HttpRequestQueue::peek() {
+    for (uint8_t level = 0; level < HTTP_REQUEST_PRIORITY_LEVELS; ++level) {
+        if (_rings[level].count > 0) {
+            return &_slots[_rings[level].slots[_rings[level].head]];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Gets the body of a queued request.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+const char* HttpRequestQueue::payloadOf(const HttpRequestDescriptor& d) const {
+    if (d.bulkPayload) return _bulkPayload;
+    return d.payload[0] != '\0' ? d.payload : nullptr;
+}
+
+/**
+ * @brief Removes the head request and records its wait time; a dispatched request keeps its slot.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+void HttpRequestQueue::pop(unsigned long nowMs, bool dispatched) {
+    for (uint8_t level = 0; level < HTTP_REQUEST_PRIORITY_LEVELS; ++level) {
+        IndexRing& ring = _rings[level];
+        if (ring.count == 0) continue;
+
+        uint8_t slot = ring.slots[ring.head];
+        ring.head = (ring.head + 1) % HTTP_REQUEST_QUEUE_CAPACITY;
+        ring.count--;
+
+        if (dispatched) {
+            unsigned long waitMs = nowMs - _slots[slot].enqueuedAtMs;
+            _stats.dispatched++;
+            _stats.lastWaitMs = waitMs;
+            _stats.totalWaitMs += waitMs;
+            if (waitMs > _stats.maxWaitMs) _stats.maxWaitMs = waitMs;
+            completeInFlight(false); // The interface runs one request at a time, so the previous one is over.
+            _inFlightSlot = slot;
+        } else {
+            _stats.dropped++;
+            retireSlot(slot);
+        }
+        _stats.depth = size();
+        return;
+    }
+}
+
+/**
+ * @brief Gets the request last dispatched while its slot is held.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+const HttpRequestDescriptor* HttpRequestQueue::inFlight() const {
+    return _inFlightSlot >= 0 ? &_slots[_inFlightSlot] : nullptr;
+}
+
+/**
+ * @brief Releases the slot of the finished in-flight request.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+void HttpRequestQueue::completeInFlight(bool answered) {
+    if (_inFlightSlot < 0) return;
+    if (answered) releaseSlot((uint8_t)_inFlightSlot);
+    else retireSlot((uint8_t)_inFlightSlot);
+    _inFlightSlot = -1;
+}
+
+/**
+ * @brief Puts the in-flight request back at the head of its level.
+ * The rings hold slot indices and there are only `HTTP_REQUEST_QUEUE_CAPACITY` slots, so there is always room.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+bool HttpRequestQueue::requeueInFlight() {
+    if (_inFlightSlot < 0) return false;
+    uint8_t slot = (uint8_t)_inFlightSlot;
+    _inFlightSlot = -1;
+    HttpRequestDescriptor& d = _slots[slot];
+
+    uint8_t level = 0, position = 0;
+    if (strcmp(d.method, "GET") == 0 && findQueuedGet(d.url, level, position) >= 0) {
+        // The same poll was queued again while this one was out; the queued copy has the newer callback.
+        DEBUG_PRINTF(4, "HttpRequestQueue: Requeued '%s' merged into queued request.\n", d.apiType);
+        retireSlot(slot);
+        _stats.coalesced++;
+        return true;
+    }
+    if (d.reissues >= HTTP_REQUEST_MAX_REISSUES) {
+        DEBUG_PRINTF(1, "HttpRequestQueue: '%s' re-issued %u times already. Dropped.\n", d.apiType, (unsigned)d.reissues);
+        retireSlot(slot);
+        _stats.dropped++;
+        return false;
+    }
+    d.reissues++;
+
+    IndexRing& ring = _rings[(uint8_t)d.priority];
+    ring.head = (ring.head + HTTP_REQUEST_QUEUE_CAPACITY - 1) % HTTP_REQUEST_QUEUE_CAPACITY;
+    ring.slots[ring.head] = slot;
+    ring.count++;
+    _stats.requeued++;
+    _stats.depth = size();
+    if (_stats.depth > _stats.highWaterMark) _stats.highWaterMark = _stats.depth;
+    DEBUG_PRINTF(3, "HttpRequestQueue: Requeued '%s' at the head of its level.\n", d.apiType);
+    return true;
+}
+
+/**
+ * @brief Discards all queued requests.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+void HttpRequestQueue::clear() {
+    for (uint8_t level = 0; level < HTTP_REQUEST_PRIORITY_LEVELS; ++level) {
+        IndexRing& ring = _rings[level];
+        while (ring.count > 0) {
+            retireSlot(ring.slots[ring.head]);
+            ring.head = (ring.head + 1) % HTTP_REQUEST_QUEUE_CAPACITY;
+            ring.count--;
+            _stats.dropped++;
+        }
+        ring.head = 0;
+    }
+    _stats.depth = 0;
+}
+
+/**
+ * @brief Gets the number of queued requests.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+uint8_t HttpRequestQueue::size() const {
+    return HTTP_REQUEST_QUEUE_CAPACITY - _freeCount - (_inFlightSlot >= 0 ? 1 : 0);
+}
+
+/**
+ * @brief Checks whether the queue is empty.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+bool HttpRequestQueue::isEmpty() const {
+    return size() == 0;
+}
+
+/**
+ * @brief Gets the running queue statistics.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+const HttpRequestQueue::Stats& HttpRequestQueue::getStats() const {
+    return _stats;
+}
+
+/**
+ * @brief Resets all counters except the current depth.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+void HttpRequestQueue::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.depth = size();
+    _stats.highWaterMark = _stats.depth;
+}
+
+/**
+ * @brief Linear search over all rings for a queued GET to `url`.
+ * The queue holds at most `HTTP_REQUEST_QUEUE_CAPACITY` entries, so this is a handful of string compares.
+ */
+int HttpRequestQueue::findQueuedGet(const char* url, uint8_t& level, uint8_t& position) const {
+    for (uint8_t l = 0; l < HTTP_REQUEST_PRIORITY_LEVELS; ++l) {
+        const IndexRing& ring = _rings[l];
+        for (uint8_t i = 0; i < ring.count; ++i) {
+            uint8_t slot = ring.slots[(ring.head + i) % HTTP_REQUEST_QUEUE_CAPACITY];
+            const HttpRequestDescriptor& d = _slots[slot];
+            if (strcmp(d.method, "GET") == 0 && strcmp(d.url, url) == 0) {
+                level = l;
+                position = i;
+                return slot;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Evicts the newest entry of the least urgent level below `priority`.
+ * Newest rather than oldest so that the request closest to dispatch keeps its place.
+ */
+bool HttpRequestQueue::evictLessUrgentThan(HttpRequestPriority priority) {
+    for (int level = HTTP_REQUEST_PRIORITY_LEVELS - 1; level > (int)priority; --level) {
+        IndexRing& ring = _rings[level];
+        if (ring.count == 0) continue;
+
+        uint8_t tail = (ring.head + ring.count - 1) % HTTP_REQUEST_QUEUE_CAPACITY;
+        uint8_t slot = ring.slots[tail];
+        DEBUG_PRINTF(2, "HttpRequestQueue: Evicting '%s' for more urgent request.\n", _slots[slot].apiType);
+        ring.count--;
+        retireSlot(slot);
+        _stats.dropped++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Evicts the queued request holding the bulk buffer if it is less urgent than `priority`.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+bool HttpRequestQueue::evictBulkLessUrgentThan(HttpRequestPriority priority) {
+    for (int level = HTTP_REQUEST_PRIORITY_LEVELS - 1; level > (int)priority; --level) {
+        IndexRing& ring = _rings[level];
+        for (uint8_t i = 0; i < ring.count; ++i) {
+            uint8_t slot = ring.slots[(ring.head + i) % HTTP_REQUEST_QUEUE_CAPACITY];
+            if (!_slots[slot].bulkPayload) continue;
+            DEBUG_PRINTF(2, "HttpRequestQueue: Evicting bulk '%s' for more urgent request.\n", _slots[slot].apiType);
+            for (; i + 1 < ring.count; ++i) {
+                ring.slots[(ring.head + i) % HTTP_REQUEST_QUEUE_CAPACITY] =
+                    ring.slots[(ring.head + i + 1) % HTTP_REQUEST_QUEUE_CAPACITY];
+            }
+            ring.count--;
+            retireSlot(slot);
+            _stats.dropped++;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns a slot to the free stack.
+ * The callback is reset so that any captured state is released immediately.
+ */
+void HttpRequestQueue::releaseSlot(uint8_t slot) {
+    _slots[slot].cb = nullptr;
+    if (_slots[slot].bulkPayload) {
+        _slots[slot].bulkPayload = false;
+        _bulkInUse = false;
+    }
+    _freeSlots[_freeCount++] = slot;
+}
+
+/**
+ * @brief Reports the tag of a discarded request, then releases its slot.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+void HttpRequestQueue::retireSlot(uint8_t slot) {
+    if (_slots[slot].tag != 0 && _retireObserver) _retireObserver(_slots[slot].tag);
+    releaseSlot(slot);
+}
+
+/**
+ * @brief Copies a C-string into a fixed buffer, always null-terminating.
+ * Refer to HttpRequestQueue.h for detailed documentation.
+ */
+void HttpRequestQueue::copyField(char* dest, size_t destSize, const char* src) {
+    if (!src) {
+        dest[0] = '\0';
+        return;
+    }
+    strncpy(dest, src, destSize - 1);
+    dest[destSize - 1] = '\0';
+}
@@ -0,0 +1,291 @@
+/**
+ * @file HttpRequestQueue.h
+ * @brief Defines the `HttpRequestQueue` class, a fixed-capacity, priority-aware queue of pending HTTP requests.
+ *
+ * The underlying network managers (`WiFiManager`, `GPRSManager`) can only run a single asynchronous
+ * HTTP operation at a time and reject any request issued while one is in flight. The `NetworkFacade`
+ * uses this queue to hold requests until the active interface is free, so that the threshold, node data,
+ * device status and relay status calls issued back-to-back from the main loop are no longer dropped.
+ *
+ * Design notes:
+ * - All request descriptors live in a statically sized slot pool (`HTTP_REQUEST_QUEUE_CAPACITY` from
+ *   `config.h`). URL, method, API type and payload are copied into fixed `char` buffers and the callback into
+ *   an `HttpResponseCallback`, so queueing a request never allocates from the heap.
+ * - A body too large for a slot (up to `HTTP_BULK_PAYLOAD_MAX_LEN`, e.g. a telemetry replay batch) is held in a
+ *   single shared bulk buffer instead, so only one such request can be queued at a time.
+ * - Each `HttpRequestPriority` level has its own small ring of slot indices. Dequeuing always serves the
+ *   most urgent non-empty ring first and is FIFO within a level.
+ * - When the pool is full, a more urgent request evicts the newest request of the least urgent level
+ *   present; otherwise the new request is rejected. Both cases are counted as drops.
+ * - A GET whose URL is already queued is coalesced into the existing entry instead of occupying a new slot,
+ *   which keeps periodic polls from piling up while the link is busy or down.
+ * - The request last dispatched keeps its slot (and the bulk buffer) until the facade reports it finished. If the
+ *   interface it went out on is lost or switched first, `requeueInFlight()` puts it back at the head of its level
+ *   for re-issue, up to `HTTP_REQUEST_MAX_REISSUES` times.
+ * - Every accepted request gets a sequence number (`seq`), kept across re-issues, from which the facade derives
+ *   the `Idempotency-Key` of POSTs so the server can drop a repeat.
+ * - A request may carry a caller `tag`. Whenever a request ends without its callback running (evicted, replaced by a
+ *   coalesced GET, dropped after a refused dispatch or too many re-issues, cleared, or completed unanswered), the
+ *   retire observer is told its tag, so a caller that keeps per-request state elsewhere can release it at once.
+ * - Time is passed in by the caller (`nowMs`), keeping the queue free of direct `millis()` calls.
+ */
+#ifndef HTTP_REQUEST_QUEUE_H
+#define HTTP_REQUEST_QUEUE_H
+
+#include <stdint.h>      // For fixed-width integer types.
+#include <stddef.h>      // For `size_t`.
+#include <functional>    // For `std::function` used by the retire observer.
+#include <ArduinoJson.h> // For `JsonDocument` used in the callback signature.
+#include "config.h"      // For `HTTP_REQUEST_QUEUE_CAPACITY` and descriptor buffer sizes.
+#include "InplaceFunction.h" // For `HttpResponseCallback`.
+
+/**
+ * @brief Response callback of an HTTP request: receives the parsed body and returns `true` if it was usable.
+ * Captures are stored inline (`HTTP_RESPONSE_CALLBACK_STORAGE` bytes), so the copies made on the way from
+ * `NetworkWorker::submit()` to the manager never allocate; a lambda that captures more does not compile.
+ */
+typedef InplaceFunction<bool(JsonDocument& doc), HTTP_RESPONSE_CALLBACK_STORAGE> HttpResponseCallback;
+
+/**
+ * @enum HttpRequestPriority
+ * @brief Scheduling priority of a queued HTTP request. Lower numeric value is served first.
+ */
+enum class HttpRequestPriority : uint8_t {
+    URGENT = 0,     ///< Control-path traffic: relay status uplinks and manual override polls.
+    NORMAL = 1,     ///< Regular data fetches (thresholds, node data).
+    BACKGROUND = 2  ///< Housekeeping that tolerates delay (e.g., HTTP time synchronisation).
+};
+
+/**
+ * @brief Number of distinct `HttpRequestPriority` levels.
+ */
+const uint8_t HTTP_REQUEST_PRIORITY_LEVELS = 3;
+
+/**
+ * @struct HttpRequestDescriptor
+ * @brief A self-contained copy of everything needed to start one asynchronous HTTP request.
+ */
+struct HttpRequestDescriptor {
+    char url[API_URL_MAX_LEN];                       ///< Target URL (copied, so the caller's buffer may be reused).
+    char method[HTTP_REQUEST_METHOD_MAX_LEN];        ///< HTTP method, e.g. "GET" or "POST".
+    char apiType[HTTP_REQUEST_API_TYPE_MAX_LEN];     ///< Descriptive tag for logging (truncated if longer).
+    char payload[HTTP_REQUEST_PAYLOAD_MAX_LEN];      ///< Request body; empty string for GET requests and bulk bodies.
+    bool bulkPayload;                                ///< Body is held in the queue's bulk buffer; read it with `payloadOf()`.
+    HttpResponseCallback cb;                         ///< Response callback, may be empty for fire-and-forget POSTs.
+    bool needsAuth;                                  ///< Whether the Authorization header should be sent.
+    HttpRequestPriority priority;                    ///< Scheduling priority of this request.
+    unsigned long enqueuedAtMs;                      ///< `millis()` timestamp at which the request was queued.
+    uint32_t seq;                                    ///< Sequence number assigned by `push()`; unchanged when re-issued.
+    uint8_t reissues;                                ///< Times the request was requeued by `requeueInFlight()`.
+    uint16_t tag;                                    ///< Caller's id for the request, passed to the retire observer; 0 if none.
+};
+
+/**
+ * @class HttpRequestQueue
+ * @brief Fixed-capacity, allocation-free priority queue of `HttpRequestDescriptor`s.
+ */
+class HttpRequestQueue {
+public:
+    /**
+     * @brief Told the `tag` of a request that ended without its callback running. Only called for non-zero tags.
+     */
+    using RetireObserver = std::function<void(uint16_t tag)>;
+
+    /**
+     * @struct Stats
+     * @brief Running counters describing queue behaviour since boot (or the last `resetStats()`).
+     */
+    struct Stats {
+        uint32_t enqueued;         ///< Requests accepted into the queue.
+        uint32_t coalesced;        ///< GET requests merged into an identical queued entry.
+        uint32_t dispatched;       ///< Requests handed to a network interface.
+        uint32_t dropped;          ///< Requests rejected or evicted because the queue was full, or discarded after a failed dispatch.
+        uint32_t requeued;         ///< Dispatched requests put back by `requeueInFlight()` after their interface was lost or switched.
+        uint8_t depth;             ///< Current number of queued requests.
+        uint8_t highWaterMark;     ///< Largest depth observed.
+        unsigned long lastWaitMs;  ///< Queue wait time of the most recently dispatched request.
+        unsigned long maxWaitMs;   ///< Longest queue wait time observed.
+        unsigned long totalWaitMs; ///< Sum of all wait times, for computing the average over `dispatched`.
+    };
+
+    /**
+     * @brief Constructs an empty queue with all slots free.
+     */
+    HttpRequestQueue();
+
+    /**
+     * @brief Copies a request into the queue.
+     *
+     * A GET request for a URL that is already queued is coalesced: the queued entry keeps its position,
+     * adopts the newer callback and tag and is promoted to the more urgent of the two priorities. The callback it
+     * replaces never runs, so its tag is retired.
+     *
+     * @param url Target URL. Must not be `nullptr`; truncated to `API_URL_MAX_LEN - 1` characters.
+     * @param method HTTP method. Must not be `nullptr`.
+     * @param apiType Descriptive tag for logging. May be `nullptr`.
+     * @param payload Request body. May be `nullptr`. A body that does not fit `HTTP_REQUEST_PAYLOAD_MAX_LEN` goes into
+     *                the bulk buffer; it is rejected if it does not fit `HTTP_BULK_PAYLOAD_MAX_LEN`, or if the buffer is
+     *                held by a request in flight or by a queued one at least as urgent. A less urgent queued
+     *                holder is evicted (and its tag retired) first.
+     * @param cb Response callback. May be empty.
+     * @param needsAuth Whether the request requires the Authorization header.
+     * @param priority Scheduling priority.
+     * @param nowMs Current `millis()` timestamp, recorded for wait-time statistics.
+     * @param tag Caller's id for the request, reported to the retire observer if the request is discarded; 0 for none.
+     *            A rejected request is not reported (the caller sees `false`).
+     * @return `true` if the request was queued or coalesced, `false` if it was rejected.
+     */
+    bool push(const char* url, const char* method, const char* apiType, const char* payload,
+              const HttpResponseCallback& cb, bool needsAuth,
+              HttpRequestPriority priority, unsigned long nowMs, uint16_t tag = 0);
+
+    /**
+     * @brief Sets the observer told the tag of each request that ends without its callback running.
+     * @param observer Called synchronously from the discarding method; may be empty.
+     */
+    void setRetireObserver(RetireObserver observer) { _retireObserver = observer; }
+
+    /**
+     * @brief Returns the request that would be dispatched next, without removing it.
+     * @return Pointer to the head descriptor of the most urgent non-empty level, or `nullptr` if the queue is empty.
+     *         The pointer stays valid until the next `pop()`, `push()` or `clear()`; after a dispatching `pop()` it
+     *         stays valid as `inFlight()`.
+     */
+    HttpRequestDescriptor* peek();
+
+    /**
+     * @brief Gets the body of a queued request, from its slot or from the bulk buffer.
+     * @param d Descriptor returned by `peek()`.
+     * @return The body, or `nullptr` if the request has none. Valid until the request is popped.
+     */
+    const char* payloadOf(const HttpRequestDescriptor& d) const;
+
+    /**
+     * @brief Removes the request returned by `peek()`.
+     * A discarded request releases its slot at once and is retired. A dispatched one keeps it as `inFlight()` until
+     * `completeInFlight()` or `requeueInFlight()`; a previous in-flight request still held is completed first, unanswered.
+     * @param nowMs Current `millis()` timestamp, used to compute the request's queue wait time.
+     * @param dispatched `true` if the request was handed to an interface, `false` if it is being discarded
+     *                   (counted as a drop).
+     */
+    void pop(unsigned long nowMs, bool dispatched);
+
+    /**
+     * @brief Gets the request last dispatched, while its slot is held.
+     * @return The descriptor, or `nullptr` if none is in flight.
+     */
+    const HttpRequestDescriptor* inFlight() const;
+
+    /**
+     * @brief Releases the slot of the in-flight request once its interface finished it (successfully or not).
+     * @param answered `true` if its callback ran (or the caller was otherwise told the outcome); if `false` the
+     *                 request is retired.
+     */
+    void completeInFlight(bool answered);
+
+    /**
+     * @brief Puts the in-flight request back at the head of its priority level, to be dispatched again.
+     * Its original enqueue time and sequence number are kept, so the wait statistics include the failed attempt and a
+     * POST is re-sent with the same idempotency key. A GET whose URL was queued again meanwhile is merged into that
+     * entry instead (counted as coalesced) and retired, as the queued copy carries the newer callback. A request already
+     * re-issued `HTTP_REQUEST_MAX_REISSUES` times is dropped and retired.
+     * @return `true` if the request will be dispatched again; `false` if none was in flight or it was dropped.
+     */
+    bool requeueInFlight();
+
+    /**
+     * @brief Discards all queued requests. Discarded requests are counted as drops and retired; the in-flight one is kept.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of queued requests, not counting the one in flight.
+     * @return Current queue depth.
+     */
+    uint8_t size() const;
+
+    /**
+     * @brief Checks whether the queue holds no requests waiting for dispatch.
+     * @return `true` if empty.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Gets the running queue statistics.
+     * @return Reference to the internal `Stats` structure.
+     */
+    const Stats& getStats() const;
+
+    /**
+     * @brief Resets all counters except the current depth.
+     */
+    void resetStats();
+
+private:
+    /**
+     * @struct IndexRing
+     * @brief Ring buffer of slot indices for one priority level.
+     */
+    struct IndexRing {
+        uint8_t slots[HTTP_REQUEST_QUEUE_CAPACITY]; ///< Slot indices in FIFO order.
+        uint8_t head;                               ///< Position of the oldest entry.
+        uint8_t count;                              ///< Number of entries in the ring.
+    };
+
+    HttpRequestDescriptor _slots[HTTP_REQUEST_QUEUE_CAPACITY]; ///< Descriptor pool; never reallocated.
+    uint8_t _freeSlots[HTTP_REQUEST_QUEUE_CAPACITY];           ///< Stack of free slot indices.
+    uint8_t _freeCount;                                        ///< Number of valid entries in `_freeSlots`.
+    IndexRing _rings[HTTP_REQUEST_PRIORITY_LEVELS];            ///< One FIFO ring per priority level.
+    Stats _stats;                                              ///< Running statistics.
+    char _bulkPayload[HTTP_BULK_PAYLOAD_MAX_LEN];              ///< Body of the one queued request too large for its slot.
+    bool _bulkInUse;                                           ///< `_bulkPayload` belongs to a queued or in-flight request.
+    int16_t _inFlightSlot;                                     ///< Slot of the request last dispatched, held until it finishes; -1 if none.
+    uint32_t _nextSeq;                                         ///< Sequence number of the next accepted request.
+    RetireObserver _retireObserver;                            ///< Told the tags of discarded requests; may be empty.
+
+    /**
+     * @brief Searches the queue for a GET request to `url`.
+     * @param url URL to look for.
+     * @param level Receives the priority level of the match.
+     * @param position Receives the ring position of the match.
+     * @return Slot index of the match, or -1 if none is queued.
+     */
+    int findQueuedGet(const char* url, uint8_t& level, uint8_t& position) const;
+
+    /**
+     * @brief Evicts the newest entry of the least urgent level that is less urgent than `priority`.
+     * @param priority Priority of the request that needs a slot.
+     * @return `true` if an entry was evicted and its slot returned to the free stack.
+     */
+    bool evictLessUrgentThan(HttpRequestPriority priority);
+
+    /**
+     * @brief Evicts the queued request that holds the bulk buffer, if it is less urgent than `priority`.
+     * A bulk request already in flight is never evicted; its buffer frees when it finishes.
+     * @param priority Priority of the bulk request that needs the buffer.
+     * @return `true` if the holder was evicted, freeing both its slot and the bulk buffer.
+     */
+    bool evictBulkLessUrgentThan(HttpRequestPriority priority);
+
+    /**
+     * @brief Returns a slot to the free stack, clears its callback and frees the bulk buffer if it held it.
+     * @param slot Slot index to release.
+     */
+    void releaseSlot(uint8_t slot);
+
+    /**
+     * @brief Reports a discarded request's tag to the retire observer, then releases its slot.
+     * @param slot Slot index of the discarded request.
+     */
+    void retireSlot(uint8_t slot);
+
+    /**
+     * @brief Copies a C-string into a fixed buffer, always null-terminating.
+     * @param dest Destination buffer.
+     * @param destSize Size of `dest` in bytes.
+     * @param src Source string; `nullptr` is treated as empty.
+     */
+    static void copyField(char* dest, size_t destSize, const char* src);
+};
+
+#endif // HTTP_REQUEST_QUEUE_H
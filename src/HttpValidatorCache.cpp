@@ -0,0 +1,116 @@
+#include "HttpValidatorCache.h"
+
+/**
+ * @brief Constructs an empty cache.
+ * Refer to HttpValidatorCache.h for detailed documentation.
+ */
+HttpValidatorCache::HttpValidatorCache() {
+    memset(_entries, 0, sizeof(_entries));
+    memset(_buckets, 0, sizeof(_buckets));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief Gets the validators stored for a URL.
+ * Refer to HttpValidatorCache.h for detailed documentation.
+ */
+const HttpValidators* HttpValidatorCache::lookup(const char* url, unsigned long nowMs) {
+    Entry* e = find(hashUrl(url));
+    if (!e || !e->validators.isSet()) return nullptr;
+    e->lastUsedMs = nowMs;
+    return &e->validators;
+}
+
+/**
+ * @brief Updates the cache from a completed GET.
+ * Refer to HttpValidatorCache.h for detailed documentation.
+ */
+void HttpValidatorCache::onResponse(const char* url, const HttpResponseInfo& info, bool overGprs, unsigned long nowMs) {
+    uint32_t hash = hashUrl(url);
+
+    if (info.notModified) {
+        _stats.notModified++;
+        Entry* e = find(hash);
+        if (!e) return; // Evicted since the request went out; nothing to credit.
+        e->lastUsedMs = nowMs;
+        _stats.bytesSaved += e->lastBodyBytes;
+        _stats.parseUsSaved += e->lastParseUs;
+        if (overGprs) {
+            uint32_t period = nowMs / HTTP_SAVINGS_BUCKET_MS;
+            SavingsBucket& b = _buckets[period % HTTP_SAVINGS_WINDOW_BUCKETS];
+            if (b.period != period) {
+                b.period = period;
+                b.bytes = 0;
+                b.parseUs = 0;
+            }
+            b.bytes += e->lastBodyBytes;
+            b.parseUs += e->lastParseUs;
+        }
+        DEBUG_PRINTF(4, "HttpValidatorCache: 304, saved %lu bytes / %lu us.\n", (unsigned long)e->lastBodyBytes, (unsigned long)e->lastParseUs);
+        return;
+    }
+
+    if (info.statusCode < 200 || info.statusCode >= 300) return;
+
+    if (!info.validators.isSet()) {
+        // The endpoint stopped sending validators (or never did): do not keep revalidating a stale tag.
+        Entry* e = find(hash);
+        if (e) e->urlHash = 0;
+        return;
+    }
+    Entry* e = claim(hash);
+    e->lastUsedMs = nowMs;
+    e->lastBodyBytes = info.bodyBytes;
+    e->lastParseUs = info.parseUs;
+    e->validators = info.validators;
+}
+
+/**
+ * @brief Gets the counters with the hourly GPRS window evaluated at `nowMs`.
+ * Refer to HttpValidatorCache.h for detailed documentation.
+ */
+HttpValidatorCache::Stats HttpValidatorCache::getStats(unsigned long nowMs) const {
+    Stats s = _stats;
+    uint32_t period = nowMs / HTTP_SAVINGS_BUCKET_MS;
+    s.gprsBytesSavedLastHour = 0;
+    s.gprsParseUsSavedLastHour = 0;
+    for (const SavingsBucket& b : _buckets) {
+        if (period - b.period >= HTTP_SAVINGS_WINDOW_BUCKETS) continue; // Older than the window (or never used).
+        s.gprsBytesSavedLastHour += b.bytes;
+        s.gprsParseUsSavedLastHour += b.parseUs;
+    }
+    return s;
+}
+
+/**
+ * @brief Hashes a URL with 32-bit FNV-1a.
+ * Refer to HttpValidatorCache.h for detailed documentation.
+ */
+uint32_t HttpValidatorCache::hashUrl(const char* url) {
+    uint32_t h = 2166136261UL;
+    for (const char* p = url; *p; ++p) {
+        h ^= (uint8_t)*p;
+        h *= 16777619UL;
+    }
+    return h ? h : 1;
+}
+
+HttpValidatorCache::Entry* HttpValidatorCache::find(uint32_t hash) {
+    for (Entry& e : _entries) {
+        if (e.urlHash == hash) return &e;
+    }
+    return nullptr;
+}
+
+HttpValidatorCache::Entry* HttpValidatorCache::claim(uint32_t hash) {
+    Entry* e = find(hash);
+    if (e) return e;
+    Entry* victim = &_entries[0];
+    for (Entry& c : _entries) {
+        if (c.urlHash == 0) { victim = &c; break; }
+        if ((long)(c.lastUsedMs - victim->lastUsedMs) < 0) victim = &c;
+    }
+    memset(victim, 0, sizeof(*victim));
+    victim->urlHash = hash;
+    return victim;
+}
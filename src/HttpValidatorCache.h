@@ -0,0 +1,146 @@
+/**
+ * @file HttpValidatorCache.h
+ * @brief Defines `HttpValidatorCache`, which remembers `ETag`/`Last-Modified` per GET endpoint for conditional requests.
+ *
+ * The threshold, node data and device status endpoints are polled on a fixed schedule, yet the threshold
+ * list in particular almost never changes. `NetworkFacade` keeps one of these caches and, before it
+ * dispatches a GET, hands the endpoint's stored validators to the active interface, which then sends
+ * `If-None-Match` / `If-Modified-Since`. A `304 Not Modified` reply has no body: the manager skips the read,
+ * the JSON parse and the response callback, and reports the response through `HttpResponseInfo`.
+ *
+ * For every 304 the cache credits the body size and parse time of the last full (200) response of that
+ * endpoint as "saved". Savings on the GPRS link are also kept in a rolling one-hour window
+ * (`HTTP_SAVINGS_WINDOW_BUCKETS` x `HTTP_SAVINGS_BUCKET_MS`), since that is the link where bytes cost money.
+ *
+ * Endpoints are keyed by a 32-bit FNV-1a hash of the full URL, so a slot costs no URL copy. Slots are
+ * reused least-recently-used. Time is passed in by the caller (`nowMs`). Not thread-safe; used from the
+ * network worker task only.
+ */
+#ifndef HTTP_VALIDATOR_CACHE_H
+#define HTTP_VALIDATOR_CACHE_H
+
+#include <Arduino.h>
+#include "config.h" // For HTTP_VALIDATOR_CACHE_SLOTS, validator lengths and the savings window.
+
+/**
+ * @struct HttpValidators
+ * @brief Cache validators of one response. Empty strings mean "not sent by the server".
+ */
+struct HttpValidators {
+    char etag[HTTP_ETAG_MAX_LEN];                  ///< `ETag` value as received, including quotes and any `W/` prefix.
+    char lastModified[HTTP_LAST_MODIFIED_MAX_LEN]; ///< `Last-Modified` value as received.
+
+    /**
+     * @brief Checks whether a conditional request can be built from these validators.
+     * @return `true` if either validator is set.
+     */
+    bool isSet() const { return etag[0] != '\0' || lastModified[0] != '\0'; }
+};
+
+/**
+ * @struct HttpResponseInfo
+ * @brief Outcome of one HTTP transaction, reported by a `NetworkInterface` to its response observer.
+ */
+struct HttpResponseInfo {
+    int statusCode;            ///< Final HTTP status code, or <= 0 for a transport error.
+    bool notModified;          ///< `true` for a `304` answering a conditional request; no body and no callback.
+    uint32_t bodyBytes;        ///< Response body bytes received (after de-chunking).
+    uint32_t parseUs;          ///< Time spent deserializing the body, in microseconds.
+    HttpValidators validators; ///< Validators sent with a 2xx response.
+    uint16_t tag;              ///< Caller's tag of the request (see `HttpRequestQueue::push()`); set by `NetworkFacade`, 0 from an interface.
+};
+
+/**
+ * @class HttpValidatorCache
+ * @brief Fixed-size store of per-endpoint validators plus counters for what conditional requests saved.
+ */
+class HttpValidatorCache {
+public:
+    /**
+     * @struct Stats
+     * @brief Running counters since boot.
+     */
+    struct Stats {
+        uint32_t conditionalSent;        ///< GETs sent with `If-None-Match` or `If-Modified-Since`.
+        uint32_t notModified;            ///< `304` replies received.
+        uint32_t bytesSaved;             ///< Body bytes not transferred thanks to `304`s, all links.
+        uint32_t parseUsSaved;           ///< JSON parse time not spent thanks to `304`s, all links.
+        uint32_t gprsBytesSavedLastHour; ///< Body bytes saved on GPRS in the last hour.
+        uint32_t gprsParseUsSavedLastHour; ///< Parse time saved on GPRS in the last hour, in microseconds.
+    };
+
+    /**
+     * @brief Constructs an empty cache.
+     */
+    HttpValidatorCache();
+
+    /**
+     * @brief Gets the validators stored for a URL.
+     * @param url Full request URL.
+     * @param nowMs Current `millis()`, used for LRU bookkeeping.
+     * @return Pointer to the stored validators, or `nullptr` if none are known.
+     */
+    const HttpValidators* lookup(const char* url, unsigned long nowMs);
+
+    /**
+     * @brief Counts a GET that went out with conditional headers.
+     */
+    void noteConditionalSent() { _stats.conditionalSent++; }
+
+    /**
+     * @brief Updates the cache from a completed GET.
+     * A 2xx response stores its validators and body size/parse time (or forgets the entry if it carries no
+     * validators); a `304` is credited with the stored body size and parse time.
+     * @param url Full request URL.
+     * @param info Response outcome reported by the interface.
+     * @param overGprs `true` if the response arrived over GPRS; counted in the hourly window.
+     * @param nowMs Current `millis()`.
+     */
+    void onResponse(const char* url, const HttpResponseInfo& info, bool overGprs, unsigned long nowMs);
+
+    /**
+     * @brief Gets the counters, with the hourly GPRS window evaluated at `nowMs`.
+     * @param nowMs Current `millis()`.
+     * @return Copy of the statistics.
+     */
+    Stats getStats(unsigned long nowMs) const;
+
+    /**
+     * @brief Hashes a URL into the key used by the cache (32-bit FNV-1a).
+     * @param url Null-terminated URL.
+     * @return Hash value; never 0, which marks a free slot.
+     */
+    static uint32_t hashUrl(const char* url);
+
+private:
+    /**
+     * @struct Entry
+     * @brief Validators and last full-response cost of one endpoint.
+     */
+    struct Entry {
+        uint32_t urlHash;          ///< Key; 0 marks a free slot.
+        unsigned long lastUsedMs;  ///< `millis()` of the last lookup or update, for LRU replacement.
+        uint32_t lastBodyBytes;    ///< Body size of the last 200 response.
+        uint32_t lastParseUs;      ///< Parse time of the last 200 response.
+        HttpValidators validators; ///< Stored validators.
+    };
+
+    /**
+     * @struct SavingsBucket
+     * @brief GPRS savings accumulated during one `HTTP_SAVINGS_BUCKET_MS` period.
+     */
+    struct SavingsBucket {
+        uint32_t period;   ///< `nowMs / HTTP_SAVINGS_BUCKET_MS` the bucket belongs to.
+        uint32_t bytes;    ///< Body bytes saved.
+        uint32_t parseUs;  ///< Parse time saved.
+    };
+
+    Entry* find(uint32_t hash);
+    Entry* claim(uint32_t hash);
+
+    Entry _entries[HTTP_VALIDATOR_CACHE_SLOTS];               ///< Validator slots.
+    SavingsBucket _buckets[HTTP_SAVINGS_WINDOW_BUCKETS];      ///< Rolling one-hour GPRS savings window.
+    Stats _stats;                                             ///< Running counters (hourly fields filled in by `getStats()`).
+};
+
+#endif // HTTP_VALIDATOR_CACHE_H
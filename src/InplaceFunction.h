@@ -0,0 +1,161 @@
+/**
+ * @file InplaceFunction.h
+ * @brief Defines `InplaceFunction`, a copyable callable wrapper that stores its target inside the object.
+ *
+ * A response callback is copied several times on its way from `NetworkWorker::submit()` to the manager that
+ * runs it (callback slot, facade queue slot, `_asyncCb`). `std::function` heap-allocates every copy of a
+ * target larger than its small buffer (two pointers in libstdc++), so a lambda with a few captures cost
+ * several allocations per request. `InplaceFunction` keeps the target in `Capacity` bytes of inline storage
+ * instead; a target that does not fit is a compile error rather than a silent allocation.
+ *
+ * Copying, moving, destroying and calling go through one static table of function pointers per target type, so
+ * the object is `Capacity` bytes plus one pointer. A moved-from `InplaceFunction` is empty. Calling an empty
+ * `InplaceFunction` is undefined; test it first. `fits<Fn>` tells whether a callable would be accepted.
+ *
+ * The template only needs `<type_traits>` and `<utility>`, so it builds unchanged for the ESP32 and for a host
+ * toolchain.
+ */
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <stddef.h>      // For size_t, std::nullptr_t.
+#include <new>           // For placement new.
+#include <type_traits>   // For std::aligned_storage, std::decay, std::enable_if, std::integral_constant.
+#include <utility>       // For std::forward, std::move.
+
+template <typename Signature, size_t Capacity>
+class InplaceFunction;
+
+/**
+ * @class InplaceFunction
+ * @brief Holds any copyable callable of signature `R(Args...)` whose size fits in `Capacity` bytes.
+ * @tparam R Return type.
+ * @tparam Args Argument types.
+ * @tparam Capacity Inline storage in bytes, typically a constant from `config.h`.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+    typedef typename std::aligned_storage<Capacity>::type Storage;
+
+public:
+    /**
+     * @brief Whether a callable of type `Fn` fits the storage; the condition the constructor's `static_assert`s check.
+     */
+    template <typename Fn>
+    struct fits : std::integral_constant<bool, sizeof(typename std::decay<Fn>::type) <= Capacity &&
+                                                   alignof(typename std::decay<Fn>::type) <= alignof(Storage)> {};
+
+    InplaceFunction() : _ops(nullptr) {}
+    InplaceFunction(std::nullptr_t) : _ops(nullptr) {}
+
+    /**
+     * @brief Stores `f`, moved if it is an rvalue.
+     * Fails to compile if `f` needs more than `Capacity` bytes or a stricter alignment than the storage.
+     */
+    template <typename Fn, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<Fn>::type, InplaceFunction>::value>::type>
+    InplaceFunction(Fn&& f) : _ops(nullptr) {
+        typedef typename std::decay<Fn>::type Target;
+        static_assert(sizeof(Target) <= Capacity, "Callable captures too much for this InplaceFunction's storage");
+        static_assert(alignof(Target) <= alignof(Storage), "Callable needs stricter alignment than the storage");
+        new (&_storage) Target(std::forward<Fn>(f));
+        _ops = &Model<Target>::ops;
+    }
+
+    InplaceFunction(const InplaceFunction& other) : _ops(other._ops) {
+        if (_ops) _ops->copy(&_storage, &other._storage);
+    }
+
+    /**
+     * @brief Takes over `other`'s target, leaving `other` empty.
+     */
+    InplaceFunction(InplaceFunction&& other) : _ops(other._ops) {
+        if (_ops) _ops->move(&_storage, &other._storage);
+        other._ops = nullptr;
+    }
+
+    ~InplaceFunction() { reset(); }
+
+    InplaceFunction& operator=(const InplaceFunction& other) {
+        if (this != &other) {
+            reset();
+            if (other._ops) other._ops->copy(&_storage, &other._storage);
+            _ops = other._ops;
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) {
+        if (this != &other) {
+            reset();
+            if (other._ops) other._ops->move(&_storage, &other._storage);
+            _ops = other._ops;
+            other._ops = nullptr;
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    /**
+     * @brief Checks whether a callable is stored.
+     */
+    explicit operator bool() const { return _ops != nullptr; }
+
+    /**
+     * @brief Calls the stored callable. It must not be empty.
+     */
+    R operator()(Args... args) const {
+        return _ops->invoke(&_storage, std::forward<Args>(args)...);
+    }
+
+private:
+    /**
+     * @brief Operations on a stored target of one type.
+     */
+    struct Ops {
+        R (*invoke)(void* target, Args&&... args);
+        void (*copy)(void* dst, const void* src);
+        void (*move)(void* dst, void* src); ///< Move-constructs into `dst` and destroys `src`.
+        void (*destroy)(void* target);
+    };
+
+    /**
+     * @brief `Ops` of target type `T`.
+     */
+    template <typename T>
+    struct Model {
+        static R invoke(void* target, Args&&... args) {
+            return (*static_cast<T*>(target))(std::forward<Args>(args)...);
+        }
+        static void copy(void* dst, const void* src) { new (dst) T(*static_cast<const T*>(src)); }
+        static void move(void* dst, void* src) {
+            new (dst) T(std::move(*static_cast<T*>(src)));
+            static_cast<T*>(src)->~T();
+        }
+        static void destroy(void* target) { static_cast<T*>(target)->~T(); }
+        static const Ops ops;
+    };
+
+    void reset() {
+        if (_ops) _ops->destroy(&_storage);
+        _ops = nullptr;
+    }
+
+    mutable Storage _storage; ///< The target; mutable because a call may change a lambda's captured state.
+    const Ops* _ops;          ///< Operations of the stored target type, or `nullptr` if empty.
+};
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename T>
+const typename InplaceFunction<R(Args...), Capacity>::Ops InplaceFunction<R(Args...), Capacity>::Model<T>::ops = {
+    &InplaceFunction<R(Args...), Capacity>::Model<T>::invoke,
+    &InplaceFunction<R(Args...), Capacity>::Model<T>::copy,
+    &InplaceFunction<R(Args...), Capacity>::Model<T>::move,
+    &InplaceFunction<R(Args...), Capacity>::Model<T>::destroy,
+};
+
+#endif // INPLACE_FUNCTION_H
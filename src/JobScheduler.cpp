@@ -0,0 +1,206 @@
+#include "JobScheduler.h"
+
+/**
+ * @brief Constructs an empty scheduler.
+ * Refer to JobScheduler.h for detailed documentation.
+ */
+JobScheduler::JobScheduler() : _heapSize(0), _wakeups(0) {
+    for (Job& j : _jobs) {
+        j.active = false;
+        j.heapPos = -1;
+    }
+}
+
+int8_t JobScheduler::addPeriodic(const char* name, unsigned long intervalMs, unsigned long firstDelayMs, JobFn fn,
+                                 unsigned long nowMs, unsigned long retryMinMs, unsigned long retryMaxMs) {
+    return add(name, intervalMs ? intervalMs : 1, firstDelayMs, fn, nowMs, retryMinMs, retryMaxMs);
+}
+
+int8_t JobScheduler::addOneShot(const char* name, unsigned long delayMs, JobFn fn, unsigned long nowMs,
+                                unsigned long retryMinMs, unsigned long retryMaxMs) {
+    return add(name, 0, delayMs, fn, nowMs, retryMinMs, retryMaxMs);
+}
+
+/**
+ * @brief Fills a free slot and schedules it.
+ */
+int8_t JobScheduler::add(const char* name, unsigned long intervalMs, unsigned long delayMs, JobFn fn,
+                         unsigned long nowMs, unsigned long retryMinMs, unsigned long retryMaxMs) {
+    if (!fn) return -1;
+    for (uint8_t i = 0; i < JOB_SCHEDULER_MAX_JOBS; ++i) {
+        Job& j = _jobs[i];
+        if (j.active) continue;
+        j.name = name;
+        j.fn = fn;
+        j.intervalMs = intervalMs;
+        j.retryMinMs = retryMinMs;
+        j.retryMaxMs = retryMaxMs > retryMinMs ? retryMaxMs : retryMinMs;
+        j.retryDelayMs = 0;
+        j.dueMs = nowMs + delayMs;
+        j.runs = 0;
+        j.failures = 0;
+        j.active = true;
+        heapInsert(i);
+        return (int8_t)i;
+    }
+    DEBUG_PRINTF(1, "JobScheduler: No slot for job %s.\n", name ? name : "?");
+    return -1;
+}
+
+/**
+ * @brief Moves a job's next run to now.
+ * Refer to JobScheduler.h for detailed documentation.
+ */
+void JobScheduler::runSoon(int8_t id, unsigned long nowMs) {
+    if (id < 0 || id >= JOB_SCHEDULER_MAX_JOBS || !_jobs[id].active) return;
+    Job& j = _jobs[id];
+    j.dueMs = nowMs;
+    if (j.heapPos < 0) heapInsert(id);
+    else siftUp(j.heapPos);
+}
+
+/**
+ * @brief Removes a job.
+ * Refer to JobScheduler.h for detailed documentation.
+ */
+void JobScheduler::cancel(int8_t id) {
+    if (id < 0 || id >= JOB_SCHEDULER_MAX_JOBS || !_jobs[id].active) return;
+    if (_jobs[id].heapPos >= 0) heapRemove(id);
+    _jobs[id].active = false;
+    _jobs[id].fn = nullptr;
+}
+
+/**
+ * @brief Runs every due job once and reschedules it.
+ * A job is taken off the heap while it runs, so it may safely reschedule or cancel itself.
+ * Refer to JobScheduler.h for detailed documentation.
+ */
+uint8_t JobScheduler::runDue(unsigned long nowMs) {
+    uint8_t ran = 0;
+    // Bound the pass so a job that keeps rescheduling itself to "now" cannot starve the caller.
+    while (_heapSize > 0 && ran < JOB_SCHEDULER_MAX_JOBS) {
+        uint8_t id = _heap[0];
+        Job& j = _jobs[id];
+        if ((long)(nowMs - j.dueMs) < 0) break;
+        heapRemove(id);
+
+        JobFn fn = j.fn; // Keep the callable alive even if the job cancels itself.
+        bool ok = fn(nowMs);
+        ran++;
+        if (!j.active) continue; // Cancelled by the job itself.
+        j.runs++;
+        if (j.heapPos >= 0) continue; // Rescheduled by the job itself.
+
+        if (ok || j.retryMinMs == 0) {
+            if (!ok) j.failures++;
+            j.retryDelayMs = 0;
+            if (j.intervalMs == 0) {
+                j.active = false;
+                j.fn = nullptr;
+                continue;
+            }
+            j.dueMs = nowMs + j.intervalMs;
+        } else {
+            j.failures++;
+            j.retryDelayMs = j.retryDelayMs ? j.retryDelayMs * 2 : j.retryMinMs;
+            if (j.retryDelayMs > j.retryMaxMs) j.retryDelayMs = j.retryMaxMs;
+            j.dueMs = nowMs + j.retryDelayMs;
+        }
+        heapInsert(id);
+    }
+    return ran;
+}
+
+/**
+ * @brief Gets the time until the earliest job is due.
+ * Refer to JobScheduler.h for detailed documentation.
+ */
+unsigned long JobScheduler::msUntilNext(unsigned long nowMs) const {
+    if (_heapSize == 0) return NO_DEADLINE;
+    long remaining = (long)(_jobs[_heap[0]].dueMs - nowMs);
+    return remaining > 0 ? (unsigned long)remaining : 0;
+}
+
+/**
+ * @brief Gets a job's current state.
+ * Refer to JobScheduler.h for detailed documentation.
+ */
+bool JobScheduler::getJobInfo(int8_t id, JobInfo& info) const {
+    if (id < 0 || id >= JOB_SCHEDULER_MAX_JOBS || !_jobs[id].active) return false;
+    const Job& j = _jobs[id];
+    info.name = j.name;
+    info.intervalMs = j.intervalMs;
+    info.retryDelayMs = j.retryDelayMs;
+    info.dueMs = j.dueMs;
+    info.runs = j.runs;
+    info.failures = j.failures;
+    return true;
+}
+
+/**
+ * @brief Prints one line per job plus the wakeup count.
+ * Refer to JobScheduler.h for detailed documentation.
+ */
+void JobScheduler::printReport(Print& out, unsigned long nowMs) const {
+    out.printf("Scheduler: %lu wakeups in %lu s\n", (unsigned long)_wakeups, nowMs / 1000);
+    out.printf("%-12s %10s %10s %10s %8s %8s\n", "job", "interval", "retry", "due_in", "runs", "fails");
+    for (uint8_t i = 0; i < JOB_SCHEDULER_MAX_JOBS; ++i) {
+        const Job& j = _jobs[i];
+        if (!j.active) continue;
+        long dueIn = (long)(j.dueMs - nowMs);
+        out.printf("%-12s %10lu %10lu %10ld %8lu %8lu\n", j.name ? j.name : "?", j.intervalMs, j.retryDelayMs,
+                   j.heapPos >= 0 ? dueIn : -1L, (unsigned long)j.runs, (unsigned long)j.failures);
+    }
+}
+
+bool JobScheduler::earlier(uint8_t a, uint8_t b) const {
+    return (long)(_jobs[a].dueMs - _jobs[b].dueMs) < 0;
+}
+
+void JobScheduler::swapHeap(uint8_t i, uint8_t j) {
+    uint8_t t = _heap[i];
+    _heap[i] = _heap[j];
+    _heap[j] = t;
+    _jobs[_heap[i]].heapPos = i;
+    _jobs[_heap[j]].heapPos = j;
+}
+
+void JobScheduler::siftUp(uint8_t pos) {
+    while (pos > 0) {
+        uint8_t parent = (pos - 1) / 2;
+        if (!earlier(_heap[pos], _heap[parent])) break;
+        swapHeap(pos, parent);
+        pos = parent;
+    }
+}
+
+void JobScheduler::siftDown(uint8_t pos) {
+    for (;;) {
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        uint8_t best = pos;
+        if (left < _heapSize && earlier(_heap[left], _heap[best])) best = left;
+        if (right < _heapSize && earlier(_heap[right], _heap[best])) best = right;
+        if (best == pos) break;
+        swapHeap(pos, best);
+        pos = best;
+    }
+}
+
+void JobScheduler::heapInsert(uint8_t job) {
+    _heap[_heapSize] = job;
+    _jobs[job].heapPos = _heapSize;
+    _heapSize++;
+    siftUp(_heapSize - 1);
+}
+
+void JobScheduler::heapRemove(uint8_t job) {
+    uint8_t pos = _jobs[job].heapPos;
+    _heapSize--;
+    if (pos != _heapSize) {
+        swapHeap(pos, _heapSize);
+        siftDown(pos);
+        siftUp(pos);
+    }
+    _jobs[job].heapPos = -1;
+}
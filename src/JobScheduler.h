@@ -0,0 +1,169 @@
+/**
+ * @file JobScheduler.h
+ * @brief Defines `JobScheduler`, a min-heap of timed jobs that replaces per-handler `millis()` polling.
+ *
+ * Periodic and one-shot jobs are registered once; the heap is ordered by due time so the control loop
+ * can run whatever is due and then block until the earliest deadline (`msUntilNext()`) instead of
+ * re-checking every interval on each pass.
+ *
+ * Each job has its own retry policy. A job function returns `true` on success, and the job is next due
+ * after its interval. It returns `false` when it could not do its work (e.g. no network). Then it is
+ * retried after `retryMinMs`, doubling up to `retryMaxMs`; the first success resets the retry delay.
+ * A `retryMinMs` of 0 treats failures like successes.
+ *
+ * Design notes:
+ * - Fixed capacity (`JOB_SCHEDULER_MAX_JOBS`), no allocation after registration.
+ * - Due times are compared wrap-safe, so intervals must stay below ~24 days.
+ * - Time is passed in by the caller (`nowMs`), like `HttpRequestQueue`.
+ * - Jobs may call `runSoon()`, `add*()` or `cancel()` while `runDue()` is executing.
+ */
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <Arduino.h>
+#include <functional>
+#include "config.h" // For JOB_SCHEDULER_MAX_JOBS.
+
+/**
+ * @class JobScheduler
+ * @brief Fixed-capacity scheduler of periodic and one-shot jobs with per-job retry backoff.
+ */
+class JobScheduler {
+public:
+    using JobFn = std::function<bool(unsigned long nowMs)>; ///< Job body; returns `false` to request a retry.
+
+    /**
+     * @brief Sentinel returned by `msUntilNext()` when no job is scheduled.
+     */
+    static const unsigned long NO_DEADLINE = 0xFFFFFFFFUL;
+
+    /**
+     * @struct JobInfo
+     * @brief Read-only view of a job for reporting.
+     */
+    struct JobInfo {
+        const char* name;          ///< Name given at registration.
+        unsigned long intervalMs;  ///< Period (0 for one-shot jobs).
+        unsigned long retryDelayMs;///< Current retry delay, 0 if the last run succeeded.
+        unsigned long dueMs;       ///< `millis()` at which the job is next due.
+        uint32_t runs;             ///< Number of times the job ran.
+        uint32_t failures;         ///< Number of runs that returned `false`.
+    };
+
+    JobScheduler();
+
+    /**
+     * @brief Registers a periodic job.
+     * @param name Static name used in reports.
+     * @param intervalMs Period between successful runs (minimum 1 ms).
+     * @param firstDelayMs Delay from `nowMs` to the first run.
+     * @param fn Job body.
+     * @param nowMs Current `millis()`.
+     * @param retryMinMs First retry delay after a failure; 0 disables retry backoff.
+     * @param retryMaxMs Upper bound for the doubling retry delay.
+     * @return Job id (>= 0), or -1 if the scheduler is full.
+     */
+    int8_t addPeriodic(const char* name, unsigned long intervalMs, unsigned long firstDelayMs, JobFn fn,
+                       unsigned long nowMs, unsigned long retryMinMs = 0, unsigned long retryMaxMs = 0);
+
+    /**
+     * @brief Registers a job that runs once after `delayMs` (and again on failure if retries are set).
+     * @param name Static name used in reports.
+     * @param delayMs Delay from `nowMs` to the run.
+     * @param fn Job body.
+     * @param nowMs Current `millis()`.
+     * @param retryMinMs First retry delay after a failure; 0 drops the job after any run.
+     * @param retryMaxMs Upper bound for the doubling retry delay.
+     * @return Job id (>= 0), or -1 if the scheduler is full.
+     */
+    int8_t addOneShot(const char* name, unsigned long delayMs, JobFn fn, unsigned long nowMs,
+                      unsigned long retryMinMs = 0, unsigned long retryMaxMs = 0);
+
+    /**
+     * @brief Moves a job's next run to `nowMs` (e.g. after a reconnect). Its retry delay is kept.
+     * @param id Job id.
+     * @param nowMs Current `millis()`.
+     */
+    void runSoon(int8_t id, unsigned long nowMs);
+
+    /**
+     * @brief Removes a job.
+     * @param id Job id.
+     */
+    void cancel(int8_t id);
+
+    /**
+     * @brief Runs every job that is due, each at most once, and reschedules it.
+     * @param nowMs Current `millis()`.
+     * @return Number of jobs run.
+     */
+    uint8_t runDue(unsigned long nowMs);
+
+    /**
+     * @brief Gets the time until the earliest job is due.
+     * @param nowMs Current `millis()`.
+     * @return Milliseconds until the next deadline, 0 if a job is overdue, or `NO_DEADLINE`.
+     */
+    unsigned long msUntilNext(unsigned long nowMs) const;
+
+    /**
+     * @brief Counts a wakeup of the caller (for power diagnostics).
+     */
+    void noteWakeup() { _wakeups++; }
+
+    /**
+     * @brief Gets the number of wakeups counted with `noteWakeup()`.
+     * @return Wakeups since boot.
+     */
+    uint32_t getWakeups() const { return _wakeups; }
+
+    /**
+     * @brief Gets a job's current state.
+     * @param id Job id.
+     * @param info Receives the job's state.
+     * @return `false` if `id` is not an active job.
+     */
+    bool getJobInfo(int8_t id, JobInfo& info) const;
+
+    /**
+     * @brief Prints one line per job plus the wakeup count.
+     * @param out Destination, e.g. `Serial`.
+     * @param nowMs Current `millis()`.
+     */
+    void printReport(Print& out, unsigned long nowMs) const;
+
+private:
+    /**
+     * @struct Job
+     * @brief One scheduler slot.
+     */
+    struct Job {
+        const char* name;           ///< Report name.
+        JobFn fn;                   ///< Job body.
+        unsigned long intervalMs;   ///< Period, or 0 for one-shot jobs.
+        unsigned long retryMinMs;   ///< First retry delay; 0 disables retries.
+        unsigned long retryMaxMs;   ///< Retry delay cap.
+        unsigned long retryDelayMs; ///< Current retry delay; 0 after a success.
+        unsigned long dueMs;        ///< Next due time.
+        uint32_t runs;              ///< Runs so far.
+        uint32_t failures;          ///< Failed runs so far.
+        int8_t heapPos;             ///< Position in `_heap`, or -1 if not scheduled.
+        bool active;                ///< Slot is in use.
+    };
+
+    int8_t add(const char* name, unsigned long intervalMs, unsigned long delayMs, JobFn fn,
+               unsigned long nowMs, unsigned long retryMinMs, unsigned long retryMaxMs);
+    bool earlier(uint8_t a, uint8_t b) const;
+    void swapHeap(uint8_t i, uint8_t j);
+    void siftUp(uint8_t pos);
+    void siftDown(uint8_t pos);
+    void heapInsert(uint8_t job);
+    void heapRemove(uint8_t job);
+
+    Job _jobs[JOB_SCHEDULER_MAX_JOBS];     ///< Job slots, indexed by id.
+    uint8_t _heap[JOB_SCHEDULER_MAX_JOBS]; ///< Job ids ordered as a binary min-heap on `dueMs`.
+    uint8_t _heapSize;                     ///< Number of scheduled jobs.
+    uint32_t _wakeups;                     ///< Caller wakeups, see `noteWakeup()`.
+};
+
+#endif // JOB_SCHEDULER_H
@@ -1,80 +1,197 @@
 #include "LCDDisplay.h"
 #include <stdio.h> // For snprintf
-#include <string.h> // For strncpy
+#include <string.h> // For memset, memcpy
 
-LCDDisplay::LCDDisplay() : _lcd_i2c(LCD_ADDR, 20, 4) {
-    // Constructor body (if any needed besides initializer list)
+LCDDisplay::LCDDisplay()
+    : _lcd_i2c(LCD_ADDR, LCD_COLS, LCD_ROWS),
+      _dirty(false),
+      _cursorCol(0),
+      _cursorRow(0),
+      _panelAddress(-1),
+      _lock(portMUX_INITIALIZER_UNLOCKED) {
+    memset(_frame, ' ', sizeof(_frame));
+    memset(_panel, ' ', sizeof(_panel));
 }
 
 void LCDDisplay::begin() {
-    _lcd_i2c.init();
+    _lcd_i2c.init(); // Clears the panel and homes its cursor.
     _lcd_i2c.backlight();
-    _lcd_i2c.setCursor(0, 0);
-    _lcd_i2c.print(F("Relay Ctrl Loading.."));
+    memset(_panel, ' ', sizeof(_panel));
+    _panelAddress = 0;
+    message(0, 0, "Relay Ctrl Loading..");
+    flushAll();
 }
 
 void LCDDisplay::update(const char* dt, float temp, float hum, float light, bool r1, bool r2, bool r3, bool r4,
                         float tMin, float tMax, float humMin, float humMax, float lightMin, float lightMax,
                         bool netConnected, bool isDataStale, bool sdCardOkLocal, bool isInFailSafe) {
-    char buf[21]; // Buffer for LCD line (20 chars + null)
-    _lcd_i2c.clear();
+    char lines[LCD_ROWS][LCD_COLS + 1]; // Formatted outside the lock; snprintf truncates each to the row width.
 
     // Line 0: Status (Time, SD, Network)
     if (isInFailSafe) {
-        snprintf(buf, sizeof(buf), "** FAILSAFE ** %-8s", dt + 11); // Show last 8 chars of datetime
+        snprintf(lines[0], sizeof(lines[0]), "** FAILSAFE ** %-8s", dt + 11); // Show last 8 chars of datetime
     } else {
         const char* sdStatus = sdCardOkLocal ? "OK" : "!!";
         const char* netStatus = netConnected ? (isDataStale ? "STL" : "OFF") : "OFF";
         // Assuming dt is "YYYY-MM-DD HH:MM:SS", dt + 11 gives "HH:MM:SS"
-        snprintf(buf, sizeof(buf), "%-8s SD:%-2s NW:%-3s", dt + 11, sdStatus, netStatus);
+        snprintf(lines[0], sizeof(lines[0]), "%-8s SD:%-2s NW:%-3s", dt + 11, sdStatus, netStatus);
     }
-    _lcd_i2c.setCursor(0, 0); 
-    _lcd_i2c.print(buf);
 
     // Line 1: Sensor Data (Temp, Humidity, Light)
-    snprintf(buf, sizeof(buf), "T:%.1fC H:%.0f%% L:%.0f", temp, hum, light);
-    _lcd_i2c.setCursor(0, 1); 
-    _lcd_i2c.print(buf);
+    snprintf(lines[1], sizeof(lines[1]), "T:%.1fC H:%.0f%% L:%.0f", temp, hum, light);
 
     // Line 2: Relay Status
-    snprintf(buf, sizeof(buf), "Exh:%c Deh:%c Blw:%c R4:%c",
+    snprintf(lines[2], sizeof(lines[2]), "Exh:%c Deh:%c Blw:%c R4:%c",
              r1 ? 'Y' : 'N', r2 ? 'Y' : 'N', r3 ? 'Y' : 'N', r4 ? 'N' : 'N'); // Assuming R4 is always N
-    _lcd_i2c.setCursor(0, 2); 
-    _lcd_i2c.print(buf);
 
     // Line 3: Thresholds (Temp, Humidity)
     // Displaying general T and H thresholds. Blower uses T, Exhaust/Dehumidifier use H.
-    char tempThresholdBuf[40]; // Larger buffer for intermediate formatting
-    snprintf(tempThresholdBuf, sizeof(tempThresholdBuf), "T:%.0f-%.0f H:%.0f-%.0f", tMin, tMax, humMin, humMax);
-    strncpy(buf, tempThresholdBuf, sizeof(buf) - 1); // Copy to LCD line buffer
-    buf[sizeof(buf) - 1] = '\0'; // Ensure null termination
-    _lcd_i2c.setCursor(0, 3); 
-    _lcd_i2c.print(buf);
+    snprintf(lines[3], sizeof(lines[3]), "T:%.0f-%.0f H:%.0f-%.0f", tMin, tMax, humMin, humMax);
+
+    portENTER_CRITICAL(&_lock);
+    for (int row = 0; row < LCD_ROWS; ++row) putText(0, row, lines[row], true);
+    portEXIT_CRITICAL(&_lock);
+    flush();
 }
 
 void LCDDisplay::message(int col, int row, const char* msg, bool clearLine) {
-    if (clearLine) {
-        _lcd_i2c.setCursor(0, row); 
-        _lcd_i2c.print(F("                    ")); // 20 spaces
+    if (row < 0 || row >= LCD_ROWS || col < 0 || col >= LCD_COLS) return;
+    portENTER_CRITICAL(&_lock);
+    if (clearLine) memset(_frame[row], ' ', col); // The rest of the row is blanked by the padding below.
+    putText(col, row, msg, true);
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LCDDisplay::clear() {
+    portENTER_CRITICAL(&_lock);
+    memset(_frame, ' ', sizeof(_frame));
+    _cursorCol = 0;
+    _cursorRow = 0;
+    _dirty = true;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LCDDisplay::setCursor(int col, int row) {
+    portENTER_CRITICAL(&_lock);
+    _cursorCol = col;
+    _cursorRow = row;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void LCDDisplay::print(const char* msg) {
+    portENTER_CRITICAL(&_lock);
+    if (_cursorRow >= 0 && _cursorRow < LCD_ROWS && _cursorCol >= 0 && _cursorCol < LCD_COLS) {
+        size_t len = strnlen(msg, LCD_COLS - _cursorCol);
+        putText(_cursorCol, _cursorRow, msg, false);
+        _cursorCol += len;
     }
-    _lcd_i2c.setCursor(col, row);
-    char buf[21];
-    snprintf(buf, sizeof(buf), "%-20s", msg); // Pad with spaces to 20 chars
-    _lcd_i2c.print(buf);
+    portEXIT_CRITICAL(&_lock);
 }
 
-void LCDDisplay::clear() { 
-    _lcd_i2c.clear(); 
+void LCDDisplay::print(const __FlashStringHelper* msg) {
+    print(reinterpret_cast<const char*>(msg)); // Flash is memory-mapped on the ESP32.
 }
 
-void LCDDisplay::setCursor(int col, int row) { 
-    _lcd_i2c.setCursor(col, row); 
+/**
+ * @brief Gets the DDRAM address the controller's cursor moves to after a write at `addr`. In two-line mode the
+ * first line ends at 0x27 and continues at 0x40; the second ends at 0x67 and continues at 0x00.
+ */
+static int16_t nextDdramAddress(int16_t addr) {
+    return addr == 0x27 ? 0x40 : (addr == 0x67 ? 0x00 : addr + 1);
+}
+
+/**
+ * @brief Sends frame buffer changes to the panel within a bus-time budget.
+ * Refer to LCDDisplay.h for detailed documentation.
+ */
+bool LCDDisplay::flush(uint32_t budgetUs) {
+    char frame[LCD_ROWS][LCD_COLS];
+    portENTER_CRITICAL(&_lock);
+    if (!_dirty) {
+        portEXIT_CRITICAL(&_lock);
+        return true;
+    }
+    memcpy(frame, _frame, sizeof(frame));
+    _dirty = false; // Drawing from now on sets it again.
+    portEXIT_CRITICAL(&_lock);
+
+    // Cells are visited in DDRAM address order (rows 0, 2, 1, 3 on a 20x4 panel), where the controller's cursor
+    // auto-increment carries a write from the end of one row to the start of the next without a setCursor.
+    static const uint8_t kRowOrder[LCD_ROWS] = {0, 2, 1, 3};
+
+    // Cost both ways in writes: patch the changed cells, or clear and redraw the cells that are not blank.
+    uint32_t patchWrites = 0, redrawWrites = 0;
+    int16_t patchAddr = _panelAddress, redrawAddr = 0;
+    for (uint8_t i = 0; i < LCD_ROWS; ++i) {
+        uint8_t row = kRowOrder[i];
+        for (uint8_t col = 0; col < LCD_COLS; ++col) {
+            int16_t addr = ddramAddress(col, row);
+            if (frame[row][col] != _panel[row][col]) {
+                patchWrites += (addr == patchAddr) ? 1 : 2;
+                patchAddr = nextDdramAddress(addr);
+            }
+            if (frame[row][col] != ' ') {
+                redrawWrites += (addr == redrawAddr) ? 1 : 2;
+                redrawAddr = nextDdramAddress(addr);
+            }
+        }
+    }
+    if (patchWrites == 0) return true; // Drawn back to what the panel already shows.
+
+    uint32_t usedUs = 0;
+    if ((uint64_t)redrawWrites * LCD_WRITE_COST_US + LCD_CLEAR_COST_US < (uint64_t)patchWrites * LCD_WRITE_COST_US) {
+        _lcd_i2c.clear();
+        memset(_panel, ' ', sizeof(_panel));
+        _panelAddress = 0;
+        usedUs += LCD_CLEAR_COST_US;
+        _stats.clears++;
+        _stats.i2cBytes += LCD_I2C_BYTES_PER_WRITE;
+    }
+
+    bool done = true;
+    for (uint8_t i = 0; i < LCD_ROWS && done; ++i) {
+        uint8_t row = kRowOrder[i];
+        for (uint8_t col = 0; col < LCD_COLS; ++col) {
+            if (frame[row][col] == _panel[row][col]) continue;
+            int16_t addr = ddramAddress(col, row);
+            uint32_t writes = (addr == _panelAddress) ? 1 : 2;
+            if (usedUs > 0 && usedUs + writes * LCD_WRITE_COST_US > budgetUs) {
+                done = false; // Budget spent; the next flush() carries on from here.
+                break;
+            }
+            if (writes == 2) {
+                _lcd_i2c.setCursor(col, row);
+                _stats.cursorMoves++;
+            }
+            _lcd_i2c.write((uint8_t)frame[row][col]);
+            _panel[row][col] = frame[row][col];
+            _panelAddress = nextDdramAddress(addr);
+            usedUs += writes * LCD_WRITE_COST_US;
+            _stats.cellsWritten++;
+            _stats.i2cBytes += writes * LCD_I2C_BYTES_PER_WRITE;
+        }
+    }
+
+    _stats.flushes++;
+    _stats.lastBusUs = usedUs;
+    if (!done) {
+        _stats.deferred++;
+        portENTER_CRITICAL(&_lock);
+        _dirty = true;
+        portEXIT_CRITICAL(&_lock);
+    }
+    return done;
 }
 
-void LCDDisplay::print(const char* msg) { 
-    _lcd_i2c.print(msg); 
+void LCDDisplay::putText(int col, int row, const char* text, bool pad) {
+    char* cell = &_frame[row][col];
+    char* end = &_frame[row][LCD_COLS];
+    while (cell < end && *text) *cell++ = *text++;
+    if (pad) while (cell < end) *cell++ = ' ';
+    _dirty = true;
 }
 
-void LCDDisplay::print(const __FlashStringHelper* msg) { 
-    _lcd_i2c.print(msg); 
-}
\ No newline at end of file
+uint8_t LCDDisplay::ddramAddress(uint8_t col, uint8_t row) {
+    static const uint8_t kRowOffsets[LCD_ROWS] = {0x00, 0x40, 0x14, 0x54};
+    return kRowOffsets[row] + col;
+}
@@ -3,7 +3,7 @@
 
 #include <Arduino.h>
 #include <LiquidCrystal_I2C.h>
-#include "config.h" // For LCD_ADDR
+#include "config.h" // For LCD_ADDR, LCD_COLS, LCD_ROWS and the flush budget
 
 /**
  * @brief Manages operations for an I2C LCD 20x4 display.
@@ -13,6 +13,13 @@
  * and system status, displaying custom messages, and controlling basic LCD functions
  * like clearing the screen or setting the cursor position. It relies on constants
  * defined in `config.h` for LCD address, dimensions, and initial messages.
+ *
+ * Drawing calls (`update()`, `message()`, `clear()`, `print()`) only write a RAM frame buffer. `flush()` compares it
+ * with a copy of what the panel shows and sends just the changed cells, walking them in DDRAM address order so the
+ * controller's cursor auto-increment replaces most `setCursor` commands (a 20x4 panel continues row 0 on row 2, row
+ * 2 on row 1 and row 1 on row 3). Each call stops at `LCD_FLUSH_BUDGET_US` of estimated bus time and the next call
+ * continues, so a full repaint never stalls the control loop. A hardware clear is used instead of blanking cells
+ * when it is cheaper. Drawing is safe from any task; `flush()` runs on the control loop task only.
  */
 class LCDDisplay {
 public:
@@ -25,16 +32,15 @@ public:
 
     /**
      * @brief Initializes the LCD.
-     * Calls `_lcd_i2c.init()` and `_lcd_i2c.backlight()`.
-     * Then, it clears the screen and prints an initial loading message, typically
-     * defined by `LCD_INITIAL_MESSAGE_LINE1` and `LCD_INITIAL_MESSAGE_LINE2` from `config.h`.
+     * Calls `_lcd_i2c.init()` (which clears the panel) and `_lcd_i2c.backlight()`, then draws and flushes the
+     * loading message.
      */
     void begin();
 
     /**
      * @brief Updates the entire LCD screen with formatted current data and status indicators.
-     * This method typically clears the screen and then lays out various pieces of information
-     * across the 4 lines of the 20-column display.
+     * Lays out the information across the 4 lines of the frame buffer, then calls `flush()`; only the
+     * characters that changed since the last update (typically the clock seconds and a sensor digit) are sent.
      *
      * @param dt Current date and time string, expected in "YYYY-MM-DD HH:MM:SS" format.
      * @param temp Current temperature value (e.g., in Celsius).
@@ -61,7 +67,8 @@ public:
 
     /**
      * @brief Displays a message at a specific column and row on the LCD.
-     * The message will be truncated if it exceeds the display width from the starting column.
+     * Writes the frame buffer only; the panel follows on the next `flush()`. The rest of the row after the
+     * message is blanked, and the message is truncated at the end of the row.
      *
      * @param col Column to start displaying the message (0-indexed, typically 0-19 for a 20x4 LCD).
      * @param row Row to display the message (0-indexed, typically 0-3 for a 20x4 LCD).
@@ -73,38 +80,95 @@ public:
     void message(int col, int row, const char* msg, bool clearLine = false);
 
     /**
-     * @brief Clears the entire LCD screen and homes the cursor to (0,0).
-     * Calls `_lcd_i2c.clear()`.
+     * @brief Blanks the frame buffer and homes the print position to (0,0).
+     * The next `flush()` issues a hardware clear if that is cheaper than blanking the cells one by one.
      */
     void clear();
 
     /**
-     * @brief Sets the cursor position on the LCD for subsequent print operations.
-     * Calls `_lcd_i2c.setCursor(col, row)`.
+     * @brief Sets the frame buffer position for subsequent `print()` calls.
      * @param col Column position (0-indexed).
      * @param row Row position (0-indexed).
      */
     void setCursor(int col, int row);
 
     /**
-     * @brief Prints a C-style string to the LCD at the current cursor position.
-     * Wraps `_lcd_i2c.print(const char*)`.
+     * @brief Prints a C-style string into the frame buffer at the current print position.
+     * Text past the end of the row is dropped.
      * @param msg The null-terminated C-style string to print.
      */
     void print(const char* msg);
 
     /**
-     * @brief Prints a string from flash memory (using the `F()` macro) to the LCD at the current cursor position.
-     * Wraps `_lcd_i2c.print(const __FlashStringHelper*)`.
+     * @brief Prints a string from flash memory (using the `F()` macro) into the frame buffer at the current print position.
      * @param msg The flash string helper (e.g., `F("Hello")`) to print.
      */
     void print(const __FlashStringHelper* msg);
 
+    /**
+     * @brief Sends frame buffer changes to the panel, stopping once `budgetUs` of estimated bus time is used.
+     * Control loop task only.
+     * @param budgetUs Bus time allowed for this call.
+     * @return `true` if the panel now matches the frame buffer, `false` if changes are left for a later call.
+     */
+    bool flush(uint32_t budgetUs = LCD_FLUSH_BUDGET_US);
+
+    /**
+     * @brief Sends every pending change regardless of the budget. For blocking screens shown before
+     *        the control loop runs or instead of it (setup progress, config portal, restart notices).
+     */
+    void flushAll() { flush(UINT32_MAX); }
+
+    /**
+     * @brief Checks whether drawing calls left changes that have not reached the panel.
+     * @return `true` if a `flush()` has work to do.
+     */
+    bool isDirty() const { return _dirty; }
+
+    /**
+     * @struct Stats
+     * @brief Rendering counters since boot.
+     */
+    struct Stats {
+        uint32_t flushes = 0;        ///< `flush()` calls that found changes.
+        uint32_t deferred = 0;       ///< Of those, calls that hit the budget and left changes pending.
+        uint32_t cellsWritten = 0;   ///< Characters sent.
+        uint32_t cursorMoves = 0;    ///< `setCursor` commands sent.
+        uint32_t clears = 0;         ///< Hardware clears sent.
+        uint32_t i2cBytes = 0;       ///< Estimated I2C bytes on the bus for all of the above.
+        uint32_t lastBusUs = 0;      ///< Estimated bus time of the last `flush()` that found changes.
+    };
+
+    /**
+     * @brief Gets the rendering counters.
+     * @return Reference to the statistics.
+     */
+    const Stats& getStats() const { return _stats; }
+
 private:
+    /**
+     * @brief Writes text into a frame buffer row from `col`, clipped at the end of the row. Caller holds `_lock`.
+     * @param pad If `true`, the rest of the row after the text is blanked.
+     */
+    void putText(int col, int row, const char* text, bool pad);
+
+    /**
+     * @brief Gets the HD44780 DDRAM address of a cell.
+     */
+    static uint8_t ddramAddress(uint8_t col, uint8_t row);
+
     LiquidCrystal_I2C _lcd_i2c; ///< Instance of the `LiquidCrystal_I2C` library.
                                 ///< It is initialized in the `LCDDisplay` constructor with the I2C address
                                 ///< (`LCD_ADDR`), number of columns (`LCD_COLS`), and number of rows (`LCD_ROWS`)
                                 ///< defined in `config.h`.
+    char _frame[LCD_ROWS][LCD_COLS];   ///< What callers drew; guarded by `_lock`.
+    char _panel[LCD_ROWS][LCD_COLS];   ///< What the panel shows, as far as `flush()` has sent it. Loop task only.
+    volatile bool _dirty;              ///< `_frame` may differ from `_panel`.
+    int _cursorCol;                    ///< Frame buffer column of the next `print()`.
+    int _cursorRow;                    ///< Frame buffer row of the next `print()`.
+    int16_t _panelAddress;             ///< DDRAM address of the panel cursor, or -1 if unknown.
+    mutable portMUX_TYPE _lock;        ///< Spinlock for `_frame`, `_dirty` and the print position.
+    Stats _stats;                      ///< Rendering counters.
 };
 
 #endif // LCD_DISPLAY_H
\ No newline at end of file
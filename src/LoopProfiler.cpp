@@ -0,0 +1,146 @@
+#include "LoopProfiler.h"
+
+#if LOOP_PROFILER_ENABLED
+
+LoopProfiler loopProfiler;
+
+/**
+ * @brief Maps a duration to its histogram bucket: floor(log2(us)), clamped to the last bucket.
+ */
+static inline uint8_t bucketFor(uint32_t us) {
+    if (us < 2) return 0;
+    uint8_t b = 31 - __builtin_clz(us);
+    return b < LOOP_PROFILER_BUCKETS ? b : LOOP_PROFILER_BUCKETS - 1;
+}
+
+/**
+ * @brief Constructs an empty profiler.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+LoopProfiler::LoopProfiler() : _cyclesPerUs(240), _sinceMs(0), _wakeups(0) {
+    reset();
+}
+
+/**
+ * @brief Reads the CPU frequency.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+void LoopProfiler::begin() {
+#if LIGHT_SLEEP_ENABLED
+    _cyclesPerUs = 1; // now() already counts microseconds.
+#else
+    uint32_t mhz = getCpuFrequencyMhz();
+    _cyclesPerUs = mhz ? mhz : 240;
+#endif
+    reset();
+}
+
+/**
+ * @brief Records one sample for a stage.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+void LoopProfiler::record(LoopStage stage, uint32_t startCycles) {
+    uint32_t us = (now() - startCycles) / _cyclesPerUs;
+    StageStats& s = _stats[(uint8_t)stage];
+    s.count++;
+    s.totalUs += us;
+    if (us < s.minUs) s.minUs = us;
+    if (us > s.maxUs) s.maxUs = us;
+    uint32_t budget = (stage == LoopStage::LOOP_TOTAL) ? LOOP_PROFILER_LOOP_BUDGET_US : LOOP_PROFILER_STAGE_BUDGET_US;
+    if (us > budget) s.overruns++;
+    s.buckets[bucketFor(us)]++;
+}
+
+/**
+ * @brief Clears all statistics.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+void LoopProfiler::reset() {
+    memset(_stats, 0, sizeof(_stats));
+    for (StageStats& s : _stats) s.minUs = UINT32_MAX;
+    _sinceMs = millis();
+    _wakeups = 0;
+}
+
+/**
+ * @brief Estimates the 99th percentile from the histogram.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+uint32_t LoopProfiler::getP99Us(LoopStage stage) const {
+    const StageStats& s = _stats[(uint8_t)stage];
+    if (s.count == 0) return 0;
+    uint32_t target = s.count - s.count / 100; // Samples at or below p99.
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < LOOP_PROFILER_BUCKETS; ++b) {
+        seen += s.buckets[b];
+        if (seen >= target) {
+            if (b == LOOP_PROFILER_BUCKETS - 1) return s.maxUs; // Open-ended bucket.
+            uint32_t upper = (1UL << (b + 1)) - 1;
+            return upper < s.maxUs ? upper : s.maxUs;
+        }
+    }
+    return s.maxUs;
+}
+
+/**
+ * @brief Prints a one-line-per-stage table.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+void LoopProfiler::printReport(Print& out) const {
+    unsigned long sinceS = (millis() - _sinceMs) / 1000;
+    out.printf("Loop profile over %lu s (us; budget %lu/%lu):\n", sinceS,
+               (unsigned long)LOOP_PROFILER_STAGE_BUDGET_US, (unsigned long)LOOP_PROFILER_LOOP_BUDGET_US);
+    out.printf("Wakeups: %lu (%lu/s), light sleep %s\n", (unsigned long)_wakeups,
+               sinceS ? (unsigned long)(_wakeups / sinceS) : (unsigned long)_wakeups, LIGHT_SLEEP_ENABLED ? "on" : "off");
+    out.printf("%-13s %9s %8s %8s %8s %9s %8s\n", "stage", "count", "min", "mean", "p99", "max", "over");
+    for (uint8_t i = 0; i < (uint8_t)LoopStage::COUNT; ++i) {
+        const StageStats& s = _stats[i];
+        unsigned long mean = s.count ? (unsigned long)(s.totalUs / s.count) : 0;
+        out.printf("%-13s %9lu %8lu %8lu %8lu %9lu %8lu\n", stageName((LoopStage)i), (unsigned long)s.count,
+                   s.count ? (unsigned long)s.minUs : 0UL, mean, (unsigned long)getP99Us((LoopStage)i),
+                   (unsigned long)s.maxUs, (unsigned long)s.overruns);
+    }
+}
+
+/**
+ * @brief Writes all statistics as JSON.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+void LoopProfiler::writeJson(Print& out) const {
+    out.printf("{\"since_s\":%lu,\"wakeups\":%lu,\"light_sleep\":%s,\"stage_budget_us\":%lu,\"loop_budget_us\":%lu,\"stages\":{",
+               (millis() - _sinceMs) / 1000, (unsigned long)_wakeups, LIGHT_SLEEP_ENABLED ? "true" : "false",
+               (unsigned long)LOOP_PROFILER_STAGE_BUDGET_US, (unsigned long)LOOP_PROFILER_LOOP_BUDGET_US);
+    for (uint8_t i = 0; i < (uint8_t)LoopStage::COUNT; ++i) {
+        const StageStats& s = _stats[i];
+        out.printf("%s\"%s\":{\"count\":%lu,\"min\":%lu,\"mean\":%lu,\"p99\":%lu,\"max\":%lu,\"overruns\":%lu,\"hist\":[",
+                   i ? "," : "", stageName((LoopStage)i), (unsigned long)s.count,
+                   s.count ? (unsigned long)s.minUs : 0UL, s.count ? (unsigned long)(s.totalUs / s.count) : 0UL,
+                   (unsigned long)getP99Us((LoopStage)i), (unsigned long)s.maxUs, (unsigned long)s.overruns);
+        for (uint8_t b = 0; b < LOOP_PROFILER_BUCKETS; ++b) {
+            out.printf(b ? ",%lu" : "%lu", (unsigned long)s.buckets[b]);
+        }
+        out.print("]}");
+    }
+    out.print("}}");
+}
+
+/**
+ * @brief Gets the printable name of a stage.
+ * Refer to LoopProfiler.h for detailed documentation.
+ */
+const char* LoopProfiler::stageName(LoopStage stage) {
+    switch (stage) {
+        case LoopStage::POLL_NETWORK: return "poll_network";
+        case LoopStage::API_FETCH:    return "api_fetch";
+        case LoopStage::FAILSAFE:     return "failsafe";
+        case LoopStage::WEB_OVERRIDE: return "web_override";
+        case LoopStage::MAIN_BLOCK:   return "main_block";
+        case LoopStage::SD_CHECK:     return "sd_check";
+        case LoopStage::RTC_SYNC:     return "rtc_sync";
+        case LoopStage::SERIAL_CMDS:  return "serial_cmds";
+        case LoopStage::LOOP_TOTAL:   return "loop_total";
+        default:                      return "?";
+    }
+}
+
+#endif // LOOP_PROFILER_ENABLED
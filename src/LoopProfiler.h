@@ -0,0 +1,161 @@
+/**
+ * @file LoopProfiler.h
+ * @brief Defines `LoopProfiler`, a low-overhead per-stage latency profiler for the control loop.
+ *
+ * Each `loop()` stage is timed with the CPU cycle counter and recorded into a fixed histogram of
+ * power-of-two microsecond buckets, together with count, min, max, total and the number of times the
+ * stage exceeded its budget (`LOOP_PROFILER_STAGE_BUDGET_US`, or `LOOP_PROFILER_LOOP_BUDGET_US` for the
+ * whole pass). p99 is read from the histogram, so it is accurate to one bucket (a factor of two).
+ *
+ * Recording costs two cycle-counter reads, one divide and a few increments; no allocation, no locks.
+ * All recording and reporting happens on the control loop task. With `LIGHT_SLEEP_ENABLED` the CPU clock
+ * changes under power management, so samples are taken from `esp_timer` (microseconds) instead.
+ *
+ * The profiler also counts `loop()` wakeups, to show how often the control loop leaves its sleep.
+ *
+ * The report is available through the `profile` serial command and `GET /profile` on
+ * `LOOP_PROFILER_HTTP_PORT`. With `LOOP_PROFILER_ENABLED` set to 0 the class is not compiled and
+ * `LOOP_PROFILE()` expands to the bare call.
+ */
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include "config.h" // For LOOP_PROFILER_ENABLED and budgets.
+
+#if LOOP_PROFILER_ENABLED
+
+#include <Arduino.h>
+#if LIGHT_SLEEP_ENABLED
+#include <esp_timer.h> // For esp_timer_get_time()
+#endif
+
+/**
+ * @enum LoopStage
+ * @brief Instrumented sections of `loop()`. `LOOP_TOTAL` covers one complete pass.
+ */
+enum class LoopStage : uint8_t {
+    POLL_NETWORK,  ///< `NetworkWorker::pollEvents()` (response callbacks).
+    API_FETCH,     ///< `api_fetch` job (`handleApiDataFetching()`).
+    FAILSAFE,      ///< `checkDataStalenessAndFailsafe()`.
+    WEB_OVERRIDE,  ///< `status_poll` job (`pollWebOverride()`).
+    MAIN_BLOCK,    ///< `control` job (`runMainOperationalBlock()`: relays, LCD, SD log).
+    SD_CHECK,      ///< `sd_retry` job (`checkSdCard()`).
+    RTC_SYNC,      ///< `rtc_sync` job (`checkRtcSync()`).
+    SERIAL_CMDS,   ///< `handleSerialCommands()`.
+    LOOP_TOTAL,    ///< Whole `loop()` pass.
+    COUNT          ///< Number of stages; not a stage.
+};
+
+/**
+ * @class LoopProfiler
+ * @brief Fixed-size latency statistics for each `LoopStage`.
+ */
+class LoopProfiler {
+public:
+    /**
+     * @struct StageStats
+     * @brief Accumulated timings of one stage.
+     */
+    struct StageStats {
+        uint32_t count;                            ///< Samples recorded.
+        uint32_t minUs;                            ///< Shortest sample.
+        uint32_t maxUs;                            ///< Longest sample.
+        uint64_t totalUs;                          ///< Sum of all samples, for the mean.
+        uint32_t overruns;                         ///< Samples above the stage budget.
+        uint32_t buckets[LOOP_PROFILER_BUCKETS];   ///< log2 histogram of samples in microseconds.
+    };
+
+    LoopProfiler();
+
+    /**
+     * @brief Reads the CPU frequency used to convert cycles to microseconds. Call once in `setup()`.
+     */
+    void begin();
+
+    /**
+     * @brief Gets the current cycle counter, to be passed to `record()`.
+     * @return CPU cycle count, or microseconds when `LIGHT_SLEEP_ENABLED` varies the CPU clock.
+     */
+#if LIGHT_SLEEP_ENABLED
+    static inline uint32_t now() { return (uint32_t)esp_timer_get_time(); }
+#else
+    static inline uint32_t now() { return ESP.getCycleCount(); }
+#endif
+
+    /**
+     * @brief Counts one wakeup of the control loop.
+     */
+    void noteWakeup() { _wakeups++; }
+
+    /**
+     * @brief Gets the number of wakeups counted since the last reset.
+     */
+    uint32_t getWakeups() const { return _wakeups; }
+
+    /**
+     * @brief Records one sample for a stage.
+     * @param stage Stage that was timed.
+     * @param startCycles Value of `now()` taken before the stage. Samples must be shorter than
+     *                    2^32 cycles (~17 s at 240 MHz).
+     */
+    void record(LoopStage stage, uint32_t startCycles);
+
+    /**
+     * @brief Clears all statistics.
+     */
+    void reset();
+
+    /**
+     * @brief Gets the accumulated statistics of a stage.
+     * @param stage Stage to query.
+     * @return Reference to the stage's statistics.
+     */
+    const StageStats& getStats(LoopStage stage) const { return _stats[(uint8_t)stage]; }
+
+    /**
+     * @brief Estimates the 99th percentile from the histogram.
+     * @param stage Stage to query.
+     * @return Upper bound in microseconds of the bucket holding the 99th percentile sample (0 if no samples).
+     */
+    uint32_t getP99Us(LoopStage stage) const;
+
+    /**
+     * @brief Prints a one-line-per-stage table.
+     * @param out Destination, e.g. `Serial`.
+     */
+    void printReport(Print& out) const;
+
+    /**
+     * @brief Writes all statistics, including histograms, as a JSON object.
+     * @param out Destination, e.g. a `String` via `StreamString` or a web client.
+     */
+    void writeJson(Print& out) const;
+
+    /**
+     * @brief Gets the printable name of a stage.
+     * @param stage Stage to name.
+     * @return Static string.
+     */
+    static const char* stageName(LoopStage stage);
+
+private:
+    StageStats _stats[(uint8_t)LoopStage::COUNT]; ///< Per-stage statistics.
+    uint32_t _cyclesPerUs;                        ///< CPU cycles per microsecond (1 when `now()` reads `esp_timer`).
+    unsigned long _sinceMs;                       ///< `millis()` at the last reset.
+    uint32_t _wakeups;                            ///< `loop()` wakeups since the last reset.
+};
+
+extern LoopProfiler loopProfiler; ///< Single profiler instance, defined in LoopProfiler.cpp.
+
+/**
+ * @brief Times `call` as `stage`. Expands to the bare call when `LOOP_PROFILER_ENABLED` is 0.
+ */
+#define LOOP_PROFILE(stage, call) do { uint32_t _lpStart = LoopProfiler::now(); call; loopProfiler.record(stage, _lpStart); } while (0)
+
+#else // LOOP_PROFILER_ENABLED
+
+#define LOOP_PROFILE(stage, call) do { call; } while (0)
+
+#endif // LOOP_PROFILER_ENABLED
+
+#endif // LOOP_PROFILER_H
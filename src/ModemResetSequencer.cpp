@@ -0,0 +1,203 @@
+#include "ModemResetSequencer.h"
+
+/**
+ * @brief One pin level of the modem hard reset sequence and how long it is held before the next step.
+ */
+struct ModemPinStep {
+    int pin;              ///< ESP32 pin; steps on a pin configured as -1 are skipped.
+    uint8_t level;        ///< Level to drive.
+    unsigned long holdMs; ///< Time to hold it before the next step.
+};
+
+// Supply off/on, PWRKEY pulse, then RESET pulse. Only used with GPRS_MODEM_HARD_RESET_PINS.
+static const ModemPinStep MODEM_HARD_RESET_SEQUENCE[] = {
+    {MODEM_POWER_ON, LOW, 500},
+    {MODEM_POWER_ON, HIGH, 1000},
+    {GSM_PWR, HIGH, 100},
+    {GSM_PWR, LOW, 1200},   // PWKEY pulse to turn OFF or ON
+    {GSM_PWR, HIGH, 2000},  // Ensure it's high (ON state for some)
+    {GSM_RST, LOW, GPRS_MODEM_RESET_PULSE_MS}, // Assert reset
+    {GSM_RST, HIGH, 3000},  // De-assert and wait
+};
+static const uint8_t MODEM_HARD_RESET_STEPS = sizeof(MODEM_HARD_RESET_SEQUENCE) / sizeof(MODEM_HARD_RESET_SEQUENCE[0]);
+
+/**
+ * @brief Constructs an idle sequencer.
+ * Refer to ModemResetSequencer.h for detailed documentation.
+ */
+ModemResetSequencer::ModemResetSequencer(AtCommandEngine& at)
+    : _at(at),
+      _kind(Kind::SOFT),
+      _simPin(""),
+      _step(Step::START),
+      _pinStep(0),
+      _stepStartMs(0),
+      _stepWaitMs(0),
+      _probeStartMs(0),
+      _cmdQueued(false),
+      _cmdDone(false),
+      _cmdResult(AtResult::TIMEOUT),
+      _modemAnswered(false),
+      _simPinSent(false),
+      _simQueryStartMs(0) {
+    _cmdInfo[0] = '\0';
+}
+
+/**
+ * @brief Starts a reset.
+ * Refer to ModemResetSequencer.h for detailed documentation.
+ */
+void ModemResetSequencer::begin(Kind kind, const char* simPin, unsigned long nowMs) {
+    _kind = kind;
+    _simPin = simPin ? simPin : "";
+    _modemAnswered = false;
+    _simPinSent = false;
+    enterStep(Step::START, 0, nowMs);
+}
+
+void ModemResetSequencer::enterStep(Step step, unsigned long waitMs, unsigned long nowMs) {
+    _step = step;
+    _stepStartMs = nowMs;
+    _stepWaitMs = waitMs;
+    _cmdQueued = false;
+}
+
+bool ModemResetSequencer::awaitCommand(const char* command, const char* infoPrefix, unsigned long timeoutMs) {
+    if (!_cmdQueued) {
+        _cmdQueued = true;
+        _cmdDone = false;
+        _cmdResult = AtResult::TIMEOUT;
+        _cmdInfo[0] = '\0';
+        // The owner clears `_at` before each reset, so this handler cannot outlive the reset it belongs to.
+        if (!_at.submit(command, infoPrefix, timeoutMs, [this](AtResult result, const char* info) {
+                _cmdResult = result;
+                strlcpy(_cmdInfo, info, sizeof(_cmdInfo));
+                _cmdDone = true;
+            })) {
+            _cmdDone = true; // Queue full: handled like a timeout.
+        }
+    }
+    return _cmdDone;
+}
+
+/**
+ * @brief Runs the current sub-step once its wait has passed.
+ * Refer to ModemResetSequencer.h for detailed documentation.
+ */
+ModemResetSequencer::Outcome ModemResetSequencer::update(unsigned long nowMs) {
+    if (nowMs - _stepStartMs < _stepWaitMs) return Outcome::RUNNING; // Current sub-step still running.
+
+    switch (_step) {
+        case Step::START:
+            if (_kind == Kind::SOFT) {
+                DEBUG_PRINTLN(2, "GPRS FSM: Attempting modem soft reset (AT+CFUN=1,1)...");
+                enterStep(Step::RESTART, 0, nowMs);
+            } else if (_kind == Kind::WAIT_AND_RESTART) {
+                DEBUG_PRINTLN(2, "GPRS FSM: Attempting modem hard reset (wait, then AT+CFUN=1,1)...");
+                enterStep(Step::RESTART, GPRS_MODEM_POWER_CYCLE_DELAY_MS, nowMs);
+            } else {
+                DEBUG_PRINTLN(2, "GPRS FSM: Attempting modem hard reset (power cycle/reset pin)...");
+                _pinStep = 0;
+                enterStep(Step::PIN_SEQUENCE, 0, nowMs);
+            }
+            return Outcome::RUNNING;
+
+        case Step::PIN_SEQUENCE:
+            while (_pinStep < MODEM_HARD_RESET_STEPS && MODEM_HARD_RESET_SEQUENCE[_pinStep].pin < 0) _pinStep++;
+            if (_pinStep < MODEM_HARD_RESET_STEPS) {
+                const ModemPinStep& step = MODEM_HARD_RESET_SEQUENCE[_pinStep++];
+                pinMode(step.pin, OUTPUT);
+                digitalWrite(step.pin, step.level);
+                enterStep(Step::PIN_SEQUENCE, step.holdMs, nowMs);
+            } else {
+                enterStep(Step::BOOT_WAIT, GPRS_MODEM_POWER_CYCLE_DELAY_MS, nowMs); // Generous delay for modem to boot
+            }
+            return Outcome::RUNNING;
+
+        case Step::RESTART:
+            if (!awaitCommand("", nullptr, GPRS_MODEM_PROBE_TIMEOUT_MS)) return Outcome::RUNNING;
+            if (_cmdResult == AtResult::OK) {
+                _at.submit("+CFUN=1,1", nullptr, AT_DEFAULT_TIMEOUT_MS, nullptr); // The reply may be lost in the reboot.
+                enterStep(Step::BOOT_WAIT, GPRS_MODEM_SOFT_RESET_BOOT_MS, nowMs);
+            } else if (_kind == Kind::SOFT) {
+                DEBUG_PRINTLN(1, "GPRS FSM: Modem soft reset command failed.");
+                return Outcome::FAILED;
+            } else {
+                DEBUG_PRINTLN(1, "GPRS FSM: Modem did not respond before restart. Probing...");
+                enterStep(Step::BOOT_WAIT, 0, nowMs);
+            }
+            return Outcome::RUNNING;
+
+        case Step::BOOT_WAIT:
+            _probeStartMs = nowMs;
+            enterStep(Step::PROBE, 0, nowMs);
+            return Outcome::RUNNING;
+
+        case Step::PROBE:
+            if (!awaitCommand("", nullptr, GPRS_MODEM_PROBE_TIMEOUT_MS)) return Outcome::RUNNING;
+            if (_cmdResult != AtResult::OK) {
+                if (nowMs - _probeStartMs >= GPRS_MODEM_RESPONSE_TIMEOUT_MS) {
+                    DEBUG_PRINTLN(1, "GPRS FSM: Modem reset failed (modem unresponsive).");
+                    return Outcome::FAILED;
+                }
+                enterStep(Step::PROBE, GPRS_MODEM_PROBE_INTERVAL_MS, nowMs);
+                return Outcome::RUNNING;
+            }
+            DEBUG_PRINTLN(3, "GPRS FSM: Modem reset successful.");
+            _modemAnswered = true;
+            // Echo off and error format, as TinyGSM's init() does, but without its blocking SIM query.
+            _at.submit("E0", nullptr, AT_DEFAULT_TIMEOUT_MS, nullptr);
+            _at.submit("+CMEE=0", nullptr, AT_DEFAULT_TIMEOUT_MS, nullptr);
+            _at.submit("I", "", AT_DEFAULT_TIMEOUT_MS, [](AtResult result, const char* info) {
+                if (result == AtResult::OK) DEBUG_PRINTF(3, "GPRS FSM: Modem Info: %s\n", info);
+            });
+            _simPinSent = false;
+            _simQueryStartMs = nowMs;
+            enterStep(Step::SIM_QUERY, 0, nowMs);
+            return Outcome::RUNNING;
+
+        case Step::SIM_QUERY:
+            if (!awaitCommand("+CPIN?", "+CPIN:", AT_DEFAULT_TIMEOUT_MS)) return Outcome::RUNNING;
+            if (strcmp(_cmdInfo, "+CPIN: READY") == 0) {
+                DEBUG_PRINTLN(3, "GPRS FSM: SIM OK.");
+                DEBUG_PRINTLN(3, "GPRS FSM: Attempting to enable SSL (AT+CIPSSL=1)...");
+                enterStep(Step::SSL_ENABLE, 0, nowMs);
+            } else if (strcmp(_cmdInfo, "+CPIN: SIM PIN") == 0 && _simPin[0] != '\0' && !_simPinSent) {
+                DEBUG_PRINTLN(3, "GPRS FSM: Unlocking SIM...");
+                _simPinSent = true;
+                enterStep(Step::SIM_UNLOCK, 0, nowMs);
+            } else if (_cmdInfo[0] == '\0' && nowMs - _simQueryStartMs < GPRS_MODEM_RESPONSE_TIMEOUT_MS) {
+                // No status yet (SIM still busy after boot): ask again, as TinyGSM's getSimStatus() does.
+                enterStep(Step::SIM_QUERY, GPRS_MODEM_PROBE_INTERVAL_MS, nowMs);
+            } else {
+                DEBUG_PRINTF(1, "GPRS FSM: SIM not ready (%s). Retrying modem reset.\n",
+                             _cmdInfo[0] != '\0' ? _cmdInfo : "no reply");
+                return Outcome::FAILED;
+            }
+            return Outcome::RUNNING;
+
+        case Step::SIM_UNLOCK: {
+            char command[AT_COMMAND_MAX_LEN];
+            snprintf(command, sizeof(command), "+CPIN=\"%s\"", _simPin);
+            if (!awaitCommand(command, nullptr, AT_DEFAULT_TIMEOUT_MS)) return Outcome::RUNNING;
+            if (_cmdResult != AtResult::OK) {
+                DEBUG_PRINTLN(1, "GPRS FSM: SIM Unlock Failed.");
+                return Outcome::SIM_UNLOCK_FAILED;
+            }
+            _simQueryStartMs = nowMs;
+            enterStep(Step::SIM_QUERY, GPRS_SIM_UNLOCK_SETTLE_MS, nowMs); // Wait for unlock
+            return Outcome::RUNNING;
+        }
+
+        case Step::SSL_ENABLE:
+            if (!awaitCommand("+CIPSSL=1", nullptr, GPRS_MODEM_RESPONSE_TIMEOUT_MS)) return Outcome::RUNNING;
+            if (_cmdResult != AtResult::OK) {
+                DEBUG_PRINTLN(1, "GPRS FSM: Failed to enable SSL (AT+CIPSSL=1). HTTPS might fail.");
+                // For now, log and continue. Some firmwares/modems might have it enabled by default.
+            } else {
+                DEBUG_PRINTLN(3, "GPRS FSM: SSL enabled successfully (AT+CIPSSL=1).");
+            }
+            return Outcome::READY;
+    }
+    return Outcome::RUNNING;
+}
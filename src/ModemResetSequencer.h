@@ -0,0 +1,137 @@
+/**
+ * @file ModemResetSequencer.h
+ * @brief Defines `ModemResetSequencer`, the timed sub-steps `GPRSManager` runs in `GPRS_STATE_INIT_RESET_MODEM`.
+ *
+ * A modem reset is a chain of waits: pin pulses, the boot time, `AT` probes once a second, the SIM settling
+ * after its PIN. Each sub-step records when it started and how long it waits, and `update()` returns at once
+ * until that time has passed, so `GPRSManager::updateFSM()` never sleeps. Every AT command goes through the
+ * `AtCommandEngine` queue and is awaited across calls, including the probes.
+ *
+ * There are three kinds of reset:
+ * - `SOFT`: `AT+CFUN=1,1`, used first.
+ * - `WAIT_AND_RESTART`: wait `GPRS_MODEM_POWER_CYCLE_DELAY_MS`, then the same `AT+CFUN=1,1`, continuing to
+ *   probe even if the modem did not answer before it. This is what a "hard" reset effectively did before
+ *   the reset was sequenced: its pin pulses sat behind `#if defined(...)` on `const int` pins and were
+ *   never compiled.
+ * - `PIN_SEQUENCE`: drives `MODEM_POWER_ON`, `GSM_PWR` (PWRKEY) and `GSM_RST` as listed in the .cpp. Used for
+ *   later resets only when `GPRS_MODEM_HARD_RESET_PINS` is set, until the pulses are verified on the board.
+ *
+ * Only needs `AtCommandEngine` and the GPIO calls, so it is driven by a scripted modem on the host
+ * (test/test_modem_reset_sequencer).
+ */
+#ifndef MODEM_RESET_SEQUENCER_H
+#define MODEM_RESET_SEQUENCER_H
+
+#include <Arduino.h>
+#include "config.h"          // For the GPRS_MODEM_* timings and modem pins.
+#include "AtCommandEngine.h" // For AtCommandEngine, AtResult.
+
+/**
+ * @class ModemResetSequencer
+ * @brief Runs one modem reset, from the reset itself to a ready SIM with SSL enabled, without blocking.
+ */
+class ModemResetSequencer {
+public:
+    /**
+     * @enum Kind
+     * @brief How the modem is reset; see the file comment.
+     */
+    enum class Kind : uint8_t {
+        SOFT,             ///< `AT+CFUN=1,1`; fails at once if the modem does not answer `AT` first.
+        WAIT_AND_RESTART, ///< `GPRS_MODEM_POWER_CYCLE_DELAY_MS`, then `AT+CFUN=1,1` if the modem answers.
+        PIN_SEQUENCE      ///< Supply, PWRKEY and RESET pulses, then `GPRS_MODEM_POWER_CYCLE_DELAY_MS`.
+    };
+
+    /**
+     * @enum Step
+     * @brief Timed sub-steps. Each waits out its time across `update()` calls.
+     */
+    enum class Step : uint8_t {
+        START,         ///< Picks the first step of the reset kind.
+        PIN_SEQUENCE,  ///< Drives the next entry of the pin sequence and holds it.
+        RESTART,       ///< `AT`, then `AT+CFUN=1,1` if it answered.
+        BOOT_WAIT,     ///< Modem rebooting (`GPRS_MODEM_SOFT_RESET_BOOT_MS` or `GPRS_MODEM_POWER_CYCLE_DELAY_MS`).
+        PROBE,         ///< `AT` every `GPRS_MODEM_PROBE_INTERVAL_MS` until it answers or `GPRS_MODEM_RESPONSE_TIMEOUT_MS`.
+        SIM_QUERY,     ///< `AT+CPIN?`; repeated while the SIM gives no status, up to `GPRS_MODEM_RESPONSE_TIMEOUT_MS`.
+        SIM_UNLOCK,    ///< `AT+CPIN="<pin>"`; on success, `SIM_QUERY` again after `GPRS_SIM_UNLOCK_SETTLE_MS`.
+        SSL_ENABLE     ///< `AT+CIPSSL=1`; a failure is logged only, as before.
+    };
+
+    /**
+     * @enum Outcome
+     * @brief What `update()` reports.
+     */
+    enum class Outcome : uint8_t {
+        RUNNING,          ///< Still in progress; call again.
+        READY,            ///< Modem answers, SIM ready, SSL requested.
+        FAILED,           ///< Modem unresponsive or SIM not ready; counts as a failed reset.
+        SIM_UNLOCK_FAILED ///< The SIM rejected the PIN.
+    };
+
+    /**
+     * @brief Constructs an idle sequencer.
+     * @param at Command engine over the modem UART; the caller keeps calling its `poll()`.
+     */
+    explicit ModemResetSequencer(AtCommandEngine& at);
+
+    /**
+     * @brief Starts a reset at `Step::START`.
+     * The caller should `clear()` the engine first, since replies to commands queued before the reset never come.
+     * @param kind How to reset the modem.
+     * @param simPin SIM PIN, or "" if the SIM is not locked; must stay valid until the reset ends.
+     * @param nowMs Current `millis()`.
+     */
+    void begin(Kind kind, const char* simPin, unsigned long nowMs);
+
+    /**
+     * @brief Runs the current sub-step if its wait has passed.
+     * Never blocks: a waiting call costs one comparison; any other call queues at most a few AT commands.
+     * @param nowMs Current `millis()`.
+     * @return Whether the reset is still running, and how it ended otherwise.
+     */
+    Outcome update(unsigned long nowMs);
+
+    /**
+     * @brief The current sub-step.
+     */
+    Step step() const { return _step; }
+
+    /**
+     * @brief Checks whether the modem answered `AT` after the reset (even if the SIM then failed).
+     */
+    bool modemAnswered() const { return _modemAnswered; }
+
+private:
+    /**
+     * @brief Enters a sub-step that `update()` runs once `waitMs` has passed.
+     */
+    void enterStep(Step step, unsigned long waitMs, unsigned long nowMs);
+
+    /**
+     * @brief Runs the current sub-step's AT command: queues it on the first call, then reports whether its
+     *        reply (or timeout) has arrived, in `_cmdResult`/`_cmdInfo`.
+     * @param command Command after "AT" ("" for a bare `AT`).
+     * @param infoPrefix Info line to capture (see `AtCommandEngine::submit()`), or `nullptr`.
+     * @param timeoutMs Command timeout.
+     * @return `true` once the command has completed.
+     */
+    bool awaitCommand(const char* command, const char* infoPrefix, unsigned long timeoutMs);
+
+    AtCommandEngine& _at;        ///< Modem command queue.
+    Kind _kind;                  ///< Kind of the reset in progress.
+    const char* _simPin;         ///< SIM PIN, or "".
+    Step _step;                  ///< Current sub-step.
+    uint8_t _pinStep;            ///< Next entry of the pin sequence.
+    unsigned long _stepStartMs;  ///< `millis()` when `_step` was entered.
+    unsigned long _stepWaitMs;   ///< Time `_step` waits before it runs.
+    unsigned long _probeStartMs; ///< `millis()` when probing for the rebooted modem began.
+    bool _cmdQueued;             ///< The current sub-step's AT command has been queued.
+    bool _cmdDone;               ///< That command has completed.
+    AtResult _cmdResult;         ///< Its outcome.
+    char _cmdInfo[24];           ///< Its info line (e.g. "+CPIN: READY"), or "".
+    bool _modemAnswered;         ///< The modem answered a probe after the reset.
+    bool _simPinSent;            ///< The SIM PIN was sent during this reset; a SIM still locked afterwards fails it.
+    unsigned long _simQueryStartMs; ///< `millis()` of the first `AT+CPIN?` of this SIM check.
+};
+
+#endif // MODEM_RESET_SEQUENCER_H
@@ -0,0 +1,125 @@
+#include "MqttManager.h"
+#include <esp_task_wdt.h>
+
+/**
+ * @brief Constructs a disabled manager.
+ * Refer to MqttManager.h for detailed documentation.
+ */
+MqttManager::MqttManager() :
+    _link(nullptr),
+    _host(""),
+    _password(""),
+    _enabled(false),
+    _up(false),
+    _nextAttemptMs(0),
+    _retryDelayMs(MQTT_RECONNECT_MIN_MS) {
+    _clientId[0] = '\0';
+    _topicOverride[0] = '\0';
+    _topicThresholds[0] = '\0';
+    _topicOnline[0] = '\0';
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief Configures the broker and the per-device topics.
+ * Refer to MqttManager.h for detailed documentation.
+ */
+bool MqttManager::begin(const char* host, uint16_t port, int ghId, const char* password) {
+    _enabled = false;
+    if (!host || host[0] == '\0') {
+        DEBUG_PRINTLN(3, "MqttManager: No broker configured, overrides are polled over HTTP.");
+        return false;
+    }
+    // The efuse MAC holds the first octet in its lowest byte; bits 24..47 are the device-specific last three octets.
+    snprintf(_clientId, sizeof(_clientId), "gh%d-%06lX", ghId, (unsigned long)((ESP.getEfuseMac() >> 24) & 0xFFFFFF));
+    snprintf(_topicOverride, sizeof(_topicOverride), MQTT_TOPIC_PREFIX "%d/override", ghId);
+    snprintf(_topicThresholds, sizeof(_topicThresholds), MQTT_TOPIC_PREFIX "%d/thresholds", ghId);
+    snprintf(_topicOnline, sizeof(_topicOnline), MQTT_TOPIC_PREFIX "%d/online", ghId);
+    if (!_mqtt.setBufferSize(MQTT_BUFFER_SIZE)) {
+        DEBUG_PRINTLN(1, "MqttManager: Buffer allocation failed, push disabled.");
+        return false;
+    }
+    _host = host;
+    _password = password ? password : "";
+    _mqtt.setServer(_host, port);
+    _mqtt.setKeepAlive(MQTT_KEEPALIVE_S);
+    _mqtt.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+    _mqtt.setCallback([this](char* topic, uint8_t* payload, unsigned int len) { onMessage(topic, payload, len); });
+    _enabled = true;
+    DEBUG_PRINTF(3, "MqttManager: Push via %s:%u as %s.\n", _host, port, _clientId);
+    return true;
+}
+
+/**
+ * @brief Services the session.
+ * Refer to MqttManager.h for detailed documentation.
+ */
+void MqttManager::loop(Client* link, unsigned long nowMs) {
+    if (!_enabled) return;
+
+    if (link != _link) {
+        // The facade switched interfaces (or went offline): the old socket's session is gone either way.
+        if (_up) _mqtt.disconnect();
+        else if (_link) _link->stop();
+        _up = false;
+        _link = link;
+        if (_link) {
+            _mqtt.setClient(*_link);
+            _nextAttemptMs = nowMs;
+            _retryDelayMs = MQTT_RECONNECT_MIN_MS;
+        }
+    }
+    if (!_link) return;
+
+    if (_mqtt.loop()) return; // Connected; pending messages were dispatched to onMessage().
+    if (_up) {
+        _up = false;
+        DEBUG_PRINTF(2, "MqttManager: Session lost (state %d).\n", _mqtt.state());
+        _nextAttemptMs = nowMs; // One immediate attempt; the broker may just have dropped an idle socket.
+    }
+    if ((long)(nowMs - _nextAttemptMs) < 0) return;
+    connectSession(nowMs);
+}
+
+/**
+ * @brief Opens the session, subscribes with QoS 1 and publishes availability.
+ * On failure schedules the next attempt with doubling backoff.
+ */
+bool MqttManager::connectSession(unsigned long nowMs) {
+    esp_task_wdt_reset(); // The TCP handshake alone can take seconds over GPRS.
+    bool anonymous = _password[0] == '\0';
+    bool ok = _mqtt.connect(_clientId, anonymous ? nullptr : _clientId, anonymous ? nullptr : _password,
+                            _topicOnline, 1, true, "0", false /* cleanSession: keep queued messages */);
+    if (ok) ok = _mqtt.subscribe(_topicOverride, 1) && _mqtt.subscribe(_topicThresholds, 1);
+    if (!ok) {
+        _stats.connectFailures++;
+        DEBUG_PRINTF(2, "MqttManager: Connect to %s failed (state %d), retry in %lu ms.\n", _host, _mqtt.state(), _retryDelayMs);
+        if (_mqtt.connected()) _mqtt.disconnect();
+        _nextAttemptMs = nowMs + _retryDelayMs;
+        _retryDelayMs *= 2;
+        if (_retryDelayMs > MQTT_RECONNECT_MAX_MS) _retryDelayMs = MQTT_RECONNECT_MAX_MS;
+        return false;
+    }
+    _mqtt.publish(_topicOnline, "1", true);
+    _stats.connects++;
+    _retryDelayMs = MQTT_RECONNECT_MIN_MS;
+    _up = true;
+    DEBUG_PRINTLN(3, "MqttManager: Session up.");
+    return true;
+}
+
+/**
+ * @brief PubSubClient callback. Runs inside `_mqtt.loop()`, before the PUBACK is written.
+ */
+void MqttManager::onMessage(char* topic, uint8_t* payload, unsigned int len) {
+    MqttTopic which;
+    if (strcmp(topic, _topicOverride) == 0) which = MqttTopic::OVERRIDE;
+    else if (strcmp(topic, _topicThresholds) == 0) which = MqttTopic::THRESHOLDS;
+    else return;
+    _stats.messages++;
+    if (!_handler || _handler(which, payload, len)) return;
+    // Closing the socket here keeps the PUBACK from going out; the broker redelivers to the next session.
+    _stats.refused++;
+    DEBUG_PRINTF(2, "MqttManager: Message on %s refused, dropping session for redelivery.\n", topic);
+    _link->stop();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file MqttManager.h
+ * @brief Defines `MqttManager`, the MQTT session over which the server pushes manual overrides and threshold changes.
+ *
+ * Without a push channel, `pollWebOverride()` asks the device status endpoint every `DEVICE_STATUS_CHECK_INTERVAL_MS`,
+ * so an override takes up to 10 s plus a round trip to act, and the polling costs bandwidth all day. With a broker
+ * configured (`DeviceConfig::mqtt_host`) the server publishes to:
+ * - `greenhouse/<gh_id>/override`: same body as the device status GET, `{"data":{"exhaust_status":"1",...}}`.
+ * - `greenhouse/<gh_id>/thresholds`: same body as the threshold GET, `{"data":[{"name":...,"threshold_min":...},...]}`.
+ * Both should be published with QoS 1 and the retain flag, so a new session starts from the current values.
+ *
+ * The session uses a fixed client id (`gh<gh_id>-<MAC>`), `cleanSession = false` and QoS 1 subscriptions, so the
+ * broker queues what is published while the link is down and delivers it on reconnect. PubSubClient sends the
+ * PUBACK after the message handler returns; if the handler cannot take a message (event ring full) the socket is
+ * dropped first, so the PUBACK never goes out and the broker redelivers the message to the next session.
+ * `greenhouse/<gh_id>/online` holds "1" (retained) while the session is up and "0" (last will) after it is lost.
+ *
+ * MQTT is not a third link: the session runs over the spare socket of whichever interface `NetworkFacade` has
+ * active (`NetworkInterface::getPushClient()`) and is re-established when the facade switches between WiFi and
+ * GPRS. While no session is up the sketch keeps polling over HTTP; reconnects back off from
+ * `MQTT_RECONNECT_MIN_MS` to `MQTT_RECONNECT_MAX_MS`.
+ *
+ * Network worker task only; no locking.
+ */
+#ifndef MQTT_MANAGER_H
+#define MQTT_MANAGER_H
+
+#include <Arduino.h>
+#include <Client.h>       // Common base of `WiFiClient` and `TinyGsmClient`.
+#include <PubSubClient.h> // MQTT 3.1.1 client.
+#include <functional>
+#include "config.h"       // For the MqttPushConfig group.
+
+/**
+ * @enum MqttTopic
+ * @brief Subscribed topic a pushed message arrived on.
+ */
+enum class MqttTopic : uint8_t {
+    OVERRIDE,   ///< `<prefix><gh_id>/override`: manual relay override targets.
+    THRESHOLDS  ///< `<prefix><gh_id>/thresholds`: sensor thresholds.
+};
+
+/**
+ * @class MqttManager
+ * @brief Keeps one persistent MQTT session on the active link and hands pushed messages to a handler.
+ */
+class MqttManager {
+public:
+    /**
+     * @brief Handler for a pushed message. Runs inside `loop()`.
+     * @return `true` if the message was taken (it is acknowledged); `false` to have the broker redeliver it.
+     */
+    using MessageHandler = std::function<bool(MqttTopic topic, const uint8_t* payload, unsigned int len)>;
+
+    /**
+     * @struct Stats
+     * @brief Running counters since boot.
+     */
+    struct Stats {
+        uint32_t connects;        ///< Sessions established.
+        uint32_t connectFailures; ///< Connect or subscribe attempts that failed.
+        uint32_t messages;        ///< Messages received on a subscribed topic.
+        uint32_t refused;         ///< Messages the handler could not take; left to the broker to redeliver.
+    };
+
+    /**
+     * @brief Constructs a disabled manager. Call `begin()` to enable it.
+     */
+    MqttManager();
+
+    /**
+     * @brief Configures the broker and the per-device topics.
+     * @param host Broker host; empty disables push. Must stay valid (e.g. `DeviceConfig::mqtt_host`).
+     * @param port Broker port.
+     * @param ghId Greenhouse id, used in the client id, user name and topics.
+     * @param password Broker password (the API token); empty connects without credentials. Must stay valid.
+     * @return `true` if push is enabled.
+     */
+    bool begin(const char* host, uint16_t port, int ghId, const char* password);
+
+    /**
+     * @brief Sets the handler for pushed messages.
+     * @param handler Called from `loop()`; may be empty (messages are then acknowledged and dropped).
+     */
+    void setMessageHandler(MessageHandler handler) { _handler = handler; }
+
+    /**
+     * @brief Services the session: follows link changes, reconnects with backoff, reads pending packets and sends keep-alives.
+     * Call on every worker pass. A connect attempt blocks for the TCP handshake and CONNACK.
+     * @param link Push socket of the active interface (`NetworkFacade::getPushClient()`), or `nullptr` while offline.
+     * @param nowMs Current `millis()`.
+     */
+    void loop(Client* link, unsigned long nowMs);
+
+    /**
+     * @brief Checks whether push is configured.
+     * @return `true` after a successful `begin()`.
+     */
+    bool isEnabled() const { return _enabled; }
+
+    /**
+     * @brief Checks whether a session is up, as of the last `loop()`.
+     * @return `true` if subscribed and connected.
+     */
+    bool isConnected() const { return _up; }
+
+    /**
+     * @brief Gets the running counters.
+     * @return Reference to the statistics.
+     */
+    const Stats& getStats() const { return _stats; }
+
+private:
+    bool connectSession(unsigned long nowMs);
+    void onMessage(char* topic, uint8_t* payload, unsigned int len);
+
+    PubSubClient _mqtt;             ///< Protocol client; its socket is re-bound on every link change.
+    Client* _link;                  ///< Socket the session currently runs on, or `nullptr`.
+    MessageHandler _handler;        ///< Receives pushed messages.
+    const char* _host;              ///< Broker host.
+    const char* _password;          ///< Broker password; empty for anonymous.
+    bool _enabled;                  ///< `begin()` found a broker configured.
+    bool _up;                       ///< Session established and subscribed.
+    unsigned long _nextAttemptMs;   ///< `millis()` of the next connect attempt.
+    unsigned long _retryDelayMs;    ///< Backoff applied after the next failed attempt.
+    char _clientId[MQTT_CLIENT_ID_MAX_LEN];      ///< `gh<gh_id>-<MAC>`; stable so the broker keeps the session.
+    char _topicOverride[MQTT_TOPIC_MAX_LEN];     ///< Subscribed override topic.
+    char _topicThresholds[MQTT_TOPIC_MAX_LEN];   ///< Subscribed threshold topic.
+    char _topicOnline[MQTT_TOPIC_MAX_LEN];       ///< Availability topic ("1" / last will "0").
+    Stats _stats;                   ///< Running counters.
+};
+
+#endif // MQTT_MANAGER_H
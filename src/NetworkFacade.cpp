@@ -3,6 +3,7 @@
 #include "GPRSManager.h"   // Ensure full definition is available
 #include "config.h"        // For DEBUG_PRINTLN
 #include <Arduino.h>       // For String, Serial, etc.
+#include <esp_task_wdt.h>  // For the blocking connect wrappers
 
 /**
 * @brief Constructs a NetworkFacade, taking ownership of the provided managers.
@@ -19,9 +20,21 @@ NetworkFacade::NetworkFacade(
       _wifiManagerRaw(_wifiManagerOwned.get()),
       _gprsManagerRaw(_gprsManagerOwned.get()),
       _deviceState(deviceState), // Initialize _deviceState
-      _activeInterface(nullptr) {
+      _activeInterface(nullptr),
+      _inFlightIsGet(false),
+      _inFlightOn(nullptr),
+      _inFlightAnswered(false),
+      _bootNonce(esp_random()),
+      _connectOp(ConnectOp::NONE),
+      _connectResult(ConnectProgress::FAILED),
+      _holdDispatch(false),
+      _linkLostAtMs(0),
+      _switchPending(false),
+      _recoveryPending(false) {
+   memset(&_failoverStats, 0, sizeof(_failoverStats));
    // _apiResponse[0] = '\0'; // Removed: _apiResponse member is removed from header
    DEBUG_PRINTLN(3, "NetworkFacade (owned): Initialized.");
+   attachResponseObservers();
    determineActiveInterface(); // Initial determination
 }
 
@@ -40,9 +53,21 @@ NetworkFacade::NetworkFacade(
       _wifiManagerRaw(wifiManager),
       _gprsManagerRaw(gprsManager),
       _deviceState(deviceState), // Initialize _deviceState
-      _activeInterface(nullptr) {
+      _activeInterface(nullptr),
+      _inFlightIsGet(false),
+      _inFlightOn(nullptr),
+      _inFlightAnswered(false),
+      _bootNonce(esp_random()),
+      _connectOp(ConnectOp::NONE),
+      _connectResult(ConnectProgress::FAILED),
+      _holdDispatch(false),
+      _linkLostAtMs(0),
+      _switchPending(false),
+      _recoveryPending(false) {
+   memset(&_failoverStats, 0, sizeof(_failoverStats));
    // _apiResponse[0] = '\0'; // Removed: _apiResponse member is removed from header
    DEBUG_PRINTLN(3, "NetworkFacade (raw ptrs): Initialized.");
+   attachResponseObservers();
    determineActiveInterface(); // Initial determination
 }
 
@@ -111,56 +136,142 @@ void NetworkFacade::determineActiveInterface() {
             break;
     }
     if (_activeInterface) {
-        // _activeInterface->getStatusString() still returns String. We'll use its c_str()
         DEBUG_PRINTF(3, "NetworkFacade: Active interface set to %s\n", _activeInterface->getStatusString().c_str());
     } else {
         DEBUG_PRINTLN(2, "NetworkFacade: No active interface could be determined.");
     }
+    if (_inFlightOn && _inFlightOn != _activeInterface) {
+        migrateInFlight(); // Nothing pumps the old interface any more; re-issue on the new one.
+    }
 }
 
 
 /**
-* @brief Attempts to establish a network connection based on the current preference.
-* This method implements the connection logic considering `_preference`.
-* It tries the preferred interface first, and if applicable (e.g., WIFI_PREFERRED and WiFi fails),
-* it attempts to connect via the fallback interface.
-* After connection attempts, it calls `determineActiveInterface()` to update the active status.
+* @brief Starts a non-blocking connect based on the current preference.
+* GPRS only starts its own FSM, so a GPRS connect completes here; a WiFi connect is advanced by `pollConnect()`.
 * Refer to NetworkFacade.h for detailed documentation.
 */
-bool NetworkFacade::connect() {
-   DEBUG_PRINTLN(3, "NetworkFacade: connect() called.");
+bool NetworkFacade::startConnect() {
+    if (_connectOp != ConnectOp::NONE) return true;
+    DEBUG_PRINTLN(3, "NetworkFacade: startConnect() called.");
     WiFiManager* wm = getWiFiManager();
     GPRSManager* gm = getGPRSManager();
-    bool success = false;
 
     switch (_preference) {
         case NetworkPreference::WIFI_ONLY:
-            if (wm) success = wm->connect();
-            break;
-        case NetworkPreference::GPRS_ONLY:
-            if (gm) success = gm->connect();
-            break;
         case NetworkPreference::WIFI_PREFERRED:
-            if (wm && wm->connect()) {
-                success = true;
-            } else if (gm) {
-                DEBUG_PRINTLN(3, "NetworkFacade: WiFi failed or not available, trying GPRS.");
-                if (wm && wm->isConnected()) wm->disconnect(); // Ensure WiFi is off if GPRS is to be primary
-                success = gm->connect();
+            if (isWarmStandby()) gm->connect(); // Attaches in the background; stays idle while WiFi is up.
+            if (wm && wm->startConnect()) {
+                _connectOp = ConnectOp::CONNECT;
+                return true;
+            }
+            if (_preference == NetworkPreference::WIFI_PREFERRED && gm) {
+                DEBUG_PRINTLN(3, "NetworkFacade: WiFi not available, trying GPRS.");
+                return finishConnect(gm->connect()) == ConnectProgress::CONNECTED;
             }
             break;
+        case NetworkPreference::GPRS_ONLY:
+            if (gm) return finishConnect(gm->connect()) == ConnectProgress::CONNECTED;
+            break;
         case NetworkPreference::GPRS_PREFERRED:
-            if (gm && gm->connect()) {
-                success = true;
-            } else if (wm) {
+            if (gm && gm->connect()) return finishConnect(true) == ConnectProgress::CONNECTED;
+            if (wm) {
                 DEBUG_PRINTLN(3, "NetworkFacade: GPRS failed or not available, trying WiFi.");
                 if (gm && gm->isConnected()) gm->disconnect(); // Ensure GPRS is off
-                success = wm->connect();
+                if (wm->startConnect()) {
+                    _connectOp = ConnectOp::CONNECT;
+                    return true;
+                }
             }
             break;
     }
+    finishConnect(false);
+    return false;
+}
+
+/**
+* @brief Starts a non-blocking switch to WiFi while GPRS stays up.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+bool NetworkFacade::startSwitchToWiFi() {
+    if (_connectOp != ConnectOp::NONE) return _connectOp == ConnectOp::SWITCH_TO_WIFI;
+    DEBUG_PRINTLN(3, "NetworkFacade: Attempting to switch to WiFi.");
+    WiFiManager* wm = getWiFiManager();
+    if (!wm) {
+        DEBUG_PRINTLN(1, "NetworkFacade: WiFiManager not available for switching.");
+        finishConnect(false);
+        return false;
+    }
+    if (!wm->startConnect()) {
+        finishConnect(false);
+        return false;
+    }
+    _connectOp = ConnectOp::SWITCH_TO_WIFI;
+    return true;
+}
+
+/**
+* @brief Advances the connect or switch started by `startConnect()` / `startSwitchToWiFi()`.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+NetworkFacade::ConnectProgress NetworkFacade::pollConnect() {
+    if (_connectOp == ConnectOp::NONE) return _connectResult;
+    WiFiManager* wm = getWiFiManager();
+    GPRSManager* gm = getGPRSManager();
+    WiFiManager::WiFiConnState state = wm->updateConnection(millis());
+    if (state == WiFiManager::WiFiConnState::CONNECTING || state == WiFiManager::WiFiConnState::RETRY_WAIT) {
+        return ConnectProgress::IN_PROGRESS;
+    }
+    bool wifiUp = state == WiFiManager::WiFiConnState::CONNECTED;
+
+    if (_connectOp == ConnectOp::SWITCH_TO_WIFI) {
+        if (!wifiUp) {
+            DEBUG_PRINTLN(2, "NetworkFacade: WiFi connection failed during switch attempt. GPRS (if active) will not be disconnected.");
+            return finishConnect(false);
+        }
+        if (gm && gm->isHttpOperationActive()) {
+            _holdDispatch = true; // Let the request on GPRS finish, but start no new one there.
+            return ConnectProgress::IN_PROGRESS;
+        }
+        if (gm && gm->isConnected() && !isWarmStandby()) {
+            DEBUG_PRINTLN(3, "NetworkFacade: Disconnecting GPRS as WiFi is now active.");
+            gm->disconnect();
+        }
+        return finishConnect(true);
+    }
+
+    if (wifiUp) return finishConnect(true);
+    if (_preference == NetworkPreference::WIFI_PREFERRED && gm) {
+        DEBUG_PRINTLN(3, "NetworkFacade: WiFi failed, trying GPRS.");
+        return finishConnect(gm->connect());
+    }
+    return finishConnect(false);
+}
+
+/**
+* @brief Ends the current connect operation and re-selects the active interface.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+NetworkFacade::ConnectProgress NetworkFacade::finishConnect(bool ok) {
+    _connectOp = ConnectOp::NONE;
+    _holdDispatch = false;
+    _connectResult = ok ? ConnectProgress::CONNECTED : ConnectProgress::FAILED;
     determineActiveInterface(); // Update active interface based on connection result
-    return success;
+    return _connectResult;
+}
+
+/**
+* @brief Blocking connect based on the current preference, for `setup()`.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+bool NetworkFacade::connect() {
+    startConnect();
+    ConnectProgress progress;
+    while ((progress = pollConnect()) == ConnectProgress::IN_PROGRESS) {
+        esp_task_wdt_reset();
+        delay(WIFI_CONNECT_POLL_MS);
+    }
+    return progress == ConnectProgress::CONNECTED;
 }
 
 /**
@@ -174,12 +285,16 @@ void NetworkFacade::disconnect() {
     WiFiManager* wm = getWiFiManager();
     GPRSManager* gm = getGPRSManager();
 
+    migrateInFlight(); // Kept for the next connection.
+
     if (wm && wm->isConnected()) {
         wm->disconnect();
     }
     if (gm && gm->isConnected()) {
         gm->disconnect();
     }
+    _connectOp = ConnectOp::NONE; // Abandon a connect in progress; the managers were just reset.
+    _holdDispatch = false;
     _activeInterface = nullptr; // No active interface after explicit disconnect
 }
 
@@ -210,9 +325,7 @@ bool NetworkFacade::isConnected() const {
 }
 
 /**
-* @brief Initiates an asynchronous HTTP request.
-* If not currently connected, it first attempts to `connect()` based on preferences.
-* If a connection is active or established, it delegates the request to the `_activeInterface`.
+* @brief Queues an asynchronous HTTP request with normal priority.
 * Refer to NetworkFacade.h for detailed documentation.
 */
 bool NetworkFacade::startAsyncHttpRequest(
@@ -220,45 +333,220 @@ bool NetworkFacade::startAsyncHttpRequest(
    const char* method,
    const char* apiType,
    const char* payload,
-   std::function<bool(JsonDocument& doc)> cb,
+   const HttpResponseCallback& cb,
    bool needsAuth) {
+   return enqueueHttpRequest(url, method, apiType, payload, cb, needsAuth, HttpRequestPriority::NORMAL);
+}
 
-   if (!isConnected()) { // Check overall facade connectivity
-       DEBUG_PRINTLN(3, "NetworkFacade: Not connected. Attempting to connect before HTTP request.");
-       if (!connect()) { // connect() handles preferences and sets _activeInterface
-           DEBUG_PRINTF(1, "NetworkFacade: Connection failed for %s. HTTP request cannot proceed.\n", apiType);
-           return false;
-       }
-       // At this point, if connect() succeeded, _activeInterface should be set and connected.
+/**
+* @brief Queues an asynchronous HTTP request with an explicit priority.
+* Fails without queueing if not currently connected.
+* The request is then copied into `_requestQueue` and dispatched immediately if the active interface is idle.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+bool NetworkFacade::enqueueHttpRequest(
+   const char* url,
+   const char* method,
+   const char* apiType,
+   const char* payload,
+   const HttpResponseCallback& cb,
+   bool needsAuth,
+   HttpRequestPriority priority,
+   uint16_t tag) {
+
+   if (!isConnected()) { // Check overall facade connectivity; reconnecting is left to the caller's backoff.
+       DEBUG_PRINTF(2, "NetworkFacade: Not connected%s. HTTP request %s cannot proceed.\n",
+                    isConnectInProgress() ? " (connect in progress)" : "", apiType);
+       return false;
    }
 
-   // By now, _activeInterface should be valid and connected if connect() was successful or if it was already connected.
-   if (_activeInterface && _activeInterface->isConnected()) {
-       return _activeInterface->startAsyncHttpRequest(url, method, apiType, payload, cb, needsAuth);
-   } else {
-       // This case implies that even after an attempt to connect(), no interface is active and connected.
-       DEBUG_PRINTF(1, "NetworkFacade: No active/connected interface available for HTTP request for %s even after connection attempt.\n", apiType);
+   if (!_requestQueue.push(url, method, apiType, payload, cb, needsAuth, priority, millis(), tag)) {
        return false;
    }
+   DEBUG_PRINTF(4, "NetworkFacade: Queued %s (prio %d, depth %u).\n", apiType, (int)priority, (unsigned)_requestQueue.size());
+
+   dispatchQueuedRequest(); // Start right away if the interface is idle.
+   return true;
 }
 
 /**
-* @brief Updates ongoing asynchronous HTTP operations for the active interface.
-* This method should be called periodically to process HTTP responses.
-* It delegates the call to the `_activeInterface` if one exists.
+* @brief Updates ongoing asynchronous HTTP operations for the active interface and dispatches queued requests.
 * Refer to NetworkFacade.h for detailed documentation.
 */
 void NetworkFacade::updateHttpOperations() {
-    // Update operations for ALL interfaces, as one might be completing
-    // a request even if it's not the "active" one for new requests.
-    // Or, more simply, only update the _activeInterface.
-    // For now, let's assume only the _activeInterface handles ongoing operations.
+    if (_connectOp != ConnectOp::NONE) pollConnect();
+    else serviceFailover(millis());
+    // Only the _activeInterface handles ongoing operations; a request is tied to the interface it started on.
     if (_activeInterface) {
         _activeInterface->updateHttpOperations();
     }
-    // If requests could be started on one, then switched, both would need update.
-    // This simplified version assumes an op is tied to the interface it started on.
-    // And that _activeInterface is the one currently handling any ops.
+    if (_inFlightOn && !_inFlightOn->isHttpOperationActive()) {
+        finishInFlight();
+    }
+    dispatchQueuedRequest();
+}
+
+/**
+* @brief Checks whether a request is in flight or waiting in the queue.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+bool NetworkFacade::isHttpOperationActive() const {
+    if (_activeInterface && _activeInterface->isHttpOperationActive()) {
+        return true;
+    }
+    return !_requestQueue.isEmpty();
+}
+
+/**
+* @brief Aborts and discards the request in flight.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::abortHttpOperation() {
+    if (!_inFlightOn) return;
+    _inFlightOn->abortHttpOperation();
+    finishInFlight();
+}
+
+/**
+* @brief Checks whether GPRS is kept attached while WiFi is primary.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+bool NetworkFacade::isWarmStandby() const {
+    return ENABLE_GPRS_WARM_STANDBY && _preference == NetworkPreference::WIFI_PREFERRED && getGPRSManager() != nullptr;
+}
+
+/**
+* @brief Fails over on a WiFi link loss and records when traffic can flow again.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::serviceFailover(unsigned long nowMs) {
+    WiFiManager* wm = getWiFiManager();
+    if (wm && _activeInterface == wm && wm->getConnectState() == WiFiManager::WiFiConnState::CONNECTED &&
+        wm->updateConnection(nowMs) != WiFiManager::WiFiConnState::CONNECTED) {
+        failOver(wm->getLinkLostAtMs());
+    }
+    if (_switchPending && _activeInterface && _activeInterface->isConnected()) {
+        unsigned long switchMs = nowMs - _linkLostAtMs;
+        _switchPending = false;
+        _failoverStats.lastSwitchMs = switchMs;
+        if (switchMs > _failoverStats.maxSwitchMs) _failoverStats.maxSwitchMs = switchMs;
+        DEBUG_PRINTF(3, "NetworkFacade: Link usable again %lu ms after WiFi loss.\n", switchMs);
+    }
+}
+
+/**
+* @brief Moves traffic off a lost WiFi link.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::failOver(unsigned long lostAtMs) {
+    WiFiManager* wm = getWiFiManager();
+    GPRSManager* gm = getGPRSManager();
+    _linkLostAtMs = lostAtMs;
+    _switchPending = true;
+    _recoveryPending = true;
+    if (_inFlightOn == wm) {
+        // The socket is gone with the link; waiting for HTTPClient's timeout and retries would only delay the re-issue.
+        migrateInFlight();
+    }
+    determineActiveInterface();
+    if (gm && _activeInterface == gm) {
+        _failoverStats.failovers++;
+        DEBUG_PRINTLN(2, "NetworkFacade: WiFi lost, failing over to GPRS standby.");
+    } else {
+        _failoverStats.coldFailovers++;
+        DEBUG_PRINTLN(2, "NetworkFacade: WiFi lost, GPRS not attached. Waiting for reconnect.");
+    }
+}
+
+/**
+* @brief Starts the most urgent queued request when the active interface is connected and idle.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::dispatchQueuedRequest() {
+    if (_holdDispatch) return; // WiFi is up; the switch completes once GPRS is idle.
+    if (!_activeInterface || !_activeInterface->isConnected() || _activeInterface->isHttpOperationActive()) {
+        return;
+    }
+    HttpRequestDescriptor* next = _requestQueue.peek();
+    if (!next) {
+        return;
+    }
+    if (_inFlightOn && !_inFlightOn->isHttpOperationActive()) finishInFlight(); // Reported before the slot is reused.
+
+    // Repeat polls of the same endpoint go out as conditional GETs once its validators are known.
+    bool isGet = strcmp(next->method, "GET") == 0;
+    const HttpValidators* validators = isGet ? _validatorCache.lookup(next->url, millis()) : nullptr;
+    _activeInterface->setConditionalRequest(validators);
+
+    // The key follows the request through re-issues, so a POST that reached the server before its link dropped
+    // is recognised as a repeat.
+    char idempotencyKey[HTTP_IDEMPOTENCY_KEY_LEN];
+    if (!isGet) snprintf(idempotencyKey, sizeof(idempotencyKey), "%08lx-%08lx", (unsigned long)_bootNonce, (unsigned long)next->seq);
+    _activeInterface->setIdempotencyKey(isGet ? nullptr : idempotencyKey);
+
+    // The response goes through the facade, so it knows at the end whether the caller got an answer.
+    HttpResponseCallback relay;
+    if (next->cb) relay = [this](JsonDocument& doc) -> bool { return relayInFlightResponse(doc); };
+    bool started = _activeInterface->startAsyncHttpRequest(
+        next->url, next->method, next->apiType,
+        _requestQueue.payloadOf(*next),
+        relay, next->needsAuth);
+
+    unsigned long now = millis();
+    if (started) {
+        _inFlightIsGet = isGet;
+        _inFlightOn = _activeInterface;
+        _inFlightAnswered = false;
+        if (validators) _validatorCache.noteConditionalSent();
+        DEBUG_PRINTF(4, "NetworkFacade: Dispatched %s after %lu ms in queue (depth %u%s).\n",
+                     next->apiType, now - next->enqueuedAtMs, (unsigned)(_requestQueue.size() - 1),
+                     validators ? ", conditional" : "");
+    } else {
+        DEBUG_PRINTF(1, "NetworkFacade: Active interface refused queued %s. Discarding.\n", next->apiType);
+    }
+    _requestQueue.pop(now, started);
+}
+
+/**
+* @brief Releases the finished in-flight request, retiring it if unanswered.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::finishInFlight() {
+    if (!_inFlightAnswered) {
+        const HttpRequestDescriptor* d = _requestQueue.inFlight();
+        DEBUG_PRINTF(3, "NetworkFacade: %s finished without a response for its caller.\n", d ? d->apiType : "?");
+    }
+    _requestQueue.completeInFlight(_inFlightAnswered);
+    _inFlightOn = nullptr;
+}
+
+/**
+* @brief Marks the in-flight request answered and runs its callback.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+bool NetworkFacade::relayInFlightResponse(JsonDocument& doc) {
+    _inFlightAnswered = true;
+    const HttpRequestDescriptor* d = _requestQueue.inFlight();
+    return d && d->cb ? d->cb(doc) : false;
+}
+
+/**
+* @brief Aborts the request in flight on its interface and requeues it.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::migrateInFlight() {
+    if (!_inFlightOn) return;
+    NetworkInterface* from = _inFlightOn;
+    if (!from->isHttpOperationActive()) {
+        finishInFlight(); // Finished before anyone noticed; re-issuing would duplicate it.
+        return;
+    }
+    _inFlightOn = nullptr;
+    from->abortHttpOperation();
+    if (_requestQueue.requeueInFlight()) {
+        _failoverStats.reissued++;
+        DEBUG_PRINTLN(3, "NetworkFacade: Request in flight moved off the previous interface.");
+    }
 }
 
 /**
@@ -267,13 +555,12 @@ void NetworkFacade::updateHttpOperations() {
 * available interfaces and current preference if disconnected.
 * Refer to NetworkFacade.h for detailed documentation.
 */
-String NetworkFacade::getStatusString() const {
-   char buffer[128]; //Reasonable buffer size for status strings
+NetworkStatusString NetworkFacade::getStatusString() const {
+    NetworkStatusString status; // Longer nested statuses are truncated to NETWORK_STATUS_MAX_LEN.
 
     if (_activeInterface) {
-        // _activeInterface->getStatusString() returns String. Use its c_str()
-        snprintf(buffer, sizeof(buffer), "Facade (Active: %s)", _activeInterface->getStatusString().c_str());
-        return String(buffer);
+        status.format("Facade (Active: %s)", _activeInterface->getStatusString().c_str());
+        return status;
     }
 
     WiFiManager* wm = getWiFiManager();
@@ -282,14 +569,12 @@ String NetworkFacade::getStatusString() const {
     bool gprsAvailable = (gm != nullptr);
 
     if (wifiAvailable && wm && wm->isConnected()) {
-        // wm->getStatusString() returns String. Use its c_str()
-        snprintf(buffer, sizeof(buffer), "Facade (WiFi Connected: %s)", wm->getStatusString().c_str());
-        return String(buffer);
+        status.format("Facade (WiFi Connected: %s)", wm->getStatusString().c_str());
+        return status;
     }
     if (gprsAvailable && gm && gm->isConnected()) {
-        // gm->getStatusString() returns String. Use its c_str()
-        snprintf(buffer, sizeof(buffer), "Facade (GPRS Connected: %s)", gm->getStatusString().c_str());
-        return String(buffer);
+        status.format("Facade (GPRS Connected: %s)", gm->getStatusString().c_str());
+        return status;
     }
     
     const char* prefStr = "";
@@ -299,42 +584,25 @@ String NetworkFacade::getStatusString() const {
         case NetworkPreference::WIFI_PREFERRED: prefStr = "WiFi Preferred"; break;
         case NetworkPreference::GPRS_PREFERRED: prefStr = "GPRS Preferred"; break;
     }
-    snprintf(buffer, sizeof(buffer), "Facade (Disconnected. Pref: %s. WiFi Avail: %d, GPRS Avail: %d)",
-             prefStr, wifiAvailable, gprsAvailable);
-    return String(buffer);
+    status.format("Facade (Disconnected. Pref: %s. WiFi Avail: %d, GPRS Avail: %d)",
+                  prefStr, wifiAvailable, gprsAvailable);
+    return status;
 }
 
 /**
-* @brief Explicitly attempts to switch to and connect via the WiFi interface.
+* @brief Explicitly switches to WiFi, blocking until the switch completes or fails.
 * If GPRS is active, it will be disconnected *after* WiFi successfully connects.
-* Calls `determineActiveInterface()` to update the active state.
 * Refer to NetworkFacade.h for detailed documentation.
 */
 bool NetworkFacade::switchToWiFi() {
-   DEBUG_PRINTLN(3, "NetworkFacade: Attempting to switch to WiFi.");
-    WiFiManager* wm = getWiFiManager();
-    GPRSManager* gm = getGPRSManager();
-
-    if (!wm) {
-        DEBUG_PRINTLN(1, "NetworkFacade: WiFiManager not available for switching.");
-        return false;
-    }
-
-    DEBUG_PRINTLN(4, "NetworkFacade: Trying to connect WiFi before potentially disconnecting GPRS.");
-    if (wm->connect()) {
-        DEBUG_PRINTLN(3, "NetworkFacade: WiFi connected successfully during switch attempt.");
-        if (gm && gm->isConnected()) {
-            DEBUG_PRINTLN(3, "NetworkFacade: Disconnecting GPRS as WiFi is now active.");
-            gm->disconnect();
-        }
-        determineActiveInterface(); // Set WiFi as active
-        return true;
-    } else {
-        DEBUG_PRINTLN(2, "NetworkFacade: WiFi connection failed during switch attempt. GPRS (if active) will not be disconnected.");
-        // Ensure the active interface is correctly set, possibly back to GPRS if it was active and WiFi failed
-        determineActiveInterface();
-        return false;
+    if (!startSwitchToWiFi()) return false;
+    ConnectProgress progress;
+    while ((progress = pollConnect()) == ConnectProgress::IN_PROGRESS) {
+        esp_task_wdt_reset();
+        updateHttpOperations(); // A GPRS request in flight must finish before GPRS is dropped.
+        delay(WIFI_CONNECT_POLL_MS);
     }
+    return progress == ConnectProgress::CONNECTED;
 }
 
 /**
@@ -378,6 +646,15 @@ NetworkInterface* NetworkFacade::getCurrentInterface() const {
    return _activeInterface;
 }
 
+/**
+* @brief Gets the push socket of the active interface while it is connected.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+Client* NetworkFacade::getPushClient() {
+   if (!_activeInterface || !_activeInterface->isConnected()) return nullptr;
+   return _activeInterface->getPushClient();
+}
+
 /**
 * @brief Gets the current network preference strategy.
 * Refer to NetworkFacade.h for detailed documentation.
@@ -426,6 +703,55 @@ bool NetworkFacade::isSafeModeActive() const {
    return false; // Default to not in safe mode if device state is not available
 }
 
+/**
+* @brief Gets the request queue statistics.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+const HttpRequestQueue::Stats& NetworkFacade::getRequestQueueStats() const {
+   return _requestQueue.getStats();
+}
+
+/**
+* @brief Registers the facade's response observer with both managers.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::attachResponseObservers() {
+   if (_wifiManagerRaw) {
+       _wifiManagerRaw->setResponseObserver([this](const char* url, const HttpResponseInfo& info) {
+           onInterfaceResponse(url, info, false);
+       });
+   }
+   if (_gprsManagerRaw) {
+       _gprsManagerRaw->setResponseObserver([this](const char* url, const HttpResponseInfo& info) {
+           onInterfaceResponse(url, info, true);
+       });
+   }
+}
+
+/**
+* @brief Updates the validator cache from a finished request and notifies the outer observer.
+* Refer to NetworkFacade.h for detailed documentation.
+*/
+void NetworkFacade::onInterfaceResponse(const char* url, const HttpResponseInfo& info, bool overGprs) {
+   unsigned long now = millis();
+   if (_inFlightIsGet) {
+       _validatorCache.onResponse(url, info, overGprs, now);
+   }
+   if (info.notModified) _inFlightAnswered = true; // The caller is told through the response observer.
+   if (_recoveryPending && info.statusCode > 0) {
+       unsigned long recoveryMs = now - _linkLostAtMs;
+       _recoveryPending = false;
+       _failoverStats.lastRecoveryMs = recoveryMs;
+       if (recoveryMs > _failoverStats.maxRecoveryMs) _failoverStats.maxRecoveryMs = recoveryMs;
+   }
+   if (_responseObserver) {
+       HttpResponseInfo tagged = info;
+       const HttpRequestDescriptor* d = _requestQueue.inFlight();
+       tagged.tag = d ? d->tag : 0;
+       _responseObserver(url, tagged);
+   }
+}
+
 // Note: The _apiResponse member variable has been removed from NetworkFacade.h
 // as it was determined to be unused. Response handling is fully delegated to
 // the active WiFiManager or GPRSManager instances.
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include <ArduinoJson.h> // Explicit include for JsonDocument
 #include "DeviceState.h" // For access to fail safe mode status
 #include "config.h" // For NETWORK_MAX_RESPONSE_LEN, WIFI_MAX_SSID_LEN, etc.
+#include "HttpRequestQueue.h" // Fixed-capacity priority queue holding requests until the active interface is free.
+#include "HttpValidatorCache.h" // ETag/Last-Modified per GET endpoint for conditional requests.
  
  // Forward declarations
 class WiFiManager;
@@ -24,6 +26,25 @@ class LCDDisplay;
  * The facade can take ownership of the manager instances (via `std::unique_ptr`) or
  * use externally managed raw pointers, providing flexibility in how network resources are handled.
  * It interacts with a `DeviceState` object to be aware of system-wide states like fail-safe mode.
+ *
+ * Because the underlying managers run only one HTTP operation at a time, the facade owns an
+ * `HttpRequestQueue`. Requests are copied into preallocated descriptors and dispatched in priority
+ * order from `updateHttpOperations()` whenever the active interface becomes idle.
+ *
+ * The facade also remembers the `ETag` / `Last-Modified` validators of every GET endpoint in an
+ * `HttpValidatorCache` and turns repeat polls into conditional GETs. A `304` completes the request without a
+ * body or callback; the savings are counted per link (see `getValidatorStats()`).
+ *
+ * Requests stay owned by the facade until they finish. Whenever the active interface changes (failover, a switch,
+ * a reconnect or `disconnect()`), the request in flight on the old interface is aborted there and requeued at the
+ * head of the queue, so it is re-issued on the new interface instead of being stranded until its timeout. Queued
+ * requests are not bound to an interface and simply go out on the new one. POSTs carry an `Idempotency-Key`
+ * (boot nonce and queue sequence number) that is the same on every re-issue, so the server can apply them at most once.
+ *
+ * With `WIFI_PREFERRED` and `ENABLE_GPRS_WARM_STANDBY`, GPRS is brought up alongside WiFi and kept registered and
+ * attached but idle. A WiFi disconnect event then moves traffic to GPRS at once instead of after a 30-60 s attach:
+ * the request in flight on WiFi is aborted and put back at the head of the queue, and goes out on GPRS in the same
+ * `updateHttpOperations()` pass. Failover times are counted in `getFailoverStats()`.
  */
 class NetworkFacade : public NetworkInterface {
 public:
@@ -84,10 +105,51 @@ public:
 
     // Inherited from NetworkInterface
     /**
-     * @brief Attempts to establish a network connection based on the current `_preference` and interface availability.
-     *
-     * It calls `determineActiveInterface()` to select the primary (and potentially fallback)
-     * interface. Then, it invokes `connect()` on the chosen `_activeInterface`.
+     * @enum ConnectProgress
+     * @brief Outcome of `pollConnect()`.
+     */
+    enum class ConnectProgress : uint8_t {
+        IN_PROGRESS, ///< WiFi is still associating (or the switch waits for GPRS to go idle).
+        CONNECTED,   ///< The operation succeeded; `_activeInterface` is updated.
+        FAILED       ///< No permissible interface could be connected.
+    };
+
+    /**
+     * @brief Starts a connect based on the current `_preference` without blocking.
+     * - `WIFI_ONLY` / `WIFI_PREFERRED`: starts the WiFi state machine; with `WIFI_PREFERRED`, GPRS is started by
+     *   `pollConnect()` if WiFi fails (or here, if WiFi cannot even start). With warm standby, GPRS is started here
+     *   as well and attaches in the background.
+     * - `GPRS_ONLY` / `GPRS_PREFERRED`: `GPRSManager::connect()` only starts the GPRS FSM and completes at once;
+     *   with `GPRS_PREFERRED`, WiFi is started if that fails.
+     * Does nothing if a connect or switch is already in progress.
+     * @return `true` if a connect is in progress or completed successfully; `false` if it failed immediately.
+     */
+    bool startConnect();
+
+    /**
+     * @brief Starts moving from GPRS to WiFi without blocking. GPRS stays up until WiFi has an IP and the request
+     *        in flight on GPRS (if any) has finished; no further request is dispatched on GPRS meanwhile. GPRS is
+     *        then disconnected, or kept attached as the warm standby.
+     * @return `true` if the switch is in progress; `false` if there is no WiFi manager, no SSID, or a connect is running.
+     */
+    bool startSwitchToWiFi();
+
+    /**
+     * @brief Advances the operation started by `startConnect()` or `startSwitchToWiFi()`.
+     * Also pumped by `updateHttpOperations()`, so callers may just read the result.
+     * @return `IN_PROGRESS` while running; afterwards the result of the last operation.
+     */
+    ConnectProgress pollConnect();
+
+    /**
+     * @brief Checks whether a connect or switch is in progress.
+     * @return `true` until `pollConnect()` reports a result.
+     */
+    bool isConnectInProgress() const { return _connectOp != ConnectOp::NONE; }
+
+    /**
+     * @brief Establishes a network connection based on the current `_preference`, blocking until done.
+     * A wrapper of `startConnect()` and `pollConnect()` for `setup()`; the network worker uses those directly.
      * - If `_preference` is `WIFI_ONLY` or `GPRS_ONLY`, it attempts connection only on that interface.
      * - If `_preference` is `WIFI_PREFERRED`, it tries WiFi first. If WiFi fails and GPRS is available, it attempts GPRS.
      * - If `_preference` is `GPRS_PREFERRED`, it tries GPRS first. If GPRS fails and WiFi is available, it attempts WiFi.
@@ -100,7 +162,7 @@ public:
      * @brief Disconnects the currently active network interface.
      *
      * If `_activeInterface` is not `nullptr`, its `disconnect()` method is called.
-     * The `_activeInterface` is then set to `nullptr`.
+     * The `_activeInterface` is then set to `nullptr`. The request in flight is requeued for the next connection.
      */
     void disconnect() override;
     /**
@@ -111,39 +173,90 @@ public:
      */
     bool isConnected() const override;
     /**
-     * @brief Initiates an asynchronous HTTP request.
+     * @brief Queues an asynchronous HTTP request with `HttpRequestPriority::NORMAL`.
      *
-     * If the facade is not currently connected, it will first attempt to establish a connection
-     * by calling its own `connect()` method (which respects the current `NetworkPreference`).
-     * If a connection is active or successfully established, it then delegates the HTTP request
-     * to the `_activeInterface->startAsyncHttpRequest()` method.
+     * If the facade is not currently connected the request fails at once; reconnecting is left
+     * to the caller (the network worker's backoff). If a connection is active, the request is copied into the
+     * `_requestQueue` and started on `_activeInterface` as soon as that interface is idle.
+     * Equivalent to `enqueueHttpRequest(..., HttpRequestPriority::NORMAL)`.
      *
      * @param url The target URL for the HTTP request.
      * @param method The HTTP method (e.g., "GET", "POST").
      * @param apiType A user-defined string categorizing the API call (for logging/debugging).
      * @param payload The request body (typically for POST requests, `nullptr` for GET).
-     * @param cb The callback function `std::function<bool(JsonDocument& doc)>` to be invoked with the
+     * @param cb The `HttpResponseCallback` to be invoked with the
      *           parsed JSON response.
      * @param needsAuth If `true`, an authorization token (if configured in the active manager) will be included.
      *
-     * @return `true` if `_activeInterface` is valid, connected, and successfully initiated the request.
-     * @return `false` if there's no active connected interface or the active interface failed to start the request.
+     * @return `true` if a connection is available and the request was queued (or coalesced with an identical queued GET).
+     * @return `false` if not connected or the queue rejected the request.
      */
     bool startAsyncHttpRequest(
         const char* url,
         const char* method,
         const char* apiType,
         const char* payload,
-        std::function<bool(JsonDocument& doc)> cb,
+        const HttpResponseCallback& cb,
         bool needsAuth = true
     ) override;
     /**
-     * @brief Updates the state of any ongoing asynchronous HTTP operations for the active network interface.
+     * @brief Queues an asynchronous HTTP request with an explicit priority.
      *
-     * This method must be called repeatedly in the main application loop. It delegates to
-     * `_activeInterface->updateHttpOperations()` if `_activeInterface` is not `nullptr`.
+     * The URL, method, API type and payload are copied into a preallocated `HttpRequestDescriptor`,
+     * so the caller's buffers may be reused immediately. Requests are dispatched most-urgent first
+     * and FIFO within a priority level. If the request can be started right away it is dispatched
+     * before this method returns.
+     *
+     * @param url The target URL for the HTTP request.
+     * @param method The HTTP method (e.g., "GET", "POST").
+     * @param apiType A user-defined string categorizing the API call (for logging/debugging).
+     * @param payload The request body (typically for POST requests, `nullptr` for GET).
+     * @param cb The callback invoked with the parsed JSON response. May be empty.
+     * @param needsAuth If `true`, an authorization token will be included.
+     * @param priority Scheduling priority, e.g. `HttpRequestPriority::URGENT` for relay status uplinks.
+     * @param tag Caller's id for the request, reported to the retire observer if the request ends without its
+     *            callback running; 0 for none.
+     *
+     * @return `true` if a connection is available and the request was queued.
+     * @return `false` if not connected or the queue rejected the request.
+     */
+    bool enqueueHttpRequest(
+        const char* url,
+        const char* method,
+        const char* apiType,
+        const char* payload,
+        const HttpResponseCallback& cb,
+        bool needsAuth,
+        HttpRequestPriority priority,
+        uint16_t tag = 0
+    );
+    /**
+     * @brief Sets the observer told the tag of each request that ends without its callback running
+     *        (see `HttpRequestQueue::setRetireObserver()`).
+     * Besides requests the queue discards, this covers every dispatched request that finishes unanswered: a transport
+     * error, an error status the manager does not pass to the callback, an abort, or a response that failed to parse.
+     * A `304` counts as answered; it is reported through the response observer instead.
+     * @param observer Called from the facade's methods on the caller's task; may be empty.
+     */
+    void setRetireObserver(HttpRequestQueue::RetireObserver observer) { _requestQueue.setRetireObserver(observer); }
+    /**
+     * @brief Updates the state of any ongoing asynchronous HTTP operations and dispatches queued requests.
+     *
+     * This method must be called repeatedly in the main application loop. It first advances a connect in
+     * progress, or otherwise checks the active WiFi link for a loss and fails over. It then delegates to
+     * `_activeInterface->updateHttpOperations()` if `_activeInterface` is not `nullptr`, releases the finished
+     * request's descriptor, and starts the next queued request if the active interface is connected and idle.
      */
     void updateHttpOperations() override;
+    /**
+     * @brief Checks whether the facade has HTTP work outstanding.
+     * @return `true` if the active interface has a request in flight or requests are waiting in `_requestQueue`.
+     */
+    bool isHttpOperationActive() const override;
+    /**
+     * @brief Aborts the request in flight on the interface it was dispatched on and discards it. Queued requests stay.
+     */
+    void abortHttpOperation() override;
     /**
      * @brief Retrieves a human-readable status string from the active network interface.
      *
@@ -151,15 +264,28 @@ public:
      * prefixed (e.g., "WIFI: " or "GPRS: ") to indicate the source.
      * If no interface is active, a message like "No active network interface." is returned.
      *
-     * @return `String` containing the current status of the active network connection or state of the facade.
+     * @return The current status of the active network connection or state of the facade, held inline.
      */
-    String getStatusString() const override;
+    NetworkStatusString getStatusString() const override;
+    /**
+     * @brief Sets an observer told about every finished request, after the facade updated its validator cache.
+     * Conditional requests are managed by the facade itself, so `setConditionalRequest()` is not forwarded.
+     * @param observer Called from `updateHttpOperations()`; may be empty.
+     */
+    void setResponseObserver(ResponseObserver observer) override { _responseObserver = observer; }
+    /**
+     * @brief Gets the spare push socket of the active interface.
+     * The socket changes when the facade switches between WiFi and GPRS; callers holding a session on the old
+     * one must reconnect on the new one.
+     * @return The active interface's `getPushClient()`, or `nullptr` if no interface is connected.
+     */
+    Client* getPushClient() override;
 
     // Additional methods specific to facade
     /**
-     * @brief Attempts to explicitly switch the active network interface to WiFi.
+     * @brief Attempts to explicitly switch the active network interface to WiFi, blocking until done.
      *
-     * This method first tries to connect using the `_wifiManagerRaw`. If successful and
+     * A wrapper of `startSwitchToWiFi()` and `pollConnect()`. If WiFi connects and
      * the `_gprsManagerRaw` was previously active and connected, GPRS will be disconnected.
      * The `_activeInterface` is updated accordingly via `determineActiveInterface()`.
      * The network preference `_preference` is not changed by this call.
@@ -237,6 +363,40 @@ public:
      */
     bool isSafeModeActive() const;
 
+    /**
+     * @brief Gets the request queue statistics (depth, high-water mark, drops and wait times).
+     * @return Reference to the statistics of `_requestQueue`.
+     */
+    const HttpRequestQueue::Stats& getRequestQueueStats() const;
+
+    /**
+     * @brief Gets the conditional request counters (304s, bytes and parse time saved, GPRS savings in the last hour).
+     * @param nowMs Current `millis()`, for the hourly window.
+     * @return Copy of the validator cache statistics.
+     */
+    HttpValidatorCache::Stats getValidatorStats(unsigned long nowMs) const { return _validatorCache.getStats(nowMs); }
+
+    /**
+     * @struct FailoverStats
+     * @brief WiFi link losses while WiFi was the active interface, and how long traffic took to resume.
+     * Times run from the WiFi disconnect event.
+     */
+    struct FailoverStats {
+        uint32_t failovers;           ///< Losses answered by switching to the warm GPRS link at once.
+        uint32_t coldFailovers;       ///< Losses with GPRS not attached; left to the reconnect backoff.
+        uint32_t reissued;            ///< Requests in flight that were requeued because their interface was lost or switched.
+        unsigned long lastSwitchMs;   ///< Loss to a connected active interface, latest loss.
+        unsigned long maxSwitchMs;    ///< Longest such time.
+        unsigned long lastRecoveryMs; ///< Loss to the first HTTP response received afterwards, latest loss.
+        unsigned long maxRecoveryMs;  ///< Longest such time.
+    };
+
+    /**
+     * @brief Gets the failover counters and times.
+     * @return Reference to the statistics.
+     */
+    const FailoverStats& getFailoverStats() const { return _failoverStats; }
+
 private:
     NetworkPreference _preference; ///< The configured strategy for selecting network interfaces (e.g., WiFi only, WiFi preferred with GPRS fallback).
     std::unique_ptr<WiFiManager> _wifiManagerOwned; ///< Manages the `WiFiManager` if its lifetime is owned by this facade (passed via `std::unique_ptr` in constructor). Will be `nullptr` if `WiFiManager` is externally managed.
@@ -247,6 +407,97 @@ private:
     // char _apiResponse[NETWORK_MAX_RESPONSE_LEN]; // Removed: This buffer was initialized but not used by the facade. Response handling is delegated.
 
     NetworkInterface* _activeInterface; ///< Pointer to the currently selected and active network interface (either `_wifiManagerRaw` or `_gprsManagerRaw`). It is `nullptr` if no interface is currently active.
+    HttpRequestQueue _requestQueue;     ///< Requests waiting for `_activeInterface` to become idle. Preallocated; no per-request heap use.
+    HttpValidatorCache _validatorCache; ///< Validators of polled GET endpoints; consulted before each GET is dispatched.
+    bool _inFlightIsGet;                ///< The request last dispatched is a GET, so its response may update `_validatorCache`.
+    NetworkInterface* _inFlightOn;      ///< Interface running `_requestQueue.inFlight()`, or `nullptr` if none.
+    bool _inFlightAnswered;             ///< The in-flight request's callback ran, or it got a `304`.
+    uint32_t _bootNonce;                ///< Random per boot; prefix of every idempotency key, so keys do not repeat after a reboot.
+    ResponseObserver _responseObserver; ///< Outer observer set via `setResponseObserver()`; may be empty.
+
+    /**
+     * @enum ConnectOp
+     * @brief Connect operation advanced by `pollConnect()`.
+     */
+    enum class ConnectOp : uint8_t {
+        NONE,          ///< Nothing in progress.
+        CONNECT,       ///< `startConnect()` is waiting for WiFi.
+        SWITCH_TO_WIFI ///< `startSwitchToWiFi()` is waiting for WiFi, then for GPRS to go idle.
+    };
+    ConnectOp _connectOp;               ///< Operation in progress.
+    ConnectProgress _connectResult;     ///< Result of the last finished operation.
+    bool _holdDispatch;                 ///< WiFi is up during a switch; queued requests wait for it instead of going out on GPRS.
+
+    FailoverStats _failoverStats;       ///< Failover counters and times.
+    unsigned long _linkLostAtMs;        ///< Disconnect event of the latest WiFi loss.
+    bool _switchPending;                ///< `lastSwitchMs` of the latest loss is not recorded yet.
+    bool _recoveryPending;              ///< `lastRecoveryMs` of the latest loss is not recorded yet.
+
+    /**
+     * @brief Checks whether GPRS is kept attached as a standby while WiFi is primary.
+     * @return `true` with `WIFI_PREFERRED`, `ENABLE_GPRS_WARM_STANDBY` and a GPRS manager.
+     */
+    bool isWarmStandby() const;
+
+    /**
+     * @brief Watches the active WiFi link and fails over when it drops; records the switch time once traffic can flow.
+     * Uses `WiFiManager::updateConnection()`, which acts on the disconnect event. Runs while no connect is in progress.
+     * @param nowMs Current `millis()`.
+     */
+    void serviceFailover(unsigned long nowMs);
+
+    /**
+     * @brief Handles a WiFi link loss: aborts and requeues the request in flight on WiFi and re-selects the active
+     *        interface, which is GPRS if it is attached.
+     * @param lostAtMs `millis()` of the disconnect event.
+     */
+    void failOver(unsigned long lostAtMs);
+
+    /**
+     * @brief Releases the finished in-flight request, retiring it if it was not answered.
+     */
+    void finishInFlight();
+
+    /**
+     * @brief Runs the in-flight request's callback; the managers are handed this in its place.
+     * @param doc Parsed response body.
+     * @return The callback's result.
+     */
+    bool relayInFlightResponse(JsonDocument& doc);
+
+    /**
+     * @brief Takes the request in flight back from `_inFlightOn`: aborts it there and requeues it for re-issue.
+     * A request its interface already finished is released instead, so it is never sent twice.
+     */
+    void migrateInFlight();
+
+    /**
+     * @brief Ends the connect operation, records its result and calls `determineActiveInterface()`.
+     * @param ok Whether a connection was established.
+     * @return The recorded result.
+     */
+    ConnectProgress finishConnect(bool ok);
+
+    /**
+     * @brief Registers the facade's response observer with both managers.
+     */
+    void attachResponseObservers();
+
+    /**
+     * @brief Updates `_validatorCache` from a finished request and forwards the outcome to `_responseObserver`.
+     * @param url Request URL.
+     * @param info Response outcome.
+     * @param overGprs `true` if reported by the GPRS manager.
+     */
+    void onInterfaceResponse(const char* url, const HttpResponseInfo& info, bool overGprs);
+
+    /**
+     * @brief Starts the most urgent queued request if `_activeInterface` is connected and idle.
+     *
+     * A request that the interface refuses despite being connected and idle (e.g., a malformed URL)
+     * is discarded so it cannot block the queue; it is counted as a drop.
+     */
+    void dispatchQueuedRequest();
 
     /**
      * @brief Selects and sets the `_activeInterface` based on the current `_preference`,
@@ -255,6 +506,7 @@ private:
      * This core internal method implements the logic for choosing which interface to use.
      * It is invoked during initialization, when `setPreference()` is called, or potentially
      * after connection attempts to handle fallback logic as defined by `_preference`.
+     * If the selection moves away from the interface running the request in flight, that request is migrated.
      * For example, if `_preference` is `WIFI_PREFERRED` and WiFi is available, `_activeInterface`
      * will be set to `_wifiManagerRaw`. If WiFi subsequently fails to connect and GPRS is available,
      * this method might then set `_activeInterface` to `_gprsManagerRaw`.
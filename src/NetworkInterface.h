@@ -2,10 +2,18 @@
 #define NETWORK_INTERFACE_H
 
 #include <functional> // For std::function
+#include <Client.h> // For Client (spare push socket)
 #include <ArduinoJson.h> // For JsonDocument
+#include "HttpValidatorCache.h" // For HttpValidators and HttpResponseInfo
+#include "HttpRequestQueue.h" // For HttpResponseCallback
+#include "FixedString.h" // For NetworkStatusString
+#include "config.h" // For NETWORK_STATUS_MAX_LEN, IP_ADDRESS_MAX_LEN
 
 // class JsonDocument; // No longer needed, full include above
 
+typedef FixedString<NETWORK_STATUS_MAX_LEN> NetworkStatusString; ///< Status line returned by value without heap use.
+typedef FixedString<IP_ADDRESS_MAX_LEN> IpAddressString;         ///< Dotted-quad IPv4 address.
+
 /**
  * @brief Abstract base class defining the interface for network management.
  *
@@ -15,6 +23,11 @@
  */
 class NetworkInterface {
 public:
+    /**
+     * @brief Observer invoked once per finished HTTP transaction with the request URL and its outcome.
+     */
+    using ResponseObserver = std::function<void(const char* url, const HttpResponseInfo& info)>;
+
     /**
      * @brief Virtual destructor for proper cleanup of derived classes.
      */
@@ -43,7 +56,9 @@ public:
      * @param url The target URL for the request.
      * @param method HTTP method (e.g., "GET", "POST").
      * @param apiType A string descriptor for the type of API call (for logging/debugging).
-     * @param payload The request body (e.g., JSON string for POST). Null or empty for GET.
+     * @param payload The request body (e.g., JSON string for POST). Null or empty for GET. The managers keep the
+     *                pointer instead of a copy, so it must stay valid until the operation finishes or is aborted;
+     *                `NetworkFacade` copies it into its `HttpRequestQueue`, which holds the slot until then.
      * @param cb Callback function to process the JSON response.
      *           Takes a JsonDocument&, returns true if processing was successful.
      * @param needsAuth Boolean indicating if the request requires an authorization header. Defaults to true.
@@ -54,10 +69,43 @@ public:
         const char* method,
         const char* apiType,
         const char* payload,
-        std::function<bool(JsonDocument& doc)> cb,
+        const HttpResponseCallback& cb,
         bool needsAuth = true
     ) = 0;
 
+    /**
+     * @brief Makes the next `startAsyncHttpRequest()` a conditional GET.
+     * The validators are copied; they apply to the next started request only. A `304` reply to that request
+     * completes successfully without reading a body or invoking its callback.
+     * The default implementation ignores the call (interface without conditional request support).
+     * @param validators Validators of the last full response, or `nullptr` for an unconditional request.
+     */
+    virtual void setConditionalRequest(const HttpValidators* validators) { (void)validators; }
+
+    /**
+     * @brief Sends an `Idempotency-Key` header with the next `startAsyncHttpRequest()` and its retries.
+     * The caller keeps the key of a request across re-issues, so the server can drop a POST it already applied.
+     * The key is copied; it applies to the next started request only.
+     * The default implementation ignores the call.
+     * @param key Header value, or `nullptr` for none.
+     */
+    virtual void setIdempotencyKey(const char* key) { (void)key; }
+
+    /**
+     * @brief Sets the observer told about every finished HTTP transaction (status, validators, body size, parse time).
+     * The default implementation ignores the call.
+     * @param observer Called from `updateHttpOperations()`; may be empty.
+     */
+    virtual void setResponseObserver(ResponseObserver observer) { (void)observer; }
+
+    /**
+     * @brief Gets the interface's spare TCP socket for a long-lived connection outside the HTTP path (the MQTT push session).
+     * The socket is not part of the HTTP connection pool and is closed by `disconnect()`.
+     * The default implementation returns `nullptr` (no spare socket).
+     * @return Socket owned by the interface, or `nullptr`.
+     */
+    virtual Client* getPushClient() { return nullptr; }
+
     /**
      * @brief Processes any ongoing asynchronous HTTP operations.
      * This method should be called repeatedly from the main loop to drive the state
@@ -65,12 +113,27 @@ public:
      */
     virtual void updateHttpOperations() = 0;
 
+    /**
+     * @brief Checks whether an asynchronous HTTP operation is currently in progress.
+     * Callers that multiplex several requests over one interface (e.g., `NetworkFacade`)
+     * use this to decide when the next request can be started.
+     * @return true if a request is in flight and a new one would be rejected, false otherwise.
+     */
+    virtual bool isHttpOperationActive() const = 0;
+
+    /**
+     * @brief Abandons the HTTP operation in flight, if any, without calling its callback or retrying it.
+     * The socket is closed and the interface becomes idle at once. Used when the link the request went out on
+     * is lost, so the caller can issue the request again elsewhere.
+     */
+    virtual void abortHttpOperation() = 0;
+
     /**
      * @brief Provides a general status string for the network interface.
      * Useful for display purposes (e.g., on an LCD).
-     * @return String containing the current status.
+     * @return The current status, truncated to `NETWORK_STATUS_MAX_LEN - 1` characters.
      */
-    virtual String getStatusString() const = 0;
+    virtual NetworkStatusString getStatusString() const = 0;
 };
 
 #endif // NETWORK_INTERFACE_H
\ No newline at end of file
@@ -0,0 +1,573 @@
+#include "NetworkWorker.h"
+#include "WiFiManager.h"
+#include "GPRSManager.h"
+#include <esp_task_wdt.h>
+
+/**
+ * @brief Constructs the worker. No task is started until `begin()`.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+NetworkWorker::NetworkWorker(NetworkFacade& facade, const DeviceConfig& config, DeviceState& state) :
+    _facade(facade),
+    _config(config),
+    _state(state),
+    _task(nullptr),
+    _controlTask(nullptr),
+    _nextCallbackId(1),
+    _rejectedRequests(0),
+    _driftCheckPending(false),
+    _modemFailReported(false),
+    _sntp(_sntpUdp),
+    _sntpFallback(false),
+    _connectAttempt(ConnectAttempt::NONE),
+    _timeSyncRequested(false),
+    _connected(facade.isConnected()),
+    _onWiFi(false),
+    _pushConnected(false),
+    _droppedEvents(0),
+    _bulkInUse(false),
+    _statsSnapshot(facade.getRequestQueueStats()),
+    _statsLock(portMUX_INITIALIZER_UNLOCKED) {
+    for (PendingCallback& p : _pending) {
+        p.id = 0;
+        p.submittedAtMs = 0;
+    }
+    memset(&_wifiConnSnapshot, 0, sizeof(_wifiConnSnapshot));
+    memset(&_gprsConnSnapshot, 0, sizeof(_gprsConnSnapshot));
+    memset(&_validatorSnapshot, 0, sizeof(_validatorSnapshot));
+    memset(&_wifiConnectSnapshot, 0, sizeof(_wifiConnectSnapshot));
+    memset(&_failoverSnapshot, 0, sizeof(_failoverSnapshot));
+    memset(&_pushSnapshot, 0, sizeof(_pushSnapshot));
+}
+
+/**
+ * @brief Starts the worker task.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+bool NetworkWorker::begin() {
+    if (_task) return true;
+    _controlTask = xTaskGetCurrentTaskHandle();
+    // Runs on the worker task: a 304 skips the response callback, so tell the control loop instead.
+    _facade.setResponseObserver([this](const char* url, const HttpResponseInfo& info) {
+        if (info.notModified) postEvent(NetworkEventKind::HTTP_NOT_MODIFIED, info.tag, 0, url);
+    });
+    // Also on the worker task: a request that ended without running its callback (failed, discarded, coalesced)
+    // never replies, so free its callback slot now rather than at the timeout.
+    _facade.setRetireObserver([this](uint16_t tag) { postEvent(NetworkEventKind::HTTP_FAILED, tag, 0, nullptr); });
+    if (_mqtt.begin(_config.mqtt_host, _config.mqtt_port, _config.gh_id, _config.api_token)) {
+        _mqtt.setMessageHandler([this](MqttTopic topic, const uint8_t* payload, unsigned int len) -> bool {
+            return postPush(topic, payload, len);
+        });
+    }
+    BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "net_worker", NETWORK_WORKER_STACK_SIZE, this,
+                                            NETWORK_WORKER_PRIORITY, &_task, NETWORK_WORKER_CORE);
+    if (ok != pdPASS) {
+        _task = nullptr;
+        DEBUG_PRINTLN(1, "NetworkWorker: Task creation failed.");
+        return false;
+    }
+    // WiFi link events wake the worker, so a link loss fails over now rather than after the idle tick.
+    if (_facade.getWiFiManager()) _facade.getWiFiManager()->setLinkEventTask(_task);
+    DEBUG_PRINTF(3, "NetworkWorker: Started on core %d.\n", NETWORK_WORKER_CORE);
+    return true;
+}
+
+/**
+ * @brief Queues an HTTP request for the worker (control loop side).
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+bool NetworkWorker::submit(const char* url, const char* method, const char* apiType, const char* payload,
+                           const HttpResponseCallback& cb, bool needsAuth,
+                           HttpRequestPriority priority) {
+    if (!url || !method) return false;
+    size_t payloadLen = payload ? strlen(payload) : 0;
+    bool bulk = payloadLen >= HTTP_REQUEST_PAYLOAD_MAX_LEN;
+    if (payloadLen >= HTTP_BULK_PAYLOAD_MAX_LEN) {
+        DEBUG_PRINTF(1, "NetworkWorker: Payload too large for %s.\n", apiType ? apiType : "?");
+        _rejectedRequests++;
+        return false;
+    }
+    if (bulk && !isBulkBufferFree()) {
+        DEBUG_PRINTF(2, "NetworkWorker: Bulk buffer busy, rejecting %s.\n", apiType ? apiType : "?");
+        _rejectedRequests++;
+        return false;
+    }
+
+    PendingCallback* slot = nullptr;
+    if (cb) {
+        slot = findPending(0);
+        if (!slot) {
+            DEBUG_PRINTF(1, "NetworkWorker: No callback slot for %s.\n", apiType ? apiType : "?");
+            _rejectedRequests++;
+            return false;
+        }
+    }
+
+    NetworkWorkerRequest* req = _requests.beginPush();
+    if (!req) {
+        DEBUG_PRINTF(1, "NetworkWorker: Request ring full, dropping %s.\n", apiType ? apiType : "?");
+        _rejectedRequests++;
+        return false;
+    }
+
+    strlcpy(req->url, url, sizeof(req->url));
+    strlcpy(req->method, method, sizeof(req->method));
+    strlcpy(req->apiType, apiType ? apiType : "", sizeof(req->apiType));
+    if (bulk) {
+        // Published to the worker by commitPush() below.
+        memcpy(_bulkPayload, payload, payloadLen + 1);
+        _bulkInUse.store(true, std::memory_order_relaxed);
+        req->payload[0] = '\0';
+    } else {
+        strlcpy(req->payload, payload ? payload : "", sizeof(req->payload));
+    }
+    req->bulkPayload = bulk;
+    req->needsAuth = needsAuth;
+    req->priority = priority;
+    req->callbackId = 0;
+
+    if (slot) {
+        slot->id = _nextCallbackId++;
+        if (_nextCallbackId == 0) _nextCallbackId = 1;
+        slot->submittedAtMs = millis();
+        slot->cb = cb;
+        req->callbackId = slot->id;
+    }
+    _requests.commitPush();
+    if (_task) xTaskNotifyGive(_task);
+    return true;
+}
+
+/**
+ * @brief Blocks until an event is posted or the timeout passes.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+bool NetworkWorker::waitForEvent(unsigned long timeoutMs) {
+    if (_events.front() != nullptr) return true;
+    return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs)) > 0;
+}
+
+/**
+ * @brief Processes pending events on the control loop.
+ * Responses are parsed into one long-lived document. In ArduinoJson 7 `StaticJsonDocument` is only a deprecated
+ * alias of the heap-backed `JsonDocument` (the size argument is ignored), so each parse does allocate from the heap
+ * and `clear()` frees it again; only the document object itself is static.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+void NetworkWorker::pollEvents() {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    static StaticJsonDocument<JSON_DOC_SIZE_DEVICE_CONFIG> doc;
+#pragma GCC diagnostic pop
+
+    NetworkWorkerEvent* ev;
+    while ((ev = _events.front()) != nullptr) {
+        if (ev->kind == NetworkEventKind::HTTP_RESPONSE || ev->kind == NetworkEventKind::HTTP_FAILED) {
+            PendingCallback* p = findPending(ev->callbackId);
+            if (!p) {
+                DEBUG_PRINTF(2, "NetworkWorker: Reply for unknown/expired callback %u.\n", ev->callbackId);
+            } else {
+                if (ev->kind == NetworkEventKind::HTTP_RESPONSE) {
+                    doc.clear();
+                    DeserializationError err = deserializeJson(doc, (const char*)ev->body, ev->len);
+                    if (err) DEBUG_PRINTF(1, "NetworkWorker: Response %u JSON error: %s\n", ev->callbackId, err.c_str());
+                    else p->cb(doc);
+                }
+                p->id = 0;
+                p->cb = nullptr;
+            }
+        } else if (ev->kind == NetworkEventKind::HTTP_NOT_MODIFIED) {
+            // The caller's data is current; free the callback of the request that got the 304. A same-URL GET
+            // queued behind it is a separate request with its own reply (coalesced polls were already retired).
+            PendingCallback* p = findPending(ev->callbackId);
+            if (p) {
+                p->id = 0;
+                p->cb = nullptr;
+            }
+            if (_eventHandler) _eventHandler(*ev);
+        } else if (ev->kind == NetworkEventKind::PUSH_MESSAGE) {
+            doc.clear();
+            DeserializationError err = deserializeJson(doc, (const char*)ev->body, ev->len);
+            if (err) DEBUG_PRINTF(1, "NetworkWorker: Push message JSON error: %s\n", err.c_str());
+            else if (_pushHandler) _pushHandler(static_cast<MqttTopic>(ev->callbackId), doc);
+        } else if (_eventHandler) {
+            _eventHandler(*ev);
+        }
+        _events.pop();
+    }
+
+    unsigned long now = millis();
+    for (PendingCallback& p : _pending) {
+        if (p.id != 0 && now - p.submittedAtMs >= NETWORK_WORKER_CALLBACK_TIMEOUT_MS) {
+            DEBUG_PRINTF(2, "NetworkWorker: Callback %u expired without a reply.\n", p.id);
+            p.id = 0;
+            p.cb = nullptr;
+        }
+    }
+}
+
+/**
+ * @brief Gets a snapshot of the facade's request queue statistics.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+HttpRequestQueue::Stats NetworkWorker::getRequestQueueStats() const {
+    portENTER_CRITICAL(&_statsLock);
+    HttpRequestQueue::Stats copy = _statsSnapshot;
+    portEXIT_CRITICAL(&_statsLock);
+    return copy;
+}
+
+/**
+ * @brief Gets a snapshot of the conditional request counters.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+HttpValidatorCache::Stats NetworkWorker::getValidatorStats() const {
+    portENTER_CRITICAL(&_statsLock);
+    HttpValidatorCache::Stats copy = _validatorSnapshot;
+    portEXIT_CRITICAL(&_statsLock);
+    return copy;
+}
+
+/**
+ * @brief Gets a snapshot of one interface's keep-alive statistics.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+HttpConnectionPool::Stats NetworkWorker::getConnectionStats(bool wifi) const {
+    portENTER_CRITICAL(&_statsLock);
+    HttpConnectionPool::Stats copy = wifi ? _wifiConnSnapshot : _gprsConnSnapshot;
+    portEXIT_CRITICAL(&_statsLock);
+    return copy;
+}
+
+/**
+ * @brief Gets a snapshot of the WiFi connect counters and time-to-IP.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+WiFiManager::ConnectStats NetworkWorker::getWiFiConnectStats() const {
+    portENTER_CRITICAL(&_statsLock);
+    WiFiManager::ConnectStats copy = _wifiConnectSnapshot;
+    portEXIT_CRITICAL(&_statsLock);
+    return copy;
+}
+
+/**
+ * @brief Gets a snapshot of the failover counters and times.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+NetworkFacade::FailoverStats NetworkWorker::getFailoverStats() const {
+    portENTER_CRITICAL(&_statsLock);
+    NetworkFacade::FailoverStats copy = _failoverSnapshot;
+    portEXIT_CRITICAL(&_statsLock);
+    return copy;
+}
+
+/**
+ * @brief Gets a snapshot of the MQTT session counters.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+MqttManager::Stats NetworkWorker::getPushStats() const {
+    portENTER_CRITICAL(&_statsLock);
+    MqttManager::Stats copy = _pushSnapshot;
+    portEXIT_CRITICAL(&_statsLock);
+    return copy;
+}
+
+/**
+ * @brief Gets a snapshot of the SNTP counters.
+ * Refer to NetworkWorker.h for detailed documentation.
+ */
+SntpClient::Stats NetworkWorker::getSntpStats() const {
+    portENTER_CRITICAL(&_statsLock);
+    SntpClient::Stats copy = _sntpSnapshot;
+    portEXIT_CRITICAL(&_statsLock);
+    return copy;
+}
+
+void NetworkWorker::taskEntry(void* arg) {
+    static_cast<NetworkWorker*>(arg)->run();
+}
+
+/**
+ * @brief Worker task body. Never returns.
+ * The task registers with the task watchdog; long blocking calls inside the managers already reset it.
+ * While a request or a connect is in flight it polls every `NETWORK_WORKER_TICK_MS`, and every `SNTP_POLL_TICK_MS`
+ * while an SNTP round runs; when idle it sleeps up to `NETWORK_WORKER_IDLE_TICK_MS` unless `submit()` wakes it.
+ */
+void NetworkWorker::run() {
+    esp_task_wdt_add(NULL);
+    for (;;) {
+        esp_task_wdt_reset();
+        unsigned long now = millis();
+
+        serviceTimeSync(); // First, so SNTP replies are timestamped before the slower services run.
+        drainRequests();
+        _facade.updateHttpOperations();
+        GPRSManager* gprs = _facade.getGPRSManager();
+        if (gprs) {
+            gprs->updateFSM();
+            // The LCD belongs to the control loop; a modem that gave up is shown there via a status event.
+            bool modemFailed = gprs->getGprsState() == GPRSState::GPRS_STATE_ERROR_MODEM_FAIL;
+            if (!modemFailed) _modemFailReported = false;
+            else if (!_modemFailReported) _modemFailReported = postEvent(NetworkEventKind::STATUS_MESSAGE, 0, 0, "Modem Fail");
+        }
+        maintainConnection(now);
+        servicePush(now);
+        publishStatus();
+
+        bool busy = _facade.isHttpOperationActive() || _facade.isConnectInProgress() || _requests.front() != nullptr;
+        unsigned long tickMs = _sntp.isBusy() ? SNTP_POLL_TICK_MS : (busy ? NETWORK_WORKER_TICK_MS : NETWORK_WORKER_IDLE_TICK_MS);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(tickMs));
+    }
+}
+
+/**
+ * @brief Moves submitted requests into the facade queue, wrapping callbacks so replies become events.
+ */
+void NetworkWorker::drainRequests() {
+    NetworkWorkerRequest* req;
+    while ((req = _requests.front()) != nullptr) {
+        uint16_t id = req->callbackId;
+        HttpResponseCallback relay;
+        if (id != 0) {
+            relay = [this, id](JsonDocument& doc) -> bool { return postResponse(id, doc); };
+        }
+        const char* body = req->bulkPayload ? _bulkPayload : (req->payload[0] ? req->payload : nullptr);
+        bool queued = _facade.enqueueHttpRequest(req->url, req->method, req->apiType, body,
+                                                 relay, req->needsAuth, req->priority, id);
+        if (req->bulkPayload) _bulkInUse.store(false, std::memory_order_release); // The facade queue holds its own copy.
+        if (!queued && id != 0) postEvent(NetworkEventKind::HTTP_FAILED, id, 0, nullptr);
+        _requests.pop();
+    }
+}
+
+/**
+ * @brief Reconnects with exponential backoff and periodically tries to move from GPRS back to WiFi.
+ * Same policy the control loop used to run inline; status is reported through events. Connects are started here
+ * and advanced by `NetworkFacade::updateHttpOperations()`, so requests keep flowing on the current link meanwhile.
+ */
+void NetworkWorker::maintainConnection(unsigned long now) {
+    if (_connectAttempt != ConnectAttempt::NONE) {
+        if (_facade.isConnectInProgress()) return;
+        bool ok = _facade.pollConnect() == NetworkFacade::ConnectProgress::CONNECTED;
+        ConnectAttempt attempt = _connectAttempt;
+        _connectAttempt = ConnectAttempt::NONE;
+
+        if (attempt == ConnectAttempt::RECONNECT) {
+            if (ok) {
+                _state.currentConnectionRetryDelayMs = INITIAL_RETRY_DELAY_MS;
+                DEBUG_PRINTF(3, "Net Reconnect OK: %s", _facade.getStatusString().c_str());
+                postEvent(NetworkEventKind::CONNECTED, 0, 0, "Net Reconnect OK");
+                _driftCheckPending = true;
+            } else {
+                _state.currentConnectionRetryDelayMs *= 2;
+                if (_state.currentConnectionRetryDelayMs > MAX_RETRY_DELAY_MS) _state.currentConnectionRetryDelayMs = MAX_RETRY_DELAY_MS;
+                postEvent(NetworkEventKind::STATUS_MESSAGE, 0, 0, "Net Reconnect Wait...");
+            }
+            // The backoff runs from the end of the attempt, as it did when connect() blocked.
+            _state.lastConnectionRetryTime = now;
+        } else if (ok) {
+            DEBUG_PRINTF(3, "Switched to WiFi: %s", _facade.getStatusString().c_str());
+            postEvent(NetworkEventKind::CONNECTED, 0, 0, "Switched to WiFi");
+            _driftCheckPending = true;
+            _state.currentWiFiSwitchBackoffDelayMs = WIFI_RETRY_WHEN_GPRS_MS;
+        } else {
+            DEBUG_PRINTLN_F(2, F("Failed to switch back to WiFi, staying on GPRS. Increasing backoff."));
+            _state.currentWiFiSwitchBackoffDelayMs *= 2;
+            if (_state.currentWiFiSwitchBackoffDelayMs > MAX_WIFI_RETRY_WHEN_GPRS_MS) {
+                _state.currentWiFiSwitchBackoffDelayMs = MAX_WIFI_RETRY_WHEN_GPRS_MS;
+            }
+            DEBUG_PRINTF(3, "Next WiFi switch attempt in %lu ms.", _state.currentWiFiSwitchBackoffDelayMs);
+        }
+        return;
+    }
+
+    if (!_facade.isConnected() && (now - _state.lastConnectionRetryTime >= _state.currentConnectionRetryDelayMs)) {
+        _state.lastConnectionRetryTime = now;
+        postEvent(NetworkEventKind::STATUS_MESSAGE, 0, 0, "Attempting network reconnect...");
+        _facade.startConnect(); // An immediate failure is reported by pollConnect() on the next pass.
+        _connectAttempt = ConnectAttempt::RECONNECT;
+        return;
+    }
+
+    if (_facade.getPreference() == NetworkFacade::NetworkPreference::WIFI_PREFERRED &&
+        _facade.getWiFiManager() != nullptr &&
+        _facade.getCurrentInterface() == _facade.getGPRSManager() &&
+        _facade.isConnected() &&
+        (now - _state.lastWiFiRetryWhenGprsTime >= _state.currentWiFiSwitchBackoffDelayMs)) {
+        _state.lastWiFiRetryWhenGprsTime = now;
+        DEBUG_PRINTF(3, "Attempting to switch back to WiFi (backoff: %lu ms)...", _state.currentWiFiSwitchBackoffDelayMs);
+        _facade.startSwitchToWiFi();
+        _connectAttempt = ConnectAttempt::SWITCH_TO_WIFI;
+    }
+}
+
+/**
+ * @brief Fetches network time when requested and pumps the running SNTP round.
+ * SNTP on WiFi; the HTTP time API otherwise, or if no server answers a full request. After a reconnect only an
+ * SNTP drift check is made, as before.
+ */
+void NetworkWorker::serviceTimeSync() {
+    SntpClient::Result result = _sntp.poll();
+    if (result == SntpClient::Result::SYNCED) {
+        const SntpClient::Sample& sample = _sntp.getSample();
+        postEvent(NetworkEventKind::TIME_EPOCH, 0, sample.epoch, nullptr, sample.edgeUs);
+    } else if (result == SntpClient::Result::FAILED && _sntpFallback && _facade.isConnected()) {
+        DEBUG_PRINTLN(2, "SNTP failed, attempting HTTP time sync (async).");
+        requestHttpTime();
+    }
+
+    bool full = _timeSyncRequested.exchange(false, std::memory_order_acq_rel);
+    if (!full && !_driftCheckPending) return;
+    _driftCheckPending = false;
+    if (!_facade.isConnected()) return;
+
+    if (_sntp.isBusy()) { // Already measuring; its sample answers this request too.
+        _sntpFallback |= full;
+        return;
+    }
+    WiFiManager* wifi = _facade.getWiFiManager();
+    if (wifi && _facade.getCurrentInterface() == wifi && wifi->isConnected() && _sntp.start()) {
+        _sntpFallback = full;
+        return;
+    }
+    if (!full) return;
+
+    DEBUG_PRINTLN(2, "SNTP unavailable, attempting HTTP time sync (async).");
+    requestHttpTime();
+}
+
+/**
+ * @brief Queues a world time API request; its epoch is posted as a `TIME_EPOCH` event without `epochEdgeUs`.
+ */
+void NetworkWorker::requestHttpTime() {
+    _facade.enqueueHttpRequest(_config.worldtime_url, "GET", "WT_ASYNC_LP", nullptr,
+        [this](JsonDocument& d) -> bool {
+            if (!d["unixtime"].isNull() && d["unixtime"].is<uint32_t>()) {
+                uint32_t epoch = d["unixtime"].as<uint32_t>();
+                DEBUG_PRINTF(3, "Async WT LP CB: Epoch fetched: %lu\n", (unsigned long)epoch);
+                return postEvent(NetworkEventKind::TIME_EPOCH, 0, epoch, nullptr);
+            }
+            DEBUG_PRINTLN_F(1, F("Async WT LP CB: Failed to parse unixtime."));
+            return false;
+        }, false, HttpRequestPriority::BACKGROUND);
+}
+
+/**
+ * @brief Keeps the MQTT session on the active link and publishes its state.
+ * Pushed messages are posted from inside `_mqtt.loop()` by `postPush()`.
+ */
+void NetworkWorker::servicePush(unsigned long now) {
+    if (!_mqtt.isEnabled()) return;
+    _mqtt.loop(_facade.getPushClient(), now);
+    bool up = _mqtt.isConnected();
+    if (up != _pushConnected.load(std::memory_order_relaxed)) {
+        _pushConnected.store(up, std::memory_order_release);
+        postEvent(NetworkEventKind::STATUS_MESSAGE, 0, 0, up ? "Push channel up" : "Push down, polling");
+    }
+}
+
+/**
+ * @brief Publishes connection state and queue statistics for the control loop.
+ */
+void NetworkWorker::publishStatus() {
+    bool connected = _facade.isConnected();
+    WiFiManager* wifi = _facade.getWiFiManager();
+    _connected.store(connected, std::memory_order_release);
+    _onWiFi.store(connected && wifi && _facade.getCurrentInterface() == wifi, std::memory_order_release);
+
+    GPRSManager* gprs = _facade.getGPRSManager();
+    HttpValidatorCache::Stats validatorStats = _facade.getValidatorStats(millis());
+    portENTER_CRITICAL(&_statsLock);
+    _statsSnapshot = _facade.getRequestQueueStats();
+    if (wifi) _wifiConnSnapshot = wifi->getConnectionStats();
+    if (wifi) _wifiConnectSnapshot = wifi->getConnectStats();
+    _failoverSnapshot = _facade.getFailoverStats();
+    if (gprs) _gprsConnSnapshot = gprs->getConnectionStats();
+    _validatorSnapshot = validatorStats;
+    _pushSnapshot = _mqtt.getStats();
+    _sntpSnapshot = _sntp.getStats();
+    portEXIT_CRITICAL(&_statsLock);
+}
+
+/**
+ * @brief Posts an event with optional text. Worker side only.
+ * @return `false` if the event ring was full and the event was dropped.
+ */
+bool NetworkWorker::postEvent(NetworkEventKind kind, uint16_t callbackId, uint32_t epoch, const char* text, int64_t epochEdgeUs) {
+    NetworkWorkerEvent* ev = _events.beginPush();
+    if (!ev) {
+        _droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        DEBUG_PRINTF(1, "NetworkWorker: Event ring full, dropping event %d.\n", (int)kind);
+        return false;
+    }
+    ev->kind = kind;
+    ev->callbackId = callbackId;
+    ev->epoch = epoch;
+    ev->epochEdgeUs = epochEdgeUs;
+    ev->len = text ? strlcpy(ev->body, text, sizeof(ev->body)) : 0;
+    if (ev->len >= sizeof(ev->body)) ev->len = sizeof(ev->body) - 1;
+    if (!text) ev->body[0] = '\0';
+    _events.commitPush();
+    if (_controlTask) xTaskNotifyGive(_controlTask);
+    return true;
+}
+
+/**
+ * @brief Re-serializes a parsed (filtered) response into the event ring. Worker side only.
+ * @return `false` if the event could not be posted; a failure event is posted instead when possible.
+ */
+bool NetworkWorker::postResponse(uint16_t callbackId, JsonDocument& doc) {
+    if (measureJson(doc) >= NETWORK_WORKER_RESPONSE_MAX_LEN) {
+        DEBUG_PRINTF(1, "NetworkWorker: Response %u exceeds %d bytes.\n", callbackId, NETWORK_WORKER_RESPONSE_MAX_LEN);
+        postEvent(NetworkEventKind::HTTP_FAILED, callbackId, 0, nullptr);
+        return false;
+    }
+    NetworkWorkerEvent* ev = _events.beginPush();
+    if (!ev) {
+        _droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        DEBUG_PRINTF(1, "NetworkWorker: Event ring full, dropping response %u.\n", callbackId);
+        return false;
+    }
+    ev->kind = NetworkEventKind::HTTP_RESPONSE;
+    ev->callbackId = callbackId;
+    ev->epoch = 0;
+    ev->epochEdgeUs = 0;
+    ev->len = serializeJson(doc, ev->body, sizeof(ev->body));
+    _events.commitPush();
+    if (_controlTask) xTaskNotifyGive(_controlTask);
+    return true;
+}
+
+/**
+ * @brief Copies a pushed MQTT payload into the event ring. Worker side only; runs inside `_mqtt.loop()`.
+ * @return `false` if the ring is full, so the message is left unacknowledged and redelivered by the broker.
+ */
+bool NetworkWorker::postPush(MqttTopic topic, const uint8_t* payload, unsigned int len) {
+    if (len >= NETWORK_WORKER_RESPONSE_MAX_LEN) {
+        // Acknowledged and dropped: a redelivery would not fit either.
+        DEBUG_PRINTF(1, "NetworkWorker: Push message of %u bytes exceeds %d bytes.\n", len, NETWORK_WORKER_RESPONSE_MAX_LEN);
+        return true;
+    }
+    NetworkWorkerEvent* ev = _events.beginPush();
+    if (!ev) return false;
+    ev->kind = NetworkEventKind::PUSH_MESSAGE;
+    ev->callbackId = static_cast<uint16_t>(topic);
+    ev->epoch = 0;
+    ev->epochEdgeUs = 0;
+    memcpy(ev->body, payload, len);
+    ev->body[len] = '\0';
+    ev->len = len;
+    _events.commitPush();
+    if (_controlTask) xTaskNotifyGive(_controlTask);
+    return true;
+}
+
+/**
+ * @brief Finds a callback slot by id; id 0 finds a free slot. Control loop side only.
+ */
+NetworkWorker::PendingCallback* NetworkWorker::findPending(uint16_t id) {
+    for (PendingCallback& p : _pending) {
+        if (p.id == id) return &p;
+    }
+    return nullptr;
+}
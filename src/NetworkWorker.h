@@ -0,0 +1,325 @@
+/**
+ * @file NetworkWorker.h
+ * @brief Defines `NetworkWorker`, the FreeRTOS task that owns all network I/O.
+ *
+ * `NetworkFacade`, `WiFiManager` and `GPRSManager` block for long stretches (connects, modem AT exchanges,
+ * HTTP reads). `NetworkWorker` runs them on a dedicated task pinned to core 0
+ * (`NETWORK_WORKER_CORE`) so the control loop on core 1 only ever touches two lock-free queues:
+ * - Requests: the control loop `submit()`s a `NetworkWorkerRequest` descriptor; the worker drains the ring
+ *   into `NetworkFacade::enqueueHttpRequest()`, which keeps its priority scheduling.
+ * - Events: the worker re-serializes each (filtered) JSON response into a `NetworkWorkerEvent`, along with
+ *   connection status changes and fetched time. `pollEvents()` on the control loop decodes them and runs the
+ *   original callbacks, so application state is still only modified on core 1.
+ *
+ * Callbacks never cross cores: they stay in a small table on the control side and only their id travels
+ * with the request. The facade reports every request that ends without running its callback (transport error, error
+ * status, abort, or discarded from its queue as coalesced, evicted or dropped), and the worker relays that as
+ * `HTTP_FAILED`, so the slot is free again as soon as the outcome is known. `NETWORK_WORKER_CALLBACK_TIMEOUT_MS` is
+ * only a backstop for a report lost to a full event ring. A `304 Not Modified` reply arrives as `HTTP_NOT_MODIFIED` carrying the
+ * URL and the callback id of the request it answered: that callback is freed without running, and the event is
+ * passed to the handler so the application can note that its data is still current.
+ *
+ * After `begin()`, the worker also owns reconnection with backoff and switching back from GPRS to WiFi
+ * (the `DeviceState` retry fields), and the network half of RTC synchronization: an `SntpClient` round on WiFi,
+ * pumped every pass, with the HTTP time API as fallback. The control loop only applies the resulting epoch to the RTC.
+ * The LCD and RTC share the I2C bus and belong to the control loop: nothing on the worker task touches them, and the
+ * managers it runs take no display. Status lines (e.g. a GPRS modem that gave up) travel as `STATUS_MESSAGE` events.
+ *
+ * When a broker is configured the worker also keeps the `MqttManager` session on the active link. Pushed
+ * messages travel as `PUSH_MESSAGE` events and are parsed and handed to the push handler on the control loop;
+ * `isPushConnected()` tells the control loop when it can skip HTTP polling.
+ */
+#ifndef NETWORK_WORKER_H
+#define NETWORK_WORKER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <ArduinoJson.h>
+#include <WiFiUdp.h>
+#include "config.h"
+#include "SpscQueue.h"
+#include "HttpRequestQueue.h"
+#include "HttpConnectionPool.h"
+#include "NetworkFacade.h"
+#include "DeviceConfig.h"
+#include "DeviceState.h"
+#include "SntpClient.h"
+#include "MqttManager.h"
+#include "WiFiManager.h"
+
+/**
+ * @struct NetworkWorkerRequest
+ * @brief Request descriptor passed from the control loop to the worker. Plain data; no callback object.
+ */
+struct NetworkWorkerRequest {
+    char url[API_URL_MAX_LEN];                   ///< Target URL.
+    char method[HTTP_REQUEST_METHOD_MAX_LEN];    ///< HTTP method, e.g. "GET" or "POST".
+    char apiType[HTTP_REQUEST_API_TYPE_MAX_LEN]; ///< Descriptive tag for logging.
+    char payload[HTTP_REQUEST_PAYLOAD_MAX_LEN];  ///< Request body; empty for GET requests and bulk bodies.
+    bool bulkPayload;                            ///< Body is in the worker's bulk buffer instead of `payload`.
+    uint16_t callbackId;                         ///< Control-side callback slot id, or 0 for fire-and-forget.
+    bool needsAuth;                              ///< Whether the Authorization header should be sent.
+    HttpRequestPriority priority;                ///< Scheduling priority within `NetworkFacade`.
+};
+
+/**
+ * @enum NetworkEventKind
+ * @brief Type of a `NetworkWorkerEvent`.
+ */
+enum class NetworkEventKind : uint8_t {
+    HTTP_RESPONSE,  ///< `body` holds the JSON response for `callbackId`.
+    HTTP_FAILED,    ///< The request for `callbackId` was rejected or its response could not be forwarded.
+    HTTP_NOT_MODIFIED, ///< A conditional GET got `304`; `body` holds the URL. The callback of `callbackId` is released without running.
+    STATUS_MESSAGE, ///< `body` holds a short status line for the LCD/log.
+    CONNECTED,      ///< The worker reconnected or switched to WiFi; `body` holds a short status line.
+    TIME_EPOCH,     ///< `epoch` holds network time (SNTP or HTTP time API) to check the RTC against; `epochEdgeUs` is set for SNTP.
+    PUSH_MESSAGE    ///< `body` holds a pushed MQTT payload; `callbackId` holds its `MqttTopic`. Handled inside `pollEvents()`.
+};
+
+/**
+ * @struct NetworkWorkerEvent
+ * @brief Event passed from the worker to the control loop.
+ */
+struct NetworkWorkerEvent {
+    NetworkEventKind kind;                      ///< Event type.
+    uint16_t callbackId;                        ///< Callback slot id for HTTP events; the `MqttTopic` for `PUSH_MESSAGE`.
+    uint32_t epoch;                             ///< Seconds since 1970 for `TIME_EPOCH`.
+    int64_t epochEdgeUs;                        ///< `esp_timer_get_time()` at which `epoch` began (SNTP), or 0.
+    uint16_t len;                               ///< Number of bytes used in `body` (excluding the terminator).
+    char body[NETWORK_WORKER_RESPONSE_MAX_LEN]; ///< JSON response or status text, null-terminated.
+};
+
+/**
+ * @class NetworkWorker
+ * @brief Runs `NetworkFacade` on its own task and exchanges requests/events with the control loop.
+ *
+ * Thread ownership: `submit()`, `pollEvents()`, `requestTimeSync()` and the getters are called from the
+ * control loop only. Everything else runs on the worker task.
+ */
+class NetworkWorker {
+public:
+    using EventHandler = std::function<void(const NetworkWorkerEvent& event)>;
+    using PushHandler = std::function<void(MqttTopic topic, JsonDocument& doc)>;
+
+    /**
+     * @brief Constructs the worker. No task is started until `begin()`.
+     * @param facade Network facade the worker takes over. Must not be used by other tasks after `begin()`.
+     * @param config Device configuration (for the world time API URL).
+     * @param state Device state; the worker owns its connection retry fields after `begin()`.
+     */
+    NetworkWorker(NetworkFacade& facade, const DeviceConfig& config, DeviceState& state);
+
+    /**
+     * @brief Sets the handler for non-HTTP events (`STATUS_MESSAGE`, `CONNECTED`, `TIME_EPOCH`) and `HTTP_NOT_MODIFIED`.
+     * @param handler Called from `pollEvents()` on the control loop.
+     */
+    void setEventHandler(EventHandler handler) { _eventHandler = handler; }
+
+    /**
+     * @brief Sets the handler for messages pushed over MQTT.
+     * @param handler Called from `pollEvents()` on the control loop with the parsed payload.
+     */
+    void setPushHandler(PushHandler handler) { _pushHandler = handler; }
+
+    /**
+     * @brief Starts the worker task. Requests submitted earlier are processed once it runs.
+     * Must be called from the control loop task, which is then woken by `waitForEvent()` when events arrive.
+     * @return `true` if the task was created.
+     */
+    bool begin();
+
+    /**
+     * @brief Queues an HTTP request for the worker. Never blocks.
+     * Same parameters as `NetworkFacade::enqueueHttpRequest()`; `cb` runs later inside `pollEvents()`.
+     * A payload longer than `HTTP_REQUEST_PAYLOAD_MAX_LEN` is copied into a single bulk buffer, which is free
+     * again once the worker has queued the request; check `isBulkBufferFree()` before building one.
+     * @return `true` if the request was handed to the worker.
+     * @return `false` if the request ring or callback table is full, the payload does not fit, or the bulk buffer is busy.
+     */
+    bool submit(const char* url, const char* method, const char* apiType, const char* payload,
+                const HttpResponseCallback& cb, bool needsAuth,
+                HttpRequestPriority priority = HttpRequestPriority::NORMAL);
+
+    /**
+     * @brief Checks whether a bulk payload can be submitted now.
+     * @return `true` if the bulk buffer is not holding a request the worker has yet to queue.
+     */
+    bool isBulkBufferFree() const { return !_bulkInUse.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Processes all pending events: runs HTTP callbacks and forwards other events to the handler.
+     * Also discards callbacks still waiting after `NETWORK_WORKER_CALLBACK_TIMEOUT_MS`, as a backstop for lost events.
+     * Call once per control loop iteration.
+     */
+    void pollEvents();
+
+    /**
+     * @brief Blocks the control loop until the worker posts an event or `timeoutMs` passes.
+     * Returns at once if events are already pending. Lets the loop idle between scheduler deadlines.
+     * @param timeoutMs Maximum time to block.
+     * @return `true` if woken by an event.
+     */
+    bool waitForEvent(unsigned long timeoutMs);
+
+    /**
+     * @brief Asks the worker to fetch network time (SNTP on WiFi, otherwise or if no server answers the HTTP time API).
+     * The result arrives as a `TIME_EPOCH` event.
+     */
+    void requestTimeSync() {
+        _timeSyncRequested.store(true, std::memory_order_release);
+        if (_task) xTaskNotifyGive(_task);
+    }
+
+    /**
+     * @brief Gets the connection state published by the worker after each service pass.
+     * @return `true` if the active interface is connected.
+     */
+    bool isConnected() const { return _connected.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Gets whether the active interface is WiFi, as published by the worker.
+     * @return `true` if connected over WiFi.
+     */
+    bool isOnWiFi() const { return _onWiFi.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Gets whether the MQTT push session is up, as published by the worker.
+     * @return `true` if overrides and thresholds arrive by push; `false` if no broker is configured or it is unreachable.
+     */
+    bool isPushConnected() const { return _pushConnected.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Gets a snapshot of the MQTT session counters.
+     * @return Copy of `MqttManager::getStats()` taken by the worker.
+     */
+    MqttManager::Stats getPushStats() const;
+
+    /**
+     * @brief Gets a snapshot of the SNTP counters.
+     * @return Copy of `SntpClient::getStats()` taken by the worker.
+     */
+    SntpClient::Stats getSntpStats() const;
+
+    /**
+     * @brief Gets a snapshot of the facade's request queue statistics.
+     * @return Copy of `NetworkFacade::getRequestQueueStats()` taken by the worker.
+     */
+    HttpRequestQueue::Stats getRequestQueueStats() const;
+
+    /**
+     * @brief Gets a snapshot of one interface's keep-alive connection statistics.
+     * @param wifi `true` for `WiFiManager`, `false` for `GPRSManager`.
+     * @return Copy of the manager's `HttpConnectionPool` counters taken by the worker (zero if the manager is absent).
+     */
+    HttpConnectionPool::Stats getConnectionStats(bool wifi) const;
+
+    /**
+     * @brief Gets a snapshot of the WiFi connect counters and time-to-IP.
+     * @return Copy of `WiFiManager::getConnectStats()` taken by the worker (zero if there is no WiFi manager).
+     */
+    WiFiManager::ConnectStats getWiFiConnectStats() const;
+
+    /**
+     * @brief Gets a snapshot of the WiFi-to-GPRS failover counters and times.
+     * @return Copy of `NetworkFacade::getFailoverStats()` taken by the worker.
+     */
+    NetworkFacade::FailoverStats getFailoverStats() const;
+
+    /**
+     * @brief Gets a snapshot of the conditional request counters.
+     * @return Copy of `NetworkFacade::getValidatorStats()` taken by the worker.
+     */
+    HttpValidatorCache::Stats getValidatorStats() const;
+
+    /**
+     * @brief Gets the number of requests rejected by `submit()` because the ring or callback table was full.
+     * @return Rejected request count since boot.
+     */
+    uint32_t getRejectedRequests() const { return _rejectedRequests; }
+
+    /**
+     * @brief Gets the number of events the worker dropped because the event ring was full.
+     * @return Dropped event count since boot.
+     */
+    uint32_t getDroppedEvents() const { return _droppedEvents.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @struct PendingCallback
+     * @brief Control-side slot holding a response callback until its event arrives.
+     */
+    struct PendingCallback {
+        uint16_t id;                                 ///< Id sent with the request; 0 marks a free slot.
+        unsigned long submittedAtMs;                 ///< `millis()` at submission, for expiry.
+        HttpResponseCallback cb;                     ///< The caller's callback.
+    };
+
+    static void taskEntry(void* arg);
+    void run();
+    void drainRequests();
+    void maintainConnection(unsigned long now);
+    void serviceTimeSync();
+    void requestHttpTime();
+    void servicePush(unsigned long now);
+    bool postPush(MqttTopic topic, const uint8_t* payload, unsigned int len);
+    void publishStatus();
+    bool postEvent(NetworkEventKind kind, uint16_t callbackId, uint32_t epoch, const char* text, int64_t epochEdgeUs = 0);
+    bool postResponse(uint16_t callbackId, JsonDocument& doc);
+    PendingCallback* findPending(uint16_t id);
+
+    NetworkFacade& _facade;     ///< Facade owned by the worker task after `begin()`.
+    const DeviceConfig& _config; ///< Device configuration (world time URL).
+    DeviceState& _state;        ///< Device state; connection retry fields are worker-owned.
+    EventHandler _eventHandler; ///< Control-side handler for non-HTTP events.
+    PushHandler _pushHandler;   ///< Control-side handler for pushed messages.
+    TaskHandle_t _task;         ///< Worker task handle once started; notified on `submit()`.
+    TaskHandle_t _controlTask;  ///< Task that called `begin()`; notified when an event is posted.
+
+    SpscQueue<NetworkWorkerRequest, NETWORK_WORKER_REQUEST_QUEUE_DEPTH> _requests; ///< Control loop -> worker.
+    SpscQueue<NetworkWorkerEvent, NETWORK_WORKER_EVENT_QUEUE_DEPTH> _events;       ///< Worker -> control loop.
+
+    // Control-side state.
+    PendingCallback _pending[NETWORK_WORKER_MAX_PENDING_CALLBACKS]; ///< Callbacks awaiting replies.
+    uint16_t _nextCallbackId;   ///< Next callback id to hand out; skips 0.
+    uint32_t _rejectedRequests; ///< Requests `submit()` could not queue.
+
+    /**
+     * @enum ConnectAttempt
+     * @brief Facade connect operation started by `maintainConnection()` and awaiting its result.
+     */
+    enum class ConnectAttempt : uint8_t {
+        NONE,           ///< Nothing pending.
+        RECONNECT,      ///< `NetworkFacade::startConnect()` after the link was lost.
+        SWITCH_TO_WIFI  ///< `NetworkFacade::startSwitchToWiFi()` while on GPRS.
+    };
+
+    // Worker-side state.
+    bool _driftCheckPending;    ///< SNTP drift check queued after a reconnect (no HTTP fallback).
+    bool _modemFailReported;    ///< "Modem Fail" was posted for the GPRS modem's current failure.
+    WiFiUDP _sntpUdp;           ///< Socket of `_sntp`.
+    SntpClient _sntp;           ///< Network time rounds, pumped by `serviceTimeSync()`.
+    bool _sntpFallback;         ///< The running SNTP round was a full request: fall back to the HTTP time API if it fails.
+    ConnectAttempt _connectAttempt; ///< Connect operation awaiting its result.
+    MqttManager _mqtt;          ///< Push session on the active link.
+
+    // Shared state.
+    std::atomic<bool> _timeSyncRequested; ///< Set by the control loop, cleared by the worker.
+    std::atomic<bool> _connected;         ///< Published connection state.
+    std::atomic<bool> _onWiFi;            ///< Published active-interface state.
+    std::atomic<bool> _pushConnected;     ///< Published MQTT session state.
+    std::atomic<uint32_t> _droppedEvents; ///< Events lost to a full event ring.
+    std::atomic<bool> _bulkInUse;         ///< Set by the control loop when it fills `_bulkPayload`, cleared by the worker once queued.
+    char _bulkPayload[HTTP_BULK_PAYLOAD_MAX_LEN]; ///< Body of the one in-transit request too large for a ring slot.
+    HttpRequestQueue::Stats _statsSnapshot; ///< Copy of the facade queue stats, guarded by `_statsLock`.
+    HttpConnectionPool::Stats _wifiConnSnapshot; ///< Copy of the WiFi connection pool stats, guarded by `_statsLock`.
+    HttpConnectionPool::Stats _gprsConnSnapshot; ///< Copy of the GPRS connection pool stats, guarded by `_statsLock`.
+    HttpValidatorCache::Stats _validatorSnapshot; ///< Copy of the conditional request stats, guarded by `_statsLock`.
+    WiFiManager::ConnectStats _wifiConnectSnapshot; ///< Copy of the WiFi connect stats, guarded by `_statsLock`.
+    NetworkFacade::FailoverStats _failoverSnapshot; ///< Copy of the failover stats, guarded by `_statsLock`.
+    MqttManager::Stats _pushSnapshot;     ///< Copy of the MQTT session stats, guarded by `_statsLock`.
+    SntpClient::Stats _sntpSnapshot;      ///< Copy of the SNTP stats, guarded by `_statsLock`.
+    mutable portMUX_TYPE _statsLock;      ///< Spinlock for `_statsSnapshot`.
+};
+
+#endif // NETWORK_WORKER_H
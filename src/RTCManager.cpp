@@ -1,17 +1,25 @@
 #include "RTCManager.h"
-#include "NetworkFacade.h" // Required for dynamic_cast and getWiFiManager
-#include "WiFiManager.h"   // Required for checking WiFiManager type
-#include "config.h"        // For DEBUG_PRINTLN, DEBUG_PRINTF (even if currently commented out)
-#include <ArduinoJson.h>   // For JsonDocument in HTTP callback
+#include "config.h"        // For DEBUG_PRINTLN, DEBUG_PRINTF
 #include <Wire.h>          // For RTC communication
+#include <math.h>          // For fabs()
+#include <esp_timer.h>     // For esp_timer_get_time(), the extrapolation timebase
+#include <esp_task_wdt.h>  // For watchdog reset while waiting for a seconds edge
 
 // Constructor
-RTCManager::RTCManager(LCDDisplay& d, NetworkFacade& facade) :
-    _lcd_ref(d),                // Renamed
-    _networkFacade(facade),
-    _timeClient(_ntpUDP),       // Renamed members
-    _rtcOk(false) { // Initialize internal flag
-    // dateTime member removed, no initialization needed here.
+RTCManager::RTCManager(LCDDisplay& d) :
+    _rtcOk(false), // Initialize internal flag
+    _lcd_ref(d),
+    _needsSet(false),
+    _synced(false),
+    _lastSyncMs(0),
+    _driftRefValid(false),
+    _driftRefOffsetUs(0),
+    _driftRefUs(0),
+    _residualOffsetUs(0),
+    _anchorEpoch(0),
+    _anchorUs(0),
+    _preciseAnchorUs(0),
+    _lastCheckMs(0) {
 }
 
 bool RTCManager::begin() {
@@ -36,149 +44,254 @@ bool RTCManager::begin() {
             _lcd_ref.message(0,1, "RTC Power OK", true);
         }
     }
+    anchorOnEdge();
     return true;
 }
 
 void RTCManager::initialTimeSync() {
-    if (_networkFacade.isConnected()) {
-        _lcd_ref.message(0,2, "Attempting Sync...", true);
-        WiFiManager* wifiMgr = _networkFacade.getWiFiManager();
-        // Check if current active interface is WiFi and it's connected
-        if (wifiMgr && _networkFacade.getCurrentInterface() == wifiMgr && wifiMgr->isConnected()) {
-            syncNTP();
-        } else {
-            syncNITZ(); // Try NITZ/HTTP if on GPRS or other connected interface
-        }
-    } else {
-        _lcd_ref.message(0,2, "RTC: No Net for Sync", true);
-    }
+    _needsSet = true;
+    _lcd_ref.message(0,2, "RTC: Sync pending", true);
 }
 
 void RTCManager::adjustTime(uint32_t epoch) {
     if (!_rtcOk) return;
     if (epoch > 1672531200UL) { // Check if epoch is somewhat valid (after 2023-01-01)
         _rtc.adjust(DateTime(epoch));
-        // DEBUG_PRINTLN(3, "RTC Time Adjusted via Epoch."); // Use global debug or lcd
+        anchorPrecise(epoch, esp_timer_get_time()); // Writing the seconds register restarts the DS3231's second.
+        _driftRefValid = false; // Whole seconds only: the phase against network time is unknown.
+        _needsSet = false;
+        _syncStats.adjustments++;
         _lcd_ref.message(0,3, "RTC Time Adjusted", true);
     } else {
-        // DEBUG_PRINTLN(1, "RTC: Invalid epoch received.");
+        DEBUG_PRINTLN(1, "RTC: Invalid epoch received.");
         _lcd_ref.message(0,3, "RTC: Invalid Epoch", true);
     }
 }
 
-bool RTCManager::checkAndSyncOnDrift(uint32_t thresholdSeconds) {
-    if (!_rtcOk) return false;
-    DateTime ntpTime;
-    if (_getNetworkDateTimeNTP(ntpTime)) {
-        DateTime rtcTime = _rtc.now();
-        long drift = abs((long)rtcTime.unixtime() - (long)ntpTime.unixtime());
-        if (drift > thresholdSeconds) {
-            // DEBUG_PRINTF(2, "RTC Drift Detected! %ld s. Syncing...\n", drift);
+bool RTCManager::applyNetworkEpoch(uint32_t epoch, int64_t edgeUs) {
+    if (!_rtcOk || epoch <= 1672531200UL) return false;
+    _synced = true;
+    _lastSyncMs = millis();
+    _syncStats.samples++;
+
+    if (edgeUs == 0) { // HTTP time API: whole seconds, phase unknown.
+        long drift = (long)epoch - (long)this->epoch(); // The extrapolated clock tracks the RTC; no I2C read needed.
+        _syncStats.lastOffsetMs = (int32_t)(drift * 1000L);
+        if (_needsSet || labs(drift) > (long)RTC_DRIFT_THRESHOLD_SECONDS) {
+            DEBUG_PRINTF(2, "RTC Drift Detected! %ld s. Syncing...\n", drift);
             _lcd_ref.message(0,3, "RTC Drift! Sync...", true);
-            adjustTime(ntpTime.unixtime());
+            adjustTime(epoch);
+            _residualOffsetUs = 0;
             return true;
         }
+        _residualOffsetUs = (int64_t)drift * 1000000LL;
+        return false;
     }
+
+    // A sample that can update the drift estimate is measured against the RTC's own seconds edge; the extrapolated
+    // clock is only kept within the reanchor bracket, which is too coarse for a rate over a few hours.
+    bool learn = !_needsSet && (!_driftRefValid || esp_timer_get_time() - _driftRefUs >= (int64_t)RTC_DRIFT_MIN_SPAN_MS * 1000LL);
+    if (learn) anchorOnEdge();
+
+    // Network second `epoch` began at `edgeUs`; RTC second `_anchorEpoch` began at `_anchorUs`.
+    int64_t offsetUs = ((int64_t)epoch - (int64_t)_anchorEpoch) * 1000000LL - (edgeUs - _anchorUs);
+    _syncStats.lastOffsetMs = (int32_t)(offsetUs / 1000LL);
+    if (learn) learnDrift(offsetUs, edgeUs);
+
+    bool adjust = _needsSet || llabs(offsetUs) > (int64_t)TIME_SYNC_TARGET_ERROR_MS * 1000LL;
+    // The next sync is at least TIME_SYNC_INTERVAL away; if the drift would use up the rest of the budget before
+    // then, correct now while there is a precise sample to do it with.
+    if (!adjust && _syncStats.driftKnown && msToTargetError(offsetUs) < (double)TIME_SYNC_INTERVAL) adjust = true;
+    if (adjust) {
+        DEBUG_PRINTF(2, "RTC off by %ld ms. Syncing...\n", (long)(offsetUs / 1000LL));
+        _lcd_ref.message(0,3, "RTC Drift! Sync...", true);
+        adjustOnEdge(epoch, edgeUs);
+        _residualOffsetUs = 0;
+        return true;
+    }
+    _residualOffsetUs = offsetUs;
     return false;
 }
 
-bool RTCManager::syncNTP() {
+/**
+ * @brief Checks whether the next network time sync is due.
+ * Refer to RTCManager.h for detailed documentation.
+ */
+bool RTCManager::isSyncDue(unsigned long nowMs) const {
+    return !_synced || nowMs - _lastSyncMs >= getSyncIntervalMs();
+}
+
+/**
+ * @brief Gets the sync interval stretched by the learned RTC drift.
+ * Refer to RTCManager.h for detailed documentation.
+ */
+unsigned long RTCManager::getSyncIntervalMs() const {
+    if (!_syncStats.driftKnown) return TIME_SYNC_INTERVAL;
+    double ms = msToTargetError(_residualOffsetUs);
+    if (ms < (double)TIME_SYNC_INTERVAL) return TIME_SYNC_INTERVAL;
+    if (ms > (double)TIME_SYNC_MAX_INTERVAL_MS) return TIME_SYNC_MAX_INTERVAL_MS;
+    return (unsigned long)ms;
+}
+
+double RTCManager::msToTargetError(int64_t offsetUs) const {
+    double ppm = (double)_syncStats.driftPpm;
+    if (ppm == 0.0) return (double)TIME_SYNC_MAX_INTERVAL_MS;
+    // Network minus RTC falls by `ppm` us per second when the RTC runs fast and rises when it runs slow.
+    double budgetUs = (double)TIME_SYNC_TARGET_ERROR_MS * 1000.0 + (ppm > 0.0 ? (double)offsetUs : -(double)offsetUs);
+    return budgetUs > 0.0 ? budgetUs * 1000.0 / fabs(ppm) : 0.0;
+}
+
+/**
+ * @brief Gets the network time counters and RTC drift estimate.
+ * Refer to RTCManager.h for detailed documentation.
+ */
+RTCManager::SyncStats RTCManager::getSyncStats() const {
+    SyncStats ss = _syncStats;
+    ss.intervalMs = getSyncIntervalMs();
+    return ss;
+}
+
+void RTCManager::adjustOnEdge(uint32_t epoch, int64_t edgeUs) {
+    int64_t now = esp_timer_get_time();
+    uint32_t k = now > edgeUs ? (uint32_t)((now - edgeUs) / 1000000LL) + 1 : 0;
+    int64_t target = edgeUs + (int64_t)k * 1000000LL;
+    while (target - esp_timer_get_time() > 2000) { // Sleep most of the wait, then spin onto the edge.
+        esp_task_wdt_reset();
+        delay(1);
+    }
+    while (esp_timer_get_time() < target) {}
+    _rtc.adjust(DateTime(epoch + k)); // Writing the seconds register restarts the DS3231's second.
+    anchorPrecise(epoch + k, target);
+    resetDriftReference(target);
+    _needsSet = false;
+    _syncStats.adjustments++;
+    _lcd_ref.message(0,3, "RTC Time Adjusted", true);
+}
+
+void RTCManager::learnDrift(int64_t offsetUs, int64_t timerUs) {
+    if (_driftRefValid) {
+        int64_t spanUs = timerUs - _driftRefUs;
+        if (spanUs <= 0) return;
+        // A growing offset means the RTC falls further behind network time: it runs slow.
+        float ppm = -(float)((double)(offsetUs - _driftRefOffsetUs) * 1e6 / (double)spanUs);
+        _syncStats.driftPpm = _syncStats.driftKnown ? (_syncStats.driftPpm + ppm) * 0.5f : ppm;
+        _syncStats.driftKnown = true;
+        DEBUG_PRINTF(3, "RTC: Drift %.2f ppm over %lu s (estimate %.2f ppm).\n", ppm,
+                     (unsigned long)(spanUs / 1000000LL), _syncStats.driftPpm);
+    }
+    _driftRefValid = true;
+    _driftRefOffsetUs = offsetUs;
+    _driftRefUs = timerUs;
+}
+
+void RTCManager::resetDriftReference(int64_t timerUs) {
+    _driftRefValid = true;
+    _driftRefOffsetUs = 0;
+    _driftRefUs = timerUs;
+}
+
+/**
+ * @brief Writes the extrapolated date and time.
+ * Refer to RTCManager.h for detailed documentation.
+ */
+bool RTCManager::formatInto(char* buf, size_t len) const {
+    if (!_rtcOk) {
+        snprintf(buf, len, "RTC Error"); // Indicate RTC problem
+        return false;
+    }
+    DateTime n(epoch()); // Calendar conversion only; no I2C.
+    snprintf(buf, len, "%04d-%02d-%02d %02d:%02d:%02d",
+             n.year(), n.month(), n.day(), n.hour(), n.minute(), n.second());
+    return true;
+}
+
+/**
+ * @brief Gets the extrapolated epoch.
+ * Refer to RTCManager.h for detailed documentation.
+ */
+uint32_t RTCManager::epoch() const {
+    if (!_rtcOk) return 0;
+    return _anchorEpoch + (uint32_t)((esp_timer_get_time() - _anchorUs) / 1000000LL);
+}
+
+/**
+ * @brief Checks the extrapolation against the RTC and nudges the anchor.
+ * Refer to RTCManager.h for detailed documentation.
+ */
+bool RTCManager::reanchorIfDue() {
     if (!_rtcOk) return false;
-    
-    // NetworkFacade* facade = dynamic_cast<NetworkFacade*>(&network_interface); // No longer needed, _networkFacade is NetworkFacade&
-    WiFiManager* wifiMgr = _networkFacade.getWiFiManager();
-
-    if (!(wifiMgr && _networkFacade.getCurrentInterface() == wifiMgr && wifiMgr->isConnected())) {
-        if (_networkFacade.isConnected()) {
-            // DEBUG_PRINTLN(2, "Not on WiFi for NTP, trying HTTP time...");
-            _lcd_ref.message(0,2, "NTP Fail, HTTP Sync", true);
-            triggerHttpTimeSync();
-        } else {
-            // DEBUG_PRINTLN(1, "NTP Sync: No WiFi connection.");
-            _lcd_ref.message(0,2, "NTP: No WiFi", true);
-        }
+    unsigned long nowMs = millis();
+    if (nowMs - _lastCheckMs < RTC_REANCHOR_INTERVAL_MS) return false;
+    _lastCheckMs = nowMs;
+
+    int64_t t = esp_timer_get_time();
+    uint32_t s = _rtc.now().unixtime();
+    _clockStats.checks++;
+
+    // Where the extrapolation puts time t, relative to the start of RTC second s; [0, 1 s) is consistent.
+    int64_t offsetUs = ((int64_t)_anchorEpoch - (int64_t)s) * 1000000LL + (t - _anchorUs);
+    int64_t correctionUs;
+    if (offsetUs < 0) {
+        correctionUs = -offsetUs; // Behind: second s has started at least this long ago.
+        _anchorEpoch = s;
+        _anchorUs = t;
+    } else if (offsetUs >= 1000000LL) {
+        correctionUs = 999999LL - offsetUs; // Ahead: second s + 1 has not started yet.
+        _anchorEpoch = s;
+        _anchorUs = t - 999999LL;
+    } else {
         return false;
     }
-    
-    // DEBUG_PRINTLN(3, "Syncing NTP...");
-    _lcd_ref.message(0,2, "Syncing NTP...", true);
-    _timeClient.begin(); 
-    _timeClient.setTimeOffset(NTP_TIMEZONE_OFFSET_SECONDS); 
-    if (_timeClient.forceUpdate()) {
-        unsigned long epochTime = _timeClient.getEpochTime();
-        adjustTime(epochTime); 
-        // DEBUG_PRINTLN(3, "NTP Sync OK");
-        _lcd_ref.message(0,3, "NTP Sync OK", true);
+
+    if (llabs(correctionUs) > 2000000LL) { // Whole seconds apart: RTC set or glitched outside adjustTime(); start over.
+        DEBUG_PRINTF(2, "RTC: Clock re-anchored, off by %ld s.\n", (long)(correctionUs / 1000000LL));
+        anchorPrecise(s, t - 500000LL); // Phase unknown; centred in the second.
         return true;
     }
-    // DEBUG_PRINTLN(1, "NTP Sync Failed, trying HTTP time...");
-    _lcd_ref.message(0,3, "NTP Fail, HTTP Sync", true);
-    triggerHttpTimeSync(); 
-    return false;
+    _clockStats.corrections++;
+    _clockStats.lastCorrectionUs = (int32_t)correctionUs;
+    _clockStats.totalCorrectionUs += correctionUs;
+    return true;
 }
 
-void RTCManager::syncNITZ() {
-    if (!_rtcOk) return;
-    // DEBUG_PRINTLN(2, "Attempting NITZ/HTTP Time Sync...");
-    _lcd_ref.message(0,2, "NITZ/HTTP Sync...", true);
-    triggerHttpTimeSync(); // NITZ is often unreliable, go straight to HTTP
+/**
+ * @brief Gets the extrapolated clock counters and drift estimate.
+ * Refer to RTCManager.h for detailed documentation.
+ */
+RTCManager::ClockStats RTCManager::getClockStats() const {
+    ClockStats cs = _clockStats;
+    int64_t spanUs = esp_timer_get_time() - _preciseAnchorUs;
+    cs.sinceAnchorS = (uint32_t)(spanUs / 1000000LL);
+    cs.driftPpm = spanUs > 0 ? (float)((double)cs.totalCorrectionUs * 1e6 / (double)spanUs) : 0.0f;
+    return cs;
+}
+
+void RTCManager::anchorPrecise(uint32_t epochSeconds, int64_t timerUs) {
+    _anchorEpoch = epochSeconds;
+    _anchorUs = timerUs;
+    _preciseAnchorUs = timerUs;
+    _lastCheckMs = millis();
+    _clockStats = ClockStats();
 }
 
-void RTCManager::triggerHttpTimeSync() {
-    if (!_networkFacade.isConnected()) {
-        // DEBUG_PRINTLN(1, "HTTP Time Sync: No network.");
-        _lcd_ref.message(0,3, "HTTP Sync: No Net", true);
-        return;
+void RTCManager::anchorOnEdge() {
+    int64_t start = esp_timer_get_time();
+    uint32_t first = _rtc.now().unixtime();
+    uint32_t s = first;
+    int64_t t = start;
+    while (s == first && t - start < (int64_t)RTC_EDGE_SEARCH_MAX_US) {
+        esp_task_wdt_reset();
+        s = _rtc.now().unixtime(); // ~0.8 ms per read at 100 kHz: the edge is found to within a read.
+        t = esp_timer_get_time();
     }
-    // DEBUG_PRINTLN(3, "Triggering Async HTTP Time Fetch...");
-    _lcd_ref.message(0,3, "HTTP Time Fetch...", true);
-    
-    extern DeviceConfig deviceConfig; // Access global deviceConfig
-
-    _networkFacade.startAsyncHttpRequest(deviceConfig.worldtime_url, "GET", "RTC_WT_ASYNC", nullptr,
-        [this](JsonDocument& d) { // Capture this
-            if (!d["unixtime"].isNull() && d["unixtime"].is<uint32_t>()) {
-                uint32_t epoch = d["unixtime"].as<uint32_t>();
-                this->adjustTime(epoch); 
-                // DEBUG_PRINTF(3, "Async RTC WT CB: Epoch fetched & RTC adjusted: %lu\n", epoch);
-                // _lcd_ref.message(0,3, "HTTP Time OK", true); // Message already in adjustTime
-                return true;
-            }
-            // DEBUG_PRINTLN(1, F("Async RTC WT CB: Failed to parse unixtime."));
-            this->_lcd_ref.message(0,3, "HTTP Time Parse ERR", true);
-            return false;
-        }, false);
-}
-
-String RTCManager::getFormattedDateTime() {
-    if (_rtcOk) {
-        DateTime n = _rtc.now();
-        char dt_buffer[20]; // YYYY-MM-DD HH:MM:SS + null
-        snprintf(dt_buffer, sizeof(dt_buffer), "%04d-%02d-%02d %02d:%02d:%02d",
-                 n.year(), n.month(), n.day(), n.hour(), n.minute(), n.second());
-        return String(dt_buffer);
+    if (s == first) {
+        DEBUG_PRINTLN(1, "RTC: Seconds did not advance; oscillator stopped?");
+        anchorPrecise(first, start - 500000LL);
     } else {
-        return String("RTC Error"); // Indicate RTC problem
+        anchorPrecise(s, t);
     }
 }
 
 bool RTCManager::isRtcOk() const {
     return _rtcOk;
 }
-
-bool RTCManager::_getNetworkDateTimeNTP(DateTime& dt) {
-    // NetworkFacade* facade = dynamic_cast<NetworkFacade*>(&_networkFacade); // Not needed
-    WiFiManager* wifiMgr = _networkFacade.getWiFiManager();
-    if (wifiMgr && _networkFacade.getCurrentInterface() == wifiMgr && wifiMgr->isConnected()) {
-        _timeClient.begin();
-        _timeClient.setTimeOffset(NTP_TIMEZONE_OFFSET_SECONDS);
-        if (_timeClient.forceUpdate()) {
-            unsigned long e = _timeClient.getEpochTime();
-            if (e > 1672531200UL) { 
-                dt = DateTime(e);
-                return true;
-            }
-        }
-    }
-    return false;
-}
\ No newline at end of file
@@ -8,49 +8,32 @@
  * - Initialization: Verifying the presence and operational status of the RTC hardware.
  *   It checks if the RTC has lost power (`_rtc.lostPower()`) which would indicate that its
  *   time is invalid.
- * - Time Synchronization: Maintaining accurate time by synchronizing the RTC with external
- *   network time sources. The manager supports multiple synchronization methods with a
- *   preference order:
- *   1.  NTP (Network Time Protocol): Used when a Wi-Fi connection is available.
- *       Configuration includes `NTP_SERVER` and `NTP_TIMEZONE_OFFSET_SECONDS` from `config.h`.
- *   2.  NITZ (Network Identity and Time Zone): Attempted when a GPRS connection is active,
- *       relying on time information provided by the cellular network.
- *   3.  HTTP World Time API: As a fallback, or if other methods fail, it can fetch the
- *       current time from a specified HTTP endpoint (e.g., `WORLDTIME_API_URL` from `config.h`
- *       or `DeviceConfig`). This is an asynchronous operation managed via `NetworkFacade`.
- * - Drift Management: Periodically checking the RTC's time against a reliable network source
- *   (primarily NTP) and re-synchronizing if the drift exceeds a configurable threshold
- *   (`RTC_DRIFT_THRESHOLD_SECONDS` from `config.h`).
- * - Time Provision: Providing the current date and time as a formatted string.
+ * - Time Synchronization: The RTC never touches the network. `NetworkWorker` fetches network time (SNTP through
+ *   `SntpClient` on WiFi, the HTTP world time API otherwise) and the control loop hands it to `applyNetworkEpoch()`.
+ *   An SNTP sample carries the timer value at which its second began, so the RTC's error is measured to a few
+ *   milliseconds and corrected by writing the RTC on the next network second edge. An HTTP epoch is only whole
+ *   seconds and is applied with the coarse `RTC_DRIFT_THRESHOLD_SECONDS` check.
+ * - Drift Management: Two SNTP samples at least `RTC_DRIFT_MIN_SPAN_MS` apart give the RTC's rate error. Once it is
+ *   known, `isSyncDue()` stretches the sync interval from `TIME_SYNC_INTERVAL` up to `TIME_SYNC_MAX_INTERVAL_MS`,
+ *   to the time the learned drift needs to reach `TIME_SYNC_TARGET_ERROR_MS`.
+ * - Time Provision: The DS3231 is read once at boot, anchored on a seconds edge, and then extrapolated from
+ *   `esp_timer`, so `epoch()` and `formatInto()` cost no I2C traffic or heap. `reanchorIfDue()` checks the
+ *   extrapolation against one RTC read every `RTC_REANCHOR_INTERVAL_MS` and nudges it back when the two disagree;
+ *   the nudges give a measured estimate of the ESP32 timer's drift against the RTC.
  *
  * The `RTCManager` interacts with:
- * - `NetworkFacade`: To determine network availability and type (WiFi/GPRS), and to initiate
- *   network requests for time synchronization (NTP lookups, HTTP GET requests for time API).
  * - `LCDDisplay`: To output status messages regarding RTC initialization, synchronization attempts,
  *   successes, and failures.
- * - `DeviceConfig`: Potentially to retrieve configurable settings like the `WORLDTIME_API_URL` if
- *   it's not hardcoded in `config.h`.
  *
- * Configuration constants such as `RTC_DRIFT_THRESHOLD_SECONDS`, `NTP_SERVER`,
- * `NTP_TIMEZONE_OFFSET_SECONDS`, `NTP_UPDATE_INTERVAL_MS`, and `WORLDTIME_API_URL` (or its
- * equivalent from `DeviceConfig`) are crucial for its operation and are typically defined
- * in `config.h`.
+ * Configuration constants such as `RTC_DRIFT_THRESHOLD_SECONDS`, `TIME_SYNC_TARGET_ERROR_MS`,
+ * `RTC_DRIFT_MIN_SPAN_MS` and `TIME_SYNC_MAX_INTERVAL_MS` are defined in `config.h`.
  */
 #ifndef RTC_MANAGER_H
 #define RTC_MANAGER_H
 
 #include <RTClib.h>         // Core library for DS3231 RTC (RTC_DS3231, DateTime classes).
-#include <NTPClient.h>      // For interfacing with NTP servers (`NTPClient` class).
-#include <WiFiUdp.h>        // UDP protocol support, required by `NTPClient`.
-#include <ArduinoJson.h>    // For parsing JSON responses from HTTP-based time APIs.
 #include "LCDDisplay.h"     // For displaying status messages to the user.
-#include "config.h"         // For RTC_DRIFT_THRESHOLD_SECONDS, NTP_SERVER, NTP_TIMEZONE_OFFSET_SECONDS,
-                            // NTP_UPDATE_INTERVAL_MS, WORLDTIME_API_URL, DEBUG_RTC etc.
-#include "DeviceConfig.h"   // Potentially for dynamic configuration of WORLDTIME_API_URL.
-#include "NetworkFacade.h"  // For initiating network requests (e.g., HTTP time sync) and checking network status.
-
-// Forward declaration for WiFiManager is not strictly needed here as it's not directly used
-// by RTCManager's public interface, but could be relevant if internal implementations change.
+#include "config.h"         // For RTC_DRIFT_THRESHOLD_SECONDS, TIME_SYNC_TARGET_ERROR_MS, RTC_DRIFT_MIN_SPAN_MS etc.
 
 /**
  * @class RTCManager
@@ -58,28 +41,20 @@
  *
  * This class encapsulates the logic for:
  * - Initializing the RTC and checking its health.
- * - Synchronizing the RTC's time with various network sources (NTP, NITZ, HTTP API).
- *   The choice of synchronization method often depends on the available network connection
- *   (Wi-Fi for NTP, GPRS for NITZ, or HTTP as a general fallback).
- * - Periodically checking for time drift against network time and correcting it.
+ * - Applying network time fetched by `NetworkWorker` and learning the RTC's drift rate from it.
+ * - Deciding when the next network time sync is due.
  * - Providing the current date and time in a formatted manner.
- * It relies on `NetworkFacade` for network-dependent operations and `LCDDisplay` for user feedback.
+ * It relies on `LCDDisplay` for user feedback. Control loop task only.
  */
 class RTCManager {
 public:
     /**
      * @brief Constructs an `RTCManager` instance.
-     * Initializes references to peripheral objects and configures the NTP client
-     * with parameters like `NTP_SERVER` and `NTP_TIMEZONE_OFFSET_SECONDS` from `config.h`.
      *
      * @param d Reference to an `LCDDisplay` object, used for displaying status messages
-     *          related to RTC operations (e.g., "RTC Init OK", "Syncing NTP...", "Time Set").
-     * @param facade Reference to a `NetworkFacade` object. This is crucial for:
-     *               - Checking network availability and type (WiFi/GPRS).
-     *               - Initiating NTP synchronization requests.
-     *               - Triggering asynchronous HTTP GET requests to a world time API.
+     *          related to RTC operations (e.g., "RTC Power OK", "RTC Time Adjusted").
      */
-    RTCManager(LCDDisplay& d, NetworkFacade& facade);
+    explicit RTCManager(LCDDisplay& d);
 
     /**
      * @brief Initializes the RTC module (DS3231).
@@ -90,8 +65,9 @@ public:
      * 3.  If communication is successful, it checks if the RTC has lost power since the last
      *     time it was set (using `_rtc.lostPower()`).
      * 4.  If power was lost or the RTC time is deemed invalid (e.g., year < 2023), it calls
-     *     `initialTimeSync()` to attempt an immediate synchronization.
-     * 5.  Displays status messages on the `_lcd_ref`.
+     *     `initialTimeSync()` so the first network time is applied unconditionally.
+     * 5.  Anchors the extrapolated clock on a DS3231 seconds edge.
+     * 6.  Displays status messages on the `_lcd_ref`.
      *
      * @return `true` if the RTC hardware was successfully initialized and is communicating.
      * @return `false` if the RTC module could not be found or initialized.
@@ -99,23 +75,14 @@ public:
     bool begin();
 
     /**
-     * @brief Performs an initial time synchronization attempt if the RTC time is invalid.
-     *
-     * This method is typically called from `begin()` if the RTC's current time is suspect
-     * (e.g., due to power loss or being a default uninitialized value like year 2000).
-     * It tries to synchronize using the best available method:
-     * - If Wi-Fi is connected (checked via `_networkFacade`), it attempts `syncNTP()`.
-     * - If GPRS is available, it may attempt `syncNITZ()` or `triggerHttpTimeSync()`.
-     * - If only HTTP is viable, it calls `triggerHttpTimeSync()`.
-     * The specific logic depends on the `NetworkFacade`'s capabilities and current status.
+     * @brief Marks the RTC time as invalid, so the next network time is applied whatever the difference.
+     * Called from `begin()` after a power loss; the caller requests a sync from `NetworkWorker`.
      */
     void initialTimeSync();
 
     /**
-     * @brief Adjusts the RTC's current time using a provided Unix epoch timestamp.
-     * This is the core method used by all synchronization mechanisms (NTP, NITZ, HTTP callback)
-     * once they have successfully obtained a valid epoch time.
-     * It converts the epoch to a `DateTime` object and then calls `_rtc.adjust()`.
+     * @brief Adjusts the RTC's current time using a provided Unix epoch timestamp, immediately.
+     * Used for whole-second sources (the HTTP time API); the written second starts at the time of the call.
      *
      * @param epoch The Unix epoch time (number of seconds that have elapsed since
      *              January 1, 1970, at 00:00:00 Coordinated Universal Time (UTC)).
@@ -123,77 +90,107 @@ public:
     void adjustTime(uint32_t epoch);
 
     /**
-     * @brief Periodically checks for RTC time drift against a reliable network time source
-     *        (primarily NTP) and re-synchronizes if the drift exceeds a specified threshold.
+     * @brief Compares network time with the RTC and adjusts the RTC when it is off.
+     * Called on the control loop with `TIME_EPOCH` events from `NetworkWorker`.
+     *
+     * With `edgeUs == 0` (HTTP time API) the RTC is adjusted if it is more than `RTC_DRIFT_THRESHOLD_SECONDS` off.
+     * With an SNTP sample the offset is measured to the millisecond, feeds the drift estimate, and the RTC is
+     * rewritten on the next network second edge if it is more than `TIME_SYNC_TARGET_ERROR_MS` off. Measuring against
+     * the RTC itself needs a seconds edge search (up to `RTC_EDGE_SEARCH_MAX_US`); it is only made for samples that
+     * can update the drift estimate, others are compared with the extrapolated clock. Once the drift is known the RTC
+     * is also adjusted when it would pass the target before the next sync, which is never sooner than
+     * `TIME_SYNC_INTERVAL`.
      *
-     * This method should be called regularly from the main application loop.
-     * 1.  It fetches the current time from the RTC.
-     * 2.  It attempts to get the current network time (e.g., via `_getNetworkDateTimeNTP()`).
-     * 3.  If both times are valid, it calculates the difference (drift).
-     * 4.  If the absolute drift is greater than `thresholdSeconds` (defaulting to
-     *     `RTC_DRIFT_THRESHOLD_SECONDS` from `config.h`), it calls `adjustTime()`
-     *     with the network time.
+     * Either way the RTC is adjusted whatever the offset after `initialTimeSync()`.
      *
-     * @param thresholdSeconds The maximum allowed drift in seconds. If the RTC time differs
-     *                         from the network time by more than this value, a synchronization
-     *                         will be triggered. Defaults to `RTC_DRIFT_THRESHOLD_SECONDS`.
-     * @return `true` if a synchronization was performed due to detected drift exceeding the threshold.
-     * @return `false` if no synchronization was needed (drift was within limits, or network time
-     *          could not be obtained).
+     * @param epoch Network time in seconds since 1970 (local time, as the RTC holds).
+     * @param edgeUs `esp_timer_get_time()` at which `epoch` began, or 0 if unknown.
+     * @return `true` if the RTC was adjusted.
      */
-    bool checkAndSyncOnDrift(uint32_t thresholdSeconds = RTC_DRIFT_THRESHOLD_SECONDS);
+    bool applyNetworkEpoch(uint32_t epoch, int64_t edgeUs = 0);
 
     /**
-     * @brief Attempts to synchronize the RTC with an NTP (Network Time Protocol) server.
-     *
-     * This method is typically used when a Wi-Fi connection is available and deemed reliable.
-     * It uses the `_timeClient` (an `NTPClient` instance) to fetch the current UTC time.
-     * If successful, it calls `adjustTime()` to update the RTC.
-     * If NTP synchronization fails, it might fall back to `triggerHttpTimeSync()` as an alternative.
-     *
-     * @return `true` if NTP synchronization was successful and the RTC was updated.
-     * @return `false` if NTP synchronization failed. (Note: A fallback to HTTP might still occur
-     *          and succeed, but this function would have returned false for the NTP part).
+     * @brief Checks whether the next network time sync is due.
+     * @param nowMs Current `millis()`.
+     * @return `true` if no sync has been applied yet, or `getSyncIntervalMs()` has passed since the last one.
      */
-    bool syncNTP();
+    bool isSyncDue(unsigned long nowMs) const;
 
     /**
-     * @brief Attempts to synchronize the RTC using NITZ (Network Identity and Time Zone)
-     *        or falls back to an HTTP-based time service.
-     *
-     * NITZ is a feature of GSM/GPRS networks where the network provides time information.
-     * This method would typically involve commands to the GPRS modem (via `NetworkFacade`)
-     * to retrieve NITZ data. If NITZ is unavailable or fails, it may call `triggerHttpTimeSync()`
-     * as a fallback. The actual implementation of NITZ retrieval depends heavily on the
-     * GPRS modem's AT command set and the `NetworkFacade`'s GPRS manager.
+     * @brief Gets the interval after which the learned RTC drift reaches `TIME_SYNC_TARGET_ERROR_MS`.
+     * Counted from the offset the last sync left on the RTC: zero after an adjustment, otherwise the measured offset.
+     * @return `TIME_SYNC_INTERVAL` until the drift is known, then the stretched interval, clamped to
+     *         [`TIME_SYNC_INTERVAL`, `TIME_SYNC_MAX_INTERVAL_MS`].
      */
-    void syncNITZ();
+    unsigned long getSyncIntervalMs() const;
 
     /**
-     * @brief Triggers an asynchronous HTTP GET request to a configured world time API
-     *        (e.g., `WORLDTIME_API_URL` from `config.h` or `DeviceConfig`) to fetch the current epoch time.
-     *
-     * This method does **not** block or directly update the RTC. Instead, it initiates an
-     * HTTP request through the `_networkFacade`. The `_networkFacade` is expected to handle
-     * the asynchronous request and, upon successful completion and parsing of the JSON response
-     * (which should contain the epoch time), invoke a callback. This callback (often a lambda
-     * function passed to the `NetworkFacade`'s HTTP request method) will then call
-     * `RTCManager::adjustTime()` with the received epoch.
-     *
-     * This is useful as a fallback when NTP/NITZ are unavailable or as the primary method
-     * if desired.
+     * @struct SyncStats
+     * @brief Network time counters and the learned RTC drift rate, since boot.
+     */
+    struct SyncStats {
+        uint32_t samples = 0;         ///< Network times applied (SNTP and HTTP).
+        uint32_t adjustments = 0;     ///< Times the RTC was written.
+        int32_t lastOffsetMs = 0;     ///< Network minus RTC at the last sample; positive when the RTC was behind.
+        bool driftKnown = false;      ///< `driftPpm` holds a measurement.
+        float driftPpm = 0.0f;        ///< RTC rate error; positive when the RTC runs fast.
+        unsigned long intervalMs = 0; ///< Current `getSyncIntervalMs()`.
+    };
+
+    /**
+     * @brief Gets the network time counters and RTC drift estimate.
+     * @return A copy of the statistics.
      */
-    void triggerHttpTimeSync();
+    SyncStats getSyncStats() const;
 
     /**
-     * @brief Gets the current date and time from the RTC as a formatted string.
-     * The format is typically "YYYY-MM-DD HH:MM:SS".
+     * @brief Writes the current date and time as "YYYY-MM-DD HH:MM:SS" without I2C access or allocation.
+     * Extrapolated from the last anchor; control loop task only.
      *
-     * @return A `String` object containing the formatted date and time.
-     *         If the RTC is not available or not initialized (`!_rtcOk`), it returns
-     *         an error string like "RTC Error" or "RTC N/A".
+     * @param buf Destination, at least 20 bytes for the full string.
+     * @param len Size of `buf`.
+     * @return `true` if the time was written; `false` if the RTC is not available (`!_rtcOk`), in which case
+     *         "RTC Error" is written instead.
      */
-    String getFormattedDateTime();
+    bool formatInto(char* buf, size_t len) const;
+
+    /**
+     * @brief Gets the current time as seconds since 1970 without I2C access.
+     * The RTC holds local time (NTP sync applies `NTP_TIMEZONE_OFFSET_SECONDS`), so this is a local-time epoch.
+     * Extrapolated from the last anchor; control loop task only.
+     * @return The time, or 0 if the RTC is not available (`!_rtcOk`).
+     */
+    uint32_t epoch() const;
+
+    /**
+     * @brief Checks the extrapolated clock against one DS3231 read once `RTC_REANCHOR_INTERVAL_MS` has passed
+     *        since the last check, and moves the anchor by the smallest amount that makes them agree.
+     * A read of second `s` means the true time is in [s, s+1); an extrapolation outside that interval is behind or
+     * ahead by at least the distance to it. Call from the control loop; returns at once when not due.
+     * @return `true` if the anchor was moved.
+     */
+    bool reanchorIfDue();
+
+    /**
+     * @struct ClockStats
+     * @brief Extrapolated clock counters since the last precise anchor (boot or RTC adjustment).
+     */
+    struct ClockStats {
+        uint32_t checks = 0;          ///< RTC reads made by `reanchorIfDue()`.
+        uint32_t corrections = 0;     ///< Reads that moved the anchor.
+        int32_t lastCorrectionUs = 0; ///< Last move; positive when the extrapolation was behind the RTC.
+        int64_t totalCorrectionUs = 0;///< Sum of all moves.
+        uint32_t sinceAnchorS = 0;    ///< Seconds since the last precise anchor.
+        float driftPpm = 0.0f;        ///< ESP32 timer drift against the RTC, `totalCorrectionUs` over the time since the
+                                      ///< precise anchor. Positive means the timer runs slow. A lower bound: errors smaller
+                                      ///< than the read phase go unseen, so it converges over hours.
+    };
+
+    /**
+     * @brief Gets the extrapolated clock counters and drift estimate.
+     * @return A copy of the statistics.
+     */
+    ClockStats getClockStats() const;
     
     /**
      * @brief Checks if the RTC hardware was successfully initialized and is considered operational.
@@ -203,27 +200,59 @@ public:
     bool isRtcOk() const;
 
 private:
-    bool _rtcOk; ///< Flag set to `true` if `_rtc.begin()` was successful, indicating RTC hardware is present and communicating.
+    /**
+     * @brief Anchors the extrapolated clock: `epochSeconds` began exactly at `timerUs` (`esp_timer_get_time()`),
+     *        and restarts the drift measurement.
+     */
+    void anchorPrecise(uint32_t epochSeconds, int64_t timerUs);
 
     /**
-     * @brief Internal helper function to fetch the current time from an NTP server.
-     * This function is called by `syncNTP()` and `checkAndSyncOnDrift()`.
-     * It uses `_timeClient.update()` to get the latest time and then `_timeClient.getEpochTime()`
-     * to retrieve it as a Unix timestamp. This epoch is then used to construct a `DateTime` object.
-     *
-     * @param[out] dt Reference to a `DateTime` object where the fetched network time will be stored
-     *                if the operation is successful.
-     * @return `true` if time was successfully fetched from NTP and `dt` was updated.
-     * @return `false` if fetching time from NTP failed (e.g., network unavailable, NTP server unreachable).
+     * @brief Reads the RTC until its seconds change (at most `RTC_EDGE_SEARCH_MAX_US`) and anchors on the edge.
+     */
+    void anchorOnEdge();
+
+    /**
+     * @brief Writes network time to the RTC on the next network second edge after now and anchors on the write.
+     * @param epoch Network second that began at `edgeUs`.
+     * @param edgeUs `esp_timer_get_time()` at which `epoch` began.
+     */
+    void adjustOnEdge(uint32_t epoch, int64_t edgeUs);
+
+    /**
+     * @brief Feeds one SNTP offset measurement into the drift estimate.
+     * @param offsetUs Network minus RTC.
+     * @param timerUs `esp_timer_get_time()` of the measurement.
+     */
+    void learnDrift(int64_t offsetUs, int64_t timerUs);
+
+    /**
+     * @brief Time for the learned drift to carry the RTC from `offsetUs` (network minus RTC) to
+     *        `TIME_SYNC_TARGET_ERROR_MS` off, in milliseconds; 0 if it is already past.
      */
-    bool _getNetworkDateTimeNTP(DateTime& dt);
+    double msToTargetError(int64_t offsetUs) const;
+
+    /**
+     * @brief Records that the RTC was just set exactly to network time, restarting the drift measurement from it.
+     */
+    void resetDriftReference(int64_t timerUs);
+
+    bool _rtcOk; ///< Flag set to `true` if `_rtc.begin()` was successful, indicating RTC hardware is present and communicating.
 
     RTC_DS3231 _rtc;             ///< Instance of the `RTC_DS3231` library object, providing the interface to the RTC chip.
-    WiFiUDP _ntpUDP;           ///< `WiFiUDP` instance used by `NTPClient` for sending and receiving NTP packets over UDP.
-    NTPClient _timeClient;       ///< `NTPClient` object configured with `NTP_SERVER`, `NTP_TIMEZONE_OFFSET_SECONDS`, and `NTP_UPDATE_INTERVAL_MS`.
     LCDDisplay& _lcd_ref;        ///< Reference to the `LCDDisplay` object for outputting status and informational messages.
-    NetworkFacade& _networkFacade; ///< Reference to the `NetworkFacade` used for all network-dependent operations,
-                                 ///< such as checking connectivity, initiating NTP lookups, or making HTTP requests for time.
+    bool _needsSet;              ///< RTC time is invalid; apply the next network time whatever the offset.
+    bool _synced;                ///< A network time has been applied since boot.
+    unsigned long _lastSyncMs;   ///< `millis()` of the last applied network time.
+    bool _driftRefValid;         ///< `_driftRefOffsetUs`/`_driftRefUs` hold a reference measurement.
+    int64_t _driftRefOffsetUs;   ///< Network minus RTC at the reference measurement.
+    int64_t _driftRefUs;         ///< `esp_timer_get_time()` of the reference measurement.
+    int64_t _residualOffsetUs;   ///< Network minus RTC left by the last sync; 0 after an adjustment.
+    SyncStats _syncStats;        ///< Network time counters and drift estimate.
+    uint32_t _anchorEpoch;       ///< RTC second that began at `_anchorUs`.
+    int64_t _anchorUs;           ///< `esp_timer_get_time()` at the start of `_anchorEpoch`.
+    int64_t _preciseAnchorUs;    ///< Timer value of the last boot or adjustment anchor; base of the drift estimate.
+    unsigned long _lastCheckMs;  ///< `millis()` of the last `reanchorIfDue()` read.
+    ClockStats _clockStats;      ///< Extrapolated clock counters.
 };
 
 #endif // RTC_MANAGER_H
\ No newline at end of file
@@ -2,15 +2,34 @@
 #include "config.h" // For DEBUG_PRINTLN, DEBUG_PRINTF
 #include <SPI.h>   // For SPI.begin()
 #include <stdio.h> // For snprintf
-#include <string.h> // For strlen
+#include <string.h> // For strlen, memset, memcpy
+#include <RTClib.h> // For DateTime (CSV export timestamps)
+#include <esp_task_wdt.h> // For watchdog reset during preallocation and export
+
+static const uint8_t TELEMETRY_RECORDS_PER_SECTOR = TELEMETRY_SECTOR_SIZE / sizeof(TelemetryRecord);
+static const uint16_t TELEMETRY_SECTORS_PER_SEGMENT = TELEMETRY_SEGMENT_RECORDS / TELEMETRY_RECORDS_PER_SECTOR;
+static const uint32_t TELEMETRY_SEGMENT_BYTES = (uint32_t)TELEMETRY_SEGMENT_RECORDS * sizeof(TelemetryRecord);
 
 // printDebugStatus was a global function from the .ino file, now removed.
 // Using DEBUG_PRINTLN/F and LCD messages directly.
 
 SDCardLogger::SDCardLogger(LCDDisplay* lcd) :
     _lcd(lcd),
-    _sdCardOk(false) { // Initialize internal flag
-    // Constructor
+    _sdCardOk(false), // Initialize internal flag
+    _logReady(false),
+    _segmentIndex(0),
+    _sectorIndex(0),
+    _sectorFill(0),
+    _unflushedRecords(0),
+    _unflushedSinceMs(0),
+    _nextSeq(1),
+    _hasLatest(false),
+    _checkpointGeneration(0),
+    _restoredFromCheckpoint(false),
+    _logOpenMicros(0) {
+    memset(_sectorBuf, 0xFF, sizeof(_sectorBuf));
+    memset(&_latest, 0, sizeof(_latest));
+    memset(&_stats, 0, sizeof(_stats));
 }
 
 bool SDCardLogger::begin() {
@@ -38,17 +57,23 @@ bool SDCardLogger::begin() {
     DEBUG_PRINTF(3, "SDCardLogger: SD Card OK. Type: %d, Size: %lluMB\n", SD.cardType(), SD.cardSize() / (1024 * 1024));
     if (_lcd) _lcd->message(0, 3, "SD Card OK", true);
     _sdCardOk = true;
+    if (!openTelemetryLog()) {
+        DEBUG_PRINTLN(1, "SDCardLogger: Telemetry log unavailable.");
+    }
     return true;
 }
 
 bool SDCardLogger::reInit() {
     DEBUG_PRINTLN(2, "SDCardLogger: Re-initializing SD card...");
+    if (_segmentFile) _segmentFile.close();
+    if (_checkpointFile) _checkpointFile.close();
+    _logReady = false;
     SD.end(); // End current SD session
     delay(100); // Short delay before re-trying
     return begin(); // Call the main begin function
 }
 
-void SDCardLogger::logData(const char* dateTime, 
+void SDCardLogger::logData(uint32_t epoch,
                            float temp, float hum, float light,
                            float tempMin, float tempMax, 
                            float humMin, float humMax, 
@@ -58,40 +83,445 @@ void SDCardLogger::logData(const char* dateTime,
         DEBUG_PRINTLN(2, "SDCardLogger: Log attempt while SD not OK.");
         return;
     }
+    if (!_logReady && !openTelemetryLog()) {
+        DEBUG_PRINTLN(1, "SDCardLogger: Telemetry log not ready, record dropped.");
+        return;
+    }
 
-    File lf = SD.open("/log.csv", FILE_APPEND);
-    if (!lf) {
-        DEBUG_PRINTLN(1, "SDCardLogger: Failed to open log.csv for append. Attempting re-init...");
-        if (reInit()) { // Try to re-initialize SD card
-            lf = SD.open("/log.csv", FILE_APPEND); // Try opening again
-            if (!lf) {
-                DEBUG_PRINTLN(1, "SDCardLogger: Still failed to open log.csv after re-init.");
-                _sdCardOk = false; // Mark SD as not OK
-                return;
+    uint8_t relayBits = (r1 ? 0x01 : 0) | (r2 ? 0x02 : 0) | (r3 ? 0x04 : 0) | (r4 ? 0x08 : 0);
+    encodeTelemetryRecord(_latest, _nextSeq, epoch, temp, hum, light,
+                          tempMin, tempMax, humMin, humMax, lightMin, lightMax, relayBits);
+    memcpy(_sectorBuf + (size_t)_sectorFill * sizeof(TelemetryRecord), &_latest, sizeof(TelemetryRecord));
+    _hasLatest = true;
+    _nextSeq++;
+    _sectorFill++;
+    if (_unflushedRecords++ == 0) _unflushedSinceMs = millis();
+    _stats.recordsLogged++;
+
+    if (_sectorFill >= TELEMETRY_RECORDS_PER_SECTOR) {
+        if (writeSector()) advanceSector();
+    } else if (millis() - _unflushedSinceMs >= TELEMETRY_MAX_UNFLUSHED_MS) {
+        writeSector(); // Partial sector; rewritten in place as it fills up.
+    }
+}
+
+bool SDCardLogger::flush() {
+    if (!_logReady || _unflushedRecords == 0) return true;
+    return writeSector();
+}
+
+bool SDCardLogger::getLatestRecord(TelemetryRecord& rec) const {
+    if (!_hasLatest) return false;
+    rec = _latest;
+    return true;
+}
+
+uint32_t SDCardLogger::getDurableNextSeq() const {
+    return _logReady ? _nextSeq - _unflushedRecords : 0;
+}
+
+uint16_t SDCardLogger::readRecords(uint32_t fromSeq, TelemetryRecord* out, uint16_t maxRecords, uint32_t& nextSeq) {
+    nextSeq = fromSeq;
+    if (!_sdCardOk || !_logReady || maxRecords == 0) return 0;
+
+    const uint32_t capacity = (uint32_t)TELEMETRY_SEGMENT_COUNT * TELEMETRY_SEGMENT_RECORDS;
+    uint32_t endSeq = getDurableNextSeq();
+    if (fromSeq >= endSeq) return 0;
+    if (endSeq - fromSeq > capacity) fromSeq = endSeq - capacity; // Older records have been overwritten.
+
+    // Ring slot of _nextSeq; every record sits (_nextSeq - seq) slots before it.
+    uint32_t nextPos = (uint32_t)_segmentIndex * TELEMETRY_SEGMENT_RECORDS +
+                       (uint32_t)_sectorIndex * TELEMETRY_RECORDS_PER_SECTOR + _sectorFill;
+    uint8_t sector[TELEMETRY_SECTOR_SIZE];
+    uint32_t cachedSector = UINT32_MAX;
+    uint8_t sectorReads = 0;
+    File replayFile;
+    int16_t replaySegment = -1;
+    uint16_t n = 0;
+    uint32_t seq = fromSeq;
+
+    while (seq < endSeq && n < maxRecords) {
+        uint32_t pos = (nextPos + capacity - (_nextSeq - seq)) % capacity;
+        uint32_t globalSector = pos / TELEMETRY_RECORDS_PER_SECTOR;
+        uint8_t slot = pos % TELEMETRY_RECORDS_PER_SECTOR;
+        if (globalSector != cachedSector) {
+            if (sectorReads == TELEMETRY_REPLAY_MAX_SECTOR_READS) break;
+            sectorReads++;
+            esp_task_wdt_reset();
+            if (!readRingSector(globalSector, replayFile, replaySegment, sector)) {
+                seq += TELEMETRY_RECORDS_PER_SECTOR - slot; // Segment not created or unreadable: skip the sector.
+                continue;
             }
-        } else {
-            DEBUG_PRINTLN(1, "SDCardLogger: SD re-init failed during log attempt.");
-            _sdCardOk = false; // Mark SD as not OK
+            cachedSector = globalSector;
+        }
+        TelemetryRecord rec;
+        memcpy(&rec, sector + (size_t)slot * sizeof(TelemetryRecord), sizeof(rec));
+        if (isTelemetryRecordValid(rec) && rec.seq == seq) out[n++] = rec;
+        seq++;
+    }
+    if (replayFile) replayFile.close();
+    nextSeq = seq < endSeq ? seq : endSeq;
+    return n;
+}
+
+const SDCardLogger::TelemetryStats& SDCardLogger::getTelemetryStats() const {
+    return _stats;
+}
+
+int32_t SDCardLogger::exportCsv(const char* path) {
+    if (!_sdCardOk || !_logReady) {
+        DEBUG_PRINTLN(1, "SDCardLogger: CSV export requested while SD or telemetry log not ready.");
+        return -1;
+    }
+    if (!flush()) return -1;
+
+    File out = SD.open(path, FILE_WRITE);
+    if (!out) {
+        DEBUG_PRINTF(1, "SDCardLogger: Failed to open %s for CSV export.\n", path);
+        return -1;
+    }
+    out.println(F("DateTime,Temperature,Humidity,Light,TempMin,TempMax,HumMin,HumMax,LightMin,LightMax,Relay1,Relay2,Relay3,Relay4"));
+
+    TelemetryRecord batch[TELEMETRY_RECORDS_PER_SECTOR];
+    char ln[160];
+    int32_t exported = 0;
+    uint32_t seq = 1, nextSeq;
+
+    // readRecords() walks the ring in sequence order from the oldest record it still holds, which after a wrap
+    // sits in the tail of the segment being written, and skips lost slots.
+    for (;;) {
+        uint16_t n = readRecords(seq, batch, TELEMETRY_RECORDS_PER_SECTOR, nextSeq);
+        for (uint16_t i = 0; i < n; ++i) {
+            const TelemetryRecord& rec = batch[i];
+            DateTime dt(rec.epoch);
+            snprintf(ln, sizeof(ln), "%04d-%02d-%02d %02d:%02d:%02d,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%u,%u,%s,%s,%s,%s",
+                     dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(), dt.second(),
+                     rec.temperature(), rec.humidity(), rec.light(),
+                     rec.tempMin10 / 10.0f, rec.tempMax10 / 10.0f, rec.humMin10 / 10.0f, rec.humMax10 / 10.0f,
+                     (unsigned)rec.lightMin, (unsigned)rec.lightMax,
+                     rec.relay(0) ? "ON" : "OFF", rec.relay(1) ? "ON" : "OFF",
+                     rec.relay(2) ? "ON" : "OFF", rec.relay(3) ? "ON" : "OFF");
+            out.println(ln);
+            exported++;
+        }
+        if (nextSeq == seq) break;
+        seq = nextSeq;
+    }
+    out.close();
+    DEBUG_PRINTF(3, "SDCardLogger: Exported %ld records to %s.\n", (long)exported, path);
+    return exported;
+}
+
+bool SDCardLogger::openTelemetryLog() {
+    unsigned long startMicros = micros();
+    _logReady = false;
+    if (_segmentFile) _segmentFile.close();
+    if (_checkpointFile) _checkpointFile.close();
+    if (!SD.exists(TELEMETRY_LOG_DIR) && !SD.mkdir(TELEMETRY_LOG_DIR)) {
+        DEBUG_PRINTLN(1, "SDCardLogger: Failed to create telemetry log directory.");
+        return false;
+    }
+
+    _restoredFromCheckpoint = restoreFromCheckpoint();
+    if (!_restoredFromCheckpoint) {
+        DEBUG_PRINTLN(2, "SDCardLogger: No usable checkpoint, scanning telemetry segments.");
+        scanTelemetryLog();
+    }
+    if (_logReady) openCheckpointFile();
+
+    _logOpenMicros = micros() - startMicros;
+    DEBUG_PRINTF(2, "SDCardLogger: Telemetry log %s in %lu us (%s).\n", _logReady ? "opened" : "failed",
+                 _logOpenMicros, _restoredFromCheckpoint ? "checkpoint" : "scan");
+    return _logReady;
+}
+
+bool SDCardLogger::restoreFromCheckpoint() {
+    File cp = SD.open(TELEMETRY_CHECKPOINT_PATH, FILE_READ);
+    if (!cp) return false;
+    TelemetryCheckpoint slots[2];
+    size_t got = cp.read(reinterpret_cast<uint8_t*>(slots), sizeof(slots));
+    cp.close();
+    if (got != sizeof(slots)) return false;
+
+    const TelemetryCheckpoint* best = nullptr;
+    for (uint8_t i = 0; i < 2; ++i) {
+        if (isTelemetryCheckpointValid(slots[i]) && (!best || slots[i].generation > best->generation)) best = &slots[i];
+    }
+    if (best) _checkpointGeneration = best->generation + 1; // Keep generations increasing even if the log is rescanned.
+    if (!best || best->segmentIndex >= TELEMETRY_SEGMENT_COUNT || best->recordIndex >= TELEMETRY_SEGMENT_RECORDS) return false;
+
+    // One sector read: the sector holding the checkpointed record, which is also the sector to resume filling.
+    _segmentIndex = best->segmentIndex;
+    if (!openSegment(_segmentIndex)) return false;
+    _sectorIndex = best->recordIndex / TELEMETRY_RECORDS_PER_SECTOR;
+    uint8_t slot = best->recordIndex % TELEMETRY_RECORDS_PER_SECTOR;
+    if (!_segmentFile.seek((uint32_t)_sectorIndex * TELEMETRY_SECTOR_SIZE) ||
+        _segmentFile.read(_sectorBuf, sizeof(_sectorBuf)) != sizeof(_sectorBuf) ||
+        memcmp(_sectorBuf + (size_t)slot * sizeof(TelemetryRecord), &best->latest, sizeof(TelemetryRecord)) != 0) {
+        DEBUG_PRINTLN(2, "SDCardLogger: Checkpoint does not match the log.");
+        _segmentFile.close();
+        return false;
+    }
+
+    // A sector write can land before its checkpoint does; pick up any newer records in the same sector.
+    memcpy(&_latest, &best->latest, sizeof(TelemetryRecord));
+    while (slot + 1 < TELEMETRY_RECORDS_PER_SECTOR) {
+        TelemetryRecord next;
+        memcpy(&next, _sectorBuf + (size_t)(slot + 1) * sizeof(TelemetryRecord), sizeof(next));
+        if (!isTelemetryRecordValid(next) || next.seq != _latest.seq + 1) break;
+        _latest = next;
+        slot++;
+    }
+    if (slot + 1 == TELEMETRY_RECORDS_PER_SECTOR && (uint32_t)(_sectorIndex + 1) < TELEMETRY_SECTORS_PER_SEGMENT) {
+        TelemetryRecord next;
+        if (readRecord(_segmentFile, (uint32_t)(_sectorIndex + 1) * TELEMETRY_RECORDS_PER_SECTOR, next) &&
+            isTelemetryRecordValid(next) && next.seq == _latest.seq + 1) {
+            _segmentFile.close(); // The log moved on to a sector the checkpoint never saw.
+            return false;
+        }
+    }
+
+    _hasLatest = true;
+    _nextSeq = _latest.seq + 1;
+    _unflushedRecords = 0;
+    _sectorFill = slot + 1;
+    _logReady = true;
+    if (_sectorFill >= TELEMETRY_RECORDS_PER_SECTOR) {
+        advanceSector();
+    } else {
+        memset(_sectorBuf + (size_t)_sectorFill * sizeof(TelemetryRecord), 0xFF,
+               sizeof(_sectorBuf) - (size_t)_sectorFill * sizeof(TelemetryRecord));
+    }
+    return _logReady;
+}
+
+bool SDCardLogger::scanTelemetryLog() {
+    // The newest segment is the one whose first record has the highest sequence number.
+    char path[24];
+    int newest = -1;
+    uint32_t newestHeadSeq = 0;
+    for (uint8_t i = 0; i < TELEMETRY_SEGMENT_COUNT; ++i) {
+        segmentPath(i, path, sizeof(path));
+        File f = SD.open(path, FILE_READ);
+        if (!f) continue;
+        TelemetryRecord head;
+        if (f.size() == TELEMETRY_SEGMENT_BYTES && readRecord(f, 0, head) &&
+            isTelemetryRecordValid(head) && head.seq > newestHeadSeq) {
+            newest = i;
+            newestHeadSeq = head.seq;
+        }
+        f.close();
+    }
+
+    memset(_sectorBuf, 0xFF, sizeof(_sectorBuf));
+    _sectorFill = 0;
+    _unflushedRecords = 0;
+
+    if (newest < 0) {
+        DEBUG_PRINTLN(3, "SDCardLogger: No telemetry records found, starting a new log.");
+        _segmentIndex = 0;
+        _sectorIndex = 0;
+        if (!_hasLatest) _nextSeq = 1;
+        _logReady = openSegment(_segmentIndex);
+        return _logReady;
+    }
+
+    _segmentIndex = (uint8_t)newest;
+    if (!openSegment(_segmentIndex)) return false;
+
+    // Records [0, last] of the newest segment are valid and consecutive; binary search for `last`.
+    uint32_t lo = 0, hi = TELEMETRY_SEGMENT_RECORDS;
+    TelemetryRecord rec;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (readRecord(_segmentFile, mid, rec) && isTelemetryRecordValid(rec) && rec.seq == newestHeadSeq + mid) lo = mid;
+        else hi = mid;
+    }
+    if (!readRecord(_segmentFile, lo, _latest)) {
+        _segmentFile.close();
+        return false;
+    }
+    _hasLatest = true;
+    _nextSeq = _latest.seq + 1;
+    DEBUG_PRINTF(3, "SDCardLogger: Resuming telemetry log at segment %u, record %lu (seq %lu).\n",
+                 (unsigned)_segmentIndex, (unsigned long)(lo + 1), (unsigned long)_nextSeq);
+
+    uint32_t next = lo + 1;
+    _logReady = true;
+    if (next >= TELEMETRY_SEGMENT_RECORDS) {
+        _sectorIndex = TELEMETRY_SECTORS_PER_SEGMENT - 1;
+        advanceSector();
+        return _logReady;
+    }
+
+    // Reload the partially filled sector so that new records are added after the existing ones.
+    _sectorIndex = next / TELEMETRY_RECORDS_PER_SECTOR;
+    _sectorFill = next % TELEMETRY_RECORDS_PER_SECTOR;
+    if (_sectorFill > 0) {
+        _segmentFile.seek((uint32_t)_sectorIndex * TELEMETRY_SECTOR_SIZE);
+        size_t keep = (size_t)_sectorFill * sizeof(TelemetryRecord);
+        if (_segmentFile.read(_sectorBuf, keep) != keep) {
+            _segmentFile.close();
+            _logReady = false;
+        }
+    }
+    return _logReady;
+}
+
+bool SDCardLogger::openSegment(uint8_t index) {
+    char path[24];
+    segmentPath(index, path, sizeof(path));
+
+    bool preallocated = false;
+    File f = SD.open(path, FILE_READ);
+    if (f) {
+        preallocated = (f.size() == TELEMETRY_SEGMENT_BYTES);
+        f.close();
+    }
+
+    if (!preallocated) {
+        // Write the whole segment once so that later sector writes never extend the file.
+        DEBUG_PRINTF(3, "SDCardLogger: Preallocating %s (%lu bytes)...\n", path, (unsigned long)TELEMETRY_SEGMENT_BYTES);
+        File nf = SD.open(path, FILE_WRITE);
+        if (!nf) {
+            DEBUG_PRINTF(1, "SDCardLogger: Failed to create %s.\n", path);
+            return false;
+        }
+        uint8_t erased[TELEMETRY_SECTOR_SIZE];
+        memset(erased, 0xFF, sizeof(erased));
+        for (uint16_t s = 0; s < TELEMETRY_SECTORS_PER_SEGMENT; ++s) {
+            if (nf.write(erased, sizeof(erased)) != sizeof(erased)) {
+                DEBUG_PRINTF(1, "SDCardLogger: Preallocation of %s failed (disk full?).\n", path);
+                nf.close();
+                SD.remove(path);
+                return false;
+            }
+            if ((s & 0x1F) == 0) esp_task_wdt_reset();
+        }
+        nf.close();
+    }
+
+    _segmentFile = SD.open(path, "r+");
+    if (!_segmentFile) {
+        DEBUG_PRINTF(1, "SDCardLogger: Failed to open %s for writing.\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool SDCardLogger::writeSector() {
+    if (!_segmentFile) return false;
+    size_t written = 0;
+    if (_segmentFile.seek((uint32_t)_sectorIndex * TELEMETRY_SECTOR_SIZE)) {
+        written = _segmentFile.write(_sectorBuf, sizeof(_sectorBuf));
+        _segmentFile.flush();
+    }
+    if (written != sizeof(_sectorBuf)) {
+        DEBUG_PRINTLN(1, "SDCardLogger: Error writing telemetry sector or disk full.");
+        _segmentFile.close();
+        _logReady = false;
+        _sdCardOk = false; // A write error is serious; checkSdCard() will re-init later.
+        return false;
+    }
+    _unflushedRecords = 0;
+    _stats.sectorWrites++;
+    _stats.bytesWritten += written;
+    writeCheckpoint();
+    DEBUG_PRINTF(4, "SDCardLogger: Sector %u/%u written. %lu records, %lu bytes total.\n",
+                 (unsigned)_segmentIndex, (unsigned)_sectorIndex,
+                 (unsigned long)_stats.recordsLogged, (unsigned long)_stats.bytesWritten);
+    return true;
+}
+
+void SDCardLogger::openCheckpointFile() {
+    if (!SD.exists(TELEMETRY_CHECKPOINT_PATH)) {
+        File nf = SD.open(TELEMETRY_CHECKPOINT_PATH, FILE_WRITE);
+        if (!nf) {
+            DEBUG_PRINTLN(1, "SDCardLogger: Failed to create checkpoint file.");
             return;
         }
+        uint8_t erased[2 * sizeof(TelemetryCheckpoint)];
+        memset(erased, 0xFF, sizeof(erased));
+        nf.write(erased, sizeof(erased));
+        nf.close();
     }
+    _checkpointFile = SD.open(TELEMETRY_CHECKPOINT_PATH, "r+");
+    if (!_checkpointFile) DEBUG_PRINTLN(1, "SDCardLogger: Failed to open checkpoint file.");
+}
+
+void SDCardLogger::writeCheckpoint() {
+    if (!_checkpointFile || _sectorFill == 0) return;
 
-    if (lf.size() == 0) { // If file is new or empty, write header
-        lf.println(F("DateTime,Temperature,Humidity,Light,TempMin,TempMax,HumMin,HumMax,LightMin,LightMax,Relay1,Relay2,Relay3,Relay4"));
+    TelemetryCheckpoint cp;
+    memset(&cp, 0, sizeof(cp));
+    cp.generation = _checkpointGeneration;
+    cp.segmentIndex = _segmentIndex;
+    cp.recordIndex = (uint32_t)_sectorIndex * TELEMETRY_RECORDS_PER_SECTOR + _sectorFill - 1;
+    memcpy(&cp.latest, _sectorBuf + (size_t)(_sectorFill - 1) * sizeof(TelemetryRecord), sizeof(TelemetryRecord));
+    sealTelemetryCheckpoint(cp);
+
+    // Alternate slots so the previous checkpoint survives a torn write.
+    uint32_t offset = (_checkpointGeneration & 1) * sizeof(TelemetryCheckpoint);
+    if (!_checkpointFile.seek(offset) ||
+        _checkpointFile.write(reinterpret_cast<const uint8_t*>(&cp), sizeof(cp)) != sizeof(cp)) {
+        DEBUG_PRINTLN(1, "SDCardLogger: Checkpoint write failed; next boot will scan the log.");
+        _checkpointFile.close();
+        return;
     }
+    _checkpointFile.flush();
+    _checkpointGeneration++;
+}
 
-    char ln[250]; // Buffer for log line
-    snprintf(ln, sizeof(ln), "%s,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%s,%s,%s,%s",
-             dateTime, temp, hum, light,
-             tempMin, tempMax, humMin, humMax, lightMin, lightMax,
-             r1 ? "ON" : "OFF", r2 ? "ON" : "OFF", r3 ? "ON" : "OFF", r4 ? "ON" : "OFF");
-    
-    size_t bytesWritten = lf.println(ln);
-    if (bytesWritten < strlen(ln)) { // Check if less than expected, not just not equal to strlen + 2, as println might handle \r\n differently or not at all on some platforms. More robust to check if basic string length was written.
-        DEBUG_PRINTLN(1, "SDCardLogger: Error writing data to log.csv or disk full.");
-        _sdCardOk = false; // A write error is serious
+bool SDCardLogger::wasRestoredFromCheckpoint() const {
+    return _restoredFromCheckpoint;
+}
+
+unsigned long SDCardLogger::getLogOpenMicros() const {
+    return _logOpenMicros;
+}
+
+void SDCardLogger::advanceSector() {
+    memset(_sectorBuf, 0xFF, sizeof(_sectorBuf));
+    _sectorFill = 0;
+    _unflushedRecords = 0;
+    if (++_sectorIndex < TELEMETRY_SECTORS_PER_SEGMENT) return;
+
+    _segmentFile.close();
+    _segmentIndex = (_segmentIndex + 1) % TELEMETRY_SEGMENT_COUNT;
+    _sectorIndex = 0;
+    if (!openSegment(_segmentIndex)) _logReady = false;
+}
+
+bool SDCardLogger::readRingSector(uint32_t globalSector, File& replayFile, int16_t& replaySegment, uint8_t* buf) {
+    uint8_t segment = globalSector / TELEMETRY_SECTORS_PER_SEGMENT;
+    uint16_t sectorInSegment = globalSector % TELEMETRY_SECTORS_PER_SEGMENT;
+    if (segment == _segmentIndex && sectorInSegment == _sectorIndex) {
+        memcpy(buf, _sectorBuf, TELEMETRY_SECTOR_SIZE); // Written part matches the card; the rest is 0xFF.
+        return true;
     }
-    lf.close();
+
+    File* f = &_segmentFile;
+    if (segment != _segmentIndex) {
+        if (replaySegment != segment) {
+            if (replayFile) replayFile.close();
+            char path[24];
+            segmentPath(segment, path, sizeof(path));
+            replayFile = SD.open(path, FILE_READ);
+            replaySegment = replayFile ? segment : -1;
+            if (!replayFile) return false;
+        }
+        f = &replayFile;
+    }
+    return f->seek((uint32_t)sectorInSegment * TELEMETRY_SECTOR_SIZE) && f->read(buf, TELEMETRY_SECTOR_SIZE) == TELEMETRY_SECTOR_SIZE;
+}
+
+bool SDCardLogger::readRecord(File& f, uint32_t index, TelemetryRecord& rec) {
+    if (!f.seek(index * sizeof(TelemetryRecord))) return false;
+    return f.read(reinterpret_cast<uint8_t*>(&rec), sizeof(rec)) == sizeof(rec);
+}
+
+void SDCardLogger::segmentPath(uint8_t index, char* buf, size_t bufSize) {
+    snprintf(buf, bufSize, TELEMETRY_LOG_DIR "/seg%02u.bin", (unsigned)index);
 }
 
 bool SDCardLogger::isSdCardOk() const {
@@ -12,10 +12,12 @@
  * - Re-initialization: Offering a mechanism to attempt re-initializing the SD card
  *   if it becomes unresponsive (`reInit()`). This is also automatically attempted by
  *   logging methods upon encountering write errors.
- * - Structured Data Logging: Writing comprehensive sensor readings, configured thresholds,
- *   and relay states to a CSV file. The filename for this log is typically defined by
- *   `LOG_FILENAME` in `config.h` (e.g., "/log.csv"). If the file doesn't exist or is empty,
- *   a header row is automatically added.
+ * - Structured Data Logging: Writing sensor readings, configured thresholds and relay states
+ *   as fixed 32-byte binary records (`TelemetryRecord.h`) into a ring of preallocated segment
+ *   files under `TELEMETRY_LOG_DIR`. Records are collected in a RAM sector buffer and written
+ *   as whole 512-byte sectors at fixed offsets, so a log write never grows a file or touches the
+ *   FAT. Each record carries a sequence number and CRC; `begin()` uses them to find the newest
+ *   record and resume writing after it. `exportCsv()` converts the log to the old CSV layout.
  * - Event Logging: Writing timestamped system events or general messages to a separate
  *   plain text file. The filename for this event log is typically `EVENT_LOG_FILENAME` in
  *   `config.h` (e.g., "/event_log.txt").
@@ -32,6 +34,7 @@
 #include <FS.h>          // ESP32/ESP8266 Filesystem library, providing the `File` object and `FS` interface.
 #include <SD.h>          // Arduino SD card library for SPI communication with the card.
 #include "LCDDisplay.h"  // For displaying status messages and errors related to SD card operations.
+#include "TelemetryRecord.h" // Binary record format of the telemetry log.
 #include "config.h"      // Essential for `SD_CS_PIN`, `LOG_FILENAME`, `EVENT_LOG_FILENAME`,
                          // `DEBUG_PRINTLN`, and other related configurations.
  
@@ -71,6 +74,7 @@ public:
      * 1. Initialize the SPI communication with the SD card using `SD.begin(SD_CS_PIN)`,
      *    where `SD_CS_PIN` is defined in `config.h`.
      * 2. Mount the SD card filesystem.
+     * 3. Open the telemetry log and locate the newest record (see `openTelemetryLog()`).
      *
      * It updates the internal `_sdCardOk` status flag based on the success or failure of
      * these operations. Messages indicating the outcome (e.g., "SD Init OK", "SD Init FAIL")
@@ -109,23 +113,29 @@ public:
     bool isSdCardOk() const;
 
     /**
-     * @brief Logs a comprehensive set of sensor data, configuration thresholds, and current relay states
-     * to a CSV (Comma Separated Values) file on the SD card.
+     * @struct TelemetryStats
+     * @brief Write counters for the telemetry log since boot.
+     */
+    struct TelemetryStats {
+        uint32_t recordsLogged; ///< Records accepted by `logData()`.
+        uint32_t sectorWrites;  ///< Sector writes issued to the card (full and partial).
+        uint32_t bytesWritten;  ///< Bytes written to the card, excluding segment preallocation.
+    };
+
+    /**
+     * @brief Logs sensor data, configuration thresholds and relay states as one binary telemetry record.
      *
-     * The target filename is specified by `LOG_FILENAME` in `config.h` (e.g., "/log.csv").
-     * If the log file does not exist or is empty upon the first call (or after being cleared),
-     * a header row is automatically written to define the columns. The standard header is:
-     * `"DateTime,Temp,Humidity,Light,TempMin,TempMax,HumMin,HumMax,LightMin,LightMax,R1,R2,R3,R4"`
-     * Subsequent calls append a new row of data.
+     * The record is appended to a RAM sector buffer. The buffer is written to the current segment file
+     * when it holds a full sector (16 records), or as a partial sector once its oldest record is older
+     * than `TELEMETRY_MAX_UNFLUSHED_MS`. When a segment is full the next one in the ring is used
+     * (created and preallocated on first use), overwriting the oldest data.
      *
      * Error Handling:
-     * If opening or writing to the log file fails, this method will automatically attempt to
-     * `reInit()` the SD card once. If the re-initialization is successful, it will retry the
-     * logging operation. If re-initialization fails or the retry also fails, an error message
-     * is displayed on the `_lcd` and printed to Serial, and `_sdCardOk` might be set to `false`.
+     * If a sector write fails, `_sdCardOk` is cleared and the telemetry log is closed. Records still in the
+     * RAM buffer are lost; the periodic `reInit()` from the main loop reopens the log and resumes after the
+     * last record found on the card.
      *
-     * @param dateTime A C-style string representing the current date and time when the data was recorded
-     *                 (e.g., "YYYY-MM-DD HH:MM:SS" format from an RTC).
+     * @param epoch RTC time of the sample in seconds since 1970 (see `RTCManager::epoch()`).
      * @param temp Current ambient temperature reading (float, e.g., in Celsius).
      * @param hum Current ambient humidity reading (float, e.g., in %).
      * @param light Current ambient light intensity reading (float, e.g., in Lux or a raw ADC value).
@@ -140,13 +150,79 @@ public:
      * @param r3 Boolean state of Relay 3.
      * @param r4 Boolean state of Relay 4.
      */
-    void logData(const char* dateTime,
+    void logData(uint32_t epoch,
                  float temp, float hum, float light,
                  float tempMin, float tempMax,
                  float humMin, float humMax,
                  float lightMin, float lightMax,
                  bool r1, bool r2, bool r3, bool r4);
 
+    /**
+     * @brief Writes any buffered telemetry records to the card as a (partial) sector.
+     * @return `true` if nothing was pending or the write succeeded.
+     */
+    bool flush();
+
+    /**
+     * @brief Gets the newest telemetry record, either logged since boot or recovered from the card by `begin()`.
+     * @param[out] rec Receives the record.
+     * @return `true` if a record is available.
+     */
+    bool getLatestRecord(TelemetryRecord& rec) const;
+
+    /**
+     * @brief Gets the sequence number that follows the newest record already written to the card.
+     * Records still in the RAM sector buffer are excluded, so everything below this value survives a reset.
+     * @return Next durable sequence number, or 0 if the telemetry log is not open.
+     */
+    uint32_t getDurableNextSeq() const;
+
+    /**
+     * @brief Reads records already on the card in sequence order, for replaying the log (see `TelemetryOutbox`).
+     *
+     * Each sequence number has a fixed slot in the ring relative to the write position, so the records are
+     * located without scanning. Slots that are erased, fail their CRC or hold another sequence number (records
+     * lost to a write error, or overwritten by the ring) are skipped. Stops after `maxRecords` records, at the
+     * durable end of the log, or after `TELEMETRY_REPLAY_MAX_SECTOR_READS` sector reads. The sector being filled
+     * in RAM replaces older records on its next write, so once the ring has wrapped, the records still on the card
+     * in its unfilled slots count as overwritten.
+     *
+     * @param fromSeq First sequence number wanted. Numbers the ring no longer holds are skipped.
+     * @param[out] out Receives the records.
+     * @param maxRecords Capacity of `out`.
+     * @param[out] nextSeq Sequence number to continue from; every number below it was either returned or is gone.
+     * @return Number of records stored in `out`.
+     */
+    uint16_t readRecords(uint32_t fromSeq, TelemetryRecord* out, uint16_t maxRecords, uint32_t& nextSeq);
+
+    /**
+     * @brief Exports the whole telemetry log, oldest record first, to a CSV file.
+     * The columns match the CSV log written by earlier firmware:
+     * `DateTime,Temperature,Humidity,Light,TempMin,TempMax,HumMin,HumMax,LightMin,LightMax,Relay1,Relay2,Relay3,Relay4`.
+     * Buffered records are flushed first. Blocks while the log is read; the watchdog is fed per sector.
+     * @param path Target file, overwritten if it exists.
+     * @return Number of records exported, or -1 if the card or the log is unavailable.
+     */
+    int32_t exportCsv(const char* path = TELEMETRY_CSV_EXPORT_PATH);
+
+    /**
+     * @brief Gets the telemetry write counters.
+     * @return Reference to the internal `TelemetryStats`.
+     */
+    const TelemetryStats& getTelemetryStats() const;
+
+    /**
+     * @brief Checks how the telemetry log write position was found when it was last opened.
+     * @return `true` if it came from the checkpoint file, `false` if the segment files had to be scanned.
+     */
+    bool wasRestoredFromCheckpoint() const;
+
+    /**
+     * @brief Gets the time taken to open the telemetry log (checkpoint restore or scan) when it was last opened.
+     * @return Duration in microseconds.
+     */
+    unsigned long getLogOpenMicros() const;
+
     /**
      * @brief Logs an event message with a timestamp to a separate event log file on the SD card.
      *
@@ -183,6 +259,105 @@ private:
      * This flag is checked before attempting logging operations and updated by `begin()` and `reInit()`.
      */
     bool _sdCardOk;
+
+    // --- Telemetry Log State ---
+    File _segmentFile;                          ///< Current segment file, kept open in "r+" mode between sector writes.
+    bool _logReady;                             ///< `true` once the log has been opened (and recovered) by `openTelemetryLog()`.
+    uint8_t _segmentIndex;                      ///< Segment currently being written (0..`TELEMETRY_SEGMENT_COUNT` - 1).
+    uint16_t _sectorIndex;                      ///< Sector within the segment that `_sectorBuf` maps to.
+    uint8_t _sectorFill;                        ///< Records currently held in `_sectorBuf`.
+    uint8_t _unflushedRecords;                  ///< Records in `_sectorBuf` not yet written to the card.
+    unsigned long _unflushedSinceMs;            ///< `millis()` when the oldest unflushed record was added.
+    uint32_t _nextSeq;                          ///< Sequence number of the next record.
+    uint8_t _sectorBuf[TELEMETRY_SECTOR_SIZE];  ///< Write-back buffer for the current sector. Unused slots are 0xFF.
+    TelemetryRecord _latest;                    ///< Newest record logged or recovered.
+    bool _hasLatest;                            ///< `true` if `_latest` holds a record.
+    TelemetryStats _stats;                      ///< Write counters.
+    File _checkpointFile;                       ///< `TELEMETRY_CHECKPOINT_PATH`, kept open in "r+" mode.
+    uint32_t _checkpointGeneration;             ///< Generation number of the next checkpoint write; its low bit selects the slot.
+    bool _restoredFromCheckpoint;               ///< Whether the last `openTelemetryLog()` used the checkpoint.
+    unsigned long _logOpenMicros;               ///< Duration of the last `openTelemetryLog()`.
+
+    /**
+     * @brief Creates the log directory if needed and finds the write position, from the checkpoint file if
+     *        possible and by scanning the segment files otherwise. The time taken is recorded for `getLogOpenMicros()`.
+     * @return `true` if the log is ready for writing.
+     */
+    bool openTelemetryLog();
+
+    /**
+     * @brief Restores the write position from the newest valid checkpoint slot.
+     * Reads the checkpoint file and the one sector holding the checkpointed record, and verifies that the
+     * record on the card matches the checkpoint. Records written after the checkpoint in the same sector are
+     * picked up; if the log continued into a later sector the checkpoint is rejected.
+     * @return `true` if the log is ready for writing.
+     */
+    bool restoreFromCheckpoint();
+
+    /**
+     * @brief Finds the write position by scanning the segment files.
+     * The segment with the highest valid head sequence number is the newest; within it, a binary search on
+     * "valid CRC and consecutive sequence number" finds the last record written.
+     * @return `true` if the log is ready for writing.
+     */
+    bool scanTelemetryLog();
+
+    /**
+     * @brief Opens (creating if needed) the two-slot checkpoint file.
+     */
+    void openCheckpointFile();
+
+    /**
+     * @brief Writes the position of the newest record in `_sectorBuf` to the next checkpoint slot.
+     * Called after every successful sector write. Failures are logged and only cost a scan on the next boot.
+     */
+    void writeCheckpoint();
+
+    /**
+     * @brief Reads one sector of the ring, from `_sectorBuf` if it is the sector being written.
+     * @param globalSector Sector index across all segments.
+     * @param replayFile Segment file opened by a previous call (reused while it is the right segment).
+     * @param replaySegment Segment held open in `replayFile`, or -1.
+     * @param[out] buf Receives `TELEMETRY_SECTOR_SIZE` bytes.
+     * @return `true` if the sector was read.
+     */
+    bool readRingSector(uint32_t globalSector, File& replayFile, int16_t& replaySegment, uint8_t* buf);
+
+    /**
+     * @brief Opens a segment file for writing, creating and preallocating it (filled with 0xFF) if it does not exist
+     *        or has the wrong size.
+     * @param index Segment index.
+     * @return `true` if `_segmentFile` is open.
+     */
+    bool openSegment(uint8_t index);
+
+    /**
+     * @brief Writes `_sectorBuf` at the current sector offset of the segment file.
+     * @return `true` on success. On failure the log is closed and `_sdCardOk` is cleared.
+     */
+    bool writeSector();
+
+    /**
+     * @brief Moves to the next sector after a full sector has been written, switching segments when needed.
+     */
+    void advanceSector();
+
+    /**
+     * @brief Reads one record of a segment file by index.
+     * @param f Open segment file.
+     * @param index Record index within the segment.
+     * @param[out] rec Receives the record.
+     * @return `true` if the record was read (not necessarily valid).
+     */
+    static bool readRecord(File& f, uint32_t index, TelemetryRecord& rec);
+
+    /**
+     * @brief Builds the path of a segment file, e.g. "/tlm/seg03.bin".
+     * @param index Segment index.
+     * @param buf Output buffer.
+     * @param bufSize Size of `buf`.
+     */
+    static void segmentPath(uint8_t index, char* buf, size_t bufSize);
 };
 
 #endif // SDCARD_LOGGER_H
\ No newline at end of file
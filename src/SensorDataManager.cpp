@@ -1,5 +1,6 @@
 #include "SensorDataManager.h"
 #include "config.h" // For DEBUG_PRINTLN and DEBUG_LEVEL
+#include "SDCardLogger.h" // For the telemetry log read by loadFromLog()
 
 SensorDataManager::SensorDataManager() :
     temperature(-99.9), humidity(-1.0), light(-1.0), // Default invalid values
@@ -36,99 +37,25 @@ void SensorDataManager::updateData(float temp, float hum, float lgt) {
     DEBUG_PRINTF(3, "Sensor data: T=%.1f H=%.0f L=%.0f\n", temperature, humidity, light);
 }
 
-bool SensorDataManager::loadFromLog() {
+bool SensorDataManager::loadFromLog(const SDCardLogger& logger) {
     DEBUG_PRINTLN(3, "SensorDataManager: Loading from log...");
-    if (!SD.cardType() || SD.cardType() == CARD_NONE) { // Check if SD card is present
-        DEBUG_PRINTLN(1, "Err: No SD card for log load.");
+    TelemetryRecord rec;
+    if (!logger.getLatestRecord(rec)) {
+        DEBUG_PRINTLN(2, "Warn: Log empty");
         return false;
     }
-    File f = SD.open("/log.csv", FILE_READ);
-    if (!f) { 
-        DEBUG_PRINTLN(1, "Err: Log open fail"); 
-        return false; 
-    }
-    if (!f.size()) { 
-        DEBUG_PRINTLN(2, "Warn: Log empty"); 
-        f.close(); 
-        return false; 
-    }
 
-    String lastLine = ""; 
-    long fileSize = f.size();
-    long position = fileSize - 1; 
-    int charsRead = 0;
-    const int maxCharsToRead = 512; // Safety break for reading last line
-
-    // Seek backwards from end of file to find the start of the last line
-    while (position > 0 && charsRead < maxCharsToRead) {
-        f.seek(position);
-        char c = f.read();
-        if (c == '\n') {
-            if (lastLine.length() > 0) break; // Found start of previous line, current lastLine is complete
-        } else if (c != '\r') {
-            lastLine = c + lastLine; // Prepend char to build line in correct order
-        }
-        position--;
-        charsRead++;
-    }
-    // If loop finished due to position=0 or maxCharsToRead, and lastLine is still empty,
-    // it might be a single-line file. Read from beginning.
-    if (lastLine.length() == 0 && fileSize > 0 && f.available()) {
-        f.seek(0);
-        lastLine = f.readStringUntil('\n');
-        lastLine.trim();
-    }
-    
-    f.close();
-
-    if (lastLine.length() == 0 || lastLine.startsWith(F("DateTime,"))) { 
-        DEBUG_PRINTLN(2, "Warn: Last log line invalid or header."); 
-        return false; 
-    }
+    tempMin  = rec.tempMin10 / 10.0f;
+    tempMax  = rec.tempMax10 / 10.0f;
+    humMin   = rec.humMin10 / 10.0f;
+    humMax   = rec.humMax10 / 10.0f;
+    lightMin = rec.lightMin;
+    lightMax = rec.lightMax;
 
-    // Parse the CSV: DateTime,Temp,Hum,Light,TMin,TMax,HMin,HMax,LMin,LMax,R1,R2,R3,R4
-    // We are interested in fields 1-9 (0-indexed after split)
-    int commaIndices[14]; // Max 13 commas for 14 fields
-    commaIndices[0] = -1; // Start before the first char
-    int fieldCount = 0;
-
-    for(int i = 1; i < 14; ++i) {
-        commaIndices[i] = lastLine.indexOf(',', commaIndices[i-1] + 1);
-        if (commaIndices[i] == -1 && i < 13) { // If a comma is missing before the last field
-            DEBUG_PRINTLN(1,"Err: Log parse fields - not enough commas."); 
-            return false;
-        }
-        fieldCount = i;
-        if (commaIndices[i] == -1) break; // Stop if no more commas (last field)
-    }
-    if (fieldCount < 10) { // Need at least up to LightMax (index 9)
-         DEBUG_PRINTLN(1,"Err: Log parse fields - too few fields.");
-         return false;
-    }
-
-
-    try {
-        // DateTime is commaIndices[0]+1 to commaIndices[1]
-        temperature = lastLine.substring(commaIndices[1] + 1, commaIndices[2]).toFloat();
-        humidity    = lastLine.substring(commaIndices[2] + 1, commaIndices[3]).toFloat();
-        light       = lastLine.substring(commaIndices[3] + 1, commaIndices[4]).toFloat();
-        tempMin     = lastLine.substring(commaIndices[4] + 1, commaIndices[5]).toFloat();
-        tempMax     = lastLine.substring(commaIndices[5] + 1, commaIndices[6]).toFloat();
-        humMin      = lastLine.substring(commaIndices[6] + 1, commaIndices[7]).toFloat();
-        humMax      = lastLine.substring(commaIndices[7] + 1, commaIndices[8]).toFloat();
-        lightMin    = lastLine.substring(commaIndices[8] + 1, commaIndices[9]).toFloat();
-        // For the last field (lightMax), if commaIndices[10] is -1, it means it's the end of the string
-        int endIdxLightMax = (commaIndices[10] == -1) ? lastLine.length() : commaIndices[10];
-        lightMax    = lastLine.substring(commaIndices[9] + 1, endIdxLightMax).toFloat();
-        
-        DEBUG_PRINTLN(3, "Log loaded successfully into SensorDataManager."); 
-        // Optionally, update current sensor values if they are valid from log
-        updateData(temperature, humidity, light); 
-        return true;
-    } catch(...) { // Generic catch, consider more specific error handling if possible
-        DEBUG_PRINTLN(1, "Err: Log parse exception during conversion."); 
-        return false; 
-    }
+    DEBUG_PRINTF(3, "Log loaded successfully into SensorDataManager (seq %lu).\n", (unsigned long)rec.seq);
+    // Optionally, update current sensor values if they are valid from log
+    updateData(rec.temperature(), rec.humidity(), rec.light());
+    return true;
 }
 
 // Getter methods
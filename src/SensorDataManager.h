@@ -23,9 +23,8 @@
  *     on user configuration or system settings.
  *   Both methods perform basic validation on the input values.
  * - Persistence (`loadFromLog()`): Provides a mechanism to initialize or restore sensor
- *   readings and threshold values by parsing them from the last entry in a log file stored
- *   on an SD card. This allows the system to resume with previously known states.
- *   This functionality relies on `<FS.h>` and `<SD.h>` for file system operations.
+ *   readings and threshold values from the newest record of the SD card telemetry log
+ *   (recovered by `SDCardLogger::begin()`). This allows the system to resume with previously known states.
  * - Access: Provides getter methods (`getTempMin()`, `getTempMax()`, etc.) for retrieving
  *   the configured thresholds. Current sensor values are accessed directly via public members.
  *
@@ -36,10 +35,8 @@
 #define SENSOR_DATA_MANAGER_H
 
 #include <Arduino.h> // Core Arduino framework, provides basic types (float, bool) and functions.
-#include <FS.h>      // Filesystem library (part of ESP32/Arduino core), used for File operations,
-                     // specifically for `loadFromLog()` when reading from the SD card.
-#include <SD.h>      // SD card library, necessary for interacting with the SD card,
-                     // particularly for `SD.open()` in `loadFromLog()`.
+
+class SDCardLogger; // Source of the last logged record for `loadFromLog()`.
 
 // Note on config.h: DEBUG_PRINTLN and other debugging macros, if used by SensorDataManager,
 // would typically be handled in the SensorDataManager.cpp implementation file. If SensorDataManager.h
@@ -132,20 +129,17 @@ public:
 
     /**
      * @brief Attempts to load the last known sensor data readings and operational thresholds
-     *        from a specified log file on the SD card (e.g., `DATA_LOG_FILENAME` from `config.h`).
+     *        from the newest record of the SD card telemetry log.
      *
-     * This function reads the last valid line from the log file, parses it to extract
-     * temperature, humidity, light, and their respective min/max thresholds, and then
-     * updates the corresponding member variables of this `SensorDataManager` instance.
+     * The newest record is located by `SDCardLogger::begin()` when it opens the log, so this
+     * does not touch the card. The record's readings and thresholds are applied to this instance.
      * This is useful for restoring the system to a previously known state on startup.
-     * Uses `SD.open()` and `File` objects for SD card interaction.
      *
-     * @return `true` if data was successfully found, read, parsed from the log file,
-     *         and applied to the current instance.
-     * @return `false` if the SD card cannot be initialized, the log file cannot be opened,
-     *         the file is empty, or the data format is invalid.
+     * @param logger The SD card logger holding the telemetry log.
+     * @return `true` if a record was available and applied to the current instance.
+     * @return `false` if the log holds no records (or the SD card was not available).
      */
-    bool loadFromLog();
+    bool loadFromLog(const SDCardLogger& logger);
 
     // --- Getter Methods for Thresholds ---
     // These provide controlled read-only access to the threshold values.
@@ -0,0 +1,236 @@
+#include "SntpClient.h"
+#include <esp_timer.h>             // For esp_timer_get_time(), the T1/T4 timebase
+#include <esp_system.h>            // For esp_random()
+#include <lwip/dns.h>              // For dns_gethostbyname()
+#include <lwip/priv/tcpip_priv.h>  // For tcpip_api_call(), to start DNS on the TCP/IP task
+
+static const uint16_t NTP_PORT = 123;
+static const size_t NTP_PACKET_LEN = 48;
+static const uint32_t NTP_UNIX_OFFSET_S = 2208988800UL; ///< Seconds from 1900 (NTP era 0) to 1970.
+
+static uint32_t readBe32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void writeBe32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+/**
+ * @brief Converts an NTP fraction of a second (units of 2^-32 s) to microseconds.
+ */
+static int64_t fractionToUs(uint32_t fraction) {
+    return (int64_t)(((uint64_t)fraction * 1000000ULL) >> 32);
+}
+
+namespace {
+/**
+ * @brief Arguments of a DNS lookup started on the TCP/IP task, as `WiFiGenericClass::hostByName()` does.
+ */
+struct DnsCall {
+    struct tcpip_api_call_data call; ///< Must be first: lwIP passes this pointer back.
+    const char* name;                ///< Host name.
+    ip_addr_t addr;                  ///< Filled when the answer is cached.
+    void* arg;                       ///< Passed to `SntpClient::onDnsFound()`.
+    dns_found_callback found;        ///< Called later when the answer is not cached.
+};
+
+err_t startDns(struct tcpip_api_call_data* data) {
+    DnsCall* c = reinterpret_cast<DnsCall*>(data);
+    return dns_gethostbyname(c->name, &c->addr, c->found, c->arg);
+}
+} // namespace
+
+/**
+ * @brief Constructs the client over a UDP socket.
+ * Refer to SntpClient.h for detailed documentation.
+ */
+SntpClient::SntpClient(UDP& udp)
+    : _udp(udp),
+      _busy(false),
+      _startedMs(0),
+      _haveSample(false) {
+    for (Query& q : _queries) {
+        q.step = Step::DONE;
+        q.dnsState.store(0);
+        q.address.store(0);
+        q.cookieHi = 0;
+        q.cookieLo = 0;
+        q.sentUs = 0;
+    }
+    memset(&_sample, 0, sizeof(_sample));
+}
+
+/**
+ * @brief Starts a round.
+ * Refer to SntpClient.h for detailed documentation.
+ */
+bool SntpClient::start() {
+    if (_busy) return false;
+    if (!_udp.begin(SNTP_LOCAL_PORT)) {
+        DEBUG_PRINTLN(1, "SntpClient: Could not open UDP socket.");
+        return false;
+    }
+    _busy = true;
+    _startedMs = millis();
+    _haveSample = false;
+    _stats.rounds++;
+    for (uint8_t i = 0; i < SNTP_SERVER_COUNT; ++i) resolve(i);
+    return true;
+}
+
+/**
+ * @brief Sends pending requests, reads replies and ends the round when complete.
+ * Refer to SntpClient.h for detailed documentation.
+ */
+SntpClient::Result SntpClient::poll() {
+    if (!_busy) return Result::IDLE;
+
+    for (uint8_t i = 0; i < SNTP_SERVER_COUNT; ++i) {
+        Query& q = _queries[i];
+        if (q.step != Step::RESOLVING) continue;
+        uint8_t dns = q.dnsState.load(std::memory_order_acquire);
+        if (dns == 1) {
+            send(i);
+        } else if (dns == 2) {
+            DEBUG_PRINTF(2, "SntpClient: %s did not resolve.\n", SNTP_SERVERS[i]);
+            _stats.dnsFailures++;
+            q.step = Step::DONE;
+        }
+    }
+
+    while (_udp.parsePacket() > 0) handleReply(esp_timer_get_time());
+
+    bool pending = false;
+    for (const Query& q : _queries) pending |= q.step != Step::DONE;
+    if (pending && millis() - _startedMs < SNTP_ROUND_TIMEOUT_MS) return Result::BUSY;
+
+    for (Query& q : _queries) {
+        if (q.step == Step::SENT) _stats.timeouts++;
+        else if (q.step == Step::RESOLVING) _stats.dnsFailures++;
+        q.step = Step::DONE;
+    }
+    return finish();
+}
+
+void SntpClient::onDnsFound(const char* name, const ip_addr_t* addr, void* arg) {
+    (void)name;
+    // A late answer for an earlier round lands in the same slot; it names the same server, so it is still valid.
+    Query* q = static_cast<Query*>(arg);
+    if (addr && IP_IS_V4(addr)) {
+        q->address.store(ip4_addr_get_u32(ip_2_ip4(addr)), std::memory_order_relaxed);
+        q->dnsState.store(1, std::memory_order_release);
+    } else {
+        q->dnsState.store(2, std::memory_order_release);
+    }
+}
+
+void SntpClient::resolve(uint8_t index) {
+    Query& q = _queries[index];
+    q.step = Step::RESOLVING;
+    q.dnsState.store(0, std::memory_order_relaxed);
+
+    DnsCall call;
+    memset(&call, 0, sizeof(call));
+    call.name = SNTP_SERVERS[index];
+    call.arg = &q;
+    call.found = &SntpClient::onDnsFound;
+    err_t err = tcpip_api_call(startDns, &call.call); // Returns once the lookup is queued; never waits for DNS.
+    if (err == ERR_OK && IP_IS_V4(&call.addr)) {
+        q.address.store(ip4_addr_get_u32(ip_2_ip4(&call.addr)), std::memory_order_relaxed);
+        q.dnsState.store(1, std::memory_order_release);
+    } else if (err != ERR_INPROGRESS) {
+        q.dnsState.store(2, std::memory_order_release);
+    }
+}
+
+void SntpClient::send(uint8_t index) {
+    Query& q = _queries[index];
+    uint8_t packet[NTP_PACKET_LEN];
+    memset(packet, 0, sizeof(packet));
+    packet[0] = 0x23; // LI 0, version 4, mode 3 (client)
+    // The transmit timestamp is only a cookie: the server copies it into the originate field of its reply.
+    q.cookieHi = esp_random();
+    q.cookieLo = esp_random();
+    writeBe32(packet + 40, q.cookieHi);
+    writeBe32(packet + 44, q.cookieLo);
+
+    IPAddress ip(q.address.load(std::memory_order_relaxed));
+    bool ok = _udp.beginPacket(ip, NTP_PORT) && _udp.write(packet, sizeof(packet)) == sizeof(packet);
+    q.sentUs = esp_timer_get_time();
+    ok = ok && _udp.endPacket();
+    if (!ok) {
+        DEBUG_PRINTF(2, "SntpClient: Send to %s failed.\n", SNTP_SERVERS[index]);
+        _stats.timeouts++;
+        q.step = Step::DONE;
+        return;
+    }
+    q.step = Step::SENT;
+}
+
+void SntpClient::handleReply(int64_t nowUs) {
+    uint8_t packet[NTP_PACKET_LEN];
+    int len = _udp.read(packet, sizeof(packet));
+    if (len < (int)NTP_PACKET_LEN) {
+        _stats.rejected++;
+        return;
+    }
+
+    uint32_t originHi = readBe32(packet + 24);
+    uint32_t originLo = readBe32(packet + 28);
+    Query* q = nullptr;
+    uint8_t index = 0;
+    for (uint8_t i = 0; i < SNTP_SERVER_COUNT; ++i) {
+        if (_queries[i].step == Step::SENT && _queries[i].cookieHi == originHi && _queries[i].cookieLo == originLo) {
+            q = &_queries[i];
+            index = i;
+            break;
+        }
+    }
+    if (!q) { // Stray, duplicate or late reply.
+        _stats.rejected++;
+        return;
+    }
+    q->step = Step::DONE;
+
+    uint8_t leap = packet[0] >> 6;
+    uint8_t version = (packet[0] >> 3) & 0x07;
+    uint8_t mode = packet[0] & 0x07;
+    uint8_t stratum = packet[1];
+    uint32_t rxSec = readBe32(packet + 32), rxFrac = readBe32(packet + 36);  // T2
+    uint32_t txSec = readBe32(packet + 40), txFrac = readBe32(packet + 44);  // T3
+    if (mode != 4 || version < 3 || leap == 3 || stratum == 0 || stratum > 15 || txSec == 0) {
+        DEBUG_PRINTF(2, "SntpClient: %s unsynchronized (LI %u, stratum %u).\n", SNTP_SERVERS[index], leap, stratum);
+        _stats.rejected++;
+        return;
+    }
+
+    // rtt = (T4 - T1) - (T3 - T2); the server's time at T4 is T3 plus the return half of the round trip.
+    int64_t holdUs = (int64_t)(int32_t)(txSec - rxSec) * 1000000LL + fractionToUs(txFrac) - fractionToUs(rxFrac);
+    int64_t rttUs = (nowUs - q->sentUs) - holdUs;
+    if (rttUs < 0) rttUs = 0;
+    uint32_t unixSec = txSec - NTP_UNIX_OFFSET_S; // Modulo 2^32, so it also holds after the 2036 NTP era rollover.
+    int64_t localUs = ((int64_t)unixSec + NTP_TIMEZONE_OFFSET_SECONDS) * 1000000LL + fractionToUs(txFrac) + rttUs / 2;
+    _stats.replies++;
+
+    if (_haveSample && (uint32_t)rttUs >= _sample.rttUs) return;
+    _sample.epoch = (uint32_t)(localUs / 1000000LL);
+    _sample.edgeUs = nowUs - localUs % 1000000LL;
+    _sample.rttUs = (uint32_t)rttUs;
+    _sample.server = index;
+    _haveSample = true;
+}
+
+SntpClient::Result SntpClient::finish() {
+    _udp.stop();
+    _busy = false;
+    if (!_haveSample) {
+        DEBUG_PRINTLN(2, "SntpClient: No usable reply this round.");
+        return Result::FAILED;
+    }
+    _stats.synced++;
+    _stats.lastRttUs = _sample.rttUs;
+    _stats.lastServer = _sample.server;
+    DEBUG_PRINTF(3, "SntpClient: %s, rtt %lu us.\n", SNTP_SERVERS[_sample.server], (unsigned long)_sample.rttUs);
+    return Result::SYNCED;
+}
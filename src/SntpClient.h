@@ -0,0 +1,160 @@
+/**
+ * @file SntpClient.h
+ * @brief Defines `SntpClient`, a non-blocking SNTP client that queries several servers at once.
+ *
+ * `NTPClient::forceUpdate()` sends one request and spins on the socket for up to a second, which stalled the
+ * network worker on every reconnect. This client is pumped instead:
+ * - `start()` begins a round: every server in `SNTP_SERVERS` is resolved through lwIP's asynchronous DNS and
+ *   sent a request as soon as its address is known.
+ * - `poll()` reads whatever replies have arrived and returns at once. A round ends when every server has
+ *   answered or `SNTP_ROUND_TIMEOUT_MS` has passed.
+ * - Each reply gives the server time at the moment it was read, corrected by half the round trip (server hold
+ *   time excluded). The sample with the shortest round trip wins, since its path asymmetry error is smallest.
+ *
+ * Requests carry a random transmit timestamp that the server echoes as its originate timestamp, so stray or late
+ * replies are rejected. Replies from unsynchronized servers (leap indicator 3, stratum 0 "kiss-o'-death" or 16)
+ * are rejected as well.
+ *
+ * The client only needs a `UDP` socket and `esp_timer_get_time()`, so it can be driven off-target against scripted
+ * NTP servers, as `test/test_sntp_client` does. Network worker task only; no locking.
+ */
+#ifndef SNTP_CLIENT_H
+#define SNTP_CLIENT_H
+
+#include <Arduino.h>
+#include <Udp.h>
+#include <atomic>
+#include <lwip/ip_addr.h> // For ip_addr_t in the DNS callback.
+#include "config.h" // For SNTP_SERVERS, SNTP_LOCAL_PORT, SNTP_ROUND_TIMEOUT_MS and NTP_TIMEZONE_OFFSET_SECONDS.
+
+/**
+ * @class SntpClient
+ * @brief Multi-server SNTP rounds over a non-blocking `UDP` socket, with round-trip compensation.
+ */
+class SntpClient {
+public:
+    /**
+     * @enum Result
+     * @brief What `poll()` observed.
+     */
+    enum class Result : uint8_t {
+        IDLE,    ///< No round running.
+        BUSY,    ///< Round running.
+        SYNCED,  ///< Round just finished with a sample; read it with `getSample()`.
+        FAILED   ///< Round just finished without a usable reply.
+    };
+
+    /**
+     * @struct Sample
+     * @brief Network time of a finished round, tied to the local timer.
+     */
+    struct Sample {
+        uint32_t epoch;   ///< Local-time second (`NTP_TIMEZONE_OFFSET_SECONDS` applied), seconds since 1970.
+        int64_t edgeUs;   ///< `esp_timer_get_time()` at which `epoch` began.
+        uint32_t rttUs;   ///< Round trip of the chosen reply, server hold time excluded.
+        uint8_t server;   ///< Index of the chosen server in `SNTP_SERVERS`.
+    };
+
+    /**
+     * @struct Stats
+     * @brief Counters since boot.
+     */
+    struct Stats {
+        uint32_t rounds = 0;       ///< Rounds started.
+        uint32_t synced = 0;       ///< Rounds that produced a sample.
+        uint32_t replies = 0;      ///< Valid replies.
+        uint32_t rejected = 0;     ///< Replies dropped (wrong origin, unsynchronized server, malformed).
+        uint32_t timeouts = 0;     ///< Servers that did not answer within the round.
+        uint32_t dnsFailures = 0;  ///< Server names that did not resolve.
+        uint32_t lastRttUs = 0;    ///< Round trip of the last chosen sample.
+        uint8_t lastServer = 0;    ///< Server of the last chosen sample.
+    };
+
+    /**
+     * @brief Constructs the client over a UDP socket.
+     * @param udp Socket used for the queries (e.g. a `WiFiUDP`); opened by `start()` and closed at the end of a round.
+     */
+    explicit SntpClient(UDP& udp);
+
+    /**
+     * @brief Starts a round. Never blocks.
+     * @return `false` if a round is already running or the socket could not be opened.
+     */
+    bool start();
+
+    /**
+     * @brief Sends pending requests, reads replies and ends the round when complete. Never blocks.
+     * Call every pass of the worker loop, at most `SNTP_POLL_TICK_MS` apart while busy.
+     * @return `SYNCED` or `FAILED` once when a round ends, otherwise `BUSY` or `IDLE`.
+     */
+    Result poll();
+
+    /**
+     * @brief Checks whether a round is running.
+     */
+    bool isBusy() const { return _busy; }
+
+    /**
+     * @brief Gets the sample of the last round that returned `SYNCED`.
+     */
+    const Sample& getSample() const { return _sample; }
+
+    /**
+     * @brief Gets the counters since boot.
+     */
+    const Stats& getStats() const { return _stats; }
+
+private:
+    /**
+     * @brief Progress of one server within a round.
+     */
+    enum class Step : uint8_t {
+        RESOLVING,  ///< Waiting for DNS.
+        SENT,       ///< Request sent; waiting for the reply.
+        DONE        ///< Replied, failed or given up.
+    };
+
+    /**
+     * @brief State of one server within a round.
+     */
+    struct Query {
+        Step step;                       ///< Progress.
+        std::atomic<uint8_t> dnsState;  ///< Written by the lwIP DNS callback: 0 pending, 1 resolved, 2 failed.
+        std::atomic<uint32_t> address;  ///< IPv4 address in network byte order, valid once `dnsState` is 1.
+        uint32_t cookieHi;               ///< Transmit timestamp sent, echoed back as the originate timestamp.
+        uint32_t cookieLo;               ///< Low word of the cookie.
+        int64_t sentUs;                  ///< `esp_timer_get_time()` just before sending (T1).
+    };
+
+    /**
+     * @brief lwIP DNS callback; runs on the TCP/IP task.
+     */
+    static void onDnsFound(const char* name, const ip_addr_t* addr, void* arg);
+    /**
+     * @brief Starts resolving a server name. The answer may be immediate (lwIP cache) or arrive in `onDnsFound()`.
+     */
+    void resolve(uint8_t index);
+    /**
+     * @brief Sends the request of a resolved server.
+     */
+    void send(uint8_t index);
+    /**
+     * @brief Validates one received datagram and keeps it if it beats the best sample so far.
+     * @param nowUs `esp_timer_get_time()` when it was read (T4).
+     */
+    void handleReply(int64_t nowUs);
+    /**
+     * @brief Closes the socket and reports the round's outcome.
+     */
+    Result finish();
+
+    UDP& _udp;                          ///< Query socket.
+    Query _queries[SNTP_SERVER_COUNT];  ///< One per entry of `SNTP_SERVERS`.
+    bool _busy;                         ///< A round is running.
+    unsigned long _startedMs;           ///< `millis()` when the round started.
+    bool _haveSample;                   ///< `_sample` holds a reply of the current round.
+    Sample _sample;                     ///< Best sample of the current round, then of the last synced round.
+    Stats _stats;                       ///< Counters.
+};
+
+#endif // SNTP_CLIENT_H
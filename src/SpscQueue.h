@@ -0,0 +1,87 @@
+/**
+ * @file SpscQueue.h
+ * @brief Defines `SpscQueue`, a fixed-capacity lock-free ring for exactly one producer and one consumer.
+ *
+ * Used by `NetworkWorker` to hand request and response descriptors between the control loop and the
+ * network task without a mutex: the producer only writes `_head`, the consumer only writes `_tail`, and
+ * acquire/release ordering on those indices publishes the slot contents.
+ *
+ * Slots are accessed in place (`beginPush()`/`commitPush()`, `front()`/`pop()`) so large descriptors are
+ * filled and read directly in the ring instead of being copied through the stack.
+ *
+ * The template only needs `<atomic>`, so it builds unchanged for the ESP32 and for a host toolchain.
+ */
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h> // For fixed-width integer types.
+#include <atomic>   // For `std::atomic` head/tail indices.
+
+/**
+ * @class SpscQueue
+ * @brief Lock-free single-producer/single-consumer ring of `Capacity` elements of type `T`.
+ * @tparam T Element type. Slots are default-constructed once and reused.
+ * @tparam Capacity Number of slots; must be a power of two.
+ */
+template <typename T, uint32_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() : _head(0), _tail(0) {}
+
+    /**
+     * @brief Producer side: gets the next free slot to fill in place.
+     * @return Pointer to the slot, or `nullptr` if the queue is full. Nothing is published until `commitPush()`.
+     */
+    T* beginPush() {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= Capacity) return nullptr;
+        return &_items[head & (Capacity - 1)];
+    }
+
+    /**
+     * @brief Producer side: publishes the slot returned by the preceding `beginPush()`.
+     */
+    void commitPush() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Consumer side: gets the oldest element without removing it.
+     * @return Pointer to the element, or `nullptr` if the queue is empty. Valid until `pop()`.
+     */
+    T* front() {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail) return nullptr;
+        return &_items[tail & (Capacity - 1)];
+    }
+
+    /**
+     * @brief Consumer side: releases the element returned by `front()` back to the producer.
+     */
+    void pop() {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Gets the number of queued elements. Exact only when called from the producer or consumer.
+     * @return Current depth.
+     */
+    uint32_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Gets the fixed capacity.
+     * @return `Capacity`.
+     */
+    static constexpr uint32_t capacity() { return Capacity; }
+
+private:
+    std::atomic<uint32_t> _head; ///< Index of the next slot to fill; written only by the producer.
+    std::atomic<uint32_t> _tail; ///< Index of the oldest filled slot; written only by the consumer.
+    T _items[Capacity];          ///< Slot storage.
+};
+
+#endif // SPSC_QUEUE_H
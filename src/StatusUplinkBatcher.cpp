@@ -0,0 +1,112 @@
+#include "StatusUplinkBatcher.h"
+#include <ArduinoJson.h>
+
+// Keys the backend already accepts on `device_status_post_url`, by relay index.
+static const char* const RELAY_KEYS[STATUS_UPLINK_RELAYS] = {"exhaust_status", "dehumidifier_status", "blower_status"};
+
+/**
+ * @brief Constructs an empty batcher.
+ * Refer to StatusUplinkBatcher.h for detailed documentation.
+ */
+StatusUplinkBatcher::StatusUplinkBatcher() :
+    _bootId(0),
+    _seq(0),
+    _seqReserved(false),
+    _dirty(0),
+    _failsafe(false),
+    _haveSensors(false),
+    _temperature(0),
+    _humidity(0),
+    _light(0) {
+    for (bool& r : _relayOn) r = false;
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief Records a relay state change.
+ * Refer to StatusUplinkBatcher.h for detailed documentation.
+ */
+bool StatusUplinkBatcher::noteRelay(uint8_t relay, bool on) {
+    if (relay >= STATUS_UPLINK_RELAYS) return false;
+    _relayOn[relay] = on;
+    return markDirty(1 << relay);
+}
+
+/**
+ * @brief Records a failsafe transition.
+ * Refer to StatusUplinkBatcher.h for detailed documentation.
+ */
+bool StatusUplinkBatcher::noteFailsafe(bool active) {
+    _failsafe = active;
+    return markDirty(DIRTY_FAILSAFE);
+}
+
+/**
+ * @brief Stores the latest sensor snapshot.
+ * Refer to StatusUplinkBatcher.h for detailed documentation.
+ */
+void StatusUplinkBatcher::noteSensors(float temperature, float humidity, float light) {
+    _temperature = temperature;
+    _humidity = humidity;
+    _light = light;
+    _haveSensors = true;
+}
+
+/**
+ * @brief Serializes the pending changes into one payload.
+ * Refer to StatusUplinkBatcher.h for detailed documentation.
+ */
+size_t StatusUplinkBatcher::buildPayload(int ghId, char* buf, size_t len) {
+    if (!_dirty) return 0;
+    uint32_t seq = _seqReserved ? _seq : _seq + 1;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    StaticJsonDocument<JSON_DOC_SIZE_STATUS_POST> doc;
+#pragma GCC diagnostic pop
+    doc["gh_id"] = ghId;
+    doc["boot"] = _bootId;
+    doc["seq"] = seq;
+    for (uint8_t i = 0; i < STATUS_UPLINK_RELAYS; ++i) {
+        if (_dirty & (1 << i)) doc[RELAY_KEYS[i]] = _relayOn[i] ? 1 : 0;
+    }
+    if (_dirty & DIRTY_FAILSAFE) doc["failsafe"] = _failsafe ? 1 : 0;
+    if (_haveSensors) {
+        doc["temperature"] = _temperature;
+        doc["humidity"] = _humidity;
+        doc["light_intensity"] = _light;
+    }
+    if (measureJson(doc) >= len) {
+        DEBUG_PRINTF(1, "StatusUplinkBatcher: Batch %lu does not fit %u bytes.\n", (unsigned long)seq, (unsigned)len);
+        return 0;
+    }
+    _seq = seq;
+    return serializeJson(doc, buf, len);
+}
+
+/**
+ * @brief Clears the pending changes after the batch was handed over.
+ * Refer to StatusUplinkBatcher.h for detailed documentation.
+ */
+void StatusUplinkBatcher::markSent() {
+    _dirty = 0;
+    _seqReserved = false;
+    _stats.batches++;
+}
+
+/**
+ * @brief Keeps the batch pending under its sequence number.
+ * Refer to StatusUplinkBatcher.h for detailed documentation.
+ */
+void StatusUplinkBatcher::markDeferred() {
+    _seqReserved = true;
+    _stats.retries++;
+}
+
+bool StatusUplinkBatcher::markDirty(uint8_t bit) {
+    bool opened = _dirty == 0;
+    _dirty |= bit;
+    _seqReserved = false; // The content changed, so a deferred batch needs a new sequence number.
+    _stats.changes++;
+    return opened;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file StatusUplinkBatcher.h
+ * @brief Defines `StatusUplinkBatcher`, which merges relay changes and failsafe transitions into one status POST.
+ *
+ * The control loop used to send one POST to `device_status_post_url` per relay that changed. When the
+ * thresholds flip, all three relays change in the same tick, so the modem was woken for three separate
+ * transactions. The batcher instead accumulates changes as a delta:
+ * - `noteRelay()` / `noteFailsafe()` mark a field dirty and keep only its latest value, so several changes
+ *   of the same field within one window collapse into one.
+ * - `noteSensors()` keeps the latest sensor snapshot; it is attached to the next batch but never opens one.
+ * - The first change opens a flush window. The caller flushes at the latest `STATUS_UPLINK_MAX_LATENCY_MS`
+ *   later (the sketch schedules a one-shot job), so everything that changed in between goes out as one POST.
+ *
+ * Each batch carries `boot` (random per power-up) and `seq` (incremented per batch). A batch that could not be
+ * handed to the network is retried under the same `seq` unless new changes were merged into it, so the server
+ * can drop duplicates (including HTTP-level retries of a request it already applied) by `(gh_id, boot, seq)`.
+ *
+ * Control-loop only; no locking.
+ */
+#ifndef STATUS_UPLINK_BATCHER_H
+#define STATUS_UPLINK_BATCHER_H
+
+#include <Arduino.h>
+#include "config.h" // For STATUS_UPLINK_RELAYS.
+
+/**
+ * @class StatusUplinkBatcher
+ * @brief Accumulates status deltas and serializes them into one batched JSON payload.
+ */
+class StatusUplinkBatcher {
+public:
+    /**
+     * @struct Stats
+     * @brief Running counters since boot.
+     */
+    struct Stats {
+        uint32_t changes;  ///< Relay and failsafe changes noted.
+        uint32_t batches;  ///< Batched payloads handed to the network.
+        uint32_t retries;  ///< Flushes that could not be handed over and were kept for later.
+    };
+
+    /**
+     * @brief Constructs an empty batcher. Call `begin()` before the first flush.
+     */
+    StatusUplinkBatcher();
+
+    /**
+     * @brief Sets the boot id sent with every batch.
+     * @param bootId Random value chosen once per power-up (e.g. `esp_random()`), so `seq` restarting at 1
+     *               after a reboot is not mistaken for a duplicate.
+     */
+    void begin(uint32_t bootId) { _bootId = bootId; }
+
+    /**
+     * @brief Records a relay state change.
+     * @param relay Relay index: 0 exhaust, 1 dehumidifier, 2 blower.
+     * @param on New state.
+     * @return `true` if this change opened a new flush window.
+     */
+    bool noteRelay(uint8_t relay, bool on);
+
+    /**
+     * @brief Records entering or leaving failsafe mode.
+     * @param active `true` when failsafe was entered.
+     * @return `true` if this change opened a new flush window.
+     */
+    bool noteFailsafe(bool active);
+
+    /**
+     * @brief Stores the latest sensor readings, attached to the next batch. Does not open a window.
+     * @param temperature Temperature in degrees Celsius.
+     * @param humidity Relative humidity in percent.
+     * @param light Light intensity.
+     */
+    void noteSensors(float temperature, float humidity, float light);
+
+    /**
+     * @brief Checks whether changes are waiting to be sent.
+     * @return `true` if at least one field is dirty.
+     */
+    bool hasPending() const { return _dirty != 0; }
+
+    /**
+     * @brief Serializes the pending changes and assigns the batch its sequence number.
+     * @param ghId Greenhouse id sent as `gh_id`.
+     * @param buf Destination buffer.
+     * @param len Size of `buf`.
+     * @return Payload length, or 0 if nothing is pending or the payload does not fit.
+     */
+    size_t buildPayload(int ghId, char* buf, size_t len);
+
+    /**
+     * @brief Marks the last built batch as handed to the network and clears the pending changes.
+     */
+    void markSent();
+
+    /**
+     * @brief Keeps the last built batch pending after it could not be handed to the network.
+     * The next `buildPayload()` reuses its sequence number unless new changes arrive first.
+     */
+    void markDeferred();
+
+    /**
+     * @brief Gets the sequence number of the last built batch.
+     * @return Sequence number, 0 before the first batch.
+     */
+    uint32_t getSequence() const { return _seq; }
+
+    /**
+     * @brief Gets the running counters.
+     * @return Reference to the statistics.
+     */
+    const Stats& getStats() const { return _stats; }
+
+private:
+    static const uint8_t DIRTY_FAILSAFE = 1 << STATUS_UPLINK_RELAYS; ///< Dirty bit after the relay bits.
+
+    bool markDirty(uint8_t bit);
+
+    uint32_t _bootId;                        ///< Random per power-up, sent as `boot`.
+    uint32_t _seq;                           ///< Sequence number of the last built batch.
+    bool _seqReserved;                       ///< The last built batch was deferred and is unchanged since.
+    uint8_t _dirty;                          ///< Bit i set: relay i changed; `DIRTY_FAILSAFE`: failsafe changed.
+    bool _relayOn[STATUS_UPLINK_RELAYS];     ///< Latest noted relay states.
+    bool _failsafe;                          ///< Latest noted failsafe state.
+    bool _haveSensors;                       ///< A sensor snapshot was noted.
+    float _temperature;                      ///< Latest temperature snapshot.
+    float _humidity;                         ///< Latest humidity snapshot.
+    float _light;                            ///< Latest light snapshot.
+    Stats _stats;                            ///< Running counters.
+};
+
+#endif // STATUS_UPLINK_BATCHER_H
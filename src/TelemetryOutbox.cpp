@@ -0,0 +1,206 @@
+#include "TelemetryOutbox.h"
+#include <SD.h>
+#include <stdio.h>  // For snprintf.
+#include <string.h> // For memset.
+
+/**
+ * @brief Constructs the outbox.
+ * Refer to TelemetryOutbox.h for detailed documentation.
+ */
+TelemetryOutbox::TelemetryOutbox(SDCardLogger& log) :
+    _log(log),
+    _loaded(false),
+    _ackedSeq(0),
+    _generation(0),
+    _inFlight(false),
+    _lastSubmitMs(0),
+    _submittedOnce(false) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/**
+ * @brief Checks whether a batch should be sent now.
+ * Refer to TelemetryOutbox.h for detailed documentation.
+ */
+bool TelemetryOutbox::isDue(unsigned long nowMs, bool onWiFi) {
+    if (!load()) return false;
+    unsigned long sinceLast = nowMs - _lastSubmitMs;
+    if (_inFlight) {
+        if (sinceLast < TELEMETRY_OUTBOX_ACK_TIMEOUT_MS) return false;
+        _inFlight = false; // Lost request or reply: resend from the ack.
+        _stats.ackTimeouts++;
+        DEBUG_PRINTLN(2, "TelemetryOutbox: No ack in time, resending from last ack.");
+    }
+    uint32_t pending = getPending();
+    if (pending == 0) return false;
+    if (!_submittedOnce) return true;
+    if (!onWiFi && sinceLast < TELEMETRY_OUTBOX_GPRS_MIN_GAP_MS) return false;
+    return pending >= TELEMETRY_OUTBOX_BATCH_RECORDS || sinceLast >= TELEMETRY_OUTBOX_MAX_DELAY_MS;
+}
+
+/**
+ * @brief Serializes the next batch after the ack.
+ * Rows are formatted straight into `buf`; records are read one sector at a time to keep the stack small.
+ * Refer to TelemetryOutbox.h for detailed documentation.
+ */
+size_t TelemetryOutbox::buildBatch(int ghId, char* buf, size_t len, uint32_t& lastSeq, uint16_t& rows) {
+    lastSeq = _ackedSeq;
+    rows = 0;
+    if (!_loaded) return 0;
+
+    int used = snprintf(buf, len, "{\"gh_id\":%d,\"records\":[", ghId);
+    if (used < 0 || (size_t)used >= len) return 0;
+    size_t pos = used;
+    uint32_t seq = _ackedSeq + 1;
+    bool full = false;
+
+    while (!full && rows < TELEMETRY_OUTBOX_BATCH_RECORDS) {
+        TelemetryRecord recs[TELEMETRY_SECTOR_SIZE / sizeof(TelemetryRecord)];
+        uint16_t want = TELEMETRY_OUTBOX_BATCH_RECORDS - rows;
+        if (want > sizeof(recs) / sizeof(recs[0])) want = sizeof(recs) / sizeof(recs[0]);
+        uint32_t nextSeq;
+        uint16_t n = _log.readRecords(seq, recs, want, nextSeq);
+        if (n == 0 && nextSeq == seq) break; // End of the durable log (or the card is unavailable).
+
+        for (uint16_t i = 0; i < n; ++i) {
+            const TelemetryRecord& r = recs[i];
+            // Keep room for the closing "]}".
+            int w = snprintf(buf + pos, len - pos, "%s[%lu,%lu,%.2f,%.2f,%.1f,%u]", rows ? "," : "",
+                             (unsigned long)r.seq, (unsigned long)r.epoch,
+                             r.temperature(), r.humidity(), r.light(), (unsigned)r.relays);
+            if (w < 0 || pos + w + 3 > len) {
+                buf[pos] = '\0';
+                full = true;
+                break;
+            }
+            pos += w;
+            rows++;
+            lastSeq = r.seq;
+        }
+        // Gaps the log skipped are covered by the batch too, unless the rows after them did not fit.
+        if (!full) lastSeq = nextSeq - 1;
+        seq = nextSeq;
+    }
+
+    if (lastSeq == _ackedSeq) return 0;
+    if (rows == 0) {
+        // Only unreadable slots: nothing to send, but do not look at them again.
+        DEBUG_PRINTF(2, "TelemetryOutbox: Skipped seq %lu..%lu (no longer on card).\n",
+                     (unsigned long)(_ackedSeq + 1), (unsigned long)lastSeq);
+        onAck(lastSeq);
+        return 0;
+    }
+    pos += snprintf(buf + pos, len - pos, "]}");
+    return pos;
+}
+
+/**
+ * @brief Records that a batch was handed to the network.
+ * Refer to TelemetryOutbox.h for detailed documentation.
+ */
+void TelemetryOutbox::markSubmitted(uint32_t lastSeq, uint16_t records, size_t bytes, unsigned long nowMs) {
+    _inFlight = true;
+    _lastSubmitMs = nowMs;
+    _submittedOnce = true;
+    _stats.batches++;
+    _stats.recordsSent += records;
+    _stats.bytesSent += bytes;
+    DEBUG_PRINTF(3, "TelemetryOutbox: Sent %u records up to seq %lu (%u bytes), %lu pending.\n",
+                 (unsigned)records, (unsigned long)lastSeq, (unsigned)bytes, (unsigned long)getPending());
+}
+
+/**
+ * @brief Handles the server's acknowledgement.
+ * Refer to TelemetryOutbox.h for detailed documentation.
+ */
+void TelemetryOutbox::onAck(uint32_t ackedSeq) {
+    _inFlight = false;
+    if (ackedSeq <= _ackedSeq) return;
+    _ackedSeq = ackedSeq;
+    _stats.acks++;
+    persist();
+}
+
+/**
+ * @brief Gets the number of durable records not yet acknowledged.
+ * Refer to TelemetryOutbox.h for detailed documentation.
+ */
+uint32_t TelemetryOutbox::getPending() const {
+    uint32_t next = _log.getDurableNextSeq();
+    if (!_loaded || next == 0 || next - 1 <= _ackedSeq) return 0;
+    return next - 1 - _ackedSeq;
+}
+
+bool TelemetryOutbox::load() {
+    uint32_t next = _log.getDurableNextSeq();
+    if (next == 0) return false; // Log not open; try again on the next check.
+    if (_loaded) {
+        // The log restarted below the ack (new or reformatted card): follow it.
+        if (_ackedSeq >= next) {
+            _ackedSeq = next - 1;
+            persist();
+        }
+        return true;
+    }
+
+    TelemetryOutboxAck slots[2];
+    bool found = false;
+    File f = SD.open(TELEMETRY_OUTBOX_ACK_PATH, FILE_READ);
+    if (f) {
+        if (f.read(reinterpret_cast<uint8_t*>(slots), sizeof(slots)) == sizeof(slots)) {
+            for (const TelemetryOutboxAck& a : slots) {
+                bool valid = a.magic == TELEMETRY_OUTBOX_ACK_MAGIC &&
+                             a.crc == telemetryCrc16(reinterpret_cast<const uint8_t*>(&a), sizeof(a) - sizeof(a.crc));
+                if (!valid || (found && a.generation < _generation)) continue;
+                _ackedSeq = a.ackedSeq;
+                _generation = a.generation + 1;
+                found = true;
+            }
+        }
+        f.close();
+    }
+    _loaded = true;
+
+    if (!found) {
+        _ackedSeq = next - 1;
+        DEBUG_PRINTF(2, "TelemetryOutbox: No ack file, replay starts after seq %lu.\n", (unsigned long)_ackedSeq);
+        persist();
+    } else if (_ackedSeq >= next) {
+        _ackedSeq = next - 1;
+        persist();
+    }
+    DEBUG_PRINTF(3, "TelemetryOutbox: Acked up to seq %lu, %lu records pending.\n", (unsigned long)_ackedSeq, (unsigned long)getPending());
+    return true;
+}
+
+void TelemetryOutbox::persist() {
+    if (!SD.exists(TELEMETRY_OUTBOX_ACK_PATH)) {
+        File nf = SD.open(TELEMETRY_OUTBOX_ACK_PATH, FILE_WRITE);
+        if (!nf) {
+            DEBUG_PRINTLN(1, "TelemetryOutbox: Failed to create ack file.");
+            return;
+        }
+        uint8_t erased[2 * sizeof(TelemetryOutboxAck)];
+        memset(erased, 0xFF, sizeof(erased));
+        nf.write(erased, sizeof(erased));
+        nf.close();
+    }
+
+    TelemetryOutboxAck a;
+    memset(&a, 0, sizeof(a));
+    a.magic = TELEMETRY_OUTBOX_ACK_MAGIC;
+    a.generation = _generation;
+    a.ackedSeq = _ackedSeq;
+    a.crc = telemetryCrc16(reinterpret_cast<const uint8_t*>(&a), sizeof(a) - sizeof(a.crc));
+
+    // Alternate slots so the previous ack survives a torn write.
+    File f = SD.open(TELEMETRY_OUTBOX_ACK_PATH, "r+");
+    if (!f || !f.seek((_generation & 1) * sizeof(TelemetryOutboxAck)) ||
+        f.write(reinterpret_cast<const uint8_t*>(&a), sizeof(a)) != sizeof(a)) {
+        DEBUG_PRINTLN(1, "TelemetryOutbox: Ack write failed; records may be resent after a reboot.");
+        if (f) f.close();
+        return;
+    }
+    f.close();
+    _generation++;
+}
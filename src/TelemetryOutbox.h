@@ -0,0 +1,139 @@
+/**
+ * @file TelemetryOutbox.h
+ * @brief Defines `TelemetryOutbox`, which replays the SD telemetry log to the backend in batched POSTs.
+ *
+ * `SDCardLogger` already writes one sequence-numbered `TelemetryRecord` per control cycle, whether or not a
+ * link is up, so the log doubles as an append-only outbox. This class keeps the one piece of state needed to
+ * drain it: the highest sequence number the telemetry endpoint has acknowledged.
+ * - Only records already on the card are sent (`SDCardLogger::getDurableNextSeq()`), so an acknowledged record
+ *   can never be lost to a reset and its sequence number reused.
+ * - A batch covers up to `TELEMETRY_OUTBOX_BATCH_RECORDS` records after the ack. It is sent once a full batch
+ *   is waiting or `TELEMETRY_OUTBOX_MAX_DELAY_MS` has passed, and on GPRS no sooner than
+ *   `TELEMETRY_OUTBOX_GPRS_MIN_GAP_MS` after the previous one. One batch is in flight at a time.
+ * - The ack is stored in `TELEMETRY_OUTBOX_ACK_PATH` as two alternating slots (like the log checkpoint), so
+ *   draining resumes after a reboot and acknowledged records are not sent again. A batch that is not
+ *   acknowledged within `TELEMETRY_OUTBOX_ACK_TIMEOUT_MS` is resent from the ack; the server can drop rows it
+ *   already has by `seq`.
+ * - When no ack file exists yet (first boot with this firmware, or a new card) replay starts at the current
+ *   end of the log instead of uploading its whole history.
+ *
+ * Request body (POST to `DeviceConfig::telemetry_url`), one row per record:
+ * `{"gh_id":1,"records":[[seq,epoch,temperature,humidity,light_intensity,relays],...]}`
+ * where `epoch` is RTC local time in seconds and `relays` has bit 0 = Relay 1 ... bit 3 = Relay 4.
+ * Any 2xx JSON reply acknowledges the whole batch; `{"acked_seq": N}` acknowledges only up to `N`.
+ *
+ * Control-loop only; no locking.
+ */
+#ifndef TELEMETRY_OUTBOX_H
+#define TELEMETRY_OUTBOX_H
+
+#include <Arduino.h>
+#include "config.h"          // For the TelemetryOutboxConfig group and TELEMETRY_OUTBOX_ACK_PATH.
+#include "SDCardLogger.h"    // Source of the records.
+#include "TelemetryRecord.h" // For TelemetryRecord and telemetryCrc16().
+
+/**
+ * @struct TelemetryOutboxAck
+ * @brief One slot of the ack file. Layout is part of the on-card format; do not reorder.
+ */
+struct __attribute__((packed)) TelemetryOutboxAck {
+    uint32_t magic;       ///< `TELEMETRY_OUTBOX_ACK_MAGIC`.
+    uint32_t generation;  ///< Incremented on every write; the highest valid slot wins.
+    uint32_t ackedSeq;    ///< Highest sequence number acknowledged by the server.
+    uint16_t reserved;    ///< Reserved, written as 0.
+    uint16_t crc;         ///< CRC-16/CCITT-FALSE over all preceding bytes.
+};
+
+const uint32_t TELEMETRY_OUTBOX_ACK_MAGIC = 0x4B414F54UL; ///< "TOAK" in little-endian byte order.
+
+/**
+ * @class TelemetryOutbox
+ * @brief Tracks the acknowledged position in the telemetry log and builds replay batches from it.
+ */
+class TelemetryOutbox {
+public:
+    /**
+     * @struct Stats
+     * @brief Running counters since boot.
+     */
+    struct Stats {
+        uint32_t batches;      ///< Batches handed to the network.
+        uint32_t recordsSent;  ///< Records in those batches (resends included).
+        uint32_t bytesSent;    ///< Request body bytes in those batches.
+        uint32_t acks;         ///< Batches acknowledged.
+        uint32_t ackTimeouts;  ///< Batches resent because no ack arrived in time.
+    };
+
+    /**
+     * @brief Constructs the outbox. The ack is loaded from the card on first use.
+     * @param log Telemetry log to replay.
+     */
+    explicit TelemetryOutbox(SDCardLogger& log);
+
+    /**
+     * @brief Checks whether a batch should be sent now. Loads the ack file on first use.
+     * @param nowMs Current `millis()`.
+     * @param onWiFi `true` if the link is WiFi; GPRS batches are spaced by `TELEMETRY_OUTBOX_GPRS_MIN_GAP_MS`.
+     * @return `true` if records are waiting, no batch is in flight and the batching rules allow a send.
+     */
+    bool isDue(unsigned long nowMs, bool onWiFi);
+
+    /**
+     * @brief Serializes the next batch after the ack.
+     * @param ghId Greenhouse id sent as `gh_id`.
+     * @param buf Destination buffer.
+     * @param len Size of `buf`; rows that do not fit are left for the next batch.
+     * @param[out] lastSeq Highest sequence number the batch covers, including skipped gaps.
+     * @param[out] rows Number of records in the batch.
+     * @return Body length, or 0 if there is nothing to send.
+     */
+    size_t buildBatch(int ghId, char* buf, size_t len, uint32_t& lastSeq, uint16_t& rows);
+
+    /**
+     * @brief Records that a built batch was handed to the network.
+     * @param lastSeq Value returned by `buildBatch()`.
+     * @param records Row count returned by `buildBatch()`.
+     * @param bytes Body length.
+     * @param nowMs Current `millis()`.
+     */
+    void markSubmitted(uint32_t lastSeq, uint16_t records, size_t bytes, unsigned long nowMs);
+
+    /**
+     * @brief Handles the server's acknowledgement and persists the new position.
+     * @param ackedSeq Highest sequence number the server stored. Values at or below the current ack are ignored.
+     */
+    void onAck(uint32_t ackedSeq);
+
+    /**
+     * @brief Gets the number of durable records not yet acknowledged.
+     * @return Backlog size in records; 0 before the ack is loaded.
+     */
+    uint32_t getPending() const;
+
+    /**
+     * @brief Gets the highest acknowledged sequence number.
+     * @return Ack position; 0 before it is loaded.
+     */
+    uint32_t getAckedSeq() const { return _ackedSeq; }
+
+    /**
+     * @brief Gets the running counters.
+     * @return Reference to the statistics.
+     */
+    const Stats& getStats() const { return _stats; }
+
+private:
+    bool load();
+    void persist();
+
+    SDCardLogger& _log;           ///< Telemetry log being replayed.
+    bool _loaded;                 ///< `_ackedSeq` has been read from the card (or initialised).
+    uint32_t _ackedSeq;           ///< Highest acknowledged sequence number.
+    uint32_t _generation;         ///< Generation of the next ack file write; its low bit selects the slot.
+    bool _inFlight;               ///< A batch is awaiting its ack.
+    unsigned long _lastSubmitMs;  ///< `millis()` of the last batch handed to the network.
+    bool _submittedOnce;          ///< A batch has been sent since boot (`_lastSubmitMs` is meaningful).
+    Stats _stats;                 ///< Running counters.
+};
+
+#endif // TELEMETRY_OUTBOX_H
@@ -0,0 +1,81 @@
+#include "TelemetryRecord.h"
+#include <math.h> // For lroundf.
+
+/**
+ * @brief Scales and rounds a value, clamping it to [lo, hi].
+ */
+static long quantize(float value, float scale, long lo, long hi) {
+    if (isnan(value)) return lo;
+    float scaled = value * scale;
+    if (scaled <= (float)lo) return lo;
+    if (scaled >= (float)hi) return hi;
+    return lroundf(scaled);
+}
+
+/**
+ * @brief Fills a record and seals it with its CRC.
+ * Refer to TelemetryRecord.h for detailed documentation.
+ */
+void encodeTelemetryRecord(TelemetryRecord& rec, uint32_t seq, uint32_t epoch,
+                           float temp, float hum, float light,
+                           float tempMin, float tempMax,
+                           float humMin, float humMax,
+                           float lightMin, float lightMax,
+                           uint8_t relayBits) {
+    rec.seq = seq;
+    rec.epoch = epoch;
+    rec.tempC100 = (int16_t)quantize(temp, 100.0f, INT16_MIN, INT16_MAX);
+    rec.humidity100 = (int16_t)quantize(hum, 100.0f, INT16_MIN, INT16_MAX);
+    rec.light10 = (int32_t)quantize(light, 10.0f, -1000000L, 1000000L);
+    rec.tempMin10 = (int16_t)quantize(tempMin, 10.0f, INT16_MIN, INT16_MAX);
+    rec.tempMax10 = (int16_t)quantize(tempMax, 10.0f, INT16_MIN, INT16_MAX);
+    rec.humMin10 = (int16_t)quantize(humMin, 10.0f, INT16_MIN, INT16_MAX);
+    rec.humMax10 = (int16_t)quantize(humMax, 10.0f, INT16_MIN, INT16_MAX);
+    rec.lightMin = (uint16_t)quantize(lightMin, 1.0f, 0, UINT16_MAX);
+    rec.lightMax = (uint16_t)quantize(lightMax, 1.0f, 0, UINT16_MAX);
+    rec.relays = relayBits & 0x0F;
+    rec.reserved = 0;
+    rec.crc = telemetryCrc16(reinterpret_cast<const uint8_t*>(&rec), sizeof(rec) - sizeof(rec.crc));
+}
+
+/**
+ * @brief Bitwise CRC-16/CCITT-FALSE. 30 bytes per record, so a lookup table is not worth the flash.
+ * Refer to TelemetryRecord.h for detailed documentation.
+ */
+uint16_t telemetryCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Checks a record's CRC.
+ * Refer to TelemetryRecord.h for detailed documentation.
+ */
+bool isTelemetryRecordValid(const TelemetryRecord& rec) {
+    return rec.crc == telemetryCrc16(reinterpret_cast<const uint8_t*>(&rec), sizeof(rec) - sizeof(rec.crc));
+}
+
+/**
+ * @brief Sets a checkpoint's magic number and CRC.
+ * Refer to TelemetryRecord.h for detailed documentation.
+ */
+void sealTelemetryCheckpoint(TelemetryCheckpoint& cp) {
+    cp.magic = TELEMETRY_CHECKPOINT_MAGIC;
+    cp.crc = telemetryCrc16(reinterpret_cast<const uint8_t*>(&cp), sizeof(cp) - sizeof(cp.crc));
+}
+
+/**
+ * @brief Checks a checkpoint's magic number, CRC and embedded record.
+ * Refer to TelemetryRecord.h for detailed documentation.
+ */
+bool isTelemetryCheckpointValid(const TelemetryCheckpoint& cp) {
+    return cp.magic == TELEMETRY_CHECKPOINT_MAGIC &&
+           cp.crc == telemetryCrc16(reinterpret_cast<const uint8_t*>(&cp), sizeof(cp) - sizeof(cp.crc)) &&
+           isTelemetryRecordValid(cp.latest);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file TelemetryRecord.h
+ * @brief Defines `TelemetryRecord`, the fixed-size binary record written to the SD card telemetry log.
+ *
+ * Each control-loop cycle produces one 32-byte record holding the sensor readings, the active
+ * thresholds and the relay states. Sixteen records fill exactly one 512-byte SD sector, which lets
+ * `SDCardLogger` write whole sectors into preallocated segment files instead of appending text lines.
+ *
+ * Encoding:
+ * - Readings and thresholds are stored as scaled integers (see the member comments). Values outside
+ *   the representable range are clamped; invalid sensor readings keep their sentinel (e.g. -99.9 C,
+ *   -1 % humidity) within the scaled range.
+ * - `seq` increases by one per record across the whole log and is used to find the newest record and
+ *   the write position after a reboot.
+ * - `crc` is a CRC-16/CCITT-FALSE over the first 30 bytes. Erased (0xFF) or partially written
+ *   records fail the check and are treated as the end of the log.
+ *
+ * This header has no Arduino dependencies.
+ */
+#ifndef TELEMETRY_RECORD_H
+#define TELEMETRY_RECORD_H
+
+#include <stdint.h> // For fixed-width integer types.
+#include <stddef.h> // For `size_t`.
+
+/**
+ * @struct TelemetryRecord
+ * @brief One packed 32-byte telemetry sample. Layout is part of the on-card format; do not reorder.
+ */
+struct __attribute__((packed)) TelemetryRecord {
+    uint32_t seq;         ///< Monotonic record sequence number, starting at 1.
+    uint32_t epoch;       ///< RTC time of the sample in seconds since 1970 (RTC local time).
+    int16_t tempC100;     ///< Temperature in 0.01 C.
+    int16_t humidity100;  ///< Relative humidity in 0.01 %.
+    int32_t light10;      ///< Light intensity in 0.1 lux.
+    int16_t tempMin10;    ///< Minimum temperature threshold in 0.1 C.
+    int16_t tempMax10;    ///< Maximum temperature threshold in 0.1 C.
+    int16_t humMin10;     ///< Minimum humidity threshold in 0.1 %.
+    int16_t humMax10;     ///< Maximum humidity threshold in 0.1 %.
+    uint16_t lightMin;    ///< Minimum light threshold in lux (clamped to 65535).
+    uint16_t lightMax;    ///< Maximum light threshold in lux (clamped to 65535).
+    uint8_t relays;       ///< Relay states, bit 0 = Relay 1 ... bit 3 = Relay 4.
+    uint8_t reserved;     ///< Reserved, written as 0.
+    uint16_t crc;         ///< CRC-16/CCITT-FALSE over all preceding bytes.
+
+    float temperature() const { return tempC100 / 100.0f; }   ///< @return Temperature in C.
+    float humidity() const { return humidity100 / 100.0f; }   ///< @return Humidity in %.
+    float light() const { return light10 / 10.0f; }           ///< @return Light intensity in lux.
+    bool relay(uint8_t index) const { return (relays >> index) & 0x01; } ///< @return State of relay `index` (0-3).
+};
+
+static_assert(sizeof(TelemetryRecord) == 32, "TelemetryRecord must stay 32 bytes (16 records per 512-byte sector)");
+
+/**
+ * @struct TelemetryCheckpoint
+ * @brief Write position of the telemetry log plus a copy of its newest record.
+ *
+ * `SDCardLogger` keeps two checkpoint slots in a small file and overwrites them alternately after each
+ * sector write, so one slot always holds a complete checkpoint even if power fails mid-write. On boot the
+ * slot with the highest valid `generation` gives the write position without scanning the segment files.
+ */
+struct __attribute__((packed)) TelemetryCheckpoint {
+    uint32_t magic;          ///< `TELEMETRY_CHECKPOINT_MAGIC`.
+    uint32_t generation;     ///< Incremented on every checkpoint write; the highest valid one wins.
+    uint8_t segmentIndex;    ///< Segment holding `latest`.
+    uint8_t reserved;        ///< Reserved, written as 0.
+    uint16_t reserved2;      ///< Reserved, written as 0.
+    uint32_t recordIndex;    ///< Index of `latest` within its segment.
+    TelemetryRecord latest;  ///< Newest record written to the card when the checkpoint was taken.
+    uint16_t crc;            ///< CRC-16/CCITT-FALSE over all preceding bytes.
+};
+
+const uint32_t TELEMETRY_CHECKPOINT_MAGIC = 0x434D4C54UL; ///< "TLMC" in little-endian byte order.
+
+/**
+ * @brief Fills a record from the current readings, thresholds and relay states, and seals it with its CRC.
+ * @param rec Record to fill.
+ * @param seq Sequence number to assign.
+ * @param epoch RTC time of the sample, seconds since 1970.
+ * @param temp Temperature in C.
+ * @param hum Humidity in %.
+ * @param light Light intensity in lux.
+ * @param tempMin Minimum temperature threshold.
+ * @param tempMax Maximum temperature threshold.
+ * @param humMin Minimum humidity threshold.
+ * @param humMax Maximum humidity threshold.
+ * @param lightMin Minimum light threshold.
+ * @param lightMax Maximum light threshold.
+ * @param relayBits Relay states, bit 0 = Relay 1 ... bit 3 = Relay 4.
+ */
+void encodeTelemetryRecord(TelemetryRecord& rec, uint32_t seq, uint32_t epoch,
+                           float temp, float hum, float light,
+                           float tempMin, float tempMax,
+                           float humMin, float humMax,
+                           float lightMin, float lightMax,
+                           uint8_t relayBits);
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of a buffer.
+ * @param data Bytes to checksum.
+ * @param len Number of bytes.
+ * @return The 16-bit CRC.
+ */
+uint16_t telemetryCrc16(const uint8_t* data, size_t len);
+
+/**
+ * @brief Checks a record's CRC.
+ * @param rec Record to check.
+ * @return `true` if the stored CRC matches the record contents.
+ */
+bool isTelemetryRecordValid(const TelemetryRecord& rec);
+
+/**
+ * @brief Sets a checkpoint's magic number and CRC.
+ * @param cp Checkpoint to seal; all other fields must already be filled.
+ */
+void sealTelemetryCheckpoint(TelemetryCheckpoint& cp);
+
+/**
+ * @brief Checks a checkpoint's magic number, CRC and embedded record.
+ * @param cp Checkpoint to check.
+ * @return `true` if the checkpoint is intact.
+ */
+bool isTelemetryCheckpointValid(const TelemetryCheckpoint& cp);
+
+#endif // TELEMETRY_RECORD_H
@@ -0,0 +1,81 @@
+#include "WiFiFastReconnectCache.h"
+#include <Preferences.h>
+
+static const char* const NVS_KEY_WIFI_CACHE_RECORD = "ap"; // Single blob key inside NVS_NAMESPACE_WIFI_CACHE.
+
+/**
+ * @brief Constructs an empty cache.
+ * Refer to WiFiFastReconnectCache.h for detailed documentation.
+ */
+WiFiFastReconnectCache::WiFiFastReconnectCache() : _valid(false), _writes(0) {
+    memset(&_rec, 0, sizeof(_rec));
+}
+
+/**
+ * @brief Reads the record from NVS.
+ * Refer to WiFiFastReconnectCache.h for detailed documentation.
+ */
+void WiFiFastReconnectCache::load() {
+    Preferences prefs;
+    _valid = false;
+    if (!prefs.begin(NVS_NAMESPACE_WIFI_CACHE, true)) return; // Namespace does not exist before the first store().
+    size_t n = prefs.getBytes(NVS_KEY_WIFI_CACHE_RECORD, &_rec, sizeof(_rec));
+    prefs.end();
+    _valid = n == sizeof(_rec) && _rec.magic == WIFI_FAST_RECONNECT_MAGIC && _rec.channel != 0;
+    if (_valid) DEBUG_PRINTF(3, "WiFiFastReconnectCache: Last AP on channel %u.\n", _rec.channel);
+    else memset(&_rec, 0, sizeof(_rec));
+}
+
+/**
+ * @brief Gets the record for an SSID.
+ * Refer to WiFiFastReconnectCache.h for detailed documentation.
+ */
+const WiFiFastReconnectRecord* WiFiFastReconnectCache::lookup(const char* ssid) const {
+    if (!_valid || _rec.ssidHash != hashSsid(ssid)) return nullptr;
+    return &_rec;
+}
+
+/**
+ * @brief Records a successful association and persists it if anything changed.
+ * Refer to WiFiFastReconnectCache.h for detailed documentation.
+ */
+void WiFiFastReconnectCache::store(const char* ssid, const uint8_t* bssid, uint8_t channel,
+                                   uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns) {
+    if (!bssid || channel == 0) return;
+    WiFiFastReconnectRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = WIFI_FAST_RECONNECT_MAGIC;
+    rec.ssidHash = hashSsid(ssid);
+    memcpy(rec.bssid, bssid, sizeof(rec.bssid));
+    rec.channel = channel;
+    rec.ip = ip;
+    rec.gateway = gateway;
+    rec.subnet = subnet;
+    rec.dns = dns;
+    if (_valid && memcmp(&rec, &_rec, sizeof(rec)) == 0) return; // Same AP and lease: no flash write.
+
+    _rec = rec;
+    _valid = true;
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE_WIFI_CACHE, false)) {
+        DEBUG_PRINTLN(1, "WiFiFastReconnectCache: NVS open failed; record kept in RAM only.");
+        return;
+    }
+    if (prefs.putBytes(NVS_KEY_WIFI_CACHE_RECORD, &_rec, sizeof(_rec)) == sizeof(_rec)) _writes++;
+    else DEBUG_PRINTLN(1, "WiFiFastReconnectCache: NVS write failed.");
+    prefs.end();
+    DEBUG_PRINTF(3, "WiFiFastReconnectCache: Stored AP %02X:%02X:%02X:%02X:%02X:%02X on channel %u.\n",
+                 bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], channel);
+}
+
+/**
+ * @brief Hashes an SSID with 32-bit FNV-1a.
+ */
+uint32_t WiFiFastReconnectCache::hashSsid(const char* ssid) {
+    uint32_t h = 2166136261UL;
+    for (const char* p = ssid; p && *p; ++p) {
+        h ^= (uint8_t)*p;
+        h *= 16777619UL;
+    }
+    return h;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file WiFiFastReconnectCache.h
+ * @brief Defines `WiFiFastReconnectCache`, the BSSID, channel and IP configuration of the last WiFi association.
+ *
+ * A plain `WiFi.begin(ssid, password)` scans every channel before it associates, which is most of the time a
+ * reconnect takes. `WiFiManager` first tries the access point and channel it was last connected to, and scans
+ * only if that attempt fails. This class keeps that record:
+ * - One record in NVS (`NVS_NAMESPACE_WIFI_CACHE`), so it also survives power cycles, not just soft resets.
+ * - It is tied to the SSID by hash; after the credentials change it is ignored until the next connect replaces it.
+ * - It is written only when the access point, channel or IP configuration actually changed, so routine
+ *   reconnects cost no flash writes.
+ *
+ * The IP configuration (address, gateway, subnet, DNS) is stored too. `WiFiManager` applies it on the fast path
+ * only if `WIFI_FAST_RECONNECT_REUSE_LEASE` is set, which skips DHCP but is only safe when the router reserves the
+ * address for this device.
+ *
+ * Network worker task only (and `setup()` before the worker starts); no locking.
+ */
+#ifndef WIFI_FAST_RECONNECT_CACHE_H
+#define WIFI_FAST_RECONNECT_CACHE_H
+
+#include <Arduino.h>
+#include "config.h" // For NVS_NAMESPACE_WIFI_CACHE.
+
+/**
+ * @struct WiFiFastReconnectRecord
+ * @brief Stored association. Layout is part of the NVS format; do not reorder.
+ */
+struct __attribute__((packed)) WiFiFastReconnectRecord {
+    uint32_t magic;     ///< `WIFI_FAST_RECONNECT_MAGIC`.
+    uint32_t ssidHash;  ///< FNV-1a hash of the SSID the record belongs to.
+    uint8_t bssid[6];   ///< MAC address of the access point.
+    uint8_t channel;    ///< Primary channel of the access point.
+    uint8_t reserved;   ///< Reserved, written as 0.
+    uint32_t ip;        ///< Last IPv4 address, as `(uint32_t)IPAddress`.
+    uint32_t gateway;   ///< Last gateway.
+    uint32_t subnet;    ///< Last subnet mask.
+    uint32_t dns;       ///< Last DNS server.
+};
+
+const uint32_t WIFI_FAST_RECONNECT_MAGIC = 0x31435746UL; ///< "FWC1" in little-endian byte order.
+
+/**
+ * @class WiFiFastReconnectCache
+ * @brief Loads, looks up and stores the fast-reconnect record.
+ */
+class WiFiFastReconnectCache {
+public:
+    /**
+     * @brief Constructs an empty cache. Call `load()` to read the stored record.
+     */
+    WiFiFastReconnectCache();
+
+    /**
+     * @brief Reads the record from NVS. A missing or malformed record leaves the cache empty.
+     */
+    void load();
+
+    /**
+     * @brief Gets the record for an SSID.
+     * @param ssid Network about to be joined.
+     * @return The record, or `nullptr` if none is stored for this SSID.
+     */
+    const WiFiFastReconnectRecord* lookup(const char* ssid) const;
+
+    /**
+     * @brief Records a successful association and persists it if anything changed.
+     * @param ssid Joined network.
+     * @param bssid Access point MAC address (6 bytes).
+     * @param channel Access point channel.
+     * @param ip Assigned address.
+     * @param gateway Gateway address.
+     * @param subnet Subnet mask.
+     * @param dns DNS server.
+     */
+    void store(const char* ssid, const uint8_t* bssid, uint8_t channel,
+               uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns);
+
+    /**
+     * @brief Gets the number of NVS writes since boot.
+     * @return Write count; stays flat while reconnects land on the cached access point.
+     */
+    uint32_t getWrites() const { return _writes; }
+
+private:
+    static uint32_t hashSsid(const char* ssid);
+
+    WiFiFastReconnectRecord _rec; ///< Current record; valid if `_valid`.
+    bool _valid;                  ///< `_rec` holds a usable record.
+    uint32_t _writes;             ///< NVS writes since boot.
+};
+
+#endif // WIFI_FAST_RECONNECT_CACHE_H
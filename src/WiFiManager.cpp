@@ -2,16 +2,227 @@
 #include "config.h" // For DEBUG_PRINTLN and potentially other configs
 #include <Arduino.h>  // For millis(), Serial, etc.
 #include <esp_task_wdt.h> // For watchdog reset
+#include "ApiResponseFilter.h" // Per-API filters for streaming JSON deserialization
+#include "ChunkedDecoder.h"    // Undoes chunked framing while the body streams into the parser
+
+/**
+ * @brief Read-only view of a response body with a known `Content-Length`.
+ * Stops the JSON parser at the end of the body, so on a kept-alive socket it can never consume bytes of a
+ * later response, and lets the remainder (e.g. trailing whitespace) be drained before the socket is reused.
+ */
+class BoundedBodyStream : public Stream {
+public:
+    BoundedBodyStream(Stream& in, size_t len) : _in(in), _left(len) {}
+    int available() override { int a = _in.available(); return (a > 0 && (size_t)a > _left) ? (int)_left : a; }
+    int read() override {
+        if (_left == 0) return -1;
+        int c = _in.read();
+        if (c >= 0) _left--;
+        return c;
+    }
+    int peek() override { return _left ? _in.peek() : -1; }
+    size_t readBytes(char* buffer, size_t length) override {
+        if (length > _left) length = _left;
+        size_t n = _in.readBytes(buffer, length);
+        _left -= n;
+        return n;
+    }
+    size_t write(uint8_t) override { return 0; }
+    void flush() override {}
+    /**
+     * @brief Discards the unread rest of the body.
+     * @return `true` if the whole body has been consumed.
+     */
+    bool drain() {
+        char scratch[32];
+        while (_left > 0) {
+            size_t n = readBytes(scratch, _left < sizeof(scratch) ? _left : sizeof(scratch));
+            if (n == 0) return false; // Stream timeout: the socket is out of sync and must not be reused.
+        }
+        return true;
+    }
+private:
+    Stream& _in;
+    size_t _left;
+};
+
+/**
+ * @brief Read-only view of a chunked response body, decoded as it is read.
+ * Replaces `HTTPClient::getString()`, which grew a `String` for the whole body; like `BoundedBodyStream` it
+ * ends at the terminating chunk, so a kept-alive socket stays in sync.
+ */
+class ChunkedBodyStream : public Stream {
+public:
+    explicit ChunkedBodyStream(Stream& in) : _in(in), _have(false), _next(0) {}
+    int available() override { return _have ? 1 : 0; }
+    int read() override {
+        if (!fill()) return -1;
+        _have = false;
+        return (uint8_t)_next;
+    }
+    int peek() override { return fill() ? (uint8_t)_next : -1; }
+    size_t readBytes(char* buffer, size_t length) override {
+        size_t n = 0;
+        int c;
+        while (n < length && (c = read()) >= 0) buffer[n++] = (char)c; // Stops at the end of the body, not the timeout.
+        return n;
+    }
+    size_t write(uint8_t) override { return 0; }
+    void flush() override {}
+    /**
+     * @brief Discards the unread rest of the body.
+     * @return `true` if the body ended cleanly at its terminating chunk.
+     */
+    bool drain() {
+        while (fill()) _have = false;
+        return _decoder.isDone();
+    }
+    /**
+     * @brief Gets the number of decoded body bytes so far.
+     */
+    uint32_t bytes() const { return (uint32_t)_decoder.getPayloadBytes(); }
+private:
+    /**
+     * @brief Reads encoded bytes (each within the stream timeout) until one body byte is decoded.
+     * @return `false` at the end of the body, on a framing error or on timeout.
+     */
+    bool fill() {
+        while (!_have && !_decoder.isDone() && !_decoder.hasError()) {
+            char c;
+            if (_in.readBytes(&c, 1) != 1) return false;
+            size_t outLen = 0;
+            _decoder.feed(&c, 1, &_next, 1, outLen);
+            _have = outLen == 1;
+        }
+        return _have;
+    }
+    Stream& _in;
+    ChunkedDecoder _decoder;
+    bool _have;  ///< `_next` holds a decoded byte not yet returned by `read()`.
+    char _next;
+};
+
+/**
+ * @brief Read-only view of a response body with neither `Content-Length` nor chunked framing.
+ * Such a body ends when the server closes the connection (as `HTTPClient::getString()` read it), so the
+ * socket can never be reused afterwards.
+ */
+class CloseDelimitedBodyStream : public Stream {
+public:
+    explicit CloseDelimitedBodyStream(Client& in) : _in(in), _eof(false), _bytes(0) {}
+    int available() override { return _in.available(); }
+    int read() override {
+        char c;
+        return readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+    }
+    int peek() override { return _eof ? -1 : _in.peek(); }
+    size_t readBytes(char* buffer, size_t length) override {
+        size_t n = 0;
+        while (n < length && !_eof) {
+            if (_in.available() <= 0 && !_in.connected()) {
+                _eof = true; // Closed and nothing buffered: that was the end of the body.
+                break;
+            }
+            size_t got = _in.readBytes(buffer + n, length - n);
+            if (got == 0) break; // Stream timeout with the socket still open.
+            n += got;
+        }
+        _bytes += n;
+        return n;
+    }
+    size_t write(uint8_t) override { return 0; }
+    void flush() override {}
+    /**
+     * @brief Discards the unread rest of the body.
+     * @return `true` if the server closed the connection, i.e. the whole body was read.
+     */
+    bool drain() {
+        char scratch[32];
+        while (readBytes(scratch, sizeof(scratch)) > 0) {}
+        return _eof;
+    }
+    /**
+     * @brief Gets the number of body bytes read so far.
+     */
+    uint32_t bytes() const { return _bytes; }
+private:
+    Client& _in;
+    bool _eof;       ///< The server closed the connection after the last buffered byte.
+    uint32_t _bytes;
+};
+
+/**
+ * @brief Extracts host and port from an "http(s)://host[:port]/path" URL.
+ * @return `false` if the URL has no host.
+ */
+static bool splitHostPort(const char* url, char* host, size_t hostLen, uint16_t& port) {
+    const char* p = strstr(url, "://");
+    bool https = strncmp(url, "https", 5) == 0;
+    p = p ? p + 3 : url;
+    size_t n = strcspn(p, ":/?");
+    if (n == 0 || n >= hostLen) return false;
+    memcpy(host, p, n);
+    host[n] = '\0';
+    port = (p[n] == ':') ? (uint16_t)atoi(p + n + 1) : (https ? 443 : 80);
+    return true;
+}
 
 // Constructor
-WiFiManager::WiFiManager(const char* ssid, const char* password, const char* authToken, LCDDisplay* lcd)
+WiFiManager::WiFiManager(const char* ssid, const char* password, const char* authToken)
     : _ssid(ssid),
       _password(password),
       _authToken(authToken),
-      _lcd(lcd),
+      _pool(_poolClients),
+      _poolSlot(0),
+      _slotAcquired(false),
+      _connReused(false),
+      _staleRetryUsed(false),
+      _asyncPort(80),
+      _connState(WiFiConnState::IDLE),
+      _fastAttempt(false),
+      _leaseApplied(false),
+      _attempt(0),
+      _attemptStartMs(0),
+      _connectStartMs(0),
+      _retryAtMs(0),
+      _evGotIp(false),
+      _evDisconnected(false),
+      _evReason(0),
+      _evDisconnectedAtMs(0),
+      _linkLostAtMs(0),
+      _linkEventTask(nullptr),
       _currentHttpState(WiFiHttpState::IDLE),
       _asyncOperationActive(false),
       _httpStatusCode(0) {
+    for (uint8_t i = 0; i < HTTP_POOL_SLOTS; ++i) _poolClients[i] = &_wifiClients[i];
+    _asyncHost[0] = '\0';
+    _pendingValidators.etag[0] = '\0';
+    _pendingValidators.lastModified[0] = '\0';
+    _asyncValidators = _pendingValidators;
+    _pendingIdempotencyKey[0] = '\0';
+    _asyncIdempotencyKey[0] = '\0';
+    // Keep-Alive tells how long the server keeps idle connections (HTTPClient handles "Connection: close" itself);
+    // ETag and Last-Modified are remembered by NetworkFacade for conditional GETs; Transfer-Encoding tells a
+    // chunked body from one that simply runs until the server closes the connection.
+    static const char* collectedHeaders[] = {"Keep-Alive", "ETag", "Last-Modified", "Transfer-Encoding"};
+    _httpClient.collectHeaders(collectedHeaders, 4);
+    memset(&_connectStats, 0, sizeof(_connectStats));
+    _cache.load();
+    WiFi.persistent(false); // Credentials live in DeviceConfig; do not rewrite the driver's flash copy on every begin().
+    // Runs on the WiFi event task: only set flags, updateConnection() does the work.
+    _wifiEventId = WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info) {
+        if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+            _evGotIp.store(true, std::memory_order_release);
+        } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+            _evReason.store(info.wifi_sta_disconnected.reason, std::memory_order_relaxed);
+            _evDisconnectedAtMs.store(millis(), std::memory_order_relaxed);
+            _evDisconnected.store(true, std::memory_order_release);
+        } else {
+            return;
+        }
+        TaskHandle_t task = _linkEventTask.load(std::memory_order_acquire);
+        if (task) xTaskNotifyGive(task);
+    });
     // Ensure JsonDocument has enough capacity. Adjust as needed.
     // For ESP32, default capacity of DynamicJsonDocument might be okay,
     // but for static JsonDocument, you need to specify.
@@ -20,9 +231,9 @@ WiFiManager::WiFiManager(const char* ssid, const char* password, const char* aut
 }
 
 WiFiManager::~WiFiManager() {
-    if (_httpClient.connected()) {
-        _httpClient.end();
-    }
+    WiFi.removeEvent(_wifiEventId);
+    releaseConnection(false);
+    _pool.closeAll();
 }
 
 void WiFiManager::setCredentials(const char* ssid, const char* password) {
@@ -34,66 +245,166 @@ void WiFiManager::setAuthToken(const char* authToken) {
     _authToken = authToken;
 }
 
-// Renamed from connect() to connectWiFi() and added retry logic
-bool WiFiManager::connectWiFi() {
+/**
+ * @brief Checks whether a station disconnect reason ends the current attempt early.
+ * These come back quickly when the AP is not on the tried channel or rejects the credentials; waiting out the
+ * attempt timeout would only delay the fallback. Other reasons are left to the timeout.
+ */
+static bool isAttemptEndingReason(uint8_t reason) {
+    return reason == WIFI_REASON_NO_AP_FOUND || reason == WIFI_REASON_AUTH_FAIL ||
+           reason == WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT || reason == WIFI_REASON_HANDSHAKE_TIMEOUT;
+}
+
+/**
+ * @brief Starts a non-blocking connect.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+bool WiFiManager::startConnect() {
+    if (_connState == WiFiConnState::CONNECTING || _connState == WiFiConnState::RETRY_WAIT) return true;
     if (_ssid.length() == 0) {
         DEBUG_PRINTLN(1, "WiFiManager: No SSID configured.");
+        _connState = WiFiConnState::FAILED;
         return false;
     }
+    if (WiFi.status() == WL_CONNECTED) {
+        _connState = WiFiConnState::CONNECTED;
+        return true;
+    }
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false); // Retries belong to updateConnection(); the driver's own would race them.
+    _evGotIp.store(false, std::memory_order_relaxed);
+    _evDisconnected.store(false, std::memory_order_relaxed); // Leftover from the link loss that got us here.
+    _connectStartMs = millis();
+    _attempt = 0;
+    _fastAttempt = true; // beginAttempt() falls through to a scan when nothing is cached for this SSID.
+    beginAttempt(_connectStartMs);
+    return true;
+}
 
-    const int MAX_CONNECT_RETRIES = 2; // 1 initial attempt + 2 retries
-    const unsigned long CONNECT_TIMEOUT_MS = 20000; // 20 seconds per attempt
+/**
+ * @brief Advances the connect state machine.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+WiFiManager::WiFiConnState WiFiManager::updateConnection(unsigned long nowMs) {
+    // Consume the event flags in every state, so a disconnect caused by dropping the previous attempt cannot
+    // end the next one.
+    bool gotIp = _evGotIp.exchange(false, std::memory_order_acq_rel);
+    bool dropped = _evDisconnected.exchange(false, std::memory_order_acq_rel);
+
+    switch (_connState) {
+        case WiFiConnState::CONNECTING:
+            if (gotIp || WiFi.status() == WL_CONNECTED) {
+                onConnected(nowMs);
+            } else if (dropped && isAttemptEndingReason(_evReason.load(std::memory_order_relaxed))) {
+                endAttempt(nowMs, "rejected");
+            } else if (nowMs - _attemptStartMs >= (_fastAttempt ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS)) {
+                endAttempt(nowMs, "timed out");
+            }
+            break;
+        case WiFiConnState::RETRY_WAIT:
+            if ((long)(nowMs - _retryAtMs) >= 0) beginAttempt(nowMs);
+            break;
+        case WiFiConnState::CONNECTED:
+            if (dropped || WiFi.status() != WL_CONNECTED) {
+                _linkLostAtMs = dropped ? _evDisconnectedAtMs.load(std::memory_order_relaxed) : nowMs;
+                DEBUG_PRINTF(2, "WiFiManager: Link lost (reason %u).\n", dropped ? _evReason.load(std::memory_order_relaxed) : 0);
+                _connState = WiFiConnState::IDLE;
+            }
+            break;
+        default:
+            break;
+    }
+    return _connState;
+}
 
-    for (int attempt = 0; attempt <= MAX_CONNECT_RETRIES; ++attempt) {
-        DEBUG_PRINTF(3, "WiFiManager: Connecting to %s (Attempt %d/%d)...\n", _ssid.c_str(), attempt + 1, MAX_CONNECT_RETRIES + 1);
-        if (_lcd) {
-            // LCD updates are handled by the main application using getStatusString()
+/**
+ * @brief Issues `WiFi.begin()` for the next attempt.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+void WiFiManager::beginAttempt(unsigned long nowMs) {
+    const WiFiFastReconnectRecord* rec = _fastAttempt ? _cache.lookup(_ssid.c_str()) : nullptr;
+    _attemptStartMs = nowMs;
+    _connectStats.attempts++;
+    if (rec) {
+        if (WIFI_FAST_RECONNECT_REUSE_LEASE && rec->ip != 0) {
+            WiFi.config(IPAddress(rec->ip), IPAddress(rec->gateway), IPAddress(rec->subnet), IPAddress(rec->dns));
+            _leaseApplied = true;
         }
-
-        WiFi.mode(WIFI_STA);
-        WiFi.disconnect(true); // Disconnect previous connection, if any
-        delay(100); // Short delay before begin
-        WiFi.begin(_ssid.c_str(), _password.c_str());
-
-        unsigned long startTime = millis();
-        bool connectedThisAttempt = false;
-        while (millis() - startTime < CONNECT_TIMEOUT_MS) {
-            esp_task_wdt_reset();
-            if (WiFi.status() == WL_CONNECTED) {
-                connectedThisAttempt = true;
-                break;
-            }
-            DEBUG_PRINTLN(4, "WiFiManager: Waiting for connection...");
-            delay(500);
+        DEBUG_PRINTF(3, "WiFiManager: Fast reconnect to %s on channel %u...\n", _ssid.c_str(), rec->channel);
+        WiFi.begin(_ssid.c_str(), _password.c_str(), rec->channel, rec->bssid);
+    } else {
+        _fastAttempt = false;
+        if (_leaseApplied) {
+            WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Back to DHCP for the scanned AP.
+            _leaseApplied = false;
         }
+        DEBUG_PRINTF(3, "WiFiManager: Connecting to %s (Attempt %d/%d)...\n", _ssid.c_str(), _attempt + 1, WIFI_CONNECT_MAX_ATTEMPTS);
+        WiFi.begin(_ssid.c_str(), _password.c_str());
+    }
+    _connState = WiFiConnState::CONNECTING;
+}
 
-        if (connectedThisAttempt) {
-            DEBUG_PRINTF(3, "WiFiManager: Connected. IP: %s\n", WiFi.localIP().toString().c_str());
-            if (_lcd) {
-                // LCD updates by main app
-            }
-            return true;
-        } else {
-            DEBUG_PRINTF(1, "WiFiManager: Connection attempt %d timed out.\n", attempt + 1);
-            WiFi.disconnect(true); // Ensure it's off before next attempt or exiting
-            if (attempt < MAX_CONNECT_RETRIES) {
-                DEBUG_PRINTLN(2, "WiFiManager: Retrying connection...");
-                delay(1000); // Wait a bit before retrying
-            }
-        }
+/**
+ * @brief Drops a failed attempt.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+void WiFiManager::endAttempt(unsigned long nowMs, const char* why) {
+    WiFi.disconnect(); // Stop the driver; the resulting disconnect event is consumed before the next begin.
+    if (_fastAttempt) {
+        _connectStats.fastFallbacks++;
+        DEBUG_PRINTF(2, "WiFiManager: Fast reconnect %s, scanning.\n", why);
+        _fastAttempt = false;
+        _retryAtMs = nowMs + WIFI_CONNECT_SETTLE_MS;
+    } else if (++_attempt >= WIFI_CONNECT_MAX_ATTEMPTS) {
+        _connectStats.failures++;
+        DEBUG_PRINTF(1, "WiFiManager: Connection attempt %s, all %d attempts failed.\n", why, WIFI_CONNECT_MAX_ATTEMPTS);
+        _connState = WiFiConnState::FAILED;
+        return;
+    } else {
+        DEBUG_PRINTF(1, "WiFiManager: Connection attempt %d %s, retrying.\n", _attempt, why);
+        _retryAtMs = nowMs + WIFI_CONNECT_RETRY_DELAY_MS;
     }
+    _connState = WiFiConnState::RETRY_WAIT;
+}
 
-    DEBUG_PRINTLN(1, "WiFiManager: All connection attempts failed.");
-    return false;
+/**
+ * @brief Records time-to-IP and refreshes the fast-reconnect cache.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+void WiFiManager::onConnected(unsigned long nowMs) {
+    unsigned long elapsed = nowMs - _connectStartMs;
+    _connectStats.connects++;
+    if (_fastAttempt) _connectStats.fastConnects++;
+    _connectStats.lastTimeToIpMs = elapsed;
+    _connectStats.totalTimeToIpMs += elapsed;
+    if (elapsed > _connectStats.maxTimeToIpMs) _connectStats.maxTimeToIpMs = elapsed;
+    DEBUG_PRINTF(3, "WiFiManager: Connected (%s) in %lu ms. IP: %s\n", _fastAttempt ? "fast" : "scan", elapsed,
+                 getIPAddress().c_str());
+    _cache.store(_ssid.c_str(), WiFi.BSSID(), (uint8_t)WiFi.channel(), (uint32_t)WiFi.localIP(),
+                 (uint32_t)WiFi.gatewayIP(), (uint32_t)WiFi.subnetMask(), (uint32_t)WiFi.dnsIP());
+    _connState = WiFiConnState::CONNECTED;
 }
 
-// Public connect method now calls the internal connectWiFi with retries
+/**
+ * @brief Blocking connect, for `setup()`.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
 bool WiFiManager::connect() {
-    return connectWiFi();
+    if (!startConnect()) return false;
+    WiFiConnState state;
+    while ((state = updateConnection(millis())) == WiFiConnState::CONNECTING || state == WiFiConnState::RETRY_WAIT) {
+        esp_task_wdt_reset();
+        delay(WIFI_CONNECT_POLL_MS);
+    }
+    return state == WiFiConnState::CONNECTED;
 }
 
 void WiFiManager::disconnect() {
     DEBUG_PRINTLN(3, "WiFiManager: Disconnecting...");
+    releaseConnection(false);
+    _pool.closeAll();
+    _pushClient.stop();
+    _connState = WiFiConnState::IDLE;
     WiFi.disconnect(true);
     delay(100); // Allow time for disconnection
 }
@@ -102,26 +413,43 @@ bool WiFiManager::isConnected() const {
     return WiFi.status() == WL_CONNECTED;
 }
 
+bool WiFiManager::isHttpOperationActive() const {
+    return _asyncOperationActive;
+}
+
+/**
+ * @brief Abandons the request in flight.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+void WiFiManager::abortHttpOperation() {
+    if (!_asyncOperationActive) return;
+    DEBUG_PRINTF(2, "WiFiManager Async (%s): Aborted.\n", _asyncApiType.c_str());
+    releaseConnection(false);
+    _asyncOperationActive = false;
+    _currentHttpState = WiFiHttpState::IDLE;
+}
+
 bool WiFiManager::isActuallyConnected() const {
     return WiFi.status() == WL_CONNECTED;
 }
 
-String WiFiManager::getIPAddress() const {
+IpAddressString WiFiManager::getIPAddress() const {
+    IpAddressString ip("0.0.0.0");
     if (WiFi.status() == WL_CONNECTED) {
-        return WiFi.localIP().toString();
+        IPAddress a = WiFi.localIP(); // IPAddress::toString() would allocate a String.
+        ip.format("%u.%u.%u.%u", a[0], a[1], a[2], a[3]);
     }
-    return "0.0.0.0";
+    return ip;
 }
 
-String WiFiManager::getStatusString() const {
-    char buffer[64]; // Increased buffer size
+NetworkStatusString WiFiManager::getStatusString() const {
+    NetworkStatusString status;
     if (isConnected()) {
-        snprintf(buffer, sizeof(buffer), "WiFi: Connected (%s)", WiFi.localIP().toString().c_str());
-        return String(buffer);
+        status.format("WiFi: Connected (%s)", getIPAddress().c_str());
+    } else {
+        status = "WiFi: Disconnected";
     }
-    // For "WiFi: Disconnected", snprintf is overkill, but for consistency:
-    snprintf(buffer, sizeof(buffer), "WiFi: Disconnected");
-    return String(buffer);
+    return status;
 }
 
 bool WiFiManager::startAsyncHttpRequest(
@@ -129,7 +457,7 @@ bool WiFiManager::startAsyncHttpRequest(
     const char* method,
     const char* apiType,
     const char* payload,
-    std::function<bool(JsonDocument& doc)> cb,
+    const HttpResponseCallback& cb,
     bool needsAuth) {
 
     if (_asyncOperationActive) {
@@ -141,18 +469,30 @@ bool WiFiManager::startAsyncHttpRequest(
         return false;
     }
 
+    if (!splitHostPort(url, _asyncHost, sizeof(_asyncHost), _asyncPort)) {
+        DEBUG_PRINTF(1, "WiFiManager: Could not parse host from URL for '%s'.\n", apiType);
+        return false;
+    }
+    if (!_asyncUrl.assign(url) || !_asyncMethod.assign(method)) {
+        DEBUG_PRINTF(1, "WiFiManager: URL or method too long for '%s'.\n", apiType);
+        return false;
+    }
     DEBUG_PRINTF(3, "WiFiManager: Starting Async HTTP %s for '%s' to %s\n", method, apiType, url);
 
-    _asyncUrl = url;
-    _asyncMethod = method;
-    _asyncApiType = apiType;
-    _asyncPayload = (payload ? payload : "");
+    _asyncApiType = apiType; // Logging tag only; truncation is harmless.
+    _asyncPayload = StrView(payload);
     _asyncCb = cb;
     _asyncNeedsAuth = needsAuth;
     _asyncRequestStartTime = millis();
     _asyncOperationActive = true;
     _httpStatusCode = 0;
     _httpRetries = 0; // Initialize retry counter
+    _staleRetryUsed = false;
+    _asyncValidators = _pendingValidators; // Conditional headers apply to this request only
+    _pendingValidators.etag[0] = '\0';
+    _pendingValidators.lastModified[0] = '\0';
+    memcpy(_asyncIdempotencyKey, _pendingIdempotencyKey, sizeof(_asyncIdempotencyKey));
+    _pendingIdempotencyKey[0] = '\0';
     _jsonDoc.clear(); // Clear the document for the new request
 
     _currentHttpState = WiFiHttpState::BEGIN_REQUEST;
@@ -161,6 +501,7 @@ bool WiFiManager::startAsyncHttpRequest(
 
 void WiFiManager::updateHttpOperations() {
     if (!_asyncOperationActive) {
+        _pool.expireIdle(millis());
         return;
     }
     esp_task_wdt_reset();
@@ -168,7 +509,7 @@ void WiFiManager::updateHttpOperations() {
     // Basic timeout for the whole operation
     if (millis() - _asyncRequestStartTime > 30000) { // 30-second overall timeout
         DEBUG_PRINTF(1, "WiFiManager: Async HTTP operation for '%s' timed out.\n", _asyncApiType.c_str());
-        if (_httpClient.connected()) _httpClient.end();
+        releaseConnection(false);
         _currentHttpState = WiFiHttpState::ERROR;
     }
 
@@ -180,10 +521,27 @@ void WiFiManager::updateHttpOperations() {
             _asyncOperationActive = false;
             break;
 
-        case WiFiHttpState::BEGIN_REQUEST:
-            DEBUG_PRINTF(4, "WiFiManager Async (%s): http.begin()\n", _asyncApiType.c_str());
-            // _wifiClientInstance needs to be valid. HTTPClient uses it.
-            if (_httpClient.begin(_wifiClientInstance, _asyncUrl)) {
+        case WiFiHttpState::BEGIN_REQUEST: {
+            if (!_slotAcquired) {
+                _poolSlot = _pool.acquire(_asyncHost, _asyncPort, millis(), _connReused);
+                _slotAcquired = true;
+            }
+            WiFiClient& conn = _wifiClients[_poolSlot];
+            if (!_connReused) {
+                // Connect here rather than inside GET()/POST() so the handshake can be timed on its own.
+                unsigned long connectStart = millis();
+                if (!conn.connect(_asyncHost, _asyncPort, HTTP_CONNECT_TIMEOUT_MS)) {
+                    DEBUG_PRINTF(1, "WiFiManager Async (%s) Err: connect(%s:%u) failed.\n", _asyncApiType.c_str(), _asyncHost, _asyncPort);
+                    _httpStatusCode = HTTPC_ERROR_CONNECTION_REFUSED;
+                    releaseConnection(false);
+                    _currentHttpState = WiFiHttpState::ERROR;
+                    break;
+                }
+                _pool.noteHandshake(millis() - connectStart);
+            }
+            DEBUG_PRINTF(4, "WiFiManager Async (%s): http.begin() on slot %u (%s)\n", _asyncApiType.c_str(), _poolSlot, _connReused ? "reused" : "new");
+            // HTTPClient finds the socket already connected and sends on it as-is.
+            if (_httpClient.begin(conn, _asyncUrl.c_str())) {
                 if (_asyncNeedsAuth && _authToken.length() > 0) {
                     // Bearer token construction:
                     char authHeaderValue[128]; // Buffer for "Bearer <token>"
@@ -193,21 +551,33 @@ void WiFiManager::updateHttpOperations() {
                 if (_asyncPayload.length() > 0 && (_asyncMethod == "POST" || _asyncMethod == "PUT" || _asyncMethod == "PATCH")) {
                     _httpClient.addHeader("Content-Type", "application/json");
                 }
-                _httpClient.setReuse(false); // Good practice for ESP32 HTTPClient
+                if (_asyncValidators.etag[0] != '\0') {
+                    _httpClient.addHeader("If-None-Match", _asyncValidators.etag);
+                }
+                if (_asyncValidators.lastModified[0] != '\0') {
+                    _httpClient.addHeader("If-Modified-Since", _asyncValidators.lastModified);
+                }
+                if (_asyncIdempotencyKey[0] != '\0') {
+                    _httpClient.addHeader("Idempotency-Key", _asyncIdempotencyKey);
+                }
+                _httpClient.useHTTP10(false); // Keep-alive needs HTTP/1.1
+                _httpClient.setReuse(true);   // Sends "Connection: keep-alive"; end() keeps the socket unless the server refused
                 _httpClient.setTimeout(15000); // Set timeout for this specific request
                 _currentHttpState = WiFiHttpState::SENDING_REQUEST;
             } else {
                 DEBUG_PRINTF(1, "WiFiManager Async (%s) Err: http.begin() failed.\n", _asyncApiType.c_str());
+                releaseConnection(false);
                 _currentHttpState = WiFiHttpState::ERROR;
             }
             break;
+        }
 
         case WiFiHttpState::SENDING_REQUEST:
             DEBUG_PRINTF(4, "WiFiManager Async (%s): Sending %s\n", _asyncApiType.c_str(), _asyncMethod.c_str());
             if (_asyncMethod == "GET") {
                 _httpStatusCode = _httpClient.GET();
             } else if (_asyncMethod == "POST") {
-                _httpStatusCode = _httpClient.POST(_asyncPayload);
+                _httpStatusCode = _httpClient.POST((uint8_t*)_asyncPayload.data, _asyncPayload.len);
             } else {
                 DEBUG_PRINTF(1, "WiFiManager Async (%s) Err: Unsupported method %s\n", _asyncApiType.c_str(), _asyncMethod.c_str());
                 _currentHttpState = WiFiHttpState::ERROR;
@@ -217,7 +587,16 @@ void WiFiManager::updateHttpOperations() {
             if (_httpStatusCode > 0) { // HTTPClient returned a code (success or error)
                 DEBUG_PRINTF(3, "WiFiManager Async (%s): Status %d\n", _asyncApiType.c_str(), _httpStatusCode);
                 _currentHttpState = WiFiHttpState::PROCESSING_RESPONSE;
+            } else if (_httpStatusCode < 0 && _connReused && !_staleRetryUsed) {
+                // The server closed the idle socket before we reused it. Reopen once; this is not an HTTP retry.
+                _staleRetryUsed = true;
+                _connReused = false;
+                _pool.markStale(_poolSlot);
+                _httpClient.end();
+                _httpStatusCode = 0;
+                _currentHttpState = WiFiHttpState::BEGIN_REQUEST;
             } else if (_httpStatusCode < 0) { // An error occurred with HTTPClient
+                releaseConnection(false);
                 DEBUG_PRINTF(1, "WiFiManager Async (%s) Err: Code %d (%s)\n", _asyncApiType.c_str(), _httpStatusCode, _httpClient.errorToString(_httpStatusCode).c_str());
                 _currentHttpState = WiFiHttpState::ERROR;
             }
@@ -226,16 +605,54 @@ void WiFiManager::updateHttpOperations() {
             // So, we typically expect a non-zero code here.
             break;
 
-        case WiFiHttpState::PROCESSING_RESPONSE:
+        case WiFiHttpState::PROCESSING_RESPONSE: {
             DEBUG_PRINTF(4, "WiFiManager Async (%s): Processing response.\n", _asyncApiType.c_str());
             // bool cbOk = false; // Moved before switch
-            if (_httpStatusCode >= 200 && _httpStatusCode < 300) {
+            bool bodyConsumed = true;
+            HttpResponseInfo info = {};
+            info.statusCode = _httpStatusCode;
+            if (_httpStatusCode == HTTP_CODE_NOT_MODIFIED && _asyncValidators.isSet()) {
+                // Our cached copy is current: a 304 has no body, and the callback already saw this data.
+                DEBUG_PRINTF(3, "WiFiManager Async (%s): 304 Not Modified, skipping body and callback.\n", _asyncApiType.c_str());
+                info.notModified = true;
+                cbOk = true;
+            } else if (_httpStatusCode >= 200 && _httpStatusCode < 300) {
                 if (_asyncCb) {
-                    String responsePayload = _httpClient.getString(); // Still uses String here, acceptable for one-time read
-                    DeserializationError err = deserializeJson(_jsonDoc, responsePayload);
+                    // The per-API filter drops every field the callback does not read while parsing.
+                    const JsonDocument* filter = getApiResponseFilter(classifyApiResponse(_asyncApiType.c_str()));
+                    unsigned long parseStartUs = micros();
+                    DeserializationError err;
+                    int bodySize = _httpClient.getSize();
+                    if (bodySize >= 0) {
+                        // Content-Length known: parse directly from the socket instead of buffering the body in a String first.
+                        BoundedBodyStream body(_httpClient.getStream(), (size_t)bodySize);
+                        err = filter
+                            ? deserializeJson(_jsonDoc, body, DeserializationOption::Filter(*filter))
+                            : deserializeJson(_jsonDoc, body);
+                        bodyConsumed = body.drain();
+                        info.bodyBytes = (uint32_t)bodySize;
+                    } else if (isChunkedResponse()) {
+                        // Chunked (HTTP/1.1): undo the framing while parsing, again without buffering the body.
+                        ChunkedBodyStream body(_httpClient.getStream());
+                        err = filter
+                            ? deserializeJson(_jsonDoc, body, DeserializationOption::Filter(*filter))
+                            : deserializeJson(_jsonDoc, body);
+                        bodyConsumed = body.drain();
+                        info.bodyBytes = body.bytes();
+                    } else {
+                        // No length and no framing: the body runs until the server closes, so the socket is not kept.
+                        CloseDelimitedBodyStream body(_httpClient.getStream());
+                        err = filter
+                            ? deserializeJson(_jsonDoc, body, DeserializationOption::Filter(*filter))
+                            : deserializeJson(_jsonDoc, body);
+                        body.drain();
+                        bodyConsumed = false;
+                        info.bodyBytes = body.bytes();
+                    }
+                    info.parseUs = micros() - parseStartUs;
+                    DEBUG_PRINTF(4, "WiFiManager Async (%s): Parse took %lu us.\n", _asyncApiType.c_str(), (unsigned long)info.parseUs);
                     if (err) {
                         DEBUG_PRINTF(1, "WiFiManager Async (%s): JSON Deserialization failed: %s\n", _asyncApiType.c_str(), err.c_str());
-                        DEBUG_PRINTF(4, "Response was: %s\n", responsePayload.c_str());
                     } else {
                         cbOk = _asyncCb(_jsonDoc);
                         if (!cbOk) {
@@ -243,15 +660,27 @@ void WiFiManager::updateHttpOperations() {
                         }
                     }
                 } else { // No callback, but 2xx status is success for the HTTP op itself
+                    bodyConsumed = readBody(nullptr, 0, info.bodyBytes); // Consume the body so the socket can be reused
                     cbOk = true;
                 }
+                if (cbOk) {
+                    // Only validators of a response the callback accepted are worth revalidating later.
+                    // A truncated validator would never match, so values that do not fit are not kept.
+                    String etag = _httpClient.header("ETag");
+                    String lastModified = _httpClient.header("Last-Modified");
+                    if (etag.length() < sizeof(info.validators.etag)) strlcpy(info.validators.etag, etag.c_str(), sizeof(info.validators.etag));
+                    if (lastModified.length() < sizeof(info.validators.lastModified)) strlcpy(info.validators.lastModified, lastModified.c_str(), sizeof(info.validators.lastModified));
+                }
             } else { // HTTP error code
-                String httpResponse = _httpClient.getString(); // Read response for logging
-                DEBUG_PRINTF(1, "WiFiManager Async (%s): HTTP Error Status %d. Response: %s\n", _asyncApiType.c_str(), _httpStatusCode, httpResponse.c_str());
+                char httpResponse[96]; // Start of the response, for logging
+                bodyConsumed = readBody(httpResponse, sizeof(httpResponse), info.bodyBytes);
+                DEBUG_PRINTF(1, "WiFiManager Async (%s): HTTP Error Status %d. Response: %s\n", _asyncApiType.c_str(), _httpStatusCode, httpResponse);
             }
-            _httpClient.end(); // IMPORTANT: Always end the client connection
+            releaseConnection(bodyConsumed); // IMPORTANT: Always end the client; the socket stays open only if reusable
+            if (_responseObserver) _responseObserver(_asyncUrl.c_str(), info);
             _currentHttpState = cbOk ? WiFiHttpState::COMPLETE : WiFiHttpState::ERROR;
             break;
+        }
 
         case WiFiHttpState::RETRY_WAIT:
             if (millis() >= _asyncRequestStartTime) { // Check if delay has passed
@@ -267,7 +696,7 @@ void WiFiManager::updateHttpOperations() {
 
         case WiFiHttpState::COMPLETE:
             DEBUG_PRINTF(3, "WiFiManager Async (%s): Operation complete.\n", _asyncApiType.c_str());
-            if (_httpClient.connected()) _httpClient.end(); // Ensure client is closed on success
+            releaseConnection(false); // No-op unless the connection was not yet returned to the pool
             _asyncOperationActive = false;
             _currentHttpState = WiFiHttpState::IDLE;
             break;
@@ -276,8 +705,8 @@ void WiFiManager::updateHttpOperations() {
             // Note: _httpClient.end() should have been called in PROCESSING_RESPONSE before transitioning here
             // or if an error occurred before/during SENDING_REQUEST.
             // If it's an error from BEGIN_REQUEST (e.g. http.begin failed), then client might not be "connected".
-            // For safety, we can call _httpClient.end() again, it should be safe.
-            if (_httpClient.connected()) _httpClient.end();
+            // For safety, release again; it is a no-op once the slot was returned.
+            releaseConnection(false);
 
             if (isRetryableError(_httpStatusCode) && _httpRetries < MAX_HTTP_RETRIES) {
                 _httpRetries++;
@@ -298,13 +727,84 @@ void WiFiManager::updateHttpOperations() {
 
         default:
             DEBUG_PRINTF(1, "WiFiManager Async (%s): Unhandled state %d\n", _asyncApiType.c_str(), (int)_currentHttpState);
-            if (_httpClient.connected()) _httpClient.end();
+            releaseConnection(false);
             _currentHttpState = WiFiHttpState::ERROR; // Go to error state, then IDLE
             _asyncOperationActive = false;
             break;
     }
 }
 
+/**
+ * @brief Makes the next request a conditional GET.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+void WiFiManager::setConditionalRequest(const HttpValidators* validators) {
+    if (validators) {
+        _pendingValidators = *validators;
+    } else {
+        _pendingValidators.etag[0] = '\0';
+        _pendingValidators.lastModified[0] = '\0';
+    }
+}
+
+/**
+ * @brief Sets the idempotency key of the next request.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+void WiFiManager::setIdempotencyKey(const char* key) {
+    strlcpy(_pendingIdempotencyKey, key ? key : "", sizeof(_pendingIdempotencyKey));
+}
+
+/**
+ * @brief Reads the current response body to its end, keeping only its start.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+bool WiFiManager::readBody(char* prefix, size_t prefixLen, uint32_t& bodyBytes) {
+    size_t kept = 0;
+    int size = _httpClient.getSize();
+    if (size >= 0) {
+        BoundedBodyStream body(_httpClient.getStream(), (size_t)size);
+        if (prefixLen > 1) kept = body.readBytes(prefix, prefixLen - 1);
+        bodyBytes = (uint32_t)size;
+        if (prefixLen) prefix[kept] = '\0';
+        return body.drain();
+    }
+    if (!isChunkedResponse()) {
+        CloseDelimitedBodyStream body(_httpClient.getStream());
+        if (prefixLen > 1) kept = body.readBytes(prefix, prefixLen - 1);
+        if (prefixLen) prefix[kept] = '\0';
+        body.drain();
+        bodyBytes = body.bytes();
+        return false; // The server ends this body by closing the socket.
+    }
+    ChunkedBodyStream body(_httpClient.getStream());
+    if (prefixLen > 1) kept = body.readBytes(prefix, prefixLen - 1);
+    if (prefixLen) prefix[kept] = '\0';
+    bool ok = body.drain();
+    bodyBytes = body.bytes();
+    return ok;
+}
+
+/**
+ * @brief Checks whether the current response body uses chunked framing.
+ * Refer to WiFiManager.h for detailed documentation.
+ */
+bool WiFiManager::isChunkedResponse() {
+    String encoding = _httpClient.header("Transfer-Encoding");
+    encoding.toLowerCase();
+    return encoding.indexOf("chunked") >= 0;
+}
+
+void WiFiManager::releaseConnection(bool keepOpen) {
+    if (!_slotAcquired) return;
+    String keepAlive = _httpClient.header("Keep-Alive");
+    unsigned long serverTimeoutMs = HttpConnectionPool::parseKeepAliveTimeout(keepAlive.c_str(), keepAlive.length());
+    if (!keepOpen) _wifiClients[_poolSlot].stop();
+    _httpClient.end(); // Stops the socket too if the server sent "Connection: close"
+    _pool.release(_poolSlot, keepOpen, millis(), serverTimeoutMs);
+    _slotAcquired = false;
+}
+
 // The WiFiManager::printDebug method has been removed.
 // Global DEBUG_PRINTF or DEBUG_PRINTLN macros are used directly.
 bool WiFiManager::isRetryableError(int httpStatusCode) {
@@ -5,8 +5,11 @@
  * This file declares the `WiFiManager` class, which concretely implements the `NetworkInterface`
  * abstract base class. Its primary responsibilities are:
  * - WiFi Connection Management: Establishing and maintaining a connection to a specified WiFi
- *   network using provided credentials (SSID and password). This includes handling connection
- *   retries (up to `WIFI_CONNECT_RETRIES` with `WIFI_CONNECT_TIMEOUT` per attempt, from `config.h`).
+ *   network using provided credentials (SSID and password). Connecting is a non-blocking state
+ *   machine (`startConnect()` / `updateConnection()`) driven by WiFi driver events: it first tries
+ *   the access point and channel of the last association (`WiFiFastReconnectCache`, kept in NVS),
+ *   which skips the channel scan, and falls back to up to `WIFI_CONNECT_MAX_ATTEMPTS` scanning
+ *   attempts of `WIFI_CONNECT_TIMEOUT_MS` each. Time-to-IP is recorded in `ConnectStats`.
  * - Credential Management: Storing and allowing updates for WiFi credentials (`_ssid`, `_password`)
  *   and an authentication token (`_authToken`) used for API access.
  * - Asynchronous HTTP/HTTPS Operations: Performing HTTP GET and POST requests in a non-blocking
@@ -17,14 +20,20 @@
  *   and an overall `HTTP_TIMEOUT` per attempt, all from `config.h`).
  * - JSON Processing: Parsing JSON responses from HTTP requests using `ArduinoJson` into a
  *   pre-allocated `_jsonDoc` (size `JSON_DOC_SIZE_API_RESPONSE` or similar from `config.h`).
- * - Status Reporting: Optionally interacting with an `LCDDisplay` (if provided via constructor)
- *   for visual feedback on WiFi and HTTP operations.
+ *   Responses with a `Content-Length` are deserialized directly from the socket stream (bounded to the
+ *   body so a kept-alive socket stays in sync); chunked responses are de-chunked by `HTTPClient` first.
+ *   A per-API filter keeps only the fields the callbacks use.
+ * - Keep-alive: Requests are sent as HTTP/1.1 with `Connection: keep-alive` over sockets taken from an
+ *   `HttpConnectionPool`, so consecutive requests to the API host skip the TCP handshake. A request that
+ *   fails on a reused socket the server already closed is reopened once without counting as a retry.
+ * - Status Reporting: Connection and HTTP outcomes are logged and exposed through `getStatusString()` and the
+ *   statistics getters. The manager runs on the network worker task and never touches the LCD.
  *
  * The class relies heavily on constants defined in `config.h` for timeouts, retry counts,
  * buffer sizes (e.g., JSON document size), and potentially the base URL for API endpoints.
  *
- * @note For HTTPS communication, the `_wifiClientInstance` would need to be a `WiFiClientSecure`
- *       object, and `_httpClient.begin()` would need to be called with this secure client,
+ * @note For HTTPS communication, the pooled `_wifiClients` would need to be `WiFiClientSecure`
+ *       objects, and `_httpClient.begin()` would need to be called with this secure client,
  *       potentially along with a root CA certificate for server verification. The current
  *       implementation primarily shows HTTP but is structured to accommodate HTTPS with
  *       these modifications.
@@ -34,13 +43,14 @@
 
 #include "config.h"           // Crucial for WIFI_*, HTTP_*, JSON_DOC_SIZE_*, API_BASE_URL, DEBUG_MODE_WIFI etc.
 #include "NetworkInterface.h" // Defines the abstract base class `NetworkInterface` and its contract.
+#include "HttpConnectionPool.h" // Keep-alive socket reuse across requests.
+#include "WiFiFastReconnectCache.h" // Last AP/channel/lease for fast reconnects.
 #include <WiFi.h>             // ESP32 WiFi library for `WiFi`, `WiFiClient`.
 #include <HTTPClient.h>       // ESP32 HTTP client library for `HTTPClient`.
 #include <ArduinoJson.h>      // For `JsonDocument`, `StaticJsonDocument`, `deserializeJson()`.
 #include <functional>         // For `std::function`, used for asynchronous HTTP request callbacks.
+#include <atomic>             // For the flags set from the WiFi event task.
 
-// Forward declaration for LCDDisplay to avoid circular dependencies.
-class LCDDisplay;
 
 /**
  * @class WiFiManager
@@ -48,7 +58,8 @@ class LCDDisplay;
  *
  * This class provides a concrete implementation of the `NetworkInterface` tailored for WiFi-based
  * communication on ESP32 platforms. It encapsulates the detailed logic for:
- * 1.  **Connecting to a WiFi Access Point**: Using stored SSID and password, with retry logic.
+ * 1.  **Connecting to a WiFi Access Point**: Using stored SSID and password, without blocking, with a
+ *     fast path to the last access point and retry logic.
  * 2.  **Disconnecting from WiFi**: Gracefully terminating the connection.
  * 3.  **Checking Connection Status**: Verifying if WiFi is currently active.
  * 4.  **Executing Asynchronous HTTP GET and POST Requests**: This is the core of its network
@@ -58,8 +69,6 @@ class LCDDisplay;
  *     processing, timeouts, and retries.
  * 5.  **Managing Authentication**: Stores an authentication token (`_authToken`) which can be
  *     automatically included in HTTP request headers.
- * 6.  **Interacting with LCD**: Optionally displays status messages (connection progress,
- *     HTTP outcomes) on an `LCDDisplay` object.
  */
 class WiFiManager : public NetworkInterface {
 public:
@@ -73,29 +82,94 @@ public:
      * @param password The password for the WiFi network. This is copied into `_password`.
      * @param authToken The initial authentication token (e.g., a Bearer token) for API requests.
      *                  This is copied into `_authToken` and can be updated later via `setAuthToken()`.
-     * @param lcd Optional pointer to an `LCDDisplay` object. If provided (not `nullptr`),
-     *            status messages related to WiFi connection and HTTP operations
-     *            (e.g., "WiFi Connecting...", "HTTP POST OK", "HTTP Error: 404") will be
-     *            displayed on the LCD. Defaults to `nullptr`, in which case no LCD output occurs.
      */
-    WiFiManager(const char* ssid, const char* password, const char* authToken, LCDDisplay* lcd = nullptr);
+    WiFiManager(const char* ssid, const char* password, const char* authToken);
     
     /**
      * @brief Destructor for `WiFiManager`.
      * Ensures a graceful shutdown by:
+     * - Removing the WiFi event handler.
      * - Disconnecting from WiFi if still connected (`WiFi.disconnect(true)`).
      * - Aborting any ongoing HTTP operation by calling `_httpClient.end()` to free resources.
      */
     ~WiFiManager() override;
 
     /**
-     * @brief Attempts to connect to the configured WiFi network using the stored SSID and password.
-     *
-     * This method internally calls the private `connectWiFi()` helper, which handles the
-     * actual connection logic including setting WiFi mode to STA, initiating `WiFi.begin()`,
-     * waiting for connection with a timeout (`WIFI_CONNECT_TIMEOUT` from `config.h`),
-     * and retrying connection up to `WIFI_CONNECT_RETRIES` times (from `config.h`).
-     * Status messages are displayed on the LCD during this process.
+     * @enum WiFiConnState
+     * @brief States of the connect state machine advanced by `updateConnection()`.
+     */
+    enum class WiFiConnState : uint8_t {
+        IDLE,       ///< No connect in progress and no link known to this state machine.
+        CONNECTING, ///< `WiFi.begin()` issued; waiting for an IP, a rejecting disconnect or the attempt timeout.
+        RETRY_WAIT, ///< The last attempt failed; the next one starts at `_retryAtMs`.
+        CONNECTED,  ///< Associated with an IP address.
+        FAILED      ///< All attempts failed (or no SSID is configured).
+    };
+
+    /**
+     * @struct ConnectStats
+     * @brief Connect counters and time-to-IP since boot.
+     */
+    struct ConnectStats {
+        uint32_t attempts;             ///< `WiFi.begin()` calls (fast and scanning).
+        uint32_t connects;             ///< Connects that reached an IP address.
+        uint32_t fastConnects;         ///< Of `connects`, those made on the cached AP and channel.
+        uint32_t fastFallbacks;        ///< Fast attempts that failed and fell back to a scan.
+        uint32_t failures;             ///< Connects that gave up after all attempts.
+        unsigned long lastTimeToIpMs;  ///< `startConnect()` to IP address of the latest connect.
+        unsigned long maxTimeToIpMs;   ///< Longest time-to-IP.
+        unsigned long totalTimeToIpMs; ///< Sum of time-to-IP over `connects`, for the mean.
+    };
+
+    /**
+     * @brief Starts connecting to the configured network without blocking.
+     * Sets station mode and issues `WiFi.begin()` on the cached AP and channel if there is a record for this SSID,
+     * otherwise a scanning `WiFi.begin()`. Progress is made by `updateConnection()`.
+     * @return `true` if a connect is in progress (or the link is already up); `false` if no SSID is configured.
+     */
+    bool startConnect();
+
+    /**
+     * @brief Advances the connect state machine. Call regularly, like `updateHttpOperations()`.
+     * - `CONNECTING`: an IP (event or `WiFi.status()`) completes the connect. A disconnect with a reason such as
+     *   "no AP found" or "auth failed", or `WIFI_FAST_CONNECT_TIMEOUT_MS` / `WIFI_CONNECT_TIMEOUT_MS`, ends the
+     *   attempt. A failed fast attempt falls back to a scan after `WIFI_CONNECT_SETTLE_MS`; a failed scan is retried
+     *   after `WIFI_CONNECT_RETRY_DELAY_MS`, up to `WIFI_CONNECT_MAX_ATTEMPTS` scans.
+     * - `CONNECTED`: a lost link (disconnect event, or `WiFi.status()` as a fallback) returns to `IDLE` and records
+     *   `getLinkLostAtMs()`.
+     * @param nowMs Current `millis()`.
+     * @return The state after this step.
+     */
+    WiFiConnState updateConnection(unsigned long nowMs);
+
+    /**
+     * @brief Gets when the link was lost, as of the `CONNECTED` to `IDLE` step of `updateConnection()`.
+     * @return `millis()` of the disconnect event (or of the step that noticed the loss without one).
+     */
+    unsigned long getLinkLostAtMs() const { return _linkLostAtMs; }
+
+    /**
+     * @brief Sets the task notified (`xTaskNotifyGive()`) from the WiFi event task whenever the station gets an IP
+     *        or disconnects, so the task driving `updateConnection()` reacts at once instead of on its next poll.
+     * @param task Task to wake, or `nullptr` for none.
+     */
+    void setLinkEventTask(TaskHandle_t task) { _linkEventTask.store(task, std::memory_order_release); }
+
+    /**
+     * @brief Gets the state of the connect state machine as of the last `updateConnection()`.
+     * @return Current state.
+     */
+    WiFiConnState getConnectState() const { return _connState; }
+
+    /**
+     * @brief Gets the connect counters and time-to-IP.
+     * @return Reference to the statistics.
+     */
+    const ConnectStats& getConnectStats() const { return _connectStats; }
+
+    /**
+     * @brief Connects to the configured WiFi network, blocking until it succeeds or all attempts fail.
+     * A wrapper of `startConnect()` and `updateConnection()` for `setup()`; the network worker uses those directly.
      *
      * @return `true` if the WiFi connection is successfully established within the configured
      *         number of attempts and timeout period.
@@ -145,7 +219,7 @@ public:
      *                It can be `nullptr` or an empty string for "GET" requests or if no body is needed.
      *                If provided for POST/PUT, "Content-Type: application/json" (or as per `config.h`)
      *                and "Content-Length" headers are typically added automatically by `HTTPClient`.
-     * @param cb A `std::function<bool(JsonDocument& doc)>` callback. This function will be invoked
+     * @param cb An `HttpResponseCallback`. This function will be invoked
      *           if the HTTP request completes successfully (typically with an HTTP 2xx status code) AND
      *           a JSON response is received and successfully parsed into the `_jsonDoc`.
      *           The `JsonDocument` passed to the callback contains the parsed response data.
@@ -170,7 +244,7 @@ public:
         const char* method,
         const char* apiType,
         const char* payload,
-        std::function<bool(JsonDocument& doc)> cb,
+        const HttpResponseCallback& cb,
         bool needsAuth = true
     ) override;
 
@@ -193,15 +267,45 @@ public:
      */
     void updateHttpOperations() override;
 
+    /**
+     * @brief Checks whether an asynchronous HTTP operation is currently in progress.
+     * @return The value of `_asyncOperationActive`. While `true`, `startAsyncHttpRequest()` rejects new requests.
+     */
+    bool isHttpOperationActive() const override;
+
+    /**
+     * @brief Abandons the request in flight: closes its socket and returns the HTTP FSM to `IDLE` without a retry.
+     */
+    void abortHttpOperation() override;
+
+    /**
+     * @brief Makes the next request a conditional GET (`If-None-Match` / `If-Modified-Since`).
+     * Refer to `NetworkInterface::setConditionalRequest()`.
+     * @param validators Validators to send, or `nullptr` for an unconditional request.
+     */
+    void setConditionalRequest(const HttpValidators* validators) override;
+
+    /**
+     * @brief Sends an `Idempotency-Key` header with the next request. Refer to `NetworkInterface::setIdempotencyKey()`.
+     * @param key Header value, or `nullptr` for none.
+     */
+    void setIdempotencyKey(const char* key) override;
+
+    /**
+     * @brief Sets the observer told about each finished request.
+     * @param observer Called at the end of `PROCESSING_RESPONSE`; may be empty.
+     */
+    void setResponseObserver(ResponseObserver observer) override { _responseObserver = observer; }
+
     /**
      * @brief Provides a human-readable status string describing the current WiFi connection state.
      * This can include the connection status (e.g., "Connected", "Connecting", "Disconnected"),
      * the SSID of the connected network, and the device's IP address if connected.
      *
-     * @return A `String` object containing the current WiFi status summary. For example:
-     *         "Connected to MyWiFi, IP: 192.168.1.101", "WiFi Connecting...", "WiFi Disconnected".
+     * @return The current WiFi status summary, built without heap use. For example:
+     *         "WiFi: Connected (192.168.1.101)", "WiFi: Disconnected".
      */
-    String getStatusString() const override;
+    NetworkStatusString getStatusString() const override;
 
     /**
      * @brief A more direct check of the WiFi connection status using `WiFi.status()`.
@@ -219,11 +323,11 @@ public:
      * @brief Gets the current IP address assigned to the ESP32 by the WiFi network.
      * Queries `WiFi.localIP()`.
      *
-     * @return A `String` containing the IP address in dot-decimal notation (e.g., "192.168.1.100").
+     * @return The IP address in dot-decimal notation (e.g., "192.168.1.100").
      * @return Returns "0.0.0.0" if the device is not connected to WiFi or if an IP address
      *         has not yet been assigned or is otherwise unavailable.
      */
-    String getIPAddress() const;
+    IpAddressString getIPAddress() const;
 
     /**
      * @brief Updates the WiFi credentials (SSID and password) stored within the `WiFiManager`.
@@ -251,25 +355,25 @@ public:
      */
     void setAuthToken(const char* authToken);
 
-private:
     /**
-     * @brief Internal helper function responsible for the actual process of establishing a WiFi connection.
-     *
-     * This function is called by the public `connect()` method. Its responsibilities include:
-     * - Setting the WiFi mode to Station mode (`WIFI_STA`).
-     * - Initiating the connection attempt using `WiFi.begin(_ssid.c_str(), _password.c_str())`.
-     * - Waiting for the connection to be established, with a timeout specified by
-     *   `WIFI_CONNECT_TIMEOUT` (from `config.h`). This wait loop checks `WiFi.status()`.
-     * - Displaying status messages on the `_lcd` (if available) during the connection process
-     *   (e.g., "WiFi Connecting...", "WiFi Connected to [SSID]", "WiFi Connect Failed").
-     * - Retrying the connection attempt up to `WIFI_CONNECT_RETRIES` times (from `config.h`)
-     *   if initial attempts fail. Each retry involves a short delay.
-     *
-     * @return `true` if the WiFi connection is successfully established (`WiFi.status() == WL_CONNECTED`).
-     * @return `false` if all connection attempts (initial + retries) fail or if the timeout is reached
-     *         during any attempt.
+     * @brief Gets the keep-alive counters (requests, reuse, handshakes and handshake time).
+     * @return Reference to the connection pool statistics.
      */
-    bool connectWiFi();
+    const HttpConnectionPool::Stats& getConnectionStats() const { return _pool.getStats(); }
+
+    /**
+     * @brief Gets the socket reserved for the MQTT push session.
+     * @return `_pushClient`; separate from the HTTP pool so the session survives pool recycling.
+     */
+    Client* getPushClient() override { return &_pushClient; }
+
+private:
+    /** @brief Issues `WiFi.begin()` for the next attempt: cached AP and channel first, then a full scan. */
+    void beginAttempt(unsigned long nowMs);
+    /** @brief Drops a failed attempt; schedules a scan, the next scan, or gives up (`FAILED`). */
+    void endAttempt(unsigned long nowMs, const char* why);
+    /** @brief Records time-to-IP and refreshes the fast-reconnect cache. */
+    void onConnected(unsigned long nowMs);
 
     /**
      * @enum WiFiHttpState
@@ -278,14 +382,15 @@ private:
      * The `updateHttpOperations()` method transitions the FSM through these states:
      * - **`IDLE`**: The FSM is inactive, awaiting a new request. `_asyncOperationActive` is `false`. Transitions from `COMPLETE` or `ERROR`.
      * - **`BEGIN_REQUEST`**: Entered when `startAsyncHttpRequest()` is called successfully.
-     *     - Action: Initializes `_httpClient.begin()` with the URL and `_wifiClientInstance`. Sets HTTP headers (User-Agent, Authorization if `_asyncNeedsAuth`). For POST/PUT, sets "Content-Type" and payload using `_httpClient.POST()` or similar. Sets `_asyncRequestStartTime`.
+     *     - Action: Takes a socket from `_pool` (connecting it if it is not a reused keep-alive socket) and initializes `_httpClient.begin()` with it and the URL. Sets HTTP headers (User-Agent, Authorization if `_asyncNeedsAuth`). For POST/PUT, sets "Content-Type" and payload using `_httpClient.POST()` or similar. Sets `_asyncRequestStartTime`.
      *     - Transition: To `SENDING_REQUEST`.
      * - **`SENDING_REQUEST`**: The request has been prepared and is now being sent.
      *     - Action: For GET, calls `_httpClient.GET()`. For POST, this state might be brief if `POST()` was synchronous, or it waits if `sendRequest()` is used for chunked/streamed data. Populates `_httpStatusCode` with the server's response code.
      *     - Transition: To `PROCESSING_RESPONSE` if status code received. To `RETRY_WAIT` or `ERROR` if send fails or `HTTP_TIMEOUT` occurs (checked against `_asyncRequestStartTime`).
      * - **`PROCESSING_RESPONSE`**: The server has responded with an HTTP status code.
      *     - Action: Checks `_httpStatusCode`.
-     *         - If success (2xx): Reads the response payload using `_httpClient.getString()`, deserializes it into `_jsonDoc` using `deserializeJson()`. If parsing succeeds, invokes `_asyncCb(_jsonDoc)`.
+     *         - If success (2xx): Deserializes the body straight from `_httpClient.getStream()` into `_jsonDoc`, applying the filter for the request's API type (see `ApiResponseFilter.h`). If parsing succeeds, invokes `_asyncCb(_jsonDoc)`.
+     *         - If `304` to a conditional GET: Succeeds without reading a body or invoking `_asyncCb`.
      *         - If error code: Calls `isRetryableError(_httpStatusCode)`.
      *     - Transition: To `COMPLETE` if successful processing or non-retryable error. To `RETRY_WAIT` if retryable error and `_httpRetries < MAX_HTTP_RETRIES`. To `ERROR` if max retries reached or other unrecoverable issue. `_httpClient.end()` is called before exiting this phase unless retrying.
      * - **`RETRY_WAIT`**: A retryable error occurred, and retries are pending.
@@ -309,25 +414,56 @@ private:
         ERROR                   ///< An unrecoverable error occurred (e.g., pre-send failure, max retries exhausted, critical parse error).
     };
 
-    String _ssid;       ///< Stores the Service Set Identifier (SSID) of the target WiFi network. Max length determined by String capacity.
-    String _password;   ///< Stores the password for the target WiFi network. Max length determined by String capacity.
-    String _authToken;  ///< Stores the authentication token (e.g., "Bearer YOUR_TOKEN_HERE") used for API requests requiring authorization. Max length from `config.h` if defined, or String capacity.
-    LCDDisplay* _lcd;   ///< Optional pointer to an `LCDDisplay` object for showing status messages. If `nullptr`, no LCD output is attempted by this manager.
+    FixedString<WIFI_SSID_MAX_LEN> _ssid;      ///< Stores the Service Set Identifier (SSID) of the target WiFi network.
+    FixedString<WIFI_PWD_MAX_LEN> _password;   ///< Stores the password for the target WiFi network.
+    FixedString<API_TOKEN_MAX_LEN> _authToken; ///< Stores the authentication token sent as "Bearer <token>" with API requests requiring authorization.
 
     HTTPClient _httpClient;         ///< ESP32 `HTTPClient` object used for making HTTP/HTTPS requests. One instance is reused for all requests.
                                     ///< For HTTPS, `_httpClient.begin()` must be called with a `WiFiClientSecure` instance and the server's root CA certificate (or `setInsecure()` for testing, not recommended for production).
-    WiFiClient _wifiClientInstance; ///< `WiFiClient` instance used by `_httpClient` for standard HTTP communication.
-                                    ///< For HTTPS, this member would typically be replaced or supplemented by a `WiFiClientSecure` object.
+    WiFiClient _wifiClients[HTTP_POOL_SLOTS]; ///< Pooled sockets handed to `_httpClient`, one per `HttpConnectionPool` slot.
+                                    ///< For HTTPS, these would typically be replaced or supplemented by `WiFiClientSecure` objects.
                                     ///< `WiFiClientSecure` needs to be configured (e.g., `setCACert()`, `setCertificate()`, `setPrivateKey()`)
                                     ///< depending on the server's SSL/TLS requirements and whether client authentication is needed.
+    Client* _poolClients[HTTP_POOL_SLOTS]; ///< Pointers to `_wifiClients` for `_pool`.
+    WiFiClient _pushClient;         ///< Socket of the MQTT push session (see `getPushClient()`); not pooled.
+    HttpConnectionPool _pool;       ///< Chooses and recycles the socket for each request.
+    uint8_t _poolSlot;              ///< Slot of the current request while `_slotAcquired`.
+    bool _slotAcquired;             ///< The current request holds `_poolSlot`.
+    bool _connReused;               ///< The current attempt runs on a socket kept open from an earlier request.
+    bool _staleRetryUsed;           ///< The current request already reopened a stale socket once.
+    char _asyncHost[GPRS_MAX_HOST_LEN]; ///< Host part of `_asyncUrl`, the pool key.
+    uint16_t _asyncPort;            ///< Port of `_asyncUrl`, the pool key.
+    HttpValidators _pendingValidators; ///< Set by `setConditionalRequest()`; taken over by the next `startAsyncHttpRequest()`.
+    HttpValidators _asyncValidators; ///< Validators sent with the current request; empty if unconditional.
+    char _pendingIdempotencyKey[HTTP_IDEMPOTENCY_KEY_LEN]; ///< Set by `setIdempotencyKey()`; taken over by the next `startAsyncHttpRequest()`.
+    char _asyncIdempotencyKey[HTTP_IDEMPOTENCY_KEY_LEN];   ///< `Idempotency-Key` of the current request; empty if none.
+    ResponseObserver _responseObserver; ///< Told about each finished request; may be empty.
+
+    // --- Connect State Machine ---
+    WiFiConnState _connState;       ///< State of the connect state machine.
+    bool _fastAttempt;              ///< The current attempt targets the cached AP and channel.
+    bool _leaseApplied;             ///< The cached IP configuration is applied (`WIFI_FAST_RECONNECT_REUSE_LEASE`).
+    uint8_t _attempt;               ///< Scanning attempts that failed in the current connect.
+    unsigned long _attemptStartMs;  ///< `millis()` when the current attempt began.
+    unsigned long _connectStartMs;  ///< `millis()` of `startConnect()`; start of the time-to-IP measurement.
+    unsigned long _retryAtMs;       ///< `millis()` at which `RETRY_WAIT` begins the next attempt.
+    std::atomic<bool> _evGotIp;         ///< Set by the WiFi event task on `STA_GOT_IP`.
+    std::atomic<bool> _evDisconnected;  ///< Set by the WiFi event task on `STA_DISCONNECTED`.
+    std::atomic<uint8_t> _evReason;     ///< Reason code of the latest `STA_DISCONNECTED`.
+    std::atomic<unsigned long> _evDisconnectedAtMs; ///< `millis()` of the latest `STA_DISCONNECTED`.
+    unsigned long _linkLostAtMs;    ///< When the last established link was lost (see `getLinkLostAtMs()`).
+    std::atomic<TaskHandle_t> _linkEventTask; ///< Woken from the WiFi event task on link events; may be `nullptr`.
+    wifi_event_id_t _wifiEventId;   ///< Handle of the event handler, removed in the destructor.
+    WiFiFastReconnectCache _cache;  ///< Last AP, channel and lease.
+    ConnectStats _connectStats;     ///< Connect counters and time-to-IP.
 
     // --- Asynchronous HTTP Operation State Variables ---
     WiFiHttpState _currentHttpState; ///< Tracks the current state of the asynchronous HTTP request Finite State Machine (FSM).
-    String _asyncUrl;                ///< Stores the URL for the active or pending asynchronous HTTP request.
-    String _asyncMethod;             ///< Stores the HTTP method (e.g., "GET", "POST") for the active/pending async request.
-    String _asyncApiType;            ///< User-defined descriptive string for the type of API call (e.g., "UploadSensorReadings", "FetchConfig"). Used for logging.
-    String _asyncPayload;            ///< Stores the payload (body content, typically JSON) for the active/pending async POST or PUT request.
-    std::function<bool(JsonDocument& doc)> _asyncCb; ///< The callback function to be invoked with the parsed JSON response upon successful completion of the async request.
+    FixedString<API_URL_MAX_LEN> _asyncUrl;  ///< Stores the URL for the active or pending asynchronous HTTP request.
+    FixedString<HTTP_REQUEST_METHOD_MAX_LEN> _asyncMethod; ///< Stores the HTTP method (e.g., "GET", "POST") for the active/pending async request.
+    FixedString<HTTP_REQUEST_API_TYPE_MAX_LEN> _asyncApiType; ///< User-defined descriptive string for the type of API call (e.g., "UploadSensorReadings", "FetchConfig"). Used for logging; truncated if longer.
+    StrView _asyncPayload;           ///< Body of the active async POST, borrowed from the caller (see `NetworkInterface::startAsyncHttpRequest()`).
+    HttpResponseCallback _asyncCb; ///< The callback function to be invoked with the parsed JSON response upon successful completion of the async request.
     bool _asyncNeedsAuth;            ///< Flag indicating whether the active/pending asynchronous request requires the `_authToken` to be sent.
     unsigned long _asyncRequestStartTime; ///< Timestamp (`millis()`) marking when the current async HTTP request state (or its latest retry attempt) began. Used for implementing `HTTP_TIMEOUT`.
     bool _asyncOperationActive;      ///< Flag that is `true` if an asynchronous HTTP operation is currently in progress (i.e., `_currentHttpState` is not `IDLE`). Prevents starting new requests.
@@ -358,6 +494,32 @@ private:
      */
     bool isRetryableError(int httpStatusCode);
 
+    /**
+     * @brief Reads the current response body to its end without buffering it, keeping only its start.
+     * Used for bodies no callback parses (error responses, fire-and-forget POSTs) so the socket can be reused.
+     * @param prefix Receives the first `prefixLen - 1` body bytes, null-terminated; may be `nullptr` if `prefixLen` is 0.
+     * @param prefixLen Size of `prefix`.
+     * @param[out] bodyBytes Body size in bytes.
+     * @return `true` if the whole body was consumed and the socket can be reused; never for a body that ends when
+     *         the server closes the connection.
+     */
+    bool readBody(char* prefix, size_t prefixLen, uint32_t& bodyBytes);
+
+    /**
+     * @brief Checks whether the current response, which has no `Content-Length`, is chunked.
+     * @return `true` if its `Transfer-Encoding` (collected in `begin()`) includes `chunked`; otherwise the body
+     *         ends when the server closes the connection.
+     */
+    bool isChunkedResponse();
+
+    /**
+     * @brief Ends the current request's use of its pooled socket.
+     * Reads the server's `Keep-Alive` timeout, calls `_httpClient.end()` (which keeps the socket open only if
+     * the server allowed reuse) and returns the slot to `_pool`. Safe to call when no slot is held.
+     * @param keepOpen `false` to close the socket regardless, e.g. after an aborted or partially read response.
+     */
+    void releaseConnection(bool keepOpen);
+
 // Suppress GCC warnings for deprecated declarations if using an older ArduinoJson version
 // where StaticJsonDocument might trigger such warnings. For ArduinoJson v6+, StaticJsonDocument is standard.
 #pragma GCC diagnostic push
@@ -373,6 +535,7 @@ private:
      * microcontrollers like the ESP32 by pre-allocating the necessary memory, typically
      * in the global/static data segment when it's a class member as it is here.
      * The document is cleared (`_jsonDoc.clear()`) before attempting to parse each new response.
+     * Because responses are parsed through an `ApiResponseFilter`, it only has to hold the filtered fields.
      */
     StaticJsonDocument<JSON_DOC_SIZE_DEVICE_CONFIG> _jsonDoc; // Consider renaming JSON_DOC_SIZE_DEVICE_CONFIG to a more general JSON_DOC_SIZE_API_RESPONSE if this manager handles diverse API responses.
 #pragma GCC diagnostic pop
@@ -100,6 +100,21 @@
 /** @} */ // end of DebugConfig group
 
 
+/**
+ * @defgroup LoopProfilerConfig Control Loop Profiler
+ * @brief Per-stage timing of `loop()` (see `LoopProfiler.h`). Disabled builds contain no profiler code or RAM.
+ * @{
+ */
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED 0                 ///< Set to 1 (or pass `-DLOOP_PROFILER_ENABLED=1`) to instrument `loop()`.
+#endif
+#define LOOP_PROFILER_BUCKETS 24                ///< Power-of-two histogram buckets; bucket i counts [2^i, 2^(i+1)) us, the last is open-ended.
+#define LOOP_PROFILER_STAGE_BUDGET_US 20000UL   ///< A single stage taking longer than this counts as an overrun. (20 ms)
+#define LOOP_PROFILER_LOOP_BUDGET_US 50000UL    ///< A whole `loop()` pass taking longer than this counts as an overrun. (50 ms)
+#define LOOP_PROFILER_HTTP_PORT 8080            ///< Port of the `/profile` endpoint (WiFi only; the config portal owns port 80).
+/** @} */ // end of LoopProfilerConfig group
+
+
 /**
  * @defgroup HardwarePins Hardware Pin Definitions
  * @brief Defines ESP32 GPIO pins connected to various hardware components.
@@ -209,6 +224,19 @@ const long GPRS_SERIAL_BAUD_RATE = 115200; ///< Baud rate for HardwareSerial com
     #error "Invalid GH_ID_FIRMWARE_DEFAULT defined for API URLs. Must be 1 or 2."
 #endif
 
+// Optional combined endpoint returning `{"thresholds": <TH response>, "node_data": <ND response>}` in one round trip.
+// Leave empty if the backend does not provide it; the TH and ND endpoints are then polled separately.
+const char DEFAULT_API_SYNC_BASE_URL[] PROGMEM = ""; ///< Default base URL for the combined sync API. Empty disables it.
+
+// Optional endpoint accepting batched telemetry log records (see `TelemetryOutbox.h` for the body layout).
+// Leave empty if the backend does not provide it; records are then only kept on the SD card.
+const char DEFAULT_API_TELEMETRY_BASE_URL[] PROGMEM = ""; ///< Default base URL for telemetry backlog replay. Empty disables it.
+
+// Optional MQTT broker that pushes manual overrides and threshold changes (see `MqttManager.h` for topics and payloads).
+// Leave empty if there is no broker; overrides are then polled from the device status endpoint.
+const char DEFAULT_MQTT_BROKER_HOST[] PROGMEM = ""; ///< Default MQTT broker host name or IP. Empty disables push.
+const uint16_t DEFAULT_MQTT_BROKER_PORT = 1883;     ///< Default MQTT broker port (plain TCP; the SIM800 sockets have no TLS).
+
 // --- World Time API URL (Stored in PROGMEM) ---
 const char WORLDTIME_URL[] PROGMEM = "YOUR_WORLDTIME_API_URL"; ///< Placeholder for World Time API URL (e.g., http://worldtimeapi.org/api/timezone/Asia/Jakarta). **Replace or configure via Web Portal, ensure correct timezone.**
 
@@ -226,7 +254,7 @@ const char AUTH[] PROGMEM = "YOUR_API_TOKEN"; ///< Default API Authentication To
  */
 const unsigned long LOOP_MS = 5000;                                 ///< Main control loop cycle duration (e.g., sensor reading, display update). (5 seconds)
 const unsigned long API_MS = 15000;                                 ///< Interval for attempting API data fetch/send. (15 seconds)
-const unsigned long TIME_SYNC_INTERVAL = 24 * 3600 * 1000UL;        ///< How often to synchronize RTC with network time. (24 hours)
+const unsigned long TIME_SYNC_INTERVAL = 24 * 3600 * 1000UL;        ///< How often to synchronize RTC with network time until its drift rate is known; the shortest stretched interval. (24 hours)
 const unsigned long STALE_DATA_THRESHOLD_MS = 30 * 60 * 1000UL;     ///< Duration after which fetched sensor data is considered stale. (30 minutes)
 const unsigned long FAILSAFE_TIMEOUT_MS = 2 * 60 * 60 * 1000UL;     ///< Duration of network/API unavailability before entering FAILSAFE mode. (2 hours)
 const unsigned long SD_RETRY_INTERVAL_MS = 5 * 60 * 1000UL;         ///< Interval to retry SD card initialization if it fails. (5 minutes)
@@ -260,6 +288,20 @@ const unsigned long GPRS_CONNECTION_CHECK_INTERVAL_MS = 30000UL;    ///< How oft
 const uint8_t GPRS_MAX_RECONNECT_ATTEMPTS = 5;                      ///< Max GPRS reconnection attempts before modem restart sequence.
 const unsigned long GPRS_MODEM_ERROR_RESTART_DELAY_MS = 60000UL;    ///< Delay before restarting modem after significant error. (60s)
 const unsigned long GPRS_MODEM_FAIL_RECOVERY_TIMEOUT_MS = 5 * 60 * 1000UL; ///< Time in MODEM_FAIL state before full recovery attempt. (5 min)
+
+// --- Modem Reset Sequencing (timed sub-steps of GPRS_STATE_INIT_RESET_MODEM; updateFSM() never sleeps) ---
+const unsigned long GPRS_MODEM_SOFT_RESET_BOOT_MS = 5000UL;         ///< Wait after `AT+CFUN=1,1` before probing the modem. (5s)
+const unsigned long GPRS_MODEM_PROBE_INTERVAL_MS = 1000UL;          ///< Interval between `AT` probes while the modem boots after a reset. (1s)
+const unsigned long GPRS_MODEM_PROBE_TIMEOUT_MS = 200UL;            ///< Time one `AT` probe waits for `OK`, as TinyGSM's `testAT(200)`. (200ms)
+/**
+ * @brief Drive `MODEM_POWER_ON`, `GSM_PWR` (PWRKEY) and `GSM_RST` on a hard modem reset.
+ * Off by default: until the pin sequence has been verified on the board, a hard reset keeps its previous effective
+ * behavior, a `GPRS_MODEM_POWER_CYCLE_DELAY_MS` wait followed by `AT+CFUN=1,1`.
+ */
+const bool GPRS_MODEM_HARD_RESET_PINS = false;
+const unsigned long GPRS_SIM_UNLOCK_SETTLE_MS = 1000UL;             ///< Wait after sending the SIM PIN before checking the SIM again. (1s)
+const unsigned long GPRS_SIGNAL_POLL_INTERVAL_MS = 30000UL;         ///< How often `updateFSM()` refreshes the signal quality (`AT+CSQ`) in `DeviceState`. (30s)
+const unsigned long GPRS_REGISTRATION_POLL_MS = 5000UL;             ///< Fallback `AT+CREG?`/`AT+CGREG?` query interval while registration is not yet known from URCs. (5s)
 /** @} */ // end of GPRSTiming group
 
 /** @defgroup HTTPTiming GPRS and General HTTP Timeouts and Retries
@@ -279,6 +321,42 @@ const unsigned long HTTP_RETRY_DELAY_MS = 5000UL;              ///< Delay before
 const uint8_t MAX_HTTP_RETRIES = 3;                            ///< Maximum number of retries for a single HTTP request.
 /** @} */ // end of HTTPTiming group
 
+/** @defgroup HttpKeepAlive HTTP Keep-Alive Connection Pool
+ *  @ingroup TimingConfig
+ *  @brief Reuse of TCP connections across requests by `WiFiManager` and `GPRSManager` (see `HttpConnectionPool.h`).
+ *  @{
+ */
+#define HTTP_POOL_SLOTS 2                                       ///< Pooled connections per interface (API host + time API host). GPRS uses modem mux 0..N-1.
+const unsigned long HTTP_KEEPALIVE_IDLE_TIMEOUT_MS = 30000UL;  ///< Close a pooled connection after this long unused. (30s)
+const unsigned long HTTP_KEEPALIVE_SERVER_MARGIN_MS = 1000UL;  ///< Close this much earlier than the server's `Keep-Alive: timeout=`. (1s)
+/** @} */ // end of HttpKeepAlive group
+
+/** @defgroup HttpConditional HTTP Conditional GET Cache
+ *  @ingroup TimingConfig
+ *  @brief `ETag`/`Last-Modified` revalidation of polled GET endpoints (see `HttpValidatorCache.h`).
+ *  @{
+ */
+#define HTTP_VALIDATOR_CACHE_SLOTS 4        ///< GET endpoints whose validators are remembered (TH, ND, device status, sync).
+#define HTTP_ETAG_MAX_LEN 64                ///< Max stored `ETag` value incl. quotes and null terminator; longer tags are not cached.
+#define HTTP_LAST_MODIFIED_MAX_LEN 32       ///< Max stored `Last-Modified` value (RFC 1123 date is 29 chars) + null terminator.
+#define HTTP_SAVINGS_WINDOW_BUCKETS 12      ///< Buckets of the rolling one-hour savings window.
+const unsigned long HTTP_SAVINGS_BUCKET_MS = 5 * 60 * 1000UL; ///< Width of one savings bucket; buckets x width = one hour. (5 minutes)
+/** @} */ // end of HttpConditional group
+
+/** @defgroup WiFiConnectConfig WiFi Connection State Machine
+ *  @ingroup TimingConfig
+ *  @brief Non-blocking connect in `WiFiManager` and its fast-reconnect cache (see `WiFiFastReconnectCache.h`).
+ *  @{
+ */
+#define WIFI_CONNECT_MAX_ATTEMPTS 3                              ///< Full (scanning) attempts per connect before giving up.
+const unsigned long WIFI_CONNECT_TIMEOUT_MS = 20000UL;           ///< Max time per full attempt to get an IP. (20s)
+const unsigned long WIFI_FAST_CONNECT_TIMEOUT_MS = 4000UL;       ///< Max time for the cached BSSID/channel attempt before falling back to a scan. (4s)
+const unsigned long WIFI_CONNECT_RETRY_DELAY_MS = 1000UL;        ///< Pause between full attempts. (1s)
+const unsigned long WIFI_CONNECT_SETTLE_MS = 100UL;              ///< Pause after dropping a failed fast attempt before the scan.
+const unsigned long WIFI_CONNECT_POLL_MS = 10UL;                 ///< Poll interval of the blocking `connect()` wrappers (used from `setup()` only).
+const bool WIFI_FAST_RECONNECT_REUSE_LEASE = false;              ///< Reuse the cached IP configuration on the fast path, skipping DHCP. Only if the router reserves the address.
+/** @} */ // end of WiFiConnectConfig group
+
 const unsigned long MODEM_SERIAL_WAIT_TIMEOUT_MS = 30000UL;    ///< Max time to wait for modem serial interface to become responsive during init. (30s)
 /** @} */ // end of TimingConfig group
 
@@ -289,6 +367,8 @@ const unsigned long MODEM_SERIAL_WAIT_TIMEOUT_MS = 30000UL;    ///< Max time to
  * @{
  */
 const bool ENABLE_GPRS_FAILOVER = true; ///< If true, system attempts GPRS if WiFi fails or is unavailable.
+const bool ENABLE_GPRS_WARM_STANDBY = true; ///< With `WIFI_PREFERRED`, keeps GPRS attached but idle while on WiFi, so a WiFi loss fails over at once.
+const uint8_t HTTP_REQUEST_MAX_REISSUES = 3; ///< Times a request in flight may be moved to another interface before it is dropped.
 /** @} */ // end of NetworkFeatures group
 
 
@@ -312,6 +392,7 @@ const bool ENABLE_GPRS_FAILOVER = true; ///< If true, system attempts GPRS if Wi
 #define GPRS_USER_MAX_LEN 65     ///< Max 64 chars for GPRS username + null terminator.
 #define GPRS_PWD_MAX_LEN 65      ///< Max 64 chars for GPRS password + null terminator.
 #define SIM_PIN_MAX_LEN 9        ///< Max 8 chars for SIM PIN + null terminator.
+#define MQTT_HOST_MAX_LEN 65     ///< Max 64 chars for the MQTT broker host + null terminator.
 /** @} */ // end of ConfigStringLengths group
 
 /** @defgroup GPRSHttpBufferSizes GPRS HTTP Request Component & Communication Buffer Sizes
@@ -328,7 +409,7 @@ const bool ENABLE_GPRS_FAILOVER = true; ///< If true, system attempts GPRS if Wi
 
 // GPRS HTTP Communication Buffers
 // **IMPORTANT**: `GPRS_BODY_BUFFER_SIZE` must hold largest expected JSON response. Truncation causes parsing failure.
-#define GPRS_REQUEST_BUFFER_SIZE 512   ///< Buffer for outgoing GPRS HTTP request headers & small POST payloads.
+#define GPRS_REQUEST_BUFFER_SIZE 512   ///< Buffer for outgoing GPRS HTTP request headers & small POST payloads; larger bodies are written separately.
 #define GPRS_HEADER_BUFFER_SIZE 512    ///< Buffer for incoming GPRS HTTP response headers (individual lines).
 #define GPRS_MAX_HEADER_SIZE 1024      ///< Max total size for all received HTTP headers combined.
 #define GPRS_BODY_BUFFER_SIZE 1024     ///< Buffer for incoming GPRS HTTP response body. **Adjust based on max expected JSON payload size.**
@@ -343,6 +424,30 @@ const bool ENABLE_GPRS_FAILOVER = true; ///< If true, system attempts GPRS if Wi
 #define JSON_DOC_SIZE_DEVICE_CONFIG 1024 ///< For parsing device config/thresholds from API (e.g., `WiFiManager`, `GPRSManager`).
 #define JSON_DOC_SIZE_STATUS_POST 256    ///< For creating small JSON payloads to post device status (e.g., in main `.ino`).
 /** @} */ // end of JsonDocumentSizes group
+
+/** @defgroup HttpRequestQueueSizes HTTP Request Queue Capacity & Descriptor Sizes
+ *  @ingroup BufferSizes
+ *  @brief Sizing for the fixed-capacity request queue in `NetworkFacade` (see `HttpRequestQueue.h`).
+ *  Every slot is preallocated, so RAM cost is roughly `HTTP_REQUEST_QUEUE_CAPACITY` x (URL + payload + ~64 bytes).
+ *  @{
+ */
+#define HTTP_REQUEST_QUEUE_CAPACITY 8                               ///< Max queued HTTP requests across all priorities. Must be <= 255.
+#define HTTP_REQUEST_METHOD_MAX_LEN 8                               ///< Max HTTP method length ("DELETE") + null terminator.
+#define HTTP_REQUEST_API_TYPE_MAX_LEN 24                            ///< Max API type tag length kept for logging + null terminator.
+#define HTTP_REQUEST_PAYLOAD_MAX_LEN JSON_DOC_SIZE_STATUS_POST      ///< Max request body held in a queue slot; status POSTs are the largest regular bodies.
+#define HTTP_BULK_PAYLOAD_MAX_LEN 2048                              ///< Max body of a bulk request (telemetry replay). Held in one shared buffer per queue, so only one can be queued at a time.
+#define HTTP_IDEMPOTENCY_KEY_LEN 18                                 ///< `Idempotency-Key` value: boot nonce and request sequence as 8-digit hex, a dash, null terminator.
+#define HTTP_RESPONSE_CALLBACK_STORAGE 16                           ///< Inline bytes for a response callback's captures (`HttpResponseCallback`); four pointers on the ESP32.
+/** @} */ // end of HttpRequestQueueSizes group
+
+/** @defgroup NetworkStringSizes Network Status Strings
+ *  @ingroup BufferSizes
+ *  @brief Capacities of the `FixedString` values returned by the network interfaces (see `FixedString.h`).
+ *  @{
+ */
+#define NETWORK_STATUS_MAX_LEN 128 ///< Max `getStatusString()` line + null terminator; the facade nests the active interface's line in its own.
+#define IP_ADDRESS_MAX_LEN 16      ///< Max dotted-quad IPv4 address ("255.255.255.255") + null terminator.
+/** @} */ // end of NetworkStringSizes group
 /** @} */ // end of BufferSizes group
 
 
@@ -360,6 +465,7 @@ const bool ENABLE_GPRS_FAILOVER = true; ///< If true, system attempts GPRS if Wi
 #define NVS_KEY_SSID "wifi_ssid"       ///< Key for storing WiFi SSID (string).
 #define NVS_KEY_PWD "wifi_pwd"         ///< Key for storing WiFi password (string).
 #define NVS_KEY_TOKEN "api_token"      ///< Key for storing API authentication token (string).
+#define NVS_NAMESPACE_WIFI_CACHE "wifi_cache" ///< Namespace of the WiFi fast-reconnect record (`WiFiFastReconnectCache`); kept apart from the device config.
 
 // Keys for deprecated/old configuration values (might be used for migration or clearing from older firmware versions).
 // Consider removing these if no active migration/cleanup logic uses them.
@@ -377,6 +483,165 @@ const unsigned long PORTAL_TIMEOUT = 5 * 60 * 1000; ///< Timeout for web config
 /** @} */ // end of WebPortalConfig group
 
 
+/**
+ * @defgroup NetworkWorkerConfig Network Worker Task
+ * @brief Settings for the FreeRTOS task that owns `NetworkFacade` (see `NetworkWorker.h`).
+ * The Arduino loop runs on core 1; the worker runs next to the WiFi stack on core 0.
+ * Queue depths must be powers of two. RAM cost is roughly request depth x ~550 bytes plus
+ * event depth x (`NETWORK_WORKER_RESPONSE_MAX_LEN` + 24 bytes).
+ * @{
+ */
+#define NETWORK_WORKER_CORE 0                        ///< Core the network task is pinned to.
+#define NETWORK_WORKER_PRIORITY 1                    ///< FreeRTOS priority (same as the Arduino loop task).
+#define NETWORK_WORKER_STACK_SIZE 8192               ///< Task stack in bytes; HTTPClient/TLS and JSON parsing run on it.
+#define NETWORK_WORKER_REQUEST_QUEUE_DEPTH 8         ///< Control loop -> worker request descriptors.
+#define NETWORK_WORKER_EVENT_QUEUE_DEPTH 4           ///< Worker -> control loop response/status events.
+#define NETWORK_WORKER_RESPONSE_MAX_LEN JSON_DOC_SIZE_DEVICE_CONFIG ///< Max re-serialized (filtered) response body handed to the control loop.
+#define NETWORK_WORKER_MAX_PENDING_CALLBACKS 8       ///< Response callbacks awaiting a reply on the control side.
+const unsigned long NETWORK_WORKER_TICK_MS = 10;                        ///< Worker sleep between service passes while an HTTP request is in flight.
+const unsigned long NETWORK_WORKER_IDLE_TICK_MS = 250;                  ///< Max worker sleep when idle; a submitted request wakes it early.
+const unsigned long NETWORK_WORKER_CALLBACK_TIMEOUT_MS = 3 * 60 * 1000UL; ///< Backstop: pending callbacks with no reply or failure report after this are discarded. (3 minutes)
+/** @} */ // end of NetworkWorkerConfig group
+
+
+/**
+ * @defgroup SchedulerConfig Control Loop Scheduling
+ * @brief Settings for the `JobScheduler` that drives `loop()` (see `JobScheduler.h`).
+ * Between deadlines the loop task blocks until a network event arrives or `LOOP_MAX_SLEEP_MS` passes.
+ * @{
+ */
+#define JOB_SCHEDULER_MAX_JOBS 8                                  ///< Max registered jobs. Must be <= 127.
+const unsigned long LOOP_MAX_SLEEP_MS = 200;                      ///< Longest block between passes; bounds serial command latency.
+const unsigned long API_FETCH_RETRY_MIN_MS = 5000UL;              ///< First API fetch retry while offline; doubles up to `API_MS`. (5 seconds)
+const unsigned long TIME_SYNC_RETRY_MIN_MS = 60 * 1000UL;         ///< First time sync retry while offline or without RTC. (1 minute)
+const unsigned long TIME_SYNC_RETRY_MAX_MS = 30 * 60 * 1000UL;    ///< Max time sync retry delay. (30 minutes)
+const unsigned long SD_RETRY_MAX_INTERVAL_MS = 30 * 60 * 1000UL;  ///< Max SD re-init retry delay; starts at `SD_RETRY_INTERVAL_MS`. (30 minutes)
+#ifndef LIGHT_SLEEP_ENABLED
+#define LIGHT_SLEEP_ENABLED 0                  ///< Set to 1 to let the idle task enter automatic light sleep while both loops block. Needs a core built with `CONFIG_PM_ENABLE` and `CONFIG_FREERTOS_USE_TICKLESS_IDLE`; serial commands may lose their first bytes.
+#endif
+#define LIGHT_SLEEP_MAX_FREQ_MHZ 240           ///< CPU frequency while a power management lock is held (WiFi, UART, running tasks).
+#define LIGHT_SLEEP_MIN_FREQ_MHZ 80            ///< CPU frequency when idle but awake; 80 MHz keeps the APB clock, and with it UART and I2C timing, fixed.
+/** @} */ // end of SchedulerConfig group
+
+
+/**
+ * @defgroup LcdRenderConfig LCD Frame Buffer Rendering
+ * @brief Geometry and bus-time model of the 20x4 I2C LCD driven by `LCDDisplay` (see `LCDDisplay.h`).
+ * Callers draw into a RAM frame buffer; `LCDDisplay::flush()` sends only the cells that differ from the panel,
+ * within `LCD_FLUSH_BUDGET_US` of estimated bus time per call. Costs assume a PCF8574 backpack at 100 kHz:
+ * every HD44780 byte (character or cursor move) goes out as two nibbles of three 2-byte I2C writes each.
+ * @{
+ */
+#define LCD_COLS 20                                  ///< Display columns.
+#define LCD_ROWS 4                                   ///< Display rows.
+#define LCD_I2C_BYTES_PER_WRITE 12                   ///< I2C bytes (address + data) on the bus per HD44780 byte.
+const uint32_t LCD_WRITE_COST_US = 1300;             ///< Estimated bus time of one character or cursor move, including enable pulses.
+const uint32_t LCD_CLEAR_COST_US = 3300;             ///< Estimated bus time of a hardware clear (one command plus its 2 ms execution).
+const uint32_t LCD_FLUSH_BUDGET_US = 30000;          ///< Bus time one `flush()` may spend; the rest is sent on later passes. (~22 writes)
+const unsigned long LCD_FLUSH_RETRY_MS = 50;         ///< Longest loop block while the panel still lags the frame buffer.
+/** @} */ // end of LcdRenderConfig group
+
+
+/**
+ * @defgroup StatusUplinkConfig Batched Relay Status Uplink
+ * @brief Settings for `StatusUplinkBatcher`, which merges relay and failsafe changes into one POST.
+ * Changes noted within `STATUS_UPLINK_MAX_LATENCY_MS` of the first one are sent together; while offline the
+ * batch is kept and retried with backoff under the same sequence number.
+ * @{
+ */
+#define STATUS_UPLINK_RELAYS 3                                     ///< Relays reported in the batch (exhaust, dehumidifier, blower).
+const unsigned long STATUS_UPLINK_MAX_LATENCY_MS = 2000UL;         ///< Longest a noted change waits before its batch is sent. (2 seconds)
+const unsigned long STATUS_UPLINK_RETRY_MIN_MS = 5000UL;           ///< First retry while the batch cannot be queued (offline or queue full). (5 seconds)
+const unsigned long STATUS_UPLINK_RETRY_MAX_MS = 2 * 60 * 1000UL;  ///< Max retry delay. (2 minutes)
+/** @} */ // end of StatusUplinkConfig group
+
+
+/**
+ * @defgroup TelemetryOutboxConfig Telemetry Backlog Replay
+ * @brief Settings for `TelemetryOutbox`, which replays the SD telemetry log to the telemetry endpoint in batches.
+ * Only used when the telemetry URL is configured (`DEFAULT_API_TELEMETRY_BASE_URL`).
+ * @{
+ */
+#define TELEMETRY_OUTBOX_BATCH_RECORDS 48                                    ///< Max records per POST; must fit `HTTP_BULK_PAYLOAD_MAX_LEN` at ~42 bytes per record.
+const unsigned long TELEMETRY_OUTBOX_CHECK_MS = 5000UL;                      ///< How often the replay job checks whether a batch is due. (5 seconds)
+const unsigned long TELEMETRY_OUTBOX_MAX_DELAY_MS = 5 * 60 * 1000UL;         ///< Send a partial batch once this long has passed since the last one. (5 minutes)
+const unsigned long TELEMETRY_OUTBOX_GPRS_MIN_GAP_MS = 30 * 1000UL;          ///< Min time between batches on GPRS while a backlog drains. (30 seconds)
+const unsigned long TELEMETRY_OUTBOX_RETRY_MAX_MS = 5 * 60 * 1000UL;         ///< Max retry delay of the replay job while offline. (5 minutes)
+const unsigned long TELEMETRY_OUTBOX_ACK_TIMEOUT_MS = NETWORK_WORKER_CALLBACK_TIMEOUT_MS; ///< Resend a batch from the last ack if it is not acknowledged within this time.
+/** @} */ // end of TelemetryOutboxConfig group
+
+
+/**
+ * @defgroup MqttPushConfig MQTT Push Channel
+ * @brief Settings for `MqttManager`, which receives overrides and threshold changes from an MQTT broker.
+ * Only used when `DEFAULT_MQTT_BROKER_HOST` is set. While no session is up, overrides are polled over HTTP as before.
+ * @{
+ */
+#define MQTT_TOPIC_PREFIX "greenhouse/"                                   ///< Topics are `MQTT_TOPIC_PREFIX<gh_id>/<name>`.
+#define MQTT_TOPIC_MAX_LEN 48                                             ///< Max topic length + null terminator.
+#define MQTT_CLIENT_ID_MAX_LEN 24                                         ///< Max client id length + null terminator.
+#define MQTT_BUFFER_SIZE (NETWORK_WORKER_RESPONSE_MAX_LEN + MQTT_TOPIC_MAX_LEN + 8) ///< PubSubClient packet buffer: header, topic and the largest payload forwarded.
+#define MQTT_GPRS_MUX HTTP_POOL_SLOTS                                     ///< Modem mux channel of the push socket, after the HTTP pool channels.
+const uint16_t MQTT_KEEPALIVE_S = 120;                                     ///< Keep-alive interval; each PINGREQ is a GPRS round trip, so longer than the library default. (2 minutes)
+const uint16_t MQTT_SOCKET_TIMEOUT_S = 10;                                 ///< Max wait for CONNACK and SUBACK. (10 seconds)
+const unsigned long MQTT_RECONNECT_MIN_MS = 5000UL;                       ///< First reconnect delay after the broker was unreachable; doubles up to the max. (5 seconds)
+const unsigned long MQTT_RECONNECT_MAX_MS = 5 * 60 * 1000UL;              ///< Max reconnect delay. (5 minutes)
+/** @} */ // end of MqttPushConfig group
+
+
+/**
+ * @defgroup AtEngineConfig Asynchronous AT Command Engine
+ * @brief Sizes and timeouts of `AtCommandEngine`, which runs the GPRS FSM's status and attach commands without
+ * blocking and dispatches `+CREG`/`+CGREG` notifications.
+ * @{
+ */
+#define AT_COMMAND_QUEUE_DEPTH 4         ///< Commands that can wait behind the one in flight.
+#define AT_COMMAND_MAX_LEN 160           ///< Max command text after "AT" + null terminator; fits `AT+CSTT` with typical APN credentials.
+#define AT_INFO_PREFIX_MAX_LEN 16        ///< Max expected info-line prefix (e.g. "+CSQ:") or final token + null terminator.
+#define AT_LINE_MAX_LEN 128              ///< Max modem line kept for matching; longer lines are truncated.
+#define AT_URC_MAX_HANDLERS 4            ///< Max registered URC prefixes.
+#define AT_PASSTHROUGH_BUFFER_LEN 256    ///< Bytes held for TinyGSM from lines the engine read but does not own (socket URCs).
+const unsigned long AT_DEFAULT_TIMEOUT_MS = 1000UL;   ///< Default command timeout, as TinyGSM `waitResponse()`. (1s)
+/** @} */ // end of AtEngineConfig group
+
+
+/**
+ * @defgroup TelemetryLog SD Card Telemetry Log
+ * @brief Layout of the binary telemetry log written by `SDCardLogger` (see `TelemetryRecord.h`).
+ * The log is a ring of preallocated segment files; the oldest segment is overwritten once all are full.
+ * Capacity is `TELEMETRY_SEGMENT_COUNT` x `TELEMETRY_SEGMENT_RECORDS` records (~7.5 days at `LOOP_MS` = 5 s).
+ * @{
+ */
+#define TELEMETRY_LOG_DIR "/tlm"                 ///< Directory holding the segment files ("/tlm/seg00.bin", ...).
+#define TELEMETRY_CHECKPOINT_PATH TELEMETRY_LOG_DIR "/state.bin" ///< Two-slot checkpoint file holding the write position and newest record.
+#define TELEMETRY_CSV_EXPORT_PATH "/log.csv"     ///< Default target of `SDCardLogger::exportCsv()`.
+#define TELEMETRY_OUTBOX_ACK_PATH TELEMETRY_LOG_DIR "/outbox.bin" ///< Two-slot file holding the last sequence number acknowledged by the telemetry endpoint.
+#define TELEMETRY_SECTOR_SIZE 512                ///< Write unit; one SD sector (16 records).
+#define TELEMETRY_SEGMENT_COUNT 16               ///< Number of segment files in the ring.
+#define TELEMETRY_SEGMENT_RECORDS 8192           ///< Records per segment (256 KB). Must be a multiple of 16.
+const unsigned long TELEMETRY_MAX_UNFLUSHED_MS = 2 * 60 * 1000UL; ///< Max age of buffered records before a partial sector is written. (2 minutes)
+#define TELEMETRY_REPLAY_MAX_SECTOR_READS 8      ///< Max sectors read per `SDCardLogger::readRecords()` call, bounding the time spent skipping gaps.
+/** @} */ // end of TelemetryLog group
+
+
+/**
+ * @defgroup SntpConfig Network Time (SNTP)
+ * @brief Servers and timeouts of `SntpClient`, which the network worker runs without blocking, and the accuracy
+ * target that `RTCManager` uses to stretch the sync interval once it has learned the RTC's drift rate.
+ * @{
+ */
+#define SNTP_SERVER_COUNT 3                                  ///< Entries in `SNTP_SERVERS`; all are queried each round.
+const char* const SNTP_SERVERS[SNTP_SERVER_COUNT] = {"0.pool.ntp.org", "1.pool.ntp.org", "time.cloudflare.com"}; ///< Queried together; the reply with the shortest round trip wins.
+const uint16_t SNTP_LOCAL_PORT = 2390;                       ///< Local UDP port for the queries.
+const unsigned long SNTP_ROUND_TIMEOUT_MS = 3000UL;          ///< Time allowed for DNS and replies of one round. (3 seconds)
+const unsigned long SNTP_POLL_TICK_MS = 2;                   ///< Worker tick while a round is running; bounds the receive timestamp error.
+const unsigned long TIME_SYNC_TARGET_ERROR_MS = 500;         ///< RTC error allowed before it is adjusted; the sync interval is stretched so the learned drift stays within it.
+const unsigned long TIME_SYNC_MAX_INTERVAL_MS = 7 * 24 * 3600 * 1000UL; ///< Upper bound of the stretched sync interval; it never drops below `TIME_SYNC_INTERVAL`. (7 days)
+const unsigned long RTC_DRIFT_MIN_SPAN_MS = 6 * 3600 * 1000UL;  ///< Shortest span between two SNTP samples used to estimate the RTC drift rate. (6 hours)
+const unsigned long TIME_SYNC_CHECK_INTERVAL_MS = 3600 * 1000UL; ///< How often the control loop asks `RTCManager::isSyncDue()`; bounds how late a stretched sync runs. (1 hour)
+/** @} */ // end of SntpConfig group
+
+
 /**
  * @defgroup SystemThresholds Miscellaneous System Thresholds & Time Settings
  * @brief System-level thresholds and time-related settings.
@@ -385,6 +650,8 @@ const unsigned long PORTAL_TIMEOUT = 5 * 60 * 1000; ///< Timeout for web config
 const uint32_t RTC_DRIFT_THRESHOLD_SECONDS = 60;     ///< If RTC time drifts by more than this from network time, force sync (60 seconds).
 const int WDT_TIMEOUT = 60;                          ///< ESP32 Watchdog Timer timeout in seconds. Main loop must reset WDT. (60 seconds)
 const int NTP_TIMEZONE_OFFSET_SECONDS = 7 * 3600;    ///< Timezone offset from UTC in seconds (e.g., GMT+7 for Jakarta). Used for local time.
+const unsigned long RTC_REANCHOR_INTERVAL_MS = 60 * 1000UL; ///< How often the extrapolated clock is checked against one DS3231 read. (1 minute)
+const uint32_t RTC_EDGE_SEARCH_MAX_US = 1100000UL;   ///< Longest wait for a DS3231 seconds edge when anchoring at boot. (1.1 seconds)
 /** @} */ // end of SystemThresholds group
 
 
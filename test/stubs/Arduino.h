@@ -0,0 +1,231 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino-ESP32 core the natively tested modules use.
+ *
+ * Only built by `env:native` (`test/stubs` is first on its include path). Time is virtual: `millis()`,
+ * `micros()` and `esp_timer_get_time()` read one microsecond counter that only moves when a test calls
+ * `nativeAdvanceUs()`/`nativeAdvanceMs()` or the code under test calls `delay()`, so timeouts and soak runs
+ * execute instantly and deterministically. `Serial` discards its output unless `nativeSerialEcho(true)`.
+ * Once a test runs tasks on threads (freertos/task.h), advancing the clock blocks the calling task instead.
+ *
+ * Everything is header-only (inline functions with function-local statics) so no extra translation unit has
+ * to be linked into each test.
+ */
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm> // For std::min/std::max, as the ESP32 core pulls them in.
+
+// newlib (ESP32) and the BSDs have strlcpy(); glibc only since 2.38.
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define IRAM_ATTR
+#define strncpy_P(dst, src, n) strncpy((dst), (src), (n))
+#define memcpy_P(dst, src, n) memcpy((dst), (src), (n))
+class __FlashStringHelper;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+// --- Virtual clock ---
+
+/**
+ * @brief The virtual time in microseconds since "boot".
+ */
+inline int64_t& nativeNowUs() {
+    static int64_t now = 0;
+    return now;
+}
+/**
+ * @brief Set while FreeRTOS tasks run on threads (freertos/task.h): advancing the clock then blocks the calling task.
+ */
+typedef void (*NativeSleepHook)(int64_t us);
+inline NativeSleepHook& nativeSleepHook() {
+    static NativeSleepHook hook = nullptr;
+    return hook;
+}
+inline void nativeAdvanceUs(int64_t us) {
+    if (nativeSleepHook()) nativeSleepHook()(us);
+    else nativeNowUs() += us;
+}
+inline void nativeAdvanceMs(unsigned long ms) { nativeAdvanceUs((int64_t)ms * 1000); }
+inline void nativeSetMs(unsigned long ms) { nativeNowUs() = (int64_t)ms * 1000; }
+
+inline unsigned long millis() { return (unsigned long)(nativeNowUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)nativeNowUs(); }
+inline void delay(unsigned long ms) { nativeAdvanceMs(ms); }
+inline void delayMicroseconds(unsigned int us) { nativeAdvanceUs(us); }
+inline void yield() {}
+
+// --- GPIO recorder ---
+
+/**
+ * @brief Last level written to each pin and the virtual time of the write.
+ */
+struct NativePinState {
+    int level = -1;
+    int mode = -1;
+    int64_t changedAtUs = 0;
+    uint32_t writes = 0;
+};
+inline NativePinState& nativePin(uint8_t pin) {
+    static NativePinState pins[64];
+    return pins[pin & 63];
+}
+inline void pinMode(uint8_t pin, uint8_t mode) { nativePin(pin).mode = mode; }
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+    NativePinState& p = nativePin(pin);
+    p.level = level;
+    p.changedAtUs = nativeNowUs();
+    p.writes++;
+}
+inline int digitalRead(uint8_t pin) { return nativePin(pin).level > 0 ? HIGH : LOW; }
+
+// --- Print / Stream ---
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* s) { return s ? write(reinterpret_cast<const uint8_t*>(s), strlen(s)) : 0; }
+    size_t print(const char* s) { return write(s); }
+    size_t print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(long v) { char b[24]; snprintf(b, sizeof(b), "%ld", v); return write(b); }
+    size_t print(unsigned long v) { char b[24]; snprintf(b, sizeof(b), "%lu", v); return write(b); }
+    size_t print(int v) { return print((long)v); }
+    size_t print(unsigned int v) { return print((unsigned long)v); }
+    size_t print(double v, int digits = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", digits, v); return write(b); }
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    __attribute__((format(printf, 2, 3))) size_t printf(const char* fmt, ...) {
+        char b[256];
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(b, sizeof(b), fmt, args);
+        va_end(args);
+        if (n < 0) return 0;
+        return write(reinterpret_cast<const uint8_t*>(b), (size_t)n < sizeof(b) ? (size_t)n : sizeof(b) - 1);
+    }
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+    Stream() : _timeout(1000) {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() const { return _timeout; }
+    /**
+     * @brief Reads up to `length` bytes; like the core, waits up to the timeout (virtual time) for each byte.
+     */
+    virtual size_t readBytes(char* buffer, size_t length) {
+        size_t n = 0;
+        while (n < length) {
+            int c = timedRead();
+            if (c < 0) break;
+            buffer[n++] = (char)c;
+        }
+        return n;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes(reinterpret_cast<char*>(buffer), length); }
+
+protected:
+    int timedRead() {
+        unsigned long start = millis();
+        do {
+            int c = read();
+            if (c >= 0) return c;
+            nativeAdvanceMs(1);
+        } while (millis() - start < _timeout);
+        return -1;
+    }
+    unsigned long _timeout;
+};
+
+/**
+ * @brief `Serial` stand-in: discards output unless echo is enabled.
+ */
+class NativeSerial : public Stream {
+public:
+    size_t write(uint8_t c) override {
+        if (echo()) putchar(c);
+        return 1;
+    }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void begin(unsigned long) {}
+    static bool& echo() {
+        static bool on = false;
+        return on;
+    }
+};
+inline NativeSerial& nativeSerial() {
+    static NativeSerial serial;
+    return serial;
+}
+inline void nativeSerialEcho(bool on) { NativeSerial::echo() = on; }
+#define Serial (nativeSerial())
+
+// --- ESP ---
+
+/**
+ * @brief `ESP`: a fixed factory MAC (24:0a:c4:01:02:03, first octet in the lowest byte, as the efuse holds it).
+ */
+struct NativeEsp {
+    uint64_t getEfuseMac() const { return 0x030201c40a24ULL; }
+};
+inline NativeEsp& nativeEsp() {
+    static NativeEsp esp;
+    return esp;
+}
+#define ESP (nativeEsp())
+
+// --- FreeRTOS critical sections (no-ops: host tasks never run at the same time) ---
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+// As in the core, `String`, `esp_random()` and the FreeRTOS task API come with Arduino.h.
+#include "WString.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,25 @@
+/**
+ * @file Client.h
+ * @brief Host stand-in for the Arduino `Client` interface, the common base of `WiFiClient` and `TinyGsmClient`.
+ */
+#ifndef NATIVE_CLIENT_H
+#define NATIVE_CLIENT_H
+
+#include "Arduino.h"
+
+/**
+ * @brief The part of the core's `Client` interface the natively tested modules use; tests implement it over a
+ *        scripted peer.
+ */
+class Client : public Stream {
+public:
+    virtual int connect(const char* host, uint16_t port) = 0;
+    using Print::write;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    using Stream::read;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+};
+
+#endif // NATIVE_CLIENT_H
@@ -0,0 +1,160 @@
+/**
+ * @file FS.h
+ * @brief Host stand-in for the ESP32 `fs::File`/`fs::FS` API, backed by files in a host directory.
+ *
+ * A path on the emulated card is a path below `nativeSd().root`. Files are host `FILE*`s shared between copies
+ * of a `File`, as the core shares its `FileImpl`; the last copy (or `close()`) closes them. `nativeSd()` also
+ * counts the bytes that reach the card and can cut the power part-way through a write: once `writeBudget`
+ * bytes have been written, writes are truncated to what is left and then fail, leaving a torn sector behind.
+ */
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+/**
+ * @brief The emulated card: host directory, fault injection and traffic counters.
+ */
+struct NativeSdCard {
+    std::string root;        ///< Host directory holding the card's files.
+    bool present = true;     ///< `SD.begin()` fails while `false`.
+    int64_t writeBudget = -1;///< Bytes that may still be written before the power cut; -1 is unlimited.
+    uint64_t bytesWritten = 0;///< Bytes written to files on the card, by any path.
+    uint32_t writeCalls = 0; ///< `File::write()` calls that wrote something.
+    uint64_t bytesRead = 0;  ///< Bytes read from files on the card.
+    uint32_t opens = 0;      ///< Successful `open()` calls.
+
+    void resetCounters() {
+        bytesWritten = 0;
+        writeCalls = 0;
+        bytesRead = 0;
+        opens = 0;
+    }
+    std::string hostPath(const char* path) const { return root + (path[0] == '/' ? "" : "/") + path; }
+};
+
+/**
+ * @brief The one emulated card of the test program; its root is a fresh temporary directory, removed at exit.
+ */
+inline NativeSdCard& nativeSd() {
+    static NativeSdCard card;
+    if (card.root.empty()) {
+        char tmpl[] = "/tmp/native_sd_XXXXXX";
+        const char* dir = mkdtemp(tmpl);
+        card.root = dir ? dir : "/tmp/native_sd";
+        ::mkdir(card.root.c_str(), 0755);
+        atexit([]() {
+            std::string cmd = "rm -rf '" + nativeSd().root + "'";
+            if (system(cmd.c_str()) != 0) {}
+        });
+    }
+    return card;
+}
+
+/**
+ * @brief Deletes every file and directory on the emulated card and resets its settings.
+ */
+inline void nativeSdWipe() {
+    NativeSdCard& card = nativeSd();
+    std::string cmd = "rm -rf '" + card.root + "'/* 2>/dev/null";
+    if (system(cmd.c_str()) != 0) {} // Nothing to delete is fine.
+    card.present = true;
+    card.writeBudget = -1;
+    card.resetCounters();
+}
+
+namespace fs {
+
+class File : public Stream {
+public:
+    File() {}
+    explicit File(FILE* fp) : _fp(fp, fclose) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (!_fp) return 0;
+        NativeSdCard& card = nativeSd();
+        if (card.writeBudget >= 0 && (int64_t)size > card.writeBudget) size = (size_t)card.writeBudget;
+        if (size == 0) return 0;
+        size_t n = fwrite(buf, 1, size, _fp.get());
+        if (card.writeBudget >= 0) card.writeBudget -= (int64_t)n;
+        card.bytesWritten += n;
+        card.writeCalls++;
+        return n;
+    }
+    using Print::write;
+
+    int available() override {
+        if (!_fp) return 0;
+        long pos = ftell(_fp.get());
+        return (int)((long)size() - pos);
+    }
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    size_t read(uint8_t* buf, size_t size) {
+        if (!_fp) return 0;
+        size_t n = fread(buf, 1, size, _fp.get());
+        nativeSd().bytesRead += n;
+        return n;
+    }
+    int peek() override {
+        if (!_fp) return -1;
+        int c = fgetc(_fp.get());
+        if (c != EOF) ungetc(c, _fp.get());
+        return c == EOF ? -1 : c;
+    }
+    bool seek(uint32_t pos) { return _fp && fseek(_fp.get(), (long)pos, SEEK_SET) == 0; }
+    size_t position() const { return _fp ? (size_t)ftell(_fp.get()) : 0; }
+    size_t size() const {
+        if (!_fp) return 0;
+        fflush(_fp.get());
+        struct stat st;
+        return fstat(fileno(_fp.get()), &st) == 0 ? (size_t)st.st_size : 0;
+    }
+    void flush() override {
+        if (_fp) fflush(_fp.get());
+    }
+    void close() { _fp.reset(); }
+    operator bool() const { return (bool)_fp; }
+
+private:
+    std::shared_ptr<FILE> _fp;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ) {
+        std::string host = nativeSd().hostPath(path);
+        struct stat st;
+        if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) return File();
+        std::string m = std::string(mode) + "b";
+        if (m == "r+b" && stat(host.c_str(), &st) != 0) return File();
+        FILE* fp = fopen(host.c_str(), m.c_str());
+        if (!fp) return File();
+        nativeSd().opens++;
+        return File(fp);
+    }
+    bool exists(const char* path) {
+        struct stat st;
+        return stat(nativeSd().hostPath(path).c_str(), &st) == 0;
+    }
+    bool mkdir(const char* path) { return ::mkdir(nativeSd().hostPath(path).c_str(), 0755) == 0; }
+    bool remove(const char* path) { return ::remove(nativeSd().hostPath(path).c_str()) == 0; }
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+
+#endif // NATIVE_FS_H
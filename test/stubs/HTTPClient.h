@@ -0,0 +1,242 @@
+/**
+ * @file HTTPClient.h
+ * @brief Host stand-in for the ESP32 `HTTPClient`, following the core's (2.x) request and response handling on a
+ *        caller-supplied `WiFiClient`.
+ *
+ * What `WiFiManager` relies on behaves as on the target:
+ * - `sendRequest()` reuses the client's socket if it is still connected (discarding stray bytes) and
+ *   connects otherwise; a failed write is `HTTPC_ERROR_SEND_HEADER_FAILED`.
+ * - Only the status line and headers are read. `getSize()` is the `Content-Length`, or -1 for chunked and
+ *   close-delimited bodies, and `getStream()` is the raw socket, still framed.
+ * - Collected headers (`collectHeaders()`) are cleared at each response; "Connection: close" or an HTTP/1.0
+ *   reply makes `end()` stop the socket, otherwise `setReuse(true)` keeps it.
+ * Waits run on the virtual clock, so a read timeout costs no real time.
+ */
+#ifndef NATIVE_HTTPCLIENT_H
+#define NATIVE_HTTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_NO_CONTENT = 204,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_NOT_FOUND = 404
+} t_http_codes;
+
+class HTTPClient {
+public:
+    HTTPClient() : _client(nullptr), _port(80), _useHTTP10(false), _reuse(true), _canReuse(false),
+                   _tcpTimeout(HTTPCLIENT_DEFAULT_TCP_TIMEOUT), _returnCode(0), _size(-1) {}
+
+    bool begin(WiFiClient& client, const char* url) {
+        _client = &client;
+        clear();
+        const char* p = strstr(url, "://");
+        if (!p) return false;
+        std::string protocol(url, p - url);
+        if (protocol != "http" && protocol != "https") return false;
+        p += 3;
+        size_t hostLen = strcspn(p, ":/?");
+        _host.assign(p, hostLen);
+        _port = protocol == "https" ? 443 : 80;
+        p += hostLen;
+        if (*p == ':') _port = (uint16_t)strtoul(p + 1, const_cast<char**>(&p), 10);
+        _uri = *p ? p : "/";
+        return !_host.empty();
+    }
+    void end() {
+        disconnect();
+        clear();
+    }
+    bool connected() { return _client && (_client->available() > 0 || _client->connected()); }
+
+    void setReuse(bool reuse) { _reuse = reuse; }
+    void useHTTP10(bool http10) {
+        _useHTTP10 = http10;
+        _reuse = !http10;
+    }
+    void setTimeout(uint16_t timeoutMs) { _tcpTimeout = timeoutMs; }
+    void addHeader(const char* name, const char* value) {
+        _headers += name;
+        _headers += ": ";
+        _headers += value;
+        _headers += "\r\n";
+    }
+    void collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+        _collected.clear();
+        for (size_t i = 0; i < headerKeysCount; ++i) _collected.push_back(Header{headerKeys[i], ""});
+    }
+    String header(const char* name) {
+        for (size_t i = 0; i < _collected.size(); ++i) {
+            if (strcasecmp(_collected[i].key.c_str(), name) == 0) return String(_collected[i].value);
+        }
+        return String();
+    }
+
+    int GET() { return sendRequest("GET"); }
+    int POST(uint8_t* payload, size_t size) { return sendRequest("POST", payload, size); }
+    int sendRequest(const char* type, uint8_t* payload = nullptr, size_t size = 0) {
+        if (!connect()) return HTTPC_ERROR_CONNECTION_REFUSED;
+        std::string head = std::string(type) + " " + _uri + (_useHTTP10 ? " HTTP/1.0" : " HTTP/1.1") + "\r\n";
+        head += "Host: " + _host + (_port != 80 && _port != 443 ? ":" + std::to_string(_port) : "") + "\r\n";
+        head += "User-Agent: ESP32HTTPClient\r\n";
+        head += std::string("Connection: ") + (_reuse ? "keep-alive" : "close") + "\r\n";
+        if (!_useHTTP10) head += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+        if (payload && size > 0) head += "Content-Length: " + std::to_string(size) + "\r\n";
+        head += _headers + "\r\n";
+        if (_client->write(reinterpret_cast<const uint8_t*>(head.data()), head.size()) != head.size()) {
+            return fail(HTTPC_ERROR_SEND_HEADER_FAILED);
+        }
+        if (payload && size > 0 && _client->write(payload, size) != size) return fail(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+        _returnCode = handleHeaderResponse();
+        if (_returnCode < 0) return fail(_returnCode);
+        return _returnCode;
+    }
+
+    int getSize() { return _size; }
+    WiFiClient& getStream() { return *_client; }
+
+    static String errorToString(int error) {
+        switch (error) {
+            case HTTPC_ERROR_CONNECTION_REFUSED: return String("connection refused");
+            case HTTPC_ERROR_SEND_HEADER_FAILED: return String("send header failed");
+            case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return String("send payload failed");
+            case HTTPC_ERROR_NOT_CONNECTED: return String("not connected");
+            case HTTPC_ERROR_CONNECTION_LOST: return String("connection lost");
+            case HTTPC_ERROR_NO_STREAM: return String("no stream");
+            case HTTPC_ERROR_NO_HTTP_SERVER: return String("no HTTP server");
+            case HTTPC_ERROR_TOO_LESS_RAM: return String("too less ram");
+            case HTTPC_ERROR_ENCODING: return String("Transfer-Encoding not supported");
+            case HTTPC_ERROR_STREAM_WRITE: return String("Stream write error");
+            case HTTPC_ERROR_READ_TIMEOUT: return String("read Timeout");
+            default: return String();
+        }
+    }
+
+private:
+    struct Header {
+        std::string key;
+        std::string value;
+    };
+
+    void clear() {
+        _returnCode = 0;
+        _size = -1;
+        _headers.clear();
+    }
+
+    bool connect() {
+        if (!_client) return false;
+        if (connected()) {
+            while (_client->available() > 0) _client->read(); // Leftovers of an earlier response.
+            return true;
+        }
+        return _client->connect(_host.c_str(), _port, _tcpTimeout) == 1;
+    }
+
+    void disconnect() {
+        if (!connected()) return;
+        while (_client->available() > 0) _client->read();
+        if (!(_reuse && _canReuse)) _client->stop();
+    }
+
+    int fail(int error) {
+        if (connected()) _client->stop();
+        return error;
+    }
+
+    /**
+     * @brief Reads one header line (without CR/LF), waiting up to the TCP timeout for each byte.
+     * @return `false` if the connection closed or timed out first.
+     */
+    bool readLine(std::string& line, int& error) {
+        line.clear();
+        unsigned long lastDataMs = millis();
+        while (connected()) {
+            int c = _client->read();
+            if (c < 0) {
+                if (millis() - lastDataMs > _tcpTimeout) {
+                    error = HTTPC_ERROR_READ_TIMEOUT;
+                    return false;
+                }
+                delay(10);
+                continue;
+            }
+            lastDataMs = millis();
+            if (c == '\n') {
+                if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+                return true;
+            }
+            line += (char)c;
+        }
+        error = HTTPC_ERROR_CONNECTION_LOST;
+        return false;
+    }
+
+    int handleHeaderResponse() {
+        _size = -1;
+        _canReuse = _reuse;
+        int code = 0;
+        for (size_t i = 0; i < _collected.size(); ++i) _collected[i].value.clear();
+        std::string line;
+        int error = 0;
+        while (readLine(line, error)) {
+            if (line.compare(0, 7, "HTTP/1.") == 0) {
+                if (_canReuse) _canReuse = line.size() > 7 && line[7] != '0';
+                code = atoi(line.c_str() + 9);
+            } else if (line.empty()) {
+                return code ? code : HTTPC_ERROR_NO_HTTP_SERVER;
+            } else {
+                size_t colon = line.find(':');
+                if (colon == std::string::npos) continue;
+                std::string name = line.substr(0, colon);
+                size_t v = line.find_first_not_of(' ', colon + 1);
+                std::string value = v == std::string::npos ? "" : line.substr(v);
+                if (strcasecmp(name.c_str(), "Content-Length") == 0) _size = atoi(value.c_str());
+                if (_canReuse && strcasecmp(name.c_str(), "Connection") == 0 &&
+                    value.find("close") != std::string::npos && value.find("keep-alive") == std::string::npos) {
+                    _canReuse = false;
+                }
+                for (size_t i = 0; i < _collected.size(); ++i) {
+                    if (strcasecmp(_collected[i].key.c_str(), name.c_str()) != 0) continue;
+                    if (!_collected[i].value.empty()) _collected[i].value += ',';
+                    _collected[i].value += value;
+                }
+            }
+        }
+        return error;
+    }
+
+    WiFiClient* _client;
+    std::string _host;
+    uint16_t _port;
+    std::string _uri;
+    bool _useHTTP10;
+    bool _reuse;
+    bool _canReuse;
+    unsigned long _tcpTimeout;
+    std::string _headers; ///< Added request headers, already formatted.
+    std::vector<Header> _collected;
+    int _returnCode;
+    int _size;
+};
+
+#endif // NATIVE_HTTPCLIENT_H
@@ -0,0 +1,28 @@
+/**
+ * @file IPAddress.h
+ * @brief Host stand-in for the core's `IPAddress`.
+ */
+#ifndef NATIVE_IPADDRESS_H
+#define NATIVE_IPADDRESS_H
+
+#include "Arduino.h"
+
+/**
+ * @brief IPv4 address held, like the core's, as a 32-bit value in network byte order.
+ */
+class IPAddress {
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint32_t address) : _address(address) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return (uint8_t)(_address >> (8 * (index & 3))); }
+
+private:
+    uint32_t _address;
+};
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+#endif // NATIVE_IPADDRESS_H
@@ -0,0 +1,92 @@
+/**
+ * @file LiquidCrystal_I2C.h
+ * @brief Host stand-in for `LiquidCrystal_I2C` that records what reaches the bus and emulates the HD44780's DDRAM.
+ *
+ * Like the library on a PCF8574 backpack in 4-bit mode, every HD44780 byte (character or command) is two nibbles
+ * of three expander writes (data, enable high, enable low), each an address byte plus a data byte: 12 bytes on
+ * the bus. Characters land at the address counter, which auto-increments across the two-line DDRAM layout
+ * (0x27 continues at 0x40, 0x67 at 0x00), so a test can read back exactly what a 20x4 panel would show.
+ * One panel per test program, reached through `nativeLcdBus()`.
+ */
+#ifndef NATIVE_LIQUID_CRYSTAL_I2C_H
+#define NATIVE_LIQUID_CRYSTAL_I2C_H
+
+#include "Arduino.h"
+
+/**
+ * @brief The emulated panel and its bus counters.
+ */
+struct NativeLcdBus {
+    uint8_t ddram[0x80];    ///< Display data RAM, addresses 0x00-0x27 and 0x40-0x67 in use.
+    uint8_t address = 0;    ///< Address counter.
+    uint32_t i2cBytes = 0;  ///< Bytes on the bus, addresses included.
+    uint32_t characters = 0;///< Character writes.
+    uint32_t commands = 0;  ///< Commands (cursor moves, clears, setup).
+    uint32_t clears = 0;    ///< Clear display commands.
+
+    NativeLcdBus() { memset(ddram, ' ', sizeof(ddram)); }
+    void resetCounters() { i2cBytes = characters = commands = clears = 0; }
+
+    /**
+     * @brief The characters a panel row shows, from DDRAM.
+     */
+    void row(uint8_t r, uint8_t cols, char* out) const {
+        static const uint8_t kRowOffsets[4] = {0x00, 0x40, 0x14, 0x54};
+        memcpy(out, &ddram[kRowOffsets[r & 3]], cols);
+        out[cols] = '\0';
+    }
+};
+
+inline NativeLcdBus& nativeLcdBus() {
+    static NativeLcdBus bus;
+    return bus;
+}
+
+class LiquidCrystal_I2C : public Print {
+public:
+    static const uint32_t BYTES_PER_SEND = 12; ///< 2 nibbles x 3 expander writes x (address + data).
+
+    LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows) : _rows(rows) { (void)addr; (void)cols; }
+
+    void init() {
+        nativeLcdBus() = NativeLcdBus();
+        command(0x28); // Function set: 4-bit, two lines.
+        command(0x0C); // Display on.
+        clear();
+        command(0x06); // Entry mode: increment.
+    }
+    void backlight() { nativeLcdBus().i2cBytes += 2; } // One expander write.
+    void clear() {
+        NativeLcdBus& bus = nativeLcdBus();
+        command(0x01);
+        memset(bus.ddram, ' ', sizeof(bus.ddram));
+        bus.address = 0;
+        bus.clears++;
+        delayMicroseconds(2000); // As the library does.
+    }
+    void setCursor(uint8_t col, uint8_t row) {
+        static const uint8_t kRowOffsets[4] = {0x00, 0x40, 0x14, 0x54};
+        if (row >= _rows) row = _rows - 1;
+        command(0x80 | (col + kRowOffsets[row]));
+        nativeLcdBus().address = (col + kRowOffsets[row]) & 0x7F;
+    }
+    size_t write(uint8_t value) override {
+        NativeLcdBus& bus = nativeLcdBus();
+        bus.i2cBytes += BYTES_PER_SEND;
+        bus.characters++;
+        bus.ddram[bus.address] = value;
+        bus.address = bus.address == 0x27 ? 0x40 : (bus.address == 0x67 ? 0x00 : bus.address + 1);
+        return 1;
+    }
+    using Print::write;
+
+private:
+    void command(uint8_t) {
+        nativeLcdBus().i2cBytes += BYTES_PER_SEND;
+        nativeLcdBus().commands++;
+    }
+
+    uint8_t _rows;
+};
+
+#endif // NATIVE_LIQUID_CRYSTAL_I2C_H
@@ -0,0 +1,207 @@
+/**
+ * @file NativeHttpServer.h
+ * @brief Loopback HTTP peer for the host stand-ins of `WiFiClient` and `TinyGsmClient`.
+ *
+ * `NativeSocket` is a `Client` whose connections end in `nativeHttpServer()`. The server reads each complete
+ * request the client writes (headers plus a `Content-Length` body), records it, and answers with the next
+ * scripted response, byte for byte as the test wrote it, so framing (Content-Length, chunked, close-delimited)
+ * and keep-alive are exercised through the real parsers. With no response scripted the request goes unanswered
+ * and the client sees a read timeout. `closeIdle()` and `dropIdle()` end kept-alive connections the two ways a
+ * client can find them gone: seen closed, or failing on the next write. Everything runs synchronously on the
+ * calling thread: a response is readable as soon as the request's last byte is written.
+ */
+#ifndef NATIVE_HTTP_SERVER_H
+#define NATIVE_HTTP_SERVER_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One TCP connection as both ends see it.
+ */
+struct NativeConnection {
+    std::string host;
+    uint16_t port = 0;
+    std::string fromClient;     ///< Written by the client, not yet taken as a complete request.
+    std::deque<char> toClient;  ///< Response bytes not yet read by the client.
+    bool serverClosed = false;  ///< The server closed its end (after a "close" response or `closeIdle()`).
+    bool halfOpen = false;      ///< The server dropped it without the client noticing (`dropIdle()`) until it writes.
+};
+
+/**
+ * @brief Scripted HTTP server behind every `NativeSocket`.
+ */
+class NativeHttpServer {
+public:
+    /**
+     * @brief Forgets all scripted responses, recorded requests, counters and connections.
+     */
+    void reset() {
+        _responses.clear();
+        requests.clear();
+        connects = 0;
+        refuse = false;
+        for (size_t i = 0; i < _conns.size(); ++i) {
+            std::shared_ptr<NativeConnection> c = _conns[i].lock();
+            if (c) c->serverClosed = true;
+        }
+        _conns.clear();
+    }
+
+    /**
+     * @brief Queues the raw bytes (status line, headers, body) answering the next request.
+     * @param close Close the connection once the response is sent, as a server does after "Connection: close"
+     *              or a close-delimited body.
+     */
+    void respond(const std::string& raw, bool close = false) { _responses.push_back(Scripted{raw, close}); }
+
+    /**
+     * @brief Closes every connection with nothing left to read, as a server does when its keep-alive expires.
+     */
+    void closeIdle() {
+        for (size_t i = 0; i < _conns.size(); ++i) {
+            std::shared_ptr<NativeConnection> c = _conns[i].lock();
+            if (c && c->toClient.empty()) c->serverClosed = true;
+        }
+    }
+
+    /**
+     * @brief Drops every connection with nothing left to read without telling the client, as a NAT timeout or a
+     *        server reboot does: the socket still looks open, and its next write fails.
+     */
+    void dropIdle() {
+        for (size_t i = 0; i < _conns.size(); ++i) {
+            std::shared_ptr<NativeConnection> c = _conns[i].lock();
+            if (c && c->toClient.empty()) c->halfOpen = true;
+        }
+    }
+
+    /**
+     * @brief Number of scripted responses not yet sent.
+     */
+    size_t pending() const { return _responses.size(); }
+
+    /**
+     * @brief Gets the newest open connection to `host`:`port`, to inspect or answer traffic that is not HTTP
+     *        (e.g. an MQTT session on a push socket) by hand.
+     * @return The connection, or `nullptr` if there is none.
+     */
+    std::shared_ptr<NativeConnection> connectionTo(const char* host, uint16_t port) {
+        for (size_t i = _conns.size(); i-- > 0;) {
+            std::shared_ptr<NativeConnection> c = _conns[i].lock();
+            if (c && !c->serverClosed && c->host == host && c->port == port) return c;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Opens a connection, unless `refuse` is set.
+     */
+    std::shared_ptr<NativeConnection> accept(const char* host, uint16_t port) {
+        if (refuse) return nullptr;
+        std::shared_ptr<NativeConnection> c = std::make_shared<NativeConnection>();
+        c->host = host;
+        c->port = port;
+        _conns.push_back(c);
+        connects++;
+        return c;
+    }
+
+    /**
+     * @brief Takes every complete request the client has written and queues its response.
+     */
+    void process(NativeConnection& c) {
+        for (;;) {
+            size_t headEnd = c.fromClient.find("\r\n\r\n");
+            if (headEnd == std::string::npos) return;
+            size_t total = headEnd + 4 + contentLength(c.fromClient.substr(0, headEnd));
+            if (c.fromClient.size() < total) return;
+            requests.push_back(c.fromClient.substr(0, total));
+            c.fromClient.erase(0, total);
+            if (_responses.empty() || c.serverClosed) continue; // Unanswered: the client times out.
+            Scripted r = _responses.front();
+            _responses.pop_front();
+            c.toClient.insert(c.toClient.end(), r.raw.begin(), r.raw.end());
+            if (r.close) c.serverClosed = true;
+        }
+    }
+
+    std::vector<std::string> requests; ///< Every complete request received, in order.
+    uint32_t connects = 0;             ///< Connections accepted.
+    bool refuse = false;               ///< Refuse new connections (host unreachable).
+
+private:
+    struct Scripted {
+        std::string raw;
+        bool close;
+    };
+
+    static size_t contentLength(const std::string& head) {
+        std::string lower(head);
+        for (size_t i = 0; i < lower.size(); ++i) lower[i] = (char)tolower((unsigned char)lower[i]);
+        size_t p = lower.find("\r\ncontent-length:");
+        return p == std::string::npos ? 0 : (size_t)strtoul(lower.c_str() + p + 17, nullptr, 10);
+    }
+
+    std::deque<Scripted> _responses;
+    std::vector<std::weak_ptr<NativeConnection>> _conns;
+};
+
+inline NativeHttpServer& nativeHttpServer() {
+    static NativeHttpServer server;
+    return server;
+}
+
+/**
+ * @brief A `Client` connected to `nativeHttpServer()`.
+ */
+class NativeSocket : public Client {
+public:
+    int connect(const char* host, uint16_t port) override {
+        _conn = nativeHttpServer().accept(host, port);
+        return _conn ? 1 : 0;
+    }
+    int connect(const char* host, uint16_t port, int32_t /*timeoutMs*/) { return connect(host, port); }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (_conn && _conn->halfOpen) _conn->serverClosed = true; // The peer answers with a reset.
+        if (!_conn || _conn->serverClosed) return 0; // Peer gone: the write fails, as on a reset connection.
+        _conn->fromClient.append(reinterpret_cast<const char*>(buffer), size);
+        nativeHttpServer().process(*_conn);
+        return size;
+    }
+    using Print::write;
+
+    int available() override { return _conn ? (int)_conn->toClient.size() : 0; }
+    int read() override {
+        if (!_conn || _conn->toClient.empty()) return -1;
+        int c = (uint8_t)_conn->toClient.front();
+        _conn->toClient.pop_front();
+        return c;
+    }
+    int read(uint8_t* buffer, size_t size) override {
+        size_t n = 0;
+        while (n < size && _conn && !_conn->toClient.empty()) {
+            buffer[n++] = (uint8_t)_conn->toClient.front();
+            _conn->toClient.pop_front();
+        }
+        return (int)n;
+    }
+    int peek() override { return (_conn && !_conn->toClient.empty()) ? (uint8_t)_conn->toClient.front() : -1; }
+    void stop() override { _conn.reset(); }
+    /**
+     * @brief Like lwIP's: open while unread data remains, even after the server closed.
+     */
+    uint8_t connected() override { return _conn && (!_conn->serverClosed || !_conn->toClient.empty()); }
+    operator bool() override { return _conn != nullptr; }
+
+private:
+    std::shared_ptr<NativeConnection> _conn;
+};
+
+#endif // NATIVE_HTTP_SERVER_H
@@ -0,0 +1,108 @@
+/**
+ * @file NativeModem.h
+ * @brief Scripted SIM800 on the other end of the modem UART, for `AtCommandEngine` and the TinyGSM stand-in.
+ *
+ * Each command line written to it ("AT...\r") is answered at once from a reply table: the rule with the longest
+ * command prefix wins, and a command no rule matches gets "OK". The defaults make a registered, attachable
+ * modem with a ready SIM; tests override single commands (`reply()`), stop the modem answering (`silent`), or
+ * push URCs (`urc()`). Every command is recorded without "AT" and line endings in `commands`.
+ */
+#ifndef NATIVE_MODEM_H
+#define NATIVE_MODEM_H
+
+#include <Arduino.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+class NativeModem : public Stream {
+public:
+    NativeModem() { reset(); }
+
+    /**
+     * @brief Back to the default replies, with nothing recorded.
+     */
+    void reset() {
+        _replies.clear();
+        reply("+CPIN?", "\r\n+CPIN: READY\r\n\r\nOK\r\n");
+        reply("+CSQ", "\r\n+CSQ: 20,0\r\n\r\nOK\r\n");
+        reply("+CREG?", "\r\n+CREG: 1,1\r\n\r\nOK\r\n");
+        reply("+CGREG?", "\r\n+CGREG: 1,1\r\n\r\nOK\r\n");
+        reply("+CGATT?", "\r\n+CGATT: 1\r\n\r\nOK\r\n");
+        reply("+CIPSHUT", "\r\nSHUT OK\r\n");
+        reply("+CIFSR", "\r\n10.64.1.7\r\n\r\nOK\r\n"); // "+CIFSR;E0": the address, then E0's OK.
+        reply("I", "\r\nSIM800 R14.18\r\n\r\nOK\r\n");
+        commands.clear();
+        rx.clear();
+        _line.clear();
+        silent = false;
+    }
+
+    /**
+     * @brief Sets the raw reply to commands starting with `command` (after "AT").
+     */
+    void reply(const char* command, const char* raw) { _replies[command] = raw; }
+
+    /**
+     * @brief Sends an unsolicited line (e.g. "+CREG: 0").
+     */
+    void urc(const char* line) {
+        std::string s = std::string("\r\n") + line + "\r\n";
+        rx.insert(rx.end(), s.begin(), s.end());
+    }
+
+    /**
+     * @brief Counts the recorded commands starting with `prefix`.
+     */
+    size_t count(const char* prefix) const {
+        size_t n = 0;
+        for (size_t i = 0; i < commands.size(); ++i) n += commands[i].compare(0, strlen(prefix), prefix) == 0;
+        return n;
+    }
+
+    int available() override { return (int)rx.size(); }
+    int read() override {
+        if (rx.empty()) return -1;
+        int c = (uint8_t)rx.front();
+        rx.pop_front();
+        return c;
+    }
+    int peek() override { return rx.empty() ? -1 : (uint8_t)rx.front(); }
+    size_t write(uint8_t c) override {
+        if (c == '\n') return 1;
+        if (c != '\r') {
+            _line += (char)c;
+            return 1;
+        }
+        if (_line.compare(0, 2, "AT") == 0) answer(_line.substr(2));
+        _line.clear();
+        return 1;
+    }
+    using Print::write;
+
+    std::vector<std::string> commands; ///< Commands received, without "AT".
+    std::deque<char> rx;               ///< Bytes not yet read by the host side.
+    bool silent;                       ///< Answer nothing, as a modem that is off or rebooting.
+
+private:
+    void answer(const std::string& command) {
+        commands.push_back(command);
+        if (silent) return;
+        const std::string* raw = nullptr;
+        size_t best = 0;
+        for (std::map<std::string, std::string>::const_iterator it = _replies.begin(); it != _replies.end(); ++it) {
+            if (command.compare(0, it->first.size(), it->first) == 0 && it->first.size() >= best) {
+                raw = &it->second;
+                best = it->first.size();
+            }
+        }
+        std::string reply = raw ? *raw : std::string("\r\nOK\r\n");
+        rx.insert(rx.end(), reply.begin(), reply.end());
+    }
+
+    std::map<std::string, std::string> _replies;
+    std::string _line;
+};
+
+#endif // NATIVE_MODEM_H
@@ -0,0 +1,81 @@
+/**
+ * @file Preferences.h
+ * @brief Host stand-in for the ESP32 `Preferences` (NVS) library: byte blobs, strings and ints.
+ *
+ * Namespaces live in one in-memory store that outlives each `Preferences` object, as flash outlives the
+ * handle; `nativePreferencesErase()` wipes it between tests. As on the target, a namespace that was never
+ * written cannot be opened read-only.
+ */
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include "Arduino.h"
+#include <map>
+#include <string>
+
+typedef std::map<std::string, std::map<std::string, std::string>> NativeNvs;
+
+inline NativeNvs& nativeNvs() {
+    static NativeNvs nvs;
+    return nvs;
+}
+inline void nativePreferencesErase() { nativeNvs().clear(); }
+
+class Preferences {
+public:
+    Preferences() : _ns(nullptr), _readOnly(true) {}
+    ~Preferences() { end(); }
+
+    bool begin(const char* name, bool readOnly = false, const char* /*partitionLabel*/ = nullptr) {
+        if (_ns) return false;
+        NativeNvs::iterator it = nativeNvs().find(name);
+        if (it == nativeNvs().end()) {
+            if (readOnly) return false;
+            it = nativeNvs().insert(std::make_pair(std::string(name), std::map<std::string, std::string>())).first;
+        }
+        _ns = &it->second;
+        _readOnly = readOnly;
+        return true;
+    }
+    void end() { _ns = nullptr; }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        if (!_ns || _readOnly) return 0;
+        (*_ns)[key].assign(static_cast<const char*>(value), len);
+        return len;
+    }
+    size_t getBytesLength(const char* key) {
+        if (!_ns) return 0;
+        std::map<std::string, std::string>::iterator it = _ns->find(key);
+        return it == _ns->end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        size_t len = getBytesLength(key);
+        if (len == 0 || len > maxLen) return 0;
+        memcpy(buf, (*_ns)[key].data(), len);
+        return len;
+    }
+    size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value)); }
+    String getString(const char* key, const String& defaultValue = String()) {
+        if (!_ns) return defaultValue;
+        std::map<std::string, std::string>::iterator it = _ns->find(key);
+        return it == _ns->end() ? defaultValue : String(it->second);
+    }
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) {
+        int32_t value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+    bool remove(const char* key) { return _ns && !_readOnly && _ns->erase(key) > 0; }
+    bool clear() {
+        if (!_ns || _readOnly) return false;
+        _ns->clear();
+        return true;
+    }
+
+private:
+    std::map<std::string, std::string>* _ns;
+    bool _readOnly;
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,80 @@
+/**
+ * @file PubSubClient.h
+ * @brief Host stand-in for the PubSubClient API `MqttManager` uses. No broker runs on the host.
+ *
+ * Configuration calls are recorded; `connect()` opens the bound socket to the configured server and then fails as
+ * a broker that never answers CONNECT would (`MQTT_CONNECTION_TIMEOUT`), so the session is never up. Push is only
+ * enabled natively when a test configures a broker host.
+ */
+#ifndef NATIVE_PUBSUBCLIENT_H
+#define NATIVE_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <functional>
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+class PubSubClient {
+public:
+    typedef std::function<void(char*, uint8_t*, unsigned int)> Callback;
+
+    bool setBufferSize(uint16_t size) {
+        bufferSize = size;
+        return size > 0;
+    }
+    PubSubClient& setServer(const char* domain, uint16_t port) {
+        _domain = domain;
+        _port = port;
+        return *this;
+    }
+    PubSubClient& setKeepAlive(uint16_t seconds) {
+        keepAliveS = seconds;
+        return *this;
+    }
+    PubSubClient& setSocketTimeout(uint16_t seconds) {
+        socketTimeoutS = seconds;
+        return *this;
+    }
+    PubSubClient& setCallback(Callback callback) {
+        _callback = callback;
+        return *this;
+    }
+    PubSubClient& setClient(Client& client) {
+        _client = &client;
+        return *this;
+    }
+
+    bool connect(const char* /*id*/, const char* /*user*/, const char* /*pass*/, const char* /*willTopic*/,
+                 uint8_t /*willQos*/, bool /*willRetain*/, const char* /*willMessage*/, bool /*cleanSession*/) {
+        if (!_client || !_domain || _client->connect(_domain, _port) != 1) {
+            _state = MQTT_CONNECT_FAILED;
+            return false;
+        }
+        _client->stop();
+        _state = MQTT_CONNECTION_TIMEOUT;
+        return false;
+    }
+    bool subscribe(const char* /*topic*/, uint8_t /*qos*/) { return false; }
+    bool publish(const char* /*topic*/, const char* /*payload*/, bool /*retained*/) { return false; }
+    bool loop() { return false; }
+    bool connected() { return false; }
+    int state() { return _state; }
+    void disconnect() { _state = MQTT_DISCONNECTED; }
+
+    uint16_t bufferSize = 0;     ///< From `setBufferSize()`.
+    uint16_t keepAliveS = 15;    ///< From `setKeepAlive()`.
+    uint16_t socketTimeoutS = 15; ///< From `setSocketTimeout()`.
+
+private:
+    Client* _client = nullptr;
+    const char* _domain = nullptr;
+    uint16_t _port = 0;
+    Callback _callback;
+    int _state = MQTT_DISCONNECTED;
+};
+
+#endif // NATIVE_PUBSUBCLIENT_H
@@ -0,0 +1,104 @@
+/**
+ * @file RTClib.h
+ * @brief Host stand-in for RTClib: `DateTime` calendar conversion and an emulated DS3231.
+ *
+ * The DS3231 keeps time on the virtual clock at a configurable rate error. Writing it restarts the current
+ * second, as the chip does, and each read costs `readCostUs` of virtual time (an I2C read at 100 kHz), so code
+ * that polls it for a seconds edge sees time pass. One chip per test program, reached through `nativeDs3231()`.
+ */
+#ifndef NATIVE_RTCLIB_H
+#define NATIVE_RTCLIB_H
+
+#include "Arduino.h"
+
+/**
+ * @brief Seconds since 1970 split into calendar fields (proleptic Gregorian, no time zone).
+ */
+class DateTime {
+public:
+    DateTime(uint32_t t = 0) : _t(t) {
+        int64_t days = t / 86400;
+        uint32_t rem = t % 86400;
+        _hh = rem / 3600;
+        _mm = (rem % 3600) / 60;
+        _ss = rem % 60;
+        // Days to civil date (H. Hinnant's algorithm).
+        days += 719468;
+        int64_t era = days / 146097;
+        uint32_t doe = (uint32_t)(days - era * 146097);
+        uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        uint32_t mp = (5 * doy + 2) / 153;
+        _d = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+        _m = (uint8_t)(mp < 10 ? mp + 3 : mp - 9);
+        _y = (uint16_t)(yoe + era * 400 + (_m <= 2 ? 1 : 0));
+    }
+    uint32_t unixtime() const { return _t; }
+    uint16_t year() const { return _y; }
+    uint8_t month() const { return _m; }
+    uint8_t day() const { return _d; }
+    uint8_t hour() const { return _hh; }
+    uint8_t minute() const { return _mm; }
+    uint8_t second() const { return _ss; }
+
+private:
+    uint32_t _t;
+    uint16_t _y;
+    uint8_t _m, _d, _hh, _mm, _ss;
+};
+
+/**
+ * @brief The emulated chip.
+ */
+struct NativeDs3231 {
+    bool present = true;       ///< `begin()` succeeds.
+    bool lostPower = false;    ///< `lostPower()` result.
+    double ppm = 0.0;          ///< Rate error against the virtual clock; positive runs fast.
+    uint32_t setEpoch = 1760000000UL; ///< Second written last...
+    int64_t setAtUs = 0;       ///< ...and the virtual time it was written.
+    int64_t readCostUs = 800;  ///< Virtual time one read takes.
+    uint32_t reads = 0;        ///< Reads since the last `resetCounters()`.
+    uint32_t writes = 0;       ///< Writes since the last `resetCounters()`.
+
+    /**
+     * @brief Sets the time without counting a write, as if it had been set before the test.
+     */
+    void set(uint32_t epoch) {
+        setEpoch = epoch;
+        setAtUs = nativeNowUs();
+    }
+    /**
+     * @brief What the chip's counters hold now, in microseconds since 1970.
+     */
+    int64_t nowUs() const {
+        double elapsed = (double)(nativeNowUs() - setAtUs) * (1.0 + ppm * 1e-6);
+        return (int64_t)setEpoch * 1000000LL + (int64_t)elapsed;
+    }
+    void resetCounters() { reads = writes = 0; }
+};
+
+inline NativeDs3231& nativeDs3231() {
+    static NativeDs3231 chip;
+    return chip;
+}
+
+class RTC_DS3231 {
+public:
+    bool begin() { return nativeDs3231().present; }
+    bool lostPower() { return nativeDs3231().lostPower; }
+    DateTime now() {
+        NativeDs3231& chip = nativeDs3231();
+        chip.reads++;
+        nativeAdvanceUs(chip.readCostUs);
+        return DateTime((uint32_t)(chip.nowUs() / 1000000LL));
+    }
+    void adjust(const DateTime& dt) {
+        NativeDs3231& chip = nativeDs3231();
+        chip.writes++;
+        chip.setEpoch = dt.unixtime();
+        chip.setAtUs = nativeNowUs();
+        chip.lostPower = false;
+    }
+};
+
+#endif // NATIVE_RTCLIB_H
@@ -0,0 +1,36 @@
+/**
+ * @file SD.h
+ * @brief Host stand-in for the ESP32 SD library: mounts the emulated card of `FS.h`.
+ */
+#ifndef NATIVE_SD_H
+#define NATIVE_SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN } sdcard_type_t;
+
+class SDFS : public fs::FS {
+public:
+    bool begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency) {
+        (void)ssPin;
+        (void)spi;
+        (void)frequency;
+        _mounted = nativeSd().present;
+        return _mounted;
+    }
+    void end() { _mounted = false; }
+    sdcard_type_t cardType() const { return _mounted ? CARD_SDHC : CARD_NONE; }
+    uint64_t cardSize() const { return 8ULL << 30; }
+
+private:
+    bool _mounted = false;
+};
+
+inline SDFS& nativeSdFs() {
+    static SDFS sd;
+    return sd;
+}
+#define SD (nativeSdFs())
+
+#endif // NATIVE_SD_H
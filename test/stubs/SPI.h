@@ -0,0 +1,27 @@
+/**
+ * @file SPI.h
+ * @brief Host stand-in: SPI devices are emulated by their library stand-ins, so `SPI` does nothing.
+ */
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+#include "Arduino.h"
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+        (void)sck;
+        (void)miso;
+        (void)mosi;
+        (void)ss;
+    }
+    void end() {}
+};
+
+inline SPIClass& nativeSpi() {
+    static SPIClass spi;
+    return spi;
+}
+#define SPI (nativeSpi())
+
+#endif // NATIVE_SPI_H
@@ -0,0 +1,127 @@
+/**
+ * @file TinyGsmClient.h
+ * @brief Host stand-in for TinyGSM's SIM800 modem (`TinyGsm`) and socket (`TinyGsmClient`).
+ *
+ * `TinyGsm` speaks AT over the `Stream` it is constructed on, as the library does: `sendAT()` writes
+ * "AT<args>\r\n" and `waitResponse()` reads until a final token or the timeout (virtual time). In the firmware
+ * that stream is the `AtCommandEngine`; on the host the engine's UART is a `NativeModem`. Only the calls the
+ * firmware makes are provided.
+ *
+ * `TinyGsmClient` does not tunnel its bytes through `AT+CIPSEND`/`AT+CIPRXGET`: it is a `NativeSocket` to the
+ * loopback server of NativeHttpServer.h, on the mux channel given to `init()`. The HTTP handling above it is
+ * what is under test, not the modem's socket commands.
+ */
+#ifndef NATIVE_TINY_GSM_CLIENT_H
+#define NATIVE_TINY_GSM_CLIENT_H
+
+#include <Arduino.h>
+#include "TinyGsmCommon.h"
+#include "NativeHttpServer.h"
+
+#if !defined(TINY_GSM_MODEM_SIM800)
+#error "The native TinyGSM stand-in only models TINY_GSM_MODEM_SIM800."
+#endif
+
+#define TINY_GSM_MUX_COUNT 5
+
+class TinyGsmSim800 {
+public:
+    explicit TinyGsmSim800(Stream& stream) : stream(stream) {}
+
+    /**
+     * @brief Sends "AT", then each argument, then CR/LF.
+     */
+    template <typename... Args>
+    void sendAT(Args... cmd) {
+        stream.print("AT");
+        streamWrite(cmd...);
+        stream.print(GSM_NL);
+        stream.flush();
+    }
+
+    /**
+     * @brief Reads until one of the tokens ends the received data.
+     * @return 1-based index of the token matched, or 0 on timeout.
+     */
+    int8_t waitResponse(uint32_t timeoutMs, String& data, const char* r1 = GSM_OK, const char* r2 = GSM_ERROR,
+                        const char* r3 = nullptr) {
+        std::string received;
+        const char* tokens[3] = {r1, r2, r3};
+        unsigned long start = millis();
+        do {
+            while (stream.available() > 0) {
+                int c = stream.read();
+                if (c < 0) break;
+                received += (char)c;
+                for (int8_t i = 0; i < 3; ++i) {
+                    size_t n = tokens[i] ? strlen(tokens[i]) : 0;
+                    if (n && received.size() >= n && received.compare(received.size() - n, n, tokens[i]) == 0) {
+                        data = String(received.substr(0, received.size() - n));
+                        return i + 1;
+                    }
+                }
+            }
+            delay(1);
+        } while (millis() - start < timeoutMs);
+        data = String(received);
+        return 0;
+    }
+    int8_t waitResponse(uint32_t timeoutMs, const char* r1 = GSM_OK, const char* r2 = GSM_ERROR,
+                        const char* r3 = nullptr) {
+        String data;
+        return waitResponse(timeoutMs, data, r1, r2, r3);
+    }
+    int8_t waitResponse() { return waitResponse(1000UL); }
+
+    bool testAT(uint32_t timeoutMs = 10000UL) {
+        for (unsigned long start = millis(); millis() - start < timeoutMs;) {
+            sendAT("");
+            if (waitResponse(200) == 1) return true;
+            delay(100);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Closes the IP task and detaches, as the library's SIM800 `gprsDisconnect()` does.
+     */
+    bool gprsDisconnect() {
+        sendAT("+CIPSHUT");
+        if (waitResponse(60000UL, "SHUT OK") != 1) return false;
+        sendAT("+CGATT=0");
+        return waitResponse(60000UL) == 1;
+    }
+
+    /**
+     * @brief Socket on one modem mux channel.
+     */
+    class GsmClientSim800 : public NativeSocket {
+    public:
+        GsmClientSim800() : _modem(nullptr), _mux(0) {}
+        bool init(TinyGsmSim800* modem, uint8_t mux = 0) {
+            _modem = modem;
+            _mux = mux;
+            return mux < TINY_GSM_MUX_COUNT;
+        }
+        uint8_t mux() const { return _mux; }
+
+    private:
+        TinyGsmSim800* _modem;
+        uint8_t _mux;
+    };
+
+    Stream& stream;
+
+private:
+    void streamWrite() {}
+    template <typename T, typename... Args>
+    void streamWrite(T head, Args... tail) {
+        stream.print(head);
+        streamWrite(tail...);
+    }
+};
+
+typedef TinyGsmSim800 TinyGsm;
+typedef TinyGsmSim800::GsmClientSim800 TinyGsmClient;
+
+#endif // NATIVE_TINY_GSM_CLIENT_H
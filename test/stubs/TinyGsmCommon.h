@@ -0,0 +1,17 @@
+/**
+ * @file TinyGsmCommon.h
+ * @brief Host stand-in for the common TinyGSM definitions (see TinyGsmClient.h for the modem and socket).
+ */
+#ifndef NATIVE_TINY_GSM_COMMON_H
+#define NATIVE_TINY_GSM_COMMON_H
+
+#include <Arduino.h>
+
+#define TINY_GSM_VERSION "0.12.0-native"
+#define GSM_NL "\r\n"
+#define GSM_OK "OK" GSM_NL
+#define GSM_ERROR "ERROR" GSM_NL
+#define GF(x) x
+#define GFP(x) x
+
+#endif // NATIVE_TINY_GSM_COMMON_H
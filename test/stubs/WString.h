@@ -0,0 +1,52 @@
+/**
+ * @file WString.h
+ * @brief Host stand-in for the Arduino `String`, limited to what the natively built modules call on the values
+ *        `HTTPClient` returns (`header()`, `errorToString()`).
+ *
+ * Included by the native `Arduino.h`, as the core's is. Backed by `std::string`; heap use does not matter off-target.
+ */
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <ctype.h>
+#include <string.h>
+#include <string>
+
+class String {
+public:
+    String(const char* s = "") : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return (unsigned int)_s.size(); }
+    bool isEmpty() const { return _s.empty(); }
+    void toLowerCase() {
+        for (size_t i = 0; i < _s.size(); ++i) _s[i] = (char)tolower((unsigned char)_s[i]);
+    }
+    int indexOf(char c) const {
+        size_t i = _s.find(c);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    int indexOf(const char* s) const {
+        size_t i = _s.find(s);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    bool equalsIgnoreCase(const char* s) const {
+        size_t n = strlen(s);
+        if (n != _s.size()) return false;
+        for (size_t i = 0; i < n; ++i) {
+            if (tolower((unsigned char)_s[i]) != tolower((unsigned char)s[i])) return false;
+        }
+        return true;
+    }
+    String& operator+=(const char* s) { _s += s; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    bool operator==(const char* s) const { return _s == s; }
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator!=(const char* s) const { return _s != s; }
+
+private:
+    std::string _s;
+};
+
+#endif // NATIVE_WSTRING_H
@@ -0,0 +1,251 @@
+/**
+ * @file WiFi.h
+ * @brief Host stand-in for the ESP32 `WiFi` station API and `WiFiClient`.
+ *
+ * `WiFi` emulates one access point (`nativeSetAccessPoint()`). `begin()` succeeds if the SSID and password
+ * match and, on a fast reconnect, the given channel and BSSID are the AP's; the outcome (`STA_GOT_IP`, or
+ * `STA_DISCONNECTED` with `NO_AP_FOUND`/`AUTH_FAIL`) is delivered `nativeConnectDelayMs` of virtual time later,
+ * on the first `WiFi` call after that. Event handlers run on the calling thread instead of the event task.
+ * `WiFiClient` connects to the loopback server of NativeHttpServer.h.
+ */
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <functional>
+#include <vector>
+#include "NativeHttpServer.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_STA_START = 2,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+    ARDUINO_EVENT_MAX = 39
+} arduino_event_id_t;
+
+enum {
+    WIFI_REASON_ASSOC_LEAVE = 8,
+    WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+    WIFI_REASON_BEACON_TIMEOUT = 200,
+    WIFI_REASON_NO_AP_FOUND = 201,
+    WIFI_REASON_AUTH_FAIL = 202,
+    WIFI_REASON_HANDSHAKE_TIMEOUT = 204
+};
+
+typedef struct {
+    uint8_t reason;
+} wifi_event_sta_disconnected_t;
+
+typedef union {
+    wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef size_t wifi_event_id_t;
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+
+/**
+ * @brief TCP socket to the loopback server.
+ */
+class WiFiClient : public NativeSocket {};
+
+/**
+ * @brief Station emulation; see the file comment.
+ */
+class WiFiClass {
+public:
+    WiFiClass() { nativeReset(); }
+
+    // --- Station API used by WiFiManager ---
+
+    wl_status_t status() {
+        nativePoll();
+        return _status;
+    }
+    wl_status_t begin(const char* ssid, const char* password, int32_t channel = 0, const uint8_t* bssid = nullptr) {
+        nativePoll();
+        beginCalls++;
+        lastBeginChannel = channel;
+        _status = WL_DISCONNECTED;
+        _outcomeAtMs = millis() + nativeConnectDelayMs;
+        _outcomePending = true;
+        if (_apSsid != ssid || (channel != 0 && channel != _apChannel) || (bssid && memcmp(bssid, _apBssid, 6) != 0)) {
+            _outcomeReason = WIFI_REASON_NO_AP_FOUND;
+        } else if (_apPassword != password) {
+            _outcomeReason = WIFI_REASON_AUTH_FAIL;
+        } else {
+            _outcomeReason = 0;
+        }
+        return _status;
+    }
+    bool disconnect(bool wifiOff = false) {
+        (void)wifiOff;
+        _outcomePending = false;
+        if (_status == WL_CONNECTED) nativeDropLink(WIFI_REASON_ASSOC_LEAVE);
+        _status = WL_DISCONNECTED;
+        return true;
+    }
+    bool mode(wifi_mode_t m) {
+        _mode = m;
+        return true;
+    }
+    bool setAutoReconnect(bool on) {
+        autoReconnect = on;
+        return true;
+    }
+    void persistent(bool on) { persistentCalls += on ? 1 : 0; }
+    bool config(IPAddress localIp, IPAddress gateway, IPAddress subnet, IPAddress dns1 = (uint32_t)0,
+                IPAddress dns2 = (uint32_t)0) {
+        (void)dns2;
+        configCalls++;
+        _staticIp = localIp;
+        _staticGateway = gateway;
+        _staticSubnet = subnet;
+        _staticDns = dns1;
+        return true;
+    }
+    wifi_event_id_t onEvent(WiFiEventFuncCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX) {
+        Handler h;
+        h.id = ++_lastHandlerId;
+        h.event = event;
+        h.cb = cb;
+        _handlers.push_back(h);
+        return h.id;
+    }
+    void removeEvent(wifi_event_id_t id) {
+        for (size_t i = 0; i < _handlers.size(); ++i) {
+            if (_handlers[i].id == id) {
+                _handlers.erase(_handlers.begin() + i);
+                return;
+            }
+        }
+    }
+    IPAddress localIP() { return _status != WL_CONNECTED ? IPAddress() : ((uint32_t)_staticIp ? _staticIp : nativeLease.ip); }
+    IPAddress gatewayIP() { return _status != WL_CONNECTED ? IPAddress() : ((uint32_t)_staticIp ? _staticGateway : nativeLease.gateway); }
+    IPAddress subnetMask() { return _status != WL_CONNECTED ? IPAddress() : ((uint32_t)_staticIp ? _staticSubnet : nativeLease.subnet); }
+    IPAddress dnsIP(uint8_t = 0) { return _status != WL_CONNECTED ? IPAddress() : ((uint32_t)_staticIp ? _staticDns : nativeLease.dns); }
+    uint8_t* BSSID() { return _status == WL_CONNECTED ? _apBssid : nullptr; }
+    int32_t channel() { return _status == WL_CONNECTED ? _apChannel : 0; }
+
+    // --- Emulation controls ---
+
+    /**
+     * @brief Address configuration handed out by DHCP.
+     */
+    struct Lease {
+        IPAddress ip, gateway, subnet, dns;
+    };
+
+    /**
+     * @brief Back to no access point, no handlers' state, and default timings and counters.
+     */
+    void nativeReset() {
+        _status = WL_IDLE_STATUS;
+        _mode = WIFI_OFF;
+        _outcomePending = false;
+        _outcomeReason = 0;
+        _outcomeAtMs = 0;
+        _apSsid.clear();
+        _apPassword.clear();
+        _apChannel = 0;
+        memset(_apBssid, 0, sizeof(_apBssid));
+        _staticIp = _staticGateway = _staticSubnet = _staticDns = IPAddress();
+        nativeConnectDelayMs = 50;
+        nativeLease.ip = IPAddress(192, 168, 1, 50);
+        nativeLease.gateway = IPAddress(192, 168, 1, 1);
+        nativeLease.subnet = IPAddress(255, 255, 255, 0);
+        nativeLease.dns = IPAddress(192, 168, 1, 1);
+        beginCalls = 0;
+        lastBeginChannel = -1;
+        configCalls = 0;
+        persistentCalls = 0;
+        autoReconnect = true;
+    }
+    /**
+     * @brief Sets the one reachable access point.
+     */
+    void nativeSetAccessPoint(const char* ssid, const char* password, int32_t channel, const uint8_t bssid[6]) {
+        _apSsid = ssid;
+        _apPassword = password;
+        _apChannel = channel;
+        memcpy(_apBssid, bssid, 6);
+    }
+    /**
+     * @brief Drops the association, as a beacon loss or deauth does.
+     */
+    void nativeDropLink(uint8_t reason) {
+        _status = WL_DISCONNECTED;
+        arduino_event_info_t info;
+        info.wifi_sta_disconnected.reason = reason;
+        dispatch(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, info);
+    }
+    /**
+     * @brief Delivers the outcome of `begin()` once its delay has passed; every `WiFi` call does this first.
+     */
+    void nativePoll() {
+        if (!_outcomePending || (long)(millis() - _outcomeAtMs) < 0) return;
+        _outcomePending = false;
+        arduino_event_info_t info;
+        if (_outcomeReason == 0) {
+            _status = WL_CONNECTED;
+            info.wifi_sta_disconnected.reason = 0;
+            dispatch(ARDUINO_EVENT_WIFI_STA_GOT_IP, info);
+        } else {
+            nativeDropLink(_outcomeReason);
+        }
+    }
+
+    unsigned long nativeConnectDelayMs; ///< Virtual time from `begin()` to its outcome.
+    Lease nativeLease;                  ///< Address configuration handed out by DHCP.
+    uint32_t beginCalls;                ///< `begin()` calls.
+    int32_t lastBeginChannel;           ///< Channel of the last `begin()` (0: scan), or -1.
+    uint32_t configCalls;               ///< `config()` calls.
+    uint32_t persistentCalls;           ///< `persistent(true)` calls.
+    bool autoReconnect;                 ///< Last `setAutoReconnect()` value.
+
+private:
+    struct Handler {
+        wifi_event_id_t id;
+        arduino_event_id_t event;
+        WiFiEventFuncCb cb;
+    };
+
+    void dispatch(arduino_event_id_t event, arduino_event_info_t info) {
+        std::vector<Handler> handlers(_handlers); // A handler may remove itself.
+        for (size_t i = 0; i < handlers.size(); ++i) {
+            if (handlers[i].event == ARDUINO_EVENT_MAX || handlers[i].event == event) handlers[i].cb(event, info);
+        }
+    }
+
+    wl_status_t _status;
+    wifi_mode_t _mode;
+    bool _outcomePending;
+    uint8_t _outcomeReason; ///< 0: `GOT_IP`; otherwise the disconnect reason.
+    unsigned long _outcomeAtMs;
+    std::string _apSsid, _apPassword;
+    int32_t _apChannel;
+    uint8_t _apBssid[6];
+    IPAddress _staticIp, _staticGateway, _staticSubnet, _staticDns;
+    std::vector<Handler> _handlers;
+    wifi_event_id_t _lastHandlerId = 0;
+};
+
+inline WiFiClass& nativeWiFi() {
+    static WiFiClass wifi;
+    return wifi;
+}
+#define WiFi (nativeWiFi())
+
+#endif // NATIVE_WIFI_H
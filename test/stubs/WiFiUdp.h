@@ -0,0 +1,29 @@
+/**
+ * @file WiFiUdp.h
+ * @brief Host stand-in for the core's `WiFiUDP`: datagrams are sent and counted, and nothing ever answers.
+ *
+ * Tests that need an SNTP server script their own `UDP` (see `test_sntp_client`); this one only lets code that owns
+ * a `WiFiUDP` (e.g. `NetworkWorker`) build and run, with its time rounds timing out.
+ */
+#ifndef NATIVE_WIFI_UDP_H
+#define NATIVE_WIFI_UDP_H
+
+#include "Udp.h"
+
+class WiFiUDP : public UDP {
+public:
+    uint8_t begin(uint16_t /*port*/) override { return 1; }
+    void stop() override {}
+    int beginPacket(IPAddress /*ip*/, uint16_t /*port*/) override { return 1; }
+    int endPacket() override {
+        sent++;
+        return 1;
+    }
+    size_t write(const uint8_t* /*buffer*/, size_t size) override { return size; }
+    int parsePacket() override { return 0; }
+    int read(unsigned char* /*buffer*/, size_t /*len*/) override { return 0; }
+
+    uint32_t sent = 0; ///< Datagrams sent.
+};
+
+#endif // NATIVE_WIFI_UDP_H
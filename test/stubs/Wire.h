@@ -0,0 +1,25 @@
+/**
+ * @file Wire.h
+ * @brief Host stand-in: I2C devices are emulated by their library stand-ins, so `Wire` does nothing.
+ */
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1) {
+        (void)sda;
+        (void)scl;
+        return true;
+    }
+};
+
+inline TwoWire& nativeWire() {
+    static TwoWire wire;
+    return wire;
+}
+#define Wire (nativeWire())
+
+#endif // NATIVE_WIRE_H
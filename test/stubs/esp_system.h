@@ -0,0 +1,23 @@
+/**
+ * @file esp_system.h
+ * @brief Host stand-in: `esp_random()` is a fixed-seed generator, so test runs repeat exactly.
+ */
+#ifndef NATIVE_ESP_SYSTEM_H
+#define NATIVE_ESP_SYSTEM_H
+
+#include <stdint.h>
+
+inline uint32_t& nativeRandomState() {
+    static uint32_t state = 0x12345678u;
+    return state;
+}
+
+inline uint32_t esp_random() {
+    uint32_t& x = nativeRandomState(); // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+#endif // NATIVE_ESP_SYSTEM_H
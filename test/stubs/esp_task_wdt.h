@@ -0,0 +1,11 @@
+/**
+ * @file esp_task_wdt.h
+ * @brief Host stand-in: there is no task watchdog off-target.
+ */
+#ifndef NATIVE_ESP_TASK_WDT_H
+#define NATIVE_ESP_TASK_WDT_H
+
+inline int esp_task_wdt_add(void* /*task*/) { return 0; }
+inline int esp_task_wdt_reset() { return 0; }
+
+#endif // NATIVE_ESP_TASK_WDT_H
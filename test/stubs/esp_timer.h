@@ -0,0 +1,24 @@
+/**
+ * @file esp_timer.h
+ * @brief Host stand-in: `esp_timer_get_time()` reads the virtual clock of the native `Arduino.h`.
+ *
+ * Code that busy-waits on the timer (e.g. spinning onto a second edge) would never see it move, so a test can
+ * make every read advance the clock by `nativeTimerReadCostUs()` microseconds. It is 0 (reads are free) unless
+ * a test sets it.
+ */
+#ifndef NATIVE_ESP_TIMER_H
+#define NATIVE_ESP_TIMER_H
+
+#include "Arduino.h"
+
+inline int64_t& nativeTimerReadCostUs() {
+    static int64_t cost = 0;
+    return cost;
+}
+
+inline int64_t esp_timer_get_time() {
+    nativeAdvanceUs(nativeTimerReadCostUs());
+    return nativeNowUs();
+}
+
+#endif // NATIVE_ESP_TIMER_H
@@ -0,0 +1,227 @@
+/**
+ * @file task.h
+ * @brief Host stand-in for FreeRTOS tasks and task notifications, on the virtual clock.
+ *
+ * Until a test creates a task, every caller is the one task returned by `xTaskGetCurrentTaskHandle()`: a
+ * notification only increments the target's count, and `ulTaskNotifyTake()` with no count pending times out at
+ * once and advances the virtual clock by its timeout, as if the task had slept through it.
+ *
+ * `xTaskCreatePinnedToCore()` runs the task function on a `std::thread`, scheduled cooperatively with the test's
+ * own thread (the calling task): exactly one task runs at a time, and a task only gives up the CPU where it would
+ * block on the target, in `ulTaskNotifyTake()` or in `delay()` and any other advance of the virtual clock. The
+ * clock never moves while a task runs; when every task is blocked it jumps to the earliest wake-up. So a task that
+ * blocks for seconds (an HTTP read timeout, WiFi retry delays) costs the others no time, and where each one wakes
+ * is exact and repeatable. Notifying a task makes it ready but does not switch to it. `nativeTasksShutdown()` ends
+ * the created tasks at their next blocking point and returns to the single-task mode; call it in `tearDown()`.
+ */
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include <Arduino.h> // For the virtual clock.
+#include "FreeRTOS.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef void (*TaskFunction_t)(void*);
+
+/**
+ * @brief A task: its notification count and, once tasks run on threads, its scheduling state.
+ */
+struct NativeTask {
+    enum State { READY, RUNNING, BLOCKED, DONE };
+
+    uint32_t notifications = 0;
+    State state = RUNNING;
+    bool waitingForNotify = false; ///< Blocked in `ulTaskNotifyTake()`: a notification makes it ready.
+    int64_t wakeAtUs = -1;         ///< Virtual time it becomes ready while blocked, or -1 for never.
+    bool exitRequested = false;    ///< Set by `nativeTasksShutdown()`.
+    std::thread thread;            ///< Empty for the test's own task.
+    std::condition_variable turn;  ///< Signalled when the task is given the CPU.
+};
+typedef NativeTask* TaskHandle_t;
+
+/**
+ * @brief Thrown from a created task's blocking point to unwind it when the test shuts the tasks down.
+ */
+struct NativeTaskExit {};
+
+/**
+ * @brief Tasks created so far (the test's own task first) and the one that holds the CPU.
+ */
+struct NativeScheduler {
+    std::mutex lock;
+    std::vector<NativeTask*> tasks; ///< Empty until the first `xTaskCreatePinnedToCore()`.
+    NativeTask* running = nullptr;
+};
+
+inline NativeScheduler& nativeScheduler() {
+    static NativeScheduler scheduler;
+    return scheduler;
+}
+
+inline NativeTask*& nativeThreadTask() {
+    static thread_local NativeTask* task = nullptr;
+    return task;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    static NativeTask main;
+    NativeTask* task = nativeThreadTask();
+    return task ? task : &main;
+}
+
+/**
+ * @brief Hands the CPU to the next ready task after `self`, round robin, and returns once `self` holds it again.
+ *
+ * Tasks whose wake-up time has come become ready first. If none is ready the clock jumps to the earliest wake-up;
+ * if no task will ever wake, the tasks deadlocked and the run aborts. A `self` that is `DONE` does not wait.
+ */
+inline void nativeTaskSwitch(std::unique_lock<std::mutex>& lk, NativeTask* self) {
+    NativeScheduler& s = nativeScheduler();
+    NativeTask* next = nullptr;
+    while (!next) {
+        int64_t earliest = -1;
+        for (NativeTask* t : s.tasks) {
+            if (t->state != NativeTask::BLOCKED || t->wakeAtUs < 0) continue;
+            if (t->wakeAtUs <= nativeNowUs()) t->state = NativeTask::READY;
+            else if (earliest < 0 || t->wakeAtUs < earliest) earliest = t->wakeAtUs;
+        }
+        size_t at = 0;
+        while (at < s.tasks.size() && s.tasks[at] != self) ++at;
+        for (size_t i = 1; i <= s.tasks.size() && !next; ++i) {
+            NativeTask* t = s.tasks[(at + i) % s.tasks.size()];
+            if (t->state == NativeTask::READY) next = t;
+        }
+        if (next) break;
+        if (earliest < 0) {
+            fprintf(stderr, "native tasks: deadlock, every task waits for a notification that never comes\n");
+            abort();
+        }
+        nativeNowUs() = earliest;
+    }
+    next->state = NativeTask::RUNNING;
+    next->wakeAtUs = -1;
+    s.running = next;
+    if (next != self) next->turn.notify_one();
+    if (self->state == NativeTask::DONE) return;
+    while (s.running != self) self->turn.wait(lk);
+    if (self->exitRequested) throw NativeTaskExit();
+}
+
+/**
+ * @brief Blocks the calling task until `wakeAtUs` (or never, if -1) or, if `onNotify`, until it is notified.
+ */
+inline void nativeTaskBlock(std::unique_lock<std::mutex>& lk, int64_t wakeAtUs, bool onNotify) {
+    NativeTask* self = xTaskGetCurrentTaskHandle();
+    self->state = NativeTask::BLOCKED;
+    self->wakeAtUs = wakeAtUs;
+    self->waitingForNotify = onNotify;
+    nativeTaskSwitch(lk, self);
+    self->waitingForNotify = false;
+}
+
+/**
+ * @brief `nativeAdvanceUs()` while tasks run: the caller sleeps for `us` of virtual time and others run meanwhile.
+ */
+inline void nativeTaskSleep(int64_t us) {
+    std::unique_lock<std::mutex> lk(nativeScheduler().lock);
+    nativeTaskBlock(lk, nativeNowUs() + (us > 0 ? us : 0), false);
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* /*name*/, uint32_t /*stackDepth*/,
+                                          void* arg, UBaseType_t /*priority*/, TaskHandle_t* created,
+                                          BaseType_t /*coreId*/) {
+    NativeScheduler& s = nativeScheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    if (s.tasks.empty()) {
+        NativeTask* self = xTaskGetCurrentTaskHandle();
+        self->state = NativeTask::RUNNING;
+        s.tasks.push_back(self);
+        s.running = self;
+        nativeSleepHook() = nativeTaskSleep;
+    }
+    NativeTask* task = new NativeTask();
+    task->state = NativeTask::READY;
+    s.tasks.push_back(task);
+    task->thread = std::thread([task, fn, arg]() {
+        nativeThreadTask() = task;
+        {
+            std::unique_lock<std::mutex> lk(nativeScheduler().lock);
+            while (nativeScheduler().running != task) task->turn.wait(lk);
+        }
+        try {
+            if (!task->exitRequested) fn(arg);
+        } catch (const NativeTaskExit&) {
+        }
+        std::unique_lock<std::mutex> lk(nativeScheduler().lock);
+        task->state = NativeTask::DONE;
+        nativeTaskSwitch(lk, task);
+    });
+    if (created) *created = task;
+    return pdPASS;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    NativeScheduler& s = nativeScheduler();
+    std::unique_lock<std::mutex> lk(s.lock, std::defer_lock);
+    if (!s.tasks.empty()) lk.lock();
+    task->notifications++;
+    if (task->state == NativeTask::BLOCKED && task->waitingForNotify) task->state = NativeTask::READY;
+    return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    NativeScheduler& s = nativeScheduler();
+    NativeTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lk(s.lock, std::defer_lock);
+    if (!s.tasks.empty()) {
+        lk.lock();
+        if (task->notifications == 0 && ticksToWait != 0) {
+            nativeTaskBlock(lk, ticksToWait == portMAX_DELAY ? -1 : nativeNowUs() + (int64_t)ticksToWait * 1000, true);
+        }
+    } else if (task->notifications == 0 && ticksToWait != portMAX_DELAY) {
+        nativeAdvanceMs(ticksToWait);
+    }
+    uint32_t count = task->notifications;
+    if (count > 0) task->notifications = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+/**
+ * @brief Ends every created task at its next blocking point, joins its thread and returns to single-task mode.
+ * Call from the test's own task, e.g. in `tearDown()`. Does nothing if no task was created.
+ */
+inline void nativeTasksShutdown() {
+    NativeScheduler& s = nativeScheduler();
+    std::unique_lock<std::mutex> lk(s.lock);
+    if (s.tasks.empty()) return;
+    NativeTask* self = xTaskGetCurrentTaskHandle();
+    for (;;) {
+        bool alive = false;
+        for (NativeTask* t : s.tasks) {
+            if (t == self || t->state == NativeTask::DONE) continue;
+            alive = true;
+            t->exitRequested = true;
+            t->state = NativeTask::READY;
+        }
+        if (!alive) break;
+        self->state = NativeTask::READY;
+        nativeTaskSwitch(lk, self);
+    }
+    std::vector<NativeTask*> tasks;
+    tasks.swap(s.tasks);
+    s.running = nullptr;
+    nativeSleepHook() = nullptr;
+    lk.unlock();
+    for (NativeTask* t : tasks) {
+        if (t == self) continue;
+        t->thread.join();
+        delete t;
+    }
+    self->notifications = 0;
+    self->state = NativeTask::RUNNING;
+}
+
+#endif // NATIVE_FREERTOS_TASK_H
@@ -0,0 +1,24 @@
+/**
+ * @file dns.h
+ * @brief Host stand-in for lwIP's asynchronous resolver. A test installs `nativeDnsHook()` to answer from
+ *        "cache" (`ERR_OK`), defer the answer to the callback (`ERR_INPROGRESS`), or fail.
+ */
+#ifndef NATIVE_LWIP_DNS_H
+#define NATIVE_LWIP_DNS_H
+
+#include "lwip/ip_addr.h"
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+typedef err_t (*NativeDnsHook)(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+
+inline NativeDnsHook& nativeDnsHook() {
+    static NativeDnsHook hook = nullptr;
+    return hook;
+}
+
+inline err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg) {
+    return nativeDnsHook() ? nativeDnsHook()(hostname, addr, found, callback_arg) : (err_t)ERR_ARG;
+}
+
+#endif // NATIVE_LWIP_DNS_H
@@ -0,0 +1,31 @@
+/**
+ * @file ip_addr.h
+ * @brief Host stand-in for the lwIP address type and the accessors `SntpClient` uses.
+ */
+#ifndef NATIVE_LWIP_IP_ADDR_H
+#define NATIVE_LWIP_IP_ADDR_H
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+#define ERR_OK 0
+#define ERR_INPROGRESS -5
+#define ERR_ARG -16
+
+#define IPADDR_TYPE_V4 0
+#define IPADDR_TYPE_V6 6
+
+struct ip4_addr_t {
+    uint32_t addr; ///< Network byte order.
+};
+
+struct ip_addr_t {
+    ip4_addr_t ip4;
+    uint8_t type;
+};
+
+#define IP_IS_V4(ipaddr) ((ipaddr)->type == IPADDR_TYPE_V4)
+#define ip_2_ip4(ipaddr) (&(ipaddr)->ip4)
+#define ip4_addr_get_u32(src_ipaddr) ((src_ipaddr)->addr)
+
+#endif // NATIVE_LWIP_IP_ADDR_H
@@ -0,0 +1,18 @@
+/**
+ * @file tcpip_priv.h
+ * @brief Host stand-in: there is no TCP/IP task off-target, so `tcpip_api_call()` runs the function in place.
+ */
+#ifndef NATIVE_LWIP_TCPIP_PRIV_H
+#define NATIVE_LWIP_TCPIP_PRIV_H
+
+#include "lwip/ip_addr.h"
+
+struct tcpip_api_call_data {
+    int unused;
+};
+
+typedef err_t (*tcpip_api_call_fn)(struct tcpip_api_call_data* call);
+
+inline err_t tcpip_api_call(tcpip_api_call_fn fn, struct tcpip_api_call_data* call) { return fn(call); }
+
+#endif // NATIVE_LWIP_TCPIP_PRIV_H
@@ -0,0 +1,140 @@
+/**
+ * @file test_main.cpp
+ * @brief Replay benchmark of the per-API response filters: each recorded response is parsed the way the network
+ *        managers did before (unfiltered) and do now (`ApiResponseFilter`), counting the document's heap through
+ *        a counting ArduinoJson allocator and timing the parse on the host.
+ *
+ * Asserted, independent of the machine: the filtered parse never needs more heap than the unfiltered one, and the
+ * filtered document re-serialized for the control loop fits `NETWORK_WORKER_RESPONSE_MAX_LEN`. The timings are
+ * printed only. That the filters keep the callbacks' fields is checked by `test_api_response_filter`.
+ */
+#include <unity.h>
+#include <chrono>
+#include <cstddef>
+#include <stdlib.h>
+#include <string.h>
+#include "ApiResponseFilter.h"
+#include "config.h"
+
+typedef std::chrono::steady_clock Clock;
+
+void setUp() {}
+void tearDown() {}
+
+const int REPLAYS = 2000; ///< Parses per body and mode for the timing.
+
+/**
+ * @brief ArduinoJson allocator that tracks the live and peak bytes of one document.
+ */
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    size_t live = 0;
+    size_t peak = 0;
+    uint32_t calls = 0; ///< allocate() and reallocate() calls.
+
+    void* allocate(size_t size) override {
+        char* p = static_cast<char*>(malloc(size + HEADER));
+        if (!p) return nullptr;
+        *reinterpret_cast<size_t*>(p) = size;
+        grow(0, size);
+        return p + HEADER;
+    }
+    void deallocate(void* ptr) override {
+        if (!ptr) return;
+        char* p = static_cast<char*>(ptr) - HEADER;
+        live -= *reinterpret_cast<size_t*>(p);
+        free(p);
+    }
+    void* reallocate(void* ptr, size_t size) override {
+        if (!ptr) return allocate(size);
+        char* p = static_cast<char*>(ptr) - HEADER;
+        size_t old = *reinterpret_cast<size_t*>(p);
+        char* q = static_cast<char*>(realloc(p, size + HEADER));
+        if (!q) return nullptr;
+        *reinterpret_cast<size_t*>(q) = size;
+        grow(old, size);
+        return q + HEADER;
+    }
+    void reset() {
+        peak = live;
+        calls = 0;
+    }
+
+private:
+    static const size_t HEADER = alignof(std::max_align_t); ///< Size prefix, keeping the payload aligned.
+    void grow(size_t from, size_t to) {
+        live = live - from + to;
+        if (live > peak) peak = live;
+        calls++;
+    }
+};
+
+/**
+ * @brief One recorded response and the tag of the request that fetched it.
+ */
+struct Recording {
+    const char* apiType;
+    const char* body;
+};
+
+static const Recording RECORDINGS[] = {
+    {"TH_ASYNC_LP", R"({"status":"success","message":"Thresholds fetched","gh_id":4,"gh_name":"Greenhouse 4 - Tomatoes","count":6,"data":[
+{"id":11,"gh_id":4,"name":"temperature","threshold_min":"18.5","threshold_max":"29.0","unit":"C","description":"Air temperature at canopy height","created_at":"2025-03-02 10:11:12","updated_at":"2025-10-08 14:02:11","updated_by":"agronomist"},
+{"id":12,"gh_id":4,"name":"humidity","threshold_min":"45","threshold_max":"85","unit":"%","description":"Relative humidity at canopy height","created_at":"2025-03-02 10:11:12","updated_at":"2025-10-08 14:02:11","updated_by":"agronomist"},
+{"id":13,"gh_id":4,"name":"light_intensity","threshold_min":"200","threshold_max":"12000","unit":"lux","description":"Light at the top of the canopy","created_at":"2025-03-02 10:11:12","updated_at":"2025-10-01 09:00:00","updated_by":"admin"},
+{"id":14,"gh_id":4,"name":"soil_moisture","threshold_min":"25","threshold_max":"60","unit":"%","description":"Volumetric water content, bed 1","created_at":"2025-03-02 10:11:12","updated_at":"2025-09-21 17:45:03","updated_by":"admin"},
+{"id":15,"gh_id":4,"name":"co2","threshold_min":"400","threshold_max":"1200","unit":"ppm","description":"CO2 near the intake","created_at":"2025-04-14 08:00:00","updated_at":"2025-09-21 17:45:03","updated_by":"admin"},
+{"id":16,"gh_id":4,"name":"ph","threshold_min":"5.8","threshold_max":"6.5","unit":"","description":"Nutrient solution pH","created_at":"2025-04-14 08:00:00","updated_at":"2025-09-30 11:12:13","updated_by":"agronomist"}]})"},
+    {"ND_ASYNC_LP", R"({"status":"success","message":"Latest node data","data":{"id":9021144,"node_id":2,"node_name":"Bed 1 north","gh_id":4,"temperature":24.6,"humidity":61.2,"light_intensity":5400,"soil_moisture":33,"co2":612,"ph":6.1,"battery_voltage":3.91,"rssi":-71,"firmware":"node-1.4.2","recorded_at":"2025-10-09 08:50:00","received_at":"2025-10-09 08:50:02"}})"},
+    {"DEV_ST_G_LP_ASYNC", R"({"status":"success","message":"Device status","data":{"id":5531,"gh_id":4,"exhaust_status":"1","dehumidifier_status":"0","blower_status":"1","mode":"manual","changed_by":"admin","changed_from":"web","changed_at":"2025-10-09 08:41:07","expires_at":"2025-10-09 20:41:07","note":"Venting after spraying"}})"},
+    {"WT_ASYNC_LP", R"({"abbreviation":"+07","client_ip":"203.0.113.7","datetime":"2025-10-09T15:53:20.123456+07:00","day_of_week":4,"day_of_year":282,"dst":false,"dst_from":null,"dst_offset":0,"dst_until":null,"raw_offset":25200,"timezone":"Asia/Jakarta","unixtime":1760000000,"utc_datetime":"2025-10-09T08:53:20.123456+00:00","utc_offset":"+07:00","week_number":41})"},
+    {"TLM_BATCH_P", R"({"status":"stored","received":48,"duplicates":0,"acked_seq":1200448,"server_time":1760000000,"message":"Batch stored"})"},
+};
+
+/**
+ * @brief Parses `body` `REPLAYS` times into a document on `alloc`.
+ * @return Host nanoseconds per parse.
+ */
+static double timeParses(const char* body, const JsonDocument* filter, CountingAllocator& alloc) {
+    JsonDocument doc(&alloc);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < REPLAYS; ++i) {
+        doc.clear();
+        DeserializationError err = filter ? deserializeJson(doc, body, DeserializationOption::Filter(*filter))
+                                          : deserializeJson(doc, body);
+        TEST_ASSERT_FALSE(err);
+    }
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count() / REPLAYS;
+}
+
+void test_filtered_replay_needs_less_heap_and_fits_the_event_body() {
+    for (const Recording& r : RECORDINGS) {
+        const JsonDocument* filter = getApiResponseFilter(classifyApiResponse(r.apiType));
+        TEST_ASSERT_NOT_NULL(filter);
+
+        CountingAllocator fullAlloc, keptAlloc;
+        JsonDocument full(&fullAlloc), kept(&keptAlloc);
+        TEST_ASSERT_FALSE(deserializeJson(full, r.body));
+        TEST_ASSERT_FALSE(deserializeJson(kept, r.body, DeserializationOption::Filter(*filter)));
+        TEST_ASSERT_TRUE(keptAlloc.peak <= fullAlloc.peak);
+
+        size_t fullLen = measureJson(full), keptLen = measureJson(kept);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(NETWORK_WORKER_RESPONSE_MAX_LEN, (uint32_t)keptLen);
+
+        CountingAllocator a, b;
+        double fullNs = timeParses(r.body, nullptr, a);
+        double keptNs = timeParses(r.body, filter, b);
+        char line[200];
+        snprintf(line, sizeof(line), "%-17s body %4u B | unfiltered: heap %5u B, %2u allocs, %6.0f ns, %4u B out | "
+                 "filtered: heap %5u B, %2u allocs, %6.0f ns, %4u B out",
+                 r.apiType, (unsigned)strlen(r.body), (unsigned)fullAlloc.peak, (unsigned)fullAlloc.calls, fullNs,
+                 (unsigned)fullLen, (unsigned)keptAlloc.peak, (unsigned)keptAlloc.calls, keptNs, (unsigned)keptLen);
+        TEST_MESSAGE(line);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_filtered_replay_needs_less_heap_and_fits_the_event_body);
+    return UNITY_END();
+}
@@ -0,0 +1,191 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `ApiResponseFilter`: every filter keeps exactly the fields its callback reads, with the
+ *        values of an unfiltered parse, and every `apiType` tag the firmware sends maps to the right filter.
+ *
+ * The field lists below mirror the callbacks (`apply*Response()` and the setup/TLM lambdas in
+ * ESP32GreenhouseController.ino, the `WT_ASYNC_LP` callback in NetworkWorker.cpp). A callback that starts reading
+ * another field needs it added to both its filter and its list here. The response bodies carry extra fields at
+ * every level, including names the filters keep elsewhere (`name` at the top, `temperature` outside `data`).
+ */
+#include <unity.h>
+#include <map>
+#include <set>
+#include <string>
+#include "ApiResponseFilter.h"
+
+typedef std::map<std::string, std::string> Leaves; ///< Leaf path ("data[2].name") to its serialized value.
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief Collects every leaf value of a document under its path.
+ */
+static void collect(JsonVariantConst v, const std::string& path, Leaves& out) {
+    if (v.is<JsonObjectConst>()) {
+        for (JsonPairConst kv : v.as<JsonObjectConst>()) {
+            collect(kv.value(), path.empty() ? std::string(kv.key().c_str()) : path + "." + kv.key().c_str(), out);
+        }
+    } else if (v.is<JsonArrayConst>()) {
+        size_t i = 0;
+        for (JsonVariantConst e : v.as<JsonArrayConst>()) collect(e, path + "[" + std::to_string(i++) + "]", out);
+    } else {
+        std::string s;
+        serializeJson(v, s);
+        out[path] = s;
+    }
+}
+
+/**
+ * @brief A leaf path with array indices dropped ("data[2].name" becomes "data[].name").
+ */
+static std::string shapeOf(const std::string& path) {
+    std::string s;
+    for (size_t i = 0; i < path.size(); ++i) {
+        s += path[i];
+        if (path[i] == '[') {
+            while (i + 1 < path.size() && path[i + 1] != ']') i++;
+        }
+    }
+    return s;
+}
+
+static std::string join(const std::set<std::string>& paths) {
+    std::string s;
+    for (const std::string& p : paths) s += (s.empty() ? "" : ",") + p;
+    return s;
+}
+
+/**
+ * @brief Parses `body` with and without the filter of `kind` and checks that the filtered document holds
+ *        exactly the leaves of `fields`, every one the body has, with unchanged values.
+ */
+static void assertKeepsExactly(ApiResponseKind kind, const char* body, const char* const* fields, size_t count) {
+    const JsonDocument* filter = getApiResponseFilter(kind);
+    TEST_ASSERT_NOT_NULL(filter);
+    JsonDocument full, kept;
+    TEST_ASSERT_FALSE(deserializeJson(full, body));
+    TEST_ASSERT_FALSE(deserializeJson(kept, body, DeserializationOption::Filter(*filter)));
+
+    Leaves fullLeaves, keptLeaves;
+    collect(full.as<JsonVariantConst>(), "", fullLeaves);
+    collect(kept.as<JsonVariantConst>(), "", keptLeaves);
+
+    std::set<std::string> wanted(fields, fields + count), keptShapes;
+    for (const Leaves::value_type& leaf : keptLeaves) {
+        keptShapes.insert(shapeOf(leaf.first));
+        TEST_ASSERT_EQUAL_STRING(fullLeaves[leaf.first].c_str(), leaf.second.c_str());
+    }
+    TEST_ASSERT_EQUAL_STRING(join(wanted).c_str(), join(keptShapes).c_str());
+    for (const Leaves::value_type& leaf : fullLeaves) {
+        if (wanted.count(shapeOf(leaf.first))) TEST_ASSERT_TRUE(keptLeaves.count(leaf.first) == 1);
+    }
+}
+
+#define ASSERT_KEEPS_EXACTLY(kind, body, fields) \
+    assertKeepsExactly(kind, body, fields, sizeof(fields) / sizeof(fields[0]))
+
+static const char THRESHOLDS_BODY[] = R"({
+  "status": "success", "name": "thresholds", "count": 3,
+  "data": [
+    {"id": 11, "gh_id": 4, "name": "temperature", "threshold_min": "18.5", "threshold_max": "29.0",
+     "unit": "C", "updated_at": "2025-10-08 14:02:11"},
+    {"id": 12, "gh_id": 4, "name": "humidity", "threshold_min": "45", "threshold_max": "85",
+     "unit": "%", "updated_at": "2025-10-08 14:02:11", "history": [{"threshold_min": "40"}]},
+    {"id": 13, "gh_id": 4, "name": "light_intensity", "threshold_min": "200", "threshold_max": "12000",
+     "unit": "lux", "updated_at": "2025-10-01 09:00:00"}
+  ]
+})";
+
+static const char NODE_DATA_BODY[] = R"({
+  "status": "success", "temperature": -1,
+  "data": {"id": 90211, "node_id": 2, "temperature": 24.6, "humidity": 61.2, "light_intensity": 5400,
+           "soil_moisture": 33, "recorded_at": "2025-10-09 08:50:00", "battery": {"voltage": 3.9}}
+})";
+
+static const char DEVICE_STATUS_BODY[] = R"({
+  "status": "success",
+  "data": {"gh_id": 4, "exhaust_status": "1", "dehumidifier_status": "0", "blower_status": "1",
+           "mode": "manual", "changed_by": "admin", "changed_at": "2025-10-09 08:41:07"}
+})";
+
+static const char WORLD_TIME_BODY[] = R"({
+  "abbreviation": "+07", "client_ip": "203.0.113.7", "datetime": "2025-10-09T15:53:20.123456+07:00",
+  "day_of_week": 4, "day_of_year": 282, "dst": false, "dst_from": null, "dst_offset": 0, "dst_until": null,
+  "raw_offset": 25200, "timezone": "Asia/Jakarta", "unixtime": 1760000000,
+  "utc_datetime": "2025-10-09T08:53:20.123456+00:00", "utc_offset": "+07:00", "week_number": 41
+})";
+
+static const char TELEMETRY_BODY[] = R"({"status": "stored", "received": 48, "acked_seq": 1200448, "server_time": 1760000000})";
+
+static const char* const THRESHOLD_FIELDS[] = {"data[].name", "data[].threshold_min", "data[].threshold_max"};
+static const char* const NODE_DATA_FIELDS[] = {"data.temperature", "data.humidity", "data.light_intensity"};
+static const char* const DEVICE_STATUS_FIELDS[] = {"data.exhaust_status", "data.dehumidifier_status",
+                                                   "data.blower_status"};
+static const char* const WORLD_TIME_FIELDS[] = {"unixtime"};
+static const char* const TELEMETRY_FIELDS[] = {"acked_seq"};
+static const char* const SYNC_FIELDS[] = {
+    "thresholds.data[].name", "thresholds.data[].threshold_min", "thresholds.data[].threshold_max",
+    "node_data.data.temperature", "node_data.data.humidity", "node_data.data.light_intensity"};
+
+void test_thresholds_filter_keeps_name_and_limits_of_every_entry() {
+    ASSERT_KEEPS_EXACTLY(ApiResponseKind::THRESHOLDS, THRESHOLDS_BODY, THRESHOLD_FIELDS);
+}
+
+void test_node_data_filter_keeps_the_three_readings() {
+    ASSERT_KEEPS_EXACTLY(ApiResponseKind::NODE_DATA, NODE_DATA_BODY, NODE_DATA_FIELDS);
+}
+
+void test_device_status_filter_keeps_the_three_relay_targets() {
+    ASSERT_KEEPS_EXACTLY(ApiResponseKind::DEVICE_STATUS, DEVICE_STATUS_BODY, DEVICE_STATUS_FIELDS);
+}
+
+void test_world_time_filter_keeps_unixtime() {
+    ASSERT_KEEPS_EXACTLY(ApiResponseKind::WORLD_TIME, WORLD_TIME_BODY, WORLD_TIME_FIELDS);
+}
+
+void test_telemetry_filter_keeps_acked_seq_and_tolerates_its_absence() {
+    ASSERT_KEEPS_EXACTLY(ApiResponseKind::TELEMETRY, TELEMETRY_BODY, TELEMETRY_FIELDS);
+
+    // The TLM_BATCH_P callback treats a missing acked_seq as "everything stored".
+    JsonDocument kept;
+    TEST_ASSERT_FALSE(deserializeJson(kept, R"({"status": "stored", "received": 48})",
+                                      DeserializationOption::Filter(*getApiResponseFilter(ApiResponseKind::TELEMETRY))));
+    TEST_ASSERT_TRUE(kept["acked_seq"].isNull());
+}
+
+void test_sync_filter_nests_the_threshold_and_node_data_filters() {
+    std::string body = std::string(R"({"status": "success", "generated_at": "2025-10-09 08:53:20", "thresholds": )") +
+                       THRESHOLDS_BODY + R"(, "node_data": )" + NODE_DATA_BODY + "}";
+    ASSERT_KEEPS_EXACTLY(ApiResponseKind::SYNC, body.c_str(), SYNC_FIELDS);
+}
+
+void test_every_tag_the_firmware_sends_selects_its_filter() {
+    TEST_ASSERT_TRUE(classifyApiResponse("TH_ASYNC_SETUP") == ApiResponseKind::THRESHOLDS);
+    TEST_ASSERT_TRUE(classifyApiResponse("TH_ASYNC_LP") == ApiResponseKind::THRESHOLDS);
+    TEST_ASSERT_TRUE(classifyApiResponse("ND_ASYNC_SETUP") == ApiResponseKind::NODE_DATA);
+    TEST_ASSERT_TRUE(classifyApiResponse("ND_ASYNC_LP") == ApiResponseKind::NODE_DATA);
+    TEST_ASSERT_TRUE(classifyApiResponse("DEV_ST_G_SETUP") == ApiResponseKind::DEVICE_STATUS);
+    TEST_ASSERT_TRUE(classifyApiResponse("DEV_ST_G_LP_ASYNC") == ApiResponseKind::DEVICE_STATUS);
+    TEST_ASSERT_TRUE(classifyApiResponse("WT_ASYNC_LP") == ApiResponseKind::WORLD_TIME);
+    TEST_ASSERT_TRUE(classifyApiResponse("SYNC_ASYNC_LP") == ApiResponseKind::SYNC);
+    TEST_ASSERT_TRUE(classifyApiResponse("TLM_BATCH_P") == ApiResponseKind::TELEMETRY);
+
+    // Requests whose callback reads nothing, or unknown tags, parse unfiltered.
+    TEST_ASSERT_TRUE(classifyApiResponse("STATUS_BATCH_P") == ApiResponseKind::GENERIC);
+    TEST_ASSERT_TRUE(classifyApiResponse(nullptr) == ApiResponseKind::GENERIC);
+    TEST_ASSERT_NULL(getApiResponseFilter(ApiResponseKind::GENERIC));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_thresholds_filter_keeps_name_and_limits_of_every_entry);
+    RUN_TEST(test_node_data_filter_keeps_the_three_readings);
+    RUN_TEST(test_device_status_filter_keeps_the_three_relay_targets);
+    RUN_TEST(test_world_time_filter_keeps_unixtime);
+    RUN_TEST(test_telemetry_filter_keeps_acked_seq_and_tolerates_its_absence);
+    RUN_TEST(test_sync_filter_nests_the_threshold_and_node_data_filters);
+    RUN_TEST(test_every_tag_the_firmware_sends_selects_its_filter);
+    return UNITY_END();
+}
@@ -0,0 +1,270 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `AtCommandEngine` against a scripted modem stream: echo suppression, info-line capture,
+ *        URCs interleaved with a reply, late finals after a timeout, long-line spill and passthrough framing, and
+ *        the handover to TinyGSM while a command is in flight.
+ */
+#include <unity.h>
+#include <string>
+#include <deque>
+#include "AtCommandEngine.h"
+
+/**
+ * @brief Modem stand-in: the test feeds the bytes the modem "sends" and reads back what the engine wrote.
+ *        An optional reply is released when the engine writes a given command, like a modem answering in time.
+ */
+class ScriptedModem : public Stream {
+public:
+    void feed(const char* s) { rx.insert(rx.end(), s, s + strlen(s)); }
+    void replyTo(const char* command, const char* reply) {
+        _command = command;
+        _reply = reply;
+    }
+
+    int available() override { return (int)rx.size(); }
+    int read() override {
+        if (rx.empty()) return -1;
+        int c = (uint8_t)rx.front();
+        rx.pop_front();
+        return c;
+    }
+    int peek() override { return rx.empty() ? -1 : (uint8_t)rx.front(); }
+    size_t write(uint8_t c) override {
+        tx += (char)c;
+        if (!_command.empty() && tx.size() >= _command.size() &&
+            tx.compare(tx.size() - _command.size(), _command.size(), _command) == 0) {
+            feed(_reply.c_str());
+            _command.clear();
+        }
+        return 1;
+    }
+    using Print::write;
+
+    std::deque<char> rx; ///< Bytes not yet read by the engine.
+    std::string tx;      ///< Everything the engine (or TinyGSM through it) wrote.
+
+private:
+    std::string _command, _reply;
+};
+
+static ScriptedModem* modem;
+static AtCommandEngine* engine;
+static int calls;
+static AtResult lastResult;
+static std::string lastInfo;
+
+static AtCommandEngine::ResponseHandler record() {
+    return [](AtResult result, const char* info) {
+        calls++;
+        lastResult = result;
+        lastInfo = info;
+    };
+}
+
+/**
+ * @brief Reads everything the engine hands to TinyGSM.
+ */
+static std::string drain() {
+    std::string out;
+    while (engine->available() > 0) out += (char)engine->read();
+    return out;
+}
+
+void setUp() {
+    nativeSetMs(1000);
+    modem = new ScriptedModem();
+    engine = new AtCommandEngine(*modem);
+    calls = 0;
+    lastResult = AtResult::TIMEOUT;
+    lastInfo = "?";
+}
+
+void tearDown() {
+    delete engine;
+    delete modem;
+}
+
+void test_echo_is_suppressed_and_prefixed_info_captured() {
+    TEST_ASSERT_TRUE(engine->submit("+CSQ", "+CSQ:", AT_DEFAULT_TIMEOUT_MS, record()));
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_STRING("AT+CSQ\r\n", modem->tx.c_str());
+
+    modem->feed("AT+CSQ\r\r\n+CSQ: 20,0\r\n\r\nOK\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(1, calls);
+    TEST_ASSERT_EQUAL_INT((int)AtResult::OK, (int)lastResult);
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 20,0", lastInfo.c_str());
+    TEST_ASSERT_TRUE(engine->isIdle());
+    TEST_ASSERT_EQUAL_STRING("", drain().c_str()); // Neither the echo nor the reply reaches TinyGSM.
+}
+
+void test_unprefixed_info_line_and_custom_final_token() {
+    engine->submit("+CIFSR", "", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    modem->feed("\r\n10.64.1.7\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(0, calls); // AT+CIFSR has no OK; a plain info line is not a final result.
+
+    engine->submit("+CIPSHUT", nullptr, AT_DEFAULT_TIMEOUT_MS, record(), "SHUT OK");
+    modem->feed("\r\nERROR\r\n"); // Completes the CIFSR with an error, with the info line kept.
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(1, calls);
+    TEST_ASSERT_EQUAL_INT((int)AtResult::ERROR, (int)lastResult);
+    TEST_ASSERT_EQUAL_STRING("10.64.1.7", lastInfo.c_str());
+
+    modem->feed("\r\nSHUT OK\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(2, calls);
+    TEST_ASSERT_EQUAL_INT((int)AtResult::OK, (int)lastResult);
+    TEST_ASSERT_EQUAL_STRING("", lastInfo.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, engine->getStats().errors);
+}
+
+void test_urc_interleaved_with_a_reply_goes_to_its_handler() {
+    std::string urc;
+    engine->onUrc("+CREG:", [&urc](const char* line) { urc = line; });
+    engine->submit("+CGREG?", "+CGREG:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+
+    modem->feed("\r\n+CREG: 5\r\n\r\n+CGREG: 0,1\r\n\r\nOK\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_STRING("+CREG: 5", urc.c_str());
+    TEST_ASSERT_EQUAL_STRING("+CGREG: 0,1", lastInfo.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, engine->getStats().urcs);
+
+    // The command's own info prefix wins over a URC handler registered for the same prefix.
+    engine->onUrc("+CSQ:", [&urc](const char* line) { urc = line; });
+    engine->submit("+CSQ", "+CSQ:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    modem->feed("\r\n+CSQ: 17,0\r\n\r\nOK\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 17,0", lastInfo.c_str());
+    TEST_ASSERT_EQUAL_STRING("+CREG: 5", urc.c_str());
+}
+
+void test_late_final_after_timeout_is_dropped() {
+    engine->submit("+COPS?", "+COPS:", 500, record());
+    engine->submit("+CSQ", "+CSQ:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    nativeAdvanceMs(499);
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(0, calls);
+
+    nativeAdvanceMs(1);
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(1, calls);
+    TEST_ASSERT_EQUAL_INT((int)AtResult::TIMEOUT, (int)lastResult);
+    TEST_ASSERT_EQUAL_STRING("AT+COPS?\r\nAT+CSQ\r\n", modem->tx.c_str()); // The next command went out.
+
+    // Late finals arriving once nothing is in flight are dropped rather than left for TinyGSM's next command.
+    modem->feed("\r\n+CSQ: 20,0\r\n\r\nOK\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(2, calls);
+    modem->feed("\r\nOK\r\n\r\nERROR\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_UINT32(2, engine->getStats().strayFinals);
+    TEST_ASSERT_EQUAL_UINT32(1, engine->getStats().timeouts);
+    TEST_ASSERT_EQUAL_STRING("", drain().c_str());
+}
+
+void test_long_line_spills_and_unowned_lines_pass_through_in_order() {
+    std::string longLine(AT_LINE_MAX_LEN + 40, 'x');
+    std::string script = "\r\n+CIPRXGET: 1,0\r\n" + longLine + "\r\n";
+    modem->feed(script.c_str());
+    engine->poll(millis());
+
+    // Re-framed short line, then the long one exactly as sent (its spill keeps the original CR LF).
+    std::string expected = "\r\n+CIPRXGET: 1,0\r\n\r\n" + longLine + "\r\n";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), drain().c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, engine->getStats().passthroughDrops);
+
+    // After the spill, line matching resumes.
+    engine->submit("", nullptr, AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    modem->feed("OK\r\n");
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(1, calls);
+    TEST_ASSERT_EQUAL_INT((int)AtResult::OK, (int)lastResult);
+}
+
+void test_passthrough_overflow_is_counted() {
+    std::string burst;
+    while (burst.size() <= AT_PASSTHROUGH_BUFFER_LEN) burst += "+CIPRXGET: 1,0\r\n";
+    modem->feed(burst.c_str());
+    engine->poll(millis());
+    TEST_ASSERT_GREATER_THAN(0, (int)engine->getStats().passthroughDrops);
+    TEST_ASSERT_EQUAL_INT(AT_PASSTHROUGH_BUFFER_LEN, (int)drain().size());
+}
+
+void test_handover_finishes_the_command_in_flight_first() {
+    engine->submit("+CSQ", "+CSQ:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    modem->feed("\r\n+CSQ: 9,0\r\n\r\nOK\r\n\r\n+CIPRXGET: 1,0\r\n");
+
+    // TinyGSM's first UART access completes the queued reply before it sees a byte.
+    std::string seen = drain();
+    TEST_ASSERT_EQUAL_INT(1, calls);
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 9,0", lastInfo.c_str());
+    TEST_ASSERT_EQUAL_STRING("\r\n+CIPRXGET: 1,0\r\n", seen.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, engine->getStats().handovers);
+    TEST_ASSERT_EQUAL_UINT32(0, engine->getStats().maxHandoverWaitMs);
+}
+
+void test_handover_waits_for_a_slow_reply_and_bounds_a_missing_one() {
+    engine->submit("+CGATT?", "+CGATT:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->submit("+CSQ", "+CSQ:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    modem->feed("\r\n+CGATT: 1\r\n"); // Final result still outstanding.
+
+    // No reply ever comes: TinyGSM's write waits out the timeout (virtual time via delay()), then goes out.
+    engine->write(reinterpret_cast<const uint8_t*>("AT+CIPSEND=0,4\r\n"), 16);
+    TEST_ASSERT_EQUAL_INT(1, calls);
+    TEST_ASSERT_EQUAL_INT((int)AtResult::TIMEOUT, (int)lastResult);
+    TEST_ASSERT_EQUAL_STRING("+CGATT: 1", lastInfo.c_str());
+    TEST_ASSERT_EQUAL_UINT32(AT_DEFAULT_TIMEOUT_MS, engine->getStats().maxHandoverWaitMs);
+    TEST_ASSERT_EQUAL_STRING("AT+CGATT?\r\nAT+CIPSEND=0,4\r\n", modem->tx.c_str()); // Queued CSQ not sent meanwhile.
+
+    // Queued commands resume on the next poll().
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_STRING("AT+CGATT?\r\nAT+CIPSEND=0,4\r\nAT+CSQ\r\n", modem->tx.c_str());
+}
+
+void test_handover_moves_a_partly_read_line_to_tinygsm() {
+    modem->feed("\r\n+CIPRXGET: 2,0,4,0\r\nab"); // Socket data without a line end yet.
+    engine->poll(millis());
+    modem->feed("cd\r\nOK\r\n");
+    TEST_ASSERT_EQUAL_STRING("\r\n+CIPRXGET: 2,0,4,0\r\n\r\nabcd\r\nOK\r\n", drain().c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, engine->getStats().handovers); // Nothing was in flight.
+}
+
+void test_reply_timed_to_the_command_and_clear_drops_handlers() {
+    modem->replyTo("AT+CPIN?\r\n", "\r\n+CPIN: READY\r\n\r\nOK\r\n");
+    engine->submit("+CPIN?", "+CPIN:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_STRING("+CPIN: READY", lastInfo.c_str());
+
+    engine->submit("+CSQ", "+CSQ:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->submit("+CREG?", "+CREG:", AT_DEFAULT_TIMEOUT_MS, record());
+    engine->poll(millis());
+    engine->clear();
+    TEST_ASSERT_TRUE(engine->isIdle());
+    nativeAdvanceMs(5000);
+    engine->poll(millis());
+    TEST_ASSERT_EQUAL_INT(1, calls); // Neither dropped command reports, not even as a timeout.
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_echo_is_suppressed_and_prefixed_info_captured);
+    RUN_TEST(test_unprefixed_info_line_and_custom_final_token);
+    RUN_TEST(test_urc_interleaved_with_a_reply_goes_to_its_handler);
+    RUN_TEST(test_late_final_after_timeout_is_dropped);
+    RUN_TEST(test_long_line_spills_and_unowned_lines_pass_through_in_order);
+    RUN_TEST(test_passthrough_overflow_is_counted);
+    RUN_TEST(test_handover_finishes_the_command_in_flight_first);
+    RUN_TEST(test_handover_waits_for_a_slow_reply_and_bounds_a_missing_one);
+    RUN_TEST(test_handover_moves_a_partly_read_line_to_tinygsm);
+    RUN_TEST(test_reply_timed_to_the_command_and_clear_drops_handlers);
+    return UNITY_END();
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_main.cpp
+ * @brief Microbenchmark of response-callback submission cost: `HttpResponseCallback` against the `std::function`
+ *        it replaced.
+ *
+ * Each submission follows the callback's path through the firmware: stored in a `NetworkWorker` callback slot,
+ * wrapped in the worker's `[this, id]` relay, copied into an `HttpRequestQueue` slot and then into the manager's
+ * `_asyncCb`, whose call runs the original callback from its slot. Global `operator new` is counted. The allocation counts are asserted; the
+ * timings are host numbers and only reported, since they say nothing about the ESP32 beyond the ranking.
+ */
+#include <unity.h>
+#include <chrono>
+#include <functional>
+#include <new>
+#include "HttpRequestQueue.h" // For HttpResponseCallback.
+
+static size_t allocations = 0;
+
+void* operator new(size_t n) {
+    allocations++;
+    void* p = malloc(n);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+void setUp() {}
+void tearDown() {}
+
+static const int SUBMISSIONS = 200000;
+
+/**
+ * @brief The slots a callback is copied through, with the hand-offs kept out of line like the real ones.
+ */
+template <typename Callback>
+struct Path {
+    Callback pending[8];
+    Callback queued[8];
+    Callback asyncCb;
+
+    __attribute__((noinline)) void submit(const Callback& cb, int i) {
+        pending[i & 7] = cb;
+        uint16_t id = (uint16_t)i;
+        Callback relay = [this, id](JsonDocument& doc) -> bool { return pending[id & 7](doc); };
+        enqueue(relay, i);
+    }
+    __attribute__((noinline)) void enqueue(const Callback& cb, int i) {
+        queued[i & 7] = cb;
+        start(queued[i & 7]);
+    }
+    __attribute__((noinline)) void start(const Callback& cb) { asyncCb = cb; }
+};
+
+/**
+ * @brief Captures of the size given, as the sketch's lambdas capture `this` and a few values.
+ */
+struct Capture16 { void* a; uint32_t b; uint32_t c; };
+struct Capture40 { void* a; void* b; void* c; void* d; uint64_t e; };
+static_assert(sizeof(Capture16) <= HTTP_RESPONSE_CALLBACK_STORAGE, "Capture16 must fit HttpResponseCallback");
+
+struct Measurement {
+    double nsPerSubmission;
+    double allocationsPerSubmission;
+};
+
+template <typename Callback, typename Capture>
+static Measurement run(const char* label) {
+    static Path<Callback> path;
+    JsonDocument doc;
+    int sink = 0;
+    Capture capture;
+    memset(&capture, 0, sizeof(capture));
+    capture.a = &sink;
+
+    allocations = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < SUBMISSIONS; ++i) {
+        path.submit([capture](JsonDocument&) -> bool { return (*(int*)capture.a)++ >= 0; }, i);
+        path.asyncCb(doc);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    Measurement m = {ns / SUBMISSIONS, (double)allocations / SUBMISSIONS};
+    char line[128];
+    snprintf(line, sizeof(line), "%-40s %6.1f ns/submission, %.2f heap allocations/submission",
+             label, m.nsPerSubmission, m.allocationsPerSubmission);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL_INT(SUBMISSIONS, sink);
+    return m;
+}
+
+void test_inplace_callback_never_allocates() {
+    Measurement m = run<HttpResponseCallback, Capture16>("HttpResponseCallback, 16-byte capture:");
+    TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)(m.allocationsPerSubmission * SUBMISSIONS));
+}
+
+void test_std_function_allocates_once_captures_outgrow_its_buffer() {
+    run<std::function<bool(JsonDocument&)>, Capture16>("std::function, 16-byte capture:");
+    Measurement big = run<std::function<bool(JsonDocument&)>, Capture40>("std::function, 40-byte capture:");
+    TEST_ASSERT_GREATER_THAN(0, (long)(big.allocationsPerSubmission * SUBMISSIONS));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_inplace_callback_never_allocates);
+    RUN_TEST(test_std_function_allocates_once_captures_outgrow_its_buffer);
+    return UNITY_END();
+}
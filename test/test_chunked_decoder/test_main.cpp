@@ -0,0 +1,221 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `ChunkedDecoder`: framing split at every possible point, chunk extensions, trailers,
+ *        size-line limits, output truncation and in-place decoding.
+ */
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "ChunkedDecoder.h"
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief Result of decoding a whole body in pieces.
+ */
+struct Decoded {
+    std::string out;
+    size_t consumed = 0;
+    bool done = false;
+    bool error = false;
+    bool overflowed = false;
+    unsigned long payloadBytes = 0;
+};
+
+/**
+ * @brief Feeds `encoded` in pieces whose sizes come from `nextPiece`, into an output buffer of `outCap` bytes.
+ */
+template <typename NextPiece>
+static Decoded decode(const std::string& encoded, NextPiece nextPiece, size_t outCap = 4096) {
+    ChunkedDecoder d;
+    Decoded r;
+    std::string buf(outCap, '\0');
+    size_t used = 0, pos = 0;
+    while (pos < encoded.size()) {
+        size_t n = nextPiece();
+        if (n > encoded.size() - pos) n = encoded.size() - pos;
+        size_t outLen = 0;
+        size_t took = d.feed(encoded.data() + pos, n, &buf[used], outCap - used, outLen);
+        used += outLen;
+        r.consumed += took;
+        pos += n;
+        if (took < n) break; // DONE or ERROR
+    }
+    r.out.assign(buf.data(), used);
+    r.done = d.isDone();
+    r.error = d.hasError();
+    r.overflowed = d.hasOverflowed();
+    r.payloadBytes = d.getPayloadBytes();
+    return r;
+}
+
+static Decoded decodeWhole(const std::string& encoded, size_t outCap = 4096) {
+    return decode(encoded, [&]() { return encoded.size(); }, outCap);
+}
+
+static Decoded decodeByteByByte(const std::string& encoded, size_t outCap = 4096) {
+    return decode(encoded, []() { return (size_t)1; }, outCap);
+}
+
+/**
+ * @brief Deterministic pseudo-random piece sizes between 1 and `maxPiece`.
+ */
+static Decoded decodeRandomSplits(const std::string& encoded, uint32_t seed, size_t maxPiece) {
+    uint32_t state = seed;
+    return decode(encoded, [&]() {
+        state = state * 1664525u + 1013904223u;
+        return (size_t)(1 + (state >> 16) % maxPiece);
+    });
+}
+
+static const char* const BODY = "{\"data\":{\"temperature\":\"23.5\",\"humidity\":\"61\"}}";
+
+static std::string encodeBody(const std::string& body, size_t chunkSize, const char* ext, const char* trailers) {
+    std::string enc;
+    char line[32];
+    for (size_t i = 0; i < body.size(); i += chunkSize) {
+        size_t n = body.size() - i < chunkSize ? body.size() - i : chunkSize;
+        snprintf(line, sizeof(line), "%zX", n);
+        enc += line;
+        enc += ext;
+        enc += "\r\n";
+        enc.append(body, i, n);
+        enc += "\r\n";
+    }
+    enc += "0";
+    enc += ext;
+    enc += "\r\n";
+    enc += trailers;
+    enc += "\r\n";
+    return enc;
+}
+
+void test_whole_body_in_one_feed() {
+    std::string enc = encodeBody(BODY, 7, "", "");
+    Decoded r = decodeWhole(enc);
+    TEST_ASSERT_TRUE(r.done);
+    TEST_ASSERT_FALSE(r.error);
+    TEST_ASSERT_EQUAL_STRING(BODY, r.out.c_str());
+    TEST_ASSERT_EQUAL_UINT32(strlen(BODY), r.payloadBytes);
+    TEST_ASSERT_EQUAL_UINT32(enc.size(), r.consumed);
+}
+
+void test_one_byte_at_a_time_splits_every_size_line_and_crlf() {
+    std::string enc = encodeBody(BODY, 5, ";name=\"v;al\"", "X-Checksum: abc\r\nX-Other: 1\r\n");
+    Decoded r = decodeByteByByte(enc);
+    TEST_ASSERT_TRUE(r.done);
+    TEST_ASSERT_EQUAL_STRING(BODY, r.out.c_str());
+    TEST_ASSERT_EQUAL_UINT32(enc.size(), r.consumed);
+}
+
+void test_every_two_way_split_point() {
+    std::string enc = encodeBody(BODY, 16, ";x", "T: 1\r\n");
+    for (size_t cut = 1; cut < enc.size(); ++cut) {
+        bool first = true;
+        Decoded r = decode(enc, [&]() {
+            size_t n = first ? cut : enc.size();
+            first = false;
+            return n;
+        });
+        TEST_ASSERT_TRUE(r.done);
+        TEST_ASSERT_EQUAL_STRING(BODY, r.out.c_str());
+    }
+}
+
+void test_arbitrary_splits() {
+    std::string enc = encodeBody(BODY, 3, ";a=b;c", "Trailer-A: x\r\n");
+    for (uint32_t seed = 1; seed <= 200; ++seed) {
+        Decoded r = decodeRandomSplits(enc, seed, 9);
+        TEST_ASSERT_TRUE(r.done);
+        TEST_ASSERT_EQUAL_STRING(BODY, r.out.c_str());
+    }
+}
+
+void test_uppercase_and_leading_zero_sizes_with_bare_lf() {
+    Decoded r = decodeByteByByte("0A\nabcdefghij\n00000001 ; ext\nk\n0\n\n");
+    TEST_ASSERT_TRUE(r.done);
+    TEST_ASSERT_EQUAL_STRING("abcdefghijk", r.out.c_str());
+}
+
+void test_trailers_after_last_chunk_are_skipped() {
+    Decoded r = decodeWhole("3\r\nabc\r\n0\r\nETag: \"1\"\r\nExpires: never\r\n\r\n");
+    TEST_ASSERT_TRUE(r.done);
+    TEST_ASSERT_EQUAL_STRING("abc", r.out.c_str());
+}
+
+void test_input_after_the_body_is_not_consumed() {
+    std::string enc = "2\r\nok\r\n0\r\n\r\n";
+    Decoded r = decodeWhole(enc + "HTTP/1.1 200 OK\r\n");
+    TEST_ASSERT_TRUE(r.done);
+    TEST_ASSERT_EQUAL_UINT32(enc.size(), r.consumed);
+}
+
+void test_size_line_longer_than_eight_digits_is_an_error() {
+    Decoded ok = decodeWhole("0000000A\r\n0123456789\r\n0\r\n\r\n");
+    TEST_ASSERT_TRUE(ok.done);
+    Decoded r = decodeByteByByte("000000001\r\nx\r\n0\r\n\r\n");
+    TEST_ASSERT_TRUE(r.error);
+    TEST_ASSERT_FALSE(r.done);
+}
+
+void test_malformed_framing_is_an_error() {
+    TEST_ASSERT_TRUE(decodeWhole("\r\n").error);            // Empty size line.
+    TEST_ASSERT_TRUE(decodeWhole("g\r\n").error);           // Not hex.
+    TEST_ASSERT_TRUE(decodeWhole("3\r\nabcX\r\n").error);   // Missing CRLF after the payload.
+    TEST_ASSERT_TRUE(decodeWhole("3\rXabc").error);         // CR not followed by LF.
+    TEST_ASSERT_TRUE(decodeWhole("0\r\n\rX").error);        // Broken final CRLF.
+}
+
+void test_output_truncation_drops_payload_but_finds_the_end() {
+    std::string enc = encodeBody(BODY, 4, "", "T: 1\r\n");
+    Decoded r = decodeByteByByte(enc, 10);
+    TEST_ASSERT_TRUE(r.done);
+    TEST_ASSERT_TRUE(r.overflowed);
+    TEST_ASSERT_EQUAL_UINT32(10, r.out.size());
+    TEST_ASSERT_EQUAL_STRING_LEN(BODY, r.out.c_str(), 10);
+    TEST_ASSERT_EQUAL_UINT32(strlen(BODY), r.payloadBytes);
+    TEST_ASSERT_FALSE(decodeWhole(enc, strlen(BODY)).overflowed);
+}
+
+void test_in_place_decoding() {
+    std::string enc = encodeBody(BODY, 6, ";e=1", "");
+    std::string buf = enc;
+    ChunkedDecoder d;
+    size_t outLen = 0;
+    size_t took = d.feed(&buf[0], buf.size(), &buf[0], buf.size(), outLen);
+    TEST_ASSERT_TRUE(d.isDone());
+    TEST_ASSERT_EQUAL_UINT32(enc.size(), took);
+    TEST_ASSERT_EQUAL_STRING_LEN(BODY, buf.data(), strlen(BODY));
+    TEST_ASSERT_EQUAL_UINT32(strlen(BODY), outLen);
+}
+
+void test_reset_allows_reuse() {
+    ChunkedDecoder d;
+    char out[8];
+    size_t outLen = 0;
+    d.feed("zz", 2, out, sizeof(out), outLen);
+    TEST_ASSERT_TRUE(d.hasError());
+    d.reset();
+    d.feed("1\r\na\r\n0\r\n\r\n", 11, out, sizeof(out), outLen);
+    TEST_ASSERT_TRUE(d.isDone());
+    TEST_ASSERT_EQUAL_UINT32(1, outLen);
+    TEST_ASSERT_EQUAL_UINT32(1, d.getPayloadBytes());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_whole_body_in_one_feed);
+    RUN_TEST(test_one_byte_at_a_time_splits_every_size_line_and_crlf);
+    RUN_TEST(test_every_two_way_split_point);
+    RUN_TEST(test_arbitrary_splits);
+    RUN_TEST(test_uppercase_and_leading_zero_sizes_with_bare_lf);
+    RUN_TEST(test_trailers_after_last_chunk_are_skipped);
+    RUN_TEST(test_input_after_the_body_is_not_consumed);
+    RUN_TEST(test_size_line_longer_than_eight_digits_is_an_error);
+    RUN_TEST(test_malformed_framing_is_an_error);
+    RUN_TEST(test_output_truncation_drops_payload_but_finds_the_end);
+    RUN_TEST(test_in_place_decoding);
+    RUN_TEST(test_reset_allows_reuse);
+    return UNITY_END();
+}
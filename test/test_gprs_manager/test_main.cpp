@@ -0,0 +1,183 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `GPRSManager` over `AtCommandEngine` and a scripted SIM800 (NativeModem.h): the connection
+ *        FSM from `connect()` to `OPERATIONAL`, registration denied, and HTTP requests over the TinyGSM socket
+ *        stand-in to the loopback server (keep-alive, chunked body, `304` on a conditional GET), and the MQTT push
+ *        socket (`getPushClient()`) on its own mux channel next to the pool.
+ */
+#include <unity.h>
+#include <string>
+#include "NativeModem.h"
+#include "GPRSManager.h"
+
+static const char* URL = "http://api.test/v1/config";
+
+static NativeModem* uart;
+static AtCommandEngine* at;
+static TinyGsm* modem;
+static int callbacks;
+static std::string lastValue;
+static HttpResponseInfo lastInfo;
+
+void setUp() {
+    nativeSetMs(1000);
+    nativeHttpServer().reset();
+    uart = new NativeModem();
+    at = new AtCommandEngine(*uart);
+    modem = new TinyGsm(*at);
+    callbacks = 0;
+    lastValue.clear();
+    lastInfo = HttpResponseInfo();
+}
+void tearDown() {
+    delete modem;
+    delete at;
+    delete uart;
+}
+
+static GPRSManager* makeManager(DeviceState* state = nullptr) {
+    GPRSManager* gm = new GPRSManager(*modem, *at, "internet", "", "", "", "token", state);
+    gm->setResponseObserver([](const char*, const HttpResponseInfo& info) { lastInfo = info; });
+    return gm;
+}
+
+/**
+ * @brief Steps the FSM on the virtual clock until it reaches `target` or `maxMs` pass.
+ */
+static bool runUntil(GPRSManager& gm, GPRSState target, unsigned long maxMs) {
+    for (unsigned long t = 0; t < maxMs; t += 10) {
+        gm.updateFSM();
+        if (gm.getGprsState() == target) return true;
+        nativeAdvanceMs(10);
+    }
+    return false;
+}
+
+static void get(GPRSManager& gm) {
+    TEST_ASSERT_TRUE(gm.startAsyncHttpRequest(URL, "GET", "Test", nullptr, [](JsonDocument& doc) -> bool {
+        callbacks++;
+        lastValue = doc["value"] | "";
+        return true;
+    }));
+    for (int i = 0; i < 5000 && gm.isHttpOperationActive(); ++i) {
+        gm.updateFSM();
+        gm.updateHttpOperations();
+        nativeAdvanceMs(10);
+    }
+    TEST_ASSERT_FALSE(gm.isHttpOperationActive());
+}
+
+/// MQTT 3.1.1 CONNECT with an empty client id, and the broker's CONNACK accepting it.
+static const uint8_t MQTT_CONNECT[] = {0x10, 0x0c, 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02, 0x00, 0x3c, 0x00, 0x00};
+static const char MQTT_CONNACK[] = {0x20, 0x02, 0x00, 0x00};
+
+static std::string lengthResponse(const char* body, const char* extraHeaders = "") {
+    return std::string("HTTP/1.1 200 OK\r\nContent-Length: ") + std::to_string(strlen(body)) + "\r\n" +
+           extraHeaders + "\r\n" + body;
+}
+
+void test_connect_attaches_and_becomes_operational() {
+    DeviceState state;
+    GPRSManager* gm = makeManager(&state);
+    TEST_ASSERT_FALSE(gm->isConnected());
+    TEST_ASSERT_TRUE(gm->connect());
+    TEST_ASSERT_TRUE(runUntil(*gm, GPRSState::GPRS_STATE_OPERATIONAL, 120000));
+    TEST_ASSERT_TRUE(gm->isConnected());
+    gm->updateFSM(); // Publishes the state to DeviceState.
+    TEST_ASSERT_TRUE(state.isGprsConnected);
+    TEST_ASSERT_EQUAL_STRING("10.64.1.7", gm->getIPAddress().c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, uart->count("+CSTT=\"internet\""));
+    TEST_ASSERT_EQUAL_UINT32(1, uart->count("+CIICR"));
+    delete gm;
+}
+
+void test_denied_registration_never_becomes_operational() {
+    uart->reply("+CREG?", "\r\n+CREG: 1,3\r\n\r\nOK\r\n");
+    uart->reply("+CGREG?", "\r\n+CGREG: 1,3\r\n\r\nOK\r\n");
+    GPRSManager* gm = makeManager();
+    gm->connect();
+    TEST_ASSERT_FALSE(runUntil(*gm, GPRSState::GPRS_STATE_OPERATIONAL, 30000));
+    TEST_ASSERT_FALSE(gm->isConnected());
+    TEST_ASSERT_EQUAL_UINT32(0, uart->count("+CIICR"));
+    delete gm;
+}
+
+void test_http_get_reaches_the_callback_and_keeps_the_socket() {
+    GPRSManager* gm = makeManager();
+    gm->connect();
+    TEST_ASSERT_TRUE(runUntil(*gm, GPRSState::GPRS_STATE_OPERATIONAL, 120000));
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"one\"}"));
+    nativeHttpServer().respond("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                               "8\r\n{\"value\"\r\n"
+                               "7\r\n:\"two\"}\r\n"
+                               "0\r\n\r\n");
+
+    get(*gm);
+    TEST_ASSERT_EQUAL_INT(1, callbacks);
+    TEST_ASSERT_EQUAL_STRING("one", lastValue.c_str());
+    get(*gm);
+    TEST_ASSERT_EQUAL_INT(2, callbacks);
+    TEST_ASSERT_EQUAL_STRING("two", lastValue.c_str());
+    TEST_ASSERT_EQUAL_UINT32(15, lastInfo.bodyBytes);
+
+    TEST_ASSERT_EQUAL_UINT32(1, nativeHttpServer().connects);
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[0].find("GET /v1/config HTTP/1.1\r\n") == 0);
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[0].find("Authorization: Bearer token\r\n") != std::string::npos);
+    delete gm;
+}
+
+void test_conditional_get_answered_by_304_skips_the_callback() {
+    GPRSManager* gm = makeManager();
+    gm->connect();
+    TEST_ASSERT_TRUE(runUntil(*gm, GPRSState::GPRS_STATE_OPERATIONAL, 120000));
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"full\"}", "ETag: \"g1\"\r\n"));
+    get(*gm);
+    TEST_ASSERT_EQUAL_STRING("\"g1\"", lastInfo.validators.etag);
+
+    HttpValidators validators = lastInfo.validators;
+    gm->setConditionalRequest(&validators);
+    nativeHttpServer().respond("HTTP/1.1 304 Not Modified\r\n\r\n");
+    get(*gm);
+    TEST_ASSERT_EQUAL_INT(1, callbacks);
+    TEST_ASSERT_TRUE(lastInfo.notModified);
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[1].find("If-None-Match: \"g1\"\r\n") != std::string::npos);
+    delete gm;
+}
+
+void test_push_socket_uses_its_own_mux_and_closes_on_disconnect() {
+    GPRSManager* gm = makeManager();
+    gm->connect();
+    TEST_ASSERT_TRUE(runUntil(*gm, GPRSState::GPRS_STATE_OPERATIONAL, 120000));
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"one\"}"));
+    get(*gm);
+
+    Client* push = gm->getPushClient();
+    TEST_ASSERT_NOT_NULL(push);
+    TEST_ASSERT_EQUAL_UINT8(MQTT_GPRS_MUX, static_cast<TinyGsmClient*>(push)->mux());
+    TEST_ASSERT_EQUAL_INT(1, push->connect("broker.test", 1883));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(MQTT_CONNECT), push->write(MQTT_CONNECT, sizeof(MQTT_CONNECT)));
+    std::shared_ptr<NativeConnection> broker = nativeHttpServer().connectionTo("broker.test", 1883);
+    TEST_ASSERT_NOT_NULL(broker.get());
+    TEST_ASSERT_EQUAL_UINT32(sizeof(MQTT_CONNECT), broker->fromClient.size());
+    broker->toClient.insert(broker->toClient.end(), MQTT_CONNACK, MQTT_CONNACK + sizeof(MQTT_CONNACK));
+    uint8_t connack[4];
+    TEST_ASSERT_EQUAL_INT(4, push->read(connack, sizeof(connack)));
+    TEST_ASSERT_EQUAL_UINT8(0x20, connack[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, nativeHttpServer().connects);
+
+    size_t shuts = uart->count("+CIPSHUT");
+    gm->disconnect();
+    TEST_ASSERT_FALSE(push->connected());
+    TEST_ASSERT_EQUAL_UINT32(shuts + 1, uart->count("+CIPSHUT"));
+    delete gm;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_connect_attaches_and_becomes_operational);
+    RUN_TEST(test_denied_registration_never_becomes_operational);
+    RUN_TEST(test_http_get_reaches_the_callback_and_keeps_the_socket);
+    RUN_TEST(test_conditional_get_answered_by_304_skips_the_callback);
+    RUN_TEST(test_push_socket_uses_its_own_mux_and_closes_on_disconnect);
+    return UNITY_END();
+}
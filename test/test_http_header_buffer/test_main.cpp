@@ -0,0 +1,259 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `HttpHeaderBuffer`: the "\r\n\r\n" scan across arbitrary read boundaries, body bytes that
+ *        arrive with the headers, mixed-case and folded headers, and header blocks at and over
+ *        `GPRS_MAX_HEADER_SIZE`.
+ */
+#include <unity.h>
+#include "HttpHeaderBuffer.h"
+
+void setUp() {}
+void tearDown() {}
+
+static HttpHeaderBuffer buf;
+
+/**
+ * @brief Delivers `len` bytes as one socket read, the way `GPRSManager` does.
+ */
+static bool feed(const char* data, size_t len) {
+    TEST_ASSERT_TRUE(len <= buf.space());
+    memcpy(buf.writePtr(), data, len);
+    return buf.commit(len);
+}
+
+static bool feed(const char* data) { return feed(data, strlen(data)); }
+
+/**
+ * @brief Writes a header block of exactly `total` bytes, padded with an `X-Pad` header, into `out`.
+ */
+static void makeBlock(char* out, size_t total) {
+    static const char prefix[] = "HTTP/1.1 200 OK\r\nX-Pad: ";
+    size_t pad = total - (sizeof(prefix) - 1) - 4;
+    memcpy(out, prefix, sizeof(prefix) - 1);
+    memset(out + sizeof(prefix) - 1, 'a', pad);
+    memcpy(out + total - 4, "\r\n\r\n", 4);
+    out[total] = '\0';
+}
+
+void test_terminator_is_found_at_every_split_point() {
+    const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello";
+    const size_t headerLen = strlen(response) - 5;
+
+    for (size_t split = 1; split < sizeof(response) - 1; ++split) {
+        buf.reset();
+        bool first = feed(response, split);
+        TEST_ASSERT_EQUAL(split >= headerLen, first);
+        if (!first) TEST_ASSERT_TRUE(feed(response + split, sizeof(response) - 1 - split));
+        TEST_ASSERT_EQUAL_STRING_LEN(response, buf.headers(), headerLen);
+        TEST_ASSERT_EQUAL_UINT32(headerLen, strlen(buf.headers()));
+        // Once complete, later reads go to the body reader; the buffer only keeps what came with the headers.
+        size_t early = first ? split - headerLen : 5;
+        TEST_ASSERT_EQUAL_UINT32(early, buf.earlyBodyLength());
+        TEST_ASSERT_EQUAL_STRING_LEN("hello", buf.earlyBody(), early);
+    }
+}
+
+void test_byte_by_byte_completes_on_the_last_terminator_byte() {
+    const char response[] = "HTTP/1.1 204 No Content\r\nX-A: 1\r\n\r\n";
+    buf.reset();
+    for (size_t i = 0; i < sizeof(response) - 1; ++i) {
+        bool done = feed(response + i, 1);
+        TEST_ASSERT_EQUAL(i == sizeof(response) - 2, done);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, buf.earlyBodyLength());
+    TEST_ASSERT_EQUAL_UINT32(0, buf.space());
+}
+
+void test_overlapping_partial_terminator_is_not_missed() {
+    // "\r\n\r" followed by "\r\n\r\n": the scan must fall back to the second '\r', not restart after it.
+    buf.reset();
+    TEST_ASSERT_FALSE(feed("HTTP/1.1 200 OK\r\nX-A: 1\r\n\r"));
+    TEST_ASSERT_FALSE(feed("\r"));
+    TEST_ASSERT_TRUE(feed("\n\r\nbody"));
+    TEST_ASSERT_EQUAL_STRING("HTTP/1.1 200 OK\r\nX-A: 1\r\n\r\r\n\r\n", buf.headers());
+    TEST_ASSERT_EQUAL_UINT32(4, buf.earlyBodyLength());
+}
+
+void test_blank_line_inside_the_body_stays_in_the_body() {
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("HTTP/1.1 200 OK\r\n\r\n{\r\n\r\n}"));
+    TEST_ASSERT_EQUAL_STRING("HTTP/1.1 200 OK\r\n\r\n", buf.headers());
+    TEST_ASSERT_EQUAL_UINT32(6, buf.earlyBodyLength());
+    TEST_ASSERT_EQUAL_STRING_LEN("{\r\n\r\n}", buf.earlyBody(), 6);
+    // Bytes after completion are not the header buffer's to take.
+    TEST_ASSERT_EQUAL_UINT32(0, buf.space());
+    TEST_ASSERT_TRUE(buf.commit(3));
+    TEST_ASSERT_EQUAL_UINT32(6, buf.earlyBodyLength());
+}
+
+void test_header_names_match_in_any_case() {
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("HTTP/1.1 200 OK\r\n"
+                          "content-length: 42\r\n"
+                          "CONNECTION: Close\r\n"
+                          "keep-alive: TIMEOUT=5, max=100\r\n"
+                          "etag: \"abc\"\r\n"
+                          "last-MODIFIED: Wed, 21 Oct 2015 07:28:00 GMT\r\n"
+                          "transfer-ENCODING: gzip, CHUNKED\r\n"
+                          "\r\n"));
+    HttpResponseHead head;
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_EQUAL_INT(200, head.statusCode);
+    TEST_ASSERT_TRUE(head.hasContentLength);
+    TEST_ASSERT_EQUAL_UINT32(42, head.contentLength);
+    TEST_ASSERT_FALSE(head.keepAlive);
+    TEST_ASSERT_EQUAL_UINT32(5000, head.keepAliveTimeoutMs);
+    TEST_ASSERT_EQUAL_STRING("\"abc\"", head.validators.etag);
+    TEST_ASSERT_EQUAL_STRING("Wed, 21 Oct 2015 07:28:00 GMT", head.validators.lastModified);
+    TEST_ASSERT_TRUE(head.chunked);
+}
+
+void test_folded_headers_are_joined_to_the_header_they_continue() {
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("HTTP/1.1 200 OK\r\n"
+                          "Transfer-Encoding: gzip,\r\n chunked\r\n"
+                          "Connection:\r\n\tclose\r\n"
+                          "ETag:\r\n  \"v1\"\r\n"
+                          "X-Long: first\r\n second\r\n"
+                          "Content-Length: 7\r\n"
+                          "\r\n"));
+    HttpResponseHead head;
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_EQUAL_INT(200, head.statusCode);
+    TEST_ASSERT_TRUE(head.chunked);
+    TEST_ASSERT_FALSE(head.keepAlive);
+    TEST_ASSERT_EQUAL_STRING("\"v1\"", head.validators.etag);
+    // The header after a folded one is still seen on its own line.
+    TEST_ASSERT_TRUE(head.hasContentLength);
+    TEST_ASSERT_EQUAL_UINT32(7, head.contentLength);
+}
+
+void test_http10_keep_alive_only_when_asked() {
+    HttpResponseHead head;
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("HTTP/1.0 200 OK\r\n\r\n"));
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_FALSE(head.keepAlive);
+    TEST_ASSERT_FALSE(head.hasContentLength);
+
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("HTTP/1.0 304 Not Modified\r\nConnection: keep-alive\r\n\r\n"));
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_EQUAL_INT(304, head.statusCode);
+    TEST_ASSERT_TRUE(head.keepAlive);
+
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("HTTP/1.1 200 OK\r\n\r\n"));
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_TRUE(head.keepAlive);
+}
+
+void test_bad_or_incomplete_status_line_is_rejected() {
+    HttpResponseHead head;
+    buf.reset();
+    TEST_ASSERT_FALSE(feed("HTTP/1.1 200 OK\r\nX-A: 1\r\n"));
+    TEST_ASSERT_FALSE(buf.parseResponseHeaders(head));
+
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("ICY 200 OK\r\n\r\n"));
+    TEST_ASSERT_FALSE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_EQUAL_INT(0, head.statusCode);
+
+    // The code must be on the status line, not borrowed from a header.
+    buf.reset();
+    TEST_ASSERT_TRUE(feed("HTTP/1.1\r\nX-A: 200\r\n\r\n"));
+    TEST_ASSERT_FALSE(buf.parseResponseHeaders(head));
+}
+
+void test_validator_that_does_not_fit_is_dropped() {
+    char response[GPRS_MAX_HEADER_SIZE];
+    char etag[HTTP_ETAG_MAX_LEN + 1];
+    HttpResponseHead head;
+
+    memset(etag, 'e', HTTP_ETAG_MAX_LEN - 1);
+    etag[HTTP_ETAG_MAX_LEN - 1] = '\0';
+    snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nETag: %s\r\n\r\n", etag);
+    buf.reset();
+    TEST_ASSERT_TRUE(feed(response));
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_EQUAL_STRING(etag, head.validators.etag);
+
+    etag[HTTP_ETAG_MAX_LEN - 1] = 'e';
+    etag[HTTP_ETAG_MAX_LEN] = '\0';
+    snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nETag: %s\r\n\r\n", etag);
+    buf.reset();
+    TEST_ASSERT_TRUE(feed(response));
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_EQUAL_STRING("", head.validators.etag);
+}
+
+void test_block_of_exactly_the_maximum_size_is_accepted() {
+    char block[GPRS_MAX_HEADER_SIZE + 8];
+    makeBlock(block, GPRS_MAX_HEADER_SIZE - 1);
+
+    // Arrives in reads of up to 100 bytes, each bounded by space() as in GPRSManager.
+    buf.reset();
+    size_t off = 0;
+    bool done = false;
+    while (!done) {
+        size_t n = GPRS_MAX_HEADER_SIZE - 1 - off;
+        if (n > 100) n = 100;
+        if (n > buf.space()) n = buf.space();
+        TEST_ASSERT_TRUE(n > 0);
+        done = feed(block + off, n);
+        off += n;
+    }
+    TEST_ASSERT_EQUAL_UINT32(GPRS_MAX_HEADER_SIZE - 1, off);
+    TEST_ASSERT_EQUAL_STRING(block, buf.headers());
+    TEST_ASSERT_EQUAL_UINT32(0, buf.earlyBodyLength());
+    HttpResponseHead head;
+    TEST_ASSERT_TRUE(buf.parseResponseHeaders(head));
+    TEST_ASSERT_EQUAL_INT(200, head.statusCode);
+
+    // Body bytes filling the rest of the buffer still fit after the NUL is inserted.
+    makeBlock(block, GPRS_MAX_HEADER_SIZE - 5);
+    memcpy(block + GPRS_MAX_HEADER_SIZE - 5, "body", 4);
+    buf.reset();
+    TEST_ASSERT_TRUE(feed(block, GPRS_MAX_HEADER_SIZE - 1));
+    TEST_ASSERT_EQUAL_UINT32(GPRS_MAX_HEADER_SIZE - 5, strlen(buf.headers()));
+    TEST_ASSERT_EQUAL_UINT32(4, buf.earlyBodyLength());
+    TEST_ASSERT_EQUAL_STRING_LEN("body", buf.earlyBody(), 4);
+}
+
+void test_block_one_byte_over_the_maximum_runs_out_of_space() {
+    char block[GPRS_MAX_HEADER_SIZE + 8];
+    makeBlock(block, GPRS_MAX_HEADER_SIZE);
+
+    buf.reset();
+    size_t off = 0;
+    while (buf.space() > 0) {
+        size_t n = buf.space() < 64 ? buf.space() : 64;
+        TEST_ASSERT_FALSE(feed(block + off, n));
+        off += n;
+    }
+    // The last terminator byte never fits, so the headers never complete and cannot be parsed.
+    TEST_ASSERT_EQUAL_UINT32(GPRS_MAX_HEADER_SIZE - 1, off);
+    TEST_ASSERT_FALSE(buf.isComplete());
+    HttpResponseHead head;
+    TEST_ASSERT_FALSE(buf.parseResponseHeaders(head));
+
+    buf.reset();
+    TEST_ASSERT_TRUE(buf.isEmpty());
+    TEST_ASSERT_EQUAL_UINT32(GPRS_MAX_HEADER_SIZE - 1, buf.space());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_terminator_is_found_at_every_split_point);
+    RUN_TEST(test_byte_by_byte_completes_on_the_last_terminator_byte);
+    RUN_TEST(test_overlapping_partial_terminator_is_not_missed);
+    RUN_TEST(test_blank_line_inside_the_body_stays_in_the_body);
+    RUN_TEST(test_header_names_match_in_any_case);
+    RUN_TEST(test_folded_headers_are_joined_to_the_header_they_continue);
+    RUN_TEST(test_http10_keep_alive_only_when_asked);
+    RUN_TEST(test_bad_or_incomplete_status_line_is_rejected);
+    RUN_TEST(test_validator_that_does_not_fit_is_dropped);
+    RUN_TEST(test_block_of_exactly_the_maximum_size_is_accepted);
+    RUN_TEST(test_block_one_byte_over_the_maximum_runs_out_of_space);
+    return UNITY_END();
+}
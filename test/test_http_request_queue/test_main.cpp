@@ -0,0 +1,298 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `HttpRequestQueue`: GET coalescing, eviction, the retire observer that lets the caller
+ *        free per-request state for requests that will never get a reply, and the in-flight slot through a
+ *        failover (requeue at the head, merge into a newer queued GET, sequence number kept, slot released).
+ */
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "HttpRequestQueue.h"
+
+static std::vector<uint16_t> retired;
+
+void setUp() { retired.clear(); }
+void tearDown() {}
+
+/**
+ * @brief Queue with its retire observer recording into `retired`.
+ */
+struct ObservedQueue : HttpRequestQueue {
+    ObservedQueue() {
+        setRetireObserver([](uint16_t tag) { retired.push_back(tag); });
+    }
+};
+
+/**
+ * @brief A callback that records which caller it belongs to.
+ */
+static HttpResponseCallback markCallback(int* calledBy, int who) {
+    return [calledBy, who](JsonDocument&) -> bool {
+        *calledBy = who;
+        return true;
+    };
+}
+
+static bool pushGet(HttpRequestQueue& q, const char* url, uint16_t tag,
+                    HttpRequestPriority prio = HttpRequestPriority::NORMAL, const HttpResponseCallback& cb = nullptr) {
+    return q.push(url, "GET", "T", nullptr, cb, true, prio, 0, tag);
+}
+
+void test_coalesced_get_runs_the_newer_callback_and_retires_the_older() {
+    ObservedQueue q;
+    int calledBy = 0;
+    TEST_ASSERT_TRUE(pushGet(q, "http://h/a", 11, HttpRequestPriority::NORMAL, markCallback(&calledBy, 1)));
+    TEST_ASSERT_TRUE(pushGet(q, "http://h/a", 12, HttpRequestPriority::NORMAL, markCallback(&calledBy, 2)));
+
+    TEST_ASSERT_EQUAL_UINT8(1, q.size());
+    TEST_ASSERT_EQUAL_UINT32(1, q.getStats().coalesced);
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(11, retired[0]);
+
+    HttpRequestDescriptor* d = q.peek();
+    TEST_ASSERT_NOT_NULL(d);
+    TEST_ASSERT_EQUAL_UINT16(12, d->tag);
+    JsonDocument doc;
+    d->cb(doc);
+    TEST_ASSERT_EQUAL_INT(2, calledBy);
+}
+
+void test_coalescing_promotes_to_the_more_urgent_priority() {
+    ObservedQueue q;
+    pushGet(q, "http://h/bg", 1, HttpRequestPriority::BACKGROUND);
+    pushGet(q, "http://h/n", 2, HttpRequestPriority::NORMAL);
+    pushGet(q, "http://h/bg", 3, HttpRequestPriority::URGENT);
+
+    HttpRequestDescriptor* d = q.peek();
+    TEST_ASSERT_EQUAL_STRING("http://h/bg", d->url);
+    TEST_ASSERT_EQUAL_UINT16(3, d->tag);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)HttpRequestPriority::URGENT, (uint8_t)d->priority);
+    q.pop(0, true);
+    TEST_ASSERT_EQUAL_STRING("http://h/n", q.peek()->url);
+}
+
+void test_posts_are_never_coalesced() {
+    ObservedQueue q;
+    q.push("http://h/p", "POST", "T", "{}", nullptr, true, HttpRequestPriority::NORMAL, 0, 1);
+    q.push("http://h/p", "POST", "T", "{}", nullptr, true, HttpRequestPriority::NORMAL, 0, 2);
+    TEST_ASSERT_EQUAL_UINT8(2, q.size());
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+}
+
+void test_eviction_retires_the_evicted_request() {
+    ObservedQueue q;
+    char url[32];
+    for (uint16_t i = 0; i < HTTP_REQUEST_QUEUE_CAPACITY; ++i) {
+        snprintf(url, sizeof(url), "http://h/%u", (unsigned)i);
+        TEST_ASSERT_TRUE(pushGet(q, url, 100 + i, HttpRequestPriority::BACKGROUND));
+    }
+    TEST_ASSERT_TRUE(pushGet(q, "http://h/urgent", 7, HttpRequestPriority::URGENT));
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(100 + HTTP_REQUEST_QUEUE_CAPACITY - 1, retired[0]); // Newest of the least urgent level.
+
+    // Nothing less urgent left to evict: the new request is rejected, and reported only through the return value.
+    TEST_ASSERT_FALSE(pushGet(q, "http://h/bg", 8, HttpRequestPriority::BACKGROUND));
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+}
+
+void test_refused_dispatch_and_clear_retire_their_requests() {
+    ObservedQueue q;
+    pushGet(q, "http://h/a", 1);
+    pushGet(q, "http://h/b", 2);
+    pushGet(q, "http://h/c", 3);
+    q.pop(0, false);
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(1, retired[0]);
+
+    q.pop(0, true); // "b" is in flight and kept by clear().
+    q.clear();
+    TEST_ASSERT_EQUAL_UINT32(2, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(3, retired[1]);
+    TEST_ASSERT_NOT_NULL(q.inFlight());
+    TEST_ASSERT_EQUAL_UINT16(2, q.inFlight()->tag);
+}
+
+void test_in_flight_request_is_retired_only_if_unanswered() {
+    ObservedQueue q;
+    pushGet(q, "http://h/a", 1);
+    pushGet(q, "http://h/b", 2);
+    q.pop(0, true);
+    q.completeInFlight(true);
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+
+    q.pop(0, true);
+    q.completeInFlight(false);
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(2, retired[0]);
+    TEST_ASSERT_NULL(q.inFlight());
+}
+
+void test_untagged_requests_are_not_reported() {
+    ObservedQueue q;
+    pushGet(q, "http://h/a", 0);
+    pushGet(q, "http://h/a", 0);
+    q.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+}
+
+static bool pushPost(HttpRequestQueue& q, const char* url, uint16_t tag, unsigned long nowMs = 0,
+                     const char* payload = "{}") {
+    return q.push(url, "POST", "T", payload, nullptr, true, HttpRequestPriority::NORMAL, nowMs, tag);
+}
+
+void test_requeued_request_keeps_its_seq_and_goes_back_to_the_head() {
+    ObservedQueue q;
+    pushPost(q, "http://h/status", 1, 100);
+    pushPost(q, "http://h/later", 2, 200);
+    uint32_t seq = q.peek()->seq;
+    q.pop(300, true);
+
+    // The link is lost mid-request: the facade requeues it for the other interface.
+    TEST_ASSERT_TRUE(q.requeueInFlight());
+    TEST_ASSERT_NULL(q.inFlight());
+    HttpRequestDescriptor* d = q.peek();
+    TEST_ASSERT_EQUAL_STRING("http://h/status", d->url);       // Ahead of the request queued after it.
+    TEST_ASSERT_EQUAL_UINT32(seq, d->seq);                      // Same idempotency key on the new interface.
+    TEST_ASSERT_EQUAL_UINT32(100, d->enqueuedAtMs);             // Wait statistics include the failed attempt.
+    TEST_ASSERT_EQUAL_UINT8(1, d->reissues);
+    TEST_ASSERT_EQUAL_UINT16(1, d->tag);
+    TEST_ASSERT_EQUAL_UINT32(1, q.getStats().requeued);
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+
+    q.pop(400, true);
+    TEST_ASSERT_EQUAL_UINT32(seq, q.inFlight()->seq);
+    TEST_ASSERT_EQUAL_UINT32(300, q.getStats().maxWaitMs);
+    // A later request still gets a fresh number.
+    pushPost(q, "http://h/new", 3);
+    TEST_ASSERT_TRUE(q.peek()->seq != seq);
+}
+
+void test_requeued_get_merges_into_a_newer_queued_copy() {
+    ObservedQueue q;
+    int calledBy = 0;
+    pushGet(q, "http://h/overrides", 1, HttpRequestPriority::NORMAL, markCallback(&calledBy, 1));
+    q.pop(0, true);
+    // The same poll is queued again while the first is still out.
+    pushGet(q, "http://h/overrides", 2, HttpRequestPriority::NORMAL, markCallback(&calledBy, 2));
+    TEST_ASSERT_EQUAL_UINT8(1, q.size());
+
+    TEST_ASSERT_TRUE(q.requeueInFlight());
+    TEST_ASSERT_EQUAL_UINT8(1, q.size());                        // Merged, not queued twice.
+    TEST_ASSERT_EQUAL_UINT32(1, q.getStats().coalesced);
+    TEST_ASSERT_EQUAL_UINT32(0, q.getStats().requeued);
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());                 // The in-flight copy's callback will never run.
+    TEST_ASSERT_EQUAL_UINT16(1, retired[0]);
+    TEST_ASSERT_NULL(q.inFlight());
+
+    HttpRequestDescriptor* d = q.peek();
+    TEST_ASSERT_EQUAL_UINT16(2, d->tag);
+    JsonDocument doc;
+    d->cb(doc);
+    TEST_ASSERT_EQUAL_INT(2, calledBy);
+}
+
+void test_request_is_dropped_after_its_last_reissue() {
+    ObservedQueue q;
+    pushPost(q, "http://h/status", 5);
+    uint32_t seq = q.peek()->seq;
+    for (uint8_t i = 0; i < HTTP_REQUEST_MAX_REISSUES; ++i) {
+        q.pop(0, true);
+        TEST_ASSERT_TRUE(q.requeueInFlight());
+        TEST_ASSERT_EQUAL_UINT32(seq, q.peek()->seq);
+    }
+    q.pop(0, true);
+    TEST_ASSERT_FALSE(q.requeueInFlight());
+    TEST_ASSERT_TRUE(q.isEmpty());
+    TEST_ASSERT_NULL(q.inFlight());
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(5, retired[0]);
+}
+
+void test_in_flight_request_holds_its_slot_until_completed() {
+    ObservedQueue q;
+    char url[32];
+    for (uint16_t i = 0; i < HTTP_REQUEST_QUEUE_CAPACITY; ++i) {
+        snprintf(url, sizeof(url), "http://h/%u", (unsigned)i);
+        pushPost(q, url, 10 + i);
+    }
+    q.pop(0, true);
+    TEST_ASSERT_EQUAL_UINT8(HTTP_REQUEST_QUEUE_CAPACITY - 1, q.size());
+    // The in-flight request still owns its slot: with no lower level to evict, a new request does not fit.
+    TEST_ASSERT_FALSE(pushPost(q, "http://h/x", 99));
+
+    q.completeInFlight(true);
+    TEST_ASSERT_NULL(q.inFlight());
+    TEST_ASSERT_TRUE(pushPost(q, "http://h/x", 99));
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+
+    // Completing twice, or with nothing in flight, is harmless.
+    q.completeInFlight(true);
+    q.completeInFlight(false);
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+    TEST_ASSERT_EQUAL_UINT8(HTTP_REQUEST_QUEUE_CAPACITY, q.size());
+}
+
+void test_completing_a_bulk_request_frees_the_bulk_buffer() {
+    ObservedQueue q;
+    std::string bulk(HTTP_REQUEST_PAYLOAD_MAX_LEN + 10, 'x');
+    TEST_ASSERT_TRUE(pushPost(q, "http://h/outbox", 1, 0, bulk.c_str()));
+    TEST_ASSERT_FALSE(pushPost(q, "http://h/outbox", 2, 0, bulk.c_str())); // One bulk body at a time.
+    q.pop(0, true);
+    TEST_ASSERT_EQUAL_STRING(bulk.c_str(), q.payloadOf(*q.inFlight()));
+    TEST_ASSERT_FALSE(pushPost(q, "http://h/outbox", 3, 0, bulk.c_str())); // Still needed while in flight.
+
+    // Requeued and dispatched again on the other interface, the body is still there.
+    TEST_ASSERT_TRUE(q.requeueInFlight());
+    q.pop(0, true);
+    TEST_ASSERT_EQUAL_STRING(bulk.c_str(), q.payloadOf(*q.inFlight()));
+
+    q.completeInFlight(true);
+    TEST_ASSERT_TRUE(pushPost(q, "http://h/outbox", 4, 0, bulk.c_str()));
+}
+
+void test_urgent_bulk_request_evicts_a_less_urgent_queued_bulk() {
+    ObservedQueue q;
+    std::string bulk(HTTP_REQUEST_PAYLOAD_MAX_LEN + 10, 'x');
+    std::string urgent(HTTP_REQUEST_PAYLOAD_MAX_LEN + 10, 'u');
+    TEST_ASSERT_TRUE(q.push("http://h/outbox", "POST", "T", bulk.c_str(), nullptr, true,
+                            HttpRequestPriority::BACKGROUND, 0, 1));
+    TEST_ASSERT_TRUE(pushPost(q, "http://h/x", 2));
+    // Equally urgent: the queued holder keeps the buffer.
+    TEST_ASSERT_FALSE(q.push("http://h/outbox", "POST", "T", bulk.c_str(), nullptr, true,
+                             HttpRequestPriority::BACKGROUND, 0, 3));
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+
+    TEST_ASSERT_TRUE(q.push("http://h/relay", "POST", "T", urgent.c_str(), nullptr, true,
+                            HttpRequestPriority::URGENT, 0, 4));
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(1, retired[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, q.size());
+
+    q.pop(0, true);
+    TEST_ASSERT_EQUAL_UINT16(4, q.inFlight()->tag);
+    TEST_ASSERT_EQUAL_STRING(urgent.c_str(), q.payloadOf(*q.inFlight()));
+    // The in-flight holder is never evicted, however urgent the newcomer.
+    TEST_ASSERT_FALSE(q.push("http://h/relay", "POST", "T", urgent.c_str(), nullptr, true,
+                             HttpRequestPriority::URGENT, 0, 5));
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    q.pop(0, true);
+    TEST_ASSERT_EQUAL_UINT16(2, q.inFlight()->tag); // The small POST was left alone.
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_coalesced_get_runs_the_newer_callback_and_retires_the_older);
+    RUN_TEST(test_coalescing_promotes_to_the_more_urgent_priority);
+    RUN_TEST(test_posts_are_never_coalesced);
+    RUN_TEST(test_eviction_retires_the_evicted_request);
+    RUN_TEST(test_refused_dispatch_and_clear_retire_their_requests);
+    RUN_TEST(test_in_flight_request_is_retired_only_if_unanswered);
+    RUN_TEST(test_untagged_requests_are_not_reported);
+    RUN_TEST(test_requeued_request_keeps_its_seq_and_goes_back_to_the_head);
+    RUN_TEST(test_requeued_get_merges_into_a_newer_queued_copy);
+    RUN_TEST(test_request_is_dropped_after_its_last_reissue);
+    RUN_TEST(test_in_flight_request_holds_its_slot_until_completed);
+    RUN_TEST(test_completing_a_bulk_request_frees_the_bulk_buffer);
+    RUN_TEST(test_urgent_bulk_request_evicts_a_less_urgent_queued_bulk);
+    return UNITY_END();
+}
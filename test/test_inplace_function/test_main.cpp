@@ -0,0 +1,137 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `InplaceFunction`: calls, copies and moves construct and destroy each target exactly as
+ *        often as expected, a moved-from object is empty, and the capture budget of `HttpResponseCallback` is
+ *        enforced at compile time (checked through the `fits` trait, which the constructor's `static_assert`s share).
+ */
+#include <unity.h>
+#include "InplaceFunction.h"
+#include "HttpRequestQueue.h" // For HttpResponseCallback and HTTP_RESPONSE_CALLBACK_STORAGE.
+
+/**
+ * @brief Callable that counts its constructions, copies, moves and destructions.
+ */
+struct Tracked {
+    static int live, copies, moves;
+    int value;
+    explicit Tracked(int v) : value(v) { live++; }
+    Tracked(const Tracked& o) : value(o.value) { live++; copies++; }
+    Tracked(Tracked&& o) : value(o.value) { o.value = -1; live++; moves++; }
+    ~Tracked() { live--; }
+    int operator()(int x) { return value + x; }
+};
+int Tracked::live = 0;
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+
+typedef InplaceFunction<int(int), 16> Fn;
+
+void setUp() {
+    Tracked::live = 0;
+    Tracked::copies = 0;
+    Tracked::moves = 0;
+}
+void tearDown() {}
+
+void test_empty_and_called() {
+    Fn empty;
+    Fn null(nullptr);
+    TEST_ASSERT_FALSE(empty);
+    TEST_ASSERT_FALSE(null);
+
+    int calls = 0;
+    Fn counting = [&calls](int x) { return x + ++calls; }; // Captured state changes through a const call.
+    TEST_ASSERT_TRUE(counting);
+    TEST_ASSERT_EQUAL_INT(11, counting(10));
+    TEST_ASSERT_EQUAL_INT(12, counting(10));
+}
+
+void test_copy_keeps_both_and_destroys_each_once() {
+    {
+        Fn a = Tracked(5);
+        TEST_ASSERT_EQUAL_INT(1, Tracked::live);
+        TEST_ASSERT_EQUAL_INT(0, Tracked::copies); // The temporary was moved in.
+        Fn b(a);
+        TEST_ASSERT_EQUAL_INT(2, Tracked::live);
+        TEST_ASSERT_EQUAL_INT(1, Tracked::copies);
+        TEST_ASSERT_EQUAL_INT(7, a(2));
+        TEST_ASSERT_EQUAL_INT(7, b(2));
+
+        Fn c = Tracked(1);
+        c = a; // Destroys c's old target.
+        TEST_ASSERT_EQUAL_INT(3, Tracked::live);
+        const Fn& same = c;
+        c = same; // Self-assignment keeps the target.
+        TEST_ASSERT_EQUAL_INT(3, Tracked::live);
+        TEST_ASSERT_EQUAL_INT(5, c(0));
+    }
+    TEST_ASSERT_EQUAL_INT(0, Tracked::live);
+}
+
+void test_move_transfers_the_target_and_empties_the_source() {
+    {
+        Fn a = Tracked(3);
+        int copiesBefore = Tracked::copies;
+        Fn b(std::move(a));
+        TEST_ASSERT_FALSE(a);
+        TEST_ASSERT_TRUE(b);
+        TEST_ASSERT_EQUAL_INT(1, Tracked::live); // The source's target was destroyed, not left behind.
+        TEST_ASSERT_EQUAL_INT(copiesBefore, Tracked::copies);
+        TEST_ASSERT_EQUAL_INT(4, b(1));
+
+        Fn c = Tracked(9);
+        c = std::move(b); // Destroys c's old target, takes b's.
+        TEST_ASSERT_FALSE(b);
+        TEST_ASSERT_EQUAL_INT(1, Tracked::live);
+        TEST_ASSERT_EQUAL_INT(3, c(0));
+
+        Fn& alias = c;
+        c = std::move(alias); // Self-move keeps the target.
+        TEST_ASSERT_TRUE(c);
+        TEST_ASSERT_EQUAL_INT(1, Tracked::live);
+
+        Fn d;
+        d = std::move(a); // Moving an empty one leaves both empty.
+        TEST_ASSERT_FALSE(d);
+        TEST_ASSERT_EQUAL_INT(copiesBefore, Tracked::copies);
+    }
+    TEST_ASSERT_EQUAL_INT(0, Tracked::live);
+}
+
+void test_nullptr_assignment_destroys_the_target() {
+    Fn a = Tracked(1);
+    a = nullptr;
+    TEST_ASSERT_FALSE(a);
+    TEST_ASSERT_EQUAL_INT(0, Tracked::live);
+    a = nullptr; // Already empty.
+    TEST_ASSERT_FALSE(a);
+}
+
+void test_capture_budget_is_enforced_at_compile_time() {
+    struct Exact { uint8_t bytes[HTTP_RESPONSE_CALLBACK_STORAGE]; bool operator()(JsonDocument&) const { return true; } };
+    struct OneOver { uint8_t bytes[HTTP_RESPONSE_CALLBACK_STORAGE + 1]; bool operator()(JsonDocument&) const { return true; } };
+    static_assert(HttpResponseCallback::fits<Exact>::value, "A callable of exactly the budget must fit");
+    static_assert(!HttpResponseCallback::fits<OneOver>::value, "A callable over the budget must be rejected");
+
+    // The shapes the firmware uses: [this, id] in NetworkWorker, [this] in the facade, plain functions.
+    struct Owner { int x; } owner = {0};
+    Owner* self = &owner;
+    uint16_t id = 7;
+    auto relay = [self, id](JsonDocument&) -> bool { return self->x == id; };
+    static_assert(HttpResponseCallback::fits<decltype(relay)>::value, "The worker's relay lambda must fit");
+    static_assert(HttpResponseCallback::fits<bool (*)(JsonDocument&)>::value, "A function pointer must fit");
+
+    HttpResponseCallback cb = relay;
+    JsonDocument doc;
+    TEST_ASSERT_FALSE(cb(doc));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_and_called);
+    RUN_TEST(test_copy_keeps_both_and_destroys_each_once);
+    RUN_TEST(test_move_transfers_the_target_and_empties_the_source);
+    RUN_TEST(test_nullptr_assignment_destroys_the_target);
+    RUN_TEST(test_capture_budget_is_enforced_at_compile_time);
+    return UNITY_END();
+}
@@ -0,0 +1,137 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `LCDDisplay` against a recording `LiquidCrystal_I2C` stand-in: after every flush the
+ *        emulated panel shows the frame buffer, only changed cells reach the bus, DDRAM-order auto-increment saves
+ *        cursor moves, the per-call budget splits a repaint, and the byte counts in `Stats` match the bus.
+ */
+#include <unity.h>
+#include "LCDDisplay.h"
+
+static LCDDisplay* lcd;
+
+static const uint32_t SEND = LiquidCrystal_I2C::BYTES_PER_SEND;
+
+static void update(const char* dt, float temp) {
+    lcd->update(dt, temp, 60.0f, 800.0f, true, false, true, false, 18, 30, 50, 80, 100, 1000,
+                true, false, true, false);
+}
+
+/**
+ * @brief Asserts the emulated panel shows `expected`, one string per row.
+ */
+static void assertPanel(const char* r0, const char* r1, const char* r2, const char* r3) {
+    const char* expected[LCD_ROWS] = {r0, r1, r2, r3};
+    char row[LCD_COLS + 1], want[LCD_COLS + 1];
+    for (uint8_t r = 0; r < LCD_ROWS; ++r) {
+        snprintf(want, sizeof(want), "%-20s", expected[r]); // Blank-padded to the row width.
+        nativeLcdBus().row(r, LCD_COLS, row);
+        TEST_ASSERT_EQUAL_STRING(want, row);
+    }
+}
+
+void setUp() {
+    nativeSetMs(0);
+    lcd = new LCDDisplay();
+    lcd->begin();
+}
+
+void tearDown() { delete lcd; }
+
+void test_begin_shows_the_loading_message() {
+    assertPanel("Relay Ctrl Loading..", "", "", "");
+    TEST_ASSERT_FALSE(lcd->isDirty());
+}
+
+void test_clock_tick_sends_only_the_changed_digit() {
+    update("2026-10-16 12:00:00", 21.5f);
+    lcd->flushAll();
+    assertPanel("12:00:00 SD:OK NW:OF", "T:21.5C H:60% L:800", "Exh:Y Deh:N Blw:Y R4", "T:18-30 H:50-80");
+
+    nativeLcdBus().resetCounters();
+    LCDDisplay::Stats before = lcd->getStats();
+    update("2026-10-16 12:00:01", 21.5f);
+    assertPanel("12:00:01 SD:OK NW:OF", "T:21.5C H:60% L:800", "Exh:Y Deh:N Blw:Y R4", "T:18-30 H:50-80");
+    TEST_ASSERT_EQUAL_UINT32(1, nativeLcdBus().characters);
+    TEST_ASSERT_EQUAL_UINT32(1, nativeLcdBus().commands); // One cursor move.
+    TEST_ASSERT_EQUAL_UINT32(2 * SEND, nativeLcdBus().i2cBytes);
+    TEST_ASSERT_EQUAL_UINT32(nativeLcdBus().i2cBytes, lcd->getStats().i2cBytes - before.i2cBytes);
+}
+
+void test_nothing_is_sent_when_the_frame_is_redrawn_unchanged() {
+    update("2026-10-16 12:00:00", 21.5f);
+    lcd->flushAll();
+    nativeLcdBus().resetCounters();
+    update("2026-10-16 12:00:00", 21.5f);
+    TEST_ASSERT_EQUAL_UINT32(0, nativeLcdBus().i2cBytes);
+
+    lcd->message(0, 3, "X");
+    lcd->message(0, 3, "T:18-30 H:50-80"); // Changed and changed back before a flush.
+    TEST_ASSERT_TRUE(lcd->flush());
+    TEST_ASSERT_EQUAL_UINT32(0, nativeLcdBus().i2cBytes);
+}
+
+void test_adjacent_cells_in_ddram_order_share_one_cursor_move() {
+    update("2026-10-16 12:00:00", 21.5f);
+    lcd->flushAll();
+    nativeLcdBus().resetCounters();
+
+    // The end of row 0 (0x13) and the start of row 2 (0x14) are neighbours in DDRAM.
+    lcd->message(19, 0, "!");
+    lcd->message(0, 2, "e", false);
+    lcd->setCursor(1, 2);
+    lcd->print("xh:Y Deh:N Blw:Y R4");
+    lcd->flush();
+    TEST_ASSERT_EQUAL_UINT32(2, nativeLcdBus().characters);
+    TEST_ASSERT_EQUAL_UINT32(1, nativeLcdBus().commands);
+    TEST_ASSERT_EQUAL_UINT32(3 * SEND, nativeLcdBus().i2cBytes);
+    assertPanel("12:00:00 SD:OK NW:O!", "T:21.5C H:60% L:800", "exh:Y Deh:N Blw:Y R4", "T:18-30 H:50-80");
+}
+
+void test_repaint_is_split_by_the_budget_and_every_byte_is_counted() {
+    lcd->clear();
+    lcd->flushAll();
+    nativeLcdBus().resetCounters();
+    uint32_t bytesBefore = lcd->getStats().i2cBytes;
+
+    update("2026-10-16 12:00:00", 21.5f); // Runs the first flush() with the default budget.
+    int calls = 1;
+    while (lcd->isDirty()) {
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(LCD_FLUSH_BUDGET_US, lcd->getStats().lastBusUs);
+        lcd->flush();
+        calls++;
+        TEST_ASSERT_LESS_THAN(20, calls);
+    }
+    TEST_ASSERT_GREATER_THAN(1, calls);
+    TEST_ASSERT_EQUAL_UINT32(calls - 1, lcd->getStats().deferred);
+    assertPanel("12:00:00 SD:OK NW:OF", "T:21.5C H:60% L:800", "Exh:Y Deh:N Blw:Y R4", "T:18-30 H:50-80");
+    TEST_ASSERT_EQUAL_UINT32(nativeLcdBus().i2cBytes, lcd->getStats().i2cBytes - bytesBefore);
+    TEST_ASSERT_EQUAL_UINT32((nativeLcdBus().characters + nativeLcdBus().commands) * SEND, nativeLcdBus().i2cBytes);
+}
+
+void test_hardware_clear_is_used_when_cheaper_than_blanking() {
+    update("2026-10-16 12:00:00", 21.5f);
+    lcd->flushAll();
+    nativeLcdBus().resetCounters();
+    uint32_t bytesBefore = lcd->getStats().i2cBytes;
+
+    lcd->clear();
+    lcd->message(0, 1, "Restarting");
+    lcd->flushAll();
+    TEST_ASSERT_EQUAL_UINT32(1, nativeLcdBus().clears);
+    TEST_ASSERT_EQUAL_UINT32(1, lcd->getStats().clears);
+    assertPanel("", "Restarting", "", "");
+    // Clear, one cursor move to row 1 and the ten characters.
+    TEST_ASSERT_EQUAL_UINT32((1 + 1 + 10) * SEND, nativeLcdBus().i2cBytes);
+    TEST_ASSERT_EQUAL_UINT32(nativeLcdBus().i2cBytes, lcd->getStats().i2cBytes - bytesBefore);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_shows_the_loading_message);
+    RUN_TEST(test_clock_tick_sends_only_the_changed_digit);
+    RUN_TEST(test_nothing_is_sent_when_the_frame_is_redrawn_unchanged);
+    RUN_TEST(test_adjacent_cells_in_ddram_order_share_one_cursor_move);
+    RUN_TEST(test_repaint_is_split_by_the_budget_and_every_byte_is_counted);
+    RUN_TEST(test_hardware_clear_is_used_when_cheaper_than_blanking);
+    return UNITY_END();
+}
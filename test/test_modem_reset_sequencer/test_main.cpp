@@ -0,0 +1,290 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `ModemResetSequencer` against a scripted SIM800: soft reset, the default hard reset (wait
+ *        and restart, no pins), the pin sequence and its hold times, an unresponsive modem, and SIM PIN unlock.
+ *
+ * Each loop pass runs `AtCommandEngine::poll()` and `update()` as `GPRSManager::updateFSM()` does, then advances
+ * the virtual clock by 1 ms. A call that slept (`delay()`) or waited on the UART would move the virtual clock
+ * itself, so the longest call is measured in virtual time (must be 0) as well as in real time.
+ */
+#include <unity.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <deque>
+#include "ModemResetSequencer.h"
+
+typedef std::chrono::steady_clock Clock;
+typedef ModemResetSequencer::Outcome Outcome;
+typedef ModemResetSequencer::Kind Kind;
+
+/**
+ * @brief SIM800 stand-in: answers each complete "AT..." line from a reply table, reboots on `AT+CFUN=1,1` and is
+ *        silent while booting or "dead".
+ */
+class ScriptedModem : public Stream {
+public:
+    int available() override { return (int)rx.size(); }
+    int read() override {
+        if (rx.empty()) return -1;
+        int c = (uint8_t)rx.front();
+        rx.pop_front();
+        return c;
+    }
+    int peek() override { return rx.empty() ? -1 : (uint8_t)rx.front(); }
+    size_t write(uint8_t c) override {
+        _line += (char)c;
+        if (c == '\n') {
+            std::string line = _line.substr(0, _line.size() - 2); // Without "\r\n".
+            _line.clear();
+            sent.push_back(line);
+            sentAtMs.push_back(millis());
+            answer(line.substr(2));
+        }
+        return 1;
+    }
+    using Print::write;
+
+    bool silent() const { return nativeNowUs() < silentUntilUs; }
+
+    std::map<std::string, std::string> replies; ///< Reply to each command (text after "AT").
+    std::string acceptedPin = "1234";           ///< PIN that unlocks the SIM.
+    unsigned long bootMs = 3000;                ///< Time the modem is silent after `AT+CFUN=1,1`.
+    int64_t silentUntilUs = 0;                  ///< The modem answers nothing before this time.
+    std::deque<char> rx;                        ///< Bytes not yet read by the engine.
+    std::vector<std::string> sent;              ///< Every command line received.
+    std::vector<unsigned long> sentAtMs;        ///< When each was received.
+
+private:
+    void answer(const std::string& command) {
+        if (silent()) return;
+        std::string reply;
+        if (command.compare(0, 7, "+CPIN=\"") == 0) {
+            bool ok = command == "+CPIN=\"" + acceptedPin + "\"";
+            reply = ok ? "\r\nOK\r\n" : "\r\n+CME ERROR: 16\r\n";
+            if (ok) replies["+CPIN?"] = "\r\n+CPIN: READY\r\n\r\nOK\r\n";
+        } else if (replies.count(command)) {
+            reply = replies[command];
+        } else {
+            reply = "\r\nERROR\r\n";
+        }
+        rx.insert(rx.end(), reply.begin(), reply.end());
+        if (command == "+CFUN=1,1") silentUntilUs = nativeNowUs() + (int64_t)bootMs * 1000;
+    }
+
+    std::string _line;
+};
+
+/**
+ * @brief One GPIO write seen by the driver loop.
+ */
+struct PinEdge {
+    int pin;
+    int level;
+    unsigned long atMs;
+};
+
+static ScriptedModem* modem;
+static AtCommandEngine* engine;
+static ModemResetSequencer* sequencer;
+static std::vector<PinEdge> edges;
+static int64_t maxVirtualCostUs;
+static long maxRealCostUs;
+static const int RESET_PINS[] = {MODEM_POWER_ON, GSM_PWR, GSM_RST};
+
+void setUp() {
+    nativeSetMs(1000);
+    for (int pin : RESET_PINS) nativePin(pin) = NativePinState();
+    modem = new ScriptedModem();
+    modem->replies[""] = "\r\nOK\r\n";
+    modem->replies["+CFUN=1,1"] = "\r\nOK\r\n";
+    modem->replies["E0"] = "\r\nOK\r\n";
+    modem->replies["+CMEE=0"] = "\r\nOK\r\n";
+    modem->replies["I"] = "\r\nSIM800 R14.18\r\n\r\nOK\r\n";
+    modem->replies["+CPIN?"] = "\r\n+CPIN: READY\r\n\r\nOK\r\n";
+    modem->replies["+CIPSSL=1"] = "\r\nOK\r\n";
+    engine = new AtCommandEngine(*modem);
+    sequencer = new ModemResetSequencer(*engine);
+    edges.clear();
+    maxVirtualCostUs = 0;
+    maxRealCostUs = 0;
+}
+
+void tearDown() {
+    delete sequencer;
+    delete engine;
+    delete modem;
+}
+
+/**
+ * @brief Runs the reset like `updateFSM()` until it ends or `limitMs` passes, recording pin writes and call costs.
+ */
+static Outcome run(Kind kind, const char* simPin = "", unsigned long limitMs = 120000) {
+    uint32_t writes[3] = {0, 0, 0};
+    unsigned long start = millis();
+    sequencer->begin(kind, simPin, start);
+    while (millis() - start < limitMs) {
+        int64_t before = nativeNowUs();
+        Clock::time_point realBefore = Clock::now();
+        engine->poll(millis());
+        Outcome outcome = sequencer->update(millis());
+        long realUs = (long)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - realBefore).count();
+        if (nativeNowUs() - before > maxVirtualCostUs) maxVirtualCostUs = nativeNowUs() - before;
+        if (realUs > maxRealCostUs) maxRealCostUs = realUs;
+
+        for (int i = 0; i < 3; ++i) {
+            const NativePinState& p = nativePin(RESET_PINS[i]);
+            if (p.writes != writes[i]) {
+                writes[i] = p.writes;
+                edges.push_back({RESET_PINS[i], p.level, (unsigned long)(p.changedAtUs / 1000)});
+            }
+        }
+        if (outcome != Outcome::RUNNING) return outcome;
+        nativeAdvanceMs(1);
+    }
+    return Outcome::RUNNING;
+}
+
+static int indexOf(const char* command, size_t from = 0) {
+    for (size_t i = from; i < modem->sent.size(); ++i) {
+        if (modem->sent[i] == command) return (int)i;
+    }
+    return -1;
+}
+
+static void assertNeverBlocked() {
+    char summary[96];
+    snprintf(summary, sizeof(summary), "longest update: %lld us virtual, %ld us real",
+             (long long)maxVirtualCostUs, maxRealCostUs);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_EQUAL_INT(0, (int)maxVirtualCostUs);
+    TEST_ASSERT_LESS_THAN((long)LOOP_PROFILER_STAGE_BUDGET_US, maxRealCostUs);
+}
+
+void test_soft_reset_reaches_ready_without_blocking() {
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(Outcome::READY == run(Kind::SOFT));
+    assertNeverBlocked();
+    TEST_ASSERT_TRUE(sequencer->modemAnswered());
+
+    const char* expected[] = {"AT", "AT+CFUN=1,1", "AT", "ATE0", "AT+CMEE=0", "ATI", "AT+CPIN?", "AT+CIPSSL=1"};
+    TEST_ASSERT_EQUAL_UINT32(sizeof(expected) / sizeof(expected[0]), modem->sent.size());
+    for (size_t i = 0; i < modem->sent.size(); ++i) TEST_ASSERT_EQUAL_STRING(expected[i], modem->sent[i].c_str());
+    // The probe after the reboot waits out the boot time.
+    TEST_ASSERT_GREATER_OR_EQUAL(start + GPRS_MODEM_SOFT_RESET_BOOT_MS, modem->sentAtMs[2]);
+    TEST_ASSERT_EQUAL_UINT32(0, edges.size());
+}
+
+void test_soft_reset_fails_at_once_when_the_modem_is_silent() {
+    modem->silentUntilUs = INT64_MAX;
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(Outcome::FAILED == run(Kind::SOFT));
+    assertNeverBlocked();
+    TEST_ASSERT_FALSE(sequencer->modemAnswered());
+    TEST_ASSERT_EQUAL_INT(-1, indexOf("AT+CFUN=1,1"));
+    TEST_ASSERT_UINT32_WITHIN(AT_DEFAULT_TIMEOUT_MS, start + GPRS_MODEM_PROBE_TIMEOUT_MS, millis());
+}
+
+void test_default_hard_reset_waits_then_restarts_without_touching_pins() {
+    // Until the pin sequence is verified on the board, a hard reset keeps its previous effective behavior.
+    TEST_ASSERT_FALSE(GPRS_MODEM_HARD_RESET_PINS);
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(Outcome::READY == run(Kind::WAIT_AND_RESTART));
+    assertNeverBlocked();
+
+    TEST_ASSERT_EQUAL_UINT32(0, edges.size());
+    for (int pin : RESET_PINS) TEST_ASSERT_EQUAL_UINT32(0, nativePin(pin).writes);
+    int cfun = indexOf("AT+CFUN=1,1");
+    TEST_ASSERT_EQUAL_INT(1, cfun);
+    TEST_ASSERT_GREATER_OR_EQUAL(start + GPRS_MODEM_POWER_CYCLE_DELAY_MS, modem->sentAtMs[0]);
+    TEST_ASSERT_GREATER_OR_EQUAL(modem->sentAtMs[cfun] + GPRS_MODEM_SOFT_RESET_BOOT_MS, modem->sentAtMs[cfun + 1]);
+}
+
+void test_default_hard_reset_keeps_probing_a_modem_silent_before_the_restart() {
+    // Silent through the wait and the first probes; answers 2 s into probing. No CFUN is sent to a silent modem.
+    modem->silentUntilUs = nativeNowUs() + (int64_t)(GPRS_MODEM_POWER_CYCLE_DELAY_MS + 2000) * 1000;
+    TEST_ASSERT_TRUE(Outcome::READY == run(Kind::WAIT_AND_RESTART));
+    assertNeverBlocked();
+    TEST_ASSERT_EQUAL_INT(-1, indexOf("AT+CFUN=1,1"));
+    TEST_ASSERT_TRUE(sequencer->modemAnswered());
+}
+
+void test_pin_sequence_drives_each_pin_for_its_hold_time() {
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(Outcome::READY == run(Kind::PIN_SEQUENCE));
+    assertNeverBlocked();
+
+    const PinEdge expected[] = {
+        {MODEM_POWER_ON, LOW, 0},   {MODEM_POWER_ON, HIGH, 500}, {GSM_PWR, HIGH, 1000}, {GSM_PWR, LOW, 100},
+        {GSM_PWR, HIGH, 1200},      {GSM_RST, LOW, 2000},        {GSM_RST, HIGH, GPRS_MODEM_RESET_PULSE_MS},
+    };
+    const size_t count = sizeof(expected) / sizeof(expected[0]);
+    TEST_ASSERT_EQUAL_UINT32(count, edges.size());
+    unsigned long at = start;
+    for (size_t i = 0; i < count; ++i) {
+        at += expected[i].atMs; // Hold time of the previous step.
+        TEST_ASSERT_EQUAL_INT(expected[i].pin, edges[i].pin);
+        TEST_ASSERT_EQUAL_INT(expected[i].level, edges[i].level);
+        TEST_ASSERT_UINT32_WITHIN(1, at, edges[i].atMs);
+    }
+    // Last hold, then the boot wait, before the first probe; no CFUN after a power cycle.
+    TEST_ASSERT_GREATER_OR_EQUAL(at + 3000 + GPRS_MODEM_POWER_CYCLE_DELAY_MS, modem->sentAtMs[0]);
+    TEST_ASSERT_EQUAL_INT(-1, indexOf("AT+CFUN=1,1"));
+}
+
+void test_unresponsive_modem_fails_after_the_probe_timeout() {
+    modem->silentUntilUs = INT64_MAX;
+    unsigned long start = millis();
+    TEST_ASSERT_TRUE(Outcome::FAILED == run(Kind::WAIT_AND_RESTART));
+    assertNeverBlocked();
+
+    unsigned long probing = millis() - start - GPRS_MODEM_POWER_CYCLE_DELAY_MS;
+    TEST_ASSERT_GREATER_OR_EQUAL(GPRS_MODEM_RESPONSE_TIMEOUT_MS, probing);
+    TEST_ASSERT_LESS_THAN((long)(GPRS_MODEM_RESPONSE_TIMEOUT_MS + GPRS_MODEM_PROBE_INTERVAL_MS + AT_DEFAULT_TIMEOUT_MS), (long)probing);
+    // One probe before the restart, then one per interval (plus its own timeout).
+    uint32_t expectedProbes = 1 + GPRS_MODEM_RESPONSE_TIMEOUT_MS / (GPRS_MODEM_PROBE_INTERVAL_MS + GPRS_MODEM_PROBE_TIMEOUT_MS) + 1;
+    TEST_ASSERT_UINT32_WITHIN(1, expectedProbes, modem->sent.size());
+    for (const std::string& line : modem->sent) TEST_ASSERT_EQUAL_STRING("AT", line.c_str());
+}
+
+void test_locked_sim_is_unlocked_with_its_pin() {
+    modem->replies["+CPIN?"] = "\r\n+CPIN: SIM PIN\r\n\r\nOK\r\n";
+    TEST_ASSERT_TRUE(Outcome::READY == run(Kind::SOFT, "1234"));
+    assertNeverBlocked();
+
+    int unlock = indexOf("AT+CPIN=\"1234\"");
+    TEST_ASSERT_TRUE(unlock > 0);
+    int recheck = indexOf("AT+CPIN?", unlock);
+    TEST_ASSERT_TRUE(recheck > unlock);
+    TEST_ASSERT_GREATER_OR_EQUAL(modem->sentAtMs[unlock] + GPRS_SIM_UNLOCK_SETTLE_MS, modem->sentAtMs[recheck]);
+}
+
+void test_rejected_sim_pin_is_reported_apart_from_a_failed_reset() {
+    modem->replies["+CPIN?"] = "\r\n+CPIN: SIM PIN\r\n\r\nOK\r\n";
+    TEST_ASSERT_TRUE(Outcome::SIM_UNLOCK_FAILED == run(Kind::SOFT, "0000"));
+    assertNeverBlocked();
+    TEST_ASSERT_TRUE(sequencer->modemAnswered());
+    TEST_ASSERT_EQUAL_INT(-1, indexOf("AT+CIPSSL=1"));
+}
+
+void test_locked_sim_without_a_pin_fails_the_reset() {
+    modem->replies["+CPIN?"] = "\r\n+CPIN: SIM PIN\r\n\r\nOK\r\n";
+    TEST_ASSERT_TRUE(Outcome::FAILED == run(Kind::SOFT));
+    TEST_ASSERT_TRUE(sequencer->modemAnswered());
+    TEST_ASSERT_EQUAL_INT(-1, indexOf("AT+CPIN=\"1234\""));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_soft_reset_reaches_ready_without_blocking);
+    RUN_TEST(test_soft_reset_fails_at_once_when_the_modem_is_silent);
+    RUN_TEST(test_default_hard_reset_waits_then_restarts_without_touching_pins);
+    RUN_TEST(test_default_hard_reset_keeps_probing_a_modem_silent_before_the_restart);
+    RUN_TEST(test_pin_sequence_drives_each_pin_for_its_hold_time);
+    RUN_TEST(test_unresponsive_modem_fails_after_the_probe_timeout);
+    RUN_TEST(test_locked_sim_is_unlocked_with_its_pin);
+    RUN_TEST(test_rejected_sim_pin_is_reported_apart_from_a_failed_reset);
+    RUN_TEST(test_locked_sim_without_a_pin_fails_the_reset);
+    return UNITY_END();
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `NetworkFacade` over a real `WiFiManager` and the loopback HTTP server: queued requests go
+ *        out most urgent first, a repeat GET becomes conditional and its `304` reaches the observer with the
+ *        caller's tag, POSTs carry an idempotency key, a request that fails is retired with its tag, and the
+ *        push socket is the active interface's only while it is connected.
+ */
+#include <unity.h>
+#include <string>
+#include <vector>
+#include <Preferences.h>
+#include "NetworkFacade.h"
+#include "WiFiManager.h"
+#include "GPRSManager.h"
+
+static const uint8_t AP_BSSID[6] = {0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03};
+
+static std::vector<std::string> answered;
+static std::vector<uint16_t> retired;
+static HttpResponseInfo lastInfo;
+
+void setUp() {
+    nativeSetMs(1000);
+    nativeHttpServer().reset();
+    WiFi.nativeReset();
+    WiFi.nativeSetAccessPoint("greenhouse", "secret", 6, AP_BSSID);
+    nativePreferencesErase();
+    answered.clear();
+    retired.clear();
+    lastInfo = HttpResponseInfo();
+}
+void tearDown() {}
+
+/**
+ * @brief WiFi-only facade, connected, with its observers recording into the statics above.
+ */
+struct ConnectedFacade : NetworkFacade {
+    ConnectedFacade()
+        : NetworkFacade(NetworkPreference::WIFI_ONLY,
+                        std::unique_ptr<WiFiManager>(new WiFiManager("greenhouse", "secret", "token")),
+                        std::unique_ptr<GPRSManager>(), nullptr) {
+        setResponseObserver([](const char*, const HttpResponseInfo& info) { lastInfo = info; });
+        setRetireObserver([](uint16_t tag) { retired.push_back(tag); });
+        TEST_ASSERT_TRUE(connect());
+    }
+};
+
+static HttpResponseCallback recordAnswer(const char* who) {
+    return [who](JsonDocument&) -> bool {
+        answered.push_back(who);
+        return true;
+    };
+}
+
+/**
+ * @brief Drives the facade on the virtual clock until the queue and the request in flight are done.
+ */
+static void drain(NetworkFacade& facade) {
+    for (int i = 0; i < 5000 && facade.isHttpOperationActive(); ++i) {
+        facade.updateHttpOperations();
+        nativeAdvanceMs(10);
+    }
+    facade.updateHttpOperations(); // Releases the last request.
+    TEST_ASSERT_FALSE(facade.isHttpOperationActive());
+}
+
+static std::string okResponse(const char* extraHeaders = "") {
+    return std::string("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n") + extraHeaders + "\r\n{}";
+}
+
+void test_queued_requests_go_out_most_urgent_first() {
+    ConnectedFacade facade;
+    for (int i = 0; i < 4; ++i) nativeHttpServer().respond(okResponse());
+    // The first one starts at once on the idle link; the others wait behind it.
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/a", "GET", "A", nullptr, recordAnswer("a"), true,
+                                               HttpRequestPriority::NORMAL, 1));
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/b", "GET", "B", nullptr, recordAnswer("b"), true,
+                                               HttpRequestPriority::BACKGROUND, 2));
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/c", "GET", "C", nullptr, recordAnswer("c"), true,
+                                               HttpRequestPriority::NORMAL, 3));
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/d", "GET", "D", nullptr, recordAnswer("d"), true,
+                                               HttpRequestPriority::URGENT, 4));
+    drain(facade);
+
+    TEST_ASSERT_EQUAL_UINT32(4, answered.size());
+    TEST_ASSERT_EQUAL_STRING("a", answered[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("d", answered[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("c", answered[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("b", answered[3].c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+    TEST_ASSERT_EQUAL_UINT32(1, nativeHttpServer().connects);
+}
+
+void test_repeat_get_is_conditional_and_its_304_reaches_the_observer_with_the_tag() {
+    ConnectedFacade facade;
+    nativeHttpServer().respond(okResponse("ETag: \"c1\"\r\n"));
+    nativeHttpServer().respond("HTTP/1.1 304 Not Modified\r\n\r\n");
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/config", "GET", "Cfg", nullptr, recordAnswer("1"),
+                                               true, HttpRequestPriority::NORMAL, 21));
+    drain(facade);
+    TEST_ASSERT_EQUAL_UINT16(21, lastInfo.tag);
+
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/config", "GET", "Cfg", nullptr, recordAnswer("2"),
+                                               true, HttpRequestPriority::NORMAL, 22));
+    drain(facade);
+
+    TEST_ASSERT_EQUAL_UINT32(1, answered.size());
+    TEST_ASSERT_TRUE(lastInfo.notModified);
+    TEST_ASSERT_EQUAL_UINT16(22, lastInfo.tag);
+    TEST_ASSERT_EQUAL_UINT32(0, retired.size());
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[1].find("If-None-Match: \"c1\"\r\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(1, facade.getValidatorStats(millis()).conditionalSent);
+    TEST_ASSERT_EQUAL_UINT32(1, facade.getValidatorStats(millis()).notModified);
+}
+
+void test_post_carries_an_idempotency_key() {
+    ConnectedFacade facade;
+    nativeHttpServer().respond(okResponse());
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/data", "POST", "Data", "{\"t\":21.5}",
+                                               recordAnswer("post"), true, HttpRequestPriority::NORMAL, 5));
+    drain(facade);
+
+    TEST_ASSERT_EQUAL_UINT32(1, answered.size());
+    const std::string& request = nativeHttpServer().requests[0];
+    TEST_ASSERT_TRUE(request.find("POST /data HTTP/1.1\r\n") == 0);
+    TEST_ASSERT_TRUE(request.find("\r\nIdempotency-Key: ") != std::string::npos);
+    TEST_ASSERT_TRUE(request.find("\r\n\r\n{\"t\":21.5}") != std::string::npos);
+}
+
+void test_request_that_gets_no_answer_is_retired_with_its_tag() {
+    ConnectedFacade facade;
+    nativeHttpServer().respond("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+    TEST_ASSERT_TRUE(facade.enqueueHttpRequest("http://api.test/missing", "GET", "Missing", nullptr,
+                                               recordAnswer("missing"), true, HttpRequestPriority::NORMAL, 9));
+    drain(facade);
+
+    TEST_ASSERT_EQUAL_UINT32(0, answered.size());
+    TEST_ASSERT_EQUAL_UINT32(1, retired.size());
+    TEST_ASSERT_EQUAL_UINT16(9, retired[0]);
+}
+
+void test_push_socket_is_the_active_interfaces_only_while_connected() {
+    WiFiManager* wm = new WiFiManager("greenhouse", "secret", "token");
+    NetworkFacade facade(NetworkFacade::NetworkPreference::WIFI_ONLY, std::unique_ptr<WiFiManager>(wm),
+                         std::unique_ptr<GPRSManager>(), nullptr);
+    TEST_ASSERT_NULL(facade.getPushClient());
+
+    TEST_ASSERT_TRUE(facade.connect());
+    TEST_ASSERT_TRUE(facade.getPushClient() == wm->getPushClient());
+
+    WiFi.nativeDropLink(WIFI_REASON_BEACON_TIMEOUT);
+    TEST_ASSERT_NULL(facade.getPushClient());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_queued_requests_go_out_most_urgent_first);
+    RUN_TEST(test_repeat_get_is_conditional_and_its_304_reaches_the_observer_with_the_tag);
+    RUN_TEST(test_post_carries_an_idempotency_key);
+    RUN_TEST(test_request_that_gets_no_answer_is_retired_with_its_tag);
+    RUN_TEST(test_push_socket_is_the_active_interfaces_only_while_connected);
+    return UNITY_END();
+}
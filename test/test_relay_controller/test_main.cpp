@@ -0,0 +1,91 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `RelayController`: relays are active low on their pins, the threshold rules switch only on
+ *        a change, a bad reading turns a relay off, and a manual override holds until it expires on the clock.
+ */
+#include <unity.h>
+#include "RelayController.h"
+
+static LCDDisplay* lcd;
+static RelayController* relays;
+
+void setUp() {
+    nativeSetMs(1000);
+    lcd = new LCDDisplay();
+    relays = new RelayController(*lcd);
+    relays->begin();
+}
+void tearDown() {
+    delete relays;
+    delete lcd;
+}
+
+void test_begin_drives_every_relay_off_high() {
+    const int pins[4] = {RELAY_CH1, RELAY_CH2, RELAY_CH3, RELAY_CH4};
+    for (int i = 0; i < 4; ++i) {
+        TEST_ASSERT_EQUAL_INT(OUTPUT, nativePin(pins[i]).mode);
+        TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(pins[i]));
+    }
+    TEST_ASSERT_FALSE(relays->getR1());
+    TEST_ASSERT_FALSE(relays->getR4());
+}
+
+void test_humidity_out_of_range_turns_the_exhaust_on_low_and_writes_only_on_change() {
+    TEST_ASSERT_TRUE(relays->updateSingleRelayState(0, 90.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f));
+    TEST_ASSERT_TRUE(relays->getR1());
+    TEST_ASSERT_EQUAL_INT(LOW, digitalRead(RELAY_CH1));
+
+    uint32_t writes = nativePin(RELAY_CH1).writes;
+    TEST_ASSERT_FALSE(relays->updateSingleRelayState(0, 91.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f));
+    TEST_ASSERT_EQUAL_UINT32(writes, nativePin(RELAY_CH1).writes);
+
+    TEST_ASSERT_TRUE(relays->updateSingleRelayState(0, 60.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f));
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(RELAY_CH1));
+}
+
+void test_bad_readings_turn_relays_off() {
+    relays->updateSingleRelayState(1, 90.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f);
+    relays->updateSingleRelayState(2, 60.0f, 40.0f, 80.0f, 35.0f, 18.0f, 30.0f);
+    TEST_ASSERT_TRUE(relays->getR2());
+    TEST_ASSERT_TRUE(relays->getR3());
+
+    relays->updateSingleRelayState(1, -1.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f);
+    relays->updateSingleRelayState(2, 60.0f, 40.0f, 80.0f, -99.9f, 18.0f, 30.0f);
+    TEST_ASSERT_FALSE(relays->getR2());
+    TEST_ASSERT_FALSE(relays->getR3());
+}
+
+void test_manual_override_holds_until_it_expires() {
+    relays->setManualOverride(2, true, 60000);
+    TEST_ASSERT_TRUE(relays->getR3());
+    TEST_ASSERT_FALSE(relays->updateSingleRelayState(2, 60.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f));
+    TEST_ASSERT_TRUE(relays->getR3());
+
+    nativeAdvanceMs(60000);
+    TEST_ASSERT_TRUE(relays->updateSingleRelayState(2, 60.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f));
+    TEST_ASSERT_FALSE(relays->getR3());
+}
+
+void test_force_safe_state_turns_everything_off_and_cancels_overrides() {
+    relays->setManualOverride(0, true, 60000);
+    relays->setState(3, true);
+    relays->forceSafeState();
+    TEST_ASSERT_FALSE(relays->getR1());
+    TEST_ASSERT_FALSE(relays->getR4());
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(RELAY_CH1));
+    TEST_ASSERT_EQUAL_INT(HIGH, digitalRead(RELAY_CH4));
+
+    // The override is gone: in-range humidity keeps the exhaust off.
+    TEST_ASSERT_FALSE(relays->updateSingleRelayState(0, 60.0f, 40.0f, 80.0f, 25.0f, 18.0f, 30.0f));
+    TEST_ASSERT_FALSE(relays->getR1());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_drives_every_relay_off_high);
+    RUN_TEST(test_humidity_out_of_range_turns_the_exhaust_on_low_and_writes_only_on_change);
+    RUN_TEST(test_bad_readings_turn_relays_off);
+    RUN_TEST(test_manual_override_holds_until_it_expires);
+    RUN_TEST(test_force_safe_state_turns_everything_off_and_cancels_overrides);
+    return UNITY_END();
+}
@@ -0,0 +1,212 @@
+/**
+ * @file test_main.cpp
+ * @brief Host simulation of `RTCManager` on a virtual timer and an emulated DS3231: extrapolation from the timer
+ *        without I2C reads, reanchoring against a DS3231 that drifts from the timer, SNTP drift learning and the
+ *        stretched sync interval, adjusting on a network second edge, and a month of closed-loop syncing.
+ *
+ * The virtual timer is true time; network (SNTP) time is `BASE_EPOCH` seconds ahead of it. The DS3231 runs at
+ * `nativeDs3231().ppm` against it. Every timer read costs 1 us, so the edge waits in `RTCManager` terminate.
+ */
+#include <unity.h>
+#include <esp_timer.h>
+#include "RTCManager.h"
+
+static const uint32_t BASE_EPOCH = 1760000000UL; ///< Network time (local) at virtual time 0.
+
+static LCDDisplay* lcd;
+static RTCManager* rtc;
+
+/**
+ * @brief Network time now, in microseconds since 1970.
+ */
+static int64_t networkUs() { return (int64_t)BASE_EPOCH * 1000000LL + nativeNowUs(); }
+
+/**
+ * @brief The DS3231 minus network time, in microseconds.
+ */
+static int64_t rtcErrorUs() { return nativeDs3231().nowUs() - networkUs(); }
+
+/**
+ * @brief Hands the RTC manager an SNTP sample taken now, as `NetworkWorker` does.
+ */
+static bool applySntp() {
+    int64_t t = nativeNowUs();
+    return rtc->applyNetworkEpoch(BASE_EPOCH + (uint32_t)(t / 1000000LL), (t / 1000000LL) * 1000000LL);
+}
+
+static void advanceS(uint32_t s) { nativeAdvanceUs((int64_t)s * 1000000LL); }
+
+void setUp() {
+    nativeSetMs(5000);
+    nativeTimerReadCostUs() = 1;
+    nativeDs3231() = NativeDs3231();
+    nativeDs3231().set(BASE_EPOCH + 5); // Agrees with network time, on its second edge.
+    lcd = new LCDDisplay();
+    lcd->begin();
+    rtc = new RTCManager(*lcd);
+}
+
+void tearDown() {
+    delete rtc;
+    delete lcd;
+    nativeTimerReadCostUs() = 0;
+}
+
+void test_time_is_extrapolated_without_i2c() {
+    nativeAdvanceUs(300000);
+    TEST_ASSERT_TRUE(rtc->begin());
+    nativeAdvanceUs(500000); // Away from the edge the anchor was taken on.
+    nativeDs3231().resetCounters();
+
+    char buf[24], want[32];
+    for (int i = 0; i < 600; ++i) {
+        advanceS(1);
+        uint32_t chip = (uint32_t)(nativeDs3231().nowUs() / 1000000LL);
+        TEST_ASSERT_EQUAL_UINT32(chip, rtc->epoch());
+        DateTime dt(chip);
+        snprintf(want, sizeof(want), "%04d-%02d-%02d %02d:%02d:%02d", dt.year(), dt.month(), dt.day(), dt.hour(),
+                 dt.minute(), dt.second());
+        TEST_ASSERT_TRUE(rtc->formatInto(buf, sizeof(buf)));
+        TEST_ASSERT_EQUAL_STRING(want, buf);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, nativeDs3231().reads);
+}
+
+void test_reanchor_follows_a_ds3231_that_runs_fast_against_the_timer() {
+    nativeDs3231().ppm = 20.0;
+    rtc->begin();
+
+    uint32_t checks = 0, behind = 0;
+    int32_t largestCorrectionUs = 0;
+    for (uint32_t minute = 0; minute < 6 * 60; ++minute) {
+        // Loop passes do not land on whole seconds; vary the phase of the checks.
+        nativeAdvanceUs(60 * 1000000LL + (minute * 379 % 1000) * 1000LL);
+        if (rtc->reanchorIfDue()) {
+            int32_t c = rtc->getClockStats().lastCorrectionUs;
+            if (c > largestCorrectionUs) largestCorrectionUs = c;
+        }
+        nativeAdvanceUs(250000);
+        checks++;
+        int64_t diff = (int64_t)rtc->epoch() - nativeDs3231().nowUs() / 1000000LL;
+        TEST_ASSERT_TRUE(diff == 0 || diff == -1); // Never ahead; at most the lag not yet seen, behind.
+        if (diff != 0) behind++;
+    }
+    RTCManager::ClockStats cs = rtc->getClockStats();
+    char line[128];
+    snprintf(line, sizeof(line), "timer drift estimate %.2f ppm (true 20), %u corrections up to %ld us, %u/%u checks behind",
+             cs.driftPpm, (unsigned)cs.corrections, (long)largestCorrectionUs, (unsigned)behind, (unsigned)checks);
+    TEST_MESSAGE(line);
+    // A lag shows only when a read lands within it of an edge, so it grows to tens of ms before it is corrected.
+    TEST_ASSERT_GREATER_THAN(0, (long)cs.corrections);
+    TEST_ASSERT_LESS_THAN(200000L, (long)largestCorrectionUs);
+    TEST_ASSERT_LESS_THAN((long)checks / 10, (long)behind);
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, 20.0f, cs.driftPpm); // A lower bound that converges over hours.
+    TEST_ASSERT_TRUE(cs.driftPpm <= 20.5f);
+}
+
+void test_sntp_samples_learn_the_rtc_drift_and_stretch_the_interval() {
+    nativeDs3231().ppm = 2.0; // Runs fast against network time.
+    rtc->begin();
+    advanceS(10);
+    TEST_ASSERT_TRUE(rtc->isSyncDue(millis()));
+    TEST_ASSERT_FALSE(applySntp()); // In agreement: nothing to adjust; becomes the drift reference.
+    TEST_ASSERT_FALSE(rtc->isSyncDue(millis()));
+    TEST_ASSERT_EQUAL_UINT32(TIME_SYNC_INTERVAL, rtc->getSyncIntervalMs());
+
+    // Too soon after the reference to learn from: compared with the extrapolated clock, no edge search.
+    advanceS(3600);
+    nativeDs3231().resetCounters();
+    applySntp();
+    TEST_ASSERT_EQUAL_UINT32(0, nativeDs3231().reads);
+    TEST_ASSERT_FALSE(rtc->getSyncStats().driftKnown);
+
+    advanceS(RTC_DRIFT_MIN_SPAN_MS / 1000);
+    TEST_ASSERT_FALSE(applySntp()); // 2 ppm over 7 h is about 50 ms: still within the target.
+    RTCManager::SyncStats ss = rtc->getSyncStats();
+    TEST_ASSERT_TRUE(ss.driftKnown);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 2.0f, ss.driftPpm);
+    TEST_ASSERT_INT_WITHIN(5, -50, ss.lastOffsetMs);
+    TEST_ASSERT_EQUAL_UINT32(0, ss.adjustments);
+    // The interval leaves room for the error already accumulated: (500 - 50) ms at 2 ppm is 62.5 h.
+    TEST_ASSERT_UINT32_WITHIN(2 * 3600 * 1000UL, 225000000UL, rtc->getSyncIntervalMs());
+}
+
+void test_large_offset_is_corrected_on_the_network_second_edge() {
+    nativeDs3231().set(BASE_EPOCH + 2); // Three seconds behind.
+    rtc->begin();
+    nativeAdvanceUs(1234567);
+    nativeDs3231().resetCounters();
+
+    TEST_ASSERT_TRUE(applySntp());
+    TEST_ASSERT_EQUAL_UINT32(1, nativeDs3231().writes);
+    TEST_ASSERT_INT_WITHIN(2000, 0, (int)rtcErrorUs());            // Written on the edge, to within the spin.
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(networkUs() / 1000000LL), rtc->epoch());
+    RTCManager::SyncStats ss = rtc->getSyncStats();
+    TEST_ASSERT_INT_WITHIN(5, 3000, ss.lastOffsetMs);              // Network minus RTC before the write.
+    TEST_ASSERT_EQUAL_UINT32(1, ss.adjustments);
+
+    // The next sample agrees.
+    advanceS(60);
+    TEST_ASSERT_FALSE(applySntp());
+}
+
+void test_http_epoch_uses_the_coarse_threshold_unless_the_rtc_lost_power() {
+    nativeDs3231().lostPower = true;
+    nativeDs3231().set(BASE_EPOCH - 20 + 5);
+    rtc->begin();
+    advanceS(2);
+    // After a power loss any valid time is applied, however close.
+    TEST_ASSERT_TRUE(rtc->applyNetworkEpoch((uint32_t)(networkUs() / 1000000LL)));
+    TEST_ASSERT_EQUAL_UINT32(1, nativeDs3231().writes);
+
+    nativeDs3231().set(BASE_EPOCH + (uint32_t)(nativeNowUs() / 1000000LL) - 30);
+    rtc->reanchorIfDue(); // Not due yet: the extrapolated clock still says the adjusted time.
+    advanceS(RTC_REANCHOR_INTERVAL_MS / 1000);
+    TEST_ASSERT_TRUE(rtc->reanchorIfDue()); // Picks up the 30 s step.
+    TEST_ASSERT_FALSE(rtc->applyNetworkEpoch((uint32_t)(networkUs() / 1000000LL))); // 30 s: under the threshold.
+    nativeDs3231().set(BASE_EPOCH + (uint32_t)(nativeNowUs() / 1000000LL) - 90);
+    advanceS(RTC_REANCHOR_INTERVAL_MS / 1000);
+    rtc->reanchorIfDue();
+    TEST_ASSERT_TRUE(rtc->applyNetworkEpoch((uint32_t)(networkUs() / 1000000LL)));
+    TEST_ASSERT_FALSE(rtc->applyNetworkEpoch(1000)); // Not a plausible time.
+}
+
+void test_a_month_of_syncing_keeps_the_rtc_within_target() {
+    nativeDs3231().ppm = -3.0; // Runs slow.
+    rtc->begin();
+    int64_t worstUs = 0;
+    uint32_t syncs = 0;
+    for (uint32_t hour = 0; hour < 30 * 24; ++hour) {
+        for (uint32_t m = 0; m < TIME_SYNC_CHECK_INTERVAL_MS / RTC_REANCHOR_INTERVAL_MS; ++m) {
+            advanceS(60);
+            rtc->reanchorIfDue();
+        }
+        int64_t err = llabs(rtcErrorUs());
+        if (err > worstUs) worstUs = err;
+        if (rtc->isSyncDue(millis())) { // Asked every TIME_SYNC_CHECK_INTERVAL_MS, as the control loop does.
+            applySntp();
+            syncs++;
+        }
+    }
+    RTCManager::SyncStats ss = rtc->getSyncStats();
+    char line[128];
+    snprintf(line, sizeof(line), "30 days at -3 ppm: %u syncs, %u adjustments, worst error %ld ms, interval %lu h",
+             (unsigned)syncs, (unsigned)ss.adjustments, (long)(worstUs / 1000), ss.intervalMs / 3600000UL);
+    TEST_MESSAGE(line);
+    // A due sync can run up to one check interval late.
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(TIME_SYNC_TARGET_ERROR_MS * 1000UL + 3 * TIME_SYNC_CHECK_INTERVAL_MS / 1000UL,
+                                     (uint32_t)worstUs);
+    TEST_ASSERT_LESS_THAN(30, (long)syncs); // Fewer than daily once the drift is known.
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, -3.0f, ss.driftPpm);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_time_is_extrapolated_without_i2c);
+    RUN_TEST(test_reanchor_follows_a_ds3231_that_runs_fast_against_the_timer);
+    RUN_TEST(test_sntp_samples_learn_the_rtc_drift_and_stretch_the_interval);
+    RUN_TEST(test_large_offset_is_corrected_on_the_network_second_edge);
+    RUN_TEST(test_http_epoch_uses_the_coarse_threshold_unless_the_rtc_lost_power);
+    RUN_TEST(test_a_month_of_syncing_keeps_the_rtc_within_target);
+    return UNITY_END();
+}
@@ -0,0 +1,275 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for the `SDCardLogger` telemetry ring on a file-backed fake SD card (`test/stubs/FS.h`):
+ *        whole-sector writes, the durable/buffered boundary seen by `readRecords()`, restart from the checkpoint,
+ *        wrap over the oldest segment, recovery from a sector torn by a power cut, the CSV export, and a
+ *        million-record soak that reports the bytes written to the card per record.
+ *
+ * Records are logged one `LOOP_MS` apart on the virtual clock, as the control loop does, and tagged through the
+ * temperature so the records of each phase of a test can be told apart when read back.
+ */
+#include <unity.h>
+#include <vector>
+#include <RTClib.h>
+#include "SDCardLogger.h"
+
+static const uint32_t RECORDS_PER_SECTOR = TELEMETRY_SECTOR_SIZE / sizeof(TelemetryRecord);
+static const uint32_t RING_CAPACITY = (uint32_t)TELEMETRY_SEGMENT_COUNT * TELEMETRY_SEGMENT_RECORDS;
+static const uint32_t BASE_EPOCH = 1760000000UL;
+
+/// Records a full ring holds with the sector being filled empty: that sector's old records count as overwritten.
+static const uint32_t RING_HOLDS = RING_CAPACITY - RECORDS_PER_SECTOR;
+
+static SDCardLogger* logger;
+
+/**
+ * @brief Logs `count` records tagged with temperature `tag`, one `LOOP_MS` apart.
+ */
+static void logRecords(uint32_t count, float tag) {
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t epoch = BASE_EPOCH + (uint32_t)(millis() / 1000);
+        logger->logData(epoch, tag, 55.5f, 1234.5f, 18.0f, 28.0f, 40.0f, 80.0f, 100.0f, 5000.0f,
+                        i & 1, false, true, false);
+        nativeAdvanceMs(LOOP_MS);
+    }
+}
+
+/**
+ * @brief Simulates a reset: the logger and its RAM buffer are dropped, and a new one opens the log on the card.
+ */
+static void reboot() {
+    delete logger;
+    logger = new SDCardLogger(nullptr);
+    TEST_ASSERT_TRUE(logger->begin());
+}
+
+/**
+ * @brief Reads the log from `fromSeq` to its durable end through `readRecords()`, as `TelemetryOutbox` does.
+ */
+static void readAll(uint32_t fromSeq, std::vector<TelemetryRecord>& out) {
+    TelemetryRecord batch[TELEMETRY_OUTBOX_BATCH_RECORDS];
+    uint32_t seq = fromSeq, next;
+    for (;;) {
+        uint16_t n = logger->readRecords(seq, batch, TELEMETRY_OUTBOX_BATCH_RECORDS, next);
+        out.insert(out.end(), batch, batch + n);
+        if (next == seq) break;
+        seq = next;
+    }
+}
+
+/**
+ * @brief Checks that `recs` are consecutive from `firstSeq` and carry a valid CRC.
+ */
+static void assertConsecutive(const std::vector<TelemetryRecord>& recs, uint32_t firstSeq) {
+    for (size_t i = 0; i < recs.size(); ++i) {
+        TEST_ASSERT_TRUE(isTelemetryRecordValid(recs[i]));
+        TEST_ASSERT_EQUAL_UINT32(firstSeq + i, recs[i].seq);
+    }
+}
+
+void setUp() {
+    nativeSdWipe();
+    nativeSetMs(0);
+    logger = new SDCardLogger(nullptr);
+    TEST_ASSERT_TRUE(logger->begin());
+}
+
+void tearDown() {
+    delete logger;
+    logger = nullptr;
+}
+
+void test_records_are_written_as_whole_sectors_and_read_back_up_to_the_durable_end() {
+    nativeSd().resetCounters();
+    logRecords(100, 21.5f);
+
+    const SDCardLogger::TelemetryStats& st = logger->getTelemetryStats();
+    TEST_ASSERT_EQUAL_UINT32(100, st.recordsLogged);
+    TEST_ASSERT_EQUAL_UINT32(100 / RECORDS_PER_SECTOR, st.sectorWrites);
+    TEST_ASSERT_EQUAL_UINT32(st.sectorWrites * TELEMETRY_SECTOR_SIZE, st.bytesWritten);
+    // Each sector write is followed by one checkpoint slot, and nothing else reaches the card.
+    TEST_ASSERT_EQUAL_UINT32(st.sectorWrites * (TELEMETRY_SECTOR_SIZE + sizeof(TelemetryCheckpoint)),
+                             (uint32_t)nativeSd().bytesWritten);
+
+    // The last 4 records are still in the RAM sector buffer.
+    TEST_ASSERT_EQUAL_UINT32(97, logger->getDurableNextSeq());
+    std::vector<TelemetryRecord> recs;
+    readAll(1, recs);
+    TEST_ASSERT_EQUAL_UINT32(96, recs.size());
+    assertConsecutive(recs, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 21.5f, recs[0].temperature());
+    TEST_ASSERT_EQUAL_UINT32(BASE_EPOCH + 95 * LOOP_MS / 1000, recs[95].epoch);
+
+    TelemetryRecord batch[10];
+    uint32_t next;
+    TEST_ASSERT_EQUAL_UINT16(10, logger->readRecords(1, batch, 10, next));
+    TEST_ASSERT_EQUAL_UINT32(11, next);
+    TEST_ASSERT_EQUAL_UINT16(0, logger->readRecords(97, batch, 10, next));
+    TEST_ASSERT_EQUAL_UINT32(97, next);
+
+    TEST_ASSERT_TRUE(logger->flush()); // A partial sector, rewritten in place as it fills up.
+    TEST_ASSERT_EQUAL_UINT32(101, logger->getDurableNextSeq());
+    recs.clear();
+    readAll(97, recs);
+    TEST_ASSERT_EQUAL_UINT32(4, recs.size());
+    assertConsecutive(recs, 97);
+}
+
+void test_old_records_are_flushed_as_a_partial_sector() {
+    logRecords(3, 21.5f);
+    TEST_ASSERT_EQUAL_UINT32(0, logger->getTelemetryStats().sectorWrites);
+    nativeAdvanceMs(TELEMETRY_MAX_UNFLUSHED_MS);
+    logRecords(1, 21.5f);
+    TEST_ASSERT_EQUAL_UINT32(1, logger->getTelemetryStats().sectorWrites);
+    TEST_ASSERT_EQUAL_UINT32(5, logger->getDurableNextSeq());
+}
+
+void test_reboot_resumes_after_the_newest_record_from_the_checkpoint() {
+    logRecords(100, 21.5f);
+    TEST_ASSERT_TRUE(logger->flush());
+    reboot();
+    TEST_ASSERT_TRUE(logger->wasRestoredFromCheckpoint());
+    TelemetryRecord latest;
+    TEST_ASSERT_TRUE(logger->getLatestRecord(latest));
+    TEST_ASSERT_EQUAL_UINT32(100, latest.seq);
+
+    logRecords(28, 22.5f); // Fills the partial sector the checkpoint points into, then one more.
+    TEST_ASSERT_TRUE(logger->flush());
+    std::vector<TelemetryRecord> recs;
+    readAll(1, recs);
+    TEST_ASSERT_EQUAL_UINT32(128, recs.size());
+    assertConsecutive(recs, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 21.5f, recs[99].temperature());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 22.5f, recs[100].temperature());
+}
+
+void test_ring_wraps_over_the_oldest_segment() {
+    const uint32_t total = RING_CAPACITY + 313 * RECORDS_PER_SECTOR; // Ends on a sector boundary.
+    logRecords(total, 21.5f);
+    TEST_ASSERT_EQUAL_UINT32(total + 1, logger->getDurableNextSeq());
+
+    // Asking for records the ring no longer holds starts at the oldest one left.
+    std::vector<TelemetryRecord> recs;
+    readAll(1, recs);
+    TEST_ASSERT_EQUAL_UINT32(RING_HOLDS, recs.size());
+    assertConsecutive(recs, total - RING_HOLDS + 1);
+
+    reboot();
+    TEST_ASSERT_TRUE(logger->wasRestoredFromCheckpoint());
+    logRecords(RECORDS_PER_SECTOR, 22.5f);
+    recs.clear();
+    readAll(1, recs);
+    TEST_ASSERT_EQUAL_UINT32(RING_HOLDS, recs.size());
+    assertConsecutive(recs, total + RECORDS_PER_SECTOR - RING_HOLDS + 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 22.5f, recs.back().temperature());
+
+    // Without the checkpoint the newest segment and the end of the log are found by scanning.
+    SD.remove(TELEMETRY_CHECKPOINT_PATH);
+    reboot();
+    TEST_ASSERT_FALSE(logger->wasRestoredFromCheckpoint());
+    TEST_ASSERT_EQUAL_UINT32(total + RECORDS_PER_SECTOR + 1, logger->getDurableNextSeq());
+
+    // The oldest records are in the tail of the segment being written; the export starts there.
+    TEST_ASSERT_EQUAL_INT32((int32_t)RING_HOLDS, logger->exportCsv("/log.csv"));
+    FILE* f = fopen(nativeSd().hostPath("/log.csv").c_str(), "r");
+    TEST_ASSERT_NOT_NULL(f);
+    char line[200], want[32];
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), f));
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), f));
+    fclose(f);
+    uint32_t oldestSeq = total + RECORDS_PER_SECTOR - RING_HOLDS + 1;
+    DateTime dt(BASE_EPOCH + (oldestSeq - 1) * (LOOP_MS / 1000));
+    snprintf(want, sizeof(want), "%04d-%02d-%02d %02d:%02d:%02d,", dt.year(), dt.month(), dt.day(), dt.hour(),
+             dt.minute(), dt.second());
+    TEST_ASSERT_EQUAL_STRING_LEN(want, line, strlen(want));
+}
+
+void test_sector_torn_by_a_power_cut_is_recovered_up_to_the_last_whole_record() {
+    logRecords(40, 21.5f); // Two sectors written, 8 records buffered.
+    nativeSd().writeBudget = 6 * sizeof(TelemetryRecord) + 8; // The next sector write stops inside record 39.
+    logRecords(8, 21.5f);
+    TEST_ASSERT_FALSE(logger->isSdCardOk());
+
+    nativeSd().writeBudget = -1;
+    reboot();
+    // The checkpoint still points at record 32, but the sector after it has records: it is not trusted.
+    TEST_ASSERT_FALSE(logger->wasRestoredFromCheckpoint());
+    TelemetryRecord latest;
+    TEST_ASSERT_TRUE(logger->getLatestRecord(latest));
+    TEST_ASSERT_EQUAL_UINT32(38, latest.seq);
+
+    // Logging resumes in the torn sector; the half-written record is overwritten.
+    logRecords(10, 22.5f);
+    TEST_ASSERT_TRUE(logger->flush());
+    std::vector<TelemetryRecord> recs;
+    readAll(1, recs);
+    TEST_ASSERT_EQUAL_UINT32(48, recs.size());
+    assertConsecutive(recs, 1);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 21.5f, recs[37].temperature());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 22.5f, recs[38].temperature());
+
+    reboot();
+    TEST_ASSERT_TRUE(logger->wasRestoredFromCheckpoint());
+    TEST_ASSERT_EQUAL_UINT32(49, logger->getDurableNextSeq());
+}
+
+void test_csv_export_writes_the_old_layout() {
+    logRecords(20, 21.5f);
+    TEST_ASSERT_EQUAL_INT32(20, logger->exportCsv("/log.csv"));
+
+    FILE* f = fopen(nativeSd().hostPath("/log.csv").c_str(), "r");
+    TEST_ASSERT_NOT_NULL(f);
+    char line[200];
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), f));
+    TEST_ASSERT_EQUAL_STRING(
+        "DateTime,Temperature,Humidity,Light,TempMin,TempMax,HumMin,HumMax,LightMin,LightMax,Relay1,Relay2,Relay3,Relay4\r\n",
+        line);
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), f));
+    TEST_ASSERT_EQUAL_STRING("2025-10-09 08:53:20,21.50,55.5,1234.5,18.0,28.0,40.0,80.0,100,5000,OFF,OFF,ON,OFF\r\n", line);
+    int lines = 2;
+    while (fgets(line, sizeof(line), f)) lines++;
+    fclose(f);
+    TEST_ASSERT_EQUAL_INT(21, lines);
+}
+
+void test_million_record_soak_reports_bytes_written_per_record() {
+    const uint32_t total = 1000000;
+    logRecords(RING_CAPACITY, 21.5f); // First lap: every segment is created and preallocated once.
+    uint64_t firstLapBytes = nativeSd().bytesWritten;
+    nativeSd().resetCounters();
+    logRecords(total - RING_CAPACITY, 21.5f);
+    TEST_ASSERT_TRUE(logger->flush());
+
+    const SDCardLogger::TelemetryStats& st = logger->getTelemetryStats();
+    double steady = (double)nativeSd().bytesWritten / (total - RING_CAPACITY);
+    double overall = (double)(firstLapBytes + nativeSd().bytesWritten) / total;
+    char line[160];
+    snprintf(line, sizeof(line), "%lu records: %.3f B/record written in steady state, %.3f B/record including "
+             "preallocation, %lu sector writes",
+             (unsigned long)total, steady, overall, (unsigned long)st.sectorWrites);
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL_UINT32(total, st.recordsLogged);
+    TEST_ASSERT_EQUAL_UINT32(total / RECORDS_PER_SECTOR, st.sectorWrites);
+    // One 32-byte record plus a sixteenth of a checkpoint slot, against ~100 bytes of CSV plus FAT updates.
+    TEST_ASSERT_TRUE(steady <= sizeof(TelemetryRecord) + (double)sizeof(TelemetryCheckpoint) / RECORDS_PER_SECTOR);
+
+    reboot();
+    TEST_ASSERT_TRUE(logger->wasRestoredFromCheckpoint());
+    std::vector<TelemetryRecord> recs;
+    readAll(1, recs);
+    TEST_ASSERT_EQUAL_UINT32(RING_HOLDS, recs.size());
+    assertConsecutive(recs, total - RING_HOLDS + 1);
+    TEST_ASSERT_EQUAL_UINT32(BASE_EPOCH + (total - 1) * (LOOP_MS / 1000), recs.back().epoch);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_are_written_as_whole_sectors_and_read_back_up_to_the_durable_end);
+    RUN_TEST(test_old_records_are_flushed_as_a_partial_sector);
+    RUN_TEST(test_reboot_resumes_after_the_newest_record_from_the_checkpoint);
+    RUN_TEST(test_ring_wraps_over_the_oldest_segment);
+    RUN_TEST(test_sector_torn_by_a_power_cut_is_recovered_up_to_the_last_whole_record);
+    RUN_TEST(test_csv_export_writes_the_old_layout);
+    RUN_TEST(test_million_record_soak_reports_bytes_written_per_record);
+    return UNITY_END();
+}
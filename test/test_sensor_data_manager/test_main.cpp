@@ -0,0 +1,86 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `SensorDataManager`: out-of-range readings become the invalid markers the relay rules
+ *        check for, invalid thresholds are rejected per group, and thresholds and readings are restored from the
+ *        last record on the fake SD card (`test/stubs/FS.h`) after a restart.
+ */
+#include <unity.h>
+#include "SDCardLogger.h"
+#include "SensorDataManager.h"
+
+void setUp() {
+    nativeSdWipe();
+    nativeSetMs(0);
+}
+void tearDown() {}
+
+void test_out_of_range_readings_become_invalid_markers() {
+    SensorDataManager data;
+    data.updateData(24.5f, 55.0f, 1200.0f);
+    TEST_ASSERT_EQUAL_FLOAT(24.5f, data.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(55.0f, data.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(1200.0f, data.light);
+
+    data.updateData(120.0f, 101.0f, -5.0f);
+    TEST_ASSERT_EQUAL_FLOAT(-99.9f, data.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, data.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, data.light);
+}
+
+void test_invalid_threshold_groups_are_rejected_and_valid_ones_kept() {
+    SensorDataManager data;
+    data.updateThresholds(30.0f, 20.0f, 40.0f, 70.0f, 100.0f, 4000.0f); // Temperature range inverted.
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, data.getTempMin());
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, data.getTempMax());
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, data.getHumMin());
+    TEST_ASSERT_EQUAL_FLOAT(70.0f, data.getHumMax());
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, data.getLightMin());
+    TEST_ASSERT_EQUAL_FLOAT(4000.0f, data.getLightMax());
+
+    data.updateThresholds(18.0f, 28.0f, -1.0f, 70.0f, 100.0f, 0.0f); // Humidity and light out of range.
+    TEST_ASSERT_EQUAL_FLOAT(18.0f, data.getTempMin());
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, data.getHumMin());
+    TEST_ASSERT_EQUAL_FLOAT(4000.0f, data.getLightMax());
+}
+
+void test_empty_log_leaves_the_defaults() {
+    SDCardLogger logger(nullptr);
+    TEST_ASSERT_TRUE(logger.begin());
+    SensorDataManager data;
+    TEST_ASSERT_FALSE(data.loadFromLog(logger));
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, data.getTempMin());
+    TEST_ASSERT_EQUAL_FLOAT(-99.9f, data.temperature);
+}
+
+void test_last_logged_record_is_restored_after_a_restart() {
+    {
+        SDCardLogger logger(nullptr);
+        TEST_ASSERT_TRUE(logger.begin());
+        logger.logData(1760000000UL, 21.5f, 48.0f, 900.0f, 18.0f, 28.0f, 40.0f, 75.0f, 150.0f, 4500.0f,
+                       true, false, true, false);
+        TEST_ASSERT_TRUE(logger.flush());
+    }
+    SDCardLogger logger(nullptr);
+    TEST_ASSERT_TRUE(logger.begin());
+    SensorDataManager data;
+    TEST_ASSERT_TRUE(data.loadFromLog(logger));
+
+    TEST_ASSERT_EQUAL_FLOAT(18.0f, data.getTempMin());
+    TEST_ASSERT_EQUAL_FLOAT(28.0f, data.getTempMax());
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, data.getHumMin());
+    TEST_ASSERT_EQUAL_FLOAT(75.0f, data.getHumMax());
+    TEST_ASSERT_EQUAL_FLOAT(150.0f, data.getLightMin());
+    TEST_ASSERT_EQUAL_FLOAT(4500.0f, data.getLightMax());
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 21.5f, data.temperature);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 48.0f, data.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 900.0f, data.light);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_out_of_range_readings_become_invalid_markers);
+    RUN_TEST(test_invalid_threshold_groups_are_rejected_and_valid_ones_kept);
+    RUN_TEST(test_empty_log_leaves_the_defaults);
+    RUN_TEST(test_last_logged_record_is_restored_after_a_restart);
+    return UNITY_END();
+}
@@ -0,0 +1,336 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `SntpClient` against a scripted UDP network: cookie matching, rejection of
+ *        unsynchronized and kiss-o'-death replies, shortest-round-trip selection with server hold time excluded,
+ *        and the sample's second/edge split when the round-trip correction crosses a second boundary.
+ *
+ * Each stand-in server keeps true time `BASE_UNIX_US + virtual time`, answers after half its round trip plus its
+ * hold time, and its reply is delivered after the other half. All times are whole milliseconds and the client is
+ * polled every millisecond, so the expected sample is exact.
+ */
+#include <unity.h>
+#include <deque>
+#include <vector>
+#include <esp_timer.h>
+#include <lwip/dns.h>
+#include "SntpClient.h"
+
+static const uint32_t NTP_UNIX_OFFSET_S = 2208988800UL;
+static const int64_t BASE_UNIX_US = 1760000000LL * 1000000LL + 250000; ///< True time at virtual time 0.
+
+/**
+ * @brief A datagram in flight to the client.
+ */
+struct Datagram {
+    int64_t deliverUs;
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief A request the client sent.
+ */
+struct Request {
+    uint8_t server;    ///< Index in `SNTP_SERVERS`, from the address 10.0.0.(index + 1).
+    uint8_t bytes[48];
+    int64_t sentUs;
+};
+
+/**
+ * @brief `UDP` over an in-memory network: records requests, delivers scheduled replies once their time has come.
+ */
+class FakeNetwork : public UDP {
+public:
+    uint8_t begin(uint16_t) override {
+        open = true;
+        return 1;
+    }
+    void stop() override { open = false; }
+    int beginPacket(IPAddress ip, uint16_t port) override {
+        TEST_ASSERT_EQUAL_UINT16(123, port);
+        _to = (uint32_t)ip;
+        _out.clear();
+        return 1;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        _out.insert(_out.end(), buffer, buffer + size);
+        return size;
+    }
+    int endPacket() override {
+        TEST_ASSERT_EQUAL_UINT32(48, _out.size());
+        Request r;
+        r.server = (uint8_t)((_to >> 24) - 1);
+        memcpy(r.bytes, _out.data(), sizeof(r.bytes));
+        r.sentUs = esp_timer_get_time();
+        requests.push_back(r);
+        return 1;
+    }
+    int parsePacket() override {
+        for (size_t i = 0; i < inbox.size(); ++i) {
+            if (inbox[i].deliverUs <= esp_timer_get_time()) {
+                _current = inbox[i].bytes;
+                inbox.erase(inbox.begin() + i);
+                return (int)_current.size();
+            }
+        }
+        return 0;
+    }
+    int read(unsigned char* buffer, size_t len) override {
+        size_t n = std::min(len, _current.size());
+        memcpy(buffer, _current.data(), n);
+        _current.clear();
+        return (int)n;
+    }
+
+    bool open = false;
+    std::vector<Request> requests;
+    std::deque<Datagram> inbox;
+
+private:
+    uint32_t _to = 0;
+    std::vector<uint8_t> _out, _current;
+};
+
+static void writeBe32(uint8_t* p, uint32_t v) {
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+/**
+ * @brief Writes a Unix time in microseconds as an NTP timestamp whose fraction converts back to the same value.
+ */
+static void writeTimestamp(uint8_t* p, int64_t unixUs) {
+    writeBe32(p, (uint32_t)(unixUs / 1000000 + NTP_UNIX_OFFSET_S));
+    uint64_t us = (uint64_t)(unixUs % 1000000);
+    writeBe32(p + 4, (uint32_t)(((us << 32) + 999999) / 1000000)); // Rounded up.
+}
+
+struct Reply {
+    uint32_t rttMs = 40;    ///< Network round trip, split evenly.
+    uint32_t holdMs = 0;    ///< Server time between receiving and sending.
+    uint8_t leap = 0;
+    uint8_t stratum = 2;
+    uint8_t mode = 4;
+    int64_t serverSkewUs = 0; ///< Added to the server's true time, to move its timestamps across a boundary.
+    bool echoCookie = true;
+};
+
+static FakeNetwork* net;
+static SntpClient* sntp;
+
+/**
+ * @brief Schedules the server's answer to request `index`.
+ */
+static void answer(size_t index, const Reply& how) {
+    const Request& req = net->requests.at(index);
+    int64_t t2 = req.sentUs + how.rttMs * 500LL;
+    int64_t t3 = t2 + how.holdMs * 1000LL;
+    Datagram d;
+    d.deliverUs = t3 + how.rttMs * 500LL;
+    d.bytes.assign(48, 0);
+    d.bytes[0] = (uint8_t)(how.leap << 6 | 4 << 3 | how.mode);
+    d.bytes[1] = how.stratum;
+    if (how.echoCookie) memcpy(&d.bytes[24], req.bytes + 40, 8);
+    writeTimestamp(&d.bytes[32], BASE_UNIX_US + how.serverSkewUs + t2);
+    writeTimestamp(&d.bytes[40], BASE_UNIX_US + how.serverSkewUs + t3);
+    net->inbox.push_back(d);
+}
+
+static std::vector<dns_found_callback> deferredFound;
+static std::vector<void*> deferredArg;
+
+static int serverIndex(const char* name) {
+    for (int i = 0; i < SNTP_SERVER_COUNT; ++i) {
+        if (strcmp(name, SNTP_SERVERS[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static void setAddress(ip_addr_t* addr, int index) {
+    addr->type = IPADDR_TYPE_V4;
+    addr->ip4.addr = (uint32_t)IPAddress(10, 0, 0, (uint8_t)(index + 1));
+}
+
+static err_t dnsCached(const char* name, ip_addr_t* addr, dns_found_callback, void*) {
+    setAddress(addr, serverIndex(name));
+    return ERR_OK;
+}
+
+/**
+ * @brief The first server is cached; the others answer later through the callback.
+ */
+static err_t dnsDeferred(const char* name, ip_addr_t* addr, dns_found_callback found, void* arg) {
+    if (serverIndex(name) == 0) return dnsCached(name, addr, found, arg);
+    deferredFound.push_back(found);
+    deferredArg.push_back(arg);
+    return ERR_INPROGRESS;
+}
+
+/**
+ * @brief Polls every millisecond until the round ends.
+ */
+static SntpClient::Result runRound() {
+    SntpClient::Result r;
+    while ((r = sntp->poll()) == SntpClient::Result::BUSY) nativeAdvanceMs(1);
+    return r;
+}
+
+/**
+ * @brief Local time (Unix, timezone applied) the sample gives for virtual time `atUs`.
+ */
+static int64_t sampleLocalUs(const SntpClient::Sample& s, int64_t atUs) {
+    return (int64_t)s.epoch * 1000000LL + (atUs - s.edgeUs);
+}
+
+void setUp() {
+    nativeSetMs(0);
+    nativeDnsHook() = dnsCached;
+    deferredFound.clear();
+    deferredArg.clear();
+    net = new FakeNetwork();
+    sntp = new SntpClient(*net);
+}
+
+void tearDown() {
+    delete sntp;
+    delete net;
+}
+
+void test_round_sends_one_request_per_server_with_a_random_cookie() {
+    TEST_ASSERT_TRUE(sntp->start());
+    TEST_ASSERT_TRUE(net->open);
+    TEST_ASSERT_FALSE(sntp->start());
+    TEST_ASSERT_EQUAL_INT((int)SntpClient::Result::BUSY, (int)sntp->poll());
+    TEST_ASSERT_EQUAL_UINT32(SNTP_SERVER_COUNT, net->requests.size());
+    for (size_t i = 0; i < net->requests.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT8(i, net->requests[i].server);
+        TEST_ASSERT_EQUAL_UINT8(0x23, net->requests[i].bytes[0]);
+        if (i > 0) TEST_ASSERT_TRUE(memcmp(net->requests[i].bytes + 40, net->requests[i - 1].bytes + 40, 8) != 0);
+    }
+}
+
+void test_replies_with_a_wrong_cookie_or_repeated_are_rejected() {
+    sntp->start();
+    sntp->poll();
+    Reply stray;
+    stray.echoCookie = false;
+    answer(0, stray);
+    answer(1, Reply());
+    answer(1, Reply()); // Duplicate: its query is already done.
+    answer(2, Reply());
+    TEST_ASSERT_EQUAL_INT((int)SntpClient::Result::SYNCED, (int)runRound());
+    TEST_ASSERT_EQUAL_UINT32(2, sntp->getStats().replies);
+    TEST_ASSERT_EQUAL_UINT32(2, sntp->getStats().rejected);
+    TEST_ASSERT_EQUAL_UINT32(1, sntp->getStats().timeouts); // Server 0 never answered with its own cookie.
+    TEST_ASSERT_EQUAL_UINT32(SNTP_ROUND_TIMEOUT_MS, millis());
+}
+
+void test_unsynchronized_and_kiss_of_death_replies_are_rejected() {
+    sntp->start();
+    sntp->poll();
+    Reply alarm, kod, unsynced;
+    alarm.leap = 3;
+    kod.stratum = 0;
+    unsynced.stratum = 16;
+    answer(0, alarm);
+    answer(1, kod);
+    answer(2, unsynced);
+    TEST_ASSERT_EQUAL_INT((int)SntpClient::Result::FAILED, (int)runRound());
+    TEST_ASSERT_EQUAL_UINT32(3, sntp->getStats().rejected);
+    TEST_ASSERT_EQUAL_UINT32(0, sntp->getStats().replies);
+    TEST_ASSERT_EQUAL_UINT32(0, sntp->getStats().synced);
+    TEST_ASSERT_FALSE(net->open);
+    TEST_ASSERT_LESS_THAN((long)SNTP_ROUND_TIMEOUT_MS, (long)millis()); // Ends as soon as every server is done.
+
+    // A client-mode reflection is not a server reply either.
+    sntp->start();
+    sntp->poll();
+    Reply reflected;
+    reflected.mode = 3;
+    for (size_t i = SNTP_SERVER_COUNT; i < net->requests.size(); ++i) answer(i, reflected);
+    TEST_ASSERT_EQUAL_INT((int)SntpClient::Result::FAILED, (int)runRound());
+    TEST_ASSERT_EQUAL_UINT32(3 + SNTP_SERVER_COUNT, sntp->getStats().rejected);
+}
+
+void test_shortest_round_trip_wins_and_hold_time_is_excluded() {
+    nativeSetMs(5000);
+    sntp->start();
+    sntp->poll();
+    Reply slow, fastButHeld, medium;
+    slow.rttMs = 120;
+    fastButHeld.rttMs = 20;
+    fastButHeld.holdMs = 200; // Arrives last, yet has the shortest network path.
+    medium.rttMs = 60;
+    answer(0, slow);
+    answer(1, fastButHeld);
+    answer(2, medium);
+    TEST_ASSERT_EQUAL_INT((int)SntpClient::Result::SYNCED, (int)runRound());
+
+    const SntpClient::Sample& s = sntp->getSample();
+    TEST_ASSERT_EQUAL_UINT8(1, s.server);
+    TEST_ASSERT_EQUAL_UINT32(20000, s.rttUs);
+    TEST_ASSERT_EQUAL_UINT32(3, sntp->getStats().replies);
+    TEST_ASSERT_EQUAL_UINT8(1, sntp->getStats().lastServer);
+    // Round-trip compensated: the sample tells true local time at any virtual time.
+    int64_t expected = BASE_UNIX_US + (int64_t)NTP_TIMEZONE_OFFSET_SECONDS * 1000000LL + esp_timer_get_time();
+    TEST_ASSERT_EQUAL_INT64(expected, sampleLocalUs(s, esp_timer_get_time()));
+}
+
+void test_correction_carries_into_the_next_second() {
+    nativeSetMs(1000);
+    sntp->start();
+    sntp->poll();
+    // Server transmits at .999900 of a second; the 10 ms return half moves its time into the next second.
+    int64_t t3 = net->requests[0].sentUs + 10000;
+    int64_t trueT3 = BASE_UNIX_US + t3;
+    Reply r;
+    r.rttMs = 20;
+    r.serverSkewUs = (trueT3 / 1000000) * 1000000 + 999900 - trueT3;
+    answer(0, r);
+    for (int i = 1; i < SNTP_SERVER_COUNT; ++i) {
+        Reply worse;
+        worse.rttMs = 300;
+        answer(i, worse);
+    }
+    TEST_ASSERT_EQUAL_INT((int)SntpClient::Result::SYNCED, (int)runRound());
+
+    const SntpClient::Sample& s = sntp->getSample();
+    TEST_ASSERT_EQUAL_UINT8(0, s.server);
+    int64_t t4 = t3 + 10000;
+    uint32_t expectedEpoch = (uint32_t)(trueT3 / 1000000 + 1 + NTP_TIMEZONE_OFFSET_SECONDS);
+    TEST_ASSERT_EQUAL_UINT32(expectedEpoch, s.epoch);
+    TEST_ASSERT_EQUAL_INT64(t4 - 9900, s.edgeUs); // The new second began 9.9 ms before the reply was read.
+    TEST_ASSERT_EQUAL_INT64((int64_t)expectedEpoch * 1000000LL + 9900, sampleLocalUs(s, t4));
+}
+
+void test_no_reply_and_unresolved_names_end_the_round_at_its_timeout() {
+    nativeDnsHook() = dnsDeferred;
+    sntp->start();
+    sntp->poll();
+    TEST_ASSERT_EQUAL_UINT32(1, net->requests.size()); // Only the cached name was sent at once.
+
+    nativeAdvanceMs(100);
+    ip_addr_t addr;
+    setAddress(&addr, 1);
+    deferredFound[0](SNTP_SERVERS[1], &addr, deferredArg[0]); // Resolves later.
+    deferredFound[1](SNTP_SERVERS[2], nullptr, deferredArg[1]); // Fails.
+    sntp->poll();
+    TEST_ASSERT_EQUAL_UINT32(2, net->requests.size());
+    TEST_ASSERT_EQUAL_UINT8(1, net->requests[1].server);
+    answer(1, Reply());
+
+    TEST_ASSERT_EQUAL_INT((int)SntpClient::Result::SYNCED, (int)runRound());
+    TEST_ASSERT_EQUAL_UINT8(1, sntp->getSample().server);
+    TEST_ASSERT_EQUAL_UINT32(1, sntp->getStats().dnsFailures);
+    TEST_ASSERT_EQUAL_UINT32(1, sntp->getStats().timeouts);
+    TEST_ASSERT_EQUAL_UINT32(SNTP_ROUND_TIMEOUT_MS, millis());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_sends_one_request_per_server_with_a_random_cookie);
+    RUN_TEST(test_replies_with_a_wrong_cookie_or_repeated_are_rejected);
+    RUN_TEST(test_unsynchronized_and_kiss_of_death_replies_are_rejected);
+    RUN_TEST(test_shortest_round_trip_wins_and_hold_time_is_excluded);
+    RUN_TEST(test_correction_carries_into_the_next_second);
+    RUN_TEST(test_no_reply_and_unresolved_names_end_the_round_at_its_timeout);
+    return UNITY_END();
+}
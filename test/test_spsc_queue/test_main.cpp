@@ -0,0 +1,134 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `SpscQueue`: empty/full bounds, FIFO order across index wrap, in-place publication, and a
+ *        two-thread stress run that checks nothing is lost, duplicated or read before it is published.
+ */
+#include <unity.h>
+#include <thread>
+#include "SpscQueue.h"
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief A descriptor with a guard word written last, so a slot read before its contents are published shows up.
+ */
+struct Item {
+    uint32_t seq;
+    uint32_t payload[15];
+    uint32_t check;
+};
+
+static void fill(Item& item, uint32_t seq) {
+    item.seq = seq;
+    for (uint32_t i = 0; i < 15; ++i) item.payload[i] = seq * 31 + i;
+    item.check = ~seq;
+}
+
+static bool intact(const Item& item) {
+    for (uint32_t i = 0; i < 15; ++i) {
+        if (item.payload[i] != item.seq * 31 + i) return false;
+    }
+    return item.check == ~item.seq;
+}
+
+void test_empty_queue_has_no_front() {
+    SpscQueue<int, 4> q;
+    TEST_ASSERT_NULL(q.front());
+    TEST_ASSERT_EQUAL_UINT32(0, q.size());
+    TEST_ASSERT_EQUAL_UINT32(4, q.capacity());
+}
+
+void test_full_queue_refuses_push_until_popped() {
+    SpscQueue<int, 4> q;
+    for (int i = 0; i < 4; ++i) {
+        int* slot = q.beginPush();
+        TEST_ASSERT_NOT_NULL(slot);
+        *slot = i;
+        q.commitPush();
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, q.size());
+    TEST_ASSERT_NULL(q.beginPush());
+
+    TEST_ASSERT_EQUAL_INT(0, *q.front());
+    q.pop();
+    TEST_ASSERT_NOT_NULL(q.beginPush());
+}
+
+void test_uncommitted_slot_is_not_visible() {
+    SpscQueue<int, 4> q;
+    int* slot = q.beginPush();
+    *slot = 7;
+    TEST_ASSERT_NULL(q.front());
+    TEST_ASSERT_EQUAL_UINT32(0, q.size());
+    // Asking again before committing hands out the same slot.
+    TEST_ASSERT_TRUE(q.beginPush() == slot);
+    q.commitPush();
+    TEST_ASSERT_EQUAL_INT(7, *q.front());
+}
+
+void test_fifo_order_survives_many_wraps() {
+    SpscQueue<uint32_t, 4> q;
+    uint32_t next = 0, expected = 0;
+    for (int round = 0; round < 10000; ++round) {
+        // Vary the fill level so head and tail wrap at different offsets.
+        int burst = 1 + round % 4;
+        for (int i = 0; i < burst; ++i) {
+            uint32_t* slot = q.beginPush();
+            if (!slot) break;
+            *slot = next++;
+            q.commitPush();
+        }
+        int drain = 1 + (round * 7) % 4;
+        for (int i = 0; i < drain && q.front(); ++i) {
+            TEST_ASSERT_EQUAL_UINT32(expected, *q.front());
+            expected++;
+            q.pop();
+        }
+    }
+    while (q.front()) {
+        TEST_ASSERT_EQUAL_UINT32(expected++, *q.front());
+        q.pop();
+    }
+    TEST_ASSERT_EQUAL_UINT32(next, expected);
+}
+
+void test_two_threads_pass_every_item_once_and_intact() {
+    static SpscQueue<Item, 8> q;
+    const uint32_t count = 200000;
+
+    std::thread producer([&]() {
+        for (uint32_t seq = 0; seq < count; ++seq) {
+            Item* slot;
+            while ((slot = q.beginPush()) == nullptr) std::this_thread::yield();
+            fill(*slot, seq);
+            q.commitPush();
+        }
+    });
+
+    uint32_t expected = 0, torn = 0;
+    while (expected < count) {
+        Item* item = q.front();
+        if (!item) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (item->seq != expected || !intact(*item)) torn++;
+        expected++;
+        q.pop();
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_NULL(q.front());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_queue_has_no_front);
+    RUN_TEST(test_full_queue_refuses_push_until_popped);
+    RUN_TEST(test_uncommitted_slot_is_not_visible);
+    RUN_TEST(test_fifo_order_survives_many_wraps);
+    RUN_TEST(test_two_threads_pass_every_item_once_and_intact);
+    return UNITY_END();
+}
@@ -0,0 +1,94 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for the on-card telemetry record format (`TelemetryRecord.h`), and a check that the native
+ *        environment's virtual clock behaves as the other suites rely on.
+ */
+#include <unity.h>
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "TelemetryRecord.h"
+
+void setUp() {}
+void tearDown() {}
+
+static TelemetryRecord sample(uint32_t seq) {
+    TelemetryRecord rec;
+    encodeTelemetryRecord(rec, seq, 1700000000UL + seq, 23.456f, 61.2f, 12345.6f, 18.0f, 30.0f, 40.0f, 80.0f, 100.0f, 70000.0f, 0x15);
+    return rec;
+}
+
+void test_crc_matches_reference_vector() {
+    // CRC-16/CCITT-FALSE check value.
+    const char* check = "123456789";
+    TEST_ASSERT_EQUAL_UINT16(0x29B1, telemetryCrc16(reinterpret_cast<const uint8_t*>(check), 9));
+}
+
+void test_encode_scales_rounds_and_clamps() {
+    TelemetryRecord rec = sample(7);
+    TEST_ASSERT_EQUAL_UINT32(7, rec.seq);
+    TEST_ASSERT_EQUAL_INT(2346, rec.tempC100);
+    TEST_ASSERT_EQUAL_INT(6120, rec.humidity100);
+    TEST_ASSERT_EQUAL_INT(123456, rec.light10);
+    TEST_ASSERT_EQUAL_UINT16(65535, rec.lightMax); // Clamped.
+    TEST_ASSERT_EQUAL_UINT8(0x05, rec.relays);    // Only relays 1-4 are kept.
+    TEST_ASSERT_FLOAT_WITHIN(0.006f, 23.456f, rec.temperature());
+    TEST_ASSERT_TRUE(rec.relay(0));
+    TEST_ASSERT_FALSE(rec.relay(1));
+    TEST_ASSERT_TRUE(rec.relay(2));
+}
+
+void test_invalid_reading_keeps_its_sentinel() {
+    TelemetryRecord rec;
+    encodeTelemetryRecord(rec, 1, 0, -99.9f, -1.0f, NAN, 0, 0, 0, 0, 0, 0, 0);
+    TEST_ASSERT_EQUAL_INT(-9990, rec.tempC100);
+    TEST_ASSERT_EQUAL_INT(-100, rec.humidity100);
+    TEST_ASSERT_EQUAL_INT(-1000000L, rec.light10); // NaN maps to the low clamp.
+}
+
+void test_crc_rejects_any_flipped_byte_and_erased_flash() {
+    TelemetryRecord rec = sample(3);
+    TEST_ASSERT_TRUE(isTelemetryRecordValid(rec));
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&rec);
+    for (size_t i = 0; i < sizeof(rec); ++i) {
+        bytes[i] ^= 0x01;
+        TEST_ASSERT_FALSE(isTelemetryRecordValid(rec));
+        bytes[i] ^= 0x01;
+    }
+    memset(&rec, 0xFF, sizeof(rec));
+    TEST_ASSERT_FALSE(isTelemetryRecordValid(rec));
+}
+
+void test_checkpoint_seal_and_validate() {
+    TelemetryCheckpoint cp;
+    memset(&cp, 0, sizeof(cp));
+    cp.generation = 5;
+    cp.segmentIndex = 2;
+    cp.recordIndex = 100;
+    cp.latest = sample(42);
+    sealTelemetryCheckpoint(cp);
+    TEST_ASSERT_TRUE(isTelemetryCheckpointValid(cp));
+    cp.recordIndex++;
+    TEST_ASSERT_FALSE(isTelemetryCheckpointValid(cp));
+}
+
+void test_virtual_clock_only_moves_when_told() {
+    nativeSetMs(1000);
+    TEST_ASSERT_EQUAL_UINT32(1000, millis());
+    TEST_ASSERT_EQUAL_UINT32(1000, millis());
+    delay(250);
+    TEST_ASSERT_EQUAL_UINT32(1250, millis());
+    nativeAdvanceUs(1500);
+    TEST_ASSERT_EQUAL_UINT32(1251500UL, micros());
+    TEST_ASSERT_EQUAL_INT64(1251500LL, esp_timer_get_time());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_matches_reference_vector);
+    RUN_TEST(test_encode_scales_rounds_and_clamps);
+    RUN_TEST(test_invalid_reading_keeps_its_sentinel);
+    RUN_TEST(test_crc_rejects_any_flipped_byte_and_erased_flash);
+    RUN_TEST(test_checkpoint_seal_and_validate);
+    RUN_TEST(test_virtual_clock_only_moves_when_told);
+    return UNITY_END();
+}
@@ -0,0 +1,250 @@
+/**
+ * @file test_main.cpp
+ * @brief Host tests for `WiFiManager` against the `WiFi`/`HTTPClient` stand-ins and the loopback HTTP server:
+ *        fast reconnect from the cache and its fallback to a scan, the three body framings (Content-Length,
+ *        chunked, close-delimited), keep-alive reuse and the stale-socket retry, and a conditional GET answered
+ *        by `304`, and the MQTT push socket (`getPushClient()`) as a connection of its own next to the pool.
+ */
+#include <unity.h>
+#include <string>
+#include <Preferences.h>
+#include "WiFiManager.h"
+
+static const uint8_t AP_BSSID[6] = {0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03};
+static const char* URL = "http://api.test/v1/config";
+
+static int callbacks;
+static std::string lastValue;
+static HttpResponseInfo lastInfo;
+static int observed;
+
+void setUp() {
+    nativeSetMs(1000);
+    nativeHttpServer().reset();
+    WiFi.nativeReset();
+    WiFi.nativeSetAccessPoint("greenhouse", "secret", 6, AP_BSSID);
+    nativePreferencesErase();
+    callbacks = 0;
+    lastValue.clear();
+    lastInfo = HttpResponseInfo();
+    observed = 0;
+}
+void tearDown() {}
+
+static HttpResponseCallback recordValue() {
+    return [](JsonDocument& doc) -> bool {
+        callbacks++;
+        lastValue = doc["value"] | "";
+        return true;
+    };
+}
+
+static void observe(WiFiManager& wm) {
+    wm.setResponseObserver([](const char*, const HttpResponseInfo& info) {
+        lastInfo = info;
+        observed++;
+    });
+}
+
+/**
+ * @brief Drives the HTTP state machine until the request finishes, on the virtual clock.
+ */
+static void runRequest(WiFiManager& wm) {
+    for (int i = 0; i < 2000 && wm.isHttpOperationActive(); ++i) {
+        wm.updateHttpOperations();
+        nativeAdvanceMs(10);
+    }
+    TEST_ASSERT_FALSE(wm.isHttpOperationActive());
+}
+
+static void get(WiFiManager& wm) {
+    TEST_ASSERT_TRUE(wm.startAsyncHttpRequest(URL, "GET", "Test", nullptr, recordValue()));
+    runRequest(wm);
+}
+
+/// MQTT 3.1.1 CONNECT with an empty client id, and the broker's CONNACK accepting it.
+static const uint8_t MQTT_CONNECT[] = {0x10, 0x0c, 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02, 0x00, 0x3c, 0x00, 0x00};
+static const char MQTT_CONNACK[] = {0x20, 0x02, 0x00, 0x00};
+
+static std::string lengthResponse(const char* body, const char* extraHeaders = "") {
+    return std::string("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: ") +
+           std::to_string(strlen(body)) + "\r\n" + extraHeaders + "\r\n" + body;
+}
+
+void test_first_connect_scans_and_the_next_one_is_fast() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    TEST_ASSERT_TRUE(wm.connect());
+    TEST_ASSERT_EQUAL_INT32(0, WiFi.lastBeginChannel);
+    TEST_ASSERT_EQUAL_UINT32(0, wm.getConnectStats().fastConnects);
+
+    wm.disconnect();
+    TEST_ASSERT_TRUE(wm.connect());
+    TEST_ASSERT_EQUAL_INT32(6, WiFi.lastBeginChannel);
+    TEST_ASSERT_EQUAL_UINT32(2, wm.getConnectStats().connects);
+    TEST_ASSERT_EQUAL_UINT32(1, wm.getConnectStats().fastConnects);
+}
+
+void test_fast_connect_to_a_moved_ap_falls_back_to_a_scan() {
+    {
+        WiFiManager wm("greenhouse", "secret", "token");
+        TEST_ASSERT_TRUE(wm.connect());
+        wm.disconnect();
+    }
+    WiFi.nativeSetAccessPoint("greenhouse", "secret", 11, AP_BSSID);
+
+    WiFiManager wm("greenhouse", "secret", "token");
+    TEST_ASSERT_TRUE(wm.connect());
+    TEST_ASSERT_EQUAL_INT32(0, WiFi.lastBeginChannel);
+    TEST_ASSERT_EQUAL_UINT32(2, wm.getConnectStats().attempts);
+    TEST_ASSERT_EQUAL_UINT32(1, wm.getConnectStats().fastFallbacks);
+    TEST_ASSERT_EQUAL_UINT32(0, wm.getConnectStats().fastConnects);
+}
+
+void test_wrong_password_gives_up_after_the_scan_attempts() {
+    WiFiManager wm("greenhouse", "wrong", "token");
+    TEST_ASSERT_FALSE(wm.connect());
+    TEST_ASSERT_EQUAL_UINT32(WIFI_CONNECT_MAX_ATTEMPTS, WiFi.beginCalls);
+    TEST_ASSERT_EQUAL_UINT32(1, wm.getConnectStats().failures);
+}
+
+void test_content_length_body_reaches_the_callback_and_keeps_the_socket() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    TEST_ASSERT_TRUE(wm.connect());
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"one\"}"));
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"two\"}"));
+
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(1, callbacks);
+    TEST_ASSERT_EQUAL_STRING("one", lastValue.c_str());
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(2, callbacks);
+    TEST_ASSERT_EQUAL_STRING("two", lastValue.c_str());
+
+    TEST_ASSERT_EQUAL_UINT32(1, nativeHttpServer().connects);
+    TEST_ASSERT_EQUAL_UINT32(1, wm.getConnectionStats().reused);
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[0].find("GET /v1/config HTTP/1.1\r\n") == 0);
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[0].find("Authorization: Bearer token\r\n") != std::string::npos);
+}
+
+void test_chunked_body_is_dechunked_and_keeps_the_socket() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    observe(wm);
+    TEST_ASSERT_TRUE(wm.connect());
+    nativeHttpServer().respond("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                               "6\r\n{\"valu\r\n"
+                               "c\r\ne\":\"chunked\"\r\n"
+                               "1\r\n}\r\n"
+                               "0\r\n\r\n");
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"after\"}"));
+
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(1, callbacks);
+    TEST_ASSERT_EQUAL_STRING("chunked", lastValue.c_str());
+    TEST_ASSERT_EQUAL_UINT32(19, lastInfo.bodyBytes);
+    get(wm);
+    TEST_ASSERT_EQUAL_STRING("after", lastValue.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, nativeHttpServer().connects);
+}
+
+void test_close_delimited_body_is_read_to_eof_and_the_next_request_reconnects() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    observe(wm);
+    TEST_ASSERT_TRUE(wm.connect());
+    nativeHttpServer().respond("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n{\"value\":\"eof\"}", true);
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"next\"}"));
+
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(1, callbacks);
+    TEST_ASSERT_EQUAL_STRING("eof", lastValue.c_str());
+    TEST_ASSERT_EQUAL_UINT32(15, lastInfo.bodyBytes);
+    get(wm);
+    TEST_ASSERT_EQUAL_STRING("next", lastValue.c_str());
+    TEST_ASSERT_EQUAL_UINT32(2, nativeHttpServer().connects);
+}
+
+void test_request_on_a_dropped_kept_socket_is_resent_once_on_a_new_one() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    TEST_ASSERT_TRUE(wm.connect());
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"one\"}"));
+    get(wm);
+
+    nativeHttpServer().dropIdle();
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"two\"}"));
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(2, callbacks);
+    TEST_ASSERT_EQUAL_STRING("two", lastValue.c_str());
+    TEST_ASSERT_EQUAL_UINT32(2, nativeHttpServer().connects);
+    TEST_ASSERT_EQUAL_UINT32(1, wm.getConnectionStats().staleReconnects);
+}
+
+void test_validators_are_reported_and_a_304_skips_the_callback() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    observe(wm);
+    TEST_ASSERT_TRUE(wm.connect());
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"full\"}", "ETag: \"v7\"\r\n"));
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(200, lastInfo.statusCode);
+    TEST_ASSERT_EQUAL_STRING("\"v7\"", lastInfo.validators.etag);
+
+    HttpValidators validators = lastInfo.validators;
+    nativeHttpServer().respond("HTTP/1.1 304 Not Modified\r\nETag: \"v7\"\r\n\r\n");
+    wm.setConditionalRequest(&validators);
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(1, callbacks);
+    TEST_ASSERT_EQUAL_INT(2, observed);
+    TEST_ASSERT_TRUE(lastInfo.notModified);
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[1].find("If-None-Match: \"v7\"\r\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(1, nativeHttpServer().connects);
+}
+
+void test_unanswered_request_fails_after_the_retries() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    observe(wm);
+    TEST_ASSERT_TRUE(wm.connect());
+    get(wm);
+    TEST_ASSERT_EQUAL_INT(0, callbacks);
+    TEST_ASSERT_TRUE(lastInfo.statusCode <= 0);
+}
+
+void test_push_socket_is_a_connection_of_its_own_and_closes_on_disconnect() {
+    WiFiManager wm("greenhouse", "secret", "token");
+    TEST_ASSERT_TRUE(wm.connect());
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"one\"}"));
+    nativeHttpServer().respond(lengthResponse("{\"value\":\"two\"}"));
+    get(wm);
+
+    Client* push = wm.getPushClient();
+    TEST_ASSERT_NOT_NULL(push);
+    TEST_ASSERT_EQUAL_INT(1, push->connect("broker.test", 1883));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(MQTT_CONNECT), push->write(MQTT_CONNECT, sizeof(MQTT_CONNECT)));
+    std::shared_ptr<NativeConnection> broker = nativeHttpServer().connectionTo("broker.test", 1883);
+    TEST_ASSERT_NOT_NULL(broker.get());
+    TEST_ASSERT_TRUE(broker->fromClient == std::string(reinterpret_cast<const char*>(MQTT_CONNECT), sizeof(MQTT_CONNECT)));
+    broker->toClient.insert(broker->toClient.end(), MQTT_CONNACK, MQTT_CONNACK + sizeof(MQTT_CONNACK));
+    uint8_t connack[4];
+    TEST_ASSERT_EQUAL_INT(4, push->read(connack, sizeof(connack)));
+    TEST_ASSERT_EQUAL_UINT8(0x20, connack[0]);
+
+    get(wm); // The HTTP socket is still the pooled one.
+    TEST_ASSERT_EQUAL_STRING("two", lastValue.c_str());
+    TEST_ASSERT_EQUAL_UINT32(2, nativeHttpServer().connects);
+    TEST_ASSERT_EQUAL_UINT32(1, wm.getConnectionStats().reused);
+
+    wm.disconnect();
+    TEST_ASSERT_FALSE(push->connected());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_connect_scans_and_the_next_one_is_fast);
+    RUN_TEST(test_fast_connect_to_a_moved_ap_falls_back_to_a_scan);
+    RUN_TEST(test_wrong_password_gives_up_after_the_scan_attempts);
+    RUN_TEST(test_content_length_body_reaches_the_callback_and_keeps_the_socket);
+    RUN_TEST(test_chunked_body_is_dechunked_and_keeps_the_socket);
+    RUN_TEST(test_close_delimited_body_is_read_to_eof_and_the_next_request_reconnects);
+    RUN_TEST(test_request_on_a_dropped_kept_socket_is_resent_once_on_a_new_one);
+    RUN_TEST(test_validators_are_reported_and_a_304_skips_the_callback);
+    RUN_TEST(test_unanswered_request_fails_after_the_retries);
+    RUN_TEST(test_push_socket_is_a_connection_of_its_own_and_closes_on_disconnect);
+    return UNITY_END();
+}
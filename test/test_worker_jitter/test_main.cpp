@@ -0,0 +1,202 @@
+/**
+ * @file test_main.cpp
+ * @brief Host run of the real `NetworkWorker` on its own task, checking that the control loop keeps its ticks while
+ *        the worker blocks, and how callbacks are released.
+ *
+ * The worker runs `NetworkFacade` over a real `WiFiManager` and the loopback HTTP server on a `std::thread` behind
+ * the FreeRTOS task stand-in (freertos/task.h); the test's own thread is the control loop, shaped like `loop()`:
+ * `pollEvents()`, the jobs that are due, then `waitForEvent()` until the next deadline. Both run on the virtual
+ * clock, which only moves while every task is blocked, so a tick's lateness is exact: any time the control loop
+ * spent waiting on the worker's I/O would show up in it, and the worker's blocking shows in when its replies arrive.
+ */
+#include <unity.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <Preferences.h>
+#include "NetworkWorker.h"
+#include "GPRSManager.h"
+
+static const uint8_t AP_BSSID[6] = {0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03};
+const unsigned long CONTROL_TICK_MS = 10;    ///< Control loop period.
+const unsigned long HTTP_READ_TIMEOUT_MS = 15000; ///< Read timeout `WiFiManager` gives `HTTPClient` per request.
+
+static DeviceConfig* config;
+static DeviceState* state;
+static NetworkFacade* facade;
+static NetworkWorker* worker;
+static std::vector<std::string> answers;          ///< Bodies handed to response callbacks, in order.
+static std::vector<unsigned long> answeredAtMs;   ///< `millis()` of each answer.
+static std::vector<NetworkWorkerEvent> handled;   ///< Events passed to the event handler.
+
+void setUp() {
+    nativeSetMs(1000);
+    nativeHttpServer().reset();
+    WiFi.nativeReset();
+    WiFi.nativeSetAccessPoint("greenhouse", "secret", 6, AP_BSSID);
+    nativePreferencesErase();
+    answers.clear();
+    answeredAtMs.clear();
+    handled.clear();
+
+    config = new DeviceConfig();
+    state = new DeviceState();
+    facade = new NetworkFacade(NetworkFacade::NetworkPreference::WIFI_ONLY,
+                               std::unique_ptr<WiFiManager>(new WiFiManager("greenhouse", "secret", "token")),
+                               std::unique_ptr<GPRSManager>(), nullptr);
+    TEST_ASSERT_TRUE(facade->connect());
+    worker = new NetworkWorker(*facade, *config, *state);
+    worker->setEventHandler([](const NetworkWorkerEvent& ev) { handled.push_back(ev); });
+    TEST_ASSERT_TRUE(worker->begin());
+}
+void tearDown() {
+    nativeTasksShutdown(); // Ends the worker task before the objects it runs on go away.
+    delete worker;
+    delete facade;
+    delete state;
+    delete config;
+}
+
+static HttpResponseCallback recordAnswer() {
+    return [](JsonDocument& doc) -> bool {
+        std::string body;
+        serializeJson(doc, body);
+        answers.push_back(body);
+        answeredAtMs.push_back(millis());
+        return true;
+    };
+}
+
+static std::string okResponse(const char* body, const char* extraHeaders = "") {
+    return std::string("HTTP/1.1 200 OK\r\nContent-Length: ") + std::to_string(strlen(body)) + "\r\n" + extraHeaders +
+           "\r\n" + body;
+}
+
+/**
+ * @brief Tick counters of one `runControlLoop()`.
+ */
+struct LoopRun {
+    uint32_t ticks = 0;     ///< Ticks run.
+    int64_t maxLateUs = 0;  ///< Latest a tick started after its due time.
+};
+
+/**
+ * @brief Runs the control loop for `ms` of virtual time, calling `job(tick)` every `CONTROL_TICK_MS`.
+ */
+static LoopRun runControlLoop(unsigned long ms, const std::function<void(uint32_t tick)>& job) {
+    LoopRun run;
+    int64_t due = nativeNowUs();
+    const int64_t end = due + (int64_t)ms * 1000;
+    while (due < end) {
+        worker->pollEvents();
+        int64_t now = nativeNowUs();
+        if (now >= due) {
+            if (now - due > run.maxLateUs) run.maxLateUs = now - due;
+            if (job) job(run.ticks);
+            run.ticks++;
+            due += (int64_t)CONTROL_TICK_MS * 1000;
+        }
+        now = nativeNowUs();
+        if (due > now) worker->waitForEvent((unsigned long)((due - now + 999) / 1000));
+    }
+    return run;
+}
+
+static bool sawEvent(NetworkEventKind kind, const char* body) {
+    for (size_t i = 0; i < handled.size(); ++i) {
+        if (handled[i].kind == kind && strcmp(handled[i].body, body) == 0) return true;
+    }
+    return false;
+}
+
+void test_control_ticks_stay_on_time_while_the_worker_blocks_on_a_read() {
+    uint32_t submitted = 0, rejected = 0;
+    unsigned long slowSubmittedAtMs = 0;
+    LoopRun run = runControlLoop(20000, [&](uint32_t tick) {
+        if (tick == 0) {
+            // Nothing is scripted yet, so this one goes unanswered and the worker sits in HTTPClient's read.
+            slowSubmittedAtMs = millis();
+            TEST_ASSERT_TRUE(worker->submit("http://api.test/slow", "GET", "Slow", nullptr, recordAnswer(), true));
+        } else if (tick == 1) {
+            TEST_ASSERT_EQUAL_UINT32(1, nativeHttpServer().requests.size());
+            for (int i = 1; i <= 7; ++i) nativeHttpServer().respond(okResponse(("{\"n\":" + std::to_string(i) + "}").c_str()));
+        } else if (tick % 5 == 0 && tick <= 50) {
+            // submit() never waits: with the worker blocked the callback table fills and the rest are rejected.
+            std::string url = "http://api.test/fast/" + std::to_string(tick / 5);
+            if (worker->submit(url.c_str(), "GET", "Fast", nullptr, recordAnswer(), true)) submitted++;
+            else rejected++;
+        }
+    });
+
+    char summary[160];
+    snprintf(summary, sizeof(summary), "%u ticks, max lateness %lld us; first reply %lu ms after the slow request; "
+             "%u submitted, %u answered, %u rejected", (unsigned)run.ticks, (long long)run.maxLateUs,
+             answeredAtMs.empty() ? 0UL : answeredAtMs[0] - slowSubmittedAtMs, (unsigned)submitted,
+             (unsigned)answers.size(), (unsigned)rejected);
+    TEST_MESSAGE(summary);
+
+    TEST_ASSERT_EQUAL_UINT32(2000, run.ticks);
+    TEST_ASSERT_EQUAL_INT64(0, run.maxLateUs); // Every tick on time...
+    TEST_ASSERT_EQUAL_UINT32(7, answers.size());
+    TEST_ASSERT_TRUE(answeredAtMs[0] - slowSubmittedAtMs >= HTTP_READ_TIMEOUT_MS); // ...while the worker blocked.
+    for (int i = 1; i <= 7; ++i) {
+        TEST_ASSERT_EQUAL_STRING(("{\"n\":" + std::to_string(i) + "}").c_str(), answers[i - 1].c_str());
+    }
+    // The slow request took one callback slot and the fast ones the other seven.
+    TEST_ASSERT_EQUAL_UINT32(NETWORK_WORKER_MAX_PENDING_CALLBACKS - 1, submitted);
+    TEST_ASSERT_EQUAL_UINT32(3, rejected);
+    TEST_ASSERT_EQUAL_UINT32(rejected, worker->getRejectedRequests());
+    TEST_ASSERT_EQUAL_UINT32(0, worker->getDroppedEvents());
+    // The timed-out request freed its slot: a new request is accepted.
+    nativeHttpServer().respond(okResponse("{\"n\":8}"));
+    TEST_ASSERT_TRUE(worker->submit("http://api.test/fast/8", "GET", "Fast", nullptr, recordAnswer(), true));
+    runControlLoop(1000, nullptr);
+    TEST_ASSERT_EQUAL_UINT32(8, answers.size());
+}
+
+void test_a_304_frees_only_the_callback_of_the_request_it_answered() {
+    nativeHttpServer().respond(okResponse("{\"v\":1}", "ETag: \"c1\"\r\n"));
+    TEST_ASSERT_TRUE(worker->submit("http://api.test/config", "GET", "Cfg", nullptr, recordAnswer(), true));
+    runControlLoop(1000, nullptr);
+    TEST_ASSERT_EQUAL_UINT32(1, answers.size());
+
+    // The first repeat goes out at once and is answered 304; the second waits behind it in the facade's queue
+    // (not coalesced: the first is already in flight) and gets a full reply.
+    nativeHttpServer().respond("HTTP/1.1 304 Not Modified\r\n\r\n");
+    nativeHttpServer().respond(okResponse("{\"v\":2}", "ETag: \"c2\"\r\n"));
+    TEST_ASSERT_TRUE(worker->submit("http://api.test/config", "GET", "Cfg", nullptr, recordAnswer(), true));
+    TEST_ASSERT_TRUE(worker->submit("http://api.test/config", "GET", "Cfg", nullptr, recordAnswer(), true));
+    runControlLoop(1000, nullptr);
+
+    TEST_ASSERT_EQUAL_UINT32(3, nativeHttpServer().requests.size());
+    TEST_ASSERT_TRUE(nativeHttpServer().requests[1].find("If-None-Match: \"c1\"\r\n") != std::string::npos);
+    TEST_ASSERT_TRUE(sawEvent(NetworkEventKind::HTTP_NOT_MODIFIED, "http://api.test/config"));
+    TEST_ASSERT_EQUAL_UINT32(2, answers.size());
+    TEST_ASSERT_EQUAL_STRING("{\"v\":2}", answers[1].c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, worker->getValidatorStats().notModified);
+    TEST_ASSERT_EQUAL_UINT32(0, worker->getDroppedEvents());
+}
+
+void test_worker_reconnects_after_a_link_loss_without_holding_the_loop() {
+    WiFi.nativeConnectDelayMs = 3000;
+    LoopRun run = runControlLoop(25000, [](uint32_t tick) {
+        if (tick == 0) WiFi.nativeDropLink(WIFI_REASON_BEACON_TIMEOUT);
+        if (tick == 1) TEST_ASSERT_FALSE(worker->isConnected());
+    });
+
+    TEST_ASSERT_EQUAL_UINT32(2500, run.ticks);
+    TEST_ASSERT_EQUAL_INT64(0, run.maxLateUs);
+    TEST_ASSERT_TRUE(sawEvent(NetworkEventKind::STATUS_MESSAGE, "Attempting network reconnect..."));
+    TEST_ASSERT_TRUE(sawEvent(NetworkEventKind::CONNECTED, "Net Reconnect OK"));
+    TEST_ASSERT_TRUE(worker->isConnected());
+    TEST_ASSERT_TRUE(worker->isOnWiFi());
+    TEST_ASSERT_TRUE(worker->getWiFiConnectStats().lastTimeToIpMs >= 3000);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_control_ticks_stay_on_time_while_the_worker_blocks_on_a_read);
+    RUN_TEST(test_a_304_frees_only_the_callback_of_the_request_it_answered);
+    RUN_TEST(test_worker_reconnects_after_a_link_loss_without_holding_the_loop);
+    return UNITY_END();
+}